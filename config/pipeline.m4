@@ -31,6 +31,8 @@ AM_COND_IF([PIPELINE_SUPPORT],[AC_CONFIG_FILES([
 	test/rofl/datapath/pipeline/openflow/openflow1x/pipeline/Makefile
 	test/rofl/datapath/pipeline/openflow/openflow1x/pipeline/bufs/Makefile
 	test/rofl/datapath/pipeline/openflow/openflow1x/pipeline/ma/loop/Makefile
+	test/rofl/datapath/pipeline/openflow/openflow1x/pipeline/ma/adaptive/Makefile
+	test/rofl/datapath/pipeline/openflow/openflow1x/pipeline/ma/bench/Makefile
 	test/rofl/datapath/pipeline/openflow/openflow1x/pipeline/dynamic/Makefile
 	test/rofl/datapath/pipeline/openflow/openflow1x/pipeline/static/Makefile
 	test/rofl/datapath/pipeline/openflow/openflow1x/pipeline/reset_pipeline/Makefile
@@ -39,7 +41,7 @@ AM_COND_IF([PIPELINE_SUPPORT],[AC_CONFIG_FILES([
 ## pipeline
 MATCHING_ALGORITHMS_DIR="src/rofl/datapath/pipeline/openflow/openflow1x/pipeline/matching_algorithms"
 AC_SUBST(MATCHING_ALGORITHMS_DIR)
-MATCHING_ALGORITHMS="loop"
+MATCHING_ALGORITHMS="loop adaptive"
 MATCHING_ALGORITHM_LIBS=""
 MATCHING_ALGORITHM_LIBADD=""
 
@@ -47,7 +49,7 @@ MATCHING_ALGORITHM_LIBADD=""
 AC_ARG_ENABLE(matching-algorithms,
 	AS_HELP_STRING([--enable-matching-algorithms="list of matching algorithms"],
   		[Build support for the list of matching algorithms. The 
-  		default is to build the loop matching algorithm.]),
+  		default is to build the loop and adaptive matching algorithms.]),
 [ case $enableval in
   yes)
   		# add all algorithms in $MATCHING_ALGORITHMS_DIR
@@ -94,3 +96,17 @@ done
 AC_SUBST(MATCHING_ALGORITHM_LIBADD)
 AC_SUBST(MATCHING_ALGORITHM_LIBS)
 AC_SUBST(MATCHING_ALGORITHMS)
+
+# pipeline latency instrumentation
+AC_MSG_CHECKING(whether to enable pipeline latency instrumentation)
+pipeline_latency_default="no"
+AC_ARG_ENABLE(pipeline-latency,
+	AS_HELP_STRING([--enable-pipeline-latency], [Record per table and per stage cycle count histograms of the pipeline [default=no]])
+		, , enable_pipeline_latency=$pipeline_latency_default)
+
+if test "$enable_pipeline_latency" = "yes"; then
+	AC_DEFINE(ROFL_PIPELINE_LATENCY_STATS)
+	AC_MSG_RESULT(yes)
+else
+	AC_MSG_RESULT(no)
+fi
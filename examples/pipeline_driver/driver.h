@@ -0,0 +1,231 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef __PIPELINE_DRIVER_H__
+#define __PIPELINE_DRIVER_H__
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#include <rofl.h>
+#include <rofl/datapath/pipeline/common/datapacket.h>
+#include <rofl/datapath/pipeline/switch_port.h>
+#include <rofl/datapath/pipeline/platform/cutil.h>
+#include <rofl/datapath/pipeline/openflow/openflow1x/of1x_switch.h>
+
+/**
+* @file driver.h
+* @brief Reference Linux userspace datapath driver for the pipeline library
+*
+* Implements the platform_* hooks of the pipeline on top of PACKET_MMAP
+* (TPACKET_V2) rings, in the spirit of cmmapport, or on top of pcap files
+* (testing). N worker threads run to completion: each one polls its RX
+* rings, processes the packets through the pipeline and writes the outputs
+* in its own TX rings. Packet buffers come from per-worker pools and never
+* leave the worker that allocated them, so the packet path takes no locks.
+*/
+
+//Workers; the last core id is reserved for the control (main) thread
+#define DRIVER_MAX_WORKERS (ROFL_PIPELINE_MAX_CORES-1)
+#define DRIVER_CONTROL_CORE (ROFL_PIPELINE_MAX_CORES-1)
+
+//Ports
+#define DRIVER_MAX_PORTS 32
+
+//Frames
+#define DRIVER_FRAME_SIZE 2048
+#define DRIVER_HEADROOM 64	//Room for push operations (VLAN, MPLS)
+
+//Packets received per port and iteration
+#define DRIVER_BURST 32
+
+//Default ring geometry (as in cmmapdev): block size in pages, number of blocks
+#define DRIVER_RING_BLOCK_SIZE 8
+#define DRIVER_RING_NUM_OF_BLOCKS 8
+
+//Default packet buffers per worker
+#define DRIVER_POOL_SIZE 4096
+
+//Offset of an absent header
+#define DRIVER_NO_HDR 0xFFFF
+
+/*
+* Packet buffers
+*/
+
+/**
+* Packet data. Shared (reference counted) between a packet and its
+* replicas (platform_packet_replicate_shared()).
+*/
+typedef struct driver_frame{
+	struct driver_frame* next;	//Free list
+	unsigned int refs;
+	unsigned int owner;		//Worker
+	uint8_t data[DRIVER_HEADROOM+DRIVER_FRAME_SIZE];
+}driver_frame_t;
+
+/**
+* Packet; pkt.platform_state points back to the driver_pkt_t
+*/
+typedef struct driver_pkt{
+	datapacket_t pkt;
+	struct driver_pkt* next;	//Free list
+	unsigned int owner;		//Worker
+
+	driver_frame_t* frame;
+	uint8_t* start;			//Ethernet header
+	uint32_t len;
+
+	//Metadata
+	uint32_t port_in;		//Logical (OF) port number
+	uint32_t queue;
+
+	//Parsed headers (offsets from start, DRIVER_NO_HDR if absent)
+	uint16_t eth_type_off;		//Innermost ethertype (after VLAN tags)
+	uint16_t vlan;			//Outermost VLAN tag (TPID)
+	uint16_t mpls;			//Outermost MPLS label
+	uint16_t pppoe;
+	uint16_t l3;			//IPv4, IPv6 or ARP
+	uint16_t l4;			//TCP, UDP, SCTP, ICMPv4 or ICMPv6
+	uint16_t gtp;
+	uint16_t eth_type;
+	uint16_t ipv6_exthdr;		//ipv6_exthdr_flags
+	uint8_t ip_proto;
+}driver_pkt_t;
+
+/**
+* Per-worker packet pool (only used by the owner worker)
+*/
+typedef struct driver_pool{
+	driver_pkt_t* free_pkts;
+	driver_frame_t* free_frames;
+	driver_pkt_t* pkts;
+	driver_frame_t* frames;
+	unsigned int size;
+	uint64_t alloc_failures;
+}driver_pool_t;
+
+/*
+* Ports
+*/
+
+typedef enum driver_port_type{
+	DRIVER_PORT_MMAP = 0,	//Linux interface (PACKET_MMAP rings)
+	DRIVER_PORT_PCAP = 1,	//pcap files
+}driver_port_type_t;
+
+/**
+* PACKET_MMAP ring
+*/
+typedef struct driver_ring{
+	int fd;
+	uint8_t* map;
+	size_t map_len;
+	unsigned int frame_size;
+	unsigned int frame_nr;
+	unsigned int pos;
+	unsigned int pending;	//TX frames not yet flushed
+}driver_ring_t;
+
+/**
+* Port
+*/
+typedef struct driver_port{
+	driver_port_type_t type;
+	unsigned int index;
+	char name[SWITCH_PORT_MAX_LEN_NAME];
+	switch_port_t* port;
+	uint32_t port_num;		//Logical (OF) port number
+
+	//PACKET_MMAP; one RX (fanout group) and one TX ring per worker
+	int ifindex;
+	driver_ring_t rx[DRIVER_MAX_WORKERS];
+	driver_ring_t tx[DRIVER_MAX_WORKERS];
+
+	//pcap
+	FILE* pcap_in;
+	FILE* pcap_out;
+	bool pcap_swapped;
+	bool pcap_eof;
+	pthread_mutex_t pcap_out_mutex;
+}driver_port_t;
+
+/*
+* Workers
+*/
+
+typedef struct driver_worker{
+	unsigned int id;
+	pthread_t thread;
+	driver_pool_t pool;
+
+	//Counters
+	uint64_t rx_pkts;
+	uint64_t tx_pkts;
+	uint64_t drops;
+	uint64_t packet_ins;
+	uint64_t __pad[3];
+}driver_worker_t;
+
+/**
+* Driver configuration and state
+*/
+typedef struct driver{
+	of1x_switch_t* sw;
+
+	unsigned int num_of_ports;
+	driver_port_t* ports[DRIVER_MAX_PORTS];
+
+	unsigned int num_of_workers;
+	driver_worker_t* workers;
+
+	unsigned int pool_size;
+	unsigned int ring_block_size;
+	unsigned int ring_num_of_blocks;
+
+	volatile bool running;
+}driver_t;
+
+extern driver_t driver;
+
+//C++ extern C
+ROFL_BEGIN_DECLS
+
+//Worker of the calling thread (NULL for non-worker threads)
+driver_worker_t* driver_get_worker(void);
+void driver_set_worker(driver_worker_t* worker);
+
+//Pools
+rofl_result_t driver_pool_init(driver_pool_t* pool, unsigned int owner, unsigned int size);
+void driver_pool_destroy(driver_pool_t* pool);
+driver_pkt_t* driver_pkt_alloc(driver_pool_t* pool);
+driver_frame_t* driver_frame_alloc(driver_pool_t* pool);
+void driver_pkt_release(driver_pkt_t* pkt);
+
+//Received frame: allocates and parses a packet
+driver_pkt_t* driver_pkt_rx(driver_worker_t* worker, driver_port_t* port, const uint8_t* data, uint32_t len, uint16_t vlan_tci, bool vlan_valid);
+void driver_pkt_parse(driver_pkt_t* pkt);
+
+//Ports
+driver_port_t* driver_port_mmap_init(const char* ifname, unsigned int index);
+driver_port_t* driver_port_pcap_init(const char* in_file, const char* out_file, unsigned int index);
+void driver_port_destroy(driver_port_t* port);
+//Link state (Linux interfaces); updates the switch port on changes
+void driver_port_poll_link(driver_port_t* port);
+
+//I/O (calling worker rings)
+unsigned int driver_port_rx_burst(driver_port_t* port, driver_worker_t* worker, driver_pkt_t** pkts, unsigned int max);
+rofl_result_t driver_port_tx(driver_port_t* port, driver_worker_t* worker, const uint8_t* data, uint32_t len);
+void driver_port_tx_flush(driver_port_t* port, driver_worker_t* worker);
+int driver_port_rx_fd(driver_port_t* port, driver_worker_t* worker);
+
+//Workers
+void* driver_worker_loop(void* arg);
+
+//C++ extern C
+ROFL_END_DECLS
+
+#endif //__PIPELINE_DRIVER_H__
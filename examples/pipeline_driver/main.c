@@ -0,0 +1,420 @@
+#include "driver.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <time.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <rofl/datapath/pipeline/physical_switch.h>
+#include <rofl/datapath/pipeline/openflow/of_switch.h>
+#include <rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_flow_entry.h>
+#include <rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_flow_table.h>
+#include <rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_instruction.h>
+#include <rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_match.h>
+#include <rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_snapshot.h>
+
+/*
+* Reference multi-core datapath driver
+*
+* Builds a single OF1.3 logical switch with the given ports, installs a
+* static forwarding configuration (there is no controller channel) and
+* runs the workers until interrupted, or until all the pcap inputs have
+* been processed.
+*/
+
+driver_t driver;
+
+typedef enum driver_flows{
+	DRIVER_FLOWS_FLOOD = 0,		//Match-all, output FLOOD
+	DRIVER_FLOWS_XCONNECT = 1,	//Ports cross-connected in pairs (1<->2, 3<->4...)
+	DRIVER_FLOWS_NONE = 2,		//Empty tables
+}driver_flows_t;
+
+static void usage(const char* prog){
+	fprintf(stderr,
+		"Usage: %s [options]\n"
+		"  -i <ifname>              add a port on a Linux interface (PACKET_MMAP rings)\n"
+		"  -p <in.pcap>[:<out.pcap>] add a port reading in.pcap and writing its output to out.pcap\n"
+		"  -w <workers>             number of worker threads (default 1)\n"
+		"  -t <tables>              number of OpenFlow tables (default 1)\n"
+		"  -f flood|xconnect|none   static flows installed in table 0 (default flood)\n"
+		"  -b <buffers>             packet buffers per worker (default %u)\n"
+		"  -s <pages>               ring block size, in pages (default %u)\n"
+		"  -n <blocks>              ring blocks (default %u)\n"
+		"  -d <seconds>             run for the given time (default: until SIGINT or end of the pcap inputs)\n"
+		"  -r <file>                warm restart: restore the pipeline from file (if any) instead of\n"
+		"                           installing the static flows, and save it there on exit\n",
+		prog, DRIVER_POOL_SIZE, DRIVER_RING_BLOCK_SIZE, DRIVER_RING_NUM_OF_BLOCKS);
+}
+
+static void sig_handler(int sig){
+	driver.running = false;
+}
+
+static rofl_result_t add_output_entry(of1x_switch_t* sw, bool match_port_in, uint32_t port_in, uint32_t port_out){
+
+	of1x_flow_entry_t* entry;
+	of1x_action_group_t* actions;
+	wrap_uint_t field;
+
+	entry = of1x_init_flow_entry(NULL, NULL, false);
+	if(!entry)
+		return ROFL_FAILURE;
+
+	if(match_port_in)
+		of1x_add_match_to_entry(entry, of1x_init_port_in_match(NULL, NULL, port_in));
+
+	field.u32 = port_out;
+	actions = of1x_init_action_group(0);
+	of1x_push_packet_action_to_group(actions, of1x_init_packet_action(OF1X_AT_OUTPUT, field, NULL, NULL));
+	of1x_add_instruction_to_group(&entry->inst_grp, OF1X_IT_APPLY_ACTIONS, actions, NULL, NULL, 0);
+
+	if(of1x_add_flow_entry_table(sw->pipeline, 0, entry, false, false) != ROFL_OF1X_FM_SUCCESS){
+		of1x_destroy_flow_entry(entry);
+		return ROFL_FAILURE;
+	}
+
+	return ROFL_SUCCESS;
+}
+
+static rofl_result_t install_flows(driver_flows_t flows){
+
+	unsigned int i;
+	uint32_t a, b;
+
+	switch(flows){
+		case DRIVER_FLOWS_FLOOD:
+			return add_output_entry(driver.sw, false, 0, OF1X_PORT_FLOOD);
+
+		case DRIVER_FLOWS_XCONNECT:
+			for(i=0;i+1<driver.num_of_ports;i+=2){
+				a = driver.ports[i]->port_num;
+				b = driver.ports[i+1]->port_num;
+				if(add_output_entry(driver.sw, true, a, b) != ROFL_SUCCESS ||
+					add_output_entry(driver.sw, true, b, a) != ROFL_SUCCESS)
+					return ROFL_FAILURE;
+			}
+			return ROFL_SUCCESS;
+
+		default:
+			return ROFL_SUCCESS;
+	}
+}
+
+static void print_stats(double elapsed){
+
+	unsigned int i;
+	port_stats_t stats;
+	driver_worker_t* worker;
+	uint64_t rx = 0;
+
+	fprintf(stdout, "\nPorts:\n");
+	for(i=0;i<driver.num_of_ports;i++){
+		switch_port_get_stats(driver.ports[i]->port, &stats);
+		fprintf(stdout, "  %-16s port %u: rx %"PRIu64" pkts (%"PRIu64" bytes, %"PRIu64" dropped), tx %"PRIu64" pkts (%"PRIu64" bytes, %"PRIu64" dropped)\n",
+			driver.ports[i]->name, driver.ports[i]->port_num,
+			stats.rx_packets, stats.rx_bytes, stats.rx_dropped,
+			stats.tx_packets, stats.tx_bytes, stats.tx_dropped);
+	}
+
+	fprintf(stdout, "Workers:\n");
+	for(i=0;i<driver.num_of_workers;i++){
+		worker = &driver.workers[i];
+		rx += worker->rx_pkts;
+		fprintf(stdout, "  worker %u: rx %"PRIu64", tx %"PRIu64", drops %"PRIu64", packet-ins %"PRIu64", buffer shortages %"PRIu64"\n",
+			i, worker->rx_pkts, worker->tx_pkts, worker->drops, worker->packet_ins, worker->pool.alloc_failures);
+	}
+
+	if(elapsed > 0)
+		fprintf(stdout, "Total: %"PRIu64" pkts in %.3f s (%.0f pps)\n", rx, elapsed, rx/elapsed);
+}
+
+/*
+* Warm restart (pipeline snapshots)
+*/
+
+//Restores the pipeline from the snapshot file, if any. ROFL_FAILURE if there is no (valid) snapshot
+static rofl_result_t restore_snapshot(const char* path){
+
+	int fd;
+	struct stat st;
+	void* image;
+	rofl_result_t res;
+
+	fd = open(path, O_RDONLY);
+	if(fd < 0)
+		return ROFL_FAILURE;
+
+	if(fstat(fd, &st) < 0 || st.st_size == 0){
+		close(fd);
+		return ROFL_FAILURE;
+	}
+
+	image = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(image == MAP_FAILED)
+		return ROFL_FAILURE;
+
+	res = of1x_snapshot_restore(driver.sw->pipeline, image, st.st_size);
+	munmap(image, st.st_size);
+
+	//Partially restored; start over
+	if(res != ROFL_SUCCESS)
+		__of1x_purge_pipeline_entries(driver.sw->pipeline);
+
+	return res;
+}
+
+//Saves the pipeline into the snapshot file (replaced atomically)
+static rofl_result_t save_snapshot(const char* path){
+
+	int fd;
+	size_t size, used;
+	void* image;
+	char tmp[PATH_MAX];
+	rofl_result_t res;
+
+	snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+	//The tables do not change any more (workers stopped); just expirations
+	size = of1x_snapshot_get_size(driver.sw->pipeline);
+
+	fd = open(tmp, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if(fd < 0)
+		return ROFL_FAILURE;
+
+	if(ftruncate(fd, size) < 0){
+		close(fd);
+		return ROFL_FAILURE;
+	}
+
+	image = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if(image == MAP_FAILED){
+		close(fd);
+		return ROFL_FAILURE;
+	}
+
+	res = of1x_snapshot_save(driver.sw->pipeline, image, size, &used);
+	munmap(image, size);
+
+	if(res == ROFL_SUCCESS && (ftruncate(fd, used) < 0 || fsync(fd) < 0))
+		res = ROFL_FAILURE;
+	close(fd);
+
+	if(res != ROFL_SUCCESS || rename(tmp, path) < 0){
+		unlink(tmp);
+		return ROFL_FAILURE;
+	}
+
+	return ROFL_SUCCESS;
+}
+
+int main(int argc, char** argv){
+
+	int opt;
+	unsigned int i, num_of_tables = 1, duration = 0;
+	driver_flows_t flows = DRIVER_FLOWS_FLOOD;
+	const char* snapshot = NULL;
+	enum of1x_matching_algorithm_available ma_list[OF1X_MAX_FLOWTABLES];
+	char* sep;
+	driver_port_t* port;
+	struct timespec start, end;
+	double elapsed;
+	bool done;
+
+	memset(&driver, 0, sizeof(driver));
+	driver.num_of_workers = 1;
+	driver.pool_size = DRIVER_POOL_SIZE;
+	driver.ring_block_size = DRIVER_RING_BLOCK_SIZE;
+	driver.ring_num_of_blocks = DRIVER_RING_NUM_OF_BLOCKS;
+
+	//First pass: settings the ports depend on
+	while((opt = getopt(argc, argv, "i:p:w:t:f:b:s:n:d:r:h")) != -1){
+		switch(opt){
+			case 'i':
+			case 'p':
+				break;
+			case 'w':
+				driver.num_of_workers = atoi(optarg);
+				break;
+			case 't':
+				num_of_tables = atoi(optarg);
+				break;
+			case 'f':
+				if(strcmp(optarg, "flood") == 0)
+					flows = DRIVER_FLOWS_FLOOD;
+				else if(strcmp(optarg, "xconnect") == 0)
+					flows = DRIVER_FLOWS_XCONNECT;
+				else if(strcmp(optarg, "none") == 0)
+					flows = DRIVER_FLOWS_NONE;
+				else{
+					usage(argv[0]);
+					return EXIT_FAILURE;
+				}
+				break;
+			case 'b':
+				driver.pool_size = atoi(optarg);
+				break;
+			case 's':
+				driver.ring_block_size = atoi(optarg);
+				break;
+			case 'n':
+				driver.ring_num_of_blocks = atoi(optarg);
+				break;
+			case 'd':
+				duration = atoi(optarg);
+				break;
+			case 'r':
+				snapshot = optarg;
+				break;
+			default:
+				usage(argv[0]);
+				return EXIT_FAILURE;
+		}
+	}
+
+	if(driver.num_of_workers == 0 || driver.num_of_workers > DRIVER_MAX_WORKERS ||
+		num_of_tables == 0 || num_of_tables > OF1X_MAX_FLOWTABLES || driver.pool_size == 0){
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	//Pipeline
+	if(physical_switch_init() != ROFL_SUCCESS){
+		fprintf(stderr, "Unable to initialize the physical switch\n");
+		return EXIT_FAILURE;
+	}
+
+	for(i=0;i<num_of_tables;i++)
+		ma_list[i] = of1x_matching_algorithm_loop;
+
+	driver.sw = of1x_init_switch("pipeline_driver", OF_VERSION_13, 0x1, num_of_tables, ma_list);
+	if(!driver.sw || physical_switch_add_logical_switch((of_switch_t*)driver.sw) != ROFL_SUCCESS){
+		fprintf(stderr, "Unable to create the logical switch\n");
+		return EXIT_FAILURE;
+	}
+
+	//Second pass: ports
+	optind = 1;
+	while((opt = getopt(argc, argv, "i:p:w:t:f:b:s:n:d:r:h")) != -1){
+		if(opt != 'i' && opt != 'p')
+			continue;
+
+		if(driver.num_of_ports == DRIVER_MAX_PORTS){
+			fprintf(stderr, "Too many ports\n");
+			return EXIT_FAILURE;
+		}
+
+		if(opt == 'i'){
+			port = driver_port_mmap_init(optarg, driver.num_of_ports);
+		}else{
+			sep = strchr(optarg, ':');
+			if(sep)
+				*sep++ = '\0';
+			port = driver_port_pcap_init(optarg, sep, driver.num_of_ports);
+		}
+
+		if(!port)
+			return EXIT_FAILURE;
+
+		if(physical_switch_add_port(port->port) != ROFL_SUCCESS ||
+			physical_switch_attach_port_to_logical_switch(port->port, (of_switch_t*)driver.sw, &port->port_num) != ROFL_SUCCESS){
+			fprintf(stderr, "Unable to attach port %s\n", port->name);
+			return EXIT_FAILURE;
+		}
+
+		driver.ports[driver.num_of_ports++] = port;
+	}
+
+	if(!driver.num_of_ports){
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if(snapshot && restore_snapshot(snapshot) == ROFL_SUCCESS){
+		fprintf(stdout, "Pipeline restored from %s\n", snapshot);
+	}else if(install_flows(flows) != ROFL_SUCCESS){
+		fprintf(stderr, "Unable to install the flows\n");
+		return EXIT_FAILURE;
+	}
+
+	//Workers
+	driver.workers = (driver_worker_t*)calloc(driver.num_of_workers, sizeof(driver_worker_t));
+	if(!driver.workers)
+		return EXIT_FAILURE;
+
+	for(i=0;i<driver.num_of_workers;i++){
+		driver.workers[i].id = i;
+		if(driver_pool_init(&driver.workers[i].pool, i, driver.pool_size) != ROFL_SUCCESS){
+			fprintf(stderr, "Unable to allocate the packet pools\n");
+			return EXIT_FAILURE;
+		}
+	}
+
+	signal(SIGINT, sig_handler);
+	signal(SIGTERM, sig_handler);
+
+	driver.running = true;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	for(i=0;i<driver.num_of_workers;i++){
+		if(pthread_create(&driver.workers[i].thread, NULL, driver_worker_loop, &driver.workers[i]) != 0){
+			fprintf(stderr, "Unable to start the workers\n");
+			return EXIT_FAILURE;
+		}
+	}
+
+	//Control loop: flow timers and link state
+	for(;;){
+		usleep(100000);
+		of_process_pipeline_tables_timeout_expirations((of_switch_t*)driver.sw);
+
+		for(i=0;i<driver.num_of_ports;i++)
+			driver_port_poll_link(driver.ports[i]);
+
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		if(duration && end.tv_sec - start.tv_sec >= (time_t)duration)
+			driver.running = false;
+
+		//pcap only: done when all the inputs have been processed
+		done = true;
+		for(i=0;i<driver.num_of_ports;i++)
+			if(driver.ports[i]->type == DRIVER_PORT_MMAP || !driver.ports[i]->pcap_eof)
+				done = false;
+		if(done || !driver.running)
+			break;
+	}
+
+	for(i=0;i<driver.num_of_workers;i++)
+		pthread_join(driver.workers[i].thread, NULL);
+	driver.running = false;
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec)/1e9;
+
+	print_stats(elapsed);
+
+	if(snapshot && save_snapshot(snapshot) != ROFL_SUCCESS)
+		fprintf(stderr, "Unable to save the pipeline to %s\n", snapshot);
+
+	//Tear down
+	physical_switch_remove_logical_switch((of_switch_t*)driver.sw);
+	for(i=0;i<driver.num_of_ports;i++){
+		physical_switch_remove_port(driver.ports[i]->name);
+		//The port (switch_port_t) is destroyed by the physical switch
+		driver.ports[i]->port = NULL;
+		driver_port_destroy(driver.ports[i]);
+	}
+	for(i=0;i<driver.num_of_workers;i++)
+		driver_pool_destroy(&driver.workers[i].pool);
+	free(driver.workers);
+	physical_switch_destroy();
+
+	return EXIT_SUCCESS;
+}
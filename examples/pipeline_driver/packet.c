@@ -0,0 +1,1370 @@
+#include "driver.h"
+
+#include <string.h>
+#include <rofl/datapath/pipeline/common/ipv6_exthdr.h>
+#include <rofl/datapath/pipeline/physical_switch.h>
+#include <rofl/datapath/pipeline/platform/packet.h>
+
+/*
+* Packet mangling platform hooks (platform/packet.h)
+*
+* Headers are located once on reception (driver_pkt_parse()) and after every
+* push/pop operation. Getters return header values in host byte order, and
+* setters keep the IPv4 and L4 checksums valid with incremental updates
+* (RFC 1624). PBB, tunnel id and the PPPoE/PBB/GTP push/pop actions are not
+* supported: getters return 0 and actions are ignored.
+*/
+
+#define ETH_TYPE_IPV4 0x0800
+#define ETH_TYPE_ARP 0x0806
+#define ETH_TYPE_VLAN 0x8100
+#define ETH_TYPE_QINQ 0x88A8
+#define ETH_TYPE_IPV6 0x86DD
+#define ETH_TYPE_MPLS 0x8847
+#define ETH_TYPE_MPLS_MC 0x8848
+#define ETH_TYPE_PPPOE_DISC 0x8863
+#define ETH_TYPE_PPPOE_SESS 0x8864
+
+#define IP_PROTO_ICMPV4 1
+#define IP_PROTO_TCP 6
+#define IP_PROTO_UDP 17
+#define IP_PROTO_ICMPV6 58
+#define IP_PROTO_SCTP 132
+
+#define UDP_PORT_GTPC 2123
+#define UDP_PORT_GTPU 2152
+
+#define ICMPV6_ND_SOLICITATION 135
+#define ICMPV6_ND_ADVERTISEMENT 136
+#define ICMPV6_ND_OPT_SLL 1
+#define ICMPV6_ND_OPT_TLL 2
+
+#define DPKT(pkt) ((driver_pkt_t*)(pkt)->platform_state)
+
+/*
+* Byte order helpers
+*/
+static inline uint16_t rd16(const uint8_t* p){
+	return ((uint16_t)p[0] << 8) | p[1];
+}
+
+static inline uint32_t rd32(const uint8_t* p){
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline uint64_t rd48(const uint8_t* p){
+	return ((uint64_t)rd16(p) << 32) | rd32(p+2);
+}
+
+static inline void wr16(uint8_t* p, uint16_t v){
+	p[0] = v >> 8;
+	p[1] = v & 0xFF;
+}
+
+static inline void wr32(uint8_t* p, uint32_t v){
+	wr16(p, v >> 16);
+	wr16(p+2, v & 0xFFFF);
+}
+
+static inline void wr48(uint8_t* p, uint64_t v){
+	wr16(p, (v >> 32) & 0xFFFF);
+	wr32(p+2, v & 0xFFFFFFFF);
+}
+
+static inline uint128__t rd128(const uint8_t* p){
+	uint128__t v;
+	UINT128__T_HI(v) = ((uint64_t)rd32(p) << 32) | rd32(p+4);
+	UINT128__T_LO(v) = ((uint64_t)rd32(p+8) << 32) | rd32(p+12);
+	return v;
+}
+
+static inline void wr128(uint8_t* p, uint128__t v){
+	wr32(p, UINT128__T_HI(v) >> 32);
+	wr32(p+4, UINT128__T_HI(v) & 0xFFFFFFFF);
+	wr32(p+8, UINT128__T_LO(v) >> 32);
+	wr32(p+12, UINT128__T_LO(v) & 0xFFFFFFFF);
+}
+
+static inline bool has(const driver_pkt_t* p, uint16_t off, uint32_t bytes){
+	return off != DRIVER_NO_HDR && (uint32_t)off + bytes <= p->len;
+}
+
+/*
+* Parsing
+*/
+
+static void __parse_ipv6(driver_pkt_t* p, uint16_t off){
+
+	uint8_t nh;
+
+	p->l3 = off;
+	nh = p->start[off+6];
+	off += 40;
+
+	//Skip extension headers
+	for(;;){
+		switch(nh){
+			case 0:
+				p->ipv6_exthdr |= IPV6_EH_HOP;
+				break;
+			case 43:
+				p->ipv6_exthdr |= IPV6_EH_ROUTER;
+				break;
+			case 60:
+				p->ipv6_exthdr |= IPV6_EH_DEST;
+				break;
+			case 44:
+				p->ipv6_exthdr |= IPV6_EH_FRAG;
+				break;
+			case 51:
+				p->ipv6_exthdr |= IPV6_EH_AUTH;
+				break;
+			case 50:
+				p->ipv6_exthdr |= IPV6_EH_ESP;
+				p->ip_proto = nh;
+				return;
+			case 59:
+				p->ipv6_exthdr |= IPV6_EH_NONEXT;
+				p->ip_proto = nh;
+				return;
+			default:
+				p->ip_proto = nh;
+				if(off < p->len)
+					p->l4 = off;
+				return;
+		}
+
+		if(off + 8 > p->len)
+			return;
+
+		if(nh == 44){
+			//Only the first fragment carries the L4 header
+			if(rd16(p->start+off+2) & 0xFFF8){
+				p->ip_proto = p->start[off];
+				return;
+			}
+			nh = p->start[off];
+			off += 8;
+		}else if(nh == 51){
+			nh = p->start[off];
+			off += (p->start[off+1]+2)*4;
+		}else{
+			nh = p->start[off];
+			off += (p->start[off+1]+1)*8;
+		}
+	}
+}
+
+void driver_pkt_parse(driver_pkt_t* p){
+
+	uint8_t* d = p->start;
+	uint16_t off, type, ihl;
+
+	p->eth_type_off = p->vlan = p->mpls = p->pppoe = p->l3 = p->l4 = p->gtp = DRIVER_NO_HDR;
+	p->eth_type = 0;
+	p->ip_proto = 0;
+	p->ipv6_exthdr = 0;
+
+	if(p->len < 14)
+		return;
+
+	//VLAN tags
+	off = 12;
+	type = rd16(d+off);
+	if(type == ETH_TYPE_VLAN || type == ETH_TYPE_QINQ)
+		p->vlan = off;
+	while((type == ETH_TYPE_VLAN || type == ETH_TYPE_QINQ) && off + 8 <= p->len){
+		off += 4;
+		type = rd16(d+off);
+	}
+
+	p->eth_type_off = off;
+	p->eth_type = type;
+	off += 2;
+
+	switch(type){
+		case ETH_TYPE_MPLS:
+		case ETH_TYPE_MPLS_MC:
+			if(off + 4 <= p->len)
+				p->mpls = off;
+			break;
+
+		case ETH_TYPE_PPPOE_DISC:
+		case ETH_TYPE_PPPOE_SESS:
+			if(off + 6 <= p->len)
+				p->pppoe = off;
+			break;
+
+		case ETH_TYPE_ARP:
+			if(off + 28 <= p->len)
+				p->l3 = off;
+			break;
+
+		case ETH_TYPE_IPV4:
+			if(off + 20 > p->len)
+				break;
+			p->l3 = off;
+			p->ip_proto = d[off+9];
+			ihl = (d[off] & 0x0F)*4;
+			//Only the first fragment carries the L4 header
+			if(ihl >= 20 && !(rd16(d+off+6) & 0x1FFF) && off + ihl < p->len)
+				p->l4 = off + ihl;
+			break;
+
+		case ETH_TYPE_IPV6:
+			if(off + 40 <= p->len)
+				__parse_ipv6(p, off);
+			break;
+
+		default:
+			break;
+	}
+
+	//GTP (over UDP)
+	if(p->ip_proto == IP_PROTO_UDP && has(p, p->l4, 8+8)){
+		uint16_t dst = rd16(d+p->l4+2);
+		if(dst == UDP_PORT_GTPU || dst == UDP_PORT_GTPC)
+			p->gtp = p->l4 + 8;
+	}
+}
+
+/*
+* Checksums
+*/
+
+//Incremental update of a checksum (RFC 1624)
+static inline void __csum_replace16(uint8_t* csum, uint16_t old_val, uint16_t new_val){
+	uint32_t sum = (~rd16(csum) & 0xFFFF) + (~old_val & 0xFFFF) + new_val;
+	sum = (sum & 0xFFFF) + (sum >> 16);
+	sum = (sum & 0xFFFF) + (sum >> 16);
+	wr16(csum, ~sum & 0xFFFF);
+}
+
+//L4 checksum affected by a change; pseudo if the change is in the pseudo-header
+static uint8_t* __l4_csum(driver_pkt_t* p, bool pseudo){
+
+	uint8_t* csum;
+
+	switch(p->ip_proto){
+		case IP_PROTO_TCP:
+			if(!has(p, p->l4, 18))
+				return NULL;
+			return p->start + p->l4 + 16;
+		case IP_PROTO_UDP:
+			if(!has(p, p->l4, 8))
+				return NULL;
+			csum = p->start + p->l4 + 6;
+			//No checksum (IPv4 only)
+			if(rd16(csum) == 0)
+				return NULL;
+			return csum;
+		case IP_PROTO_ICMPV4:
+			if(pseudo || !has(p, p->l4, 4))
+				return NULL;
+			return p->start + p->l4 + 2;
+		case IP_PROTO_ICMPV6:
+			if(!has(p, p->l4, 4))
+				return NULL;
+			return p->start + p->l4 + 2;
+		default:
+			return NULL;
+	}
+}
+
+static void __l4_csum_replace16(driver_pkt_t* p, bool pseudo, uint16_t old_val, uint16_t new_val){
+
+	uint8_t* csum = __l4_csum(p, pseudo);
+
+	if(!csum)
+		return;
+
+	__csum_replace16(csum, old_val, new_val);
+
+	//0 means no checksum in UDP
+	if(p->ip_proto == IP_PROTO_UDP && rd16(csum) == 0)
+		wr16(csum, 0xFFFF);
+}
+
+//Writes a 16 bit word of the packet, updating the checksums
+static void __set16(driver_pkt_t* p, uint16_t off, uint16_t val, bool ipv4_hdr, bool l4, bool pseudo){
+
+	uint16_t old_val = rd16(p->start+off);
+
+	if(old_val == val)
+		return;
+
+	wr16(p->start+off, val);
+
+	if(ipv4_hdr)
+		__csum_replace16(p->start+p->l3+10, old_val, val);
+	if(l4)
+		__l4_csum_replace16(p, pseudo, old_val, val);
+}
+
+//SCTP uses CRC32c; recomputed after any change
+static void __sctp_crc(driver_pkt_t* p){
+
+	uint32_t crc = 0xFFFFFFFF;
+	uint32_t i;
+	int j;
+	uint8_t* sctp = p->start + p->l4;
+
+	if(!has(p, p->l4, 12))
+		return;
+
+	memset(sctp+8, 0, 4);
+	for(i=0;i<p->len - p->l4;i++){
+		crc ^= sctp[i];
+		for(j=0;j<8;j++)
+			crc = (crc >> 1) ^ (0x82F63B78 & -(crc & 1));
+	}
+	crc = ~crc;
+
+	//Little endian
+	sctp[8] = crc & 0xFF;
+	sctp[9] = (crc >> 8) & 0xFF;
+	sctp[10] = (crc >> 16) & 0xFF;
+	sctp[11] = crc >> 24;
+}
+
+/*
+* Generic
+*/
+
+uint32_t platform_packet_get_size_bytes(datapacket_t *const pkt){
+	return DPKT(pkt)->len;
+}
+
+uint32_t platform_packet_get_port_in(datapacket_t *const pkt){
+	return DPKT(pkt)->port_in;
+}
+
+uint32_t platform_packet_get_phy_port_in(datapacket_t *const pkt){
+	return DPKT(pkt)->port_in;
+}
+
+void platform_packet_set_queue(datapacket_t* pkt, uint32_t queue){
+	DPKT(pkt)->queue = queue;
+}
+
+static driver_pkt_t* __replicate(datapacket_t* pkt, bool shared){
+
+	driver_pkt_t* orig = DPKT(pkt);
+	driver_worker_t* worker = driver_get_worker();
+	driver_pkt_t* replica;
+	driver_frame_t* frame;
+
+	if(!worker)
+		return NULL;
+
+	replica = driver_pkt_alloc(&worker->pool);
+	if(!replica)
+		return NULL;
+
+	//Copy the driver state (not the pipeline state)
+	frame = orig->frame;
+	replica->start = orig->start;
+	replica->len = orig->len;
+	replica->port_in = orig->port_in;
+	replica->queue = orig->queue;
+	replica->eth_type_off = orig->eth_type_off;
+	replica->vlan = orig->vlan;
+	replica->mpls = orig->mpls;
+	replica->pppoe = orig->pppoe;
+	replica->l3 = orig->l3;
+	replica->l4 = orig->l4;
+	replica->gtp = orig->gtp;
+	replica->eth_type = orig->eth_type;
+	replica->ipv6_exthdr = orig->ipv6_exthdr;
+	replica->ip_proto = orig->ip_proto;
+
+	if(shared){
+		frame->refs++;
+		replica->frame = frame;
+		replica->pkt.is_shared = pkt->is_shared = true;
+	}else{
+		replica->frame = driver_frame_alloc(&worker->pool);
+		if(!replica->frame){
+			driver_pkt_release(replica);
+			return NULL;
+		}
+		memcpy(replica->frame->data, frame->data, sizeof(frame->data));
+		replica->start = replica->frame->data + (orig->start - frame->data);
+	}
+
+	replica->pkt.is_replica = true;
+
+	return replica;
+}
+
+datapacket_t* platform_packet_replicate(datapacket_t* pkt){
+	driver_pkt_t* replica = __replicate(pkt, false);
+	return (replica)? &replica->pkt : NULL;
+}
+
+datapacket_t* platform_packet_replicate_shared(datapacket_t* pkt){
+	driver_pkt_t* replica = __replicate(pkt, true);
+	return (replica)? &replica->pkt : NULL;
+}
+
+rofl_result_t platform_packet_make_writable(datapacket_t* pkt){
+
+	driver_pkt_t* p = DPKT(pkt);
+	driver_worker_t* worker = driver_get_worker();
+	driver_frame_t* frame;
+
+	if(p->frame->refs > 1){
+		if(!worker)
+			return ROFL_FAILURE;
+
+		frame = driver_frame_alloc(&worker->pool);
+		if(!frame)
+			return ROFL_FAILURE;
+
+		memcpy(frame->data, p->frame->data, sizeof(frame->data));
+		p->start = frame->data + (p->start - p->frame->data);
+		p->frame->refs--;
+		p->frame = frame;
+	}
+
+	pkt->is_shared = false;
+
+	return ROFL_SUCCESS;
+}
+
+void platform_packet_drop(datapacket_t* pkt){
+
+	driver_worker_t* worker = driver_get_worker();
+
+	if(worker)
+		worker->drops++;
+
+	driver_pkt_release(DPKT(pkt));
+}
+
+/*
+* Output
+*/
+
+static void __tx(driver_worker_t* worker, switch_port_t* port, driver_pkt_t* p){
+
+	driver_port_t* dport = (driver_port_t*)port->platform_port_state;
+	port_queue_t* queue = &port->queues[(p->queue < port->max_queues)? p->queue : 0];
+
+	if(!dport || !port->up || !port->forward_packets){
+		switch_port_stats_inc(port, 0, 0, 0, 0, 0, 1);
+		return;
+	}
+
+	if(driver_port_tx(dport, worker, p->start, p->len) == ROFL_SUCCESS){
+		switch_port_stats_inc(port, 0, 1, 0, p->len, 0, 0);
+		if(queue->set)
+			port_queue_stats_inc(queue, 1, p->len, 0);
+		worker->tx_pkts++;
+	}else{
+		switch_port_stats_inc(port, 0, 0, 0, 0, 0, 1);
+	}
+}
+
+void platform_packet_output(datapacket_t* pkt, switch_port_t* port){
+
+	driver_pkt_t* p = DPKT(pkt);
+	driver_worker_t* worker = driver_get_worker();
+	const of_switch_t* sw = pkt->sw;
+	switch_port_t* out;
+	unsigned int i;
+
+	if(!worker || !sw){
+		driver_pkt_release(p);
+		return;
+	}
+
+	if(port == flood_meta_port || port == all_meta_port){
+		//TX copies the frame; no need to replicate
+		for(i=0;i<LOGICAL_SWITCH_MAX_LOG_PORTS;i++){
+			out = sw->logical_ports[i].port;
+			if(!out || i == p->port_in || sw->logical_ports[i].attachment_state != LOGICAL_PORT_STATE_ATTACHED)
+				continue;
+			if(port == flood_meta_port && out->no_flood)
+				continue;
+			__tx(worker, out, p);
+		}
+	}else if(port == in_port_meta_port){
+		if(p->port_in < LOGICAL_SWITCH_MAX_LOG_PORTS && sw->logical_ports[p->port_in].port)
+			__tx(worker, sw->logical_ports[p->port_in].port, p);
+	}else{
+		__tx(worker, port, p);
+	}
+
+	driver_pkt_release(p);
+}
+
+void platform_packet_output_multi(datapacket_t* pkt, switch_port_t** ports, unsigned int num_of_ports){
+
+	driver_pkt_t* p = DPKT(pkt);
+	driver_worker_t* worker = driver_get_worker();
+	unsigned int i;
+
+	//TX copies the frame; the same buffer is sent to all the ports
+	if(worker){
+		for(i=0;i<num_of_ports;i++)
+			__tx(worker, ports[i], p);
+	}
+
+	driver_pkt_release(p);
+}
+
+/*
+* Ethernet
+*/
+
+uint64_t platform_packet_get_eth_src(datapacket_t *const pkt){
+	return rd48(DPKT(pkt)->start+6);
+}
+
+uint64_t platform_packet_get_eth_dst(datapacket_t *const pkt){
+	return rd48(DPKT(pkt)->start);
+}
+
+uint16_t platform_packet_get_eth_type(datapacket_t *const pkt){
+	return DPKT(pkt)->eth_type;
+}
+
+void platform_packet_set_eth_src(datapacket_t* pkt, uint64_t eth_src){
+	wr48(DPKT(pkt)->start+6, eth_src);
+}
+
+void platform_packet_set_eth_dst(datapacket_t* pkt, uint64_t eth_dst){
+	wr48(DPKT(pkt)->start, eth_dst);
+}
+
+void platform_packet_set_eth_type(datapacket_t* pkt, uint16_t eth_type){
+
+	driver_pkt_t* p = DPKT(pkt);
+
+	if(!has(p, p->eth_type_off, 2))
+		return;
+
+	wr16(p->start+p->eth_type_off, eth_type);
+	driver_pkt_parse(p);
+}
+
+/*
+* VLAN
+*/
+
+bool platform_packet_has_vlan(datapacket_t *const pkt){
+	return has(DPKT(pkt), DPKT(pkt)->vlan, 4);
+}
+
+uint16_t platform_packet_get_vlan_vid(datapacket_t *const pkt){
+
+	driver_pkt_t* p = DPKT(pkt);
+
+	if(!has(p, p->vlan, 4))
+		return 0;
+	return rd16(p->start+p->vlan+2) & 0x0FFF;
+}
+
+uint8_t platform_packet_get_vlan_pcp(datapacket_t *const pkt){
+
+	driver_pkt_t* p = DPKT(pkt);
+
+	if(!has(p, p->vlan, 4))
+		return 0;
+	return p->start[p->vlan+2] >> 5;
+}
+
+void platform_packet_set_vlan_vid(datapacket_t* pkt, uint16_t vlan_vid){
+
+	driver_pkt_t* p = DPKT(pkt);
+
+	if(!has(p, p->vlan, 4))
+		return;
+	wr16(p->start+p->vlan+2, (rd16(p->start+p->vlan+2) & 0xF000) | (vlan_vid & 0x0FFF));
+}
+
+void platform_packet_set_vlan_pcp(datapacket_t* pkt, uint8_t vlan_pcp){
+
+	driver_pkt_t* p = DPKT(pkt);
+
+	if(!has(p, p->vlan, 4))
+		return;
+	p->start[p->vlan+2] = (p->start[p->vlan+2] & 0x1F) | ((vlan_pcp & 0x07) << 5);
+}
+
+void platform_packet_pop_vlan(datapacket_t* pkt){
+
+	driver_pkt_t* p = DPKT(pkt);
+
+	if(!has(p, p->vlan, 4))
+		return;
+
+	memmove(p->start+4, p->start, 12);
+	p->start += 4;
+	p->len -= 4;
+	driver_pkt_parse(p);
+}
+
+void platform_packet_push_vlan(datapacket_t* pkt, uint16_t ether_type){
+
+	driver_pkt_t* p = DPKT(pkt);
+	uint16_t tci = 0;
+
+	if(p->start - p->frame->data < 4 || p->len < 14)
+		return;
+
+	//New tag fields are copied from the current outermost tag, if any
+	if(has(p, p->vlan, 4))
+		tci = rd16(p->start+p->vlan+2);
+
+	memmove(p->start-4, p->start, 12);
+	p->start -= 4;
+	p->len += 4;
+	wr16(p->start+12, ether_type);
+	wr16(p->start+14, tci);
+	driver_pkt_parse(p);
+}
+
+/*
+* MPLS
+*/
+
+uint32_t platform_packet_get_mpls_label(datapacket_t *const pkt){
+
+	driver_pkt_t* p = DPKT(pkt);
+
+	if(!has(p, p->mpls, 4))
+		return 0;
+	return rd32(p->start+p->mpls) >> 12;
+}
+
+uint8_t platform_packet_get_mpls_tc(datapacket_t *const pkt){
+
+	driver_pkt_t* p = DPKT(pkt);
+
+	if(!has(p, p->mpls, 4))
+		return 0;
+	return (p->start[p->mpls+2] >> 1) & 0x07;
+}
+
+bool platform_packet_get_mpls_bos(datapacket_t *const pkt){
+
+	driver_pkt_t* p = DPKT(pkt);
+
+	if(!has(p, p->mpls, 4))
+		return false;
+	return p->start[p->mpls+2] & 0x01;
+}
+
+void platform_packet_set_mpls_label(datapacket_t* pkt, uint32_t label){
+
+	driver_pkt_t* p = DPKT(pkt);
+
+	if(!has(p, p->mpls, 4))
+		return;
+	wr32(p->start+p->mpls, (rd32(p->start+p->mpls) & 0xFFF) | ((label & 0xFFFFF) << 12));
+}
+
+void platform_packet_set_mpls_tc(datapacket_t* pkt, uint8_t tc){
+
+	driver_pkt_t* p = DPKT(pkt);
+
+	if(!has(p, p->mpls, 4))
+		return;
+	p->start[p->mpls+2] = (p->start[p->mpls+2] & 0xF1) | ((tc & 0x07) << 1);
+}
+
+void platform_packet_set_mpls_bos(datapacket_t* pkt, bool bos){
+
+	driver_pkt_t* p = DPKT(pkt);
+
+	if(!has(p, p->mpls, 4))
+		return;
+	p->start[p->mpls+2] = (p->start[p->mpls+2] & 0xFE) | (bos? 1:0);
+}
+
+void platform_packet_set_mpls_ttl(datapacket_t* pkt, uint8_t new_ttl){
+
+	driver_pkt_t* p = DPKT(pkt);
+
+	if(!has(p, p->mpls, 4))
+		return;
+	p->start[p->mpls+3] = new_ttl;
+}
+
+void platform_packet_dec_mpls_ttl(datapacket_t* pkt){
+
+	driver_pkt_t* p = DPKT(pkt);
+
+	if(!has(p, p->mpls, 4) || p->start[p->mpls+3] == 0)
+		return;
+	p->start[p->mpls+3]--;
+}
+
+void platform_packet_pop_mpls(datapacket_t* pkt, uint16_t ether_type){
+
+	driver_pkt_t* p = DPKT(pkt);
+	uint16_t off = p->mpls;
+
+	if(!has(p, off, 4))
+		return;
+
+	memmove(p->start+4, p->start, off);
+	p->start += 4;
+	p->len -= 4;
+	wr16(p->start+off-2, ether_type);
+	driver_pkt_parse(p);
+}
+
+void platform_packet_push_mpls(datapacket_t* pkt, uint16_t ether_type){
+
+	driver_pkt_t* p = DPKT(pkt);
+	uint16_t off;
+	uint32_t label;
+
+	if(p->start - p->frame->data < 4 || !has(p, p->eth_type_off, 2))
+		return;
+
+	if(has(p, p->mpls, 4)){
+		//Copy the current outermost label, clearing BoS
+		off = p->mpls;
+		label = rd32(p->start+off) & ~0x100;
+	}else{
+		//New stack; TTL copied from IP
+		off = p->eth_type_off+2;
+		label = 0x100;
+		if(p->eth_type == ETH_TYPE_IPV4 && has(p, p->l3, 20))
+			label |= p->start[p->l3+8];
+		else if(p->eth_type == ETH_TYPE_IPV6 && has(p, p->l3, 40))
+			label |= p->start[p->l3+7];
+	}
+
+	memmove(p->start-4, p->start, off);
+	p->start -= 4;
+	p->len += 4;
+	wr16(p->start+off-2, ether_type);
+	wr32(p->start+off, label);
+	driver_pkt_parse(p);
+}
+
+/*
+* TTL
+*/
+
+//TTL right below the outermost MPLS label (next label or IP)
+static uint8_t* __inner_ttl(driver_pkt_t* p, bool* ipv4){
+
+	uint16_t off = p->mpls;
+
+	*ipv4 = false;
+
+	if(!(p->start[off+2] & 0x01))
+		return has(p, off+4, 4)? p->start+off+7 : NULL;
+
+	//Bottom of stack, IP below
+	off += 4;
+	if(off >= p->len)
+		return NULL;
+	if((p->start[off] >> 4) == 4 && has(p, off, 20)){
+		*ipv4 = true;
+		return p->start+off+8;
+	}
+	if((p->start[off] >> 4) == 6 && has(p, off, 40))
+		return p->start+off+7;
+	return NULL;
+}
+
+void platform_packet_copy_ttl_in(datapacket_t* pkt){
+
+	driver_pkt_t* p = DPKT(pkt);
+	uint8_t* ttl;
+	uint16_t old_val;
+	bool ipv4;
+
+	if(!has(p, p->mpls, 4) || !(ttl = __inner_ttl(p, &ipv4)))
+		return;
+
+	old_val = rd16(ttl);
+	*ttl = p->start[p->mpls+3];
+	if(ipv4)
+		__csum_replace16(ttl+2, old_val, rd16(ttl));
+}
+
+void platform_packet_copy_ttl_out(datapacket_t* pkt){
+
+	driver_pkt_t* p = DPKT(pkt);
+	uint8_t* ttl;
+	bool ipv4;
+
+	if(!has(p, p->mpls, 4) || !(ttl = __inner_ttl(p, &ipv4)))
+		return;
+
+	p->start[p->mpls+3] = *ttl;
+}
+
+void platform_packet_dec_nw_ttl(datapacket_t* pkt){
+
+	driver_pkt_t* p = DPKT(pkt);
+
+	if(p->eth_type == ETH_TYPE_IPV4 && has(p, p->l3, 20)){
+		if(p->start[p->l3+8])
+			__set16(p, p->l3+8, rd16(p->start+p->l3+8) - 0x100, true, false, false);
+	}else if(p->eth_type == ETH_TYPE_IPV6 && has(p, p->l3, 40)){
+		if(p->start[p->l3+7])
+			p->start[p->l3+7]--;
+	}
+}
+
+void platform_packet_set_nw_ttl(datapacket_t* pkt, uint8_t new_ttl){
+
+	driver_pkt_t* p = DPKT(pkt);
+
+	if(p->eth_type == ETH_TYPE_IPV4 && has(p, p->l3, 20))
+		__set16(p, p->l3+8, (new_ttl << 8) | p->start[p->l3+9], true, false, false);
+	else if(p->eth_type == ETH_TYPE_IPV6 && has(p, p->l3, 40))
+		p->start[p->l3+7] = new_ttl;
+}
+
+/*
+* IP
+*/
+
+static inline bool is_ipv4(driver_pkt_t* p){
+	return p->eth_type == ETH_TYPE_IPV4 && has(p, p->l3, 20);
+}
+
+static inline bool is_ipv6(driver_pkt_t* p){
+	return p->eth_type == ETH_TYPE_IPV6 && has(p, p->l3, 40);
+}
+
+static uint8_t __get_tos(driver_pkt_t* p){
+	if(is_ipv4(p))
+		return p->start[p->l3+1];
+	if(is_ipv6(p))
+		return (rd16(p->start+p->l3) >> 4) & 0xFF;
+	return 0;
+}
+
+static void __set_tos(driver_pkt_t* p, uint8_t tos){
+
+	uint16_t word;
+
+	if(is_ipv4(p)){
+		__set16(p, p->l3, (p->start[p->l3] << 8) | tos, true, false, false);
+	}else if(is_ipv6(p)){
+		word = rd16(p->start+p->l3);
+		wr16(p->start+p->l3, (word & 0xF00F) | (tos << 4));
+	}
+}
+
+uint8_t platform_packet_get_ip_proto(datapacket_t *const pkt){
+	return DPKT(pkt)->ip_proto;
+}
+
+uint8_t platform_packet_get_ip_ecn(datapacket_t *const pkt){
+	return __get_tos(DPKT(pkt)) & 0x03;
+}
+
+uint8_t platform_packet_get_ip_dscp(datapacket_t *const pkt){
+	return __get_tos(DPKT(pkt)) >> 2;
+}
+
+void platform_packet_set_ip_proto(datapacket_t* pkt, uint8_t ip_proto){
+
+	driver_pkt_t* p = DPKT(pkt);
+
+	if(is_ipv4(p)){
+		__set16(p, p->l3+8, (p->start[p->l3+8] << 8) | ip_proto, true, false, false);
+		driver_pkt_parse(p);
+	}else if(is_ipv6(p)){
+		p->start[p->l3+6] = ip_proto;
+		driver_pkt_parse(p);
+	}
+}
+
+void platform_packet_set_ip_dscp(datapacket_t* pkt, uint8_t ip_dscp){
+	driver_pkt_t* p = DPKT(pkt);
+	__set_tos(p, (__get_tos(p) & 0x03) | (ip_dscp << 2));
+}
+
+void platform_packet_set_ip_ecn(datapacket_t* pkt, uint8_t ip_ecn){
+	driver_pkt_t* p = DPKT(pkt);
+	__set_tos(p, (__get_tos(p) & 0xFC) | (ip_ecn & 0x03));
+}
+
+/*
+* ARP
+*/
+
+static inline bool is_arp(driver_pkt_t* p){
+	return p->eth_type == ETH_TYPE_ARP && has(p, p->l3, 28);
+}
+
+uint16_t platform_packet_get_arp_opcode(datapacket_t *const pkt){
+	driver_pkt_t* p = DPKT(pkt);
+	return is_arp(p)? rd16(p->start+p->l3+6) : 0;
+}
+
+uint64_t platform_packet_get_arp_sha(datapacket_t *const pkt){
+	driver_pkt_t* p = DPKT(pkt);
+	return is_arp(p)? rd48(p->start+p->l3+8) : 0;
+}
+
+uint32_t platform_packet_get_arp_spa(datapacket_t *const pkt){
+	driver_pkt_t* p = DPKT(pkt);
+	return is_arp(p)? rd32(p->start+p->l3+14) : 0;
+}
+
+uint64_t platform_packet_get_arp_tha(datapacket_t *const pkt){
+	driver_pkt_t* p = DPKT(pkt);
+	return is_arp(p)? rd48(p->start+p->l3+18) : 0;
+}
+
+uint32_t platform_packet_get_arp_tpa(datapacket_t *const pkt){
+	driver_pkt_t* p = DPKT(pkt);
+	return is_arp(p)? rd32(p->start+p->l3+24) : 0;
+}
+
+void platform_packet_set_arp_opcode(datapacket_t* pkt, uint16_t arp_opcode){
+	driver_pkt_t* p = DPKT(pkt);
+	if(is_arp(p))
+		wr16(p->start+p->l3+6, arp_opcode);
+}
+
+void platform_packet_set_arp_sha(datapacket_t* pkt, uint64_t arp_sha){
+	driver_pkt_t* p = DPKT(pkt);
+	if(is_arp(p))
+		wr48(p->start+p->l3+8, arp_sha);
+}
+
+void platform_packet_set_arp_spa(datapacket_t* pkt, uint32_t arp_spa){
+	driver_pkt_t* p = DPKT(pkt);
+	if(is_arp(p))
+		wr32(p->start+p->l3+14, arp_spa);
+}
+
+void platform_packet_set_arp_tha(datapacket_t* pkt, uint64_t arp_tha){
+	driver_pkt_t* p = DPKT(pkt);
+	if(is_arp(p))
+		wr48(p->start+p->l3+18, arp_tha);
+}
+
+void platform_packet_set_arp_tpa(datapacket_t* pkt, uint32_t arp_tpa){
+	driver_pkt_t* p = DPKT(pkt);
+	if(is_arp(p))
+		wr32(p->start+p->l3+24, arp_tpa);
+}
+
+/*
+* IPv4
+*/
+
+uint32_t platform_packet_get_ipv4_src(datapacket_t *const pkt){
+	driver_pkt_t* p = DPKT(pkt);
+	return is_ipv4(p)? rd32(p->start+p->l3+12) : 0;
+}
+
+uint32_t platform_packet_get_ipv4_dst(datapacket_t *const pkt){
+	driver_pkt_t* p = DPKT(pkt);
+	return is_ipv4(p)? rd32(p->start+p->l3+16) : 0;
+}
+
+static void __set_ipv4_addr(driver_pkt_t* p, uint16_t off, uint32_t addr){
+
+	if(!is_ipv4(p))
+		return;
+
+	__set16(p, p->l3+off, addr >> 16, true, p->l4 != DRIVER_NO_HDR, true);
+	__set16(p, p->l3+off+2, addr & 0xFFFF, true, p->l4 != DRIVER_NO_HDR, true);
+}
+
+void platform_packet_set_ipv4_src(datapacket_t* pkt, uint32_t ip_src){
+	__set_ipv4_addr(DPKT(pkt), 12, ip_src);
+}
+
+void platform_packet_set_ipv4_dst(datapacket_t* pkt, uint32_t ip_dst){
+	__set_ipv4_addr(DPKT(pkt), 16, ip_dst);
+}
+
+/*
+* IPv6
+*/
+
+static inline bool is_nd(driver_pkt_t* p){
+	return is_ipv6(p) && p->ip_proto == IP_PROTO_ICMPV6 && has(p, p->l4, 24) &&
+		(p->start[p->l4] == ICMPV6_ND_SOLICITATION || p->start[p->l4] == ICMPV6_ND_ADVERTISEMENT);
+}
+
+//Link layer address option of a ND message
+static uint16_t __nd_option(driver_pkt_t* p, uint8_t type){
+
+	uint16_t off;
+
+	if(!is_nd(p))
+		return DRIVER_NO_HDR;
+
+	for(off = p->l4+24; off + 8 <= p->len && p->start[off+1]; off += p->start[off+1]*8){
+		if(p->start[off] == type)
+			return off+2;
+	}
+	return DRIVER_NO_HDR;
+}
+
+static void __set_ipv6_words(driver_pkt_t* p, uint16_t off, uint128__t val, bool pseudo){
+
+	uint8_t bytes[16];
+	unsigned int i;
+
+	wr128(bytes, val);
+	for(i=0;i<16;i+=2)
+		__set16(p, off+i, rd16(bytes+i), false, p->l4 != DRIVER_NO_HDR, pseudo);
+}
+
+uint128__t platform_packet_get_ipv6_src(datapacket_t *const pkt){
+	driver_pkt_t* p = DPKT(pkt);
+	uint128__t zero;
+
+	if(is_ipv6(p))
+		return rd128(p->start+p->l3+8);
+	memset(&zero, 0, sizeof(zero));
+	return zero;
+}
+
+uint128__t platform_packet_get_ipv6_dst(datapacket_t *const pkt){
+	driver_pkt_t* p = DPKT(pkt);
+	uint128__t zero;
+
+	if(is_ipv6(p))
+		return rd128(p->start+p->l3+24);
+	memset(&zero, 0, sizeof(zero));
+	return zero;
+}
+
+uint64_t platform_packet_get_ipv6_flabel(datapacket_t *const pkt){
+	driver_pkt_t* p = DPKT(pkt);
+	return is_ipv6(p)? rd32(p->start+p->l3) & 0x000FFFFF : 0;
+}
+
+uint128__t platform_packet_get_ipv6_nd_target(datapacket_t *const pkt){
+	driver_pkt_t* p = DPKT(pkt);
+	uint128__t zero;
+
+	if(is_nd(p))
+		return rd128(p->start+p->l4+8);
+	memset(&zero, 0, sizeof(zero));
+	return zero;
+}
+
+uint64_t platform_packet_get_ipv6_nd_sll(datapacket_t *const pkt){
+	driver_pkt_t* p = DPKT(pkt);
+	uint16_t off = __nd_option(p, ICMPV6_ND_OPT_SLL);
+	return (off != DRIVER_NO_HDR)? rd48(p->start+off) : 0;
+}
+
+uint64_t platform_packet_get_ipv6_nd_tll(datapacket_t *const pkt){
+	driver_pkt_t* p = DPKT(pkt);
+	uint16_t off = __nd_option(p, ICMPV6_ND_OPT_TLL);
+	return (off != DRIVER_NO_HDR)? rd48(p->start+off) : 0;
+}
+
+uint16_t platform_packet_get_ipv6_exthdr(datapacket_t *const pkt){
+	return DPKT(pkt)->ipv6_exthdr;
+}
+
+void platform_packet_set_ipv6_src(datapacket_t*pkt, uint128__t ipv6_src){
+	driver_pkt_t* p = DPKT(pkt);
+	if(is_ipv6(p))
+		__set_ipv6_words(p, p->l3+8, ipv6_src, true);
+}
+
+void platform_packet_set_ipv6_dst(datapacket_t*pkt, uint128__t ipv6_dst){
+	driver_pkt_t* p = DPKT(pkt);
+	if(is_ipv6(p))
+		__set_ipv6_words(p, p->l3+24, ipv6_dst, true);
+}
+
+void platform_packet_set_ipv6_flabel(datapacket_t*pkt, uint64_t ipv6_flabel){
+	driver_pkt_t* p = DPKT(pkt);
+	if(is_ipv6(p))
+		wr32(p->start+p->l3, (rd32(p->start+p->l3) & 0xFFF00000) | (ipv6_flabel & 0x000FFFFF));
+}
+
+void platform_packet_set_ipv6_nd_target(datapacket_t*pkt, uint128__t ipv6_nd_target){
+	driver_pkt_t* p = DPKT(pkt);
+	if(is_nd(p))
+		__set_ipv6_words(p, p->l4+8, ipv6_nd_target, false);
+}
+
+static void __set_nd_lladdr(driver_pkt_t* p, uint8_t type, uint64_t lladdr){
+
+	uint16_t off = __nd_option(p, type);
+	uint8_t bytes[6];
+
+	if(off == DRIVER_NO_HDR)
+		return;
+
+	wr48(bytes, lladdr);
+	__set16(p, off, rd16(bytes), false, true, false);
+	__set16(p, off+2, rd16(bytes+2), false, true, false);
+	__set16(p, off+4, rd16(bytes+4), false, true, false);
+}
+
+void platform_packet_set_ipv6_nd_sll(datapacket_t*pkt, uint64_t ipv6_nd_sll){
+	__set_nd_lladdr(DPKT(pkt), ICMPV6_ND_OPT_SLL, ipv6_nd_sll);
+}
+
+void platform_packet_set_ipv6_nd_tll(datapacket_t*pkt, uint64_t ipv6_nd_tll){
+	__set_nd_lladdr(DPKT(pkt), ICMPV6_ND_OPT_TLL, ipv6_nd_tll);
+}
+
+void platform_packet_set_ipv6_exthdr(datapacket_t*pkt, uint16_t ipv6_exthdr){
+	//Pseudo-field; not settable
+}
+
+/*
+* Transport
+*/
+
+static uint16_t __get_port(driver_pkt_t* p, uint8_t proto, uint16_t off){
+	if(p->ip_proto != proto || !has(p, p->l4, 4))
+		return 0;
+	return rd16(p->start+p->l4+off);
+}
+
+static void __set_port(driver_pkt_t* p, uint8_t proto, uint16_t off, uint16_t port){
+
+	if(p->ip_proto != proto || !has(p, p->l4, 4))
+		return;
+
+	if(proto == IP_PROTO_SCTP){
+		wr16(p->start+p->l4+off, port);
+		__sctp_crc(p);
+	}else{
+		__set16(p, p->l4+off, port, false, true, false);
+	}
+}
+
+uint16_t platform_packet_get_tcp_src(datapacket_t *const pkt){
+	return __get_port(DPKT(pkt), IP_PROTO_TCP, 0);
+}
+
+uint16_t platform_packet_get_tcp_dst(datapacket_t *const pkt){
+	return __get_port(DPKT(pkt), IP_PROTO_TCP, 2);
+}
+
+void platform_packet_set_tcp_src(datapacket_t* pkt, uint16_t tcp_src){
+	__set_port(DPKT(pkt), IP_PROTO_TCP, 0, tcp_src);
+}
+
+void platform_packet_set_tcp_dst(datapacket_t* pkt, uint16_t tcp_dst){
+	__set_port(DPKT(pkt), IP_PROTO_TCP, 2, tcp_dst);
+}
+
+uint16_t platform_packet_get_udp_src(datapacket_t *const pkt){
+	return __get_port(DPKT(pkt), IP_PROTO_UDP, 0);
+}
+
+uint16_t platform_packet_get_udp_dst(datapacket_t *const pkt){
+	return __get_port(DPKT(pkt), IP_PROTO_UDP, 2);
+}
+
+void platform_packet_set_udp_src(datapacket_t* pkt, uint16_t udp_src){
+	__set_port(DPKT(pkt), IP_PROTO_UDP, 0, udp_src);
+}
+
+void platform_packet_set_udp_dst(datapacket_t* pkt, uint16_t udp_dst){
+	__set_port(DPKT(pkt), IP_PROTO_UDP, 2, udp_dst);
+	driver_pkt_parse(DPKT(pkt));
+}
+
+uint16_t platform_packet_get_sctp_src(datapacket_t *const pkt){
+	return __get_port(DPKT(pkt), IP_PROTO_SCTP, 0);
+}
+
+uint16_t platform_packet_get_sctp_dst(datapacket_t *const pkt){
+	return __get_port(DPKT(pkt), IP_PROTO_SCTP, 2);
+}
+
+void platform_packet_set_sctp_src(datapacket_t* pkt, uint16_t sctp_src){
+	__set_port(DPKT(pkt), IP_PROTO_SCTP, 0, sctp_src);
+}
+
+void platform_packet_set_sctp_dst(datapacket_t* pkt, uint16_t sctp_dst){
+	__set_port(DPKT(pkt), IP_PROTO_SCTP, 2, sctp_dst);
+}
+
+/*
+* ICMP
+*/
+
+static uint8_t __get_icmp(driver_pkt_t* p, uint8_t proto, uint16_t off){
+	if(p->ip_proto != proto || !has(p, p->l4, 4))
+		return 0;
+	return p->start[p->l4+off];
+}
+
+static void __set_icmp(driver_pkt_t* p, uint8_t proto, uint16_t off, uint8_t val){
+
+	uint16_t word;
+
+	if(p->ip_proto != proto || !has(p, p->l4, 4))
+		return;
+
+	word = rd16(p->start+p->l4);
+	if(off == 0)
+		word = (val << 8) | (word & 0xFF);
+	else
+		word = (word & 0xFF00) | val;
+	__set16(p, p->l4, word, false, true, false);
+}
+
+uint8_t platform_packet_get_icmpv4_type(datapacket_t *const pkt){
+	return __get_icmp(DPKT(pkt), IP_PROTO_ICMPV4, 0);
+}
+
+uint8_t platform_packet_get_icmpv4_code(datapacket_t *const pkt){
+	return __get_icmp(DPKT(pkt), IP_PROTO_ICMPV4, 1);
+}
+
+void platform_packet_set_icmpv4_type(datapacket_t* pkt, uint8_t type){
+	__set_icmp(DPKT(pkt), IP_PROTO_ICMPV4, 0, type);
+}
+
+void platform_packet_set_icmpv4_code(datapacket_t* pkt, uint8_t code){
+	__set_icmp(DPKT(pkt), IP_PROTO_ICMPV4, 1, code);
+}
+
+uint8_t platform_packet_get_icmpv6_type(datapacket_t *const pkt){
+	return __get_icmp(DPKT(pkt), IP_PROTO_ICMPV6, 0);
+}
+
+uint8_t platform_packet_get_icmpv6_code(datapacket_t *const pkt){
+	return __get_icmp(DPKT(pkt), IP_PROTO_ICMPV6, 1);
+}
+
+void platform_packet_set_icmpv6_type(datapacket_t*pkt, uint8_t icmpv6_type){
+	__set_icmp(DPKT(pkt), IP_PROTO_ICMPV6, 0, icmpv6_type);
+}
+
+void platform_packet_set_icmpv6_code(datapacket_t*pkt, uint8_t icmpv6_code){
+	__set_icmp(DPKT(pkt), IP_PROTO_ICMPV6, 1, icmpv6_code);
+}
+
+/*
+* PPPoE/PPP
+*/
+
+uint8_t platform_packet_get_pppoe_code(datapacket_t *const pkt){
+	driver_pkt_t* p = DPKT(pkt);
+	return has(p, p->pppoe, 6)? p->start[p->pppoe+1] : 0;
+}
+
+uint8_t platform_packet_get_pppoe_type(datapacket_t *const pkt){
+	driver_pkt_t* p = DPKT(pkt);
+	return has(p, p->pppoe, 6)? p->start[p->pppoe] & 0x0F : 0;
+}
+
+uint16_t platform_packet_get_pppoe_sid(datapacket_t *const pkt){
+	driver_pkt_t* p = DPKT(pkt);
+	return has(p, p->pppoe, 6)? rd16(p->start+p->pppoe+2) : 0;
+}
+
+void platform_packet_set_pppoe_type(datapacket_t* pkt, uint8_t type){
+	driver_pkt_t* p = DPKT(pkt);
+	if(has(p, p->pppoe, 6))
+		p->start[p->pppoe] = (p->start[p->pppoe] & 0xF0) | (type & 0x0F);
+}
+
+void platform_packet_set_pppoe_code(datapacket_t* pkt, uint8_t code){
+	driver_pkt_t* p = DPKT(pkt);
+	if(has(p, p->pppoe, 6))
+		p->start[p->pppoe+1] = code;
+}
+
+void platform_packet_set_pppoe_sid(datapacket_t* pkt, uint16_t sid){
+	driver_pkt_t* p = DPKT(pkt);
+	if(has(p, p->pppoe, 6))
+		wr16(p->start+p->pppoe+2, sid);
+}
+
+void platform_packet_pop_pppoe(datapacket_t* pkt, uint16_t ether_type){
+	//Not supported
+}
+
+void platform_packet_push_pppoe(datapacket_t* pkt, uint16_t ether_type){
+	//Not supported
+}
+
+uint16_t platform_packet_get_ppp_proto(datapacket_t *const pkt){
+	driver_pkt_t* p = DPKT(pkt);
+	if(p->eth_type != ETH_TYPE_PPPOE_SESS || !has(p, p->pppoe, 8))
+		return 0;
+	return rd16(p->start+p->pppoe+6);
+}
+
+void platform_packet_set_ppp_proto(datapacket_t* pkt, uint16_t proto){
+	driver_pkt_t* p = DPKT(pkt);
+	if(p->eth_type == ETH_TYPE_PPPOE_SESS && has(p, p->pppoe, 8))
+		wr16(p->start+p->pppoe+6, proto);
+}
+
+/*
+* GTP
+*/
+
+uint8_t platform_packet_get_gtp_msg_type(datapacket_t *const pkt){
+	driver_pkt_t* p = DPKT(pkt);
+	return has(p, p->gtp, 8)? p->start[p->gtp+1] : 0;
+}
+
+uint32_t platform_packet_get_gtp_teid(datapacket_t *const pkt){
+	driver_pkt_t* p = DPKT(pkt);
+	return has(p, p->gtp, 8)? rd32(p->start+p->gtp+4) : 0;
+}
+
+void platform_packet_set_gtp_msg_type(datapacket_t* pkt, uint8_t msg_type){
+	driver_pkt_t* p = DPKT(pkt);
+	if(has(p, p->gtp, 8))
+		__set16(p, p->gtp, (p->start[p->gtp] << 8) | msg_type, false, true, false);
+}
+
+void platform_packet_set_gtp_teid(datapacket_t* pkt, uint32_t teid){
+	driver_pkt_t* p = DPKT(pkt);
+	if(has(p, p->gtp, 8)){
+		__set16(p, p->gtp+4, teid >> 16, false, true, false);
+		__set16(p, p->gtp+6, teid & 0xFFFF, false, true, false);
+	}
+}
+
+void platform_packet_pop_gtp(datapacket_t* pkt){
+	//Not supported
+}
+
+void platform_packet_push_gtp(datapacket_t* pkt){
+	//Not supported
+}
+
+/*
+* PBB and tunnel id (not supported)
+*/
+
+uint32_t platform_packet_get_pbb_isid(datapacket_t *const pkt){
+	return 0;
+}
+
+void platform_packet_set_pbb_isid(datapacket_t*pkt, uint32_t pbb_isid){
+}
+
+void platform_packet_pop_pbb(datapacket_t* pkt, uint16_t ether_type){
+}
+
+void platform_packet_push_pbb(datapacket_t* pkt, uint16_t ether_type){
+}
+
+uint64_t platform_packet_get_tunnel_id(datapacket_t *const pkt){
+	return 0;
+}
+
+void platform_packet_set_tunnel_id(datapacket_t*pkt, uint64_t tunnel_id){
+}
@@ -0,0 +1,193 @@
+#include "driver.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <rofl/datapath/pipeline/platform/memory.h>
+#include <rofl/datapath/pipeline/platform/lock.h>
+#include <rofl/datapath/pipeline/platform/atomic_operations.h>
+#include <rofl/datapath/pipeline/openflow/openflow1x/of1x_async_events_hooks.h>
+
+/*
+* Memory, locking, atomic, core id and OpenFlow event platform hooks
+*/
+
+/*
+* Memory
+*/
+
+void* platform_malloc(size_t length){
+	return malloc(length);
+}
+
+void* platform_malloc_shared(size_t length){
+	return malloc(length);
+}
+
+void platform_free(void* data){
+	free(data);
+}
+
+void platform_free_shared(void* data){
+	free(data);
+}
+
+void* platform_memcpy(void* dst, const void* src, size_t length){
+	return memcpy(dst, src, length);
+}
+
+void* platform_memset(void* src, int c, size_t length){
+	return memset(src, c, length);
+}
+
+void* platform_memmove(void* dst, const void* src, size_t length){
+	return memmove(dst, src, length);
+}
+
+/*
+* Locks (pthread)
+*/
+
+platform_mutex_t* platform_mutex_init(void* params){
+
+	pthread_mutex_t* mutex = (pthread_mutex_t*)platform_malloc_shared(sizeof(pthread_mutex_t));
+
+	if(!mutex)
+		return NULL;
+
+	if(pthread_mutex_init(mutex, params) != 0){
+		platform_free_shared(mutex);
+		return NULL;
+	}
+
+	return (platform_mutex_t*)mutex;
+}
+
+void platform_mutex_destroy(platform_mutex_t* mutex){
+	pthread_mutex_destroy(mutex);
+	platform_free_shared(mutex);
+}
+
+void platform_mutex_lock(platform_mutex_t* mutex){
+	pthread_mutex_lock(mutex);
+}
+
+void platform_mutex_unlock(platform_mutex_t* mutex){
+	pthread_mutex_unlock(mutex);
+}
+
+platform_rwlock_t* platform_rwlock_init(void* params){
+
+	pthread_rwlock_t* rwlock = (pthread_rwlock_t*)platform_malloc_shared(sizeof(pthread_rwlock_t));
+
+	if(!rwlock)
+		return NULL;
+
+	if(pthread_rwlock_init(rwlock, params) != 0){
+		platform_free_shared(rwlock);
+		return NULL;
+	}
+
+	return (platform_rwlock_t*)rwlock;
+}
+
+void platform_rwlock_destroy(platform_rwlock_t* rwlock){
+	pthread_rwlock_destroy(rwlock);
+	platform_free_shared(rwlock);
+}
+
+void platform_rwlock_rdlock(platform_rwlock_t* rwlock){
+	pthread_rwlock_rdlock(rwlock);
+}
+
+void platform_rwlock_rdunlock(platform_rwlock_t* rwlock){
+	pthread_rwlock_unlock(rwlock);
+}
+
+void platform_rwlock_wrlock(platform_rwlock_t* rwlock){
+	pthread_rwlock_wrlock(rwlock);
+}
+
+void platform_rwlock_wrunlock(platform_rwlock_t* rwlock){
+	pthread_rwlock_unlock(rwlock);
+}
+
+/*
+* Atomic operations (no need for the mutex)
+*/
+
+void platform_atomic_inc64(uint64_t* counter, platform_mutex_t* mutex){
+	__sync_fetch_and_add(counter, 1);
+}
+
+void platform_atomic_inc32(uint32_t* counter, platform_mutex_t* mutex){
+	__sync_fetch_and_add(counter, 1);
+}
+
+void platform_atomic_dec32(uint32_t* counter, platform_mutex_t* mutex){
+	__sync_fetch_and_sub(counter, 1);
+}
+
+void platform_atomic_add64(uint64_t* counter, uint64_t* value, platform_mutex_t* mutex){
+	__sync_fetch_and_add(counter, *value);
+}
+
+void platform_atomic_add32(uint32_t* counter, uint32_t* value, platform_mutex_t* mutex){
+	__sync_fetch_and_add(counter, *value);
+}
+
+/*
+* Core id; workers use their index, any other thread the control core
+*/
+
+static __thread driver_worker_t* current_worker = NULL;
+
+driver_worker_t* driver_get_worker(void){
+	return current_worker;
+}
+
+void driver_set_worker(driver_worker_t* worker){
+	current_worker = worker;
+}
+
+unsigned int platform_get_core_id(void){
+	return (current_worker)? current_worker->id : DRIVER_CONTROL_CORE;
+}
+
+/*
+* OpenFlow 1.x events
+*/
+
+rofl_result_t platform_post_init_of1x_switch(of1x_switch_t* sw){
+	//PBB and tunnel id are not advertised by the pipeline
+	return ROFL_SUCCESS;
+}
+
+rofl_result_t platform_pre_destroy_of1x_switch(of1x_switch_t* sw){
+	return ROFL_SUCCESS;
+}
+
+void platform_of1x_packet_in(const of1x_switch_t* sw, uint8_t table_id, datapacket_t* pkt, of_packet_in_reason_t reason){
+
+	driver_worker_t* worker = driver_get_worker();
+
+	//No controller channel; packet-ins are counted and dropped
+	if(worker)
+		worker->packet_ins++;
+
+	driver_pkt_release((driver_pkt_t*)pkt->platform_state);
+}
+
+void platform_of1x_notify_flow_removed(const of1x_switch_t* sw, of1x_flow_remove_reason_t reason, of1x_flow_entry_t* removed_flow_entry){
+}
+
+void plaftorm_of1x_add_entry_hook(of1x_flow_entry_t* new_entry){
+}
+
+void platform_of1x_modify_entry_hook(of1x_flow_entry_t* old_entry, of1x_flow_entry_t* mod, int reset_count){
+}
+
+void platform_of1x_remove_entry_hook(of1x_flow_entry_t* entry){
+}
+
+void platform_of1x_update_stats_hook(of1x_flow_entry_t* entry){
+}
@@ -0,0 +1,144 @@
+#include "driver.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+* Per-worker packet pools
+*
+* Packets and frames are preallocated at startup and kept in two free lists.
+* A packet (and its replicas) is always processed to completion by the worker
+* that received it, so the pool, and the frame reference counters, are only
+* touched by its owner and need no synchronization.
+*/
+
+rofl_result_t driver_pool_init(driver_pool_t* pool, unsigned int owner, unsigned int size){
+
+	unsigned int i;
+
+	memset(pool, 0, sizeof(*pool));
+
+	pool->pkts = (driver_pkt_t*)calloc(size, sizeof(driver_pkt_t));
+	pool->frames = (driver_frame_t*)calloc(size, sizeof(driver_frame_t));
+
+	if(!pool->pkts || !pool->frames){
+		free(pool->pkts);
+		free(pool->frames);
+		return ROFL_FAILURE;
+	}
+
+	for(i=0;i<size;i++){
+		pool->pkts[i].owner = owner;
+		pool->pkts[i].pkt.platform_state = &pool->pkts[i];
+		pool->pkts[i].next = pool->free_pkts;
+		pool->free_pkts = &pool->pkts[i];
+
+		pool->frames[i].owner = owner;
+		pool->frames[i].next = pool->free_frames;
+		pool->free_frames = &pool->frames[i];
+	}
+
+	pool->size = size;
+
+	return ROFL_SUCCESS;
+}
+
+void driver_pool_destroy(driver_pool_t* pool){
+	free(pool->pkts);
+	free(pool->frames);
+	memset(pool, 0, sizeof(*pool));
+}
+
+driver_pkt_t* driver_pkt_alloc(driver_pool_t* pool){
+
+	driver_pkt_t* pkt = pool->free_pkts;
+
+	if(!pkt){
+		pool->alloc_failures++;
+		return NULL;
+	}
+	pool->free_pkts = pkt->next;
+
+	//Reset the pipeline state, keeping the back pointer
+	memset(&pkt->pkt, 0, sizeof(pkt->pkt));
+	pkt->pkt.platform_state = pkt;
+	pkt->next = NULL;
+	pkt->frame = NULL;
+
+	return pkt;
+}
+
+driver_frame_t* driver_frame_alloc(driver_pool_t* pool){
+
+	driver_frame_t* frame = pool->free_frames;
+
+	if(!frame){
+		pool->alloc_failures++;
+		return NULL;
+	}
+	pool->free_frames = frame->next;
+	frame->next = NULL;
+	frame->refs = 1;
+
+	return frame;
+}
+
+//Returns the packet, and the frame if it was the last reference, to its pool
+void driver_pkt_release(driver_pkt_t* pkt){
+
+	driver_pool_t* pool = &driver.workers[pkt->owner].pool;
+	driver_frame_t* frame = pkt->frame;
+
+	if(frame && --frame->refs == 0){
+		driver_pool_t* frame_pool = &driver.workers[frame->owner].pool;
+		frame->next = frame_pool->free_frames;
+		frame_pool->free_frames = frame;
+	}
+
+	pkt->frame = NULL;
+	pkt->next = pool->free_pkts;
+	pool->free_pkts = pkt;
+}
+
+driver_pkt_t* driver_pkt_rx(driver_worker_t* worker, driver_port_t* port, const uint8_t* data, uint32_t len, uint16_t vlan_tci, bool vlan_valid){
+
+	driver_pkt_t* pkt;
+	uint8_t* start;
+
+	if(len < 14 || len + (vlan_valid? 4:0) > DRIVER_FRAME_SIZE)
+		return NULL;
+
+	pkt = driver_pkt_alloc(&worker->pool);
+	if(!pkt)
+		return NULL;
+
+	pkt->frame = driver_frame_alloc(&worker->pool);
+	if(!pkt->frame){
+		driver_pkt_release(pkt);
+		return NULL;
+	}
+
+	start = pkt->frame->data + DRIVER_HEADROOM;
+
+	if(vlan_valid){
+		//Re-insert the tag stripped by the kernel (VLAN offloading)
+		memcpy(start, data, 12);
+		start[12] = 0x81;
+		start[13] = 0x00;
+		start[14] = vlan_tci >> 8;
+		start[15] = vlan_tci & 0xFF;
+		memcpy(start+16, data+12, len-12);
+		len += 4;
+	}else{
+		memcpy(start, data, len);
+	}
+
+	pkt->start = start;
+	pkt->len = len;
+	pkt->port_in = port->port_num;
+	pkt->queue = 0;
+
+	driver_pkt_parse(pkt);
+
+	return pkt;
+}
@@ -0,0 +1,485 @@
+#include "driver.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <arpa/inet.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+
+/*
+* Ports
+*
+* PACKET_MMAP (TPACKET_V2) ports follow cmmapport: frames are copied from
+* the RX ring into pool buffers, and from the buffers into the TX ring. Each
+* worker has its own RX ring, in a PACKET_FANOUT (hash) group per port, and
+* its own TX ring, so rings are never shared between threads.
+*
+* pcap ports read their input file (from a single worker) and append
+* the output packets to another file; they are meant for functional tests.
+*/
+
+#define PCAP_MAGIC 0xa1b2c3d4
+#define PCAP_MAGIC_NS 0xa1b23c4d
+#define PCAP_LINKTYPE_ETHERNET 1
+#define PCAP_SNAPLEN 65535
+
+typedef struct pcap_hdr{
+	uint32_t magic;
+	uint16_t version_major;
+	uint16_t version_minor;
+	int32_t thiszone;
+	uint32_t sigfigs;
+	uint32_t snaplen;
+	uint32_t linktype;
+}pcap_hdr_t;
+
+typedef struct pcap_rec_hdr{
+	uint32_t ts_sec;
+	uint32_t ts_usec;
+	uint32_t incl_len;
+	uint32_t orig_len;
+}pcap_rec_hdr_t;
+
+static driver_port_t* __port_alloc(driver_port_type_t type, const char* name, unsigned int index){
+
+	driver_port_t* port = (driver_port_t*)calloc(1, sizeof(driver_port_t));
+	unsigned int i;
+
+	if(!port)
+		return NULL;
+
+	port->type = type;
+	port->index = index;
+	snprintf(port->name, sizeof(port->name), "%s", name);
+	for(i=0;i<DRIVER_MAX_WORKERS;i++)
+		port->rx[i].fd = port->tx[i].fd = -1;
+
+	port->port = switch_port_init(port->name, true, PORT_TYPE_PHYSICAL, PORT_STATE_NONE);
+	if(!port->port){
+		free(port);
+		return NULL;
+	}
+	port->port->platform_port_state = port;
+
+	return port;
+}
+
+/*
+* PACKET_MMAP
+*/
+
+static rofl_result_t __ring_init(driver_ring_t* ring, int ring_type, int ifindex, int fanout_id){
+
+	struct tpacket_req req;
+	struct sockaddr_ll addr;
+	struct packet_mreq mreq;
+	int version = TPACKET_V2;
+	int fanout;
+	bool rx = (ring_type == PACKET_RX_RING);
+
+	//TX sockets bind to no protocol, so that they do not receive
+	ring->fd = socket(AF_PACKET, SOCK_RAW, rx? htons(ETH_P_ALL) : 0);
+	if(ring->fd < 0)
+		return ROFL_FAILURE;
+
+	if(setsockopt(ring->fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0)
+		return ROFL_FAILURE;
+
+	//Same geometry as cmmapdev
+	memset(&req, 0, sizeof(req));
+	req.tp_block_size = driver.ring_block_size * getpagesize();
+	req.tp_block_nr = driver.ring_num_of_blocks;
+	req.tp_frame_size = DRIVER_FRAME_SIZE;
+	req.tp_frame_nr = req.tp_block_size * req.tp_block_nr / req.tp_frame_size;
+
+	if(setsockopt(ring->fd, SOL_PACKET, ring_type, &req, sizeof(req)) < 0)
+		return ROFL_FAILURE;
+
+	ring->map_len = req.tp_block_size * req.tp_block_nr;
+	ring->map = (uint8_t*)mmap(NULL, ring->map_len, PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd, 0);
+	if(ring->map == MAP_FAILED){
+		ring->map = NULL;
+		return ROFL_FAILURE;
+	}
+	ring->frame_size = req.tp_frame_size;
+	ring->frame_nr = req.tp_frame_nr;
+	ring->pos = ring->pending = 0;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sll_family = AF_PACKET;
+	addr.sll_protocol = rx? htons(ETH_P_ALL) : 0;
+	addr.sll_ifindex = ifindex;
+	if(bind(ring->fd, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+		return ROFL_FAILURE;
+
+	if(!rx)
+		return ROFL_SUCCESS;
+
+#ifdef PACKET_IGNORE_OUTGOING
+	version = 1;
+	setsockopt(ring->fd, SOL_PACKET, PACKET_IGNORE_OUTGOING, &version, sizeof(version));
+#endif
+
+	memset(&mreq, 0, sizeof(mreq));
+	mreq.mr_ifindex = ifindex;
+	mreq.mr_type = PACKET_MR_PROMISC;
+	if(setsockopt(ring->fd, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0)
+		return ROFL_FAILURE;
+
+	//Spread the flows of the port among the workers
+	if(driver.num_of_workers > 1){
+		fanout = (fanout_id & 0xFFFF) | (PACKET_FANOUT_HASH << 16);
+		if(setsockopt(ring->fd, SOL_PACKET, PACKET_FANOUT, &fanout, sizeof(fanout)) < 0)
+			return ROFL_FAILURE;
+	}
+
+	return ROFL_SUCCESS;
+}
+
+static void __ring_destroy(driver_ring_t* ring){
+	if(ring->map)
+		munmap(ring->map, ring->map_len);
+	if(ring->fd >= 0)
+		close(ring->fd);
+	ring->map = NULL;
+	ring->fd = -1;
+}
+
+static void __mmap_hwaddr(driver_port_t* port){
+
+	struct ifreq ifr;
+	int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+	if(fd < 0)
+		return;
+
+	memset(&ifr, 0, sizeof(ifr));
+	memcpy(ifr.ifr_name, port->name, IFNAMSIZ-1);	//port->name is zero padded
+	if(ioctl(fd, SIOCGIFHWADDR, &ifr) == 0)
+		memcpy(port->port->hwaddr, ifr.ifr_hwaddr.sa_data, SW_PORT_ETH_ALEN);
+	close(fd);
+}
+
+void driver_port_poll_link(driver_port_t* port){
+
+	struct ifreq ifr;
+	bool up;
+	bitmap32_t state;
+	int fd;
+
+	if(port->type != DRIVER_PORT_MMAP)
+		return;
+
+	fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if(fd < 0)
+		return;
+
+	memset(&ifr, 0, sizeof(ifr));
+	memcpy(ifr.ifr_name, port->name, IFNAMSIZ-1);	//port->name is zero padded
+	if(ioctl(fd, SIOCGIFFLAGS, &ifr) < 0){
+		close(fd);
+		return;
+	}
+	close(fd);
+
+	//Admin. state and carrier
+	up = (ifr.ifr_flags & IFF_UP) != 0;
+	state = (up && (ifr.ifr_flags & IFF_RUNNING))? PORT_STATE_LIVE : PORT_STATE_LINK_DOWN;
+
+	//Only changes are notified to the pipeline (liveness of the logical switch)
+	if(up == port->port->up && state == port->port->state)
+		return;
+
+	fprintf(stdout, "Port %s: %s, link %s\n", port->name, up? "up" : "down", (state == PORT_STATE_LIVE)? "up" : "down");
+	switch_port_update_state(port->port, up, state);
+}
+
+driver_port_t* driver_port_mmap_init(const char* ifname, unsigned int index){
+
+	driver_port_t* port;
+	unsigned int i;
+	int fanout_id = (getpid() + index) & 0xFFFF;
+
+	port = __port_alloc(DRIVER_PORT_MMAP, ifname, index);
+	if(!port)
+		return NULL;
+
+	port->ifindex = if_nametoindex(ifname);
+	if(!port->ifindex){
+		fprintf(stderr, "Interface %s not found\n", ifname);
+		driver_port_destroy(port);
+		return NULL;
+	}
+
+	for(i=0;i<driver.num_of_workers;i++){
+		if(__ring_init(&port->rx[i], PACKET_RX_RING, port->ifindex, fanout_id) != ROFL_SUCCESS ||
+			__ring_init(&port->tx[i], PACKET_TX_RING, port->ifindex, fanout_id) != ROFL_SUCCESS){
+			fprintf(stderr, "Unable to set up the PACKET_MMAP rings of %s: %s\n", ifname, strerror(errno));
+			driver_port_destroy(port);
+			return NULL;
+		}
+	}
+
+	__mmap_hwaddr(port);
+	driver_port_poll_link(port);
+
+	return port;
+}
+
+static unsigned int __mmap_rx_burst(driver_port_t* port, driver_worker_t* worker, driver_pkt_t** pkts, unsigned int max){
+
+	driver_ring_t* ring = &port->rx[worker->id];
+	struct tpacket2_hdr* hdr;
+	struct sockaddr_ll* sll;
+	driver_pkt_t* pkt;
+	unsigned int n = 0;
+	bool vlan_valid;
+
+	while(n < max){
+		hdr = (struct tpacket2_hdr*)(ring->map + ring->pos*ring->frame_size);
+
+		if(!(__atomic_load_n(&hdr->tp_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER))
+			break;
+
+		sll = (struct sockaddr_ll*)((uint8_t*)hdr + TPACKET_ALIGN(sizeof(struct tpacket2_hdr)));
+
+		//Ignore our own frames
+		if(sll->sll_pkttype != PACKET_OUTGOING){
+			vlan_valid = (hdr->tp_status & TP_STATUS_VLAN_VALID) != 0;
+			pkt = driver_pkt_rx(worker, port, (uint8_t*)hdr + hdr->tp_mac, hdr->tp_snaplen, hdr->tp_vlan_tci, vlan_valid);
+			if(pkt)
+				pkts[n++] = pkt;
+			else
+				switch_port_stats_inc(port->port, 0, 0, 0, 0, 1, 0);
+		}
+
+		//Return the slot to the kernel
+		__atomic_store_n(&hdr->tp_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+		ring->pos = (ring->pos+1 == ring->frame_nr)? 0 : ring->pos+1;
+	}
+
+	return n;
+}
+
+static void __mmap_tx_flush(driver_ring_t* ring){
+	if(!ring->pending)
+		return;
+	sendto(ring->fd, NULL, 0, MSG_DONTWAIT, NULL, 0);
+	ring->pending = 0;
+}
+
+static rofl_result_t __mmap_tx(driver_port_t* port, driver_worker_t* worker, const uint8_t* data, uint32_t len){
+
+	driver_ring_t* ring = &port->tx[worker->id];
+	struct tpacket2_hdr* hdr = (struct tpacket2_hdr*)(ring->map + ring->pos*ring->frame_size);
+	unsigned int offset = TPACKET2_HDRLEN - sizeof(struct sockaddr_ll);
+
+	if(len > ring->frame_size - offset)
+		return ROFL_FAILURE;
+
+	if(__atomic_load_n(&hdr->tp_status, __ATOMIC_ACQUIRE) != TP_STATUS_AVAILABLE){
+		//Ring full; kick the kernel and retry once
+		__mmap_tx_flush(ring);
+		if(__atomic_load_n(&hdr->tp_status, __ATOMIC_ACQUIRE) != TP_STATUS_AVAILABLE)
+			return ROFL_FAILURE;
+	}
+
+	memcpy((uint8_t*)hdr + offset, data, len);
+	hdr->tp_len = len;
+	__atomic_store_n(&hdr->tp_status, TP_STATUS_SEND_REQUEST, __ATOMIC_RELEASE);
+	ring->pos = (ring->pos+1 == ring->frame_nr)? 0 : ring->pos+1;
+
+	if(++ring->pending >= DRIVER_BURST)
+		__mmap_tx_flush(ring);
+
+	return ROFL_SUCCESS;
+}
+
+/*
+* pcap
+*/
+
+static inline uint32_t __pcap32(driver_port_t* port, uint32_t val){
+	return (port->pcap_swapped)? __builtin_bswap32(val) : val;
+}
+
+driver_port_t* driver_port_pcap_init(const char* in_file, const char* out_file, unsigned int index){
+
+	driver_port_t* port;
+	pcap_hdr_t hdr;
+	char name[SWITCH_PORT_MAX_LEN_NAME];
+
+	snprintf(name, sizeof(name), "pcap%u", index);
+	port = __port_alloc(DRIVER_PORT_PCAP, name, index);
+	if(!port)
+		return NULL;
+
+	pthread_mutex_init(&port->pcap_out_mutex, NULL);
+
+	port->pcap_in = fopen(in_file, "rb");
+	if(!port->pcap_in || fread(&hdr, sizeof(hdr), 1, port->pcap_in) != 1){
+		fprintf(stderr, "Unable to read pcap file %s\n", in_file);
+		driver_port_destroy(port);
+		return NULL;
+	}
+
+	if(hdr.magic == __builtin_bswap32(PCAP_MAGIC) || hdr.magic == __builtin_bswap32(PCAP_MAGIC_NS))
+		port->pcap_swapped = true;
+	else if(hdr.magic != PCAP_MAGIC && hdr.magic != PCAP_MAGIC_NS){
+		fprintf(stderr, "%s is not a pcap file\n", in_file);
+		driver_port_destroy(port);
+		return NULL;
+	}
+
+	if(__pcap32(port, hdr.linktype) != PCAP_LINKTYPE_ETHERNET){
+		fprintf(stderr, "%s: link type is not Ethernet\n", in_file);
+		driver_port_destroy(port);
+		return NULL;
+	}
+
+	if(out_file){
+		port->pcap_out = fopen(out_file, "wb");
+		if(!port->pcap_out){
+			fprintf(stderr, "Unable to create pcap file %s\n", out_file);
+			driver_port_destroy(port);
+			return NULL;
+		}
+		memset(&hdr, 0, sizeof(hdr));
+		hdr.magic = PCAP_MAGIC;
+		hdr.version_major = 2;
+		hdr.version_minor = 4;
+		hdr.snaplen = PCAP_SNAPLEN;
+		hdr.linktype = PCAP_LINKTYPE_ETHERNET;
+		fwrite(&hdr, sizeof(hdr), 1, port->pcap_out);
+	}
+
+	return port;
+}
+
+static unsigned int __pcap_rx_burst(driver_port_t* port, driver_worker_t* worker, driver_pkt_t** pkts, unsigned int max){
+
+	pcap_rec_hdr_t rec;
+	uint8_t data[DRIVER_FRAME_SIZE];
+	uint32_t len;
+	driver_pkt_t* pkt;
+	unsigned int n = 0;
+
+	while(n < max && !port->pcap_eof){
+		if(fread(&rec, sizeof(rec), 1, port->pcap_in) != 1){
+			port->pcap_eof = true;
+			break;
+		}
+
+		len = __pcap32(port, rec.incl_len);
+		if(len > PCAP_SNAPLEN){
+			port->pcap_eof = true;
+			break;
+		}
+
+		if(len > sizeof(data)){
+			//Jumbo frames are not supported
+			fseek(port->pcap_in, len, SEEK_CUR);
+			switch_port_stats_inc(port->port, 0, 0, 0, 0, 1, 0);
+			continue;
+		}
+
+		if(fread(data, len, 1, port->pcap_in) != 1){
+			port->pcap_eof = true;
+			break;
+		}
+
+		pkt = driver_pkt_rx(worker, port, data, len, 0, false);
+		if(pkt)
+			pkts[n++] = pkt;
+		else
+			switch_port_stats_inc(port->port, 0, 0, 0, 0, 1, 0);
+	}
+
+	return n;
+}
+
+static rofl_result_t __pcap_tx(driver_port_t* port, const uint8_t* data, uint32_t len){
+
+	pcap_rec_hdr_t rec;
+	struct timeval tv;
+
+	if(!port->pcap_out)
+		return ROFL_SUCCESS;
+
+	gettimeofday(&tv, NULL);
+	rec.ts_sec = tv.tv_sec;
+	rec.ts_usec = tv.tv_usec;
+	rec.incl_len = rec.orig_len = len;
+
+	//Functional testing only; workers serialize here
+	pthread_mutex_lock(&port->pcap_out_mutex);
+	fwrite(&rec, sizeof(rec), 1, port->pcap_out);
+	fwrite(data, len, 1, port->pcap_out);
+	pthread_mutex_unlock(&port->pcap_out_mutex);
+
+	return ROFL_SUCCESS;
+}
+
+/*
+* Generic
+*/
+
+void driver_port_destroy(driver_port_t* port){
+
+	unsigned int i;
+
+	for(i=0;i<DRIVER_MAX_WORKERS;i++){
+		__ring_destroy(&port->rx[i]);
+		__ring_destroy(&port->tx[i]);
+	}
+
+	if(port->type == DRIVER_PORT_PCAP){
+		if(port->pcap_in)
+			fclose(port->pcap_in);
+		if(port->pcap_out)
+			fclose(port->pcap_out);
+		pthread_mutex_destroy(&port->pcap_out_mutex);
+	}
+
+	if(port->port)
+		switch_port_destroy(port->port);
+
+	free(port);
+}
+
+unsigned int driver_port_rx_burst(driver_port_t* port, driver_worker_t* worker, driver_pkt_t** pkts, unsigned int max){
+
+	if(!port->port->up || port->port->drop_received)
+		return 0;
+
+	if(port->type == DRIVER_PORT_MMAP)
+		return __mmap_rx_burst(port, worker, pkts, max);
+
+	//A single worker reads each file
+	if(port->index % driver.num_of_workers != worker->id)
+		return 0;
+	return __pcap_rx_burst(port, worker, pkts, max);
+}
+
+rofl_result_t driver_port_tx(driver_port_t* port, driver_worker_t* worker, const uint8_t* data, uint32_t len){
+
+	if(port->type == DRIVER_PORT_MMAP)
+		return __mmap_tx(port, worker, data, len);
+	return __pcap_tx(port, data, len);
+}
+
+void driver_port_tx_flush(driver_port_t* port, driver_worker_t* worker){
+	if(port->type == DRIVER_PORT_MMAP)
+		__mmap_tx_flush(&port->tx[worker->id]);
+}
+
+int driver_port_rx_fd(driver_port_t* port, driver_worker_t* worker){
+	return (port->type == DRIVER_PORT_MMAP)? port->rx[worker->id].fd : -1;
+}
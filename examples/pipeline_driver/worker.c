@@ -0,0 +1,94 @@
+#include "driver.h"
+
+#include <poll.h>
+#include <time.h>
+
+/*
+* Run-to-completion workers
+*/
+
+//Idle wait when no packets were received (ms)
+#define DRIVER_IDLE_POLL_MS 10
+
+//Whether all the pcap inputs of the worker have been consumed (or there are none)
+static bool __inputs_done(driver_worker_t* worker){
+
+	unsigned int i;
+	driver_port_t* port;
+
+	for(i=0;i<driver.num_of_ports;i++){
+		port = driver.ports[i];
+		if(port->type == DRIVER_PORT_MMAP)
+			return false;
+		if(port->index % driver.num_of_workers == worker->id && !port->pcap_eof)
+			return false;
+	}
+	return true;
+}
+
+static void __idle(driver_worker_t* worker){
+
+	struct pollfd fds[DRIVER_MAX_PORTS];
+	unsigned int i, n = 0;
+	int fd;
+	struct timespec ts = { 0, DRIVER_IDLE_POLL_MS*1000000L };
+
+	for(i=0;i<driver.num_of_ports;i++){
+		fd = driver_port_rx_fd(driver.ports[i], worker);
+		if(fd < 0)
+			continue;
+		fds[n].fd = fd;
+		fds[n].events = POLLIN | POLLERR;
+		fds[n].revents = 0;
+		n++;
+	}
+
+	if(n)
+		poll(fds, n, DRIVER_IDLE_POLL_MS);
+	else
+		nanosleep(&ts, NULL);
+}
+
+void* driver_worker_loop(void* arg){
+
+	driver_worker_t* worker = (driver_worker_t*)arg;
+	driver_pkt_t* pkts[DRIVER_BURST];
+	driver_port_t* port;
+	unsigned int i, j, n, total;
+
+	driver_set_worker(worker);
+
+	while(driver.running){
+
+		total = 0;
+
+		for(i=0;i<driver.num_of_ports;i++){
+			port = driver.ports[i];
+
+			n = driver_port_rx_burst(port, worker, pkts, DRIVER_BURST);
+			total += n;
+
+			for(j=0;j<n;j++){
+				switch_port_stats_inc(port->port, 1, 0, pkts[j]->len, 0, 0, 0);
+				worker->rx_pkts++;
+
+				//The pipeline consumes the packet (output, drop or packet-in)
+				of_process_packet_pipeline((of_switch_t*)driver.sw, &pkts[j]->pkt);
+			}
+		}
+
+		//Kick the TX rings once per iteration
+		for(i=0;i<driver.num_of_ports;i++)
+			driver_port_tx_flush(driver.ports[i], worker);
+
+		if(total)
+			continue;
+
+		if(__inputs_done(worker))
+			break;
+
+		__idle(worker);
+	}
+
+	return NULL;
+}
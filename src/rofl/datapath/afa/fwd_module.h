@@ -135,6 +135,8 @@ afa_result_t fwd_module_attach_port_to_switch(uint64_t dpid, const char* name, u
 * @brief   Attemps to connect two logical switches via a virtual port. Forwarding module may or may not support this functionality. On success, the two ports must be functional and process packets. 
 * @ingroup management
 *
+* Forwarding modules may join the two ports with virtual_link_connect() (see pipeline's virtual_link.h), so that packets are handed over in memory to the pipeline of the other logical switch.
+*
 * @param dpid_lsi1 Datapath ID of the LSI1
 * @param port1 A pointer to the virtual port attached to the LS1
 * @param dpid_lsi2 Datapath ID of the LSI2
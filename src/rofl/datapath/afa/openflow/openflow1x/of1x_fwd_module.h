@@ -102,10 +102,133 @@ afa_result_t fwd_module_of1x_set_pipeline_config(uint64_t dpid, unsigned int fla
  */
 afa_result_t fwd_module_of1x_set_table_config(uint64_t dpid, unsigned int table_id, of1x_flow_table_miss_config_t config);
 
+/**
+ * @name    fwd_module_of1x_set_table_matching_algorithm
+ * @brief   Instructs forward module to migrate a table to another matching algorithm, preserving its entries
+ * @ingroup of1x_fwd_module_async_event_processing
+ *
+ * Flow mods on the table are blocked while the state of the new algorithm is built.
+ * See of1x_set_table_matching_algorithm()
+ *
+ * @param dpid 		Datapath ID of the switch
+ * @param table_id	Table ID
+ * @param algorithm	Matching algorithm
+ */
+afa_result_t fwd_module_of1x_set_table_matching_algorithm(uint64_t dpid, unsigned int table_id, enum of1x_matching_algorithm_available algorithm);
+
+/**
+ * @name    fwd_module_of1x_set_table_shadow_lookup
+ * @brief   Instructs forward module to validate the lookups of a table against the loop algorithm
+ * @ingroup of1x_fwd_module_async_event_processing
+ *
+ * See of1x_set_table_shadow_lookup()
+ *
+ * @param dpid 		Datapath ID of the switch
+ * @param table_id	Table ID
+ * @param sample_rate	1 out of sample_rate lookups is checked (0 disables)
+ */
+afa_result_t fwd_module_of1x_set_table_shadow_lookup(uint64_t dpid, unsigned int table_id, uint32_t sample_rate);
+
+/**
+ * @name    fwd_module_of1x_set_table_capacity
+ * @brief   Instructs forward module to limit the number of entries of a table
+ * @ingroup of1x_fwd_module_async_event_processing
+ *
+ * See of1x_set_table_capacity()
+ *
+ * @param dpid 		Datapath ID of the switch
+ * @param table_id	Table ID
+ * @param max_entries	Maximum number of entries
+ * @param eviction	Eviction policy when the table is full
+ */
+afa_result_t fwd_module_of1x_set_table_capacity(uint64_t dpid, unsigned int table_id, unsigned int max_entries, of1x_flow_table_eviction_t eviction);
+
+/**
+ * @name    fwd_module_of1x_get_latency_stats
+ * @brief   Retrieves the cycle count histogram of a table and pipeline stage
+ * @ingroup of1x_fwd_module_async_event_processing
+ *
+ * Only available if the pipeline has been built with --enable-pipeline-latency.
+ * See of1x_get_pipeline_latency()
+ *
+ * @param dpid 		Datapath ID of the switch
+ * @param table_id	Table ID
+ * @param stage		Pipeline stage
+ * @param hist		Histogram (aggregated over all cores)
+ */
+afa_result_t fwd_module_of1x_get_latency_stats(uint64_t dpid, unsigned int table_id, of1x_latency_stage_t stage, of1x_latency_hist_t* hist);
+
+/**
+ * @name    fwd_module_of1x_reset_latency_stats
+ * @brief   Resets all the cycle count histograms of the pipeline
+ * @ingroup of1x_fwd_module_async_event_processing
+ *
+ * @param dpid 		Datapath ID of the switch
+ */
+afa_result_t fwd_module_of1x_reset_latency_stats(uint64_t dpid);
+
+/**
+ * @name    fwd_module_of1x_set_flight_recorder
+ * @brief   Instructs forward module to record the decisions of 1 out of sample_rate packets
+ * @ingroup of1x_fwd_module_async_event_processing
+ *
+ * See of1x_set_flight_recorder()
+ *
+ * @param dpid 		Datapath ID of the switch
+ * @param sample_rate	1 out of sample_rate packets is recorded (0 disables)
+ */
+afa_result_t fwd_module_of1x_set_flight_recorder(uint64_t dpid, uint32_t sample_rate);
+
+/**
+ * @name    fwd_module_of1x_get_flight_records
+ * @brief   Retrieves the most recent flight recorder records
+ * @ingroup of1x_fwd_module_async_event_processing
+ *
+ * See of1x_get_flight_records()
+ *
+ * @param dpid 		Datapath ID of the switch
+ * @param records	Array of max_records records to be filled in
+ * @param max_records	Max number of records
+ * @param num_of_records Number of records filled in
+ */
+afa_result_t fwd_module_of1x_get_flight_records(uint64_t dpid, of1x_flight_record_t* records, unsigned int max_records, unsigned int* num_of_records);
+
+/**
+ * @name    fwd_module_of1x_set_packet_in_limit
+ * @brief   Instructs forward module to limit the packet-in rate of a switch, table or reason
+ * @ingroup of1x_fwd_module_async_event_processing
+ *
+ * See of1x_set_packet_in_limit()
+ *
+ * @param dpid 		Datapath ID of the switch
+ * @param scope		Switch, table or reason
+ * @param id		Table id or reason (ignored for the switch)
+ * @param rate		Packet-ins per second (0 removes the limit)
+ * @param burst		Packet-ins admitted back to back
+ */
+afa_result_t fwd_module_of1x_set_packet_in_limit(uint64_t dpid, of1x_pkt_in_limit_scope_t scope, unsigned int id, uint32_t rate, uint32_t burst);
+
+/**
+ * @name    fwd_module_of1x_get_packet_in_limit_stats
+ * @brief   Retrieves a packet-in limit and its admitted and dropped counters
+ * @ingroup of1x_fwd_module_async_event_processing
+ *
+ * See of1x_get_packet_in_limit_stats()
+ *
+ * @param dpid 		Datapath ID of the switch
+ * @param scope		Switch, table or reason
+ * @param id		Table id or reason (ignored for the switch)
+ * @param stats		Limit and counters
+ */
+afa_result_t fwd_module_of1x_get_packet_in_limit_stats(uint64_t dpid, of1x_pkt_in_limit_scope_t scope, unsigned int id, of1x_pkt_in_limit_stats_t* stats);
+
 /**
  * @name    fwd_module_of1x_process_packet_out
  * @brief   Instructs forward module to process a PACKET_OUT event
  * @ingroup of1x_fwd_module_async_event_processing
+ *
+ * Packets stored with of1x_store_packet_buffer() on packet-in are resolved
+ * with of1x_retrieve_packet_buffer() (O(1), no copy).
  * 
  * @param dpid 		Datapath ID of the switch to process PACKET_OUT
  * @param buffer_id	Buffer ID. 0 or OF1XP_NO_BUFFER and implies no buffer
@@ -207,6 +330,37 @@ afa_result_t fwd_module_of1x_process_flow_mod_delete(uint64_t dpid, uint8_t tabl
  * modified, and MUST be destroyed via of1x_destroy_stats_flow_msg() once used.
  */
 of1x_stats_flow_msg_t* fwd_module_of1x_get_flow_stats(uint64_t dpid, uint8_t table_id, uint32_t cookie, uint32_t cookie_mask, uint32_t out_port, uint32_t out_group, of1x_match_group_t *const matches);
+
+/**
+ * @name    fwd_module_of1x_init_flow_stats_cursor
+ * @brief   Initializes a cursor to recover the flow stats in chunks (see fwd_module_of1x_get_flow_stats_chunk())
+ * @ingroup of1x_fwd_module_async_event_processing
+ *
+ * @param dpid 		Datapath ID of the switch
+ * @param cursor	Cursor to be initialized (owned by the caller)
+ *
+ * Rest of the parameters as in fwd_module_of1x_get_flow_stats(). matches must
+ * be kept by the caller until the cursor is done.
+ */
+afa_result_t fwd_module_of1x_init_flow_stats_cursor(uint64_t dpid, of1x_stats_flow_cursor_t* cursor, uint8_t table_id, uint32_t cookie, uint32_t cookie_mask, uint32_t out_port, uint32_t out_group, of1x_match_group_t *const matches);
+
+/**
+ * @name    fwd_module_of1x_get_flow_stats_chunk
+ * @brief   Recovers the next chunk of flow stats of the cursor 
+ * @ingroup of1x_fwd_module_async_event_processing
+ *
+ * Each chunk is meant to be serialized into a single OpenFlow multipart reply,
+ * setting the MORE flag according to more.
+ *
+ * @param dpid 		Datapath ID of the switch
+ * @param cursor	Cursor initialized via fwd_module_of1x_init_flow_stats_cursor()
+ * @param max_entries	Max number of flows in the chunk
+ * @param more		Set to true if there are more chunks to recover
+ * 
+ * @return A pointer to an of1x_flow_msg_t struct or NULL on error. MUST be destroyed via 
+ * of1x_destroy_stats_flow_msg() once used.
+ */
+of1x_stats_flow_msg_t* fwd_module_of1x_get_flow_stats_chunk(uint64_t dpid, of1x_stats_flow_cursor_t* cursor, unsigned int max_entries, bool* more);
  
 /**
  * @name    fwd_module_of1x_get_flow_aggregate_stats
@@ -280,6 +434,48 @@ of1x_stats_group_msg_t * fwd_module_of1x_get_group_stats(uint64_t dpid, uint32_t
  */
 of1x_stats_group_msg_t * fwd_module_of1x_get_group_all_stats(uint64_t dpid, uint32_t id);
 
+/**
+ * @name    fwd_module_of1x_meter_mod_add
+ * @brief   Instructs driver to add a new METER
+ * @ingroup of1x_fwd_module_async_event_processing
+ *
+ * @param dpid 		Datapath ID of the switch to install the METER
+ * @param id 		Meter id
+ * @param flags 	Bitmap of of1x_meter_flag_t
+ * @param bands 	Band configuration array (copied)
+ * @param num_of_bands 	Number of bands
+ */
+rofl_of1x_mm_result_t fwd_module_of1x_meter_mod_add(uint64_t dpid, uint32_t id, bitmap32_t flags, const of1x_meter_band_config_t* bands, unsigned int num_of_bands);
+
+/**
+ * @name    fwd_module_of1x_meter_mod_modify
+ * @brief   Instructs driver to modify the METER with identification ID
+ * @ingroup of1x_fwd_module_async_event_processing
+ *
+ * @param dpid 		Datapath ID of the switch to modify the METER
+ */
+rofl_of1x_mm_result_t fwd_module_of1x_meter_mod_modify(uint64_t dpid, uint32_t id, bitmap32_t flags, const of1x_meter_band_config_t* bands, unsigned int num_of_bands);
+
+/**
+ * @name    fwd_module_of1x_meter_mod_delete
+ * @brief   Instructs driver to delete the METER with identification ID (and the entries using it)
+ * @ingroup of1x_fwd_module_async_event_processing
+ *
+ * @param dpid 		Datapath ID of the switch to delete the METER
+ * @param id 		Meter id or OF1X_METER_ALL
+ */
+rofl_of1x_mm_result_t fwd_module_of1x_meter_mod_delete(uint64_t dpid, uint32_t id);
+
+/**
+ * @name    fwd_module_of1x_get_meter_stats
+ * @brief   Instructs driver to fetch the METER statistics
+ * @ingroup of1x_fwd_module_async_event_processing
+ *
+ * @param dpid 		Datapath ID of the switch where the METER is
+ * @param id 		Meter id or OF1X_METER_ALL
+ */
+of1x_stats_meter_msg_t * fwd_module_of1x_get_meter_stats(uint64_t dpid, uint32_t id);
+
 //Add more here..
 
 //C++ extern C
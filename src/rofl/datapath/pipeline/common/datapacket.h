@@ -68,6 +68,15 @@ typedef struct datapacket{
 	* (used for multi-output matches)
 	*/
 	bool is_replica;
+
+	/**
+	* Flag indicating that the packet buffer is shared (refcounted) with
+	* at least another datapacket_t (see platform_packet_replicate_shared()).
+	* Set and cleared by the platform. The pipeline guarantees that
+	* platform_packet_make_writable() is called before any header mangling
+	* over a packet with this flag set (copy-on-write).
+	*/
+	bool is_shared;
 	
 	/** 
 	* @brief Platform specific state. 
@@ -0,0 +1,101 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef __PER_CORE_H__
+#define __PER_CORE_H__
+
+#include <stdint.h>
+#include <string.h>
+#include "rofl.h"
+#include "../platform/cutil.h"
+#include "../platform/memory.h"
+
+/**
+* @file per_core.h
+* @brief Per-core state (ROFL_PIPELINE_MAX_CORES elements) aligned to the cache line
+*
+* platform_malloc_shared() does not guarantee any alignment, so elements padded
+* to a cache line could still share lines with the neighbouring cores. Per-core
+* arrays are over-allocated and their base aligned; the pointer obtained from
+* the platform is kept right before the base.
+*/
+
+//Cache line size assumed by the per-core state
+#define ROFL_PIPELINE_CACHE_LINE_SIZE 64
+
+//Allocates a zeroed array of ROFL_PIPELINE_MAX_CORES elements of size bytes
+//(multiple of ROFL_PIPELINE_CACHE_LINE_SIZE), aligned to the cache line
+static inline void* __per_core_alloc(size_t size){
+
+	uint8_t *raw, *base;
+	size_t len = size*ROFL_PIPELINE_MAX_CORES;
+
+	raw = (uint8_t*)platform_malloc_shared(len + sizeof(void*) + ROFL_PIPELINE_CACHE_LINE_SIZE-1);
+	if(!raw)
+		return NULL;
+
+	base = (uint8_t*)( ((uintptr_t)(raw + sizeof(void*)) + ROFL_PIPELINE_CACHE_LINE_SIZE-1) & ~(uintptr_t)(ROFL_PIPELINE_CACHE_LINE_SIZE-1) );
+	((void**)base)[-1] = raw;
+	memset(base, 0, len);
+
+	return base;
+}
+
+//Releases an array allocated with __per_core_alloc()
+static inline void __per_core_free(void* base){
+	if(base)
+		platform_free_shared(((void**)base)[-1]);
+}
+
+//Id of the calling core, in [0, ROFL_PIPELINE_MAX_CORES)
+static inline unsigned int __per_core_id(void){
+
+	unsigned int core_id = platform_get_core_id();
+
+	if(core_id >= ROFL_PIPELINE_MAX_CORES)
+		core_id %= ROFL_PIPELINE_MAX_CORES;
+	return core_id;
+}
+
+/*
+* Read side sections (RCU-like). Objects read lock-free by the datapath are
+* replaced as a whole (pointer swap); every core owns an epoch counter, odd
+* while it is inside a section, so a writer only has to wait for the sections
+* in progress before releasing the object it unpublished. Readers never write
+* shared state.
+*/
+
+//Enters a read side section; epoch is the counter of the calling core
+static inline void __per_core_read_lock(volatile uint64_t* epoch){
+	(*epoch)++;
+	__sync_synchronize(); //Before loading the published pointer
+}
+
+//Leaves a read side section
+static inline void __per_core_read_unlock(volatile uint64_t* epoch){
+	__sync_synchronize(); //Loads of the section done
+	(*epoch)++;
+}
+
+//Waits for the read side sections in progress (grace period). The epoch of
+//core i is at (uint8_t*)epochs + i*stride; called after the new pointer is published
+static inline void __per_core_synchronize(volatile uint64_t* epochs, size_t stride){
+
+	unsigned int i;
+	uint64_t start;
+	volatile uint64_t* epoch;
+
+	__sync_synchronize();
+
+	for(i=0;i<ROFL_PIPELINE_MAX_CORES;i++){
+		epoch = (volatile uint64_t*)((volatile uint8_t*)epochs + i*stride);
+		start = *epoch;
+		if(!(start & 0x1))
+			continue;
+		while(*epoch == start)
+			__sync_synchronize();
+	}
+}
+
+#endif //__PER_CORE_H__
@@ -0,0 +1,300 @@
+#include "slab.h"
+
+#include <stdbool.h>
+#include <string.h>
+#include "../platform/lock.h"
+#include "../platform/memory.h"
+#include "../util/logging.h"
+
+/*
+* Every object is preceded by a header, which contains the class of the
+* object. Free objects are linked through their first word.
+*/
+
+//Header size; keeps 16 byte alignment of the objects
+#define SLAB_HDR_SIZE 16
+
+//Pseudo-classes
+#define SLAB_CLASS_DIRECT 0xFFFFFFFE	/* Too big; allocated straight from the platform */
+#define SLAB_CLASS_UNMANAGED 0xFFFFFFFF	/* Allocated before slab_init() */
+
+typedef struct slab_hdr{
+	uint32_t cls;
+	uint32_t __pad[3];
+}slab_hdr_t;
+
+typedef struct slab_class{
+	size_t obj_size;
+	size_t stride;
+
+	void* free_list;
+	void* pages;
+
+	uint64_t num_of_pages;
+	uint64_t objs_total;
+	uint64_t objs_in_use;
+
+	platform_mutex_t* mutex;
+}slab_class_t;
+
+static const size_t slab_class_sizes[SLAB_NUM_OF_CLASSES] = { 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072, 4096 };
+
+static slab_class_t slab_classes[SLAB_NUM_OF_CLASSES];
+static bool slab_initialized = false;
+
+//Direct allocations
+static uint64_t slab_direct_in_use = 0;
+static platform_mutex_t* slab_direct_mutex = NULL;
+
+#define SLAB_HDR(data) ((slab_hdr_t*)((uint8_t*)(data) - SLAB_HDR_SIZE))
+#define SLAB_NEXT(obj) (*(void**)(obj))
+
+rofl_result_t slab_init(){
+	unsigned int i;
+
+	if(slab_initialized)
+		return ROFL_SUCCESS;
+
+	memset(slab_classes, 0, sizeof(slab_classes));
+
+	for(i=0;i<SLAB_NUM_OF_CLASSES;i++){
+		slab_classes[i].obj_size = slab_class_sizes[i];
+		slab_classes[i].stride = slab_class_sizes[i] + SLAB_HDR_SIZE;
+
+		if( (slab_classes[i].mutex = platform_mutex_init(NULL)) == NULL){
+			for(--i; (int)i>=0; i--)
+				platform_mutex_destroy(slab_classes[i].mutex);
+			return ROFL_FAILURE;
+		}
+	}
+
+	if( (slab_direct_mutex = platform_mutex_init(NULL)) == NULL){
+		for(i=0;i<SLAB_NUM_OF_CLASSES;i++)
+			platform_mutex_destroy(slab_classes[i].mutex);
+		return ROFL_FAILURE;
+	}
+	slab_direct_in_use = 0;
+
+	slab_initialized = true;
+
+	return ROFL_SUCCESS;
+}
+
+void slab_destroy(){
+	unsigned int i;
+	void *page, *next;
+
+	if(!slab_initialized)
+		return;
+
+	//Objects still referenced would be pointing to released pages
+	for(i=0;i<SLAB_NUM_OF_CLASSES;i++){
+		if(slab_classes[i].objs_in_use){
+			ROFL_PIPELINE_WARN("Slab class of %u bytes has %"PRIu64" objects in use; pages will not be released\n", (unsigned int)slab_classes[i].obj_size, slab_classes[i].objs_in_use);
+			return;
+		}
+	}
+
+	slab_initialized = false;
+
+	for(i=0;i<SLAB_NUM_OF_CLASSES;i++){
+		for(page = slab_classes[i].pages; page; page = next){
+			next = SLAB_NEXT(page);
+			platform_free_shared(page);
+		}
+		platform_mutex_destroy(slab_classes[i].mutex);
+	}
+	memset(slab_classes, 0, sizeof(slab_classes));
+
+	//Direct allocations are released one by one; just stop counting
+	platform_mutex_destroy(slab_direct_mutex);
+	slab_direct_mutex = NULL;
+}
+
+void slab_get_stats(slab_stats_t* stats){
+	unsigned int i;
+
+	memset(stats, 0, sizeof(slab_stats_t));
+
+	for(i=0;i<SLAB_NUM_OF_CLASSES;i++){
+		stats->classes[i].obj_size = slab_class_sizes[i];
+
+		if(!slab_initialized)
+			continue;
+
+		platform_mutex_lock(slab_classes[i].mutex);
+		stats->classes[i].num_of_pages = slab_classes[i].num_of_pages;
+		stats->classes[i].objs_total = slab_classes[i].objs_total;
+		stats->classes[i].objs_in_use = slab_classes[i].objs_in_use;
+		platform_mutex_unlock(slab_classes[i].mutex);
+	}
+
+	stats->direct_in_use = slab_direct_in_use;
+}
+
+/*
+* Allocation
+*/
+static inline int __slab_class(size_t length){
+	unsigned int i;
+
+	for(i=0;i<SLAB_NUM_OF_CLASSES;i++){
+		if(length <= slab_class_sizes[i])
+			return i;
+	}
+	return -1;
+}
+
+//Carves a new page into objects (class lock must be held)
+static rofl_result_t __slab_grow(slab_class_t* cls, uint32_t cls_id){
+	uint8_t *page, *obj;
+	size_t offset;
+
+	page = (uint8_t*)platform_malloc_shared(SLAB_PAGE_SIZE);
+	if(!page)
+		return ROFL_FAILURE;
+
+	//The first bytes of the page link the pages of the class
+	SLAB_NEXT(page) = cls->pages;
+	cls->pages = page;
+	cls->num_of_pages++;
+
+	for(offset = SLAB_HDR_SIZE; offset + cls->stride <= SLAB_PAGE_SIZE; offset += cls->stride){
+		obj = page + offset + SLAB_HDR_SIZE;
+		SLAB_HDR(obj)->cls = cls_id;
+		SLAB_NEXT(obj) = cls->free_list;
+		cls->free_list = obj;
+		cls->objs_total++;
+	}
+
+	return ROFL_SUCCESS;
+}
+
+static void* __slab_malloc_platform(size_t length, uint32_t cls_id){
+	uint8_t* obj = (uint8_t*)platform_malloc_shared(length + SLAB_HDR_SIZE);
+
+	if(!obj)
+		return NULL;
+
+	obj += SLAB_HDR_SIZE;
+	SLAB_HDR(obj)->cls = cls_id;
+	return obj;
+}
+
+void* __slab_malloc(size_t length){
+	int cls_id;
+	slab_class_t* cls;
+	void* obj;
+
+	if(!slab_initialized)
+		return __slab_malloc_platform(length, SLAB_CLASS_UNMANAGED);
+
+	if( (cls_id = __slab_class(length)) < 0){
+		if( (obj = __slab_malloc_platform(length, SLAB_CLASS_DIRECT)) != NULL){
+			platform_mutex_lock(slab_direct_mutex);
+			slab_direct_in_use++;
+			platform_mutex_unlock(slab_direct_mutex);
+		}
+		return obj;
+	}
+
+	cls = &slab_classes[cls_id];
+
+	platform_mutex_lock(cls->mutex);
+
+	if(!cls->free_list && __slab_grow(cls, cls_id) != ROFL_SUCCESS){
+		platform_mutex_unlock(cls->mutex);
+		return NULL;
+	}
+
+	obj = cls->free_list;
+	cls->free_list = SLAB_NEXT(obj);
+	cls->objs_in_use++;
+
+	platform_mutex_unlock(cls->mutex);
+
+	return obj;
+}
+
+void __slab_free(void* data){
+	slab_class_t* cls;
+	uint32_t cls_id;
+
+	if(!data)
+		return;
+
+	cls_id = SLAB_HDR(data)->cls;
+
+	switch(cls_id){
+		case SLAB_CLASS_UNMANAGED:
+			platform_free_shared(SLAB_HDR(data));
+			return;
+		case SLAB_CLASS_DIRECT:
+			if(slab_direct_mutex){
+				platform_mutex_lock(slab_direct_mutex);
+				slab_direct_in_use--;
+				platform_mutex_unlock(slab_direct_mutex);
+			}
+			platform_free_shared(SLAB_HDR(data));
+			return;
+		default:
+			break;
+	}
+
+	cls = &slab_classes[cls_id];
+
+	platform_mutex_lock(cls->mutex);
+	SLAB_NEXT(data) = cls->free_list;
+	cls->free_list = data;
+	cls->objs_in_use--;
+	platform_mutex_unlock(cls->mutex);
+}
+
+/*
+* Bulk release
+*/
+void __slab_batch_init(slab_batch_t* batch){
+	memset(batch, 0, sizeof(slab_batch_t));
+}
+
+void __slab_batch_free(slab_batch_t* batch, void* data){
+	uint32_t cls_id;
+
+	if(!data)
+		return;
+
+	cls_id = SLAB_HDR(data)->cls;
+
+	//Platform allocations are released right away
+	if(!batch || cls_id >= SLAB_NUM_OF_CLASSES){
+		__slab_free(data);
+		return;
+	}
+
+	SLAB_NEXT(data) = batch->head[cls_id];
+	batch->head[cls_id] = data;
+	if(!batch->tail[cls_id])
+		batch->tail[cls_id] = data;
+	batch->num_of_objs[cls_id]++;
+}
+
+void __slab_batch_flush(slab_batch_t* batch){
+	unsigned int i;
+	slab_class_t* cls;
+
+	for(i=0;i<SLAB_NUM_OF_CLASSES;i++){
+		if(!batch->num_of_objs[i])
+			continue;
+
+		cls = &slab_classes[i];
+
+		//Splice the whole chain
+		platform_mutex_lock(cls->mutex);
+		SLAB_NEXT(batch->tail[i]) = cls->free_list;
+		cls->free_list = batch->head[i];
+		cls->objs_in_use -= batch->num_of_objs[i];
+		platform_mutex_unlock(cls->mutex);
+	}
+
+	__slab_batch_init(batch);
+}
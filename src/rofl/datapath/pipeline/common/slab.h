@@ -0,0 +1,100 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef __SLAB_H__
+#define __SLAB_H__
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include "rofl.h"
+
+/**
+* @file slab.h
+* @brief Slab allocator for the small, frequently created and destroyed
+* objects of the library (flow entries, matches, ternary fields, actions...)
+*
+* Objects are carved out of pages (SLAB_PAGE_SIZE) obtained through
+* platform_malloc_shared() and recycled through per size class free lists.
+* Pages are only returned to the platform on slab_destroy().
+*
+* Objects can be released one by one (__slab_free()) or in bulk through a
+* slab_batch_t, which returns all the objects of a class taking the class
+* lock only once.
+*
+* Before slab_init() (and after slab_destroy()) the allocator falls back to
+* platform_malloc_shared()/platform_free_shared().
+*/
+
+//Number of size classes
+#define SLAB_NUM_OF_CLASSES 14
+
+//Size of the pages requested to the platform
+#define SLAB_PAGE_SIZE (64*1024)
+
+/**
+* @ingroup core
+* Occupancy statistics of a size class
+*/
+typedef struct slab_class_stats{
+	size_t obj_size;	/* Max size of the objects of the class */
+	uint64_t num_of_pages;	/* Pages allocated */
+	uint64_t objs_total;	/* Objects carved (free + in use) */
+	uint64_t objs_in_use;	/* Objects in use */
+}slab_class_stats_t;
+
+/**
+* @ingroup core
+* Slab allocator statistics
+*/
+typedef struct slab_stats{
+	slab_class_stats_t classes[SLAB_NUM_OF_CLASSES];
+
+	//Objects allocated straight from the platform (too big or slab not initialized)
+	uint64_t direct_in_use;
+}slab_stats_t;
+
+/**
+* Batch of objects to be released together (see __slab_batch_flush())
+*/
+typedef struct slab_batch{
+	void* head[SLAB_NUM_OF_CLASSES];
+	void* tail[SLAB_NUM_OF_CLASSES];
+	unsigned int num_of_objs[SLAB_NUM_OF_CLASSES];
+}slab_batch_t;
+
+//C++ extern C
+ROFL_BEGIN_DECLS
+
+/**
+* @brief Initializes the slab allocator. Called by physical_switch_init()
+* @ingroup mgmt
+*/
+rofl_result_t slab_init(void);
+
+/**
+* @brief Releases the slab pages. Pages are kept if there are objects in use.
+* Called by physical_switch_destroy()
+* @ingroup mgmt
+*/
+void slab_destroy(void);
+
+/**
+* @brief Fills in the occupancy statistics of the slab allocator
+* @ingroup mgmt
+*/
+void slab_get_stats(slab_stats_t* stats);
+
+//Allocate and release
+void* __slab_malloc(size_t length);
+void __slab_free(void* data);
+
+//Bulk release
+void __slab_batch_init(slab_batch_t* batch);
+void __slab_batch_free(slab_batch_t* batch, void* data); //batch may be NULL (immediate release)
+void __slab_batch_flush(slab_batch_t* batch);
+
+//C++ extern C
+ROFL_END_DECLS
+
+#endif //__SLAB_H__
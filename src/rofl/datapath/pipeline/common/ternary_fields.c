@@ -2,14 +2,14 @@
 
 #include <assert.h>
 
-#include "../platform/memory.h"
+#include "slab.h"
 #include <rofl/datapath/pipeline/common/ternary_fields.h>
 
 /*
 * Initializers
 */
 inline utern_t* __init_utern8(uint8_t value, uint8_t mask){
-	utern_t* tern = (utern_t*)platform_malloc_shared(sizeof(utern_t));
+	utern_t* tern = (utern_t*)__slab_malloc(sizeof(utern_t));
 
 	if(!tern)
 		return NULL;
@@ -20,7 +20,7 @@ inline utern_t* __init_utern8(uint8_t value, uint8_t mask){
 	return (utern_t*)tern;
 }
 inline utern_t* __init_utern16(uint16_t value, uint16_t mask){
-	utern_t* tern = (utern_t*)platform_malloc_shared(sizeof(utern_t));
+	utern_t* tern = (utern_t*)__slab_malloc(sizeof(utern_t));
 
 	if(!tern)
 		return NULL;
@@ -31,7 +31,7 @@ inline utern_t* __init_utern16(uint16_t value, uint16_t mask){
 	return (utern_t*)tern;
 }
 inline utern_t* __init_utern32(uint32_t value, uint32_t mask){
-	utern_t* tern = (utern_t*)platform_malloc_shared(sizeof(utern_t));
+	utern_t* tern = (utern_t*)__slab_malloc(sizeof(utern_t));
 
 	if(!tern)
 		return NULL;
@@ -42,7 +42,7 @@ inline utern_t* __init_utern32(uint32_t value, uint32_t mask){
 	return (utern_t*)tern;
 }
 inline utern_t* __init_utern64(uint64_t value, uint64_t mask){
-	utern_t* tern = (utern_t*)platform_malloc_shared(sizeof(utern_t));
+	utern_t* tern = (utern_t*)__slab_malloc(sizeof(utern_t));
 
 	if(!tern)
 		return NULL;
@@ -53,7 +53,7 @@ inline utern_t* __init_utern64(uint64_t value, uint64_t mask){
 	return (utern_t*)tern;
 }
 inline utern_t* __init_utern128(uint128__t value, uint128__t mask){ //uint128_t funny!
-	utern_t* tern = (utern_t*)platform_malloc_shared(sizeof(utern_t));
+	utern_t* tern = (utern_t*)__slab_malloc(sizeof(utern_t));
 	
 	if(!tern)
 		return NULL;
@@ -68,11 +68,14 @@ inline utern_t* __init_utern128(uint128__t value, uint128__t mask){ //uint128_t
 * Single destructor
 */
 rofl_result_t __destroy_utern(utern_t* utern){
-	platform_free_shared(utern);
-	//FIXME: maybe check returning value
-	return ROFL_SUCCESS; 
+	return __destroy_utern_batch(utern, NULL);
 }	
 
+rofl_result_t __destroy_utern_batch(utern_t* utern, slab_batch_t* batch){
+	__slab_batch_free(batch, utern);
+	return ROFL_SUCCESS;
+}
+
 
 /*
 * Comparison 
@@ -10,6 +10,7 @@
 #include <stdbool.h>
 #include "rofl.h"
 #include "wrap_types.h"
+#include "slab.h"
 
 /**
 * @author Marc Sune<marc.sune (at) bisdn.de>
@@ -51,6 +52,7 @@ utern_t* __init_utern128(uint128__t value, uint128__t mask);
 
 //Destructor
 rofl_result_t __destroy_utern(utern_t* utern );
+rofl_result_t __destroy_utern_batch(utern_t* utern, slab_batch_t* batch);
 
 //Comparison
 bool __utern_compare8(const utern_t* tern, const uint8_t value);
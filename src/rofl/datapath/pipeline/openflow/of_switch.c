@@ -1,5 +1,6 @@
 #include "of_switch.h"
 #include "../common/datapacket.h"
+#include "../virtual_link.h"
 
 //OpenFlow specific switch implementations 
 #include "openflow1x/of1x_switch.h"
@@ -35,7 +36,7 @@ rofl_result_t of_reconfigure_switch(of_switch_t* sw, of_version_t version){
 
 
 //Wrapping of processing
-rofl_result_t of_process_packet_pipeline(const of_switch_t* sw, datapacket_t *const pkt){
+static inline rofl_result_t __of_process_packet_pipeline(const of_switch_t* sw, datapacket_t *const pkt){
 	
 	switch(sw->of_ver){
 		case OF_VERSION_10: 
@@ -50,6 +51,22 @@ rofl_result_t of_process_packet_pipeline(const of_switch_t* sw, datapacket_t *co
 	return ROFL_SUCCESS;
 }	
 
+rofl_result_t of_process_packet_pipeline(const of_switch_t* sw, datapacket_t *const pkt){
+
+	rofl_result_t res;
+	virtual_link_core_t* vlink_core;
+
+	if(!__virtual_link_cores)
+		return __of_process_packet_pipeline(sw, pkt);
+
+	//Packets sent through virtual links are processed afterwards
+	vlink_core = __virtual_link_enter();
+	res = __of_process_packet_pipeline(sw, pkt);
+	__virtual_link_leave(vlink_core);
+
+	return res;
+}
+
 //Wrapping of timers processing
 void of_process_pipeline_tables_timeout_expirations(const of_switch_t* sw){
 	
@@ -121,6 +138,18 @@ rofl_result_t __of_detach_all_ports_from_switch(of_switch_t* sw){
 	}
 }
 
+void __of_update_port_liveness(of_switch_t* sw, switch_port_t* port){
+	switch(sw->of_ver){
+		case OF_VERSION_10: 
+		case OF_VERSION_12: 
+		case OF_VERSION_13: 
+			__of1x_update_port_liveness((of1x_switch_t*)sw, port);
+			break;
+		default: 
+			break;
+	}
+}
+
 rofl_result_t of_get_switch_matching_algorithms(of_version_t of_version, const char * const** name_list, int *count){
 
 	switch (of_version) {
@@ -137,6 +137,8 @@ rofl_result_t __of_attach_port_to_switch(of_switch_t* sw, switch_port_t* port, u
 rofl_result_t __of_detach_port_from_switch_by_port_num(of_switch_t* sw, unsigned int port_num);
 rofl_result_t __of_detach_port_from_switch(of_switch_t* sw, switch_port_t* port);
 rofl_result_t __of_detach_all_ports_from_switch(of_switch_t* sw);
+//Port state or config changed (liveness, flood/all port sets)
+void __of_update_port_liveness(of_switch_t* sw, switch_port_t* port);
 
 /**
 * @brief Retrieves the list of available matching algorithms available for OF version of_version. 
@@ -30,6 +30,14 @@ of1x_switch_t* of1x_init_switch(const char* name, of_version_t version, uint64_t
 	
 	//Initialize platform state to NULL
 	sw->platform_state=NULL;
+
+	//No ports, no liveness
+	memset(sw->port_liveness,0,sizeof(sw->port_liveness));
+
+	//Empty port sets
+	memset(sw->port_sets,0,sizeof(sw->port_sets));
+	sw->flood_set = &sw->port_sets[0][0];
+	sw->all_set = &sw->port_sets[1][0];
 	
 	//Mutex
 	if(NULL == (sw->mutex = platform_mutex_init(NULL))){
@@ -54,6 +62,14 @@ of1x_switch_t* of1x_init_switch(const char* name, of_version_t version, uint64_t
 		return NULL;
 	}
 
+	//Packet buffers, as set by the platform
+	if(sw->pipeline->num_of_buffers && __of1x_init_buffer_pool(sw->pipeline) != ROFL_SUCCESS){
+		__of1x_destroy_pipeline(sw->pipeline);
+		platform_free_shared(sw->name);
+		platform_free_shared(sw);
+		return NULL;
+	}
+
 	return sw;
 }
 
@@ -102,6 +118,79 @@ rofl_result_t __of1x_reconfigure_switch(of1x_switch_t* sw, of_version_t version)
 	return ROFL_SUCCESS; 
 }
 
+/* Port liveness; switch mutex must be held */
+static void __of1x_set_port_liveness(of1x_switch_t* sw, unsigned int port_num, bool live){
+
+	//Atomic read-modify-write of the word (the other bits are left untouched)
+	if(live)
+		__sync_fetch_and_or(&sw->port_liveness[port_num/32], 1U << (port_num%32));
+	else
+		__sync_fetch_and_and(&sw->port_liveness[port_num/32], ~(1U << (port_num%32)));
+}
+
+/* Port sets; switch mutex must be held */
+static void __of1x_rebuild_port_sets(of1x_switch_t* sw){
+
+	unsigned int i;
+	switch_port_t* port;
+	of1x_port_set_t* flood = (sw->flood_set == &sw->port_sets[0][0])? &sw->port_sets[0][1] : &sw->port_sets[0][0];
+	of1x_port_set_t* all = (sw->all_set == &sw->port_sets[1][0])? &sw->port_sets[1][1] : &sw->port_sets[1][0];
+
+	//Readers still on the spare sets (previous generation) will retry
+	flood->seq++;
+	all->seq++;
+	__sync_synchronize();
+
+	memset(flood->bitmap, 0, sizeof(flood->bitmap));
+	memset(all->bitmap, 0, sizeof(all->bitmap));
+	flood->num_of_ports = all->num_of_ports = 0;
+
+	for(i=1;i<LOGICAL_SWITCH_MAX_LOG_PORTS;i++){
+		port = sw->logical_ports[i].port;
+
+		if(!port || sw->logical_ports[i].attachment_state != LOGICAL_PORT_STATE_ATTACHED)
+			continue;
+		if(!port->forward_packets || !switch_port_is_live(port))
+			continue;
+
+		all->bitmap[i/32] |= 1U << (i%32);
+		all->port_nums[all->num_of_ports++] = i;
+
+		if(port->no_flood)
+			continue;
+
+		flood->bitmap[i/32] |= 1U << (i%32);
+		flood->port_nums[flood->num_of_ports++] = i;
+	}
+
+	__sync_synchronize();
+	flood->seq++;
+	all->seq++;
+
+	//Publish
+	sw->flood_set = flood;
+	sw->all_set = all;
+}
+
+void __of1x_update_port_sets(of1x_switch_t* sw){
+	platform_mutex_lock(sw->mutex);
+	__of1x_rebuild_port_sets(sw);
+	platform_mutex_unlock(sw->mutex);
+}
+
+void __of1x_update_port_liveness(of1x_switch_t* sw, switch_port_t* port){
+	
+	platform_mutex_lock(sw->mutex);
+	
+	//Port may have been detached in the meantime
+	if(port->of_port_num && port->of_port_num < LOGICAL_SWITCH_MAX_LOG_PORTS && sw->logical_ports[port->of_port_num].port == port){
+		__of1x_set_port_liveness(sw, port->of_port_num, switch_port_is_live(port));
+		__of1x_rebuild_port_sets(sw);
+	}
+
+	platform_mutex_unlock(sw->mutex);
+}
+
 /* Port management */
 rofl_result_t __of1x_attach_port_to_switch_at_port_num(of1x_switch_t* sw, unsigned int port_num, switch_port_t* port){
 
@@ -124,6 +213,8 @@ rofl_result_t __of1x_attach_port_to_switch_at_port_num(of1x_switch_t* sw, unsign
 	//Initialize also port structure
 	port->attached_sw = (of_switch_t*)sw;
 	port->of_port_num = port_num; 
+	__of1x_set_port_liveness(sw, port_num, switch_port_is_live(port));
+	__of1x_rebuild_port_sets(sw);
 
 	//Return success
 	platform_mutex_unlock(sw->mutex);
@@ -150,6 +241,8 @@ rofl_result_t __of1x_attach_port_to_switch(of1x_switch_t* sw, switch_port_t* por
 			//Initialize port
 			port->attached_sw = (of_switch_t*)sw;
 			port->of_port_num = i; 
+			__of1x_set_port_liveness(sw, i, switch_port_is_live(port));
+			__of1x_rebuild_port_sets(sw);
 				
 			//Return success
 			platform_mutex_unlock(sw->mutex);
@@ -176,12 +269,14 @@ rofl_result_t __of1x_detach_port_from_switch_by_port_num(of1x_switch_t* sw, unsi
 	}
 	
 	//Free port
+	__of1x_set_port_liveness(sw, port_num, false);
 	sw->logical_ports[port_num].port->attached_sw = NULL;
 	sw->logical_ports[port_num].port->of_port_num = 0;
 
 	sw->logical_ports[port_num].attachment_state = LOGICAL_PORT_STATE_DETACHED;
 	sw->logical_ports[port_num].port = NULL;
 	sw->num_of_ports--;
+	__of1x_rebuild_port_sets(sw);
 	
 	//return success
 	platform_mutex_unlock(sw->mutex);
@@ -202,6 +297,7 @@ rofl_result_t __of1x_detach_port_from_switch(of1x_switch_t* sw, switch_port_t* p
 		if(sw->logical_ports[i].port == port){
 			
 			//Free port
+			__of1x_set_port_liveness(sw, i, false);
 			sw->logical_ports[i].port->attached_sw = NULL;
 			sw->logical_ports[i].port->of_port_num = 0;
 
@@ -209,6 +305,7 @@ rofl_result_t __of1x_detach_port_from_switch(of1x_switch_t* sw, switch_port_t* p
 			sw->logical_ports[i].attachment_state = LOGICAL_PORT_STATE_DETACHED;
 			sw->logical_ports[i].port = NULL;
 			sw->num_of_ports--;
+			__of1x_rebuild_port_sets(sw);
 
 			platform_mutex_unlock(sw->mutex);
 			return ROFL_SUCCESS;
@@ -237,6 +334,8 @@ rofl_result_t __of1x_detach_all_ports_from_switch(of1x_switch_t* sw){
 		sw->logical_ports[i].attachment_state = LOGICAL_PORT_STATE_DETACHED;
 		sw->logical_ports[i].port = NULL;
 	}	
+	memset(sw->port_liveness,0,sizeof(sw->port_liveness));
+	__of1x_rebuild_port_sets(sw);
 	
 	//Not found 
 	platform_mutex_unlock(sw->mutex);
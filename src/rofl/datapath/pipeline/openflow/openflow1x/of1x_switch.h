@@ -23,6 +23,21 @@
 
 #define OF1XP_NO_BUFFER	0xffffffff
 
+//Number of words of the port liveness bitmap
+#define OF1X_PORT_LIVENESS_WORDS ((LOGICAL_SWITCH_MAX_LOG_PORTS+31)/32)
+
+/**
+* @ingroup core_of1x
+* Set of output ports of OF1X_PORT_FLOOD or OF1X_PORT_ALL: a bitmap and a
+* dense array, both indexed/filled with OF port numbers
+*/
+typedef struct of1x_port_set{
+	volatile uint32_t seq;		//Odd while being rebuilt; see of1x_port_set_read()
+	bitmap32_t bitmap[OF1X_PORT_LIVENESS_WORDS];
+	unsigned int num_of_ports;
+	uint32_t port_nums[LOGICAL_SWITCH_MAX_LOG_PORTS];
+}of1x_port_set_t;
+
 /**
 * @ingroup core_of1x 
 * OpenFlow-enabled v1.0, 1.2 and 1.3.2 switch abstraction
@@ -51,6 +66,18 @@ typedef struct of1x_switch{
 	//Mutex
 	platform_mutex_t* mutex;
 
+	//Port liveness bitmap, indexed by OF port number. Written atomically
+	//with the switch mutex held, read lock-less in the packet path
+	bitmap32_t port_liveness[OF1X_PORT_LIVENESS_WORDS];
+
+	//Flood and all port sets. Rebuilt (switch mutex held) in the spare
+	//buffer on every port attachment, config or state change, and
+	//published by swapping the pointer. A reader may still be on the
+	//spare buffer (two rebuilds), hence the sequence of the sets
+	of1x_port_set_t* volatile flood_set;
+	of1x_port_set_t* volatile all_set;
+	of1x_port_set_t port_sets[2][2];
+
 }of1x_switch_t;
 
 //C++ extern C
@@ -81,6 +108,69 @@ rofl_result_t __of1x_detach_port_from_switch_by_port_num(of1x_switch_t* sw, unsi
 rofl_result_t __of1x_detach_port_from_switch(of1x_switch_t* sw, switch_port_t* port);
 rofl_result_t __of1x_detach_all_ports_from_switch(of1x_switch_t* sw);
 
+/* Port liveness */
+void __of1x_update_port_liveness(of1x_switch_t* sw, switch_port_t* port);
+
+//Lock-less liveness check (packet path)
+static inline bool __of1x_is_port_live(const of1x_switch_t* sw, uint32_t port_num){
+	if(port_num >= LOGICAL_SWITCH_MAX_LOG_PORTS)
+		return false;
+	return ( sw->port_liveness[port_num/32] & (1U << (port_num%32)) ) != 0;
+}
+
+/* Port sets */
+void __of1x_update_port_sets(of1x_switch_t* sw);
+
+/**
+* @brief Ports where OF1X_PORT_FLOOD packets are sent: attached, live, forwarding
+* and not flagged no_flood. Lock-less; the set must not be cached (ports: of1x_port_set_read())
+* @ingroup core_of1x
+*/
+static inline const of1x_port_set_t* of1x_get_flood_port_set(const of1x_switch_t* sw){
+	return sw->flood_set;
+}
+
+/**
+* @brief Ports where OF1X_PORT_ALL packets are sent: attached, live and forwarding.
+* Lock-less; the set must not be cached (ports: of1x_port_set_read())
+* @ingroup core_of1x
+*/
+static inline const of1x_port_set_t* of1x_get_all_port_set(const of1x_switch_t* sw){
+	return sw->all_set;
+}
+
+/**
+* @brief Copies the port numbers of a set (lock-less). The copy is consistent:
+* it is retried if the set is rebuilt meanwhile
+* @ingroup core_of1x
+* @param port_nums Array of LOGICAL_SWITCH_MAX_LOG_PORTS elements
+* @return number of ports
+*/
+static inline unsigned int of1x_port_set_read(const of1x_port_set_t* set, uint32_t* port_nums){
+	unsigned int i, num_of_ports;
+	uint32_t seq;
+
+	do{
+		while((seq = set->seq) & 0x1);
+		__sync_synchronize();
+
+		num_of_ports = set->num_of_ports;
+		for(i=0;i<num_of_ports;i++)
+			port_nums[i] = set->port_nums[i];
+
+		__sync_synchronize();
+	}while(set->seq != seq);
+
+	return num_of_ports;
+}
+
+//Lock-less membership check
+static inline bool of1x_port_set_contains(const of1x_port_set_t* set, uint32_t port_num){
+	if(port_num >= LOGICAL_SWITCH_MAX_LOG_PORTS)
+		return false;
+	return ( set->bitmap[port_num/32] & (1U << (port_num%32)) ) != 0;
+}
+
 /* Dump */
 /**
 * @brief Dumps the OpenFlow v1.0, 1.2 and 1.3.2 forwarding instance, for debugging purposes.  
@@ -0,0 +1,867 @@
+#include "of1x_adaptive_match.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "../../of1x_pipeline.h"
+#include "../../of1x_flow_table.h"
+#include "../../of1x_flow_entry.h"
+#include "../../of1x_match.h"
+#include "../../../../../common/slab.h"
+#include "../../../../../platform/lock.h"
+#include "../../../../../platform/memory.h"
+#include "../../../../../util/logging.h"
+#include "../matching_algorithms.h"
+#include "../loop/of1x_loop_match.h"
+
+#define ADAPTIVE_DESCRIPTION "The adaptive algorithm keeps the loop list, and looks up entries linearly, in a hash table (exact match), in per prefix length hash tables (LPM) or in per mask shape hash tables (tuple space), depending on the masks of the installed entries"
+
+//Initial number of buckets of a shape (power of 2)
+#define ADAPTIVE_MIN_BUCKETS 16
+
+/*
+* Mask shape: fields (sorted by type) and masks. 128 bit values are
+* handled as hi/lo words; smaller ones only use lo.
+*/
+typedef struct of1x_adaptive_field{
+	of1x_match_type_t type;
+	uint64_t mask_hi;
+	uint64_t mask_lo;
+	bool exact;
+}of1x_adaptive_field_t;
+
+typedef struct of1x_adaptive_node{
+	of1x_flow_entry_t* entry;
+	uint32_t hash;
+	struct of1x_adaptive_node* next;
+}of1x_adaptive_node_t;
+
+typedef struct of1x_adaptive_shape{
+	unsigned int num_of_fields;
+	of1x_adaptive_field_t fields[OF1X_ADAPTIVE_MAX_SHAPE_FIELDS];
+
+	uint32_t num_of_entries;
+	uint32_t max_priority; //Upper bound of the priority of the entries
+
+	//Hash index; only when the table is indexed
+	of1x_adaptive_node_t** buckets;
+	uint32_t num_of_buckets;
+
+	//Sorted by max_priority (desc)
+	struct of1x_adaptive_shape* next;
+}of1x_adaptive_shape_t;
+
+typedef struct of1x_adaptive_state{
+	of1x_adaptive_strategy_t strategy;
+
+	of1x_adaptive_shape_t* shapes;
+	unsigned int num_of_shapes;
+
+	//Entries which cannot be hashed; the list only when indexed (loop order)
+	unsigned int num_of_residual;
+	of1x_adaptive_node_t* residual;
+
+	//The index could not be kept up to date (out of memory); rebuild
+	bool degraded;
+
+	uint64_t num_of_rebuilds;
+	uint64_t num_of_switches;
+}of1x_adaptive_state_t;
+
+//fwd decl
+static const of1x_loop_index_ops_t of1x_adaptive_ops;
+
+/*
+* Fields
+*/
+static inline bool __of1x_adaptive_field_hashable(of1x_match_type_t type){
+	switch(type){
+		case OF1X_MATCH_IN_PORT:
+		case OF1X_MATCH_METADATA:
+		case OF1X_MATCH_ETH_DST:
+		case OF1X_MATCH_ETH_SRC:
+		case OF1X_MATCH_ETH_TYPE:
+		case OF1X_MATCH_IP_PROTO:
+		case OF1X_MATCH_IPV4_SRC:
+		case OF1X_MATCH_IPV4_DST:
+		case OF1X_MATCH_TCP_SRC:
+		case OF1X_MATCH_TCP_DST:
+		case OF1X_MATCH_UDP_SRC:
+		case OF1X_MATCH_UDP_DST:
+		case OF1X_MATCH_IPV6_SRC:
+		case OF1X_MATCH_IPV6_DST:
+		case OF1X_MATCH_TUNNEL_ID:
+			return true;
+		default:
+			return false;
+	}
+}
+
+//Value of the field compared by __of1x_check_match(); only for hashable fields
+static inline void __of1x_adaptive_pkt_field(const of1x_packet_matches_t* pkt, of1x_match_type_t type, uint64_t* hi, uint64_t* lo){
+	*hi = 0;
+	switch(type){
+		case OF1X_MATCH_IN_PORT: *lo = pkt->port_in; break;
+		case OF1X_MATCH_METADATA: *lo = pkt->metadata; break;
+		case OF1X_MATCH_ETH_DST: *lo = pkt->eth_dst; break;
+		case OF1X_MATCH_ETH_SRC: *lo = pkt->eth_src; break;
+		case OF1X_MATCH_ETH_TYPE: *lo = pkt->eth_type; break;
+		case OF1X_MATCH_IP_PROTO: *lo = pkt->ip_proto; break;
+		case OF1X_MATCH_IPV4_SRC: *lo = pkt->ipv4_src; break;
+		case OF1X_MATCH_IPV4_DST: *lo = pkt->ipv4_dst; break;
+		case OF1X_MATCH_TCP_SRC: *lo = pkt->tcp_src; break;
+		case OF1X_MATCH_TCP_DST: *lo = pkt->tcp_dst; break;
+		case OF1X_MATCH_UDP_SRC: *lo = pkt->udp_src; break;
+		case OF1X_MATCH_UDP_DST: *lo = pkt->udp_dst; break;
+		case OF1X_MATCH_IPV6_SRC: *hi = UINT128__T_HI(pkt->ipv6_src); *lo = UINT128__T_LO(pkt->ipv6_src); break;
+		case OF1X_MATCH_IPV6_DST: *hi = UINT128__T_HI(pkt->ipv6_dst); *lo = UINT128__T_LO(pkt->ipv6_dst); break;
+		case OF1X_MATCH_TUNNEL_ID: *lo = pkt->tunnel_id; break;
+		default: *lo = 0; break;
+	}
+}
+
+static inline void __of1x_adaptive_utern_words(const utern_t* tern, const wrap_uint_t* w, uint64_t* hi, uint64_t* lo){
+	*hi = 0;
+	switch(tern->type){
+		case UTERN8_T: *lo = w->u8; break;
+		case UTERN16_T: *lo = w->u16; break;
+		case UTERN32_T: *lo = w->u32; break;
+		case UTERN64_T: *lo = w->u64; break;
+		case UTERN128_T: *hi = UINT128__T_HI(w->u128); *lo = UINT128__T_LO(w->u128); break;
+		default: *lo = 0; break;
+	}
+}
+
+static inline bool __of1x_adaptive_mask_exact(const utern_t* tern, uint64_t hi, uint64_t lo){
+	switch(tern->type){
+		case UTERN8_T: return lo == 0xFFULL;
+		case UTERN16_T: return lo == 0xFFFFULL;
+		case UTERN32_T: return lo == 0xFFFFFFFFULL;
+		case UTERN64_T: return lo == 0xFFFFFFFFFFFFFFFFULL || lo == 0xFFFFFFFFFFFFULL; //MACs
+		case UTERN128_T: return hi == 0xFFFFFFFFFFFFFFFFULL && lo == 0xFFFFFFFFFFFFFFFFULL;
+		default: return false;
+	}
+}
+
+/*
+* Shapes and hashing
+*/
+
+//Fills in the shape of the entry. Returns false if the entry cannot be hashed
+static bool __of1x_adaptive_get_shape(of1x_flow_entry_t* entry, of1x_adaptive_field_t* fields, unsigned int* num_of_fields){
+	of1x_match_t* it;
+	unsigned int i, n = 0;
+	of1x_adaptive_field_t field;
+
+	if(entry->matches.num_elements > OF1X_ADAPTIVE_MAX_SHAPE_FIELDS)
+		return false;
+
+	for(it = entry->matches.head; it; it = it->next){
+		if(!__of1x_adaptive_field_hashable(it->type))
+			return false;
+
+		field.type = it->type;
+		__of1x_adaptive_utern_words(it->value, &it->value->mask, &field.mask_hi, &field.mask_lo);
+		field.exact = __of1x_adaptive_mask_exact(it->value, field.mask_hi, field.mask_lo);
+
+		//Insert sorted by type
+		for(i = n; i > 0 && fields[i-1].type > field.type; i--)
+			fields[i] = fields[i-1];
+		fields[i] = field;
+		n++;
+	}
+
+	*num_of_fields = n;
+	return true;
+}
+
+static inline bool __of1x_adaptive_shape_equals(const of1x_adaptive_shape_t* shape, const of1x_adaptive_field_t* fields, unsigned int num_of_fields){
+	unsigned int i;
+
+	if(shape->num_of_fields != num_of_fields)
+		return false;
+
+	for(i = 0; i < num_of_fields; i++){
+		if(shape->fields[i].type != fields[i].type || shape->fields[i].mask_hi != fields[i].mask_hi || shape->fields[i].mask_lo != fields[i].mask_lo)
+			return false;
+	}
+	return true;
+}
+
+static inline of1x_adaptive_shape_t* __of1x_adaptive_find_shape(of1x_adaptive_state_t* state, const of1x_adaptive_field_t* fields, unsigned int num_of_fields){
+	of1x_adaptive_shape_t* shape;
+
+	for(shape = state->shapes; shape; shape = shape->next){
+		if(__of1x_adaptive_shape_equals(shape, fields, num_of_fields))
+			return shape;
+	}
+	return NULL;
+}
+
+static inline uint64_t __of1x_adaptive_mix(uint64_t h){
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	return h;
+}
+
+static inline uint32_t __of1x_adaptive_hash_pkt(const of1x_adaptive_shape_t* shape, const of1x_packet_matches_t* pkt){
+	unsigned int i;
+	uint64_t h = shape->num_of_fields, hi, lo;
+
+	for(i = 0; i < shape->num_of_fields; i++){
+		__of1x_adaptive_pkt_field(pkt, shape->fields[i].type, &hi, &lo);
+		h = __of1x_adaptive_mix(h ^ (hi & shape->fields[i].mask_hi));
+		h = __of1x_adaptive_mix(h ^ (lo & shape->fields[i].mask_lo));
+	}
+	return (uint32_t)(h ^ (h >> 32));
+}
+
+static uint32_t __of1x_adaptive_hash_entry(const of1x_adaptive_shape_t* shape, of1x_flow_entry_t* entry){
+	unsigned int i;
+	uint64_t h = shape->num_of_fields, hi = 0, lo = 0;
+	of1x_match_t* it;
+
+	for(i = 0; i < shape->num_of_fields; i++){
+		for(it = entry->matches.head; it; it = it->next){
+			if(it->type == shape->fields[i].type){
+				__of1x_adaptive_utern_words(it->value, &it->value->value, &hi, &lo);
+				break;
+			}
+		}
+		h = __of1x_adaptive_mix(h ^ (hi & shape->fields[i].mask_hi));
+		h = __of1x_adaptive_mix(h ^ (lo & shape->fields[i].mask_lo));
+	}
+	return (uint32_t)(h ^ (h >> 32));
+}
+
+//Same order as the loop list (priority, then number of matches)
+static inline bool __of1x_adaptive_precedes(of1x_flow_entry_t* entry, of1x_flow_entry_t* other){
+	return entry->priority > other->priority || (entry->priority == other->priority && entry->matches.num_elements > other->matches.num_elements);
+}
+
+//Keeps the shapes sorted by max_priority
+static void __of1x_adaptive_sort_shape(of1x_adaptive_state_t* state, of1x_adaptive_shape_t* shape){
+	of1x_adaptive_shape_t **it;
+
+	//Unlink
+	for(it = &state->shapes; *it && *it != shape; it = &(*it)->next);
+	if(*it)
+		*it = shape->next;
+
+	//Insert
+	for(it = &state->shapes; *it && (*it)->max_priority >= shape->max_priority; it = &(*it)->next);
+	shape->next = *it;
+	*it = shape;
+}
+
+/*
+* State
+*/
+static void __of1x_adaptive_free_index(of1x_adaptive_shape_t* shape){
+	uint32_t i;
+	of1x_adaptive_node_t *node, *next;
+
+	if(!shape->buckets)
+		return;
+
+	for(i = 0; i < shape->num_of_buckets; i++){
+		for(node = shape->buckets[i]; node; node = next){
+			next = node->next;
+			__slab_free(node);
+		}
+	}
+	platform_free_shared(shape->buckets);
+	shape->buckets = NULL;
+	shape->num_of_buckets = 0;
+}
+
+static void __of1x_adaptive_destroy_state(of1x_adaptive_state_t* state){
+	of1x_adaptive_shape_t *shape, *next_shape;
+	of1x_adaptive_node_t *node, *next;
+
+	if(!state)
+		return;
+
+	for(shape = state->shapes; shape; shape = next_shape){
+		next_shape = shape->next;
+		__of1x_adaptive_free_index(shape);
+		__slab_free(shape);
+	}
+
+	for(node = state->residual; node; node = next){
+		next = node->next;
+		__slab_free(node);
+	}
+
+	platform_free_shared(state);
+}
+
+static of1x_adaptive_state_t* __of1x_adaptive_init_state(void){
+	of1x_adaptive_state_t* state = (of1x_adaptive_state_t*)platform_malloc_shared(sizeof(of1x_adaptive_state_t));
+
+	if(!state)
+		return NULL;
+
+	memset(state, 0, sizeof(of1x_adaptive_state_t));
+	state->strategy = OF1X_ADAPTIVE_LINEAR;
+	return state;
+}
+
+static of1x_adaptive_strategy_t __of1x_adaptive_choose(of1x_adaptive_state_t* state, unsigned int num_of_entries){
+	of1x_adaptive_shape_t* shape;
+	bool exact, single_field;
+
+	//Hysteresis
+	if(state->strategy == OF1X_ADAPTIVE_LINEAR && num_of_entries < OF1X_ADAPTIVE_INDEX_MIN_ENTRIES)
+		return OF1X_ADAPTIVE_LINEAR;
+	if(state->strategy != OF1X_ADAPTIVE_LINEAR && num_of_entries < OF1X_ADAPTIVE_LINEAR_MAX_ENTRIES)
+		return OF1X_ADAPTIVE_LINEAR;
+
+	if(!state->num_of_shapes || state->num_of_shapes > OF1X_ADAPTIVE_MAX_SHAPES)
+		return OF1X_ADAPTIVE_LINEAR;
+	if(state->num_of_residual > (num_of_entries >> OF1X_ADAPTIVE_MAX_RESIDUAL_SHIFT))
+		return OF1X_ADAPTIVE_LINEAR;
+
+	if(state->num_of_residual)
+		return OF1X_ADAPTIVE_TUPLE;
+
+	shape = state->shapes;
+	if(state->num_of_shapes == 1){
+		unsigned int i;
+		exact = true;
+		for(i = 0; i < shape->num_of_fields; i++)
+			exact &= shape->fields[i].exact;
+		if(exact)
+			return OF1X_ADAPTIVE_EXACT;
+	}
+
+	//All the shapes on the same single field (different prefixes)
+	single_field = true;
+	for(; shape; shape = shape->next){
+		if(shape->num_of_fields != 1 || shape->fields[0].type != state->shapes->fields[0].type){
+			single_field = false;
+			break;
+		}
+	}
+	if(single_field)
+		return OF1X_ADAPTIVE_LPM;
+
+	return OF1X_ADAPTIVE_TUPLE;
+}
+
+//Adds the entry to the hash index of the shape (grows it if necessary)
+static rofl_result_t __of1x_adaptive_index_insert(of1x_adaptive_shape_t* shape, of1x_flow_entry_t* entry){
+	uint32_t i, num_of_buckets;
+	of1x_adaptive_node_t *node, *next, **buckets;
+
+	//Grow (load factor 2)
+	if(!shape->buckets || shape->num_of_entries > (shape->num_of_buckets << 1)){
+		num_of_buckets = shape->num_of_buckets? shape->num_of_buckets << 1 : ADAPTIVE_MIN_BUCKETS;
+		while(num_of_buckets < shape->num_of_entries)
+			num_of_buckets <<= 1;
+
+		buckets = (of1x_adaptive_node_t**)platform_malloc_shared(sizeof(of1x_adaptive_node_t*)*num_of_buckets);
+		if(buckets){
+			memset(buckets, 0, sizeof(of1x_adaptive_node_t*)*num_of_buckets);
+			for(i = 0; i < shape->num_of_buckets; i++){
+				for(node = shape->buckets[i]; node; node = next){
+					next = node->next;
+					node->next = buckets[node->hash & (num_of_buckets-1)];
+					buckets[node->hash & (num_of_buckets-1)] = node;
+				}
+			}
+			if(shape->buckets)
+				platform_free_shared(shape->buckets);
+			shape->buckets = buckets;
+			shape->num_of_buckets = num_of_buckets;
+		}else if(!shape->buckets){
+			return ROFL_FAILURE;
+		}
+	}
+
+	node = (of1x_adaptive_node_t*)__slab_malloc(sizeof(of1x_adaptive_node_t));
+	if(!node)
+		return ROFL_FAILURE;
+
+	node->entry = entry;
+	node->hash = __of1x_adaptive_hash_entry(shape, entry);
+	node->next = shape->buckets[node->hash & (shape->num_of_buckets-1)];
+	shape->buckets[node->hash & (shape->num_of_buckets-1)] = node;
+
+	return ROFL_SUCCESS;
+}
+
+static void __of1x_adaptive_index_remove(of1x_adaptive_shape_t* shape, of1x_flow_entry_t* entry){
+	of1x_adaptive_node_t **it, *node;
+
+	if(!shape->buckets)
+		return;
+
+	for(it = &shape->buckets[__of1x_adaptive_hash_entry(shape, entry) & (shape->num_of_buckets-1)]; *it; it = &(*it)->next){
+		if((*it)->entry == entry){
+			node = *it;
+			*it = node->next;
+			__slab_free(node);
+			return;
+		}
+	}
+}
+
+static rofl_result_t __of1x_adaptive_residual_insert(of1x_adaptive_state_t* state, of1x_flow_entry_t* entry){
+	of1x_adaptive_node_t **it, *node;
+
+	node = (of1x_adaptive_node_t*)__slab_malloc(sizeof(of1x_adaptive_node_t));
+	if(!node)
+		return ROFL_FAILURE;
+	node->entry = entry;
+	node->hash = 0;
+
+	//Before the first one not preceding it (as in the loop list)
+	for(it = &state->residual; *it && __of1x_adaptive_precedes((*it)->entry, entry); it = &(*it)->next);
+	node->next = *it;
+	*it = node;
+
+	return ROFL_SUCCESS;
+}
+
+static void __of1x_adaptive_residual_remove(of1x_adaptive_state_t* state, of1x_flow_entry_t* entry){
+	of1x_adaptive_node_t **it, *node;
+
+	for(it = &state->residual; *it; it = &(*it)->next){
+		if((*it)->entry == entry){
+			node = *it;
+			*it = node->next;
+			__slab_free(node);
+			return;
+		}
+	}
+}
+
+//Accounts the entry in the shapes (and the index, if indexed)
+static rofl_result_t __of1x_adaptive_add_entry(of1x_adaptive_state_t* state, of1x_flow_entry_t* entry, bool indexed){
+	of1x_adaptive_field_t fields[OF1X_ADAPTIVE_MAX_SHAPE_FIELDS];
+	unsigned int num_of_fields;
+	of1x_adaptive_shape_t* shape;
+
+	if(!__of1x_adaptive_get_shape(entry, fields, &num_of_fields)){
+		state->num_of_residual++;
+		if(indexed)
+			return __of1x_adaptive_residual_insert(state, entry);
+		return ROFL_SUCCESS;
+	}
+
+	shape = __of1x_adaptive_find_shape(state, fields, num_of_fields);
+	if(!shape){
+		shape = (of1x_adaptive_shape_t*)__slab_malloc(sizeof(of1x_adaptive_shape_t));
+		if(!shape)
+			return ROFL_FAILURE;
+		memset(shape, 0, sizeof(of1x_adaptive_shape_t));
+		shape->num_of_fields = num_of_fields;
+		memcpy(shape->fields, fields, sizeof(of1x_adaptive_field_t)*num_of_fields);
+		shape->max_priority = entry->priority;
+		__of1x_adaptive_sort_shape(state, shape);
+		state->num_of_shapes++;
+	}else if(entry->priority > shape->max_priority){
+		shape->max_priority = entry->priority;
+		__of1x_adaptive_sort_shape(state, shape);
+	}
+
+	shape->num_of_entries++;
+
+	if(indexed)
+		return __of1x_adaptive_index_insert(shape, entry);
+	return ROFL_SUCCESS;
+}
+
+/*
+* Builds a new state for the entries of the table: shapes first, then the
+* index according to the strategy chosen
+*/
+static of1x_adaptive_state_t* __of1x_adaptive_build_state(of1x_flow_table_t *const table, of1x_adaptive_state_t* prev){
+	of1x_adaptive_state_t* state;
+	of1x_flow_entry_t* entry;
+	of1x_adaptive_shape_t* shape;
+	of1x_adaptive_field_t fields[OF1X_ADAPTIVE_MAX_SHAPE_FIELDS];
+	unsigned int num_of_fields;
+	of1x_adaptive_strategy_t strategy;
+
+	if( (state = __of1x_adaptive_init_state()) == NULL)
+		return NULL;
+
+	if(prev){
+		state->strategy = prev->strategy;
+		state->num_of_rebuilds = prev->num_of_rebuilds;
+		state->num_of_switches = prev->num_of_switches;
+	}
+
+	for(entry = table->entries; entry; entry = entry->next){
+		if(__of1x_adaptive_add_entry(state, entry, false) != ROFL_SUCCESS)
+			goto BUILD_ERROR;
+	}
+
+	//Linear: shapes are only accounted
+	strategy = __of1x_adaptive_choose(state, table->num_of_entries);
+	if(prev && prev->strategy != strategy)
+		state->num_of_switches++;
+	state->strategy = strategy;
+
+	if(strategy == OF1X_ADAPTIVE_LINEAR)
+		return state;
+
+	//Index
+	for(entry = table->entries; entry; entry = entry->next){
+		if(!__of1x_adaptive_get_shape(entry, fields, &num_of_fields)){
+			if(__of1x_adaptive_residual_insert(state, entry) != ROFL_SUCCESS)
+				goto BUILD_ERROR;
+			continue;
+		}
+
+		shape = __of1x_adaptive_find_shape(state, fields, num_of_fields);
+		if(!shape || __of1x_adaptive_index_insert(shape, entry) != ROFL_SUCCESS)
+			goto BUILD_ERROR;
+	}
+	state->num_of_rebuilds++;
+
+	return state;
+
+BUILD_ERROR:
+	__of1x_adaptive_destroy_state(state);
+	return NULL;
+}
+
+/*
+* Reconsiders the strategy after a flow mod. Table mutex must be held
+*/
+static void __of1x_adaptive_reconsider(of1x_flow_table_t *const table){
+	of1x_adaptive_state_t *state = (of1x_adaptive_state_t*)table->matching_aux[0], *new_state;
+	of1x_adaptive_strategy_t strategy;
+
+	if(!state)
+		return;
+
+	strategy = __of1x_adaptive_choose(state, table->num_of_entries);
+
+	if(!state->degraded && strategy == state->strategy)
+		return;
+
+	//Between hashed strategies only the lookup changes
+	if(!state->degraded && strategy != OF1X_ADAPTIVE_LINEAR && state->strategy != OF1X_ADAPTIVE_LINEAR){
+		platform_rwlock_wrlock(table->rwlock);
+		state->strategy = strategy;
+		state->num_of_switches++;
+		platform_rwlock_wrunlock(table->rwlock);
+		return;
+	}
+
+	//Build the new state while lookups use the current one
+	if( (new_state = __of1x_adaptive_build_state(table, state)) == NULL){
+		ROFL_PIPELINE_WARN("[adaptive] Unable to rebuild the state of table %u; keeping strategy %s\n", table->number, of1x_adaptive_strategy_str(state->strategy));
+		return;
+	}
+
+	platform_rwlock_wrlock(table->rwlock);
+	table->matching_aux[0] = new_state;
+	platform_rwlock_wrunlock(table->rwlock);
+
+	__of1x_adaptive_destroy_state(state);
+}
+
+/*
+* Loop list notifications (table->rwlock held)
+*/
+static void __of1x_adaptive_degrade(of1x_adaptive_state_t* state){
+	of1x_adaptive_shape_t* shape;
+	of1x_adaptive_node_t *node, *next;
+
+	//Lookups fall back to the loop list until the state is rebuilt
+	for(shape = state->shapes; shape; shape = shape->next)
+		__of1x_adaptive_free_index(shape);
+	for(node = state->residual; node; node = next){
+		next = node->next;
+		__slab_free(node);
+	}
+	state->residual = NULL;
+
+	if(state->strategy != OF1X_ADAPTIVE_LINEAR)
+		state->num_of_switches++;
+	state->strategy = OF1X_ADAPTIVE_LINEAR;
+	state->degraded = true;
+}
+
+static void of1x_adaptive_link(of1x_flow_table_t *const table, of1x_flow_entry_t *const entry){
+	of1x_adaptive_state_t* state = (of1x_adaptive_state_t*)table->matching_aux[0];
+
+	if(!state || state->degraded)
+		return;
+
+	if(__of1x_adaptive_add_entry(state, entry, state->strategy != OF1X_ADAPTIVE_LINEAR) != ROFL_SUCCESS)
+		__of1x_adaptive_degrade(state);
+}
+
+static void of1x_adaptive_unlink(of1x_flow_table_t *const table, of1x_flow_entry_t *const entry){
+	of1x_adaptive_state_t* state = (of1x_adaptive_state_t*)table->matching_aux[0];
+	of1x_adaptive_field_t fields[OF1X_ADAPTIVE_MAX_SHAPE_FIELDS];
+	unsigned int num_of_fields;
+	of1x_adaptive_shape_t *shape, **it;
+
+	if(!state || state->degraded)
+		return;
+
+	if(!__of1x_adaptive_get_shape(entry, fields, &num_of_fields)){
+		if(state->num_of_residual)
+			state->num_of_residual--;
+		__of1x_adaptive_residual_remove(state, entry);
+		return;
+	}
+
+	if( (shape = __of1x_adaptive_find_shape(state, fields, num_of_fields)) == NULL)
+		return;
+
+	__of1x_adaptive_index_remove(shape, entry);
+
+	if(--shape->num_of_entries)
+		return;
+
+	//Last entry of the shape
+	for(it = &state->shapes; *it && *it != shape; it = &(*it)->next);
+	if(*it)
+		*it = shape->next;
+	__of1x_adaptive_free_index(shape);
+	__slab_free(shape);
+	state->num_of_shapes--;
+}
+
+static const of1x_loop_index_ops_t of1x_adaptive_ops = {
+	.link = of1x_adaptive_link,
+	.unlink = of1x_adaptive_unlink,
+};
+
+/*
+* Hooks
+*/
+rofl_result_t of1x_init_adaptive(struct of1x_flow_table *const table){
+
+	if( (table->matching_aux[0] = __of1x_adaptive_init_state()) == NULL)
+		return ROFL_FAILURE;
+	return ROFL_SUCCESS;
+}
+
+rofl_result_t of1x_destroy_adaptive(struct of1x_flow_table *const table){
+
+	__of1x_adaptive_destroy_state((of1x_adaptive_state_t*)table->matching_aux[0]);
+	table->matching_aux[0] = NULL;
+
+	return of1x_destroy_loop(table);
+}
+
+rofl_of1x_fm_result_t of1x_add_flow_entry_adaptive(of1x_flow_table_t *const table, of1x_flow_entry_t *const entry, bool check_overlap, bool reset_counts){
+
+	rofl_of1x_fm_result_t result;
+
+	result = __of1x_add_flow_entry_loop_indexed(table, entry, check_overlap, reset_counts, &of1x_adaptive_ops);
+
+	if(result == ROFL_OF1X_FM_SUCCESS){
+		platform_mutex_lock(table->mutex);
+		__of1x_adaptive_reconsider(table);
+		platform_mutex_unlock(table->mutex);
+	}
+
+	return result;
+}
+
+rofl_result_t of1x_modify_flow_entry_adaptive(of1x_flow_table_t *const table, of1x_flow_entry_t *const entry, const enum of1x_flow_removal_strictness strict, bool reset_counts){
+
+	rofl_result_t result;
+
+	//Matches are not modified; entries may be added though
+	result = __of1x_modify_flow_entry_loop_indexed(table, entry, strict, reset_counts, &of1x_adaptive_ops);
+
+	if(result == ROFL_SUCCESS){
+		platform_mutex_lock(table->mutex);
+		__of1x_adaptive_reconsider(table);
+		platform_mutex_unlock(table->mutex);
+	}
+
+	return result;
+}
+
+rofl_result_t of1x_remove_flow_entry_adaptive(of1x_flow_table_t *const table , of1x_flow_entry_t *const entry, of1x_flow_entry_t *const specific_entry, const enum of1x_flow_removal_strictness strict, uint32_t out_port, uint32_t out_group, of1x_flow_remove_reason_t reason, of1x_mutex_acquisition_required_t mutex_acquired){
+
+	rofl_result_t result;
+
+	result = __of1x_remove_flow_entry_loop_indexed(table, entry, specific_entry, strict, out_port, out_group, reason, mutex_acquired, &of1x_adaptive_ops);
+
+	if(!mutex_acquired)
+		platform_mutex_lock(table->mutex);
+	__of1x_adaptive_reconsider(table);
+	if(!mutex_acquired)
+		platform_mutex_unlock(table->mutex);
+
+	return result;
+}
+
+static inline bool __of1x_adaptive_check_entry(of1x_flow_entry_t* entry, of1x_packet_matches_t *const pkt_matches){
+	of1x_match_t* it;
+
+	for(it = entry->matches.head; it; it = it->next){
+		if(!__of1x_check_match(pkt_matches, it))
+			return false;
+	}
+	return true;
+}
+
+/* FLOW entry lookup entry point */
+of1x_flow_entry_t* of1x_find_best_match_adaptive(of1x_flow_table_t *const table, of1x_packet_matches_t *const pkt_matches){
+
+	of1x_adaptive_state_t* state;
+	of1x_adaptive_shape_t* shape;
+	of1x_adaptive_node_t* node;
+	of1x_flow_entry_t *entry, *best = NULL;
+	uint32_t hash;
+
+	//Prevent writers to change structure during matching
+	platform_rwlock_rdlock(table->rwlock);
+
+	state = (of1x_adaptive_state_t*)table->matching_aux[0];
+
+	//Linear (or table no longer adaptive; see migrations)
+	if(table->matching_algorithm != of1x_matching_algorithm_adaptive || !state || state->strategy == OF1X_ADAPTIVE_LINEAR){
+		for(entry = table->entries; entry; entry = entry->next){
+			if(__of1x_adaptive_check_entry(entry, pkt_matches)){
+				best = entry;
+				break;
+			}
+		}
+		goto LOOKUP_DONE;
+	}
+
+	//Hashed; shapes by decreasing max priority
+	for(shape = state->shapes; shape; shape = shape->next){
+		if(best && shape->max_priority < best->priority)
+			break;
+
+		hash = __of1x_adaptive_hash_pkt(shape, pkt_matches);
+		for(node = shape->buckets[hash & (shape->num_of_buckets-1)]; node; node = node->next){
+			if(node->hash != hash || (best && !__of1x_adaptive_precedes(node->entry, best)))
+				continue;
+			if(__of1x_adaptive_check_entry(node->entry, pkt_matches))
+				best = node->entry;
+		}
+
+		//Single table
+		if(state->strategy == OF1X_ADAPTIVE_EXACT)
+			break;
+	}
+
+	//Residual entries, in loop order
+	for(node = state->residual; node; node = node->next){
+		if(best && !__of1x_adaptive_precedes(node->entry, best))
+			break;
+		if(__of1x_adaptive_check_entry(node->entry, pkt_matches)){
+			best = node->entry;
+			break;
+		}
+	}
+
+LOOKUP_DONE:
+	if(best){
+		//Lock writers to modify the entry while packet processing. WARNING!!!! this must be released by the pipeline, once packet is processed!
+		platform_rwlock_rdlock(best->rwlock);
+	}
+
+	//Green light for writers
+	platform_rwlock_rdunlock(table->rwlock);
+	return best;
+}
+
+/*
+* Migration
+*/
+rofl_result_t of1x_migrate_build_adaptive(struct of1x_flow_table *const table){
+
+	if( (table->matching_aux[1] = __of1x_adaptive_build_state(table, NULL)) == NULL)
+		return ROFL_FAILURE;
+	return ROFL_SUCCESS;
+}
+
+void of1x_migrate_release_adaptive(struct of1x_flow_table *const table){
+	__of1x_adaptive_destroy_state((of1x_adaptive_state_t*)table->matching_aux[1]);
+}
+
+/*
+* Query API
+*/
+rofl_result_t of1x_adaptive_get_info(struct of1x_flow_table *const table, of1x_adaptive_info_t* info){
+	of1x_adaptive_state_t* state;
+
+	platform_rwlock_rdlock(table->rwlock);
+
+	state = (of1x_adaptive_state_t*)table->matching_aux[0];
+	if(table->matching_algorithm != of1x_matching_algorithm_adaptive || !state){
+		platform_rwlock_rdunlock(table->rwlock);
+		return ROFL_FAILURE;
+	}
+
+	info->strategy = state->strategy;
+	info->num_of_shapes = state->num_of_shapes;
+	info->num_of_residual = state->num_of_residual;
+	info->num_of_rebuilds = state->num_of_rebuilds;
+	info->num_of_switches = state->num_of_switches;
+
+	platform_rwlock_rdunlock(table->rwlock);
+
+	return ROFL_SUCCESS;
+}
+
+const char* of1x_adaptive_strategy_str(of1x_adaptive_strategy_t strategy){
+	switch(strategy){
+		case OF1X_ADAPTIVE_LINEAR: return "linear";
+		case OF1X_ADAPTIVE_EXACT: return "exact";
+		case OF1X_ADAPTIVE_LPM: return "lpm";
+		case OF1X_ADAPTIVE_TUPLE: return "tuple";
+		default: return "unknown";
+	}
+}
+
+void of1x_dump_adaptive(struct of1x_flow_table *const table){
+	of1x_adaptive_info_t info;
+
+	if(of1x_adaptive_get_info(table, &info) != ROFL_SUCCESS)
+		return;
+
+	ROFL_PIPELINE_INFO("\t[*] Adaptive strategy: %s, shapes: %u, residual entries: %u, rebuilds: %"PRIu64", strategy changes: %"PRIu64"\n", of1x_adaptive_strategy_str(info.strategy), info.num_of_shapes, info.num_of_residual, info.num_of_rebuilds, info.num_of_switches);
+}
+
+//Define the matching algorithm struct
+OF1X_REGISTER_MATCHING_ALGORITHM(adaptive) = {
+	//Init and destroy hooks
+	.init_hook = of1x_init_adaptive,
+	.destroy_hook = of1x_destroy_adaptive,
+
+	//Flow mods
+	.add_flow_entry_hook = of1x_add_flow_entry_adaptive,
+	.modify_flow_entry_hook = of1x_modify_flow_entry_adaptive,
+	.remove_flow_entry_hook = of1x_remove_flow_entry_adaptive,
+
+	//Find best match
+	.find_best_match_hook = of1x_find_best_match_adaptive,
+
+	//Stats (loop list)
+	.get_flow_stats_hook = of1x_get_flow_stats_loop,
+	.get_flow_stats_chunk_hook = of1x_get_flow_stats_chunk_loop,
+	.get_flow_aggregate_stats_hook = of1x_get_flow_aggregate_stats_loop,
+
+	//Find group related entries
+	.find_entry_using_group_hook = of1x_find_entry_using_group_loop,
+
+	//Find meter related entries
+	.find_entry_using_meter_hook = of1x_find_entry_using_meter_loop,
+
+	//Live migration
+	.migrate_build_hook = of1x_migrate_build_adaptive,
+	.migrate_release_hook = of1x_migrate_release_adaptive,
+
+	//Dumping
+	.dump_hook = of1x_dump_adaptive,
+	.description = ADAPTIVE_DESCRIPTION,
+};
@@ -0,0 +1,89 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef __OF1X_ADAPTIVE_MATCH_H__
+#define __OF1X_ADAPTIVE_MATCH_H__
+
+#include <inttypes.h>
+#include "rofl.h"
+#include "../matching_algorithms.h"
+#include "../../of1x_flow_table.h"
+
+/**
+* @file of1x_adaptive_match.h
+* @brief Adaptive matching algorithm
+*
+* Entries are kept in the loop list (flow mods, stats and dumps behave exactly
+* as in loop), and classified by their mask shape: the set of fields matched
+* and their masks. According to the distribution of the shapes, lookups use:
+*
+*  - linear: the loop list. Small tables, or tables with many shapes (ACLs)
+*  - exact: a single hash table; all entries match the same fields, fully masked
+*  - LPM: a hash table per prefix length of a single field
+*  - tuple: a hash table per shape (tuple space search)
+*
+* Only fields with a single packet value can be hashed (in port, metadata, Ethernet
+* addresses and type, IP proto, IPv4/IPv6 addresses, TCP/UDP ports and tunnel id).
+* Entries matching other fields are kept in a priority ordered residual list.
+*
+* The strategy is reconsidered after every flow mod; moving from linear to any
+* of the hashed strategies requires building the index (a rebuild).
+*
+* Requires the loop matching algorithm.
+*/
+
+//Entries matching more fields are residual
+#define OF1X_ADAPTIVE_MAX_SHAPE_FIELDS 8
+
+//Tables are indexed from OF1X_ADAPTIVE_INDEX_MIN_ENTRIES, and go back to linear below OF1X_ADAPTIVE_LINEAR_MAX_ENTRIES
+#define OF1X_ADAPTIVE_INDEX_MIN_ENTRIES 32
+#define OF1X_ADAPTIVE_LINEAR_MAX_ENTRIES 16
+
+//Tables with more shapes, or more than 1/2^OF1X_ADAPTIVE_MAX_RESIDUAL_SHIFT residual entries, are linear
+#define OF1X_ADAPTIVE_MAX_SHAPES 32
+#define OF1X_ADAPTIVE_MAX_RESIDUAL_SHIFT 2
+
+/**
+* @ingroup core_ma_of1x
+* Lookup strategy of an adaptive table
+*/
+typedef enum{
+	OF1X_ADAPTIVE_LINEAR = 0,
+	OF1X_ADAPTIVE_EXACT = 1,
+	OF1X_ADAPTIVE_LPM = 2,
+	OF1X_ADAPTIVE_TUPLE = 3,
+}of1x_adaptive_strategy_t;
+
+/**
+* @ingroup core_ma_of1x
+* Adaptive table state summary
+*/
+typedef struct of1x_adaptive_info{
+	of1x_adaptive_strategy_t strategy;
+	unsigned int num_of_shapes;	/* Distinct mask shapes */
+	unsigned int num_of_residual;	/* Entries which cannot be hashed */
+	uint64_t num_of_rebuilds;	/* Index builds */
+	uint64_t num_of_switches;	/* Strategy changes */
+}of1x_adaptive_info_t;
+
+//C++ extern C
+ROFL_BEGIN_DECLS
+
+/**
+* @ingroup core_ma_of1x
+* Retrieves the current strategy and counters of an adaptive table. Fails if the
+* table does not use the adaptive algorithm.
+*/
+rofl_result_t of1x_adaptive_get_info(struct of1x_flow_table *const table, of1x_adaptive_info_t* info);
+
+/**
+* @ingroup core_ma_of1x
+* Name of the strategy
+*/
+const char* of1x_adaptive_strategy_str(of1x_adaptive_strategy_t strategy);
+
+//C++ extern C
+ROFL_END_DECLS
+
+#endif //__OF1X_ADAPTIVE_MATCH_H__
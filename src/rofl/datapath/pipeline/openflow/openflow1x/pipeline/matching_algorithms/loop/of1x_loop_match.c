@@ -71,7 +71,7 @@ static of1x_flow_entry_t* of1x_flow_table_loop_check_identical(of1x_flow_entry_t
 * and table pointer, but no further checkings are done (including lookup in the table linked list)
 *
 */
-static rofl_result_t of1x_remove_flow_entry_table_specific_imp(of1x_flow_table_t *const table, of1x_flow_entry_t *const specific_entry, of1x_flow_remove_reason_t reason){
+static rofl_result_t of1x_remove_flow_entry_table_specific_imp(of1x_flow_table_t *const table, of1x_flow_entry_t *const specific_entry, of1x_flow_remove_reason_t reason, const of1x_loop_index_ops_t* ops){
 	
 	if(table->num_of_entries == 0) 
 		return ROFL_FAILURE; 
@@ -99,6 +99,11 @@ static rofl_result_t of1x_remove_flow_entry_table_specific_imp(of1x_flow_table_t
 			specific_entry->next->prev = specific_entry->prev;
 	}
 	table->num_of_entries--;
+	table->entries_version++;
+	__of1x_flow_table_recency_unlink(table, specific_entry);
+
+	if(ops)
+		ops->unlink(table, specific_entry);
 	
 	//Green light to readers and other writers			
 	platform_rwlock_wrunlock(table->rwlock);
@@ -114,22 +119,25 @@ static rofl_result_t of1x_remove_flow_entry_table_specific_imp(of1x_flow_table_t
 * Adds flow_entry to the main table. This function is NOT thread safe, and mutual exclusion should be 
 * acquired BEFORE this function being called, using table->mutex var. 
 */
-static rofl_of1x_fm_result_t of1x_add_flow_entry_table_imp(of1x_flow_table_t *const table, of1x_flow_entry_t *const entry, bool check_overlap, bool reset_counts){
-	of1x_flow_entry_t *it, *prev, *existing=NULL;
+static rofl_of1x_fm_result_t of1x_add_flow_entry_table_imp(of1x_flow_table_t *const table, of1x_flow_entry_t *const entry, bool check_overlap, bool reset_counts, const of1x_loop_index_ops_t* ops){
+	of1x_flow_entry_t *it, *prev, *existing=NULL, *victim;
 	
-	if(table->num_of_entries == OF1X_MAX_NUMBER_OF_TABLE_ENTRIES){
-		return ROFL_OF1X_FM_FAILURE; 
-	}
-
 	if(!table->entries){
 		//No rule yet
 		entry->prev = NULL;
 		entry->next = NULL;
-		table->entries = entry;
 		//Point entry table to us
 		entry->table = table;
 
+		//Prevent readers to jump in
+		platform_rwlock_wrlock(table->rwlock);
+		table->entries = entry;
+		if(ops)
+			ops->link(table, entry);
+		platform_rwlock_wrunlock(table->rwlock);
+
 		table->num_of_entries++;
+		__of1x_flow_table_recency_link(table, entry);
 
 		// let the platform do the necessary add operations
 		plaftorm_of1x_add_entry_hook(entry);
@@ -145,12 +153,23 @@ static rofl_of1x_fm_result_t of1x_add_flow_entry_table_imp(of1x_flow_table_t *co
 	if(!check_overlap)
 		existing = of1x_flow_table_loop_check_identical(table->entries, entry, OF1X_PORT_ANY, OF1X_GROUP_ANY, false); //According to spec do NOT check cookie
 
+	//Table full (entries replacing an identical one do not count); make room if possible
+	if(!existing && table->num_of_entries >= table->max_entries){
+		if( (victim = __of1x_flow_table_get_eviction_victim(table)) == NULL)
+			return ROFL_OF1X_FM_TABLE_FULL;
+		if(of1x_remove_flow_entry_table_specific_imp(table, victim, OF1X_FLOW_REMOVE_EVICTION, ops) != ROFL_SUCCESS)
+			return ROFL_OF1X_FM_FAILURE;
+	}
+
 	if(existing){
 		//There was already an entry. Update it..
 		if(!reset_counts){
 			entry->stats.packet_count = existing->stats.packet_count; 
 			entry->stats.byte_count = existing->stats.byte_count; 
 			entry->stats.initial_time = existing->stats.initial_time; 
+
+			//Inherited counters are accounted in the table aggregates
+			__of1x_stats_table_add_flow_counts(table, entry->stats.packet_count, entry->stats.byte_count);
 		}
 		
 		//Let it add normally...
@@ -187,18 +206,22 @@ static rofl_of1x_fm_result_t of1x_add_flow_entry_table_imp(of1x_flow_table_t *co
 				prev->next = entry;
 				
 			}
+			if(ops)
+				ops->link(table, entry);
+
 			//Unlock mutexes
 			platform_rwlock_wrunlock(table->rwlock);
 
 			//Increment the number of entries in the table (safe since we have the mutex acquired)
 			table->num_of_entries++;
+			__of1x_flow_table_recency_link(table, entry);
 	
 			//Point entry table to us
 			entry->table = table;
 
 			//Delete old entry
 			if(existing){
-				if(of1x_remove_flow_entry_table_specific_imp(table,existing, OF1X_FLOW_REMOVE_NO_REASON) != ROFL_SUCCESS){
+				if(of1x_remove_flow_entry_table_specific_imp(table,existing, OF1X_FLOW_REMOVE_NO_REASON, ops) != ROFL_SUCCESS){
 					assert(0);
 				}
 			}
@@ -232,16 +255,19 @@ static rofl_of1x_fm_result_t of1x_add_flow_entry_table_imp(of1x_flow_table_t *co
 		//Last
 		prev->next = entry;
 	}
+	if(ops)
+		ops->link(table, entry);
 	
 	//Unlock mutexes
 	platform_rwlock_wrunlock(table->rwlock);
 	
 	//Increment the number of entries in the table (safe since we have the mutex acquired)
 	table->num_of_entries++;
+	__of1x_flow_table_recency_link(table, entry);
 
 	//Delete old entry
 	if(existing){
-		if(of1x_remove_flow_entry_table_specific_imp(table,existing, OF1X_FLOW_REMOVE_NO_REASON) != ROFL_SUCCESS){
+		if(of1x_remove_flow_entry_table_specific_imp(table,existing, OF1X_FLOW_REMOVE_NO_REASON, ops) != ROFL_SUCCESS){
 			assert(0);
 		}
 	}
@@ -260,7 +286,7 @@ static rofl_of1x_fm_result_t of1x_add_flow_entry_table_imp(of1x_flow_table_t *co
 * This function shall NOT be used if there is some prior knowledge by the lookup algorithm before (specially a pointer to the entry), as it is inherently VERY innefficient
 */
 
-static rofl_result_t of1x_remove_flow_entry_table_non_specific_imp(of1x_flow_table_t *const table, of1x_flow_entry_t *const entry, const enum of1x_flow_removal_strictness strict, uint32_t out_port, uint32_t out_group, of1x_flow_remove_reason_t reason){
+static rofl_result_t of1x_remove_flow_entry_table_non_specific_imp(of1x_flow_table_t *const table, of1x_flow_entry_t *const entry, const enum of1x_flow_removal_strictness strict, uint32_t out_port, uint32_t out_group, of1x_flow_remove_reason_t reason, const of1x_loop_index_ops_t* ops){
 
 	int deleted=0; 
 	of1x_flow_entry_t *it, *it_next;
@@ -278,7 +304,7 @@ static rofl_result_t of1x_remove_flow_entry_table_non_specific_imp(of1x_flow_tab
 			//Strict make sure they are equal
 			if( __of1x_flow_entry_check_equal(it, entry, out_port, out_group, true) ){
 				
-				if(of1x_remove_flow_entry_table_specific_imp(table, it, reason) != ROFL_SUCCESS){
+				if(of1x_remove_flow_entry_table_specific_imp(table, it, reason, ops) != ROFL_SUCCESS){
 					assert(0); //This should never happen
 					return ROFL_FAILURE;
 				}
@@ -288,7 +314,7 @@ static rofl_result_t of1x_remove_flow_entry_table_non_specific_imp(of1x_flow_tab
 		}else{
 			if( __of1x_flow_entry_check_contained(it, entry, strict, true, out_port, out_group,false) ){
 				
-				if(of1x_remove_flow_entry_table_specific_imp(table, it, reason) != ROFL_SUCCESS){
+				if(of1x_remove_flow_entry_table_specific_imp(table, it, reason, ops) != ROFL_SUCCESS){
 					assert(0); //This should never happen
 					return ROFL_FAILURE;
 				}
@@ -318,26 +344,26 @@ static rofl_result_t of1x_remove_flow_entry_table_non_specific_imp(of1x_flow_tab
 * 
 */
 
-static inline rofl_result_t of1x_remove_flow_entry_table_imp(of1x_flow_table_t *const table, of1x_flow_entry_t *const entry, of1x_flow_entry_t *const specific_entry, uint32_t out_port, uint32_t out_group, of1x_flow_remove_reason_t reason, const enum of1x_flow_removal_strictness strict){
+static inline rofl_result_t of1x_remove_flow_entry_table_imp(of1x_flow_table_t *const table, of1x_flow_entry_t *const entry, of1x_flow_entry_t *const specific_entry, uint32_t out_port, uint32_t out_group, of1x_flow_remove_reason_t reason, const enum of1x_flow_removal_strictness strict, const of1x_loop_index_ops_t* ops){
 
 	if( (entry&&specific_entry) || ( !entry && !specific_entry) )
 		return ROFL_FAILURE;
  
 	if(entry)
-		return of1x_remove_flow_entry_table_non_specific_imp(table, entry, strict, out_port, out_group, reason);
+		return of1x_remove_flow_entry_table_non_specific_imp(table, entry, strict, out_port, out_group, reason, ops);
 	else
-		return of1x_remove_flow_entry_table_specific_imp(table, specific_entry, reason);
+		return of1x_remove_flow_entry_table_specific_imp(table, specific_entry, reason, ops);
 }
 
 /* Conveniently wraps call with mutex.  */
-rofl_of1x_fm_result_t of1x_add_flow_entry_loop(of1x_flow_table_t *const table, of1x_flow_entry_t *const entry, bool check_overlap, bool reset_counts){
+rofl_of1x_fm_result_t __of1x_add_flow_entry_loop_indexed(of1x_flow_table_t *const table, of1x_flow_entry_t *const entry, bool check_overlap, bool reset_counts, const of1x_loop_index_ops_t* ops){
 
 	rofl_of1x_fm_result_t return_value;
 
 	//Allow single add/remove operation over the table
 	platform_mutex_lock(table->mutex);
 	
-	return_value = of1x_add_flow_entry_table_imp(table, entry, check_overlap, reset_counts);
+	return_value = of1x_add_flow_entry_table_imp(table, entry, check_overlap, reset_counts, ops);
 
 	//Green light to other threads
 	platform_mutex_unlock(table->mutex);
@@ -345,10 +371,13 @@ rofl_of1x_fm_result_t of1x_add_flow_entry_loop(of1x_flow_table_t *const table, o
 	return return_value;
 }
 
-rofl_result_t of1x_modify_flow_entry_loop(of1x_flow_table_t *const table, of1x_flow_entry_t *const entry, const enum of1x_flow_removal_strictness strict, bool reset_counts){
+rofl_of1x_fm_result_t of1x_add_flow_entry_loop(of1x_flow_table_t *const table, of1x_flow_entry_t *const entry, bool check_overlap, bool reset_counts){
+	return __of1x_add_flow_entry_loop_indexed(table, entry, check_overlap, reset_counts, NULL);
+}
+
+rofl_result_t __of1x_modify_flow_entry_loop_indexed(of1x_flow_table_t *const table, of1x_flow_entry_t *const entry, const enum of1x_flow_removal_strictness strict, bool reset_counts, const of1x_loop_index_ops_t* ops){
 
-	int moded=0; 
-	of1x_flow_entry_t *it;
+	of1x_flow_entry_t *it, *last=NULL;
 
 	//Allow single add/remove operation over the table
 	platform_mutex_lock(table->mutex);
@@ -359,25 +388,32 @@ rofl_result_t of1x_modify_flow_entry_loop(of1x_flow_table_t *const table, of1x_f
 		if( strict == STRICT ){
 			//Strict make sure they are equal
 			if( __of1x_flow_entry_check_equal(it, entry, OF1X_PORT_ANY, OF1X_GROUP_ANY, true) ){
-				if(__of1x_update_flow_entry(it, entry, reset_counts) != ROFL_SUCCESS)
-					return ROFL_FAILURE;
-				moded++;
+				last = it;
 				break;
 			}
 		}else{
 			if( __of1x_flow_entry_check_contained(it, entry, strict, true, OF1X_PORT_ANY, OF1X_GROUP_ANY,false) ){
-				if(__of1x_update_flow_entry(it, entry, reset_counts) != ROFL_SUCCESS)
+				//All but the last matching entry get a copy of the instructions
+				if(last && __of1x_update_flow_entry(last, entry, reset_counts, false) != ROFL_SUCCESS){
+					platform_mutex_unlock(table->mutex);
 					return ROFL_FAILURE;
-				moded++;
+				}
+				last = it;
 			}
 		}
 	}
 
+	//The last one (usually the only one) takes over the instructions of the flowmod
+	if(last && __of1x_update_flow_entry(last, entry, reset_counts, true) != ROFL_SUCCESS){
+		platform_mutex_unlock(table->mutex);
+		return ROFL_FAILURE;
+	}
+
 	platform_mutex_unlock(table->mutex);
 
 	//According to spec
-	if(moded == 0){	
-		return of1x_add_flow_entry_loop(table, entry, false, reset_counts);
+	if(!last){	
+		return __of1x_add_flow_entry_loop_indexed(table, entry, false, reset_counts, ops);
 	}
 
 	//Delete the original flowmod (modify one)
@@ -386,7 +422,11 @@ rofl_result_t of1x_modify_flow_entry_loop(of1x_flow_table_t *const table, of1x_f
 	return ROFL_SUCCESS;
 }
 
-rofl_result_t of1x_remove_flow_entry_loop(of1x_flow_table_t *const table , of1x_flow_entry_t *const entry, of1x_flow_entry_t *const specific_entry, const enum of1x_flow_removal_strictness strict, uint32_t out_port, uint32_t out_group, of1x_flow_remove_reason_t reason, of1x_mutex_acquisition_required_t mutex_acquired){
+rofl_result_t of1x_modify_flow_entry_loop(of1x_flow_table_t *const table, of1x_flow_entry_t *const entry, const enum of1x_flow_removal_strictness strict, bool reset_counts){
+	return __of1x_modify_flow_entry_loop_indexed(table, entry, strict, reset_counts, NULL);
+}
+
+rofl_result_t __of1x_remove_flow_entry_loop_indexed(of1x_flow_table_t *const table , of1x_flow_entry_t *const entry, of1x_flow_entry_t *const specific_entry, const enum of1x_flow_removal_strictness strict, uint32_t out_port, uint32_t out_group, of1x_flow_remove_reason_t reason, of1x_mutex_acquisition_required_t mutex_acquired, const of1x_loop_index_ops_t* ops){
 
 	rofl_result_t result;
 
@@ -395,7 +435,7 @@ rofl_result_t of1x_remove_flow_entry_loop(of1x_flow_table_t *const table , of1x_
 		platform_mutex_lock(table->mutex);
 	}
 	
-	result = of1x_remove_flow_entry_table_imp(table, entry, specific_entry, out_port, out_group,reason, strict);
+	result = of1x_remove_flow_entry_table_imp(table, entry, specific_entry, out_port, out_group,reason, strict, ops);
 
 	//Green light to other threads
 	if(!mutex_acquired){
@@ -405,6 +445,9 @@ rofl_result_t of1x_remove_flow_entry_loop(of1x_flow_table_t *const table , of1x_
 	return result;
 }
 
+rofl_result_t of1x_remove_flow_entry_loop(of1x_flow_table_t *const table , of1x_flow_entry_t *const entry, of1x_flow_entry_t *const specific_entry, const enum of1x_flow_removal_strictness strict, uint32_t out_port, uint32_t out_group, of1x_flow_remove_reason_t reason, of1x_mutex_acquisition_required_t mutex_acquired){
+	return __of1x_remove_flow_entry_loop_indexed(table, entry, specific_entry, strict, out_port, out_group, reason, mutex_acquired, NULL);
+}
 	
 /* FLOW entry lookup entry point */ 
 of1x_flow_entry_t* of1x_find_best_match_loop(of1x_flow_table_t *const table, of1x_packet_matches_t *const pkt_matches){
@@ -486,8 +529,10 @@ rofl_result_t of1x_get_flow_stats_loop(struct of1x_flow_table *const table,
 			//Create a new single flow entry and fillin 
 			flow_stats = __of1x_init_stats_single_flow_msg(entry);
 			
-			if(!flow_stats)
+			if(!flow_stats){
+				platform_rwlock_rdunlock(table->rwlock);
 				return ROFL_FAILURE;	
+			}
 	
 			//Push this stat to the msg
 			__of1x_push_single_flow_stats_to_msg(msg, flow_stats);	
@@ -501,6 +546,74 @@ rofl_result_t of1x_get_flow_stats_loop(struct of1x_flow_table *const table,
 	return ROFL_SUCCESS;
 }
 
+rofl_result_t of1x_get_flow_stats_chunk_loop(struct of1x_flow_table *const table,
+		of1x_stats_flow_cursor_t* cursor,
+		unsigned int max_entries,
+		of1x_stats_flow_msg_t* msg){
+
+	uint64_t i;
+	unsigned int visited, pushed;
+	of1x_flow_entry_t* entry, flow_stats_entry;
+	of1x_stats_single_flow_msg_t* flow_stats;
+	bool check_cookie = (table->pipeline->sw->of_ver != OF_VERSION_10);
+
+	if(!msg || !table)
+		return ROFL_FAILURE;
+
+	//Create a flow_stats_entry
+	memset(&flow_stats_entry,0,sizeof(of1x_flow_entry_t));
+	if(cursor->matches)
+		flow_stats_entry.matches = *cursor->matches;
+	flow_stats_entry.cookie = cursor->cookie;
+	flow_stats_entry.cookie_mask = cursor->cookie_mask;
+	
+	//Mark table as being read
+	platform_rwlock_rdlock(table->rwlock);
+
+	//Resume
+	if(!cursor->last){
+		entry = table->entries;
+	}else if(cursor->last_version == table->entries_version){
+		entry = cursor->last->next;
+	}else{
+		//Entries were removed (last may be gone); skip the ones already visited
+		for(i=0, entry=table->entries; entry && i<cursor->position; i++, entry=entry->next);
+	}
+
+	for(visited=pushed=0; entry && visited < OF1X_STATS_FLOW_CURSOR_MAX_VISITS && pushed < max_entries; entry=entry->next, visited++){
+	
+		cursor->last = entry;
+
+		//Check if is contained 
+		if(__of1x_flow_entry_check_contained(&flow_stats_entry, entry, false, check_cookie, cursor->out_port, cursor->out_group, true)){
+
+			// update statistics from platform
+			platform_of1x_update_stats_hook(entry);
+
+			//Create a new single flow entry and fillin 
+			flow_stats = __of1x_init_stats_single_flow_msg(entry);
+			
+			if(!flow_stats){
+				platform_rwlock_rdunlock(table->rwlock);
+				return ROFL_FAILURE;	
+			}
+	
+			//Push this stat to the msg
+			__of1x_push_single_flow_stats_to_msg(msg, flow_stats);	
+			pushed++;
+		}
+	}
+
+	cursor->position += visited;
+	cursor->last_version = table->entries_version;
+	cursor->table_done = (entry == NULL);
+
+	//Release the table
+	platform_rwlock_rdunlock(table->rwlock);
+
+	return ROFL_SUCCESS;
+}
+
 rofl_result_t of1x_get_flow_aggregate_stats_loop(struct of1x_flow_table *const table,
 		uint64_t cookie,
 		uint64_t cookie_mask,
@@ -578,6 +691,29 @@ of1x_flow_entry_t* of1x_find_entry_using_group_loop(of1x_flow_table_t *const tab
 	return NULL; 
 }
 
+/* Meter related FLOW entry lookup */ 
+of1x_flow_entry_t* of1x_find_entry_using_meter_loop(of1x_flow_table_t *const table, const unsigned int meter_id){
+
+	of1x_flow_entry_t *entry;
+
+	//Prevent writers to change structure during matching
+	platform_rwlock_rdlock(table->rwlock);
+	
+	//Find an entry that refers to the meter with meter_id
+	for(entry = table->entries;entry!=NULL;entry = entry->next){
+		if(__of1x_instructions_contain_meter(entry, meter_id)){
+			//Green light for writers
+			platform_rwlock_rdunlock(table->rwlock);
+			return entry;
+		}
+	}
+	
+	//No match
+	//Green light for writers
+	platform_rwlock_rdunlock(table->rwlock);
+	return NULL; 
+}
+
 rofl_result_t of1x_destroy_loop(struct of1x_flow_table *const table){
 
 	of1x_flow_entry_t *entry, *next;
@@ -593,6 +729,18 @@ rofl_result_t of1x_destroy_loop(struct of1x_flow_table *const table){
 	return ROFL_SUCCESS;
 }
 
+/*
+* Migration. Loop keeps no state other than the list of entries
+*/
+rofl_result_t of1x_migrate_build_loop(struct of1x_flow_table *const table){
+	table->matching_aux[1] = NULL;
+	return ROFL_SUCCESS;
+}
+
+void of1x_migrate_release_loop(struct of1x_flow_table *const table){
+	//Nothing to release
+}
+
 //Define the matching algorithm struct
 OF1X_REGISTER_MATCHING_ALGORITHM(loop) = {
 	//Init and destroy hooks
@@ -609,11 +757,19 @@ OF1X_REGISTER_MATCHING_ALGORITHM(loop) = {
 
 	//Stats
 	.get_flow_stats_hook = of1x_get_flow_stats_loop,
+	.get_flow_stats_chunk_hook = of1x_get_flow_stats_chunk_loop,
 	.get_flow_aggregate_stats_hook = of1x_get_flow_aggregate_stats_loop,
 
 	//Find group related entries	
 	.find_entry_using_group_hook = of1x_find_entry_using_group_loop,
 
+	//Find meter related entries	
+	.find_entry_using_meter_hook = of1x_find_entry_using_meter_loop,
+
+	//Live migration
+	.migrate_build_hook = of1x_migrate_build_loop,
+	.migrate_release_hook = of1x_migrate_release_loop,
+
 	//Dumping	
 	.dump_hook = NULL,
 	.description = LOOP_DESCRIPTION,
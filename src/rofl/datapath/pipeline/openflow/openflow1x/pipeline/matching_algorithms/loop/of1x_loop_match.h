@@ -5,9 +5,36 @@
 #include "../matching_algorithms.h"
 #include "../../of1x_flow_table.h"
 
+/**
+* Notifications of the changes in the list of entries, for matching algorithms
+* which build an index on top of the loop list (e.g. adaptive). Both are called
+* with table->rwlock (write) held.
+*/
+typedef struct of1x_loop_index_ops{
+	void (*link)(struct of1x_flow_table *const table, of1x_flow_entry_t *const entry);
+	void (*unlink)(struct of1x_flow_table *const table, of1x_flow_entry_t *const entry);
+}of1x_loop_index_ops_t;
+
 //C++ extern C
 ROFL_BEGIN_DECLS
 
+//Loop hooks
+rofl_of1x_fm_result_t of1x_add_flow_entry_loop(struct of1x_flow_table *const table, of1x_flow_entry_t *const entry, bool check_overlap, bool reset_counts);
+rofl_result_t of1x_modify_flow_entry_loop(struct of1x_flow_table *const table, of1x_flow_entry_t *const entry, const enum of1x_flow_removal_strictness strict, bool reset_counts);
+rofl_result_t of1x_remove_flow_entry_loop(struct of1x_flow_table *const table , of1x_flow_entry_t *const entry, of1x_flow_entry_t *const specific_entry, const enum of1x_flow_removal_strictness strict, uint32_t out_port, uint32_t out_group, of1x_flow_remove_reason_t reason, of1x_mutex_acquisition_required_t mutex_acquired);
+of1x_flow_entry_t* of1x_find_best_match_loop(struct of1x_flow_table *const table, of1x_packet_matches_t *const pkt_matches);
+rofl_result_t of1x_get_flow_stats_loop(struct of1x_flow_table *const table, uint64_t cookie, uint64_t cookie_mask, uint32_t out_port, uint32_t out_group, of1x_match_group_t *const matches, of1x_stats_flow_msg_t* msg);
+rofl_result_t of1x_get_flow_stats_chunk_loop(struct of1x_flow_table *const table, of1x_stats_flow_cursor_t* cursor, unsigned int max_entries, of1x_stats_flow_msg_t* msg);
+rofl_result_t of1x_get_flow_aggregate_stats_loop(struct of1x_flow_table *const table, uint64_t cookie, uint64_t cookie_mask, uint32_t out_port, uint32_t out_group, of1x_match_group_t *const matches, of1x_stats_flow_aggregate_msg_t* msg);
+of1x_flow_entry_t* of1x_find_entry_using_group_loop(struct of1x_flow_table *const table, const unsigned int group_id);
+of1x_flow_entry_t* of1x_find_entry_using_meter_loop(struct of1x_flow_table *const table, const unsigned int meter_id);
+rofl_result_t of1x_destroy_loop(struct of1x_flow_table *const table);
+
+//Loop list operations notifying the changes to ops (may be NULL)
+rofl_of1x_fm_result_t __of1x_add_flow_entry_loop_indexed(struct of1x_flow_table *const table, of1x_flow_entry_t *const entry, bool check_overlap, bool reset_counts, const of1x_loop_index_ops_t* ops);
+rofl_result_t __of1x_modify_flow_entry_loop_indexed(struct of1x_flow_table *const table, of1x_flow_entry_t *const entry, const enum of1x_flow_removal_strictness strict, bool reset_counts, const of1x_loop_index_ops_t* ops);
+rofl_result_t __of1x_remove_flow_entry_loop_indexed(struct of1x_flow_table *const table , of1x_flow_entry_t *const entry, of1x_flow_entry_t *const specific_entry, const enum of1x_flow_removal_strictness strict, uint32_t out_port, uint32_t out_group, of1x_flow_remove_reason_t reason, of1x_mutex_acquisition_required_t mutex_acquired, const of1x_loop_index_ops_t* ops);
+
 //void load_matching_algorithm_loop(struct matching_algorithm_functions *f);
 //inline of1x_flow_entry_t* of1x_find_best_match_loop(of1x_flow_table_t *const table, of1x_packet_matches_t *const pkt);
 
@@ -197,6 +197,25 @@ typedef struct of1x_matching_algorithm_functions{
 
 
 
+	/**
+	* @ingroup core_ma_of1x 
+	* Retrieves the next chunk of flow stats of the table, resuming from the
+	* position of the cursor. At most max_entries flow stats are pushed to msg.
+	*
+	* The hook should visit at most OF1X_STATS_FLOW_CURSOR_MAX_VISITS entries per
+	* call, and must set cursor->table_done once the end of the table is reached.
+	* The saved position (cursor->last) shall only be used if table->entries_version
+	* has not changed since it was saved.
+	*
+	* This is optional; if not implemented get_flow_stats_hook() is used instead,
+	* retrieving the whole table at once.
+	*/
+	rofl_result_t
+	(*get_flow_stats_chunk_hook)(struct of1x_flow_table *const table,
+			of1x_stats_flow_cursor_t* cursor,
+			unsigned int max_entries,
+			of1x_stats_flow_msg_t* msg);
+
 	/**
 	* @ingroup core_ma_of1x 
 	* Retrieves aggregate flow stats according to spec 
@@ -226,6 +245,56 @@ typedef struct of1x_matching_algorithm_functions{
 	(*find_entry_using_group_hook)(struct of1x_flow_table *const table,
 			const unsigned int group_id);
 
+	/**
+	* @ingroup core_ma_of1x 
+	* The find_entry_using_meter_hook() must retrieve the first entry in the
+	* table whose instructions refer to meter_id and return it.
+	*
+	* The matching algorithm may use __of1x_instructions_contain_meter()
+	* helper function to perform the lookup.
+	*
+	* This is usually used by the core when meter deletion occurs.
+	*/
+	of1x_flow_entry_t*
+	(*find_entry_using_meter_hook)(struct of1x_flow_table *const table,
+			const unsigned int meter_id);
+
+
+	// live migration
+	/**
+	* @ingroup core_ma_of1x 
+	* Builds the algorithm state for the entries currently in the table, in
+	* table->matching_aux[1], without modifying the entries. Used to migrate
+	* a live table to this algorithm (of1x_set_table_matching_algorithm()). The
+	* state is promoted to table->matching_aux[0] when the table is switched.
+	*
+	* The table mutex is held, and lookups are still being served by the
+	* current algorithm.
+	*
+	* Only algorithms keeping table->entries as the (ordered) list of entries
+	* of the table can take part in migrations. Since lookups, stats and
+	* group/meter hooks may still be dispatched to an algorithm after the table
+	* has been migrated away from it, such hooks must not use matching_aux
+	* unless, once table->rwlock is held, table->matching_algorithm is still
+	* theirs (table->entries can be used instead).
+	*
+	* On failure, the hook must release whatever it allocated.
+	*
+	* This is optional; tables cannot be migrated to algorithms not implementing it.
+	*/
+	rofl_result_t
+	(*migrate_build_hook)(struct of1x_flow_table *const table);
+
+	/**
+	* @ingroup core_ma_of1x 
+	* Releases the state of the algorithm left in table->matching_aux[1] once the
+	* table has been migrated to another algorithm. Entries MUST NOT be destroyed.
+	*
+	* This is optional; tables cannot be migrated from algorithms not implementing it.
+	*/
+	void
+	(*migrate_release_hook)(struct of1x_flow_table *const table);
+
 
 	// dump flow table
 	/**
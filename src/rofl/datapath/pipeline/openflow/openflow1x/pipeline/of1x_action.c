@@ -6,15 +6,14 @@
 
 #include "of1x_packet_matches.h" //TODO: evaluate if this is the best approach to update of1x_matches after actions
 #include "../../../physical_switch.h"
+#include "../../../virtual_link.h"
 #include "../../../platform/packet.h"
 #include "../../../util/logging.h"
-#include "../../../platform/memory.h"
+#include "../../../common/slab.h"
+#include "../../../common/per_core.h"
 #include "../of1x_async_events_hooks.h"
 #include "of1x_utils.h"
 
-//Flood port
-extern switch_port_t* flood_meta_port;
-
 //fwd declarations
 static void __of1x_process_group_actions(const struct of1x_switch* sw, const unsigned int table_id, datapacket_t *pkt,uint64_t field, of1x_group_t* group, bool replicate_pkts);
 
@@ -26,7 +25,7 @@ of1x_packet_action_t* of1x_init_packet_action(/*const struct of1x_switch* sw, */
 	if(!type)
 		return NULL;
 
-	action = platform_malloc_shared(sizeof(of1x_packet_action_t));
+	action = __slab_malloc(sizeof(of1x_packet_action_t));
 
 	if(!action)
 		return NULL;
@@ -307,7 +306,7 @@ of1x_packet_action_t* of1x_init_packet_action(/*const struct of1x_switch* sw, */
 
 void of1x_destroy_packet_action(of1x_packet_action_t* action){
 
-	platform_free_shared(action);
+	__slab_free(action);
 }
 
 /* Action group init and destroy */
@@ -316,7 +315,7 @@ of1x_action_group_t* of1x_init_action_group(of1x_packet_action_t* actions){
 	unsigned int number_of_actions=0, number_of_output_actions=0;
 	of1x_action_group_t* action_group;
 	
-	action_group = platform_malloc_shared(sizeof(of1x_action_group_t));
+	action_group = __slab_malloc(sizeof(of1x_action_group_t));
 
 	if(!action_group)
 		return NULL;
@@ -350,6 +349,10 @@ of1x_action_group_t* of1x_init_action_group(of1x_packet_action_t* actions){
 }
 
 void of1x_destroy_action_group(of1x_action_group_t* group){
+	__of1x_destroy_action_group(group, NULL);
+}
+
+void __of1x_destroy_action_group(of1x_action_group_t* group, slab_batch_t* batch){
 
 	of1x_packet_action_t* it,*next;
 
@@ -358,9 +361,9 @@ void of1x_destroy_action_group(of1x_action_group_t* group){
 
 	for(it=group->head;it;it=next){
 		next = it->next; 
-		of1x_destroy_packet_action(it);
+		__slab_batch_free(batch, it);
 	}
-	platform_free_shared(group);	
+	__slab_batch_free(batch, group);
 }
 
 /* Addition of an action to an action group */
@@ -407,7 +410,7 @@ void __of1x_init_packet_write_actions(datapacket_t *const pkt){
 
 of1x_write_actions_t* of1x_init_write_actions(){
 
-	of1x_write_actions_t* write_actions = platform_malloc_shared(sizeof(of1x_write_actions_t)); 
+	of1x_write_actions_t* write_actions = __slab_malloc(sizeof(of1x_write_actions_t)); 
 
 	if(!write_actions)
 		return NULL;
@@ -421,8 +424,8 @@ of1x_write_actions_t* of1x_init_write_actions(){
 	return write_actions;
 }
 
-void __of1x_destroy_write_actions(of1x_write_actions_t* write_actions){
-	platform_free_shared(write_actions);	
+void __of1x_destroy_write_actions(of1x_write_actions_t* write_actions, slab_batch_t* batch){
+	__slab_batch_free(batch, write_actions);
 }
 
 void of1x_set_packet_action_on_write_actions(of1x_write_actions_t* write_actions, of1x_packet_action_t* action){
@@ -470,11 +473,73 @@ void __of1x_clear_write_actions(datapacket_t* pkt){
 	memset(&pkt->write_actions.of1x, 0, sizeof(of1x_write_actions_t));
 }
 
+//Returns true if the action modifies the packet buffer
+static inline bool __of1x_action_mangles_packet(of1x_packet_action_type_t type){
+	switch(type){
+		case OF1X_AT_NO_ACTION:
+		case OF1X_AT_SET_QUEUE:
+		case OF1X_AT_GROUP:
+		case OF1X_AT_EXPERIMENTER:
+		case OF1X_AT_OUTPUT:
+			return false;
+		default:
+			return true;
+	}
+}
+
+//Flood/all output to the precomputed port set, except the input port
+static void __of1x_output_port_set(const struct of1x_switch* sw, datapacket_t* pkt, datapacket_t* pkt_to_send, const of1x_port_set_t* set){
+
+	unsigned int i, num_of_port_nums, num_of_ports = 0;
+	uint32_t port_num;
+	uint32_t port_nums[LOGICAL_SWITCH_MAX_LOG_PORTS];
+	switch_port_t* port;
+	switch_port_t* ports[LOGICAL_SWITCH_MAX_LOG_PORTS];
+	datapacket_t* replica;
+
+	//The set may be rebuilt meanwhile
+	num_of_port_nums = of1x_port_set_read(set, port_nums);
+
+	for(i=0;i<num_of_port_nums;i++){
+		port_num = port_nums[i];
+		port = sw->logical_ports[port_num].port;
+
+		//Detached in the meantime
+		if(!port || port_num == pkt->matches.of1x.port_in)
+			continue;
+
+		if(port->vlink_peer){
+			//In-memory link to another switch; a replica per link
+			replica = platform_packet_replicate_shared(pkt_to_send);
+			if(!replica)
+				continue;
+			replica->matches = pkt->matches;
+			virtual_link_transmit(port, replica, !replica->matches.of1x.headers_changed);
+			continue;
+		}
+
+		ports[num_of_ports++] = port;
+	}
+
+	if(num_of_ports)
+		platform_packet_output_multi(pkt_to_send, ports, num_of_ports);
+	else
+		platform_packet_drop(pkt_to_send);
+}
+
 /* Contains switch with all the different action functions */
 static inline void __of1x_process_packet_action(const struct of1x_switch* sw, const unsigned int table_id, datapacket_t* pkt, of1x_packet_action_t* action, bool replicate_pkts){
 
 	of1x_packet_matches_t* pkt_matches = &pkt->matches.of1x;
 
+	//Copy-on-write; the buffer of a shared packet must be made private before mangling it
+	if(pkt->is_shared && __of1x_action_mangles_packet(action->type)){
+		if(platform_packet_make_writable(pkt) != ROFL_SUCCESS){
+			ROFL_PIPELINE_ERR("Unable to get a private copy of packet %p; skipping action of type %u\n", pkt, action->type);
+			return;
+		}
+	}
+
 	switch(action->type){
 		case OF1X_AT_NO_ACTION: assert(0);
 			break;
@@ -503,6 +568,7 @@ static inline void __of1x_process_packet_action(const struct of1x_switch* sw, co
 			//Update match
 			pkt_matches->eth_type= platform_packet_get_eth_type(pkt); 
 			pkt_matches->pkt_size_bytes = platform_packet_get_size_bytes(pkt); 
+			pkt_matches->headers_changed = true;
 			break;
 		case OF1X_AT_POP_PPPOE: 
 			//Call platform
@@ -510,6 +576,7 @@ static inline void __of1x_process_packet_action(const struct of1x_switch* sw, co
 			//Update match
 			pkt_matches->eth_type= platform_packet_get_eth_type(pkt); 
 			pkt_matches->pkt_size_bytes = platform_packet_get_size_bytes(pkt); 
+			pkt_matches->headers_changed = true;
 			break;
 	
 		//PUSH
@@ -519,6 +586,7 @@ static inline void __of1x_process_packet_action(const struct of1x_switch* sw, co
 			//Update match
 			pkt_matches->eth_type= platform_packet_get_eth_type(pkt); 
 			pkt_matches->pkt_size_bytes = platform_packet_get_size_bytes(pkt); 
+			pkt_matches->headers_changed = true;
 			break;
 		case OF1X_AT_PUSH_MPLS:
 			//Call platform
@@ -526,6 +594,7 @@ static inline void __of1x_process_packet_action(const struct of1x_switch* sw, co
 			//Update match
 			pkt_matches->eth_type= platform_packet_get_eth_type(pkt); 
 			pkt_matches->pkt_size_bytes = platform_packet_get_size_bytes(pkt); 
+			pkt_matches->headers_changed = true;
 			break;
 		case OF1X_AT_PUSH_VLAN:
 			//Call platform
@@ -950,12 +1019,14 @@ static inline void __of1x_process_packet_action(const struct of1x_switch* sw, co
 			platform_packet_pop_gtp(pkt);
 			//Update match
 			pkt_matches->pkt_size_bytes = platform_packet_get_size_bytes(pkt); 
+			pkt_matches->headers_changed = true;
 			break;
 		case OF1X_AT_PUSH_GTP: 
 			//Call platform
 			platform_packet_push_gtp(pkt);
 			//Update match
 			pkt_matches->pkt_size_bytes = platform_packet_get_size_bytes(pkt); 
+			pkt_matches->headers_changed = true;
 			break;
 
 		//PBB
@@ -971,6 +1042,7 @@ static inline void __of1x_process_packet_action(const struct of1x_switch* sw, co
 			//Update match
 			pkt_matches->eth_type= platform_packet_get_eth_type(pkt); 
 			pkt_matches->pkt_size_bytes = platform_packet_get_size_bytes(pkt); 
+			pkt_matches->headers_changed = true;
 			break;
 		case OF1X_AT_PUSH_PBB: 
 			//Call platform
@@ -978,6 +1050,7 @@ static inline void __of1x_process_packet_action(const struct of1x_switch* sw, co
 			//Update match
 			pkt_matches->eth_type= platform_packet_get_eth_type(pkt); 
 			pkt_matches->pkt_size_bytes = platform_packet_get_size_bytes(pkt); 
+			pkt_matches->headers_changed = true;
 			break;
 
 		//TUNNEL ID
@@ -1006,10 +1079,24 @@ static inline void __of1x_process_packet_action(const struct of1x_switch* sw, co
 
 				//Pointer for the packet to be sent
 				datapacket_t* pkt_to_send;			
+				of1x_flight_record_t* record = NULL;
+
+				if(((of1x_switch_t*)sw)->pipeline->flight_recorder_rate)
+					record = __of1x_flight_recorder_current(((of1x_switch_t*)sw)->pipeline->flight_recorder);
+
+				//Packet-ins over the limit are dropped before replicating the packet
+				if((action->field.u32 == OF1X_PORT_CONTROLLER || action->field.u32 == OF1X_PORT_NORMAL) &&
+					((of1x_switch_t*)sw)->pipeline->pkt_in_limiter && !__of1x_packet_in_admit(((of1x_switch_t*)sw)->pipeline, table_id, pkt, OF1X_PKT_IN_ACTION)){
+					if(record)
+						__of1x_flight_recorder_pkt_in_limited(record);
+					if(!replicate_pkts)
+						platform_packet_drop(pkt);
+					break;
+				}
 	
-				//Duplicate the packet only if necessary
+				//Duplicate the packet only if necessary (sharing the buffer)
 				if(replicate_pkts){
-					pkt_to_send = platform_packet_replicate(pkt);
+					pkt_to_send = platform_packet_replicate_shared(pkt);
 	
 					//check for wrong copy
 					if(!pkt_to_send)
@@ -1017,6 +1104,9 @@ static inline void __of1x_process_packet_action(const struct of1x_switch* sw, co
 				}else
 					pkt_to_send = pkt;
 
+				if(record)
+					__of1x_flight_recorder_output(record, action->field.u32);
+
 				//Perform output
 				if( action->field.u32 < LOGICAL_SWITCH_MAX_LOG_PORTS && NULL != sw->logical_ports[action->field.u32].port ){
 
@@ -1025,20 +1115,25 @@ static inline void __of1x_process_packet_action(const struct of1x_switch* sw, co
 					//unless IN_PORT meta port is used
 					if(action->field.u32 == pkt->matches.of1x.port_in){
 						platform_packet_drop(pkt_to_send);
+					}else if(sw->logical_ports[action->field.u32].port->vlink_peer){
+						//In-memory link to another switch; replicas carry no matches
+						if(pkt_to_send != pkt)
+							pkt_to_send->matches = pkt->matches;
+						virtual_link_transmit(sw->logical_ports[action->field.u32].port, pkt_to_send, !pkt_to_send->matches.of1x.headers_changed);
 					}else{
 						platform_packet_output(pkt_to_send, sw->logical_ports[action->field.u32].port);
 					}
 
 				}else if(action->field.u32 == OF1X_PORT_FLOOD){
 					//Flood
-					platform_packet_output(pkt_to_send, flood_meta_port);
+					__of1x_output_port_set(sw, pkt, pkt_to_send, ((of1x_switch_t*)sw)->flood_set);
 				}else if(action->field.u32 == OF1X_PORT_CONTROLLER ||
 					action->field.u32 == OF1X_PORT_NORMAL){
-					//Controller
+					//Controller (admitted by the limiter, if any)
 					platform_of1x_packet_in(sw, table_id, pkt_to_send, OF1X_PKT_IN_ACTION);
 				}else if(action->field.u32 == OF1X_PORT_ALL){
 					//Flood
-					platform_packet_output(pkt_to_send, all_meta_port);
+					__of1x_output_port_set(sw, pkt, pkt_to_send, ((of1x_switch_t*)sw)->all_set);
 				}else if(action->field.u32 == OF1X_PORT_IN_PORT){
 					//in port
 					platform_packet_output(pkt_to_send, in_port_meta_port);
@@ -1107,7 +1202,7 @@ rofl_result_t __of1x_update_write_actions(of1x_write_actions_t** group, of1x_wri
 	
 	//Destroy old group	
 	if(old_group)
-		__of1x_destroy_write_actions(old_group);
+		__of1x_destroy_write_actions(old_group, NULL);
 	
 	return ROFL_SUCCESS;
 }
@@ -1116,12 +1211,26 @@ static void __of1x_process_group_actions(const struct of1x_switch* sw, const uns
 	datapacket_t* pkt_replica;
 	of1x_bucket_t *it_bk;
 	of1x_packet_matches_t *matches = &pkt->matches.of1x;
+	uint64_t bytes = matches->pkt_size_bytes; //pkt may be released by the actions
+	of1x_stats_counter_t* counters;
+	of1x_flight_record_t* record = NULL;
+	OF1X_LATENCY_START(group_start);
+	
+	platform_rwlock_rdlock(group->rwlock);
+	
+	//Counters of this core (group and buckets)
+	counters = __of1x_stats_group_row(&group->stats, __per_core_id());
+
+	//Only sampled packets are recorded
+	if(((of1x_switch_t*)sw)->pipeline->flight_recorder_rate)
+		record = __of1x_flight_recorder_current(((of1x_switch_t*)sw)->pipeline->flight_recorder);
 	
 	//process the actions in the buckets depending on the type
 	switch(group->type){
 		case OF1X_GROUP_TYPE_ALL:
 			//executes all buckets
-			platform_rwlock_rdlock(group->rwlock);
+			if(record)
+				__of1x_flight_recorder_group(record, group->id, OF1X_FLIGHT_RECORDER_ALL_BUCKETS);
 			for (it_bk = group->bc_list->head; it_bk!=NULL;it_bk = it_bk->next){
 
 				//If there are no output actions, skip bucket 
@@ -1129,8 +1238,9 @@ static void __of1x_process_group_actions(const struct of1x_switch* sw, const uns
 					continue;
 
 				//Clone the packet according to spec before applying the bucket
-				//action list
-				pkt_replica = platform_packet_replicate(pkt);
+				//action list. The buffer is shared; buckets rewriting headers
+				//will get a private copy on the first mangling action
+				pkt_replica = platform_packet_replicate_shared(pkt);
 				if(!pkt_replica){
 					assert(0);
 					break;
@@ -1138,34 +1248,46 @@ static void __of1x_process_group_actions(const struct of1x_switch* sw, const uns
 				
 				//Process all actions in the bucket
 				__of1x_process_apply_actions(sw,table_id, pkt_replica, it_bk->actions, it_bk->actions->num_of_output_actions > 1); //No replica
-				__of1x_stats_bucket_update(&it_bk->stats, matches->pkt_size_bytes);
+				__of1x_stats_counter_update(&counters[OF1X_STATS_BUCKET_COLUMN(it_bk->index)], bytes);
 				
 				if(it_bk->actions->num_of_output_actions > 1)
 					platform_packet_drop(pkt_replica);
 			}
-			platform_rwlock_rdunlock(group->rwlock);
 			break;
 		case OF1X_GROUP_TYPE_SELECT:
-			//NOT SUPPORTED	
-			assert(0);  //Should NEVER be installed
+			//executes one bucket, selected by hashing the packet fields
+			it_bk = __of1x_group_select_bucket(group, ((of1x_switch_t*)sw)->pipeline->groups->select_hash_fields, matches);
+			if(record)
+				__of1x_flight_recorder_group(record, group->id, it_bk->index);
+			__of1x_process_apply_actions(sw,table_id,pkt,it_bk->actions, replicate_pkts);
+			__of1x_stats_counter_update(&counters[OF1X_STATS_BUCKET_COLUMN(it_bk->index)], bytes);
 			break;
 		case OF1X_GROUP_TYPE_INDIRECT:
 			//executes the "one bucket defined"
-			platform_rwlock_rdlock(group->rwlock);
-			__of1x_process_apply_actions(sw,table_id,pkt,group->bc_list->head->actions, replicate_pkts);
-			__of1x_stats_bucket_update(&group->bc_list->head->stats, matches->pkt_size_bytes);
-			platform_rwlock_rdunlock(group->rwlock);
+			it_bk = group->bc_list->head;
+			if(record)
+				__of1x_flight_recorder_group(record, group->id, it_bk->index);
+			__of1x_process_apply_actions(sw,table_id,pkt,it_bk->actions, replicate_pkts);
+			__of1x_stats_counter_update(&counters[OF1X_STATS_BUCKET_COLUMN(it_bk->index)], bytes);
 			break;
 		case OF1X_GROUP_TYPE_FF:
-			//NOT SUPPORTED
-			assert(0);  //Should NEVER be installed
+			//executes the first live bucket, if any
+			it_bk = __of1x_group_ff_bucket((of1x_switch_t*)sw, group);
+			if(record)
+				__of1x_flight_recorder_group(record, group->id, (it_bk)? it_bk->index : OF1X_FLIGHT_RECORDER_NO_BUCKET);
+			if(it_bk){
+				__of1x_process_apply_actions(sw,table_id,pkt,it_bk->actions, replicate_pkts);
+				__of1x_stats_counter_update(&counters[OF1X_STATS_BUCKET_COLUMN(it_bk->index)], bytes);
+			}
 			break;
 		default:
 			assert(0);  //Should NEVER be reached 
 			break;
 	}
-	__of1x_stats_group_update(&group->stats, matches->pkt_size_bytes);
+	__of1x_stats_counter_update(&counters[OF1X_STATS_GROUP_COLUMN], bytes);
 	
+	platform_rwlock_rdunlock(group->rwlock);
+	OF1X_LATENCY_END(((of1x_switch_t*)sw)->pipeline, table_id, OF1X_LATENCY_STAGE_GROUP, group_start);
 }
 //Checking functions
 /*TODO specific funcions for 128 bits. So far only used for OUTPUT and GROUP actions, so not really necessary*/
@@ -1198,7 +1320,7 @@ of1x_packet_action_t* __of1x_copy_packet_action(of1x_packet_action_t* action){
 
 	of1x_packet_action_t* copy;
 
-	copy = platform_malloc_shared(sizeof(of1x_packet_action_t));
+	copy = __slab_malloc(sizeof(of1x_packet_action_t));
 
 	if(!copy)
 		return NULL;
@@ -1216,7 +1338,7 @@ of1x_action_group_t* __of1x_copy_action_group(of1x_action_group_t* origin){
 	if(!origin)
 		return NULL;
 
-	copy = platform_malloc_shared(sizeof(of1x_action_group_t));
+	copy = __slab_malloc(sizeof(of1x_action_group_t));
 
 
 	if(!copy)
@@ -1260,7 +1382,7 @@ of1x_write_actions_t* __of1x_copy_write_actions(of1x_write_actions_t* origin){
 	if(!origin)
 		return NULL;
 
-	copy = platform_malloc_shared(sizeof(of1x_write_actions_t)); 
+	copy = __slab_malloc(sizeof(of1x_write_actions_t)); 
 
 	if(!copy)
 		return NULL;
@@ -389,7 +389,8 @@ of1x_write_actions_t* of1x_init_write_actions(void);
 /*
 * Destroy a write_actions instance. This also destroys actions contained
 */
-void __of1x_destroy_write_actions(of1x_write_actions_t* write_actions);
+void __of1x_destroy_action_group(of1x_action_group_t* group, slab_batch_t* batch);
+void __of1x_destroy_write_actions(of1x_write_actions_t* write_actions, slab_batch_t* batch);
 
 /**
 * @ingroup core_of1x 
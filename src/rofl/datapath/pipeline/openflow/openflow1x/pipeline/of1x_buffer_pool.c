@@ -0,0 +1,282 @@
+#include "of1x_buffer_pool.h"
+
+#include <string.h>
+#include <sys/time.h>
+#include "of1x_pipeline.h"
+#include "of1x_timers.h"
+#include "../of1x_switch.h"
+#include "../../../common/per_core.h"
+#include "../../../platform/cutil.h"
+#include "../../../platform/memory.h"
+#include "../../../platform/packet.h"
+#include "../../../util/logging.h"
+
+/*
+* Packet buffer pool
+*/
+
+static inline of1x_buffer_pool_core_t* __of1x_buffer_pool_get_core(of1x_buffer_pool_t* pool){
+
+	return &pool->cores[__per_core_id()];
+}
+
+//Global free stack (lock-free; the tag prevents ABA)
+static void __of1x_buffer_pool_push(of1x_buffer_pool_t* pool, uint32_t index){
+
+	uint64_t old_head, new_head;
+
+	do{
+		old_head = pool->free_head;
+		pool->slots[index].next = (uint32_t)old_head;
+		new_head = (((old_head >> 32) + 1) << 32) | index;
+	}while(!__sync_bool_compare_and_swap(&pool->free_head, old_head, new_head));
+}
+
+static uint32_t __of1x_buffer_pool_pop(of1x_buffer_pool_t* pool){
+
+	uint64_t old_head, new_head;
+	uint32_t index;
+
+	do{
+		old_head = pool->free_head;
+		index = (uint32_t)old_head;
+		if(index == OF1X_BUFFER_POOL_NIL)
+			return OF1X_BUFFER_POOL_NIL;
+		new_head = (((old_head >> 32) + 1) << 32) | pool->slots[index].next;
+	}while(!__sync_bool_compare_and_swap(&pool->free_head, old_head, new_head));
+
+	return index;
+}
+
+//Per-core cache
+static uint32_t __of1x_buffer_pool_alloc(of1x_buffer_pool_t* pool, of1x_buffer_pool_core_t* core){
+
+	uint32_t index;
+
+	if(!pool->cache_size)
+		return __of1x_buffer_pool_pop(pool);
+
+	//Refill half of the cache
+	while(core->count < (pool->cache_size+1)/2){
+		index = __of1x_buffer_pool_pop(pool);
+		if(index == OF1X_BUFFER_POOL_NIL)
+			break;
+		core->cache[core->count++] = index;
+	}
+
+	if(!core->count)
+		return OF1X_BUFFER_POOL_NIL;
+
+	return core->cache[--core->count];
+}
+
+static void __of1x_buffer_pool_free(of1x_buffer_pool_t* pool, of1x_buffer_pool_core_t* core, uint32_t index){
+
+	if(!pool->cache_size){
+		__of1x_buffer_pool_push(pool, index);
+		return;
+	}
+
+	//Spill half of the cache
+	if(core->count == pool->cache_size){
+		while(core->count > pool->cache_size/2)
+			__of1x_buffer_pool_push(pool, core->cache[--core->count]);
+	}
+
+	core->cache[core->count++] = index;
+}
+
+static inline uint64_t __of1x_buffer_pool_now_ms(void){
+
+	struct timeval now;
+
+	__of1x_gettimeofday(&now, NULL);
+	return __of1x_get_time_ms(&now);
+}
+
+rofl_result_t __of1x_init_buffer_pool(of1x_pipeline_t* pipeline){
+
+	of1x_buffer_pool_t* pool;
+	unsigned int i, num_of_buffers = pipeline->num_of_buffers;
+
+	if(!num_of_buffers || num_of_buffers > OF1X_BUFFER_POOL_MAX_BUFFERS)
+		return ROFL_FAILURE;
+
+	pool = (of1x_buffer_pool_t*)platform_malloc_shared(sizeof(of1x_buffer_pool_t));
+	if(!pool)
+		return ROFL_FAILURE;
+	memset(pool, 0, sizeof(of1x_buffer_pool_t));
+
+	pool->slots = (of1x_buffer_slot_t*)platform_malloc_shared(sizeof(of1x_buffer_slot_t)*num_of_buffers);
+	pool->cores = (of1x_buffer_pool_core_t*)platform_malloc_shared(sizeof(of1x_buffer_pool_core_t)*ROFL_PIPELINE_MAX_CORES);
+	if(!pool->slots || !pool->cores){
+		if(pool->slots)
+			platform_free_shared(pool->slots);
+		if(pool->cores)
+			platform_free_shared(pool->cores);
+		platform_free_shared(pool);
+		return ROFL_FAILURE;
+	}
+	memset(pool->slots, 0, sizeof(of1x_buffer_slot_t)*num_of_buffers);
+	memset(pool->cores, 0, sizeof(of1x_buffer_pool_core_t)*ROFL_PIPELINE_MAX_CORES);
+
+	pool->num_of_buffers = num_of_buffers;
+	for(pool->index_bits=1; (1U << pool->index_bits) < num_of_buffers; pool->index_bits++);
+
+	//All ones is never used, so that ids are never OF1XP_NO_BUFFER
+	pool->max_generation = (1U << (32 - pool->index_bits)) - 2;
+
+	//At most half of the slots can be cached
+	pool->cache_size = num_of_buffers / (2*ROFL_PIPELINE_MAX_CORES);
+	if(pool->cache_size > OF1X_BUFFER_POOL_CACHE_SIZE)
+		pool->cache_size = OF1X_BUFFER_POOL_CACHE_SIZE;
+
+	pool->free_head = OF1X_BUFFER_POOL_NIL;
+	for(i=num_of_buffers; i>0; i--)
+		__of1x_buffer_pool_push(pool, i-1);
+
+	pipeline->buffers = pool;
+
+	return ROFL_SUCCESS;
+}
+
+void __of1x_destroy_buffer_pool(of1x_pipeline_t* pipeline){
+
+	unsigned int i;
+	of1x_buffer_pool_t* pool = pipeline->buffers;
+
+	if(!pool)
+		return;
+
+	for(i=0;i<pool->num_of_buffers;i++){
+		if(pool->slots[i].buffer_id)
+			platform_packet_drop(pool->slots[i].pkt);
+	}
+
+	pipeline->buffers = NULL;
+	platform_free_shared(pool->slots);
+	platform_free_shared(pool->cores);
+	platform_free_shared(pool);
+}
+
+uint32_t of1x_store_packet_buffer(of1x_pipeline_t* pipeline, datapacket_t* pkt){
+
+	of1x_buffer_pool_t* pool = pipeline->buffers;
+	of1x_buffer_pool_core_t* core;
+	of1x_buffer_slot_t* slot;
+	uint32_t index;
+
+	if(!pool)
+		return OF1XP_NO_BUFFER;
+
+	core = __of1x_buffer_pool_get_core(pool);
+
+	index = __of1x_buffer_pool_alloc(pool, core);
+	if(index == OF1X_BUFFER_POOL_NIL){
+		core->exhausted++;
+		return OF1XP_NO_BUFFER;
+	}
+
+	//The slot is owned exclusively until published
+	slot = &pool->slots[index];
+	slot->generation = (slot->generation >= pool->max_generation)? 1 : slot->generation+1;
+	slot->pkt = pkt;
+	slot->expiration_ms = __of1x_buffer_pool_now_ms() + OF1X_BUFFER_POOL_EXPIRATION_MS;
+
+	__sync_synchronize();
+	slot->buffer_id = (slot->generation << pool->index_bits) | index;
+
+	core->stored++;
+
+	return slot->buffer_id;
+}
+
+datapacket_t* of1x_retrieve_packet_buffer(of1x_pipeline_t* pipeline, uint32_t buffer_id){
+
+	of1x_buffer_pool_t* pool = pipeline->buffers;
+	of1x_buffer_pool_core_t* core;
+	of1x_buffer_slot_t* slot;
+	datapacket_t* pkt;
+	uint32_t index;
+
+	if(!pool || buffer_id == 0 || buffer_id == OF1XP_NO_BUFFER)
+		return NULL;
+
+	core = __of1x_buffer_pool_get_core(pool);
+	index = buffer_id & ((1U << pool->index_bits) - 1);
+
+	//Claim; fails if the id is stale (the generation is part of it)
+	if(index >= pool->num_of_buffers || !__sync_bool_compare_and_swap(&pool->slots[index].buffer_id, buffer_id, 0)){
+		core->stale++;
+		return NULL;
+	}
+
+	slot = &pool->slots[index];
+	pkt = slot->pkt;
+	slot->pkt = NULL;
+
+	__of1x_buffer_pool_free(pool, core, index);
+	core->retrieved++;
+
+	return pkt;
+}
+
+void __of1x_expire_packet_buffers(of1x_pipeline_t* pipeline, uint64_t now_ms){
+
+	unsigned int i;
+	of1x_buffer_pool_t* pool = pipeline->buffers;
+	of1x_buffer_pool_core_t* core;
+	of1x_buffer_slot_t* slot;
+	datapacket_t* pkt;
+	uint32_t buffer_id;
+
+	if(!pool)
+		return;
+
+	core = __of1x_buffer_pool_get_core(pool);
+
+	for(i=0;i<pool->num_of_buffers;i++){
+		slot = &pool->slots[i];
+
+		buffer_id = slot->buffer_id;
+		if(!buffer_id)
+			continue;
+
+		//Expiration time is published before the id
+		__sync_synchronize();
+		if(slot->expiration_ms > now_ms)
+			continue;
+
+		//Lost against a retrieval
+		if(!__sync_bool_compare_and_swap(&slot->buffer_id, buffer_id, 0))
+			continue;
+
+		pkt = slot->pkt;
+		slot->pkt = NULL;
+		__of1x_buffer_pool_free(pool, core, i);
+		core->expired++;
+
+		platform_packet_drop(pkt);
+	}
+}
+
+void of1x_get_buffer_pool_stats(of1x_pipeline_t* pipeline, of1x_buffer_pool_stats_t* stats){
+
+	unsigned int i;
+	of1x_buffer_pool_t* pool = pipeline->buffers;
+
+	memset(stats, 0, sizeof(of1x_buffer_pool_stats_t));
+
+	if(!pool)
+		return;
+
+	stats->num_of_buffers = pool->num_of_buffers;
+	for(i=0;i<ROFL_PIPELINE_MAX_CORES;i++){
+		stats->stored += pool->cores[i].stored;
+		stats->retrieved += pool->cores[i].retrieved;
+		stats->expired += pool->cores[i].expired;
+		stats->stale += pool->cores[i].stale;
+		stats->exhausted += pool->cores[i].exhausted;
+	}
+	stats->in_use = stats->stored - stats->retrieved - stats->expired;
+}
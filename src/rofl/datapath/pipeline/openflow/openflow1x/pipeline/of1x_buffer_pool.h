@@ -0,0 +1,148 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef __OF1X_BUFFER_POOL_H__
+#define __OF1X_BUFFER_POOL_H__
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include "rofl.h"
+#include "../../../common/datapacket.h"
+
+/**
+* @file of1x_buffer_pool.h
+* @brief Packet buffer store (buffer_id) for packet-in/packet-out
+*
+* Retains the packets sent to the controller (packet-in) and resolves the
+* buffer_id of packet-out and flow-mod messages in O(1), without copies.
+*
+* The pool has pipeline->num_of_buffers slots. A buffer_id encodes the slot
+* index (low bits) and a per-slot generation (high bits), so ids of packets
+* already released or expired are detected as stale, even if the slot has
+* been reused. Ids are never 0 or OF1XP_NO_BUFFER.
+*
+* Free slots are kept in per-core caches, refilled from (and spilled to) a
+* lock-free global stack; store and retrieve take no locks. Packets not
+* claimed within OF1X_BUFFER_POOL_EXPIRATION_MS are dropped
+* (platform_packet_drop()) by of_process_pipeline_tables_timeout_expirations().
+*/
+
+//Time a packet is retained (ms)
+#ifndef OF1X_BUFFER_POOL_EXPIRATION_MS
+	#define OF1X_BUFFER_POOL_EXPIRATION_MS 5000
+#endif
+
+//Max free slots cached per core
+#define OF1X_BUFFER_POOL_CACHE_SIZE 32
+
+//Max number of buffers (at least 12 bits are left for the generation)
+#define OF1X_BUFFER_POOL_MAX_BUFFERS (1<<20)
+
+//Slot index end of list
+#define OF1X_BUFFER_POOL_NIL 0xFFFFFFFF
+
+/**
+* Buffer slot
+*/
+typedef struct of1x_buffer_slot{
+	volatile uint32_t buffer_id;	//Id of the packet stored (0 if the slot is not in use)
+	uint32_t generation;		//Generation of the last id assigned
+	uint32_t next;			//Global free stack link
+	uint64_t expiration_ms;
+	datapacket_t* pkt;
+}of1x_buffer_slot_t;
+
+/**
+* Per-core free slot cache and counters (only accessed by the owning core)
+*/
+typedef struct of1x_buffer_pool_core{
+	unsigned int count;
+	uint32_t cache[OF1X_BUFFER_POOL_CACHE_SIZE];
+
+	uint64_t stored;
+	uint64_t retrieved;
+	uint64_t expired;
+	uint64_t stale;				//Retrievals of unknown, stale or expired ids
+	uint64_t exhausted;			//Stores failed (no free slot)
+	uint64_t __pad[3];
+}of1x_buffer_pool_core_t;
+
+/**
+* @ingroup core_of1x
+* Packet buffer pool
+*/
+typedef struct of1x_buffer_pool{
+	unsigned int num_of_buffers;
+	unsigned int index_bits;		//buffer_id bits used by the slot index
+	unsigned int cache_size;		//Free slots cached per core
+	uint32_t max_generation;
+
+	//Global free stack; (ABA tag << 32) | slot index
+	volatile uint64_t free_head;
+
+	of1x_buffer_slot_t* slots;
+	of1x_buffer_pool_core_t* cores;
+}of1x_buffer_pool_t;
+
+/**
+* @ingroup core_of1x
+* Buffer pool counters
+*/
+typedef struct of1x_buffer_pool_stats{
+	uint32_t num_of_buffers;
+	uint32_t in_use;
+	uint64_t stored;
+	uint64_t retrieved;
+	uint64_t expired;
+	uint64_t stale;
+	uint64_t exhausted;
+}of1x_buffer_pool_stats_t;
+
+//Fwd declarations
+struct of1x_pipeline;
+
+//C++ extern C
+ROFL_BEGIN_DECLS
+
+/**
+* @ingroup core_of1x
+* Stores a packet (typically from platform_of1x_packet_in()) until it is
+* retrieved with of1x_retrieve_packet_buffer() or it expires. The pool owns
+* the packet meanwhile.
+*
+* @return buffer_id, or OF1XP_NO_BUFFER if there is no pool or it is
+* exhausted (the packet must then be sent unbuffered)
+*/
+uint32_t of1x_store_packet_buffer(struct of1x_pipeline* pipeline, datapacket_t* pkt);
+
+/**
+* @ingroup core_of1x
+* Retrieves (and releases from the pool) a stored packet, e.g. to process a
+* packet-out with of1x_process_packet_out_pipeline(). The caller owns the
+* packet afterwards.
+*
+* @return the packet, or NULL if buffer_id is unknown, stale (already
+* retrieved) or expired
+*/
+datapacket_t* of1x_retrieve_packet_buffer(struct of1x_pipeline* pipeline, uint32_t buffer_id);
+
+/**
+* @ingroup core_of1x
+* Retrieves the buffer pool counters
+*/
+void of1x_get_buffer_pool_stats(struct of1x_pipeline* pipeline, of1x_buffer_pool_stats_t* stats);
+
+//Creates the pool of pipeline->num_of_buffers slots (called after platform_post_init_of1x_switch())
+rofl_result_t __of1x_init_buffer_pool(struct of1x_pipeline* pipeline);
+
+//Drops the packets stored and releases the pool
+void __of1x_destroy_buffer_pool(struct of1x_pipeline* pipeline);
+
+//Drops the packets stored before now_ms - OF1X_BUFFER_POOL_EXPIRATION_MS
+void __of1x_expire_packet_buffers(struct of1x_pipeline* pipeline, uint64_t now_ms);
+
+//C++ extern C
+ROFL_END_DECLS
+
+#endif //OF1X_BUFFER_POOL
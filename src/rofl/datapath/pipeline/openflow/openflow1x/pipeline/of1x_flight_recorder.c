@@ -0,0 +1,213 @@
+#include "of1x_flight_recorder.h"
+
+#include <string.h>
+#include "of1x_pipeline.h"
+#include "of1x_flow_entry.h"
+#include "../../../platform/cutil.h"
+#include "../../../platform/memory.h"
+#include "../../../util/logging.h"
+
+/*
+* Packet decision flight recorder
+*/
+
+static const char* __of1x_flight_verdict_names[] = {
+	"IN_PROGRESS",
+	"OUTPUT",
+	"DROP_NO_OUTPUT",
+	"DROP_TABLE_MISS",
+	"DROP_END_OF_PIPELINE",
+	"DROP_METER",
+	"PACKET_IN_MISS",
+	"DROP_PACKET_IN_LIMIT",
+};
+
+const char* of1x_flight_verdict_str(of1x_flight_verdict_t verdict){
+	if(verdict > OF1X_FLIGHT_DROP_PACKET_IN_LIMIT)
+		return "UNKNOWN";
+	return __of1x_flight_verdict_names[verdict];
+}
+
+static inline of1x_flight_recorder_core_t* __of1x_flight_recorder_get_core(of1x_pipeline_t* pipeline, unsigned int* core_id){
+
+	*core_id = __per_core_id();
+
+	return &pipeline->flight_recorder[*core_id];
+}
+
+rofl_result_t of1x_set_flight_recorder(of1x_pipeline_t* pipeline, uint32_t sample_rate){
+
+	unsigned int i;
+	of1x_flight_recorder_core_t* cores;
+
+	if(sample_rate && !pipeline->flight_recorder){
+		cores = (of1x_flight_recorder_core_t*)platform_malloc_shared(sizeof(of1x_flight_recorder_core_t)*ROFL_PIPELINE_MAX_CORES);
+		if(!cores)
+			return ROFL_FAILURE;
+		memset(cores, 0, sizeof(of1x_flight_recorder_core_t)*ROFL_PIPELINE_MAX_CORES);
+
+		//Rings must be visible before the sample rate
+		if(!__sync_bool_compare_and_swap(&pipeline->flight_recorder, NULL, cores))
+			platform_free_shared(cores);
+	}
+
+	pipeline->flight_recorder_rate = sample_rate;
+
+	//Restart the sampling; countdowns of a previous (larger) rate would delay the new one
+	if(pipeline->flight_recorder){
+		for(i=0;i<ROFL_PIPELINE_MAX_CORES;i++)
+			pipeline->flight_recorder[i].countdown = 0;
+	}
+
+	return ROFL_SUCCESS;
+}
+
+void __of1x_flight_recorder_destroy(of1x_pipeline_t* pipeline){
+	if(pipeline->flight_recorder)
+		platform_free_shared(pipeline->flight_recorder);
+	pipeline->flight_recorder = NULL;
+}
+
+of1x_flight_record_t* __of1x_flight_recorder_begin(of1x_pipeline_t* pipeline, uint32_t sample_rate, uint32_t port_in, uint32_t pkt_size_bytes, uint16_t eth_type){
+
+	unsigned int core_id;
+	of1x_flight_recorder_core_t* core;
+	of1x_flight_record_t* record;
+
+	if(!pipeline->flight_recorder)
+		return NULL;
+
+	core = __of1x_flight_recorder_get_core(pipeline, &core_id);
+
+	if(core->countdown){
+		core->countdown--;
+		return NULL;
+	}
+	core->countdown = sample_rate-1;
+
+	//Invalidate the slot before overwriting it
+	record = &core->records[core->head % OF1X_FLIGHT_RECORDER_SLOTS];
+	record->seq = 0;
+	__sync_synchronize();
+
+	record->core_id = core_id;
+	record->verdict = OF1X_FLIGHT_IN_PROGRESS;
+	record->num_of_hops = 0;
+	record->port_in = port_in;
+	record->pkt_size_bytes = pkt_size_bytes;
+	record->eth_type = eth_type;
+	record->group_id = OF1X_FLIGHT_RECORDER_NO_GROUP;
+	record->bucket = 0;
+	record->num_of_outputs = 0;
+	record->output_port = 0;
+	record->num_of_pkt_in_limited = 0;
+
+	core->current = record;
+
+	return record;
+}
+
+void __of1x_flight_recorder_end(of1x_pipeline_t* pipeline, of1x_flight_record_t* record, of1x_flight_verdict_t verdict){
+
+	unsigned int core_id;
+	of1x_flight_recorder_core_t* core = __of1x_flight_recorder_get_core(pipeline, &core_id);
+
+	if(verdict == OF1X_FLIGHT_DROP_NO_OUTPUT && record->num_of_outputs)
+		verdict = OF1X_FLIGHT_OUTPUT;
+	else if(verdict == OF1X_FLIGHT_DROP_NO_OUTPUT && record->num_of_pkt_in_limited)
+		verdict = OF1X_FLIGHT_DROP_PACKET_IN_LIMIT;
+	record->verdict = verdict;
+
+	//Publish
+	__sync_synchronize();
+	record->seq = ++core->head;
+	core->current = NULL;
+}
+
+unsigned int of1x_get_flight_records(of1x_pipeline_t* pipeline, of1x_flight_record_t* records, unsigned int max_records){
+
+	unsigned int i, j, num_of_records = 0;
+	uint64_t seq;
+	of1x_flight_recorder_core_t* core;
+	of1x_flight_record_t* record;
+
+	if(!pipeline->flight_recorder || !records)
+		return 0;
+
+	for(i=0;i<ROFL_PIPELINE_MAX_CORES && num_of_records < max_records;i++){
+		core = &pipeline->flight_recorder[i];
+
+		for(j=0;j<OF1X_FLIGHT_RECORDER_SLOTS && num_of_records < max_records;j++){
+			record = &core->records[j];
+
+			seq = record->seq;
+			if(!seq)
+				continue;
+			__sync_synchronize();
+
+			memcpy(&records[num_of_records], record, sizeof(of1x_flight_record_t));
+
+			//Discard if overwritten while copying
+			__sync_synchronize();
+			if(record->seq != seq)
+				continue;
+
+			num_of_records++;
+		}
+	}
+
+	return num_of_records;
+}
+
+rofl_result_t of1x_clear_flight_recorder(of1x_pipeline_t* pipeline){
+
+	unsigned int i, j;
+
+	if(!pipeline->flight_recorder)
+		return ROFL_FAILURE;
+
+	for(i=0;i<ROFL_PIPELINE_MAX_CORES;i++){
+		for(j=0;j<OF1X_FLIGHT_RECORDER_SLOTS;j++)
+			pipeline->flight_recorder[i].records[j].seq = 0;
+	}
+
+	return ROFL_SUCCESS;
+}
+
+void of1x_dump_flight_recorder(of1x_pipeline_t* pipeline){
+
+	unsigned int i, j, k;
+	of1x_flight_record_t record;
+	of1x_flight_recorder_core_t* core;
+
+	if(!pipeline->flight_recorder){
+		ROFL_PIPELINE_INFO("Flight recorder not enabled\n");
+		return;
+	}
+
+	ROFL_PIPELINE_INFO("Dumping flight recorder (sample rate %u)\n", pipeline->flight_recorder_rate);
+
+	for(i=0;i<ROFL_PIPELINE_MAX_CORES;i++){
+		core = &pipeline->flight_recorder[i];
+
+		//Oldest first
+		for(j=0;j<OF1X_FLIGHT_RECORDER_SLOTS;j++){
+			record = core->records[(core->head+j) % OF1X_FLIGHT_RECORDER_SLOTS];
+			if(!record.seq)
+				continue;
+
+			ROFL_PIPELINE_INFO_NO_PREFIX("\t[core %u, #%"PRIu64"] port_in %u, %u bytes, eth_type 0x%x -> %s", record.core_id, record.seq, record.port_in, record.pkt_size_bytes, record.eth_type, of1x_flight_verdict_str(record.verdict));
+			for(k=0; k < record.num_of_hops && k < OF1X_FLIGHT_RECORDER_MAX_HOPS; k++){
+				if(record.hops[k].matched)
+					ROFL_PIPELINE_INFO_NO_PREFIX(", table %u entry %p (cookie 0x%"PRIx64")", record.hops[k].table_id, record.hops[k].entry, record.hops[k].cookie);
+				else
+					ROFL_PIPELINE_INFO_NO_PREFIX(", table %u miss", record.hops[k].table_id);
+			}
+			if(record.group_id != OF1X_FLIGHT_RECORDER_NO_GROUP)
+				ROFL_PIPELINE_INFO_NO_PREFIX(", group %u bucket %d", record.group_id, (int)record.bucket);
+			if(record.num_of_outputs)
+				ROFL_PIPELINE_INFO_NO_PREFIX(", %u outputs (last port %u)", record.num_of_outputs, record.output_port);
+			ROFL_PIPELINE_INFO_NO_PREFIX("\n");
+		}
+	}
+}
@@ -0,0 +1,204 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef __OF1X_FLIGHT_RECORDER_H__
+#define __OF1X_FLIGHT_RECORDER_H__
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include "rofl.h"
+#include "../../../common/per_core.h"
+
+/**
+* @file of1x_flight_recorder.h
+* @brief Packet decision flight recorder
+*
+* Records a compact trace of 1 out of sample_rate packets processed by the
+* pipeline: tables visited (goto chain) and entries matched, last group and
+* bucket executed, outputs and the final verdict (e.g. drop reason).
+*
+* Traces are kept in per-core rings of OF1X_FLIGHT_RECORDER_SLOTS records,
+* written only by the owning core, and can be retrieved at any time with
+* of1x_get_flight_records() without stopping the datapath.
+*/
+
+//Records kept per core
+#ifndef OF1X_FLIGHT_RECORDER_SLOTS
+	#define OF1X_FLIGHT_RECORDER_SLOTS 128
+#endif
+
+//Max number of tables recorded per packet (the rest are counted only)
+#define OF1X_FLIGHT_RECORDER_MAX_HOPS 8
+
+//Bucket field when all the buckets are executed (ALL groups)
+#define OF1X_FLIGHT_RECORDER_ALL_BUCKETS 0xFFFFFFFF
+
+//Bucket field when no bucket was live (fast failover groups)
+#define OF1X_FLIGHT_RECORDER_NO_BUCKET 0xFFFFFFFE
+
+//Group field when no group has been executed
+#define OF1X_FLIGHT_RECORDER_NO_GROUP 0xFFFFFFFF
+
+/**
+* @ingroup core_of1x
+* Final verdict of a recorded packet
+*/
+typedef enum of1x_flight_verdict{
+	OF1X_FLIGHT_IN_PROGRESS = 0,		/* Not finished (should not be seen) */
+	OF1X_FLIGHT_OUTPUT = 1,			/* Sent to one or more ports (including CONTROLLER) */
+	OF1X_FLIGHT_DROP_NO_OUTPUT = 2,		/* Matched, but no output action */
+	OF1X_FLIGHT_DROP_TABLE_MISS = 3,	/* Table miss, with drop behaviour */
+	OF1X_FLIGHT_DROP_END_OF_PIPELINE = 4,	/* Table miss in the last table (continue behaviour) */
+	OF1X_FLIGHT_DROP_METER = 5,		/* Dropped by a meter band */
+	OF1X_FLIGHT_PACKET_IN_MISS = 6,		/* Table miss, sent to the controller */
+	OF1X_FLIGHT_DROP_PACKET_IN_LIMIT = 7,	/* Packet-in (miss or action) dropped by the limiter */
+}of1x_flight_verdict_t;
+
+//Fwd declarations
+struct of1x_pipeline;
+struct of1x_flow_entry;
+
+/**
+* @ingroup core_of1x
+* Table visited by a recorded packet
+*/
+typedef struct of1x_flight_hop{
+	uint8_t table_id;
+	bool matched;
+	struct of1x_flow_entry* entry;		/* Entry matched; for identification only (may no longer exist) */
+	uint64_t cookie;			/* Cookie of the entry matched */
+}of1x_flight_hop_t;
+
+/**
+* @ingroup core_of1x
+* Trace of a recorded packet
+*/
+typedef struct of1x_flight_record{
+	uint64_t seq;				/* Per-core sequence number (0 invalid) */
+	uint16_t core_id;
+	uint8_t verdict;			/* of1x_flight_verdict_t */
+	uint8_t num_of_hops;			/* Tables visited */
+
+	//Packet
+	uint32_t port_in;
+	uint32_t pkt_size_bytes;
+	uint16_t eth_type;
+
+	of1x_flight_hop_t hops[OF1X_FLIGHT_RECORDER_MAX_HOPS];
+
+	//Last group executed and bucket selected (index in the bucket list)
+	uint32_t group_id;
+	uint32_t bucket;
+
+	//Outputs
+	uint32_t num_of_outputs;
+	uint32_t output_port;			/* Last output port */
+	uint32_t num_of_pkt_in_limited;		/* Packet-in actions dropped by the limiter */
+}of1x_flight_record_t;
+
+/**
+* Per-core flight recorder ring
+*/
+typedef struct of1x_flight_recorder_core{
+	uint32_t countdown;			/* Packets until the next sample */
+	uint64_t head;				/* Records written */
+	of1x_flight_record_t* current;		/* Record of the packet in process (if sampled) */
+	uint64_t __pad[5];
+
+	of1x_flight_record_t records[OF1X_FLIGHT_RECORDER_SLOTS];
+}of1x_flight_recorder_core_t;
+
+//C++ extern C
+ROFL_BEGIN_DECLS
+
+/**
+* @ingroup core_of1x
+* Enables (or disables, sample_rate 0) the flight recorder of a pipeline.
+*
+* The rings are allocated the first time the recorder is enabled, and kept
+* until the pipeline is destroyed; disabling it keeps the records.
+*
+* @param sample_rate 1 out of sample_rate packets (per core) is recorded
+*/
+rofl_result_t of1x_set_flight_recorder(struct of1x_pipeline* pipeline, uint32_t sample_rate);
+
+/**
+* @ingroup core_of1x
+* Retrieves up to max_records of the most recent records (of all cores), in
+* no particular order. Records being written are skipped.
+*
+* @return number of records copied
+*/
+unsigned int of1x_get_flight_records(struct of1x_pipeline* pipeline, of1x_flight_record_t* records, unsigned int max_records);
+
+/**
+* @ingroup core_of1x
+* Clears all the records
+*/
+rofl_result_t of1x_clear_flight_recorder(struct of1x_pipeline* pipeline);
+
+/**
+* @ingroup core_of1x
+* Dumps the records (logging)
+*/
+void of1x_dump_flight_recorder(struct of1x_pipeline* pipeline);
+
+/**
+* @ingroup core_of1x
+* Returns the name of a verdict
+*/
+const char* of1x_flight_verdict_str(of1x_flight_verdict_t verdict);
+
+//Release the rings
+void __of1x_flight_recorder_destroy(struct of1x_pipeline* pipeline);
+
+//Recording (pipeline internal). Only called if the recorder is enabled; sample_rate
+//is the (non zero) rate read by the caller
+of1x_flight_record_t* __of1x_flight_recorder_begin(struct of1x_pipeline* pipeline, uint32_t sample_rate, uint32_t port_in, uint32_t pkt_size_bytes, uint16_t eth_type);
+void __of1x_flight_recorder_end(struct of1x_pipeline* pipeline, of1x_flight_record_t* record, of1x_flight_verdict_t verdict);
+
+//Record of the packet in process in the calling core (pipeline->flight_recorder
+//rings); NULL if it is not sampled. Checked before gathering what to record
+static inline of1x_flight_record_t* __of1x_flight_recorder_current(of1x_flight_recorder_core_t* cores){
+	if(!cores)
+		return NULL;
+	return cores[__per_core_id()].current;
+}
+
+//Records the group executed and the bucket (index in the bucket list)
+static inline void __of1x_flight_recorder_group(of1x_flight_record_t* record, uint32_t group_id, uint32_t bucket){
+	record->group_id = group_id;
+	record->bucket = bucket;
+}
+
+//Records an output
+static inline void __of1x_flight_recorder_output(of1x_flight_record_t* record, uint32_t port_num){
+	record->num_of_outputs++;
+	record->output_port = port_num;
+}
+
+//Records a packet-in action dropped by the limiter (not an output)
+static inline void __of1x_flight_recorder_pkt_in_limited(of1x_flight_record_t* record){
+	record->num_of_pkt_in_limited++;
+}
+
+//Records a table visited
+static inline void __of1x_flight_recorder_hop(of1x_flight_record_t* record, unsigned int table_id, struct of1x_flow_entry* entry, uint64_t cookie){
+	of1x_flight_hop_t* hop;
+
+	if(record->num_of_hops < OF1X_FLIGHT_RECORDER_MAX_HOPS){
+		hop = &record->hops[record->num_of_hops];
+		hop->table_id = table_id;
+		hop->matched = (entry != NULL);
+		hop->entry = entry;
+		hop->cookie = cookie;
+	}
+	if(record->num_of_hops < 0xFF)
+		record->num_of_hops++;
+}
+
+//C++ extern C
+ROFL_END_DECLS
+
+#endif //OF1X_FLIGHT_RECORDER
@@ -1,6 +1,6 @@
 #include "of1x_flow_entry.h"
 
-#include "../../../platform/memory.h"
+#include "../../../common/slab.h"
 #include "../of1x_async_events_hooks.h"
 
 #include <assert.h>
@@ -19,7 +19,7 @@
 
 of1x_flow_entry_t* of1x_init_flow_entry(of1x_flow_entry_t* prev, of1x_flow_entry_t* next, bool notify_removal){
 
-	of1x_flow_entry_t* entry = (of1x_flow_entry_t*)platform_malloc_shared(sizeof(of1x_flow_entry_t));
+	of1x_flow_entry_t* entry = (of1x_flow_entry_t*)__slab_malloc(sizeof(of1x_flow_entry_t));
 	
 	if(!entry)
 		return NULL;
@@ -27,7 +27,7 @@ of1x_flow_entry_t* of1x_init_flow_entry(of1x_flow_entry_t* prev, of1x_flow_entry
 	memset(entry,0,sizeof(of1x_flow_entry_t));	
 	
 	if(NULL == (entry->rwlock = platform_rwlock_init(NULL))){
-		platform_free_shared(entry);
+		__slab_free(entry);
 		assert(0);
 		return NULL; 
 	}
@@ -55,6 +55,8 @@ of1x_flow_entry_t* of1x_init_flow_entry(of1x_flow_entry_t* prev, of1x_flow_entry
 
 //This function is meant to only be used internally
 rofl_result_t __of1x_destroy_flow_entry_with_reason(of1x_flow_entry_t* entry, of1x_flow_remove_reason_t reason){
+
+	slab_batch_t batch;
 	
 	//wait for any thread which is still using the entry (processing a packet)
 	platform_rwlock_wrlock(entry->rwlock);
@@ -70,19 +72,28 @@ rofl_result_t __of1x_destroy_flow_entry_with_reason(of1x_flow_entry_t* entry, of
 			
 	}	
 
+	//Discount the counters from the table aggregates
+	if(entry->table)
+		__of1x_stats_table_sub_flow_counts(entry->table, entry->stats.packet_count, entry->stats.byte_count);
+
 	//destroy stats
 	__of1x_destroy_flow_stats(entry);
 
+	//Matches, ternaries, actions and the entry itself are returned to
+	//the slab at once
+	__slab_batch_init(&batch);
+
 	//Destroy matches group 
-	__of1x_destroy_match_group(&entry->matches);
+	__of1x_destroy_match_group(&entry->matches, &batch);
 
 	//Destroy instructions
-	__of1x_destroy_instruction_group(&entry->inst_grp);
+	__of1x_destroy_instruction_group(&entry->inst_grp, &batch);
 	
 	platform_rwlock_destroy(entry->rwlock);
 	
 	//Destroy entry itself
-	platform_free_shared(entry);	
+	__slab_batch_free(&batch, entry);
+	__slab_batch_flush(&batch);
 	
 	return ROFL_SUCCESS;
 }
@@ -126,8 +137,18 @@ rofl_result_t of1x_add_match_to_entry(of1x_flow_entry_t* entry, of1x_match_t* ma
 #endif
 }
 
-rofl_result_t __of1x_update_flow_entry(of1x_flow_entry_t* entry_to_update, of1x_flow_entry_t* mod, bool reset_counts){
+rofl_result_t __of1x_update_flow_entry(of1x_flow_entry_t* entry_to_update, of1x_flow_entry_t* mod, bool reset_counts, bool transfer){
 
+	of1x_instruction_group_t copy;
+	of1x_instruction_group_t* inst_grp = &mod->inst_grp;
+
+	//Clone the instructions (outside the entry lock) if mod has to be preserved
+	if(!transfer){
+		__of1x_init_instruction_group(&copy);
+		if(__of1x_copy_instruction_group(&mod->inst_grp, &copy) != ROFL_SUCCESS)
+			return ROFL_FAILURE;
+		inst_grp = &copy;
+	}
 
 	// let the platform do the necessary updates
 	platform_of1x_modify_entry_hook(entry_to_update, mod, reset_counts);
@@ -135,8 +156,8 @@ rofl_result_t __of1x_update_flow_entry(of1x_flow_entry_t* entry_to_update, of1x_
 	//Lock entry
 	platform_rwlock_wrlock(entry_to_update->rwlock);
 
-	//Copy instructions
-	__of1x_update_instructions(&entry_to_update->inst_grp, &mod->inst_grp);
+	//Move instructions
+	__of1x_update_instructions(&entry_to_update->inst_grp, inst_grp);
 
 	//Reset counts
 	if(reset_counts)
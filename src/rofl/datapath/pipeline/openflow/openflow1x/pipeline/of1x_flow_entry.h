@@ -49,6 +49,8 @@ typedef enum of1x_flow_remove_reason {
 	OF1X_FLOW_REMOVE_HARD_TIMEOUT=1,		/* Time exceeded hard_timeout. */
 	OF1X_FLOW_REMOVE_DELETE=2,			/* Evicted by a DELETE flow mod. */
 	OF1X_FLOW_REMOVE_GROUP_DELETE=3,		/* Group was removed. */
+	OF1X_FLOW_REMOVE_METER_DELETE=4,		/* Meter was removed. */
+	OF1X_FLOW_REMOVE_EVICTION=5,			/* Evicted to make room for a new entry (table full). */
 
 	OF1X_FLOW_REMOVE_NO_REASON = 0xFF		/* No reason -> do not notify */
 }of1x_flow_remove_reason_t;
@@ -100,6 +102,13 @@ typedef struct of1x_flow_entry{
 	//statistics
 	of1x_stats_flow_t stats;
 
+	//Eviction (see of1x_set_table_capacity()). Importance is set by the platform
+	//(0 by default); the recency list is protected by table->mutex
+	uint16_t importance;
+	bool referenced;		//Hit since the entry was last visited by the eviction sweep
+	struct of1x_flow_entry* recency_prev;
+	struct of1x_flow_entry* recency_next;
+
 	//RWlock
 	platform_rwlock_t* rwlock;
 
@@ -132,8 +141,9 @@ rofl_result_t of1x_destroy_flow_entry(of1x_flow_entry_t* entry);
 */
 rofl_result_t of1x_add_match_to_entry(of1x_flow_entry_t* entry, of1x_match_t* match);
 
-//Update entry
-rofl_result_t __of1x_update_flow_entry(of1x_flow_entry_t* entry_to_update, of1x_flow_entry_t* mod, bool reset_counts);
+//Update entry. If transfer is set, the instructions of mod are moved (no allocations) and
+//mod is left without them; otherwise they are copied
+rofl_result_t __of1x_update_flow_entry(of1x_flow_entry_t* entry_to_update, of1x_flow_entry_t* mod, bool reset_counts, bool transfer);
 
 //Fast validation against OF version
 rofl_result_t __of1x_validate_flow_entry(of1x_flow_entry_t* entry, struct of1x_pipeline* pipeline);
@@ -143,6 +153,12 @@ bool __of1x_flow_entry_check_equal(of1x_flow_entry_t*const original, of1x_flow_e
 bool __of1x_flow_entry_check_overlap(of1x_flow_entry_t*const original, of1x_flow_entry_t*const entry, bool check_priority, bool check_cookie, uint32_t out_port, uint32_t out_group);
 bool __of1x_flow_entry_check_contained(of1x_flow_entry_t*const original, of1x_flow_entry_t*const subentry, bool check_priority, bool check_cookie, uint32_t out_port, uint32_t out_group, bool reverse_out_check);
 
+//Marks the entry as hit, for the eviction sweep (the flag is only written once per sweep)
+static inline void __of1x_flow_entry_mark_referenced(of1x_flow_entry_t* entry){
+	if(!entry->referenced)
+		entry->referenced = true;
+}
+
 //Dump flow
 /**
 * @brief Dumps the flow entry for debugging purposes.  
@@ -1,6 +1,10 @@
 #include "of1x_flow_table.h"
 
+#include <string.h>
+#include "../../../platform/cutil.h"
+#include "../../../platform/memory.h"
 #include "../../../util/logging.h"
+#include "../../../common/per_core.h"
 
 #include "of1x_group_table.h"
 #include "of1x_pipeline.h"
@@ -229,12 +233,21 @@ rofl_result_t __of1x_init_table(struct of1x_pipeline* pipeline, of1x_flow_table_
 		return ROFL_FAILURE;
 	if(NULL == (table->rwlock = platform_rwlock_init(NULL)))
 		return ROFL_FAILURE;
+	if(NULL == (table->ma_rwlock = platform_rwlock_init(NULL)))
+		return ROFL_FAILURE;
 	
 	table->pipeline = pipeline;
 	table->number = table_index;
 	table->entries = NULL;
 	table->num_of_entries = 0;
 	table->max_entries = OF1X_MAX_NUMBER_OF_TABLE_ENTRIES;
+	table->eviction = OF1X_TABLE_EVICTION_NONE;
+	table->recency_head = table->recency_tail = NULL;
+	table->entries_version = 0;
+	table->shadow_sample_rate = 0;
+	table->shadow_cores = NULL;
+	table->shadow_log_ms = 0;
+	table->shadow_logged = 0;
 
 	//Set name
 	snprintf(table->name, OF1X_MAX_TABLE_NAME_LEN, "table%u", table_index);
@@ -243,6 +256,7 @@ rofl_result_t __of1x_init_table(struct of1x_pipeline* pipeline, of1x_flow_table_
 	if(! (algorithm < of1x_matching_algorithm_count)){
 		platform_mutex_destroy(table->mutex);
 		platform_rwlock_destroy(table->rwlock);
+		platform_rwlock_destroy(table->ma_rwlock);
 		return ROFL_FAILURE;
 	}
 
@@ -273,6 +287,7 @@ rofl_result_t __of1x_init_table(struct of1x_pipeline* pipeline, of1x_flow_table_
 		default:
 			platform_mutex_destroy(table->mutex);
 			platform_rwlock_destroy(table->rwlock);
+			platform_rwlock_destroy(table->ma_rwlock);
 			return ROFL_FAILURE;
 	}
 
@@ -298,10 +313,13 @@ rofl_result_t __of1x_destroy_table(of1x_flow_table_t* table){
 
 	platform_mutex_destroy(table->mutex);
 	platform_rwlock_destroy(table->rwlock);
+	platform_rwlock_destroy(table->ma_rwlock);
 	
 	//Destroy stats
 	__of1x_stats_table_destroy(table);
 
+	__per_core_free(table->shadow_cores);
+
 	//Do NOT free table, since it was allocated in a single buffer in pipeline.c	
 	return ROFL_SUCCESS;
 }
@@ -323,22 +341,27 @@ inline rofl_of1x_fm_result_t of1x_add_flow_entry_table(of1x_pipeline_t *const pi
 
 	table = &pipeline->tables[table_id];
 
-	//Take rd lock over the grouptable (avoid deletion of groups while flow entry insertion)
+	//Take rd lock over the grouptable and the meter table (avoid deletion of groups/meters while flow entry insertion)
 	platform_rwlock_rdlock(pipeline->groups->rwlock);
+	platform_rwlock_rdlock(pipeline->meters->rwlock);
 
 	//Verify entry
 	if(__of1x_validate_flow_entry(entry, pipeline) != ROFL_SUCCESS){
 		//Release rdlock
+		platform_rwlock_rdunlock(pipeline->meters->rwlock);
 		platform_rwlock_rdunlock(pipeline->groups->rwlock);
 		return ROFL_OF1X_FM_FAILURE;
 	}
 
 
 	//Perform insertion
+	platform_rwlock_rdlock(table->ma_rwlock);
 	result = of1x_matching_algorithms[table->matching_algorithm].add_flow_entry_hook(table, entry, check_overlap, reset_counts);
+	platform_rwlock_rdunlock(table->ma_rwlock);
 
 	if(result != ROFL_OF1X_FM_SUCCESS){
 		//Release rdlock
+		platform_rwlock_rdunlock(pipeline->meters->rwlock);
 		platform_rwlock_rdunlock(pipeline->groups->rwlock);
 		return result;
 	}
@@ -347,6 +370,7 @@ inline rofl_of1x_fm_result_t of1x_add_flow_entry_table(of1x_pipeline_t *const pi
 	__of1x_add_timer(table, entry);
 
 	//Release rdlock
+	platform_rwlock_rdunlock(pipeline->meters->rwlock);
 	platform_rwlock_rdunlock(pipeline->groups->rwlock);
 
 	//Return value
@@ -364,26 +388,32 @@ inline rofl_result_t of1x_modify_flow_entry_table(of1x_pipeline_t *const pipelin
 
 	table = &pipeline->tables[table_id];
 
-	//Take rd lock over the grouptable (avoid deletion of groups while flow entry insertion)
+	//Take rd lock over the grouptable and the meter table (avoid deletion of groups/meters while flow entry insertion)
 	platform_rwlock_rdlock(pipeline->groups->rwlock);
+	platform_rwlock_rdlock(pipeline->meters->rwlock);
 
 	//Verify entry
 	if(__of1x_validate_flow_entry(entry, pipeline) != ROFL_SUCCESS){
 		//Release rdlock
+		platform_rwlock_rdunlock(pipeline->meters->rwlock);
 		platform_rwlock_rdunlock(pipeline->groups->rwlock);
 		return ROFL_FAILURE;
 	}
 
 	//Perform insertion
+	platform_rwlock_rdlock(table->ma_rwlock);
 	result = of1x_matching_algorithms[table->matching_algorithm].modify_flow_entry_hook(table, entry, strict, reset_counts);
+	platform_rwlock_rdunlock(table->ma_rwlock);
 
 	if(result != ROFL_SUCCESS){
 		//Release rdlock
+		platform_rwlock_rdunlock(pipeline->meters->rwlock);
 		platform_rwlock_rdunlock(pipeline->groups->rwlock);
 		return result;
 	}
 	
 	//Release rdlock
+	platform_rwlock_rdunlock(pipeline->meters->rwlock);
 	platform_rwlock_rdunlock(pipeline->groups->rwlock);
 
 	//Return value
@@ -392,6 +422,7 @@ inline rofl_result_t of1x_modify_flow_entry_table(of1x_pipeline_t *const pipelin
 
 inline rofl_result_t of1x_remove_flow_entry_table(of1x_pipeline_t *const pipeline, const unsigned int table_id, of1x_flow_entry_t* entry, const enum of1x_flow_removal_strictness strict, uint32_t out_port, uint32_t out_group){
 	
+	rofl_result_t result;
 	of1x_flow_table_t* table;
 	
 	//Verify table_id
@@ -399,18 +430,28 @@ inline rofl_result_t of1x_remove_flow_entry_table(of1x_pipeline_t *const pipelin
 		return ROFL_FAILURE;
 
 	//Verify entry
-	if(__of1x_validate_flow_entry(entry, pipeline) != ROFL_SUCCESS){
+	platform_rwlock_rdlock(pipeline->groups->rwlock);
+	platform_rwlock_rdlock(pipeline->meters->rwlock);
+	result = __of1x_validate_flow_entry(entry, pipeline);
+	platform_rwlock_rdunlock(pipeline->meters->rwlock);
+	platform_rwlock_rdunlock(pipeline->groups->rwlock);
+	if(result != ROFL_SUCCESS){
 		return ROFL_FAILURE;
 	}
 
 	//Recover table pointer
 	table = &pipeline->tables[table_id];
 	
-	return of1x_matching_algorithms[table->matching_algorithm].remove_flow_entry_hook(table, entry, NULL, strict,  out_port, out_group, OF1X_FLOW_REMOVE_DELETE, MUTEX_NOT_ACQUIRED);
+	platform_rwlock_rdlock(table->ma_rwlock);
+	result = of1x_matching_algorithms[table->matching_algorithm].remove_flow_entry_hook(table, entry, NULL, strict,  out_port, out_group, OF1X_FLOW_REMOVE_DELETE, MUTEX_NOT_ACQUIRED);
+	platform_rwlock_rdunlock(table->ma_rwlock);
+
+	return result;
 }
 
 //This API call should NOT be called from outside pipeline library
 rofl_result_t __of1x_remove_specific_flow_entry_table(of1x_pipeline_t *const pipeline, const unsigned int table_id, of1x_flow_entry_t *const specific_entry, of1x_flow_remove_reason_t reason, of1x_mutex_acquisition_required_t mutex_acquired){
+	rofl_result_t result;
 	of1x_flow_table_t* table;
 	
 	//Verify table_id
@@ -420,11 +461,391 @@ rofl_result_t __of1x_remove_specific_flow_entry_table(of1x_pipeline_t *const pip
 	//Recover table pointer
 	table = &pipeline->tables[table_id];
 	
-	return of1x_matching_algorithms[table->matching_algorithm].remove_flow_entry_hook(table, NULL, specific_entry, STRICT, OF1X_PORT_ANY, OF1X_GROUP_ANY, reason, mutex_acquired);
+	//If the table mutex is already held, no migration can be in progress
+	if(mutex_acquired != MUTEX_NOT_ACQUIRED)
+		return of1x_matching_algorithms[table->matching_algorithm].remove_flow_entry_hook(table, NULL, specific_entry, STRICT, OF1X_PORT_ANY, OF1X_GROUP_ANY, reason, mutex_acquired);
+
+	platform_rwlock_rdlock(table->ma_rwlock);
+	result = of1x_matching_algorithms[table->matching_algorithm].remove_flow_entry_hook(table, NULL, specific_entry, STRICT, OF1X_PORT_ANY, OF1X_GROUP_ANY, reason, mutex_acquired);
+	platform_rwlock_rdunlock(table->ma_rwlock);
+
+	return result;
+}
+
+/*
+* Matching algorithm migration
+*/
+rofl_result_t of1x_set_table_matching_algorithm(of1x_pipeline_t *const pipeline, const unsigned int table_id, const enum of1x_matching_algorithm_available algorithm){
+	
+	of1x_flow_table_t* table;
+	of1x_matching_algorithms_functions_t *from, *to;
+	matching_auxiliary_t* state;
+
+	//Verify table_id and algorithm
+	if(table_id >= pipeline->num_of_tables || !(algorithm < of1x_matching_algorithm_count))
+		return ROFL_FAILURE;
+
+	table = &pipeline->tables[table_id];
+
+	//Wait for ongoing flow mods and block new ones (and timer expirations)
+	platform_rwlock_wrlock(table->ma_rwlock);
+	platform_mutex_lock(table->mutex);
+
+	from = &of1x_matching_algorithms[table->matching_algorithm];
+	to = &of1x_matching_algorithms[algorithm];
+
+	if(!from->migrate_release_hook || !to->migrate_build_hook){
+		ROFL_PIPELINE_ERR("[flowtable] Matching algorithm of table %u cannot be migrated; not supported by the algorithms\n", table->number);
+		goto MIGRATE_ERROR;
+	}
+
+	//Build the new state; lookups keep using the current one
+	table->matching_aux[1] = NULL;
+	if(to->migrate_build_hook(table) != ROFL_SUCCESS){
+		ROFL_PIPELINE_ERR("[flowtable] Unable to build the matching algorithm state of table %u\n", table->number);
+		goto MIGRATE_ERROR;
+	}
+
+	//Switch
+	platform_rwlock_wrlock(table->rwlock);
+	state = table->matching_aux[0];
+	table->matching_aux[0] = table->matching_aux[1];
+	table->matching_aux[1] = state;
+	table->matching_algorithm = algorithm;
+	platform_rwlock_wrunlock(table->rwlock);
+
+	//Release the old state
+	from->migrate_release_hook(table);
+	table->matching_aux[1] = NULL;
+
+	platform_mutex_unlock(table->mutex);
+	platform_rwlock_wrunlock(table->ma_rwlock);
+
+	return ROFL_SUCCESS;
+
+MIGRATE_ERROR:
+	platform_mutex_unlock(table->mutex);
+	platform_rwlock_wrunlock(table->ma_rwlock);
+	return ROFL_FAILURE;
+}
+
+/*
+* Capacity and eviction
+*/
+void __of1x_flow_table_recency_link(of1x_flow_table_t *const table, of1x_flow_entry_t *const entry){
+
+	entry->recency_prev = NULL;
+	entry->recency_next = table->recency_head;
+
+	if(table->recency_head)
+		table->recency_head->recency_prev = entry;
+	else
+		table->recency_tail = entry;
+	table->recency_head = entry;
+}
+
+void __of1x_flow_table_recency_unlink(of1x_flow_table_t *const table, of1x_flow_entry_t *const entry){
+
+	if(entry->recency_prev)
+		entry->recency_prev->recency_next = entry->recency_next;
+	else
+		table->recency_head = entry->recency_next;
+
+	if(entry->recency_next)
+		entry->recency_next->recency_prev = entry->recency_prev;
+	else
+		table->recency_tail = entry->recency_prev;
+
+	entry->recency_prev = entry->recency_next = NULL;
+}
+
+static inline uint64_t __of1x_flow_table_ms(const struct timeval* time){
+	return time->tv_sec*1000ULL + time->tv_usec/1000;
+}
+
+//Milliseconds until the first timeout of the entry expires; UINT64_MAX if it has none
+static uint64_t __of1x_flow_table_entry_lifetime(of1x_flow_entry_t* entry, uint64_t now){
+
+	uint64_t lifetime = UINT64_MAX, expiration;
+
+	if(entry->timer_info.hard_timeout){
+		expiration = __of1x_flow_table_ms(&entry->stats.initial_time) + entry->timer_info.hard_timeout*1000ULL;
+		lifetime = (expiration > now)? expiration - now : 0;
+	}
+	if(entry->timer_info.idle_timeout){
+		expiration = __of1x_flow_table_ms(&entry->timer_info.time_last_update) + entry->timer_info.idle_timeout*1000ULL;
+		expiration = (expiration > now)? expiration - now : 0;
+		if(expiration < lifetime)
+			lifetime = expiration;
+	}
+
+	return lifetime;
+}
+
+of1x_flow_entry_t* __of1x_flow_table_get_eviction_victim(of1x_flow_table_t *const table){
+
+	unsigned int i, visited, num_of_candidates = 0, max_candidates;
+	uint64_t lifetime, victim_lifetime = UINT64_MAX;
+	of1x_flow_entry_t *entry, *prev, *victim;
+	of1x_flow_entry_t* candidates[OF1X_TABLE_EVICTION_CANDIDATES];
+	struct timeval now;
+
+	if(table->eviction == OF1X_TABLE_EVICTION_NONE || !table->recency_tail)
+		return NULL;
+
+	max_candidates = (table->eviction == OF1X_TABLE_EVICTION_LRU)? 1 : OF1X_TABLE_EVICTION_CANDIDATES;
+
+	//Sweep from the least recently used end; entries hit since the last sweep
+	//get a second chance (back to the head), so the cost is amortized by the hits
+	for(entry=table->recency_tail, visited=0; entry && num_of_candidates < max_candidates && visited < table->num_of_entries; entry=prev, visited++){
+		prev = entry->recency_prev;
+
+		if(entry->referenced){
+			entry->referenced = false;
+			__of1x_flow_table_recency_unlink(table, entry);
+			__of1x_flow_table_recency_link(table, entry);
+			continue;
+		}
+
+		candidates[num_of_candidates++] = entry;
+	}
+
+	//All of them were hit; the oldest one
+	if(!num_of_candidates)
+		return table->recency_tail;
+
+	victim = candidates[0];
+
+	switch(table->eviction){
+		case OF1X_TABLE_EVICTION_IMPORTANCE:
+			for(i=1;i<num_of_candidates;i++){
+				if(candidates[i]->importance < victim->importance)
+					victim = candidates[i];
+			}
+			break;
+		case OF1X_TABLE_EVICTION_LIFETIME:
+			__of1x_gettimeofday(&now, NULL);
+			for(i=0;i<num_of_candidates;i++){
+				lifetime = __of1x_flow_table_entry_lifetime(candidates[i], __of1x_flow_table_ms(&now));
+				if(lifetime < victim_lifetime){
+					victim = candidates[i];
+					victim_lifetime = lifetime;
+				}
+			}
+			break;
+		default:
+			break;
+	}
+
+	return victim;
+}
+
+rofl_result_t of1x_set_table_capacity(of1x_pipeline_t *const pipeline, const unsigned int table_id, unsigned int max_entries, of1x_flow_table_eviction_t eviction){
+
+	of1x_flow_table_t* table;
+	of1x_flow_entry_t* victim;
+	rofl_result_t result = ROFL_SUCCESS;
+
+	if(table_id >= pipeline->num_of_tables || max_entries == 0 || eviction > OF1X_TABLE_EVICTION_MAX)
+		return ROFL_FAILURE;
+
+	table = &pipeline->tables[table_id];
+
+	platform_rwlock_rdlock(table->ma_rwlock);
+	platform_mutex_lock(table->mutex);
+
+	if(table->num_of_entries > max_entries && eviction == OF1X_TABLE_EVICTION_NONE){
+		ROFL_PIPELINE_ERR("[flowtable] Table %u has %u entries; unable to set a capacity of %u without eviction\n", table->number, table->num_of_entries, max_entries);
+		result = ROFL_FAILURE;
+		goto CAPACITY_END;
+	}
+
+	table->max_entries = max_entries;
+	table->eviction = eviction;
+
+	//Evict the excess
+	while(table->num_of_entries > table->max_entries){
+		if( (victim = __of1x_flow_table_get_eviction_victim(table)) == NULL ||
+			of1x_matching_algorithms[table->matching_algorithm].remove_flow_entry_hook(table, NULL, victim, STRICT, OF1X_PORT_ANY, OF1X_GROUP_ANY, OF1X_FLOW_REMOVE_EVICTION, MUTEX_ALREADY_ACQUIRED_NON_STRICT_SEARCH) != ROFL_SUCCESS){
+			result = ROFL_FAILURE;
+			break;
+		}
+	}
+
+CAPACITY_END:
+	platform_mutex_unlock(table->mutex);
+	platform_rwlock_rdunlock(table->ma_rwlock);
+
+	return result;
+}
+
+/*
+* Shadow lookups
+*/
+rofl_result_t of1x_set_table_shadow_lookup(of1x_pipeline_t *const pipeline, const unsigned int table_id, uint32_t sample_rate){
+
+	of1x_flow_table_t* table;
+	of1x_shadow_core_t* cores;
+
+	if(table_id >= pipeline->num_of_tables)
+		return ROFL_FAILURE;
+
+	table = &pipeline->tables[table_id];
+
+	platform_mutex_lock(table->mutex);
+
+	//The loop reference walks table->entries; only the algorithms taking part
+	//in migrations are required to keep it
+	if(sample_rate && !of1x_matching_algorithms[table->matching_algorithm].migrate_build_hook){
+		platform_mutex_unlock(table->mutex);
+		ROFL_PIPELINE_ERR("[flowtable] Algorithm %u of table %u does not keep the list of entries; unable to enable shadow lookups\n", table->matching_algorithm, table->number);
+		return ROFL_FAILURE;
+	}
+
+	if(sample_rate && !table->shadow_cores){
+		cores = (of1x_shadow_core_t*)__per_core_alloc(sizeof(of1x_shadow_core_t));
+		if(!cores){
+			platform_mutex_unlock(table->mutex);
+			return ROFL_FAILURE;
+		}
+
+		//Cores must be visible before the sample rate
+		table->shadow_cores = cores;
+		__sync_synchronize();
+	}
+
+	table->shadow_sample_rate = sample_rate;
+
+	platform_mutex_unlock(table->mutex);
+
+	return ROFL_SUCCESS;
+}
+
+rofl_result_t of1x_get_table_shadow_stats(of1x_pipeline_t *const pipeline, const unsigned int table_id, of1x_shadow_stats_t* stats){
+
+	unsigned int i;
+	of1x_flow_table_t* table;
+
+	if(table_id >= pipeline->num_of_tables || !stats)
+		return ROFL_FAILURE;
+
+	table = &pipeline->tables[table_id];
+
+	memset(stats, 0, sizeof(of1x_shadow_stats_t));
+	stats->sample_rate = table->shadow_sample_rate;
+	stats->mismatches_logged = table->shadow_logged;
+
+	if(!table->shadow_cores)
+		return ROFL_SUCCESS;
+
+	for(i=0;i<ROFL_PIPELINE_MAX_CORES;i++){
+		stats->lookups += table->shadow_cores[i].lookups;
+		stats->mismatches += table->shadow_cores[i].mismatches;
+
+		if(!stats->has_mismatch && table->shadow_cores[i].mismatches){
+			stats->has_mismatch = true;
+			memcpy(&stats->last_mismatch, &table->shadow_cores[i].last_mismatch, sizeof(of1x_packet_matches_t));
+		}
+	}
+
+	return ROFL_SUCCESS;
+}
+
+//Returns the core state if this lookup must be sampled
+static inline of1x_shadow_core_t* __of1x_shadow_sample(of1x_flow_table_t *const table){
+
+	uint32_t sample_rate = table->shadow_sample_rate;
+	of1x_shadow_core_t* core;
+
+	if(!sample_rate || !table->shadow_cores)
+		return NULL;
+
+	core = &table->shadow_cores[__per_core_id()];
+
+	if(core->countdown){
+		core->countdown--;
+		return NULL;
+	}
+	core->countdown = sample_rate-1;
+
+	return core;
+}
+
+static void __of1x_shadow_log_mismatch(of1x_flow_table_t *const table, of1x_packet_matches_t *const pkt, of1x_flow_entry_t* entry, of1x_flow_entry_t* reference, uint32_t reference_priority){
+
+	unsigned int i;
+	uint64_t now, last = table->shadow_log_ms, mismatches = 0;
+	struct timeval tv;
+
+	//At most one mismatch per interval (and only the core winning it) is logged
+	__of1x_gettimeofday(&tv, NULL);
+	now = __of1x_get_time_ms(&tv);
+	if(table->shadow_logged && now - last < OF1X_SHADOW_LOG_INTERVAL_MS)
+		return;
+	if(!__sync_bool_compare_and_swap(&table->shadow_log_ms, last, now))
+		return;
+	table->shadow_logged++;
+
+	for(i=0;i<ROFL_PIPELINE_MAX_CORES;i++)
+		mismatches += table->shadow_cores[i].mismatches;
+
+	ROFL_PIPELINE_WARN("Shadow lookup mismatch in table %u (algorithm %u, %"PRIu64" mismatches so far): entry %p (priority %u), loop entry %p (priority %u). Packet: port_in %u, eth_dst 0x%"PRIx64", eth_src 0x%"PRIx64", eth_type 0x%x, vlan %u, ip_proto %u, ipv4_src 0x%x, ipv4_dst 0x%x, tcp %u->%u, udp %u->%u, metadata 0x%"PRIx64"\n",
+		table->number, table->matching_algorithm, mismatches,
+		entry, entry? entry->priority : 0,
+		reference, reference_priority,
+		pkt->port_in, pkt->eth_dst, pkt->eth_src, pkt->eth_type, pkt->vlan_vid, pkt->ip_proto, pkt->ipv4_src, pkt->ipv4_dst,
+		pkt->tcp_src, pkt->tcp_dst, pkt->udp_src, pkt->udp_dst, pkt->metadata);
+
+	//Full dump (debug)
+	of1x_dump_packet_matches((of_packet_matches_t*)pkt);
+}
+
+static of1x_flow_entry_t* __of1x_find_best_match_table_shadow(of1x_flow_table_t *const table, of1x_packet_matches_t *const pkt, of1x_shadow_core_t* core){
+
+	unsigned int attempt;
+	uint32_t reference_priority = 0, reference_num_of_matches = 0;
+	of1x_flow_entry_t *entry, *reference;
+	bool equivalent;
+
+	for(attempt=0;;attempt++){
+		//Reference lookup first; its entry is only compared, so it is released right away
+		reference = of1x_matching_algorithms[of1x_matching_algorithm_loop].find_best_match_hook(table, pkt);
+		if(reference){
+			reference_priority = reference->priority;
+			reference_num_of_matches = reference->matches.num_elements;
+			platform_rwlock_rdunlock(reference->rwlock);
+		}
+
+		entry = of1x_matching_algorithms[table->matching_algorithm].find_best_match_hook(table, pkt);
+
+		equivalent = (entry == reference) || (entry && reference && entry->priority == reference_priority && entry->matches.num_elements == reference_num_of_matches);
+
+		//Retry once; the table may have been modified in between
+		if(equivalent || attempt)
+			break;
+		if(entry)
+			platform_rwlock_rdunlock(entry->rwlock);
+	}
+
+	core->lookups++;
+
+	if(!equivalent){
+		core->mismatches++;
+		memcpy(&core->last_mismatch, pkt, sizeof(of1x_packet_matches_t));
+		__of1x_shadow_log_mismatch(table, pkt, entry, reference, reference_priority);
+	}
+
+	return entry;
 }
 
 /* Main process_packet_through */
 inline of1x_flow_entry_t* __of1x_find_best_match_table(of1x_flow_table_t *const table, of1x_packet_matches_t *const pkt){
+
+	of1x_shadow_core_t* core;
+
+	if(table->shadow_sample_rate && (core = __of1x_shadow_sample(table)) != NULL)
+		return __of1x_find_best_match_table_shadow(table, pkt, core);
+
 	return of1x_matching_algorithms[table->matching_algorithm].find_best_match_hook(table, pkt);
 }	
 
@@ -11,6 +11,7 @@
 #include <stdint.h>
 #include "rofl.h"
 #include "../../../common/bitmap.h"
+#include "../../../common/per_core.h"
 #include "../../../platform/lock.h"
 #include "of1x_flow_entry.h"
 #include "of1x_timers.h"
@@ -34,8 +35,9 @@
 *  - Remove flow entries
 *
 * Additionally the table contain the pointer's to the matching algorithm using
-* in this particular table. This is set during switch bootstrap and cannot be
-* changed at runtime.
+* in this particular table. This is set during switch bootstrap, and can be
+* changed at runtime via of1x_set_table_matching_algorithm() if both algorithms
+* support live migration.
 *
 * The matching algorithm, in conjunction with the state of the table can perform
 * a packet lookup operation. The API is defined in the data struct matching_algorithm_functions
@@ -54,6 +56,32 @@ struct of1x_pipeline;
 //Agnostic auxiliary matching structures. 
 typedef void matching_auxiliary_t;
 
+//Mismatches of the shadow lookups are logged at most once per interval (per table)
+#define OF1X_SHADOW_LOG_INTERVAL_MS 1000
+
+/**
+* Per-core state of the shadow lookups (see of1x_set_table_shadow_lookup())
+*/
+typedef struct of1x_shadow_core{
+	uint32_t countdown;		/* Lookups until the next sample */
+	uint64_t lookups;		/* Sampled lookups */
+	uint64_t mismatches;		/* Sampled lookups in which the algorithm and loop disagreed */
+	of1x_packet_matches_t last_mismatch;	/* Last packet that mismatched in this core */
+}__attribute__((aligned(ROFL_PIPELINE_CACHE_LINE_SIZE))) of1x_shadow_core_t;
+
+/**
+* @ingroup core_of1x
+* Shadow lookup counters of a table
+*/
+typedef struct of1x_shadow_stats{
+	uint32_t sample_rate;		/* 1 out of sample_rate lookups is checked; 0 disabled */
+	uint64_t lookups;
+	uint64_t mismatches;
+	uint64_t mismatches_logged;	/* Mismatches logged (rate limited) */
+	bool has_mismatch;
+	of1x_packet_matches_t last_mismatch;	/* A packet that mismatched (if has_mismatch) */
+}of1x_shadow_stats_t;
+
 /**
 * Table miss behaviour (ofp_table_config)
 */
@@ -64,6 +92,21 @@ typedef enum{
 	OF1X_TABLE_MISS_MASK       = 3
 }of1x_flow_table_miss_config_t; 
 
+/**
+* @ingroup core_of1x
+* Entry eviction policy, when the table is full (see of1x_set_table_capacity())
+*/
+typedef enum of1x_flow_table_eviction{
+	OF1X_TABLE_EVICTION_NONE	= 0,	/* Additions fail (ROFL_OF1X_FM_TABLE_FULL) */
+	OF1X_TABLE_EVICTION_LRU		= 1,	/* Least recently hit entry */
+	OF1X_TABLE_EVICTION_IMPORTANCE	= 2,	/* Lowest importance */
+	OF1X_TABLE_EVICTION_LIFETIME	= 3,	/* Nearest (hard or idle) timeout */
+	OF1X_TABLE_EVICTION_MAX		= OF1X_TABLE_EVICTION_LIFETIME
+}of1x_flow_table_eviction_t;
+
+//Least recently hit entries among which the IMPORTANCE and LIFETIME policies choose
+#define OF1X_TABLE_EVICTION_CANDIDATES 8
+
 /**
 * Table configuration
 */
@@ -101,6 +144,21 @@ typedef struct of1x_flow_table{
 	of1x_flow_entry_t* entries;
 	unsigned int num_of_entries;
 	unsigned int max_entries;    	/* Max number of entries supported. */
+	of1x_flow_table_eviction_t eviction;	/* What to do when max_entries is reached */
+
+	/**
+	* Entries by recency (table->mutex), most recent first. Entries are
+	* added at the head; hits only set entry->referenced, and the eviction
+	* sweep moves the referenced entries back to the head (second chance)
+	*/
+	of1x_flow_entry_t* recency_head;
+	of1x_flow_entry_t* recency_tail;
+
+	/**
+	* Incremented by the matching algorithm (with the rwlock held) every time
+	* an entry is removed. Flow stats cursors use it to validate their position.
+	*/
+	uint64_t entries_version;
 
 	//Timers associated
 #if OF1X_TIMER_STATIC_ALLOCATION_SLOTS
@@ -119,17 +177,29 @@ typedef struct of1x_flow_table{
 	
 	/**
 	* Place-holder to allow matching algorithms
-	* keep its own state
+	* keep its own state. matching_aux[1] is used to build
+	* the state of the new algorithm during migrations
 	*/
 	matching_auxiliary_t* matching_aux[2];
 
 	//Mutexes
 	platform_mutex_t* mutex; //Mutual exclusion among insertion/deletion threads
 	platform_rwlock_t* rwlock; //Readers mutex
+	platform_rwlock_t* ma_rwlock; //Matching algorithm migrations (writer) vs. flow mods (readers)
 
 	//Reference back
 	struct of1x_pipeline* pipeline;
 
+	/**
+	* Shadow lookups: 1 out of shadow_sample_rate lookups (0 disabled) is
+	* repeated with the loop algorithm, and the results compared.
+	* shadow_cores (ROFL_PIPELINE_MAX_CORES) is kept until the table is destroyed
+	*/
+	uint32_t shadow_sample_rate;
+	of1x_shadow_core_t* shadow_cores;
+	volatile uint64_t shadow_log_ms;	//Last mismatch logged
+	uint64_t shadow_logged;
+
 	/* 
 	* Matching algorithm identifier 
 	*/
@@ -241,6 +311,83 @@ rofl_result_t of1x_remove_flow_entry_table(struct of1x_pipeline *const pipeline,
 //This API call is meant to ONLY be used internally within the pipeline library (timers)
 rofl_result_t __of1x_remove_specific_flow_entry_table(struct of1x_pipeline *const pipeline, const unsigned int table_id, of1x_flow_entry_t *const specific_entry, of1x_flow_remove_reason_t reason, of1x_mutex_acquisition_required_t mutex_acquired);
 
+/**
+* @ingroup core_of1x 
+* Migrates a live table to another matching algorithm (or rebuilds the state of the current one).
+*
+* The state of the new algorithm is built from the existing entries while lookups are
+* served by the current one; then the table is switched atomically. Entries (and thus
+* their stats and timers) are preserved. Flow mods on the table are blocked during
+* the migration.
+*
+* Both algorithms must implement the migration hooks.
+*
+* @param pipeline Switch pipeline
+* @param table_id Table index
+* @param algorithm New matching algorithm
+*/
+rofl_result_t of1x_set_table_matching_algorithm(struct of1x_pipeline *const pipeline, const unsigned int table_id, const enum of1x_matching_algorithm_available algorithm);
+
+/**
+* @ingroup core_of1x
+* Enables (or disables, sample_rate 0) the shadow lookups of a table.
+*
+* One out of sample_rate lookups (per core) is also performed with the loop
+* algorithm; if the entries returned differ, the mismatch is counted and
+* logged along with the packet matches (at most once every
+* OF1X_SHADOW_LOG_INTERVAL_MS per table). Entries with the same priority and
+* number of matches are considered equivalent (overlapping entries with the
+* same priority may be matched in any order).
+*
+* This allows validating an algorithm against loop on live traffic; for
+* large sample rates (e.g. 10000) the overhead is negligible.
+*
+* Fails for algorithms not keeping table->entries (those without a
+* migrate_build_hook), since loop could not see the entries.
+*
+* @param pipeline Switch pipeline
+* @param table_id Table index
+* @param sample_rate 1 out of sample_rate lookups is checked (0 disables)
+*/
+rofl_result_t of1x_set_table_shadow_lookup(struct of1x_pipeline *const pipeline, const unsigned int table_id, uint32_t sample_rate);
+
+/**
+* @ingroup core_of1x
+* Retrieves the shadow lookup counters of a table
+*/
+rofl_result_t of1x_get_table_shadow_stats(struct of1x_pipeline *const pipeline, const unsigned int table_id, of1x_shadow_stats_t* stats);
+
+/**
+* @ingroup core_of1x
+* Sets the maximum number of entries of a table, and the eviction policy.
+*
+* When the table is full, the addition of a new entry (not replacing an
+* identical one) either fails with ROFL_OF1X_FM_TABLE_FULL or, if the table
+* has an eviction policy, removes an existing entry first. Evicted entries
+* are notified (flow removed, if requested) with OF1X_FLOW_REMOVE_EVICTION.
+*
+* The victim is found in (amortized) constant time: LRU evicts the least
+* recently hit entry; IMPORTANCE and LIFETIME pick the entry with the lowest
+* importance or the nearest timeout among the OF1X_TABLE_EVICTION_CANDIDATES
+* least recently hit ones.
+*
+* If the table holds more than max_entries, the excess is evicted; without
+* an eviction policy the call fails instead.
+*
+* @param pipeline Switch pipeline
+* @param table_id Table index
+* @param max_entries Maximum number of entries (at least 1)
+* @param eviction Eviction policy
+*/
+rofl_result_t of1x_set_table_capacity(struct of1x_pipeline *const pipeline, const unsigned int table_id, unsigned int max_entries, of1x_flow_table_eviction_t eviction);
+
+//Recency list (table->mutex held)
+void __of1x_flow_table_recency_link(of1x_flow_table_t *const table, of1x_flow_entry_t *const entry);
+void __of1x_flow_table_recency_unlink(of1x_flow_table_t *const table, of1x_flow_entry_t *const entry);
+
+//Entry to evict according to the table policy, or NULL (table->mutex held)
+of1x_flow_entry_t* __of1x_flow_table_get_eviction_victim(of1x_flow_table_t *const table);
+
 /*
 * Entry lookup. This should never be used directly
 */ 
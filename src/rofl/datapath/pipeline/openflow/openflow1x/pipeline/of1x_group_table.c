@@ -11,6 +11,7 @@
  */
 #include "of1x_group_table.h"
 #include "of1x_pipeline.h"
+#include "../of1x_switch.h"
 #include "../../../platform/memory.h"
 #include "../../../util/logging.h"
 #include <stdio.h>
@@ -30,6 +31,14 @@ of1x_group_table_t* of1x_init_group_table(){
 	gt->num_of_entries = 0;
 	gt->head = NULL;
 	gt->tail = NULL;
+	gt->select_hash_fields = OF1X_GROUP_SELECT_HASH_DEFAULT;
+	
+	gt->hash_index = (of1x_group_t**) platform_malloc_shared(sizeof(of1x_group_t*)*OF1X_GROUP_TABLE_HASH_SIZE);
+	if(gt->hash_index == NULL){
+		platform_free_shared(gt);
+		return NULL;
+	}
+	memset(gt->hash_index, 0, sizeof(of1x_group_t*)*OF1X_GROUP_TABLE_HASH_SIZE);
 	
 	gt->rwlock = platform_rwlock_init(NULL);
 	
@@ -49,7 +58,7 @@ void of1x_destroy_group_table(of1x_group_table_t* gt){
 	
 	platform_rwlock_destroy(gt->rwlock);
 	
-	
+	platform_free_shared(gt->hash_index);
 	platform_free_shared(gt);
 }
 
@@ -65,15 +74,47 @@ rofl_result_t of1x_fetch_group_table(of1x_pipeline_t *pipeline, of1x_group_table
 	return ROFL_SUCCESS;
 }
 
+rofl_result_t of1x_set_group_table_select_hash(of1x_group_table_t *gt, bitmap32_t fields){
+	
+	if(!fields)
+		return ROFL_FAILURE;
+
+	gt->select_hash_fields = fields;
+	return ROFL_SUCCESS;
+}
+
+static inline uint32_t __of1x_group_hash(uint32_t id){
+	//Multiplicative (Fibonacci) hashing
+	return (id * 2654435761U) >> (32 - OF1X_GROUP_TABLE_HASH_BITS);
+}
+
+static void __of1x_group_hash_insert(of1x_group_table_t *gt, of1x_group_t *ge){
+	uint32_t h = __of1x_group_hash(ge->id);
+	
+	ge->hash_next = gt->hash_index[h];
+	gt->hash_index[h] = ge;
+}
+
+static void __of1x_group_hash_remove(of1x_group_table_t *gt, of1x_group_t *ge){
+	of1x_group_t **it;
+	
+	for(it = &gt->hash_index[__of1x_group_hash(ge->id)]; *it; it = &(*it)->hash_next){
+		if(*it == ge){
+			*it = ge->hash_next;
+			break;
+		}
+	}
+	ge->hash_next = NULL;
+}
+
 /**
  * Searches in the table for an entry with a specific id
  * returns pointer if found or NULL if not
  */
 of1x_group_t* __of1x_group_search(of1x_group_table_t *gt, uint32_t id){
-	of1x_group_t *iterator=NULL, *next=NULL;
+	of1x_group_t *iterator;
 	
-	for(iterator=gt->head; iterator!=NULL; iterator=next){
-		next=iterator->next;
+	for(iterator=gt->hash_index[__of1x_group_hash(id)]; iterator!=NULL; iterator=iterator->hash_next){
 		if(iterator->id == id)
 			return iterator;
 	}
@@ -94,13 +135,16 @@ rofl_of1x_gm_result_t __of1x_check_group_parameters(of1x_group_table_t *gt, of1x
 			return ret_val;
 	}
 	
-	//Group types not supported
-	if (type == OF1X_GROUP_TYPE_SELECT || type == OF1X_GROUP_TYPE_FF){
-		ROFL_PIPELINE_DEBUG("Warning; group type %u NOT supported\n", type);
-		return ROFL_OF1X_GM_INVAL;
+	//Fast failover buckets must watch a port. Watching groups is not supported (no chaining)
+	if(type == OF1X_GROUP_TYPE_FF){
+		for(bu_it=buckets->head;bu_it!=NULL;bu_it=bu_it->next){
+			if(bu_it->group != OF1X_GROUP_ANY)
+				return ROFL_OF1X_GM_WATCH;
+			if(bu_it->port == OF1X_PORT_ANY || bu_it->port >= LOGICAL_SWITCH_MAX_LOG_PORTS)
+				return ROFL_OF1X_GM_BWATCH;
+		}
 	}
 	
-	
 	if(type == OF1X_GROUP_TYPE_INDIRECT && buckets->num_of_buckets>1)
 		return ROFL_OF1X_GM_INVAL;
 	if( (type == OF1X_GROUP_TYPE_ALL || type == OF1X_GROUP_TYPE_INDIRECT) && __of1x_bucket_list_has_weights(buckets))
@@ -111,6 +155,110 @@ rofl_of1x_gm_result_t __of1x_check_group_parameters(of1x_group_table_t *gt, of1x
 	return ROFL_OF1X_GM_OK;
 }
 
+/*
+* Builds the weighted bucket lookup table of a SELECT group. Slots are
+* distributed proportionally to the bucket weights and interleaved
+* (smooth weighted round-robin), so that consecutive hash values spread
+* over the buckets.
+*/
+static
+rofl_result_t __of1x_build_select_lut(of1x_group_t *ge){
+	
+	unsigned int i, j, max, num_of_buckets = ge->bc_list->num_of_buckets;
+	int32_t total_weight = 0;
+	of1x_bucket_t *bu_it;
+	of1x_bucket_t **lut;
+	
+	if(ge->type != OF1X_GROUP_TYPE_SELECT){
+		ge->select_lut = NULL;
+		return ROFL_SUCCESS;
+	}
+	
+	if(num_of_buckets == 0)
+		return ROFL_FAILURE;
+	
+	int32_t current[num_of_buckets];
+	of1x_bucket_t *buckets[num_of_buckets];
+	
+	for(bu_it=ge->bc_list->head, i=0; bu_it; bu_it=bu_it->next, i++){
+		buckets[i] = bu_it;
+		current[i] = 0;
+		total_weight += bu_it->weight;
+	}
+	
+	if(total_weight == 0)
+		return ROFL_FAILURE;
+	
+	lut = (of1x_bucket_t**)platform_malloc_shared(sizeof(of1x_bucket_t*)*OF1X_GROUP_SELECT_LUT_SIZE);
+	if(!lut)
+		return ROFL_FAILURE;
+	
+	for(j=0; j<OF1X_GROUP_SELECT_LUT_SIZE; j++){
+		max = 0;
+		for(i=0; i<num_of_buckets; i++){
+			current[i] += buckets[i]->weight;
+			if(current[i] > current[max])
+				max = i;
+		}
+		current[max] -= total_weight;
+		lut[j] = buckets[max];
+	}
+	
+	ge->select_lut = lut;
+	return ROFL_SUCCESS;
+}
+
+static inline uint64_t __of1x_group_select_hash_mix(uint64_t hash, uint64_t value){
+	hash ^= value;
+	hash *= 0x9E3779B97F4A7C15ULL;
+	return hash ^ (hash >> 29);
+}
+
+of1x_bucket_t* __of1x_group_select_bucket(of1x_group_t *group, bitmap32_t hash_fields, of1x_packet_matches_t *const matches){
+	
+	uint64_t hash = 0;
+	uint16_t l4_src, l4_dst;
+	
+	if(hash_fields & OF1X_GROUP_SELECT_HASH_ETH){
+		hash = __of1x_group_select_hash_mix(hash, matches->eth_src);
+		hash = __of1x_group_select_hash_mix(hash, matches->eth_dst);
+	}
+	if(hash_fields & OF1X_GROUP_SELECT_HASH_VLAN)
+		hash = __of1x_group_select_hash_mix(hash, matches->vlan_vid);
+	if(hash_fields & OF1X_GROUP_SELECT_HASH_IP_SRC){
+		hash = __of1x_group_select_hash_mix(hash, matches->ipv4_src);
+		hash = __of1x_group_select_hash_mix(hash, UINT128__T_HI(matches->ipv6_src) ^ UINT128__T_LO(matches->ipv6_src));
+	}
+	if(hash_fields & OF1X_GROUP_SELECT_HASH_IP_DST){
+		hash = __of1x_group_select_hash_mix(hash, matches->ipv4_dst);
+		hash = __of1x_group_select_hash_mix(hash, UINT128__T_HI(matches->ipv6_dst) ^ UINT128__T_LO(matches->ipv6_dst));
+	}
+	if(hash_fields & OF1X_GROUP_SELECT_HASH_IP_PROTO)
+		hash = __of1x_group_select_hash_mix(hash, matches->ip_proto);
+	
+	if(hash_fields & (OF1X_GROUP_SELECT_HASH_L4_SRC | OF1X_GROUP_SELECT_HASH_L4_DST)){
+		//Only one of the L4 protocols is set per packet
+		l4_src = matches->tcp_src | matches->udp_src | matches->sctp_src;
+		l4_dst = matches->tcp_dst | matches->udp_dst | matches->sctp_dst;
+		
+		if(hash_fields & OF1X_GROUP_SELECT_HASH_L4_SRC)
+			hash = __of1x_group_select_hash_mix(hash, l4_src);
+		if(hash_fields & OF1X_GROUP_SELECT_HASH_L4_DST)
+			hash = __of1x_group_select_hash_mix(hash, l4_dst);
+	}
+	
+	return group->select_lut[ (hash ^ (hash >> 32)) & (OF1X_GROUP_SELECT_LUT_SIZE-1) ];
+}
+
+//Numbers the buckets of a list, before it is attached to a group
+static void __of1x_group_index_buckets(of1x_bucket_list_t *buckets){
+	unsigned int index = 0;
+	of1x_bucket_t *bc;
+
+	for(bc=buckets->head; bc; bc=bc->next)
+		bc->index = index++;
+}
+
 static
 rofl_of1x_gm_result_t __of1x_init_group(of1x_group_table_t *gt, of1x_group_type_t type, uint32_t id, of1x_bucket_list_t *buckets){
 							//uint32_t weigth, uint32_t group, uint32_t port, of1x_action_group_t **actions){
@@ -131,8 +279,21 @@ rofl_of1x_gm_result_t __of1x_init_group(of1x_group_table_t *gt, of1x_group_type_
 	ge->id = id;
 	ge->type = type;
 	ge->group_table = gt;
+	
+	if(__of1x_build_select_lut(ge) != ROFL_SUCCESS){
+		platform_free_shared(ge);
+		return ROFL_OF1X_GM_OBUCKETS;
+	}
+	
+	if(__of1x_init_group_stats(&ge->stats, buckets->num_of_buckets) != ROFL_SUCCESS){
+		if(ge->select_lut)
+			platform_free_shared(ge->select_lut);
+		platform_free_shared(ge);
+		return ROFL_OF1X_GM_OGRUPS;
+	}
+	__of1x_group_index_buckets(buckets);
+	
 	ge->rwlock = platform_rwlock_init(NULL);
-	__of1x_init_group_stats(&ge->stats);
 	
 	// Count the number of output actions existing inside the group. WARNING For select type groups the count depends on the bucket used!
 	ge->num_of_output_actions = 0;
@@ -154,9 +315,24 @@ rofl_of1x_gm_result_t __of1x_init_group(of1x_group_table_t *gt, of1x_group_type_
 	gt->tail = ge;
 	gt->num_of_entries++;
 	
+	__of1x_group_hash_insert(gt, ge);
+	
 	return ROFL_OF1X_GM_OK;
 }
 
+of1x_bucket_t* __of1x_group_ff_bucket(const struct of1x_switch *sw, of1x_group_t *group){
+	
+	of1x_bucket_t *bu_it;
+	
+	//First bucket whose watch port is live
+	for(bu_it=group->bc_list->head; bu_it; bu_it=bu_it->next){
+		if(__of1x_is_port_live(sw, bu_it->port))
+			return bu_it;
+	}
+	
+	return NULL;
+}
+
 rofl_of1x_gm_result_t of1x_group_add(of1x_group_table_t *gt, of1x_group_type_t type, uint32_t id, of1x_bucket_list_t *buckets){
 							 //uint32_t weigth, uint32_t group, uint32_t port, of1x_action_group_t **actions){
 	rofl_of1x_gm_result_t ret_val;
@@ -186,6 +362,9 @@ void __of1x_destroy_group(of1x_group_table_t *gt, of1x_group_t *ge){
 	//destroy buckets & actions inside
 	of1x_destroy_bucket_list(ge->bc_list);
 	
+	if(ge->select_lut)
+		platform_free_shared(ge->select_lut);
+	
 	__of1x_destroy_group_stats(&ge->stats);
 	
 	platform_rwlock_destroy(ge->rwlock);
@@ -218,6 +397,8 @@ rofl_result_t __of1x_extract_group(of1x_group_table_t *gt, of1x_group_t *ge){
 	if (gt->tail == ge)
 		gt->tail = ge->prev;
 	
+	__of1x_group_hash_remove(gt, ge);
+	
 	gt->num_of_entries--;
 	//leave write lock of the table
 	platform_rwlock_wrunlock(gt->rwlock);
@@ -250,7 +431,7 @@ rofl_of1x_gm_result_t of1x_group_delete(of1x_pipeline_t *pipeline, of1x_group_ta
 	}
 	
 	//search the table for the group
-	if((ge=__of1x_group_search(gt,id))==NULL);
+	if((ge=__of1x_group_search(gt,id))==NULL)
 		return ROFL_OF1X_GM_OK; //if it is not found no need to throw an error
 	
 	//extract the group without destroying it (only the first thread that comes gets it)
@@ -288,10 +469,36 @@ rofl_of1x_gm_result_t of1x_group_modify(of1x_group_table_t *gt, of1x_group_type_
 	
 	platform_rwlock_wrlock(ge->rwlock);
 	
-	of1x_destroy_bucket_list(ge->bc_list);
+	of1x_bucket_list_t *old_buckets = ge->bc_list;
+	of1x_bucket_t **old_lut = ge->select_lut;
+	of1x_group_type_t old_type = ge->type;
+	
 	ge->bc_list = buckets;
-	ge->id = id;
 	ge->type = type;
+	if(__of1x_build_select_lut(ge) != ROFL_SUCCESS){
+		//Restore previous state
+		ge->bc_list = old_buckets;
+		ge->type = old_type;
+		ge->select_lut = old_lut;
+		platform_rwlock_wrunlock(ge->rwlock);
+		return ROFL_OF1X_GM_OBUCKETS;
+	}
+	if(__of1x_stats_group_reset_buckets(&ge->stats, buckets->num_of_buckets) != ROFL_SUCCESS){
+		if(ge->select_lut)
+			platform_free_shared(ge->select_lut);
+		ge->bc_list = old_buckets;
+		ge->type = old_type;
+		ge->select_lut = old_lut;
+		platform_rwlock_wrunlock(ge->rwlock);
+		return ROFL_OF1X_GM_OBUCKETS;
+	}
+	__of1x_group_index_buckets(buckets);
+	
+	of1x_destroy_bucket_list(old_buckets);
+	if(old_lut)
+		platform_free_shared(old_lut);
+	
+	ge->id = id;
 	ge->group_table = gt;
 	/*for(i=0;buckets[i]!=NULL;i++){
 		if(of1x_init_group_bucket(ge,buckets[i])==ROFL_FAILURE){
@@ -340,7 +547,7 @@ of1x_bucket_t* of1x_init_bucket(uint16_t weight, uint32_t port, uint32_t group,
 	bk->port= port;
 	bk->group= group;
 	bk->actions = actions;// actions must be already initialized
-	__of1x_init_bucket_stats(&bk->stats);
+	bk->index = 0;
 	
 	return bk;
 }
@@ -352,7 +559,6 @@ void of1x_destroy_bucket_list(of1x_bucket_list_t *bc_list){
 		next = bk_it->next;
 		//NOTE were are the action groups created and deleted?
 		of1x_destroy_action_group(bk_it->actions);
-		__of1x_destroy_buckets_stats(&bk_it->stats);
 		platform_free_shared(bk_it);
 	}
 	platform_free_shared(bc_list);
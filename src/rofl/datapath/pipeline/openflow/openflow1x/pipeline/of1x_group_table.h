@@ -10,11 +10,19 @@
 #include "of1x_action.h"
 #include "of1x_flow_entry.h"
 #include "../../../platform/lock.h"
+#include "../../../common/bitmap.h"
 
 #define OF1X_GROUP_MAX 0xffffff00
 #define OF1X_GROUP_ALL 0xfffffffc  /* Represents all groups for group delete commands. */
 #define OF1X_GROUP_ANY 0xffffffff /* Wildcard group used only for flow stats */
 
+//Number of slots of the SELECT group bucket lookup table (power of 2)
+#define OF1X_GROUP_SELECT_LUT_SIZE 1024
+
+//Number of buckets of the group id hash index (power of 2)
+#define OF1X_GROUP_TABLE_HASH_BITS 12
+#define OF1X_GROUP_TABLE_HASH_SIZE (1 << OF1X_GROUP_TABLE_HASH_BITS)
+
 /**
 * @file of1x_group_table.h
 * @author Victor Alvarez<victor.alvarez (at) bisdn.de>, Marc Sune<marc.sune (at) bisdn.de>
@@ -30,7 +38,7 @@ typedef struct of1x_bucket{
 	uint32_t port;
 	uint32_t group;
 	of1x_action_group_t *actions;
-	of1x_stats_bucket_counter_t stats;
+	unsigned int index; //Position in the group bucket list (stats column)
 	
 	struct of1x_bucket *next;
 	
@@ -57,6 +65,23 @@ typedef enum{
 	OF1X_GROUP_TYPE_FF	 	= 3,	/* Fast failover group. */
 }of1x_group_type_t;
 
+/**
+* @ingroup core_of1x 
+* Packet fields used to compute the hash for SELECT group bucket selection
+*/
+typedef enum{
+	OF1X_GROUP_SELECT_HASH_ETH		= 1 << 0,	/* Ethernet src and dst addresses */
+	OF1X_GROUP_SELECT_HASH_VLAN		= 1 << 1,	/* VLAN id */
+	OF1X_GROUP_SELECT_HASH_IP_SRC		= 1 << 2,	/* IPv4/IPv6 source address */
+	OF1X_GROUP_SELECT_HASH_IP_DST		= 1 << 3,	/* IPv4/IPv6 destination address */
+	OF1X_GROUP_SELECT_HASH_IP_PROTO		= 1 << 4,	/* IP protocol */
+	OF1X_GROUP_SELECT_HASH_L4_SRC		= 1 << 5,	/* TCP/UDP/SCTP source port */
+	OF1X_GROUP_SELECT_HASH_L4_DST		= 1 << 6,	/* TCP/UDP/SCTP destination port */
+}of1x_group_select_hash_field_t;
+
+//Default SELECT group hash; classic 5-tuple
+#define OF1X_GROUP_SELECT_HASH_DEFAULT ( OF1X_GROUP_SELECT_HASH_IP_SRC | OF1X_GROUP_SELECT_HASH_IP_DST | OF1X_GROUP_SELECT_HASH_IP_PROTO | OF1X_GROUP_SELECT_HASH_L4_SRC | OF1X_GROUP_SELECT_HASH_L4_DST )
+
 struct of1x_group_table;
 
 /**
@@ -76,16 +101,28 @@ typedef struct of1x_group{
 	struct of1x_group *next;
 	struct of1x_group *prev;
 	
+	//Next group in the same hash index bucket
+	struct of1x_group *hash_next;
+	
 	unsigned int num_of_output_actions;
+
+	//SELECT groups only; weighted bucket lookup table (OF1X_GROUP_SELECT_LUT_SIZE slots)
+	of1x_bucket_t **select_lut;
 }of1x_group_t;
 
 typedef struct of1x_group_table{
 	uint32_t num_of_entries;
 	
+	//Fields hashed for SELECT group bucket selection (of1x_group_select_hash_field_t)
+	bitmap32_t select_hash_fields;
+	
 	platform_rwlock_t *rwlock;
 	
 	struct of1x_group *head;
 	struct of1x_group *tail;
+	
+	//Hash index by group id (OF1X_GROUP_TABLE_HASH_SIZE buckets), consistent with the list
+	struct of1x_group **hash_index;
 }of1x_group_table_t;
 
 typedef enum{
@@ -109,6 +146,7 @@ typedef enum{
 
 //fwd decls
 struct of1x_pipeline;
+struct of1x_switch;
 
 //C++ extern C
 ROFL_BEGIN_DECLS
@@ -144,8 +182,21 @@ of1x_bucket_t* of1x_init_bucket(uint16_t weight, uint32_t port, uint32_t group,
 //FIXME: put documentation
 rofl_result_t of1x_insert_bucket_in_list(of1x_bucket_list_t *bu_list,of1x_bucket_t *bucket);
 
+/**
+* @ingroup core_of1x 
+* Sets the packet fields (bitmap of of1x_group_select_hash_field_t) used to select
+* the bucket of SELECT groups. Defaults to OF1X_GROUP_SELECT_HASH_DEFAULT.
+*/
+rofl_result_t of1x_set_group_table_select_hash(of1x_group_table_t *gt, bitmap32_t fields);
+
 of1x_group_t* __of1x_group_search(of1x_group_table_t *gt, uint32_t id);
 
+//Select the bucket of a SELECT group for the packet matches (group rdlock must be held)
+of1x_bucket_t* __of1x_group_select_bucket(of1x_group_t *group, bitmap32_t hash_fields, of1x_packet_matches_t *const matches);
+
+//Returns the first live bucket of a FF group or NULL (group rdlock must be held)
+of1x_bucket_t* __of1x_group_ff_bucket(const struct of1x_switch *sw, of1x_group_t *group);
+
 void of1x_dump_group_table(of1x_group_table_t *gt);
 
 //C++ extern C
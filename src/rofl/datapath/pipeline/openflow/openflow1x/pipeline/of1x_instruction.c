@@ -3,6 +3,7 @@
 #include "../of1x_switch.h"
 #include "of1x_flow_entry.h"
 #include "of1x_group_table.h"
+#include "of1x_meter_table.h"
 
 #include <assert.h> 
 #include "../../../util/logging.h"
@@ -26,16 +27,16 @@ static void __of1x_init_instruction(of1x_instruction_t* inst, of1x_instruction_t
 
 
 
-static void __of1x_destroy_instruction(of1x_instruction_t* inst){
+static void __of1x_destroy_instruction(of1x_instruction_t* inst, slab_batch_t* batch){
 	//Check if empty	
 	if(inst->type == OF1X_IT_NO_INSTRUCTION)
 		return;
 	
 	if(inst->apply_actions)
-		of1x_destroy_action_group(inst->apply_actions);
+		__of1x_destroy_action_group(inst->apply_actions, batch);
 
 	if(inst->write_actions)
-		__of1x_destroy_write_actions(inst->write_actions);
+		__of1x_destroy_write_actions(inst->write_actions, batch);
 }
 
 /* Instruction groups init and destroy */
@@ -44,12 +45,12 @@ void __of1x_init_instruction_group(of1x_instruction_group_t* group){
 	memset(group,0,sizeof(of1x_instruction_group_t));	
 }
 
-void __of1x_destroy_instruction_group(of1x_instruction_group_t* group){
+void __of1x_destroy_instruction_group(of1x_instruction_group_t* group, slab_batch_t* batch){
 
 	unsigned int i;	
 
 	for(i=0;i<OF1X_IT_MAX;i++)
-		__of1x_destroy_instruction(&group->instructions[i]);
+		__of1x_destroy_instruction(&group->instructions[i], batch);
 	
 	group->num_of_instructions=0;
 } 
@@ -57,7 +58,7 @@ void __of1x_destroy_instruction_group(of1x_instruction_group_t* group){
 //Removal of instruction from the group.
 void of1x_remove_instruction_from_the_group(of1x_instruction_group_t* group, of1x_instruction_type_t type){
 	
-	__of1x_destroy_instruction(&group->instructions[OF1X_SAFE_IT_TYPE_INDEX(type)]);
+	__of1x_destroy_instruction(&group->instructions[OF1X_SAFE_IT_TYPE_INDEX(type)], NULL);
 	group->num_of_instructions--;
 }
 
@@ -76,6 +77,15 @@ void of1x_add_instruction_to_group(of1x_instruction_group_t* group, of1x_instruc
 	//flow be installed/modified/deleted
 }
 
+void of1x_add_meter_instruction_to_group(of1x_instruction_group_t* group, uint32_t meter_id){
+
+	of1x_add_instruction_to_group(group, OF1X_IT_METER, NULL, NULL, NULL, 0);
+
+	//Meter pointer is resolved during validation
+	group->instructions[OF1X_SAFE_IT_TYPE_INDEX(OF1X_IT_METER)].meter_id = meter_id;
+	group->instructions[OF1X_SAFE_IT_TYPE_INDEX(OF1X_IT_METER)].meter = NULL;
+}
+
 
 //Update instructions
 rofl_result_t __of1x_update_instructions(of1x_instruction_group_t* group, of1x_instruction_group_t* new_group){
@@ -102,6 +112,7 @@ rofl_result_t __of1x_update_instructions(of1x_instruction_group_t* group, of1x_i
 	//Static stuff
 	group->instructions[OF1X_SAFE_IT_TYPE_INDEX(OF1X_IT_CLEAR_ACTIONS)] = new_group->instructions[OF1X_SAFE_IT_TYPE_INDEX(OF1X_IT_CLEAR_ACTIONS)];	
 	group->instructions[OF1X_SAFE_IT_TYPE_INDEX(OF1X_IT_GOTO_TABLE)] = new_group->instructions[OF1X_SAFE_IT_TYPE_INDEX(OF1X_IT_GOTO_TABLE)];
+	group->instructions[OF1X_SAFE_IT_TYPE_INDEX(OF1X_IT_METER)] = new_group->instructions[OF1X_SAFE_IT_TYPE_INDEX(OF1X_IT_METER)];
 			
 
 	//Static stuff
@@ -117,10 +128,23 @@ bool __of1x_instructions_contain_group(of1x_flow_entry_t *const entry, const uns
 		|| __of1x_apply_actions_has(entry->inst_grp.instructions[OF1X_SAFE_IT_TYPE_INDEX(OF1X_IT_APPLY_ACTIONS)].apply_actions,OF1X_AT_GROUP,group_id);
 }
 
+/* Check whether instructions contain meter */
+bool __of1x_instructions_contain_meter(of1x_flow_entry_t *const entry, const unsigned int meter_id){
+
+	const of1x_instruction_t* inst = &entry->inst_grp.instructions[OF1X_SAFE_IT_TYPE_INDEX(OF1X_IT_METER)];
+
+	return inst->type == OF1X_IT_METER && inst->meter_id == meter_id;
+}
+
 /* Process instructions */
 unsigned int __of1x_process_instructions(const struct of1x_switch* sw, const unsigned int table_id, datapacket_t *const pkt, const of1x_instruction_group_t* instructions){
 
 	unsigned int i;
+	const of1x_instruction_t* meter_inst = &instructions->instructions[OF1X_SAFE_IT_TYPE_INDEX(OF1X_IT_METER)];
+
+	//Meter is applied before any other instruction
+	if(meter_inst->type == OF1X_IT_METER && __of1x_meter_process_packet(meter_inst->meter, pkt))
+		return OF1X_IT_DROP_PKT;
 
 	for(i=0;i<OF1X_IT_MAX;i++){
 	
@@ -152,8 +176,8 @@ unsigned int __of1x_process_instructions(const struct of1x_switch* sw, const uns
 	return 0; //NO go-to-table
 }
 
-//Copy (clone) instructions: TODO evaluate if is necessary to check for errors
-void __of1x_copy_instruction_group(of1x_instruction_group_t* origin, of1x_instruction_group_t* dest){
+//Copy (clone) instructions
+rofl_result_t __of1x_copy_instruction_group(of1x_instruction_group_t* origin, of1x_instruction_group_t* dest){
 	
 	unsigned int i;
 	
@@ -166,16 +190,21 @@ void __of1x_copy_instruction_group(of1x_instruction_group_t* origin, of1x_instru
 			case OF1X_IT_EXPERIMENTER: 
     			case OF1X_IT_WRITE_METADATA:
 			case OF1X_IT_GOTO_TABLE:  
+			case OF1X_IT_METER:  
     					dest->instructions[i] = origin->instructions[i];	
 					break;
 			
 			case OF1X_IT_APPLY_ACTIONS:  
     					dest->instructions[i] = origin->instructions[i];	
     					dest->instructions[i].apply_actions = __of1x_copy_action_group(origin->instructions[i].apply_actions);	
+					if(origin->instructions[i].apply_actions && !dest->instructions[i].apply_actions)
+						goto COPY_ERROR;
 					break;
 			case OF1X_IT_WRITE_ACTIONS: 
     					dest->instructions[i] = origin->instructions[i];	
     					dest->instructions[i].write_actions = __of1x_copy_write_actions(origin->instructions[i].write_actions);	
+					if(origin->instructions[i].write_actions && !dest->instructions[i].write_actions)
+						goto COPY_ERROR;
 					break;
 			
 			default: //Empty instruction 
@@ -183,6 +212,21 @@ void __of1x_copy_instruction_group(of1x_instruction_group_t* origin, of1x_instru
 					break;	
 		}
 	}	
+
+	dest->num_of_instructions = origin->num_of_instructions;
+
+	return ROFL_SUCCESS;
+
+COPY_ERROR:
+	//Release what has been copied so far
+	for(;(int)i>=0;i--){
+		if(dest->instructions[i].type == OF1X_IT_APPLY_ACTIONS && dest->instructions[i].apply_actions)
+			__of1x_destroy_action_group(dest->instructions[i].apply_actions, NULL);
+		if(dest->instructions[i].type == OF1X_IT_WRITE_ACTIONS && dest->instructions[i].write_actions)
+			__of1x_destroy_write_actions(dest->instructions[i].write_actions, NULL);
+	}
+	__of1x_init_instruction_group(dest);
+	return ROFL_FAILURE;
 }
 
 
@@ -218,9 +262,9 @@ void __of1x_dump_instructions(of1x_instruction_group_t group){
 					ROFL_PIPELINE_INFO_NO_PREFIX(" GOTO(%u), ",group.instructions[i].go_to_table);
 					break;
     			
-			case OF1X_IT_METER:  //TODO implement
-				assert(0);
-				break;
+			case OF1X_IT_METER:  
+					ROFL_PIPELINE_INFO_NO_PREFIX(" METER(%u), ",group.instructions[i].meter_id);
+					break;
 				
 			case OF1X_IT_NO_INSTRUCTION: //Empty instruction
 				break;
@@ -246,6 +290,7 @@ bool __of1x_instruction_has(of1x_instruction_group_t *inst_grp, of1x_packet_acti
 rofl_result_t __of1x_validate_instructions(of1x_instruction_group_t* inst_grp, of1x_pipeline_t* pipeline){
 	int i, num_of_output_actions=0;
 	of1x_group_table_t *gt = pipeline->groups;
+	of1x_meter_table_t *mt = pipeline->meters;
 	of_version_t version = pipeline->sw->of_ver;
 	
 	//if there is a group action we should check that the group exists
@@ -295,6 +340,10 @@ rofl_result_t __of1x_validate_instructions(of1x_instruction_group_t* inst_grp, o
 				if( (version < OF_VERSION_13))	
 					return ROFL_FAILURE;
 
+				//The meter must exist
+				if( (inst_grp->instructions[i].meter = __of1x_meter_search(mt, inst_grp->instructions[i].meter_id)) == NULL)
+					return ROFL_FAILURE;
+
 				break;
 				
 		}
@@ -69,6 +69,9 @@ typedef enum {
 
 #define OF1X_IT_MAX OF1X_IT_METER
 
+//Returned by __of1x_process_instructions() when the packet must be dropped (e.g. meter band)
+#define OF1X_IT_DROP_PKT 0xFFFFFFFF
+
 //Write metadata instruction
 typedef struct of1x_write_metadata{
 	uint64_t metadata;
@@ -92,6 +95,10 @@ typedef struct of1x_instruction{
 
 	//GO-TO-TABLE
 	unsigned int go_to_table;	
+
+	//METER type only; meter pointer is cached during validation
+	uint32_t meter_id;
+	struct of1x_meter* meter;
 }of1x_instruction_t;
 
 /* Instruction group, using a double-linked-list */ 
@@ -112,6 +119,7 @@ typedef struct of1x_instruction_group{
 
 //Fwd declaration
 struct of1x_switch;
+struct of1x_meter;
 struct of1x_pipeline;
 struct of1x_flow_entry;
 struct of1x_group_table;
@@ -132,7 +140,7 @@ ROFL_BEGIN_DECLS
 //Instruction group
 
 void __of1x_init_instruction_group(of1x_instruction_group_t* group);
-void __of1x_destroy_instruction_group(of1x_instruction_group_t* group);
+void __of1x_destroy_instruction_group(of1x_instruction_group_t* group, slab_batch_t* batch);
 
 //Add/remove instructions to/from group
 /**
@@ -145,6 +153,12 @@ void __of1x_destroy_instruction_group(of1x_instruction_group_t* group);
 */
 void of1x_add_instruction_to_group(of1x_instruction_group_t* group, of1x_instruction_type_t type, of1x_action_group_t* apply_actions, of1x_write_actions_t* write_actions, of1x_write_metadata_t* write_metadata, unsigned int go_to_table);
 /**
+* @brief Adds a METER instruction to the group 
+* @ingroup core_of1x 
+* @param meter_id Id of the meter. The meter must exist when the entry is installed 
+*/
+void of1x_add_meter_instruction_to_group(of1x_instruction_group_t* group, uint32_t meter_id);
+/**
 * @brief Remove an instruction of the group 
 * @ingroup core_of1x 
 * @param group Instruction group 
@@ -152,14 +166,17 @@ void of1x_add_instruction_to_group(of1x_instruction_group_t* group, of1x_instruc
 */
 void of1x_remove_instruction_from_the_group(of1x_instruction_group_t* group, of1x_instruction_type_t type);
 
-//Update instructions
+//Update instructions. Action groups are moved from new_group, which is left without them
 rofl_result_t __of1x_update_instructions(of1x_instruction_group_t* group, of1x_instruction_group_t* new_group);
 
 //Check whether instructions contain group
 bool __of1x_instructions_contain_group(struct of1x_flow_entry *const entry, const unsigned int group_id);
 
-//Copy (clone) instructions: TODO evaluate if is necessary to check for errors
-void __of1x_copy_instruction_group(of1x_instruction_group_t* origin, of1x_instruction_group_t* dest);
+//Check whether instructions contain meter
+bool __of1x_instructions_contain_meter(struct of1x_flow_entry *const entry, const unsigned int meter_id);
+
+//Copy (clone) instructions. On failure, dest is left empty
+rofl_result_t __of1x_copy_instruction_group(of1x_instruction_group_t* origin, of1x_instruction_group_t* dest);
 
 unsigned int __of1x_process_instructions(const struct of1x_switch* sw, const unsigned int table_id, datapacket_t *const pkt, const of1x_instruction_group_t* instructions);
 
@@ -0,0 +1,108 @@
+#include "of1x_latency.h"
+
+#include <string.h>
+#include "of1x_pipeline.h"
+#include "../../../platform/cutil.h"
+#include "../../../platform/memory.h"
+#include "../../../common/per_core.h"
+
+/*
+* Pipeline latency instrumentation
+*/
+
+static const char* __of1x_latency_stage_names[OF1X_LATENCY_STAGE_MAX] = {
+	"lookup",
+	"instructions",
+	"group",
+	"actions",
+};
+
+const char* of1x_latency_stage_str(of1x_latency_stage_t stage){
+	if(stage >= OF1X_LATENCY_STAGE_MAX)
+		return "unknown";
+	return __of1x_latency_stage_names[stage];
+}
+
+#ifdef ROFL_PIPELINE_LATENCY_STATS
+
+static inline size_t __of1x_latency_size(of1x_pipeline_t* pipeline){
+	return sizeof(of1x_latency_hist_t)*ROFL_PIPELINE_MAX_CORES*pipeline->num_of_tables*OF1X_LATENCY_STAGE_MAX;
+}
+
+rofl_result_t __of1x_latency_init(of1x_pipeline_t* pipeline){
+
+	pipeline->latency = (of1x_latency_hist_t*)platform_malloc_shared(__of1x_latency_size(pipeline));
+
+	if(!pipeline->latency)
+		return ROFL_FAILURE;
+
+	memset(pipeline->latency, 0, __of1x_latency_size(pipeline));
+
+	return ROFL_SUCCESS;
+}
+
+void __of1x_latency_destroy(of1x_pipeline_t* pipeline){
+	if(pipeline->latency)
+		platform_free_shared(pipeline->latency);
+	pipeline->latency = NULL;
+}
+
+void __of1x_latency_record(of1x_pipeline_t* pipeline, unsigned int table_id, of1x_latency_stage_t stage, uint64_t cycles){
+
+	unsigned int core_id, bucket;
+	of1x_latency_hist_t* hist;
+
+	if(!pipeline->latency || table_id >= pipeline->num_of_tables)
+		return;
+
+	core_id = __per_core_id();
+
+	hist = &pipeline->latency[(core_id*pipeline->num_of_tables + table_id)*OF1X_LATENCY_STAGE_MAX + stage];
+
+	//log2 bucket
+	bucket = (cycles)? 64 - __builtin_clzll(cycles) : 0;
+	if(bucket >= OF1X_LATENCY_BUCKETS)
+		bucket = OF1X_LATENCY_BUCKETS-1;
+
+	hist->count++;
+	hist->sum += cycles;
+	if(cycles > hist->max)
+		hist->max = cycles;
+	hist->buckets[bucket]++;
+}
+
+#endif //ROFL_PIPELINE_LATENCY_STATS
+
+rofl_result_t of1x_get_pipeline_latency(of1x_pipeline_t* pipeline, unsigned int table_id, of1x_latency_stage_t stage, of1x_latency_hist_t* hist){
+
+	unsigned int i, j;
+	of1x_latency_hist_t* core_hist;
+
+	if(!pipeline->latency || !hist || table_id >= pipeline->num_of_tables || stage >= OF1X_LATENCY_STAGE_MAX)
+		return ROFL_FAILURE;
+
+	memset(hist, 0, sizeof(of1x_latency_hist_t));
+
+	for(i=0;i<ROFL_PIPELINE_MAX_CORES;i++){
+		core_hist = &pipeline->latency[(i*pipeline->num_of_tables + table_id)*OF1X_LATENCY_STAGE_MAX + stage];
+
+		hist->count += core_hist->count;
+		hist->sum += core_hist->sum;
+		if(core_hist->max > hist->max)
+			hist->max = core_hist->max;
+		for(j=0;j<OF1X_LATENCY_BUCKETS;j++)
+			hist->buckets[j] += core_hist->buckets[j];
+	}
+
+	return ROFL_SUCCESS;
+}
+
+rofl_result_t of1x_reset_pipeline_latency(of1x_pipeline_t* pipeline){
+
+	if(!pipeline->latency)
+		return ROFL_FAILURE;
+
+	memset(pipeline->latency, 0, sizeof(of1x_latency_hist_t)*ROFL_PIPELINE_MAX_CORES*pipeline->num_of_tables*OF1X_LATENCY_STAGE_MAX);
+
+	return ROFL_SUCCESS;
+}
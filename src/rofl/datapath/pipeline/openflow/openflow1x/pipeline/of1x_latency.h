@@ -0,0 +1,118 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef __OF1X_LATENCY_H__
+#define __OF1X_LATENCY_H__
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <time.h>
+#include "rofl.h"
+
+/**
+* @file of1x_latency.h
+* @brief Pipeline latency instrumentation
+*
+* Cycle count histograms per table and per processing stage, kept in per-core
+* buffers. The instrumentation is only compiled in if ROFL_PIPELINE_LATENCY_STATS
+* is defined (--enable-pipeline-latency); otherwise the OF1X_LATENCY_XXX macros
+* expand to nothing and the query API returns ROFL_FAILURE.
+*
+* Stages are inclusive: the time of the group stage is also accounted in the
+* instructions (apply actions) or actions (write actions) stage that triggered it.
+*/
+
+//Histogram buckets; bucket i holds samples in [2^(i-1), 2^i) cycles, the last one the rest
+#define OF1X_LATENCY_BUCKETS 29
+
+/**
+* @ingroup core_of1x
+* Pipeline processing stages
+*/
+typedef enum of1x_latency_stage{
+	OF1X_LATENCY_STAGE_LOOKUP = 0,		/* Table lookup (hit or miss) */
+	OF1X_LATENCY_STAGE_INSTRUCTIONS = 1,	/* Instructions, including apply actions */
+	OF1X_LATENCY_STAGE_GROUP = 2,		/* Group (buckets) execution */
+	OF1X_LATENCY_STAGE_ACTIONS = 3,		/* Write actions, including the output */
+	OF1X_LATENCY_STAGE_MAX
+}of1x_latency_stage_t;
+
+/**
+* @ingroup core_of1x
+* Cycle count histogram (4 cache lines)
+*/
+typedef struct of1x_latency_hist{
+	uint64_t count;
+	uint64_t sum;				/* Sum of cycles */
+	uint64_t max;				/* Max cycles */
+	uint64_t buckets[OF1X_LATENCY_BUCKETS];
+}of1x_latency_hist_t;
+
+//Fwd declarations
+struct of1x_pipeline;
+
+//C++ extern C
+ROFL_BEGIN_DECLS
+
+#ifdef ROFL_PIPELINE_LATENCY_STATS
+
+//Current cycle count (time stamp counter where available, ns otherwise)
+static inline uint64_t __of1x_latency_cycles(void){
+#if defined(__x86_64__) || defined(__i386__)
+	return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+	uint64_t cycles;
+	__asm__ __volatile__("mrs %0, cntvct_el0" : "=r" (cycles));
+	return cycles;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec*1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+//Init/destroy per-core buffers
+rofl_result_t __of1x_latency_init(struct of1x_pipeline* pipeline);
+void __of1x_latency_destroy(struct of1x_pipeline* pipeline);
+
+//Record a sample in the calling core buffer
+void __of1x_latency_record(struct of1x_pipeline* pipeline, unsigned int table_id, of1x_latency_stage_t stage, uint64_t cycles);
+
+#define OF1X_LATENCY_START(var) uint64_t var = __of1x_latency_cycles()
+#define OF1X_LATENCY_END(pipeline, table_id, stage, var) __of1x_latency_record((pipeline), (table_id), (stage), __of1x_latency_cycles()-(var))
+
+#else
+
+#define OF1X_LATENCY_START(var)
+#define OF1X_LATENCY_END(pipeline, table_id, stage, var)
+
+#endif //ROFL_PIPELINE_LATENCY_STATS
+
+/**
+* @ingroup core_of1x
+* Retrieves the histogram of a table and stage, aggregated over all cores
+*
+* @return ROFL_FAILURE if table_id or stage are invalid, or the instrumentation
+* has not been compiled in
+*/
+rofl_result_t of1x_get_pipeline_latency(struct of1x_pipeline* pipeline, unsigned int table_id, of1x_latency_stage_t stage, of1x_latency_hist_t* hist);
+
+/**
+* @ingroup core_of1x
+* Resets all the histograms of the pipeline.
+*
+* Samples being recorded concurrently may be partially lost.
+*/
+rofl_result_t of1x_reset_pipeline_latency(struct of1x_pipeline* pipeline);
+
+/**
+* @ingroup core_of1x
+* Returns the name of a stage
+*/
+const char* of1x_latency_stage_str(of1x_latency_stage_t stage);
+
+//C++ extern C
+ROFL_END_DECLS
+
+#endif //OF1X_LATENCY
@@ -2,7 +2,7 @@
 #include "of1x_match.h"
 
 #include "../../../common/datapacket.h"
-#include "../../../platform/memory.h"
+#include "../../../common/slab.h"
 #include "../../../util/logging.h"
 
 /*
@@ -14,7 +14,7 @@
 
 //Phy
 inline of1x_match_t* of1x_init_port_in_match(of1x_match_t* prev, of1x_match_t* next, uint32_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_IN_PORT; 
 	match->value = __init_utern32(value,OF1X_4_BYTE_MASK); //No wildcard
 	match->prev = prev;
@@ -29,7 +29,7 @@ inline of1x_match_t* of1x_init_port_in_match(of1x_match_t* prev, of1x_match_t* n
 }
 
 inline of1x_match_t* of1x_init_port_in_phy_match(of1x_match_t* prev, of1x_match_t* next, uint32_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_IN_PHY_PORT; 
 	match->value = __init_utern32(value,OF1X_4_BYTE_MASK); //No wildcard 
 	match->prev = prev;
@@ -45,7 +45,7 @@ inline of1x_match_t* of1x_init_port_in_phy_match(of1x_match_t* prev, of1x_match_
 
 //METADATA
 inline of1x_match_t* of1x_init_metadata_match(of1x_match_t* prev, of1x_match_t* next, uint64_t value, uint64_t mask){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_METADATA; 
 	match->value = __init_utern64(value, mask);
 	match->prev = prev;
@@ -64,7 +64,7 @@ inline of1x_match_t* of1x_init_metadata_match(of1x_match_t* prev, of1x_match_t*
 
 //ETHERNET
 inline of1x_match_t* of1x_init_eth_dst_match(of1x_match_t* prev, of1x_match_t* next, uint64_t value, uint64_t mask){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_ETH_DST; 
 	match->value = __init_utern64(value&OF1X_48_BITS_MASK, mask&OF1X_48_BITS_MASK); //Enforce mask bits are always 00 for the first bits
 
@@ -82,7 +82,7 @@ inline of1x_match_t* of1x_init_eth_dst_match(of1x_match_t* prev, of1x_match_t* n
 	return match;
 }
 inline of1x_match_t* of1x_init_eth_src_match(of1x_match_t* prev, of1x_match_t* next, uint64_t value, uint64_t mask){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_ETH_SRC; 
 	match->value = __init_utern64(value&OF1X_48_BITS_MASK, mask&OF1X_48_BITS_MASK); //Enforce mask bits are always 00 for the first bits
 	match->prev = prev;
@@ -99,7 +99,7 @@ inline of1x_match_t* of1x_init_eth_src_match(of1x_match_t* prev, of1x_match_t* n
 	return match;
 }
 inline of1x_match_t* of1x_init_eth_type_match(of1x_match_t* prev, of1x_match_t* next, uint16_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_ETH_TYPE; 
 	match->value = __init_utern16(value,OF1X_2_BYTE_MASK); //No wildcard 
 	match->prev = prev;
@@ -115,7 +115,7 @@ inline of1x_match_t* of1x_init_eth_type_match(of1x_match_t* prev, of1x_match_t*
 
 //8021.q
 inline of1x_match_t* of1x_init_vlan_vid_match(of1x_match_t* prev, of1x_match_t* next, uint16_t value, uint16_t mask){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_VLAN_VID; 
 	//Setting values; note that value includes the flag HAS_VLAN in the 13th bit
 	//The mask is set to be strictly 12 bits, so only matching the VLAN ID itself
@@ -134,7 +134,7 @@ inline of1x_match_t* of1x_init_vlan_vid_match(of1x_match_t* prev, of1x_match_t*
 	return match;
 }
 inline of1x_match_t* of1x_init_vlan_pcp_match(of1x_match_t* prev, of1x_match_t* next, uint8_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_VLAN_PCP; 
 	match->value = __init_utern8(value&OF1X_3_BITS_MASK,OF1X_3_BITS_MASK); //Ensure only 3 bit value, no wildcard 
 	match->prev = prev;
@@ -150,7 +150,7 @@ inline of1x_match_t* of1x_init_vlan_pcp_match(of1x_match_t* prev, of1x_match_t*
 
 //MPLS
 inline of1x_match_t* of1x_init_mpls_label_match(of1x_match_t* prev, of1x_match_t* next, uint32_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_MPLS_LABEL; 
 	match->value = __init_utern32(value&OF1X_20_BITS_MASK,OF1X_20_BITS_MASK); //no wildcard?? wtf! 
 	match->prev = prev;
@@ -164,7 +164,7 @@ inline of1x_match_t* of1x_init_mpls_label_match(of1x_match_t* prev, of1x_match_t
 	return match;
 }
 inline of1x_match_t* of1x_init_mpls_tc_match(of1x_match_t* prev, of1x_match_t* next, uint8_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_MPLS_TC; 
 	match->value = __init_utern8(value&OF1X_3_BITS_MASK,OF1X_3_BITS_MASK); //Ensure only 3 bit value, no wildcard 
 	match->prev = prev;
@@ -178,7 +178,7 @@ inline of1x_match_t* of1x_init_mpls_tc_match(of1x_match_t* prev, of1x_match_t* n
 	return match;
 }
 inline of1x_match_t* of1x_init_mpls_bos_match(of1x_match_t* prev, of1x_match_t* next, uint8_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_MPLS_BOS; 
 	match->value = __init_utern8(value&OF1X_1_BIT_MASK,OF1X_1_BIT_MASK); //Ensure only 1 bit value, no wildcard 
 	match->prev = prev;
@@ -195,7 +195,7 @@ inline of1x_match_t* of1x_init_mpls_bos_match(of1x_match_t* prev, of1x_match_t*
 //ARP
 inline of1x_match_t* of1x_init_arp_opcode_match(of1x_match_t* prev, of1x_match_t* next, uint16_t value){
 
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_ARP_OP;
 	match->value = __init_utern16(value,OF1X_2_BYTE_MASK); //No wildcard
 	match->prev = prev;
@@ -209,7 +209,7 @@ inline of1x_match_t* of1x_init_arp_opcode_match(of1x_match_t* prev, of1x_match_t
 	return match;
 }
 inline of1x_match_t* of1x_init_arp_tha_match(of1x_match_t* prev, of1x_match_t* next, uint64_t value, uint64_t mask){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_ARP_THA;
 	match->value = __init_utern64(value&OF1X_48_BITS_MASK, mask&OF1X_48_BITS_MASK); //Enforce mask bits are always 00 for the first bits
 
@@ -227,7 +227,7 @@ inline of1x_match_t* of1x_init_arp_tha_match(of1x_match_t* prev, of1x_match_t* n
 	return match;
 }
 inline of1x_match_t* of1x_init_arp_sha_match(of1x_match_t* prev, of1x_match_t* next, uint64_t value, uint64_t mask){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_ARP_SHA;
 	match->value = __init_utern64(value&OF1X_48_BITS_MASK, mask&OF1X_48_BITS_MASK); //Enforce mask bits are always 00 for the first bits
 	match->prev = prev;
@@ -244,7 +244,7 @@ inline of1x_match_t* of1x_init_arp_sha_match(of1x_match_t* prev, of1x_match_t* n
 	return match;
 }
 inline of1x_match_t* of1x_init_arp_tpa_match(of1x_match_t* prev, of1x_match_t* next, uint32_t value, uint32_t mask){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_ARP_TPA;
 	match->value = __init_utern32(value,mask);
 	match->prev = prev;
@@ -261,7 +261,7 @@ inline of1x_match_t* of1x_init_arp_tpa_match(of1x_match_t* prev, of1x_match_t* n
 	return match;
 }
 inline of1x_match_t* of1x_init_arp_spa_match(of1x_match_t* prev, of1x_match_t* next, uint32_t value, uint32_t mask){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_ARP_SPA;
 	match->value = __init_utern32(value,mask);
 	match->prev = prev;
@@ -280,7 +280,7 @@ inline of1x_match_t* of1x_init_arp_spa_match(of1x_match_t* prev, of1x_match_t* n
 
 //NW
 inline of1x_match_t* of1x_init_nw_proto_match(of1x_match_t* prev, of1x_match_t* next, uint8_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_NW_PROTO; 
 	match->value = __init_utern8(value,OF1X_1_BYTE_MASK); //no wildcard 
 	match->prev = prev;
@@ -294,7 +294,7 @@ inline of1x_match_t* of1x_init_nw_proto_match(of1x_match_t* prev, of1x_match_t*
 	return match;
 }
 inline of1x_match_t* of1x_init_nw_src_match(of1x_match_t* prev, of1x_match_t* next, uint32_t value, uint32_t mask){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_NW_SRC;
 	match->value = __init_utern32(value,mask); 
 	match->prev = prev;
@@ -311,7 +311,7 @@ inline of1x_match_t* of1x_init_nw_src_match(of1x_match_t* prev, of1x_match_t* ne
 	return match;
 }
 inline of1x_match_t* of1x_init_nw_dst_match(of1x_match_t* prev, of1x_match_t* next, uint32_t value, uint32_t mask){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_NW_DST;
 	match->value = __init_utern32(value,mask); 
 	match->prev = prev;
@@ -330,7 +330,7 @@ inline of1x_match_t* of1x_init_nw_dst_match(of1x_match_t* prev, of1x_match_t* ne
 
 //IPv4
 inline of1x_match_t* of1x_init_ip4_src_match(of1x_match_t* prev, of1x_match_t* next, uint32_t value, uint32_t mask){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_IPV4_SRC;
 	match->value = __init_utern32(value,mask); 
 	match->prev = prev;
@@ -347,7 +347,7 @@ inline of1x_match_t* of1x_init_ip4_src_match(of1x_match_t* prev, of1x_match_t* n
 	return match;
 }
 inline of1x_match_t* of1x_init_ip4_dst_match(of1x_match_t* prev, of1x_match_t* next, uint32_t value, uint32_t mask){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_IPV4_DST;
 	match->value = __init_utern32(value,mask); 
 	match->prev = prev;
@@ -364,7 +364,7 @@ inline of1x_match_t* of1x_init_ip4_dst_match(of1x_match_t* prev, of1x_match_t* n
 	return match;
 }
 inline of1x_match_t* of1x_init_ip_proto_match(of1x_match_t* prev, of1x_match_t* next, uint8_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_IP_PROTO; 
 	match->value = __init_utern8(value,OF1X_1_BYTE_MASK); //no wildcard 
 	match->prev = prev;
@@ -378,7 +378,7 @@ inline of1x_match_t* of1x_init_ip_proto_match(of1x_match_t* prev, of1x_match_t*
 	return match;
 }
 inline of1x_match_t* of1x_init_ip_dscp_match(of1x_match_t* prev, of1x_match_t* next, uint8_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_IP_DSCP; 
 	match->value = __init_utern8(value&OF1X_6_BITS_MASK,OF1X_6_BITS_MASK); //no wildcard 
 	match->prev = prev;
@@ -393,7 +393,7 @@ inline of1x_match_t* of1x_init_ip_dscp_match(of1x_match_t* prev, of1x_match_t* n
 }
 
 inline of1x_match_t* of1x_init_ip_ecn_match(of1x_match_t* prev, of1x_match_t* next, uint8_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_IP_ECN; 
 	match->value = __init_utern8(value&OF1X_2_BITS_MASK,OF1X_2_BITS_MASK); //no wildcard 
 	match->prev = prev;
@@ -409,7 +409,7 @@ inline of1x_match_t* of1x_init_ip_ecn_match(of1x_match_t* prev, of1x_match_t* ne
 
 //IPv6
 inline of1x_match_t* of1x_init_ip6_src_match(of1x_match_t* prev, of1x_match_t* next, uint128__t value, uint128__t mask){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	uint128__t fixed_mask = {{0xff,0xff,0xff,0xff, 0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff, 0xff,0xff,0xff,0xff}};
 	match->type = OF1X_MATCH_IPV6_SRC;
 	match->value = __init_utern128(value,mask); 
@@ -427,7 +427,7 @@ inline of1x_match_t* of1x_init_ip6_src_match(of1x_match_t* prev, of1x_match_t* n
 	return match;
 }
 inline of1x_match_t* of1x_init_ip6_dst_match(of1x_match_t* prev, of1x_match_t* next, uint128__t value, uint128__t mask){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	uint128__t fixed_mask = {{0xff,0xff,0xff,0xff, 0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff, 0xff,0xff,0xff,0xff}};
 	match->type = OF1X_MATCH_IPV6_DST;
 	match->value = __init_utern128(value,mask); 
@@ -445,7 +445,7 @@ inline of1x_match_t* of1x_init_ip6_dst_match(of1x_match_t* prev, of1x_match_t* n
 	return match;
 }
 inline of1x_match_t* of1x_init_ip6_flabel_match(of1x_match_t* prev, of1x_match_t* next, uint64_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_IPV6_FLABEL;
 	match->value = __init_utern64(value&OF1X_20_BITS_MASK,OF1X_20_BITS_MASK); // ensure 20 bits. No wildcard
 	match->prev = prev;
@@ -460,7 +460,7 @@ inline of1x_match_t* of1x_init_ip6_flabel_match(of1x_match_t* prev, of1x_match_t
 }
 inline of1x_match_t* of1x_init_ip6_nd_target_match(of1x_match_t* prev, of1x_match_t* next, uint128__t value){
 	
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	uint128__t mask = {{0xff,0xff,0xff,0xff, 0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff, 0xff,0xff,0xff,0xff}};
 	
 	match->type = OF1X_MATCH_IPV6_ND_TARGET;
@@ -476,7 +476,7 @@ inline of1x_match_t* of1x_init_ip6_nd_target_match(of1x_match_t* prev, of1x_matc
 	return match;
 }
 inline of1x_match_t* of1x_init_ip6_nd_sll_match(of1x_match_t* prev, of1x_match_t* next, uint64_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_IPV6_ND_SLL;
 	match->value = __init_utern64(value & OF1X_48_BITS_MASK, OF1X_48_BITS_MASK); //ensure 48 bits. No wildcard
 	match->prev = prev;
@@ -490,7 +490,7 @@ inline of1x_match_t* of1x_init_ip6_nd_sll_match(of1x_match_t* prev, of1x_match_t
 	return match;
 }
 inline of1x_match_t* of1x_init_ip6_nd_tll_match(of1x_match_t* prev, of1x_match_t* next, uint64_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_IPV6_ND_TLL;
 	match->value = __init_utern64(value & OF1X_48_BITS_MASK, OF1X_48_BITS_MASK); //ensure 48 bits. No wildcard
 	match->prev = prev;
@@ -504,7 +504,7 @@ inline of1x_match_t* of1x_init_ip6_nd_tll_match(of1x_match_t* prev, of1x_match_t
 	return match;
 }
 inline of1x_match_t* of1x_init_ip6_exthdr_match(of1x_match_t* prev, of1x_match_t* next, uint16_t value, uint16_t mask){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_IPV6_EXTHDR;
 	match->value = __init_utern16(value&OF1X_9_BITS_MASK, mask & OF1X_9_BITS_MASK );  //ensure 9 bits, with Wildcard
 	match->prev = prev;
@@ -523,7 +523,7 @@ inline of1x_match_t* of1x_init_ip6_exthdr_match(of1x_match_t* prev, of1x_match_t
 
 //ICMPV6
 inline of1x_match_t* of1x_init_icmpv6_type_match(of1x_match_t* prev, of1x_match_t* next, uint8_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_ICMPV6_TYPE;
 	match->value = __init_utern8(value,OF1X_1_BYTE_MASK);
 	match->prev = prev;
@@ -537,7 +537,7 @@ inline of1x_match_t* of1x_init_icmpv6_type_match(of1x_match_t* prev, of1x_match_
 	return match;
 }
 inline of1x_match_t* of1x_init_icmpv6_code_match(of1x_match_t* prev, of1x_match_t* next, uint8_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_ICMPV6_CODE;
 	match->value = __init_utern8(value,OF1X_1_BYTE_MASK);
 	match->prev = prev;
@@ -553,7 +553,7 @@ inline of1x_match_t* of1x_init_icmpv6_code_match(of1x_match_t* prev, of1x_match_
 
 //TCP
 inline of1x_match_t* of1x_init_tcp_src_match(of1x_match_t* prev, of1x_match_t* next, uint16_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_TCP_SRC;
 	match->value = __init_utern16(value,OF1X_2_BYTE_MASK); //no wildcard 
 	match->prev = prev;
@@ -568,7 +568,7 @@ inline of1x_match_t* of1x_init_tcp_src_match(of1x_match_t* prev, of1x_match_t* n
 	return match;
 }
 inline of1x_match_t* of1x_init_tcp_dst_match(of1x_match_t* prev, of1x_match_t* next, uint16_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_TCP_DST;
 	match->value = __init_utern16(value,OF1X_2_BYTE_MASK); //no wildcard 
 	match->prev = prev;
@@ -583,7 +583,7 @@ inline of1x_match_t* of1x_init_tcp_dst_match(of1x_match_t* prev, of1x_match_t* n
 }
 //UDP
 inline of1x_match_t* of1x_init_udp_src_match(of1x_match_t* prev, of1x_match_t* next, uint16_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_UDP_SRC;
 	match->value = __init_utern16(value,OF1X_2_BYTE_MASK); //no wildcard 
 	match->prev = prev;
@@ -597,7 +597,7 @@ inline of1x_match_t* of1x_init_udp_src_match(of1x_match_t* prev, of1x_match_t* n
 	return match;
 }
 inline of1x_match_t* of1x_init_udp_dst_match(of1x_match_t* prev, of1x_match_t* next, uint16_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_UDP_DST;
 	match->value = __init_utern16(value,OF1X_2_BYTE_MASK); //no wildcard 
 	match->prev = prev;
@@ -613,7 +613,7 @@ inline of1x_match_t* of1x_init_udp_dst_match(of1x_match_t* prev, of1x_match_t* n
 
 //SCTP
 inline of1x_match_t* of1x_init_sctp_src_match(of1x_match_t* prev, of1x_match_t* next, uint16_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_SCTP_SRC;
 	match->value = __init_utern16(value,OF1X_2_BYTE_MASK); //no wildcard 
 	match->prev = prev;
@@ -628,7 +628,7 @@ inline of1x_match_t* of1x_init_sctp_src_match(of1x_match_t* prev, of1x_match_t*
 	return match;
 }
 inline of1x_match_t* of1x_init_sctp_dst_match(of1x_match_t* prev, of1x_match_t* next, uint16_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_SCTP_DST;
 	match->value = __init_utern16(value,OF1X_2_BYTE_MASK); //no wildcard 
 	match->prev = prev;
@@ -644,7 +644,7 @@ inline of1x_match_t* of1x_init_sctp_dst_match(of1x_match_t* prev, of1x_match_t*
 
 //TP
 inline of1x_match_t* of1x_init_tp_src_match(of1x_match_t* prev, of1x_match_t* next, uint16_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_TP_SRC;
 	match->value = __init_utern16(value,OF1X_2_BYTE_MASK); //no wildcard 
 	match->prev = prev;
@@ -658,7 +658,7 @@ inline of1x_match_t* of1x_init_tp_src_match(of1x_match_t* prev, of1x_match_t* ne
 	return match;
 }
 inline of1x_match_t* of1x_init_tp_dst_match(of1x_match_t* prev, of1x_match_t* next, uint16_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_TP_DST;
 	match->value = __init_utern16(value,OF1X_2_BYTE_MASK); //no wildcard 
 	match->prev = prev;
@@ -673,7 +673,7 @@ inline of1x_match_t* of1x_init_tp_dst_match(of1x_match_t* prev, of1x_match_t* ne
 }
 //ICMPv4
 inline of1x_match_t* of1x_init_icmpv4_type_match(of1x_match_t* prev, of1x_match_t* next, uint8_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_ICMPV4_TYPE; 
 	match->value = __init_utern8(value,OF1X_1_BYTE_MASK); //no wildcard 
 	match->prev = prev;
@@ -687,7 +687,7 @@ inline of1x_match_t* of1x_init_icmpv4_type_match(of1x_match_t* prev, of1x_match_
 	return match;
 }
 inline of1x_match_t* of1x_init_icmpv4_code_match(of1x_match_t* prev, of1x_match_t* next, uint8_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_ICMPV4_CODE; 
 	match->value = __init_utern8(value,OF1X_1_BYTE_MASK); //no wildcard 
 	match->prev = prev;
@@ -703,7 +703,7 @@ inline of1x_match_t* of1x_init_icmpv4_code_match(of1x_match_t* prev, of1x_match_
 
 //PBB
 inline of1x_match_t* of1x_init_pbb_isid_match(of1x_match_t* prev, of1x_match_t* next, uint32_t value, uint32_t mask){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_PBB_ISID;
 	match->value = __init_utern32(value&OF1X_3_BYTE_MASK, mask&OF1X_3_BYTE_MASK); //no wildcard 
 	match->prev = prev;
@@ -722,7 +722,7 @@ inline of1x_match_t* of1x_init_pbb_isid_match(of1x_match_t* prev, of1x_match_t*
 
 //Tunnel Id
 inline of1x_match_t* of1x_init_tunnel_id_match(of1x_match_t* prev, of1x_match_t* next, uint64_t value, uint64_t mask){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_TUNNEL_ID; 
 	match->value = __init_utern64(value, mask); //no wildcard 
 	match->prev = prev;
@@ -745,7 +745,7 @@ inline of1x_match_t* of1x_init_tunnel_id_match(of1x_match_t* prev, of1x_match_t*
 
 //PPPoE
 inline of1x_match_t* of1x_init_pppoe_code_match(of1x_match_t* prev, of1x_match_t* next, uint8_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_PPPOE_CODE; 
 	match->value = __init_utern8(value&OF1X_1_BYTE_MASK,OF1X_1_BYTE_MASK); //no wildcard 
 	match->prev = prev;
@@ -759,7 +759,7 @@ inline of1x_match_t* of1x_init_pppoe_code_match(of1x_match_t* prev, of1x_match_t
 	return match;
 }
 inline of1x_match_t* of1x_init_pppoe_type_match(of1x_match_t* prev, of1x_match_t* next, uint8_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_PPPOE_TYPE; 
 	match->value = __init_utern8(value&OF1X_4_BITS_MASK,OF1X_4_BITS_MASK); //Ensure only 4 bit value, no wildcard 
 	match->prev = prev;
@@ -773,7 +773,7 @@ inline of1x_match_t* of1x_init_pppoe_type_match(of1x_match_t* prev, of1x_match_t
 	return match;
 }
 inline of1x_match_t* of1x_init_pppoe_session_match(of1x_match_t* prev, of1x_match_t* next, uint16_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_PPPOE_SID; 
 	match->value = __init_utern16(value,OF1X_2_BYTE_MASK); //no wildcard 
 	match->prev = prev;
@@ -788,7 +788,7 @@ inline of1x_match_t* of1x_init_pppoe_session_match(of1x_match_t* prev, of1x_matc
 //PPP
 inline of1x_match_t* of1x_init_ppp_prot_match(of1x_match_t* prev, of1x_match_t* next, uint16_t value){
 
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_PPP_PROT; 
 	match->value = __init_utern16(value,OF1X_2_BYTE_MASK); //no wildcard 
 	match->prev = prev;
@@ -803,7 +803,7 @@ inline of1x_match_t* of1x_init_ppp_prot_match(of1x_match_t* prev, of1x_match_t*
 }
 //GTP
 inline of1x_match_t* of1x_init_gtp_msg_type_match(of1x_match_t* prev, of1x_match_t* next, uint8_t value){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_GTP_MSG_TYPE;
 	match->value = __init_utern8(value,OF1X_1_BYTE_MASK); //no wildcard
 	match->prev = prev;
@@ -817,7 +817,7 @@ inline of1x_match_t* of1x_init_gtp_msg_type_match(of1x_match_t* prev, of1x_match
 	return match;
 }
 inline of1x_match_t* of1x_init_gtp_teid_match(of1x_match_t* prev, of1x_match_t* next, uint32_t value, uint32_t mask){
-	of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+	of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 	match->type = OF1X_MATCH_GTP_TEID;
 	match->value = __init_utern32(value, mask);
 	match->prev = prev;
@@ -846,9 +846,18 @@ void __of1x_init_match_group(of1x_match_group_t* group){
 	group->ver_req.max_ver = OF1X_MAX_VERSION;
 }
 
-void __of1x_destroy_match_group(of1x_match_group_t* group){
+void __of1x_destroy_match_group(of1x_match_group_t* group, slab_batch_t* batch){
 	of1x_match_t *match;
 
+	//Matches are referenced by stats messages; the last one releases them
+	if(group->snapshot){
+		__of1x_release_match_snapshot(group->snapshot);
+		group->snapshot = NULL;
+		group->head = NULL; 
+		group->tail = NULL; 
+		return;
+	}
+
 	if (!group->head)
 		return;
 
@@ -856,7 +865,7 @@ void __of1x_destroy_match_group(of1x_match_group_t* group){
 
 	while (match){
 		of1x_match_t *next = match->next;
-		of1x_destroy_match(match);
+		__of1x_destroy_match(match, batch);
 		match = next;
 	}
 
@@ -903,6 +912,61 @@ void __of1x_match_group_push_back(of1x_match_group_t* group, of1x_match_t* match
 	group->tail = match;
 }
 
+/*
+* Match snapshots
+*/
+of1x_match_snapshot_t* __of1x_get_match_snapshot(of1x_match_group_t* group){
+
+	of1x_match_snapshot_t* snapshot = group->snapshot;
+
+	if(!snapshot){
+		snapshot = (of1x_match_snapshot_t*)__slab_malloc(sizeof(of1x_match_snapshot_t));
+
+		if(!snapshot)
+			return NULL;
+
+		if( (snapshot->mutex = platform_mutex_init(NULL)) == NULL){
+			__slab_free(snapshot);
+			return NULL;
+		}
+
+		//The group holds the first reference
+		snapshot->head = group->head;
+		snapshot->ref_count = 1;
+		group->snapshot = snapshot;
+	}
+
+	platform_mutex_lock(snapshot->mutex);
+	snapshot->ref_count++;
+	platform_mutex_unlock(snapshot->mutex);
+
+	return snapshot;
+}
+
+void __of1x_release_match_snapshot(of1x_match_snapshot_t* snapshot){
+
+	uint32_t ref_count;
+	of1x_match_t *match, *next;
+	slab_batch_t batch;
+
+	platform_mutex_lock(snapshot->mutex);
+	ref_count = --snapshot->ref_count;
+	platform_mutex_unlock(snapshot->mutex);
+
+	if(ref_count)
+		return;
+
+	platform_mutex_destroy(snapshot->mutex);
+
+	__slab_batch_init(&batch);
+	for(match = snapshot->head; match; match = next){
+		next = match->next;
+		__of1x_destroy_match(match, &batch);
+	}
+	__slab_batch_free(&batch, snapshot);
+	__slab_batch_flush(&batch);
+}
+
 /*
 * Copy match to heap. Leaves next and prev pointers to NULL
 */
@@ -1044,7 +1108,7 @@ inline of1x_match_t* __of1x_get_alike_match(of1x_match_t* match1, of1x_match_t*
 	common_tern = __utern_get_alike(*match1->value,*match2->value);
 
 	if(common_tern){
-		of1x_match_t* match = (of1x_match_t*)platform_malloc_shared(sizeof(of1x_match_t));
+		of1x_match_t* match = (of1x_match_t*)__slab_malloc(sizeof(of1x_match_t));
 		match->value = common_tern;
 		match->type = match1->type;
 		match->next = NULL;
@@ -1057,8 +1121,12 @@ inline of1x_match_t* __of1x_get_alike_match(of1x_match_t* match1, of1x_match_t*
 * Common destructor
 */
 void of1x_destroy_match(of1x_match_t* match){
-	__destroy_utern(match->value);
-	platform_free_shared(match);
+	__of1x_destroy_match(match, NULL);
+}
+
+void __of1x_destroy_match(of1x_match_t* match, slab_batch_t* batch){
+	__destroy_utern_batch(match->value, batch);
+	__slab_batch_free(batch, match);
 }
 
 /*
@@ -7,6 +7,7 @@
 #include <stdbool.h>
 #include "rofl.h"
 #include "../../../common/ternary_fields.h"
+#include "../../../platform/lock.h"
 #include "of1x_packet_matches.h"
 #include "of1x_utils.h"
 
@@ -123,6 +124,17 @@ typedef struct of1x_match{
 	bool has_wildcard;
 }of1x_match_t;
 
+/*
+* Reference counted view of the matches of an installed entry. Matches are
+* never modified once the entry is in a table, so stats messages reference
+* them instead of copying them. The last reference releases the matches.
+*/
+typedef struct of1x_match_snapshot{
+	of1x_match_t* head;
+
+	uint32_t ref_count;
+	platform_mutex_t* mutex;
+}of1x_match_snapshot_t;
 
 /* Match group, using a double-linked-list */
 typedef struct of1x_match_group{
@@ -139,6 +151,9 @@ typedef struct of1x_match_group{
  
 	//OF1.0 only
 	bool has_wildcard;
+
+	//Owner of the matches when they are shared (created on demand)
+	of1x_match_snapshot_t* snapshot;
 }of1x_match_group_t;
 
 
@@ -456,10 +471,11 @@ of1x_match_t* of1x_init_tunnel_id_match(of1x_match_t* prev, of1x_match_t* next,
 * @ingroup core_of1x 
 */
 void of1x_destroy_match(of1x_match_t* match);
+void __of1x_destroy_match(of1x_match_t* match, slab_batch_t* batch);
 
 /* match group */
 void __of1x_init_match_group(of1x_match_group_t* group);
-void __of1x_destroy_match_group(of1x_match_group_t* group);
+void __of1x_destroy_match_group(of1x_match_group_t* group, slab_batch_t* batch);
 void __of1x_match_group_push_back(of1x_match_group_t* group, of1x_match_t* match);
 
 /* Push match at the end of the match */
@@ -478,6 +494,13 @@ of1x_match_t* __of1x_copy_match(of1x_match_t* match);
 of1x_match_t* __of1x_copy_matches(of1x_match_t* matches);
 
 
+/*
+* Match snapshots. Get creates the snapshot on the first call and adds a reference;
+* calls must be serialized by the caller.
+*/
+of1x_match_snapshot_t* __of1x_get_match_snapshot(of1x_match_group_t* group);
+void __of1x_release_match_snapshot(of1x_match_snapshot_t* snapshot);
+
 /* 
 * Get alike match 
 */ 
@@ -0,0 +1,640 @@
+/*
+ * A meter table is a list of meters, each one of them contain:
+ * - Meter ID
+ * - Flags (rate unit, burst, stats)
+ * - Bands, each one with its own token bucket
+ * - Counters
+ *
+ * Meters are referenced by flow entries through the OF1X_IT_METER
+ * instruction, and processed before any other instruction.
+ */
+#include "of1x_meter_table.h"
+#include "of1x_pipeline.h"
+#include "of1x_timers.h"
+#include "of1x_utils.h"
+#include "of1x_packet_matches.h"
+#include "matching_algorithms/matching_algorithms.h"
+#include "../../../platform/memory.h"
+#include "../../../platform/packet.h"
+#include "../../../common/per_core.h"
+#include "../../../util/logging.h"
+#include <string.h>
+
+//Max elapsed time considered for a refill; beyond that buckets are full
+#define OF1X_METER_MAX_REFILL_US 1000000000ULL
+
+static inline uint64_t __of1x_meter_now_us(void){
+	struct timeval now;
+	__of1x_gettimeofday(&now, NULL);
+	return ((uint64_t)now.tv_sec)*1000000 + now.tv_usec;
+}
+
+of1x_meter_table_t* of1x_init_meter_table(){
+	of1x_meter_table_t* mt;
+	mt = (of1x_meter_table_t*) platform_malloc_shared(sizeof(of1x_meter_table_t));
+
+	if(mt == NULL)
+		return NULL;
+
+	mt->num_of_entries = 0;
+	mt->head = NULL;
+	mt->tail = NULL;
+
+	mt->hash_index = (of1x_meter_t**) platform_malloc_shared(sizeof(of1x_meter_t*)*OF1X_METER_TABLE_HASH_SIZE);
+	if(mt->hash_index == NULL){
+		platform_free_shared(mt);
+		return NULL;
+	}
+	memset(mt->hash_index, 0, sizeof(of1x_meter_t*)*OF1X_METER_TABLE_HASH_SIZE);
+
+	mt->rwlock = platform_rwlock_init(NULL);
+
+	return mt;
+}
+
+static inline uint32_t __of1x_meter_hash(uint32_t id){
+	//Multiplicative (Fibonacci) hashing
+	return (id * 2654435761U) >> (32 - OF1X_METER_TABLE_HASH_BITS);
+}
+
+of1x_meter_t* __of1x_meter_search(of1x_meter_table_t* mt, uint32_t id){
+	of1x_meter_t* it;
+
+	for(it=mt->hash_index[__of1x_meter_hash(id)]; it; it=it->hash_next){
+		if(it->id == id)
+			return it;
+	}
+
+	return NULL;
+}
+
+/*
+* Bands
+*/
+static rofl_of1x_mm_result_t __of1x_check_meter_parameters(uint32_t id, bitmap32_t flags, const of1x_meter_band_config_t* bands, unsigned int num_of_bands){
+	unsigned int i;
+
+	if(id == 0 || id > OF1X_METER_MAX)
+		return ROFL_OF1X_MM_INVAL;
+
+	if( (flags & ~(OF1X_METER_FLAG_KBPS | OF1X_METER_FLAG_PKTPS | OF1X_METER_FLAG_BURST | OF1X_METER_FLAG_STATS)) ||
+		( (flags & OF1X_METER_FLAG_KBPS) && (flags & OF1X_METER_FLAG_PKTPS) ) )
+		return ROFL_OF1X_MM_BFLAGS;
+
+	if(num_of_bands > OF1X_METER_MAX_BANDS)
+		return ROFL_OF1X_MM_OBANDS;
+
+	if(num_of_bands && !bands)
+		return ROFL_OF1X_MM_INVAL;
+
+	for(i=0;i<num_of_bands;i++){
+		if(bands[i].type != OF1X_METER_BAND_DROP && bands[i].type != OF1X_METER_BAND_DSCP_REMARK)
+			return ROFL_OF1X_MM_BBAND;
+		if(bands[i].rate == 0)
+			return ROFL_OF1X_MM_BRATE;
+		if( (flags & OF1X_METER_FLAG_BURST) && bands[i].burst_size == 0)
+			return ROFL_OF1X_MM_BBURST;
+		if(bands[i].type == OF1X_METER_BAND_DSCP_REMARK && (bands[i].prec_level == 0 || bands[i].prec_level > 2))
+			return ROFL_OF1X_MM_BBAND_VALUE;
+	}
+
+	return ROFL_OF1X_MM_OK;
+}
+
+static void __of1x_release_meter_bands(of1x_meter_band_t* bands, unsigned int num_of_bands){
+	unsigned int i;
+
+	for(i=0;i<num_of_bands;i++){
+		platform_mutex_destroy(bands[i].mutex);
+		__per_core_free(bands[i].cores);
+	}
+}
+
+//Fills in bands (sorted by rate) and their buckets. Bands are left untouched on failure
+static rofl_result_t __of1x_init_meter_bands(of1x_meter_band_t* dst, bitmap32_t flags, const of1x_meter_band_config_t* bands, unsigned int num_of_bands){
+	unsigned int i, j;
+	uint64_t now = __of1x_meter_now_us();
+	of1x_meter_band_t band;
+
+	for(i=0;i<num_of_bands;i++){
+		memset(&dst[i], 0, sizeof(of1x_meter_band_t));
+		dst[i].config = bands[i];
+
+		//Bucket depth. Units are bits (kb/s) or 1/1000 packets (packets/s)
+		if(flags & OF1X_METER_FLAG_BURST)
+			dst[i].capacity = ((uint64_t)bands[i].burst_size)*1000;
+		else
+			dst[i].capacity = ((uint64_t)bands[i].rate)*OF1X_METER_DEFAULT_BURST_MS;
+
+		dst[i].chunk = dst[i].capacity >> OF1X_METER_CREDIT_CHUNK_SHIFT;
+		dst[i].tokens = dst[i].capacity;
+		dst[i].last_refill_us = now;
+
+		dst[i].mutex = platform_mutex_init(NULL);
+		dst[i].cores = (of1x_meter_band_core_t*)__per_core_alloc(sizeof(of1x_meter_band_core_t));
+
+		if(!dst[i].mutex || !dst[i].cores){
+			if(dst[i].mutex)
+				platform_mutex_destroy(dst[i].mutex);
+			__per_core_free(dst[i].cores);
+
+			//Rollback
+			__of1x_release_meter_bands(dst, i);
+			return ROFL_FAILURE;
+		}
+	}
+
+	//Sort by rate (insertion; at most OF1X_METER_MAX_BANDS)
+	for(i=1;i<num_of_bands;i++){
+		band = dst[i];
+		for(j=i; j>0 && dst[j-1].config.rate > band.config.rate; j--)
+			dst[j] = dst[j-1];
+		dst[j] = band;
+	}
+
+	return ROFL_SUCCESS;
+}
+
+static of1x_meter_config_t* __of1x_init_meter_config(bitmap32_t flags, const of1x_meter_band_config_t* bands, unsigned int num_of_bands){
+	of1x_meter_config_t* config;
+
+	config = (of1x_meter_config_t*)platform_malloc_shared(sizeof(of1x_meter_config_t));
+	if(!config)
+		return NULL;
+
+	if(__of1x_init_meter_bands(config->bands, flags, bands, num_of_bands) != ROFL_SUCCESS){
+		platform_free_shared(config);
+		return NULL;
+	}
+	config->flags = flags;
+	config->num_of_bands = num_of_bands;
+
+	return config;
+}
+
+static void __of1x_destroy_meter_config(of1x_meter_config_t* config){
+	__of1x_release_meter_bands(config->bands, config->num_of_bands);
+	platform_free_shared(config);
+}
+
+//Carries the counts of the bands kept (same type and rate) over to the new configuration
+static void __of1x_meter_carry_band_counts(of1x_meter_config_t* config, const of1x_meter_config_t* old){
+	unsigned int i, j;
+	uint32_t carried = 0;
+
+	for(i=0;i<config->num_of_bands;i++){
+		for(j=0;j<old->num_of_bands;j++){
+			if( (carried & (1 << j)) || old->bands[j].config.type != config->bands[i].config.type || old->bands[j].config.rate != config->bands[i].config.rate)
+				continue;
+
+			__of1x_meter_band_get_counts(&old->bands[j], &config->bands[i].packet_offset, &config->bands[i].byte_offset);
+			carried |= 1 << j;
+			break;
+		}
+	}
+}
+
+/*
+* Meter mgmt
+*/
+static void __of1x_destroy_meter(of1x_meter_t* meter){
+
+	platform_rwlock_wrlock(meter->rwlock);
+
+	__of1x_destroy_meter_config(meter->config);
+	__per_core_free(meter->cores);
+
+	platform_rwlock_destroy(meter->rwlock);
+
+	platform_free_shared(meter);
+}
+
+void of1x_destroy_meter_table(of1x_meter_table_t* mt){
+	of1x_meter_t *it, *next;
+
+	platform_rwlock_wrlock(mt->rwlock);
+
+	for(it=mt->head; it; it=next){
+		next = it->next;
+		__of1x_destroy_meter(it);
+	}
+
+	platform_rwlock_destroy(mt->rwlock);
+
+	platform_free_shared(mt->hash_index);
+	platform_free_shared(mt);
+}
+
+rofl_of1x_mm_result_t of1x_meter_add(of1x_meter_table_t* mt, uint32_t id, bitmap32_t flags, const of1x_meter_band_config_t* bands, unsigned int num_of_bands){
+	rofl_of1x_mm_result_t ret_val;
+	of1x_meter_t* meter;
+	uint32_t h;
+
+	if( (ret_val=__of1x_check_meter_parameters(id, flags, bands, num_of_bands)) != ROFL_OF1X_MM_OK)
+		return ret_val;
+
+	meter = (of1x_meter_t*)platform_malloc_shared(sizeof(of1x_meter_t));
+	if(!meter)
+		return ROFL_OF1X_MM_OMETERS;
+	memset(meter, 0, sizeof(of1x_meter_t));
+
+	meter->cores = (of1x_meter_core_t*)__per_core_alloc(sizeof(of1x_meter_core_t));
+	if(!meter->cores){
+		platform_free_shared(meter);
+		return ROFL_OF1X_MM_OMETERS;
+	}
+
+	if((meter->config = __of1x_init_meter_config(flags, bands, num_of_bands)) == NULL){
+		__per_core_free(meter->cores);
+		platform_free_shared(meter);
+		return ROFL_OF1X_MM_OBANDS;
+	}
+
+	meter->id = id;
+	meter->creation_time_us = __of1x_meter_now_us();
+	meter->rwlock = platform_rwlock_init(NULL);
+
+	platform_rwlock_wrlock(mt->rwlock);
+
+	if(__of1x_meter_search(mt, id) != NULL){
+		platform_rwlock_wrunlock(mt->rwlock);
+		__of1x_destroy_meter(meter);
+		return ROFL_OF1X_MM_EXISTS;
+	}
+
+	//insert in the end
+	meter->meter_table = mt;
+	meter->prev = mt->tail;
+	meter->next = NULL;
+	if(mt->tail)
+		mt->tail->next = meter;
+	else
+		mt->head = meter;
+	mt->tail = meter;
+
+	h = __of1x_meter_hash(id);
+	meter->hash_next = mt->hash_index[h];
+	mt->hash_index[h] = meter;
+
+	mt->num_of_entries++;
+
+	platform_rwlock_wrunlock(mt->rwlock);
+
+	return ROFL_OF1X_MM_OK;
+}
+
+rofl_of1x_mm_result_t of1x_meter_modify(of1x_meter_table_t* mt, uint32_t id, bitmap32_t flags, const of1x_meter_band_config_t* bands, unsigned int num_of_bands){
+	rofl_of1x_mm_result_t ret_val;
+	of1x_meter_config_t *config, *old;
+	of1x_meter_t* meter;
+
+	if( (ret_val=__of1x_check_meter_parameters(id, flags, bands, num_of_bands)) != ROFL_OF1X_MM_OK)
+		return ret_val;
+
+	if((config = __of1x_init_meter_config(flags, bands, num_of_bands)) == NULL)
+		return ROFL_OF1X_MM_OBANDS;
+
+	platform_rwlock_rdlock(mt->rwlock);
+
+	meter = __of1x_meter_search(mt, id);
+	if(!meter){
+		platform_rwlock_rdunlock(mt->rwlock);
+		__of1x_destroy_meter_config(config);
+		return ROFL_OF1X_MM_UNKMETER;
+	}
+
+	platform_rwlock_wrlock(meter->rwlock);
+
+	//Publish; packets being metered may still use the old configuration
+	old = meter->config;
+	__sync_synchronize();
+	meter->config = config;
+	__per_core_synchronize(&meter->cores[0].epoch, sizeof(of1x_meter_core_t));
+
+	//Old bands are no longer updated
+	__of1x_meter_carry_band_counts(config, old);
+
+	platform_rwlock_wrunlock(meter->rwlock);
+	platform_rwlock_rdunlock(mt->rwlock);
+
+	__of1x_destroy_meter_config(old);
+
+	return ROFL_OF1X_MM_OK;
+}
+
+static void __of1x_unlink_meter(of1x_meter_table_t* mt, of1x_meter_t* meter){
+	of1x_meter_t** it;
+
+	//detach
+	if(meter->next)
+		meter->next->prev = meter->prev;
+	else
+		mt->tail = meter->prev;
+	if(meter->prev)
+		meter->prev->next = meter->next;
+	else
+		mt->head = meter->next;
+
+	for(it = &mt->hash_index[__of1x_meter_hash(meter->id)]; *it; it = &(*it)->hash_next){
+		if(*it == meter){
+			*it = meter->hash_next;
+			break;
+		}
+	}
+
+	meter->meter_table = NULL;
+	mt->num_of_entries--;
+}
+
+//Removes the entries of all the tables that refer to the meter
+static void __of1x_meter_remove_flows(of1x_pipeline_t* pipeline, uint32_t id){
+	unsigned int i;
+	of1x_flow_entry_t* entry;
+
+	for(i=0; i<pipeline->num_of_tables; i++){
+		while((entry=of1x_matching_algorithms[pipeline->tables[i].matching_algorithm].find_entry_using_meter_hook(&pipeline->tables[i], id))!=NULL){
+			__of1x_remove_specific_flow_entry_table(pipeline, i, entry, OF1X_FLOW_REMOVE_METER_DELETE, MUTEX_NOT_ACQUIRED);
+		}
+	}
+}
+
+rofl_of1x_mm_result_t of1x_meter_delete(of1x_pipeline_t* pipeline, of1x_meter_table_t* mt, uint32_t id){
+	of1x_meter_t* meter;
+
+	if(id == OF1X_METER_ALL){
+		for(;;){
+			platform_rwlock_wrlock(mt->rwlock);
+			if((meter = mt->head) == NULL){
+				platform_rwlock_wrunlock(mt->rwlock);
+				break;
+			}
+			__of1x_unlink_meter(mt, meter);
+			platform_rwlock_wrunlock(mt->rwlock);
+
+			__of1x_meter_remove_flows(pipeline, meter->id);
+			__of1x_destroy_meter(meter);
+		}
+		return ROFL_OF1X_MM_OK;
+	}
+
+	if(id == 0 || id > OF1X_METER_MAX)
+		return ROFL_OF1X_MM_INVAL;
+
+	//extract the meter without destroying it (only the first thread that comes gets it)
+	platform_rwlock_wrlock(mt->rwlock);
+	if((meter = __of1x_meter_search(mt, id)) == NULL){
+		platform_rwlock_wrunlock(mt->rwlock);
+		return ROFL_OF1X_MM_OK; //if it is not found no need to throw an error
+	}
+	__of1x_unlink_meter(mt, meter);
+	platform_rwlock_wrunlock(mt->rwlock);
+
+	//Entries are removed before the meter is released
+	__of1x_meter_remove_flows(pipeline, id);
+	__of1x_destroy_meter(meter);
+
+	return ROFL_OF1X_MM_OK;
+}
+
+/*
+* Packet processing
+*/
+
+//Consumes cost tokens of the band; returns false if the band rate is exceeded
+static inline bool __of1x_meter_band_consume(of1x_meter_band_t* band, of1x_meter_band_core_t* core, uint64_t cost){
+	uint64_t now, elapsed, refill, need, take;
+
+	//Fast path; local credit of the core
+	if(core->credit >= (int64_t)cost){
+		core->credit -= cost;
+		return true;
+	}
+
+	need = cost - core->credit;
+
+	platform_mutex_lock(band->mutex);
+
+	//Refill the shared bucket (rate tokens per ms)
+	now = __of1x_meter_now_us();
+	if(now > band->last_refill_us){
+		elapsed = now - band->last_refill_us;
+
+		if(elapsed >= OF1X_METER_MAX_REFILL_US){
+			band->tokens = band->capacity;
+			band->last_refill_us = now;
+		}else{
+			refill = elapsed*band->config.rate/1000;
+			//Do not lose fractions of a token with frequent refills
+			if(refill){
+				band->tokens += refill;
+				if(band->tokens > band->capacity)
+					band->tokens = band->capacity;
+				band->last_refill_us = now;
+			}
+		}
+	}
+
+	//Borrow at least a chunk, if available
+	take = (need > band->chunk)? need : band->chunk;
+	if(take > band->tokens)
+		take = band->tokens;
+
+	if(take < need){
+		platform_mutex_unlock(band->mutex);
+		return false;
+	}
+	band->tokens -= take;
+
+	platform_mutex_unlock(band->mutex);
+
+	core->credit += take - cost;
+	return true;
+}
+
+//Increases the drop precedence of Assured Forwarding (RFC 2597) code points
+static inline void __of1x_meter_remark_dscp(datapacket_t* pkt, uint8_t prec_level){
+	of1x_packet_matches_t* matches = &pkt->matches.of1x;
+	uint8_t dscp = matches->ip_dscp;
+	uint8_t af_class = dscp >> 3;
+	uint8_t drop_prec = (dscp >> 1) & 0x3;
+
+	if(matches->eth_type != OF1X_ETH_TYPE_IPV4 && matches->eth_type != OF1X_ETH_TYPE_IPV6)
+		return;
+
+	//AFxy: class 1-4, drop precedence 1-3
+	if( (dscp & 0x1) || af_class < 1 || af_class > 4 || drop_prec == 0 || drop_prec == 3)
+		return;
+
+	drop_prec += prec_level;
+	if(drop_prec > 3)
+		drop_prec = 3;
+	dscp = (af_class << 3) | (drop_prec << 1);
+
+	//Copy-on-write
+	if(pkt->is_shared && platform_packet_make_writable(pkt) != ROFL_SUCCESS){
+		ROFL_PIPELINE_ERR("Unable to get a private copy of packet %p; skipping DSCP remark\n", pkt);
+		return;
+	}
+
+	platform_packet_set_ip_dscp(pkt, dscp);
+	matches->ip_dscp = dscp;
+}
+
+bool __of1x_meter_process_packet(of1x_meter_t* meter, datapacket_t* pkt){
+	unsigned int i, core_id = __per_core_id();
+	uint32_t pkt_size = pkt->matches.of1x.pkt_size_bytes;
+	uint64_t cost;
+	of1x_meter_core_t* core = &meter->cores[core_id];
+	of1x_meter_config_t* config;
+	of1x_meter_band_t* band = NULL;
+	of1x_meter_band_type_t type;
+	uint8_t prec_level;
+
+	core->packet_count++;
+	core->byte_count += pkt_size;
+
+	//Only per-core state is written; config is kept until the section is left
+	__per_core_read_lock(&core->epoch);
+	config = meter->config;
+
+	cost = (config->flags & OF1X_METER_FLAG_PKTPS)? 1000 : ((uint64_t)pkt_size)*8;
+
+	//Bands are sorted by rate; the exceeded band with the highest rate applies
+	for(i=0;i<config->num_of_bands;i++){
+		if(!__of1x_meter_band_consume(&config->bands[i], &config->bands[i].cores[core_id], cost))
+			band = &config->bands[i];
+	}
+
+	if(!band){
+		__per_core_read_unlock(&core->epoch);
+		return false;
+	}
+
+	band->cores[core_id].packet_count++;
+	band->cores[core_id].byte_count += pkt_size;
+	type = band->config.type;
+	prec_level = band->config.prec_level;
+
+	__per_core_read_unlock(&core->epoch);
+
+	if(type == OF1X_METER_BAND_DROP)
+		return true;
+
+	__of1x_meter_remark_dscp(pkt, prec_level);
+	return false;
+}
+
+/*
+* Stats
+*/
+void __of1x_meter_band_get_counts(const of1x_meter_band_t* band, uint64_t* packets, uint64_t* bytes){
+	unsigned int i;
+
+	*packets = band->packet_offset;
+	*bytes = band->byte_offset;
+	for(i=0;i<ROFL_PIPELINE_MAX_CORES;i++){
+		*packets += band->cores[i].packet_count;
+		*bytes += band->cores[i].byte_count;
+	}
+}
+
+static of1x_stats_meter_msg_t* __of1x_init_stats_meter_msg(of1x_meter_t* meter, uint64_t now){
+	unsigned int i, j;
+	uint64_t duration;
+	const of1x_meter_config_t* config;
+	of1x_stats_meter_msg_t* msg = (of1x_stats_meter_msg_t*)platform_malloc_shared(sizeof(of1x_stats_meter_msg_t));
+
+	if(!msg)
+		return NULL;
+	memset(msg, 0, sizeof(of1x_stats_meter_msg_t));
+
+	platform_rwlock_rdlock(meter->rwlock);
+
+	config = meter->config;
+	msg->meter_id = meter->id;
+	msg->num_of_bands = config->num_of_bands;
+
+	duration = (now > meter->creation_time_us)? now - meter->creation_time_us : 0;
+	msg->duration_sec = duration/1000000;
+	msg->duration_nsec = (duration%1000000)*1000;
+
+	//Aggregate per-core counters
+	for(j=0;j<ROFL_PIPELINE_MAX_CORES;j++){
+		msg->packet_in_count += meter->cores[j].packet_count;
+		msg->byte_in_count += meter->cores[j].byte_count;
+	}
+	for(i=0;i<config->num_of_bands;i++)
+		__of1x_meter_band_get_counts(&config->bands[i], &msg->band_stats[i].packet_band_count, &msg->band_stats[i].byte_band_count);
+
+	platform_rwlock_rdunlock(meter->rwlock);
+
+	return msg;
+}
+
+of1x_stats_meter_msg_t* of1x_get_meter_stats(of1x_pipeline_t* pipeline, uint32_t id){
+	of1x_meter_table_t* mt = pipeline->meters;
+	of1x_meter_t* meter;
+	of1x_stats_meter_msg_t *head=NULL, *tail=NULL, *msg;
+	uint64_t now = __of1x_meter_now_us();
+
+	platform_rwlock_rdlock(mt->rwlock);
+
+	if(id != OF1X_METER_ALL){
+		meter = __of1x_meter_search(mt, id);
+		head = (meter)? __of1x_init_stats_meter_msg(meter, now) : NULL;
+		platform_rwlock_rdunlock(mt->rwlock);
+		return head;
+	}
+
+	for(meter=mt->head; meter; meter=meter->next){
+		if((msg = __of1x_init_stats_meter_msg(meter, now)) == NULL){
+			platform_rwlock_rdunlock(mt->rwlock);
+			of1x_destroy_stats_meter_msg(head);
+			return NULL;
+		}
+
+		if(tail)
+			tail->next = msg;
+		else
+			head = msg;
+		tail = msg;
+	}
+
+	platform_rwlock_rdunlock(mt->rwlock);
+
+	return head;
+}
+
+void of1x_destroy_stats_meter_msg(of1x_stats_meter_msg_t* msg){
+	of1x_stats_meter_msg_t* next;
+
+	for(; msg; msg=next){
+		next = msg->next;
+		platform_free_shared(msg);
+	}
+}
+
+/*
+* Dump
+*/
+void of1x_dump_meter_table(of1x_meter_table_t* mt){
+	of1x_meter_t* it;
+	const of1x_meter_config_t* config;
+	unsigned int i, j;
+
+	ROFL_PIPELINE_DEBUG("Dumping meter table. # of meters: %u. \n", mt->num_of_entries);
+
+	if(mt->num_of_entries == 0){
+		ROFL_PIPELINE_DEBUG("\t[*] No entries\n");
+		ROFL_PIPELINE_DEBUG("\n");
+		return;
+	}
+
+	for(it=mt->head, i=0; it; it=it->next, i++){
+		config = it->config;
+		ROFL_PIPELINE_DEBUG("\t[%u] Meter (%p). Id %u, %s, # of bands %u\n", i, it, it->id, (config->flags & OF1X_METER_FLAG_PKTPS)? "pktps" : "kbps", config->num_of_bands);
+		for(j=0;j<config->num_of_bands;j++){
+			ROFL_PIPELINE_DEBUG("\t\t[%u] Band %s, rate %u, burst %u, prec_level %u\n", j, (config->bands[j].config.type == OF1X_METER_BAND_DROP)? "DROP" : "DSCP_REMARK", config->bands[j].config.rate, config->bands[j].config.burst_size, config->bands[j].config.prec_level);
+		}
+	}
+}
@@ -0,0 +1,277 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef __OF1X_METER_TABLE_H__
+#define __OF1X_METER_TABLE_H__
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include "rofl.h"
+#include "../../../platform/lock.h"
+#include "../../../platform/cutil.h"
+#include "../../../common/bitmap.h"
+#include "../../../common/datapacket.h"
+
+#define OF1X_METER_MAX 0xffff0000
+#define OF1X_METER_SLOWPATH 0xfffffffd /* Meter for slow datapath (unsupported) */
+#define OF1X_METER_CONTROLLER 0xfffffffe /* Meter for controller connection (unsupported) */
+#define OF1X_METER_ALL 0xffffffff /* Represents all meters for stats requests and delete commands */
+
+//Maximum number of bands per meter
+#define OF1X_METER_MAX_BANDS 8
+
+//Number of buckets of the meter id hash index (power of 2)
+#define OF1X_METER_TABLE_HASH_BITS 10
+#define OF1X_METER_TABLE_HASH_SIZE (1 << OF1X_METER_TABLE_HASH_BITS)
+
+//Bucket depth (in ms worth of rate) when OF1X_METER_FLAG_BURST is not set
+#define OF1X_METER_DEFAULT_BURST_MS 100
+
+//A core borrows 1/2^OF1X_METER_CREDIT_CHUNK_SHIFT of the bucket depth at once
+#define OF1X_METER_CREDIT_CHUNK_SHIFT 4
+
+/**
+* @file of1x_meter_table.h
+* @brief OpenFlow v1.3.2 meter table subsystem
+*
+* Meters are token bucket policers. Every band owns a shared bucket, refilled
+* on demand according to the elapsed time. To avoid taking the bucket lock (or
+* an atomic op) for every packet, processing cores borrow credit from the shared
+* bucket in chunks and consume it locally; the core id is provided by
+* platform_get_core_id(). The error introduced is bounded by one chunk per core.
+*
+* Meter and band counters are also kept per core and aggregated on stats requests.
+*
+* The datapath does not lock the meter: flags and bands (of1x_meter_config_t)
+* are published through a pointer and replaced as a whole on modification; the
+* previous configuration is released once the cores using it are done with
+* it (read side sections, see per_core.h).
+*/
+
+/**
+* @ingroup core_of1x
+* Meter flags. Values are mapped 1:1 to enum ofp_meter_flags
+*/
+typedef enum{
+	OF1X_METER_FLAG_KBPS	= 1 << 0,	/* Rate value in kb/s (default) */
+	OF1X_METER_FLAG_PKTPS	= 1 << 1,	/* Rate value in packet/sec */
+	OF1X_METER_FLAG_BURST	= 1 << 2,	/* Do burst size */
+	OF1X_METER_FLAG_STATS	= 1 << 3,	/* Collect statistics */
+}of1x_meter_flag_t;
+
+/**
+* @ingroup core_of1x
+* Meter band type. Values are mapped 1:1 to enum ofp_meter_band_type
+*/
+typedef enum{
+	OF1X_METER_BAND_DROP		= 1,	/* Drop packet */
+	OF1X_METER_BAND_DSCP_REMARK	= 2,	/* Remark DSCP in the IP header */
+}of1x_meter_band_type_t;
+
+/**
+* @ingroup core_of1x
+* Meter band configuration, as received in the meter mod
+*/
+typedef struct of1x_meter_band_config{
+	of1x_meter_band_type_t type;
+	uint32_t rate;		/* kb/s or packets/s, depending on meter flags */
+	uint32_t burst_size;	/* kb or packets; only with OF1X_METER_FLAG_BURST */
+	uint8_t prec_level;	/* Drop precedence increase (OF1X_METER_BAND_DSCP_REMARK only) */
+}of1x_meter_band_config_t;
+
+//Per-core state of a band; one cache line per core
+typedef struct of1x_meter_band_core{
+	int64_t credit;			/* Credit borrowed from the shared bucket */
+	uint64_t packet_count;		/* Packets in excess of the band */
+	uint64_t byte_count;		/* Bytes in excess of the band */
+	uint64_t __pad[5];
+}of1x_meter_band_core_t;
+
+//Per-core counters of a meter; one cache line per core
+typedef struct of1x_meter_core{
+	uint64_t packet_count;		/* Packets processed by the meter */
+	uint64_t byte_count;		/* Bytes processed by the meter */
+	volatile uint64_t epoch;	/* Read side sections of the core (configuration) */
+	uint64_t __pad[5];
+}of1x_meter_core_t;
+
+/**
+* @ingroup core_of1x
+* Meter band
+*/
+typedef struct of1x_meter_band{
+	of1x_meter_band_config_t config;
+
+	//Shared token bucket. Tokens are bits (kb/s) or 1/1000 packets (packets/s),
+	//so that in both cases the bucket is refilled at rate tokens per ms
+	uint64_t tokens;
+	uint64_t capacity;
+	uint64_t chunk;
+	uint64_t last_refill_us;
+	platform_mutex_t* mutex;
+
+	//Per-core state (ROFL_PIPELINE_MAX_CORES)
+	of1x_meter_band_core_t* cores;
+
+	//Counts of the band replaced by of1x_meter_modify(), if any
+	uint64_t packet_offset;
+	uint64_t byte_offset;
+}of1x_meter_band_t;
+
+/**
+* @ingroup core_of1x
+* Meter configuration; immutable once published (only the buckets and
+* counters of the bands are updated)
+*/
+typedef struct of1x_meter_config{
+	bitmap32_t flags;
+
+	//Bands, sorted by rate (ascending)
+	unsigned int num_of_bands;
+	of1x_meter_band_t bands[OF1X_METER_MAX_BANDS];
+}of1x_meter_config_t;
+
+struct of1x_meter_table;
+
+/**
+* @ingroup core_of1x
+* Meter
+*/
+typedef struct of1x_meter{
+	uint32_t id;
+
+	//Flags and bands; replaced under the write lock
+	of1x_meter_config_t* volatile config;
+
+	//Per-core counters (ROFL_PIPELINE_MAX_CORES, cache aligned)
+	of1x_meter_core_t* cores;
+
+	//Creation time
+	uint64_t creation_time_us;
+
+	struct of1x_meter_table* meter_table;
+
+	platform_rwlock_t* rwlock;
+
+	struct of1x_meter* next;
+	struct of1x_meter* prev;
+
+	//Next meter in the same hash index bucket
+	struct of1x_meter* hash_next;
+}of1x_meter_t;
+
+/**
+* @ingroup core_of1x
+* Meter table
+*/
+typedef struct of1x_meter_table{
+	uint32_t num_of_entries;
+
+	platform_rwlock_t* rwlock;
+
+	struct of1x_meter* head;
+	struct of1x_meter* tail;
+
+	//Hash index by meter id (OF1X_METER_TABLE_HASH_SIZE buckets), consistent with the list
+	struct of1x_meter** hash_index;
+}of1x_meter_table_t;
+
+typedef enum{
+	ROFL_OF1X_MM_OK			= 0,	/* No error */
+	ROFL_OF1X_MM_EXISTS		= 1,	/* Meter already exists */
+	ROFL_OF1X_MM_INVAL		= 2,	/* Invalid meter id */
+	ROFL_OF1X_MM_UNKMETER		= 3,	/* Unknown meter */
+	ROFL_OF1X_MM_BCOMMAND		= 4,	/* Bad command */
+	ROFL_OF1X_MM_BFLAGS		= 5,	/* Unsupported flags */
+	ROFL_OF1X_MM_BRATE		= 6,	/* Bad rate */
+	ROFL_OF1X_MM_BBURST		= 7,	/* Bad burst size */
+	ROFL_OF1X_MM_BBAND		= 8,	/* Bad band type */
+	ROFL_OF1X_MM_BBAND_VALUE	= 9,	/* Bad band value */
+	ROFL_OF1X_MM_OMETERS		= 10,	/* Out of meters */
+	ROFL_OF1X_MM_OBANDS		= 11,	/* Out of bands */
+}rofl_of1x_mm_result_t;
+
+//Band stats
+typedef struct of1x_stats_meter_band{
+	uint64_t packet_band_count;
+	uint64_t byte_band_count;
+}of1x_stats_meter_band_t;
+
+//Meter stats
+typedef struct of1x_stats_meter_msg{
+	uint32_t meter_id;
+	uint64_t packet_in_count;
+	uint64_t byte_in_count;
+	uint32_t duration_sec;
+	uint32_t duration_nsec;
+	unsigned int num_of_bands;
+	of1x_stats_meter_band_t band_stats[OF1X_METER_MAX_BANDS];
+	struct of1x_stats_meter_msg* next;
+}of1x_stats_meter_msg_t;
+
+//fwd decls
+struct of1x_pipeline;
+
+//C++ extern C
+ROFL_BEGIN_DECLS
+
+/**
+* @ingroup core_of1x
+* Creates an empty meter table
+*/
+of1x_meter_table_t* of1x_init_meter_table(void);
+
+/**
+* @ingroup core_of1x
+* Destroys the meter table and all its meters
+*/
+void of1x_destroy_meter_table(of1x_meter_table_t* mt);
+
+/**
+* @ingroup core_of1x
+* Adds a meter to the table
+* @param flags Bitmap of of1x_meter_flag_t
+* @param bands Band configuration array (copied)
+*/
+rofl_of1x_mm_result_t of1x_meter_add(of1x_meter_table_t* mt, uint32_t id, bitmap32_t flags, const of1x_meter_band_config_t* bands, unsigned int num_of_bands);
+
+/**
+* @ingroup core_of1x
+* Replaces the configuration of an existing meter. The meter counters are preserved, as well as
+* the ones of the bands kept (same type and rate); buckets are refilled.
+*/
+rofl_of1x_mm_result_t of1x_meter_modify(of1x_meter_table_t* mt, uint32_t id, bitmap32_t flags, const of1x_meter_band_config_t* bands, unsigned int num_of_bands);
+
+/**
+* @ingroup core_of1x
+* Deletes a meter (or all with OF1X_METER_ALL), removing the flow entries that use it
+*/
+rofl_of1x_mm_result_t of1x_meter_delete(struct of1x_pipeline* pipeline, of1x_meter_table_t* mt, uint32_t id);
+
+/**
+* @ingroup core_of1x
+* Get the stats of a meter (or a list of all of them with OF1X_METER_ALL)
+*/
+of1x_stats_meter_msg_t* of1x_get_meter_stats(struct of1x_pipeline* pipeline, uint32_t id);
+
+/**
+* @ingroup core_of1x
+* Destroy a meter stats message (list)
+*/
+void of1x_destroy_stats_meter_msg(of1x_stats_meter_msg_t* msg);
+
+of1x_meter_t* __of1x_meter_search(of1x_meter_table_t* mt, uint32_t id);
+
+//Meters the packet; returns true if the packet must be dropped
+bool __of1x_meter_process_packet(of1x_meter_t* meter, datapacket_t* pkt);
+
+//Counts of a band, summed over all the cores
+void __of1x_meter_band_get_counts(const of1x_meter_band_t* band, uint64_t* packets, uint64_t* bytes);
+
+void of1x_dump_meter_table(of1x_meter_table_t* mt);
+
+//C++ extern C
+ROFL_END_DECLS
+
+#endif //__OF1X_METER_TABLE_H__
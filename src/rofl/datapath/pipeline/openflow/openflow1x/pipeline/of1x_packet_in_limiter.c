@@ -0,0 +1,292 @@
+#include "of1x_packet_in_limiter.h"
+
+#include <string.h>
+#include <sys/time.h>
+#include "of1x_pipeline.h"
+#include "of1x_timers.h"
+#include "../../../common/large_types.h"
+#include "../../../common/per_core.h"
+#include "../../../platform/cutil.h"
+#include "../../../platform/memory.h"
+#include "../../../util/logging.h"
+
+/*
+* Packet-in rate limiting and duplicate flow suppression
+*/
+
+static inline uint64_t __of1x_pkt_in_now_ns(void){
+
+	struct timeval now;
+
+	__of1x_gettimeofday(&now, NULL);
+	return (now.tv_sec*1000000ULL + now.tv_usec)*1000ULL;
+}
+
+//Allocates the limiter the first time a limit is set
+static of1x_packet_in_limiter_t* __of1x_packet_in_limiter_get(of1x_pipeline_t* pipeline){
+
+	of1x_packet_in_limiter_t* limiter;
+
+	if(pipeline->pkt_in_limiter)
+		return pipeline->pkt_in_limiter;
+
+	limiter = (of1x_packet_in_limiter_t*)platform_malloc_shared(sizeof(of1x_packet_in_limiter_t));
+	if(!limiter)
+		return NULL;
+	memset(limiter, 0, sizeof(of1x_packet_in_limiter_t));
+
+	limiter->tables = (of1x_pkt_in_bucket_t*)platform_malloc_shared(sizeof(of1x_pkt_in_bucket_t)*pipeline->num_of_tables);
+	if(!limiter->tables){
+		platform_free_shared(limiter);
+		return NULL;
+	}
+	memset(limiter->tables, 0, sizeof(of1x_pkt_in_bucket_t)*pipeline->num_of_tables);
+
+	if(!__sync_bool_compare_and_swap(&pipeline->pkt_in_limiter, NULL, limiter)){
+		platform_free_shared(limiter->tables);
+		platform_free_shared(limiter);
+	}
+
+	return pipeline->pkt_in_limiter;
+}
+
+static bool __of1x_packet_in_valid_id(of1x_pipeline_t* pipeline, of1x_pkt_in_limit_scope_t scope, unsigned int id){
+
+	switch(scope){
+		case OF1X_PKT_IN_LIMIT_SWITCH:
+			return true;
+		case OF1X_PKT_IN_LIMIT_TABLE:
+			return id < pipeline->num_of_tables;
+		case OF1X_PKT_IN_LIMIT_REASON:
+			return id < OF1X_PKT_IN_LIMITER_NUM_REASONS;
+		default:
+			return false;
+	}
+}
+
+static of1x_pkt_in_bucket_t* __of1x_packet_in_get_bucket(of1x_packet_in_limiter_t* limiter, of1x_pkt_in_limit_scope_t scope, unsigned int id){
+
+	switch(scope){
+		case OF1X_PKT_IN_LIMIT_TABLE:
+			return &limiter->tables[id];
+		case OF1X_PKT_IN_LIMIT_REASON:
+			return &limiter->reasons[id];
+		default:
+			return &limiter->sw;
+	}
+}
+
+rofl_result_t of1x_set_packet_in_limit(of1x_pipeline_t* pipeline, of1x_pkt_in_limit_scope_t scope, unsigned int id, uint32_t rate, uint32_t burst){
+
+	of1x_packet_in_limiter_t* limiter;
+	of1x_pkt_in_bucket_t* bucket;
+
+	if((rate && !burst) || !__of1x_packet_in_valid_id(pipeline, scope, id))
+		return ROFL_FAILURE;
+
+	//Nothing to remove
+	if(!rate && !pipeline->pkt_in_limiter)
+		return ROFL_SUCCESS;
+
+	limiter = __of1x_packet_in_limiter_get(pipeline);
+	if(!limiter)
+		return ROFL_FAILURE;
+
+	bucket = __of1x_packet_in_get_bucket(limiter, scope, id);
+	bucket->rate = rate;
+	bucket->burst = burst;
+	bucket->tolerance_ns = (rate)? (burst-1)*(1000000000ULL/rate) : 0;
+	bucket->tat = 0;
+	__sync_synchronize();
+	bucket->interval_ns = (rate)? 1000000000ULL/rate : 0;
+
+	return ROFL_SUCCESS;
+}
+
+rofl_result_t of1x_get_packet_in_limit_stats(of1x_pipeline_t* pipeline, of1x_pkt_in_limit_scope_t scope, unsigned int id, of1x_pkt_in_limit_stats_t* stats){
+
+	of1x_pkt_in_bucket_t* bucket;
+
+	memset(stats, 0, sizeof(of1x_pkt_in_limit_stats_t));
+
+	if(!__of1x_packet_in_valid_id(pipeline, scope, id))
+		return ROFL_FAILURE;
+
+	//Never configured
+	if(!pipeline->pkt_in_limiter)
+		return ROFL_SUCCESS;
+
+	bucket = __of1x_packet_in_get_bucket(pipeline->pkt_in_limiter, scope, id);
+
+	stats->rate = bucket->rate;
+	stats->burst = bucket->burst;
+	stats->passed = bucket->passed;
+	stats->dropped = bucket->dropped;
+
+	return ROFL_SUCCESS;
+}
+
+rofl_result_t of1x_set_packet_in_flow_filter(of1x_pipeline_t* pipeline, uint32_t window_ms){
+
+	of1x_packet_in_limiter_t* limiter;
+	of1x_pkt_in_filter_core_t* cores;
+
+	if(!window_ms && !pipeline->pkt_in_limiter)
+		return ROFL_SUCCESS;
+
+	limiter = __of1x_packet_in_limiter_get(pipeline);
+	if(!limiter)
+		return ROFL_FAILURE;
+
+	if(window_ms && !limiter->filter){
+		cores = (of1x_pkt_in_filter_core_t*)platform_malloc_shared(sizeof(of1x_pkt_in_filter_core_t)*ROFL_PIPELINE_MAX_CORES);
+		if(!cores)
+			return ROFL_FAILURE;
+		memset(cores, 0, sizeof(of1x_pkt_in_filter_core_t)*ROFL_PIPELINE_MAX_CORES);
+
+		//Slots must be visible before the window
+		if(!__sync_bool_compare_and_swap(&limiter->filter, NULL, cores))
+			platform_free_shared(cores);
+	}
+
+	limiter->filter_window_ms = window_ms;
+
+	return ROFL_SUCCESS;
+}
+
+uint64_t of1x_get_packet_in_flow_filter_suppressed(of1x_pipeline_t* pipeline){
+
+	unsigned int i;
+	uint64_t suppressed = 0;
+
+	if(!pipeline->pkt_in_limiter || !pipeline->pkt_in_limiter->filter)
+		return 0;
+
+	for(i=0;i<ROFL_PIPELINE_MAX_CORES;i++)
+		suppressed += pipeline->pkt_in_limiter->filter[i].suppressed;
+
+	return suppressed;
+}
+
+void __of1x_packet_in_limiter_destroy(of1x_pipeline_t* pipeline){
+
+	of1x_packet_in_limiter_t* limiter = pipeline->pkt_in_limiter;
+
+	if(!limiter)
+		return;
+
+	pipeline->pkt_in_limiter = NULL;
+	if(limiter->filter)
+		platform_free_shared(limiter->filter);
+	platform_free_shared(limiter->tables);
+	platform_free_shared(limiter);
+}
+
+//GCRA; true if admitted
+static inline bool __of1x_pkt_in_bucket_admit(of1x_pkt_in_bucket_t* bucket, uint64_t now){
+
+	uint64_t tat, start, interval = bucket->interval_ns;
+
+	if(!interval)
+		return true;
+
+	do{
+		tat = bucket->tat;
+		start = (tat < now)? now : tat;
+
+		if(start - now > bucket->tolerance_ns){
+			__sync_fetch_and_add(&bucket->dropped, 1);
+			return false;
+		}
+	}while(!__sync_bool_compare_and_swap(&bucket->tat, tat, start + interval));
+
+	__sync_fetch_and_add(&bucket->passed, 1);
+	return true;
+}
+
+//Returns the token of a packet admitted but rejected by another bucket
+static inline void __of1x_pkt_in_bucket_refund(of1x_pkt_in_bucket_t* bucket){
+
+	uint64_t interval = bucket->interval_ns;
+
+	if(!interval)
+		return;
+
+	__sync_fetch_and_sub(&bucket->tat, interval);
+	__sync_fetch_and_sub(&bucket->passed, 1);
+}
+
+//Flow hash (port, addresses, protocol and L4 ports)
+static inline uint32_t __of1x_pkt_in_flow_hash(unsigned int table_id, of1x_packet_matches_t* m, int reason){
+
+	uint64_t h;
+
+	h = ((uint64_t)m->port_in << 32) ^ (table_id << 8) ^ reason;
+	h = (h ^ m->eth_dst) * 0x9E3779B97F4A7C15ULL;
+	h = (h ^ m->eth_src) * 0x9E3779B97F4A7C15ULL;
+	h = (h ^ (((uint64_t)m->eth_type << 32) | ((uint64_t)m->vlan_vid << 8) | m->ip_proto)) * 0x9E3779B97F4A7C15ULL;
+	h = (h ^ (((uint64_t)m->ipv4_src << 32) | m->ipv4_dst)) * 0x9E3779B97F4A7C15ULL;
+	h = (h ^ UINT128__T_HI(m->ipv6_src)) * 0x9E3779B97F4A7C15ULL;
+	h = (h ^ UINT128__T_LO(m->ipv6_src)) * 0x9E3779B97F4A7C15ULL;
+	h = (h ^ UINT128__T_HI(m->ipv6_dst)) * 0x9E3779B97F4A7C15ULL;
+	h = (h ^ UINT128__T_LO(m->ipv6_dst)) * 0x9E3779B97F4A7C15ULL;
+	h = (h ^ (((uint64_t)(m->tcp_src | m->udp_src | m->sctp_src) << 16) | (m->tcp_dst | m->udp_dst | m->sctp_dst))) * 0x9E3779B97F4A7C15ULL;
+
+	return (uint32_t)(h >> 32) | 1; //Never 0 (empty slot)
+}
+
+//true if the flow was already sent to the controller within the window
+static inline bool __of1x_pkt_in_filter_duplicate(of1x_packet_in_limiter_t* limiter, unsigned int table_id, datapacket_t* pkt, int reason, uint64_t now){
+
+	of1x_pkt_in_filter_core_t* core = &limiter->filter[__per_core_id()];
+	of1x_pkt_in_filter_slot_t* slot;
+	uint32_t hash;
+
+	hash = __of1x_pkt_in_flow_hash(table_id, &pkt->matches.of1x, reason);
+	slot = &core->slots[(hash >> 1) & (OF1X_PKT_IN_FILTER_SLOTS-1)];
+
+	if(slot->hash == hash && now - slot->time_ns < limiter->filter_window_ms*1000000ULL){
+		core->suppressed++;
+		return true;
+	}
+
+	slot->hash = hash;
+	slot->time_ns = now;
+	return false;
+}
+
+bool __of1x_packet_in_admit(of1x_pipeline_t* pipeline, unsigned int table_id, datapacket_t* pkt, int reason){
+
+	of1x_packet_in_limiter_t* limiter = pipeline->pkt_in_limiter;
+	of1x_pkt_in_bucket_t *reason_bucket = NULL, *table_bucket = NULL;
+	uint64_t now = __of1x_pkt_in_now_ns();
+
+	//Duplicates do not consume tokens
+	if(limiter->filter_window_ms && limiter->filter && __of1x_pkt_in_filter_duplicate(limiter, table_id, pkt, reason, now))
+		return false;
+
+	//Most specific first; tokens are returned if a wider limit rejects the packet
+	if(reason >= 0 && reason < OF1X_PKT_IN_LIMITER_NUM_REASONS)
+		reason_bucket = &limiter->reasons[reason];
+	if(table_id < pipeline->num_of_tables)
+		table_bucket = &limiter->tables[table_id];
+
+	if(reason_bucket && !__of1x_pkt_in_bucket_admit(reason_bucket, now))
+		return false;
+
+	if(table_bucket && !__of1x_pkt_in_bucket_admit(table_bucket, now)){
+		if(reason_bucket)
+			__of1x_pkt_in_bucket_refund(reason_bucket);
+		return false;
+	}
+
+	if(!__of1x_pkt_in_bucket_admit(&limiter->sw, now)){
+		if(reason_bucket)
+			__of1x_pkt_in_bucket_refund(reason_bucket);
+		if(table_bucket)
+			__of1x_pkt_in_bucket_refund(table_bucket);
+		return false;
+	}
+
+	return true;
+}
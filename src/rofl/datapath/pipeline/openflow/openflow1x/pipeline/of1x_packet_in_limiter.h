@@ -0,0 +1,148 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef __OF1X_PACKET_IN_LIMITER_H__
+#define __OF1X_PACKET_IN_LIMITER_H__
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include "rofl.h"
+#include "../../../common/datapacket.h"
+
+/**
+* @file of1x_packet_in_limiter.h
+* @brief Packet-in rate limiting and duplicate flow suppression
+*
+* Packet-ins (table miss to controller and output to CONTROLLER) are
+* admitted by token buckets before platform_of1x_packet_in() is called:
+* one per switch, one per table and one per reason. Packets not admitted
+* are dropped and counted in the bucket that rejected them (the tokens taken
+* from the other buckets are returned).
+*
+* Buckets are lock-free (GCRA: a single theoretical arrival time updated
+* with compare-and-swap) and shared by all cores.
+*
+* Optionally, a per-core recent flow filter suppresses packet-ins of a flow
+* (port, addresses, protocol and L4 ports) already sent to the controller
+* within the last window_ms.
+*
+* With no limit configured the cost is a single branch per packet-in.
+*/
+
+//Packet-in reasons (OF1X_PKT_IN_NO_MATCH, OF1X_PKT_IN_ACTION, OF1X_PKT_IN_INVALID_TTL)
+#define OF1X_PKT_IN_LIMITER_NUM_REASONS 3
+
+//Recent flow filter slots (per core; power of 2)
+#define OF1X_PKT_IN_FILTER_SLOTS 256
+
+/**
+* @ingroup core_of1x
+* Scope of a packet-in limit
+*/
+typedef enum of1x_pkt_in_limit_scope{
+	OF1X_PKT_IN_LIMIT_SWITCH = 0,		/* All the packet-ins of the switch */
+	OF1X_PKT_IN_LIMIT_TABLE = 1,		/* Packet-ins generated in a table */
+	OF1X_PKT_IN_LIMIT_REASON = 2,		/* Packet-ins with a reason (of_packet_in_reason_t) */
+}of1x_pkt_in_limit_scope_t;
+
+/**
+* Token bucket
+*/
+typedef struct of1x_pkt_in_bucket{
+	volatile uint64_t tat;			//Theoretical arrival time (ns)
+	uint64_t interval_ns;			//1/rate (0 unlimited)
+	uint64_t tolerance_ns;			//(burst-1)*interval
+
+	//Counters
+	volatile uint64_t passed;
+	volatile uint64_t dropped;
+
+	uint32_t rate;				//pps
+	uint32_t burst;				//packets
+	uint64_t __pad[2];
+}of1x_pkt_in_bucket_t;
+
+/**
+* Recent flow filter (per core; only accessed by the owning core)
+*/
+typedef struct of1x_pkt_in_filter_slot{
+	uint32_t hash;
+	uint64_t time_ns;			//Last packet-in sent
+}of1x_pkt_in_filter_slot_t;
+
+typedef struct of1x_pkt_in_filter_core{
+	uint64_t suppressed;
+	uint64_t __pad[7];
+	of1x_pkt_in_filter_slot_t slots[OF1X_PKT_IN_FILTER_SLOTS];
+}of1x_pkt_in_filter_core_t;
+
+/**
+* Packet-in limiter of a pipeline
+*/
+typedef struct of1x_packet_in_limiter{
+	of1x_pkt_in_bucket_t sw;
+	of1x_pkt_in_bucket_t reasons[OF1X_PKT_IN_LIMITER_NUM_REASONS];
+	of1x_pkt_in_bucket_t* tables;		//One per table
+
+	//Recent flow filter (0 disabled)
+	uint32_t filter_window_ms;
+	of1x_pkt_in_filter_core_t* filter;
+}of1x_packet_in_limiter_t;
+
+/**
+* @ingroup core_of1x
+* Packet-in limit configuration and counters
+*/
+typedef struct of1x_pkt_in_limit_stats{
+	uint32_t rate;				/* pps (0 unlimited) */
+	uint32_t burst;
+	uint64_t passed;			/* Admitted while the limit was set */
+	uint64_t dropped;
+}of1x_pkt_in_limit_stats_t;
+
+//Fwd declarations
+struct of1x_pipeline;
+
+//C++ extern C
+ROFL_BEGIN_DECLS
+
+/**
+* @ingroup core_of1x
+* Sets (or removes, rate 0) a packet-in limit
+*
+* @param id table id (OF1X_PKT_IN_LIMIT_TABLE) or reason (OF1X_PKT_IN_LIMIT_REASON); ignored for OF1X_PKT_IN_LIMIT_SWITCH
+* @param rate packet-ins per second
+* @param burst packet-ins admitted back to back (at least 1)
+*/
+rofl_result_t of1x_set_packet_in_limit(struct of1x_pipeline* pipeline, of1x_pkt_in_limit_scope_t scope, unsigned int id, uint32_t rate, uint32_t burst);
+
+/**
+* @ingroup core_of1x
+* Retrieves a packet-in limit and its counters
+*/
+rofl_result_t of1x_get_packet_in_limit_stats(struct of1x_pipeline* pipeline, of1x_pkt_in_limit_scope_t scope, unsigned int id, of1x_pkt_in_limit_stats_t* stats);
+
+/**
+* @ingroup core_of1x
+* Enables (or disables, window_ms 0) the suppression of packet-ins of flows
+* already sent to the controller in the last window_ms
+*/
+rofl_result_t of1x_set_packet_in_flow_filter(struct of1x_pipeline* pipeline, uint32_t window_ms);
+
+/**
+* @ingroup core_of1x
+* Number of packet-ins suppressed by the flow filter
+*/
+uint64_t of1x_get_packet_in_flow_filter_suppressed(struct of1x_pipeline* pipeline);
+
+//Release the limiter
+void __of1x_packet_in_limiter_destroy(struct of1x_pipeline* pipeline);
+
+//Whether a packet-in has to be sent (pkt is only used for its matches). Only called if pipeline->pkt_in_limiter is set
+bool __of1x_packet_in_admit(struct of1x_pipeline* pipeline, unsigned int table_id, datapacket_t* pkt, int reason);
+
+//C++ extern C
+ROFL_END_DECLS
+
+#endif //OF1X_PACKET_IN_LIMITER
@@ -14,6 +14,7 @@ void __of1x_update_packet_matches(datapacket_t *const pkt){
 
 	//Pkt size
 	matches->pkt_size_bytes = platform_packet_get_size_bytes(pkt);
+	matches->headers_changed = false;
 	
 	//Ports
 	matches->port_in = platform_packet_get_port_in(pkt);
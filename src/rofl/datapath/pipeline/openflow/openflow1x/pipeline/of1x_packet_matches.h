@@ -32,6 +32,9 @@ typedef struct{
 	
 	//Associated metadata
 	uint64_t metadata;		/* Metadata passed between tables. */
+
+	//Encap/decap (push/pop) since parsed; L3+ fields may be stale
+	bool headers_changed;
  
 	//802
 	uint64_t eth_dst;		/* Ethernet destination address. */
@@ -8,6 +8,7 @@
 #include "../of1x_async_events_hooks.h"
 #include "matching_algorithms/matching_algorithms_available.h"
 #include "../of1x_switch.h"
+#include "../../../virtual_link.h"
 
 #include "../../../util/logging.h"
 
@@ -85,6 +86,26 @@ of1x_pipeline_t* __of1x_init_pipeline(struct of1x_switch* sw, const unsigned int
 	//init groups
 	pipeline->groups = of1x_init_group_table();
 
+	//init meters
+	pipeline->meters = of1x_init_meter_table();
+
+	//Buffer pool (created once the platform has set num_of_buffers)
+	pipeline->buffers = NULL;
+
+	//Packet-in limiter (not configured)
+	pipeline->pkt_in_limiter = NULL;
+
+	//Flight recorder (disabled)
+	pipeline->flight_recorder_rate = 0;
+	pipeline->flight_recorder = NULL;
+
+	//Latency histograms
+	pipeline->latency = NULL;
+#ifdef ROFL_PIPELINE_LATENCY_STATS
+	if(__of1x_latency_init(pipeline) != ROFL_SUCCESS)
+		ROFL_PIPELINE_WARN("Unable to allocate the latency histograms of logical switch %s; latency will not be recorded\n",sw->name);
+#endif
+
 	return pipeline;
 }
 
@@ -99,6 +120,16 @@ rofl_result_t __of1x_destroy_pipeline(of1x_pipeline_t* pipeline){
 		//We don't care about errors here, maybe add trace TODO
 		__of1x_destroy_table(&pipeline->tables[i]);
 	}
+
+	//destroy meters (after the entries referring to them)
+	of1x_destroy_meter_table(pipeline->meters);
+
+#ifdef ROFL_PIPELINE_LATENCY_STATS
+	__of1x_latency_destroy(pipeline);
+#endif
+	__of1x_flight_recorder_destroy(pipeline);
+	__of1x_destroy_buffer_pool(pipeline);
+	__of1x_packet_in_limiter_destroy(pipeline);
 			
 	//Now release table resources (allocated as single block)
 	platform_free_shared(pipeline->tables);
@@ -143,6 +174,12 @@ rofl_result_t __of1x_purge_pipeline_entries(of1x_pipeline_t* pipeline){
 		if(of1x_group_delete(pipeline, group_entry, OF1X_GROUP_ANY) != ROFL_OF1X_GM_OK)
 			result = ROFL_FAILURE;
 	}
+
+	//Purge meter mods
+	if(result == ROFL_SUCCESS){
+		if(of1x_meter_delete(pipeline, pipeline->meters, OF1X_METER_ALL) != ROFL_OF1X_MM_OK)
+			result = ROFL_FAILURE;
+	}
 	
 	//Destroy entries
 	of1x_destroy_flow_entry(flow_entry);
@@ -183,15 +220,16 @@ rofl_result_t __of1x_set_pipeline_tables_defaults(of1x_pipeline_t* pipeline, of_
 * Packet processing through pipeline
 *
 */
-void __of1x_process_packet_pipeline(const of_switch_t *sw, datapacket_t *const pkt){
+static inline void __of1x_process_packet_pipeline_tables(const of_switch_t *sw, datapacket_t *const pkt){
 
 	//Loop over tables
 	unsigned int i, table_to_go, num_of_outputs;
 	of1x_flow_entry_t* match;
 	of1x_packet_matches_t* pkt_matches;
+	of1x_flight_record_t* record = NULL;
+	uint32_t flight_recorder_rate;
 	
-	//Initialize packet for OF1.2 pipeline processing 
-	__of1x_init_packet_matches(pkt); 
+	//Matches are already initialized
 	__of1x_init_packet_write_actions(pkt); 
 
 	//Mark packet as being processed by this sw
@@ -205,27 +243,53 @@ void __of1x_process_packet_pipeline(const of_switch_t *sw, datapacket_t *const p
 #ifdef DEBUG
 	of1x_dump_packet_matches(&pkt->matches);
 #endif
+
+	//Sample the packet for the flight recorder (the rate may change concurrently; read it once)
+	flight_recorder_rate = ((of1x_switch_t*)sw)->pipeline->flight_recorder_rate;
+	if(flight_recorder_rate)
+		record = __of1x_flight_recorder_begin(((of1x_switch_t*)sw)->pipeline, flight_recorder_rate, pkt_matches->port_in, pkt_matches->pkt_size_bytes, pkt_matches->eth_type);
 	
 	//FIXME: add metadata+write operations 
 	for(i=OF1X_FIRST_FLOW_TABLE_INDEX; i < ((of1x_switch_t*)sw)->pipeline->num_of_tables ; i++){
 		
 		//Perform lookup	
+		OF1X_LATENCY_START(lookup_start);
 		match = __of1x_find_best_match_table((of1x_flow_table_t* const)&((of1x_switch_t*)sw)->pipeline->tables[i], pkt_matches);
+		OF1X_LATENCY_END(((of1x_switch_t*)sw)->pipeline, i, OF1X_LATENCY_STAGE_LOOKUP, lookup_start);
 		
 		if(match){
 			
 
 			ROFL_PIPELINE_DEBUG("Packet[%p] matched at table: %u, entry: %p\n", pkt, i,match);
 
+			if(record)
+				__of1x_flight_recorder_hop(record, i, match, match->cookie);
+
 			//Update table and entry statistics
 			__of1x_stats_table_matches_inc(&((of1x_switch_t*)sw)->pipeline->tables[i]);
 			__of1x_stats_flow_update_match(match, pkt_matches->pkt_size_bytes);
 
-			//Update entry timers
+			//Update entry timers and recency (eviction)
 			__of1x_timer_update_entry(match);
+			__of1x_flow_entry_mark_referenced(match);
 
 			//Process instructions
+			OF1X_LATENCY_START(inst_start);
 			table_to_go = __of1x_process_instructions((of1x_switch_t*)sw, i, pkt, &match->inst_grp);
+			OF1X_LATENCY_END(((of1x_switch_t*)sw)->pipeline, i, OF1X_LATENCY_STAGE_INSTRUCTIONS, inst_start);
+
+			if(table_to_go == OF1X_IT_DROP_PKT){
+				ROFL_PIPELINE_DEBUG("Packet[%p] dropped by meter at table: %u\n", pkt, i);
+				
+				//Unlock the entry so that it can eventually be modified/deleted
+				platform_rwlock_rdunlock(match->rwlock);
+
+				if(record)
+					__of1x_flight_recorder_end(((of1x_switch_t*)sw)->pipeline, record, OF1X_FLIGHT_DROP_METER);
+				
+				platform_packet_drop(pkt);
+				return;
+			}
 
 			if(table_to_go > i && table_to_go < OF1X_MAX_FLOWTABLES){
 
@@ -239,7 +303,9 @@ void __of1x_process_packet_pipeline(const of_switch_t *sw, datapacket_t *const p
 			}
 
 			//Process WRITE actions
+			OF1X_LATENCY_START(actions_start);
 			__of1x_process_write_actions((of1x_switch_t*)sw, i, pkt, __of1x_process_instructions_must_replicate(&match->inst_grp));
+			OF1X_LATENCY_END(((of1x_switch_t*)sw)->pipeline, i, OF1X_LATENCY_STAGE_ACTIONS, actions_start);
 
 			//Recover the num_of_outputs to release the lock asap
 			num_of_outputs = match->inst_grp.num_of_outputs;
@@ -247,6 +313,9 @@ void __of1x_process_packet_pipeline(const of_switch_t *sw, datapacket_t *const p
 			//Unlock the entry so that it can eventually be modified/deleted
 			platform_rwlock_rdunlock(match->rwlock);
 
+			if(record)
+				__of1x_flight_recorder_end(((of1x_switch_t*)sw)->pipeline, record, OF1X_FLIGHT_DROP_NO_OUTPUT);
+
 			//Drop packet Only if there has been copy(cloning of the packet) due to 
 			//multiple output actions
 			if(num_of_outputs != 1)
@@ -257,10 +326,16 @@ void __of1x_process_packet_pipeline(const of_switch_t *sw, datapacket_t *const p
 			//Update table statistics
 			__of1x_stats_table_lookup_inc(&((of1x_switch_t*)sw)->pipeline->tables[i]);
 
+			if(record)
+				__of1x_flight_recorder_hop(record, i, NULL, 0);
+
 			//Not matched, look for table_miss behaviour 
 			if(((of1x_switch_t*)sw)->pipeline->tables[i].default_action == OF1X_TABLE_MISS_DROP){
 
 				ROFL_PIPELINE_DEBUG("Packet[%p] table MISS_DROP %u\n",pkt, i);	
+
+				if(record)
+					__of1x_flight_recorder_end(((of1x_switch_t*)sw)->pipeline, record, OF1X_FLIGHT_DROP_TABLE_MISS);
 				platform_packet_drop(pkt);
 				return;
 
@@ -268,6 +343,16 @@ void __of1x_process_packet_pipeline(const of_switch_t *sw, datapacket_t *const p
 			
 				ROFL_PIPELINE_DEBUG("Packet[%p] table MISS_CONTROLLER. It Will generate a PACKET_IN event to the controller\n",pkt);
 
+				if(((of1x_switch_t*)sw)->pipeline->pkt_in_limiter && !__of1x_packet_in_admit(((of1x_switch_t*)sw)->pipeline, i, pkt, OF1X_PKT_IN_NO_MATCH)){
+					if(record)
+						__of1x_flight_recorder_end(((of1x_switch_t*)sw)->pipeline, record, OF1X_FLIGHT_DROP_PACKET_IN_LIMIT);
+					platform_packet_drop(pkt);
+					return;
+				}
+
+				if(record)
+					__of1x_flight_recorder_end(((of1x_switch_t*)sw)->pipeline, record, OF1X_FLIGHT_PACKET_IN_MISS);
+
 				platform_of1x_packet_in((of1x_switch_t*)sw, i, pkt, OF1X_PKT_IN_NO_MATCH);
 				return;
 			}
@@ -276,10 +361,35 @@ void __of1x_process_packet_pipeline(const of_switch_t *sw, datapacket_t *const p
 	}
 	
 	//No match/default table action -> DROP the packet	
+	if(record)
+		__of1x_flight_recorder_end(((of1x_switch_t*)sw)->pipeline, record, OF1X_FLIGHT_DROP_END_OF_PIPELINE);
 	platform_packet_drop(pkt);
 
 }
 
+void __of1x_process_packet_pipeline(const of_switch_t *sw, datapacket_t *const pkt){
+
+	//Initialize packet for OF1.2 pipeline processing 
+	__of1x_init_packet_matches(pkt); 
+
+	__of1x_process_packet_pipeline_tables(sw, pkt);
+}
+
+void __of1x_process_packet_pipeline_vlink(const of_switch_t *sw, datapacket_t *const pkt, uint32_t port_in, bool matches_valid){
+
+	of1x_packet_matches_t* pkt_matches = &pkt->matches.of1x;
+
+	//Headers already parsed by the switch at the other end of the link
+	if(matches_valid)
+		pkt_matches->metadata = 0x0;
+	else
+		__of1x_init_packet_matches(pkt);
+
+	pkt_matches->port_in = pkt_matches->phy_port_in = port_in;
+
+	__of1x_process_packet_pipeline_tables(sw, pkt);
+}
+
 /*
 * Process the packet out 
 */
@@ -287,6 +397,7 @@ void of1x_process_packet_out_pipeline(const of1x_switch_t *sw, datapacket_t *con
 	
 	bool has_multiple_outputs=false;
 	of1x_group_table_t *gt = sw->pipeline->groups;
+	virtual_link_core_t* vlink_core = NULL;
 
 	//Initialize packet for OF1.2 pipeline processing 
 	__of1x_init_packet_matches(pkt); 
@@ -303,6 +414,10 @@ void of1x_process_packet_out_pipeline(const of1x_switch_t *sw, datapacket_t *con
 	
 	has_multiple_outputs = (apply_actions_group->num_of_output_actions > 1);
 
+	//Packets sent through virtual links are processed afterwards
+	if(__virtual_link_cores)
+		vlink_core = __virtual_link_enter();
+
 	//Just process the action group
 	__of1x_process_apply_actions((of1x_switch_t*)sw, 0, pkt, apply_actions_group, has_multiple_outputs);
 		
@@ -310,4 +425,7 @@ void of1x_process_packet_out_pipeline(const of1x_switch_t *sw, datapacket_t *con
 		//Packet was replicated. Drop original packet
 		platform_packet_drop(pkt);
 	}
+
+	if(vlink_core)
+		__virtual_link_leave(vlink_core);
 }
@@ -9,6 +9,11 @@
 #include "rofl.h" 
 #include "of1x_flow_table.h"
 #include "of1x_group_table.h"
+#include "of1x_meter_table.h"
+#include "of1x_latency.h"
+#include "of1x_flight_recorder.h"
+#include "of1x_buffer_pool.h"
+#include "of1x_packet_in_limiter.h"
 #include "../../../common/bitmap.h"
 #include "../../../common/datapacket.h"
 #include "../../of_switch.h"
@@ -55,6 +60,12 @@ typedef struct of1x_pipeline{
 	//Number of buffers
 	unsigned int num_of_buffers;
 
+	//Packet buffers (NULL if num_of_buffers is 0)
+	of1x_buffer_pool_t* buffers;
+
+	//Packet-in limits (NULL if never configured)
+	of1x_packet_in_limiter_t* pkt_in_limiter;
+
 	//Capabilities bitmap (OF1X_CAP_FLOW_STATS, OF1X_CAP_TABLE_STATS, ...)
 	bitmap32_t capabilities;
 
@@ -67,6 +78,16 @@ typedef struct of1x_pipeline{
 	//Group table
 	of1x_group_table_t* groups;
 
+	//Meter table
+	of1x_meter_table_t* meters;
+
+	//Latency histograms [core][table][stage] (NULL if not compiled in)
+	of1x_latency_hist_t* latency;
+
+	//Flight recorder (1 out of flight_recorder_rate packets; 0 disabled)
+	uint32_t flight_recorder_rate;
+	of1x_flight_recorder_core_t* flight_recorder;
+
 	//Reference back
 	struct of1x_switch* sw;	
 }of1x_pipeline_t;
@@ -84,6 +105,9 @@ rofl_result_t __of1x_purge_pipeline_entries(of1x_pipeline_t* pipeline);
 //Packet processing
 void __of1x_process_packet_pipeline(const of_switch_t *sw, datapacket_t *const pkt);
 
+//Processing of a packet received through a virtual link (virtual_link.h) on port port_in
+void __of1x_process_packet_pipeline_vlink(const of_switch_t *sw, datapacket_t *const pkt, uint32_t port_in, bool matches_valid);
+
 //Set the default tables(flow and group tables) configuration according to the new version
 rofl_result_t __of1x_set_pipeline_tables_defaults(of1x_pipeline_t* pipeline, of_version_t version);
 
@@ -0,0 +1,874 @@
+#include "of1x_snapshot.h"
+
+#include <string.h>
+#include <sys/time.h>
+#include "of1x_pipeline.h"
+#include "of1x_flow_entry.h"
+#include "of1x_flow_table.h"
+#include "of1x_group_table.h"
+#include "of1x_meter_table.h"
+#include "of1x_timers.h"
+#include "../of1x_async_events_hooks.h"
+#include "../of1x_switch.h"
+#include "../../../platform/atomic_operations.h"
+#include "../../../platform/lock.h"
+#include "../../../util/logging.h"
+
+/*
+* Pipeline snapshots
+*/
+
+//Image cursor; with no base only the size is accounted (records go to scratch)
+typedef struct of1x_snapshot_cursor{
+	uint8_t* base;
+	size_t size;
+	size_t offset;
+	bool overflow;
+	uint64_t scratch[sizeof(of1x_snapshot_meter_t)/sizeof(uint64_t)+1];
+}of1x_snapshot_cursor_t;
+
+static inline uint32_t __of1x_snapshot_record_sizes(void){
+	return sizeof(of1x_snapshot_header_t) + 3*sizeof(of1x_snapshot_meter_t) + 5*sizeof(of1x_snapshot_group_t) +
+		7*sizeof(of1x_snapshot_bucket_t) + 11*sizeof(of1x_snapshot_action_t) + 13*sizeof(of1x_snapshot_table_t) +
+		17*sizeof(of1x_snapshot_entry_t) + 19*sizeof(of1x_snapshot_match_t) + 23*sizeof(of1x_snapshot_instruction_t);
+}
+
+static void* __of1x_snapshot_put(of1x_snapshot_cursor_t* cur, size_t len){
+
+	void* rec;
+
+	if(cur->base && cur->offset+len <= cur->size){
+		rec = cur->base + cur->offset;
+	}else{
+		if(cur->base)
+			cur->overflow = true;
+		rec = cur->scratch;
+	}
+
+	memset(rec, 0, len);
+	cur->offset += len;
+
+	return rec;
+}
+
+static const void* __of1x_snapshot_get(of1x_snapshot_cursor_t* cur, size_t len){
+
+	const void* rec;
+
+	if(cur->offset+len > cur->size)
+		return NULL;
+
+	rec = cur->base + cur->offset;
+	cur->offset += len;
+
+	return rec;
+}
+
+static inline uint64_t __of1x_snapshot_ms_since(const struct timeval* now, const struct timeval* then){
+
+	int64_t ms = (now->tv_sec - then->tv_sec)*1000LL + (now->tv_usec - then->tv_usec)/1000;
+
+	return (ms > 0)? (uint64_t)ms : 0;
+}
+
+static inline void __of1x_snapshot_ms_before(const struct timeval* now, uint64_t ms, struct timeval* then){
+
+	uint64_t us = now->tv_sec*1000000ULL + now->tv_usec;
+
+	us = (us > ms*1000)? us - ms*1000 : 0;
+	then->tv_sec = us/1000000;
+	then->tv_usec = us%1000000;
+}
+
+/*
+* Save
+*/
+
+static void __of1x_snapshot_put_actions(of1x_snapshot_cursor_t* cur, const of1x_action_group_t* actions, uint32_t* num_of_actions){
+
+	of1x_packet_action_t* it;
+	of1x_snapshot_action_t* rec;
+
+	for(it=actions->head; it; it=it->next){
+		rec = __of1x_snapshot_put(cur, sizeof(*rec));
+		rec->type = it->type;
+		rec->field = it->field;
+		(*num_of_actions)++;
+	}
+}
+
+static void __of1x_snapshot_put_meters(of1x_snapshot_cursor_t* cur, of1x_meter_table_t* mt, uint32_t* num_of_meters){
+
+	unsigned int i, j;
+	uint64_t now_us;
+	struct timeval now;
+	of1x_meter_t* meter;
+	const of1x_meter_config_t* config;
+	of1x_snapshot_meter_t* rec;
+
+	__of1x_gettimeofday(&now, NULL);
+	now_us = now.tv_sec*1000000ULL + now.tv_usec;
+
+	platform_rwlock_rdlock(mt->rwlock);
+
+	for(meter=mt->head; meter; meter=meter->next){
+		//The configuration can be replaced by of1x_meter_modify()
+		platform_rwlock_rdlock(meter->rwlock);
+		config = meter->config;
+
+		rec = __of1x_snapshot_put(cur, sizeof(*rec));
+		rec->id = meter->id;
+		rec->flags = config->flags;
+		rec->num_of_bands = config->num_of_bands;
+		rec->duration_us = (now_us > meter->creation_time_us)? now_us - meter->creation_time_us : 0;
+
+		for(j=0;j<ROFL_PIPELINE_MAX_CORES;j++){
+			rec->packet_count += meter->cores[j].packet_count;
+			rec->byte_count += meter->cores[j].byte_count;
+		}
+
+		for(i=0;i<config->num_of_bands;i++){
+			rec->bands[i].type = config->bands[i].config.type;
+			rec->bands[i].rate = config->bands[i].config.rate;
+			rec->bands[i].burst_size = config->bands[i].config.burst_size;
+			rec->bands[i].prec_level = config->bands[i].config.prec_level;
+			__of1x_meter_band_get_counts(&config->bands[i], &rec->bands[i].packet_count, &rec->bands[i].byte_count);
+		}
+		platform_rwlock_rdunlock(meter->rwlock);
+		(*num_of_meters)++;
+	}
+
+	platform_rwlock_rdunlock(mt->rwlock);
+}
+
+static void __of1x_snapshot_put_groups(of1x_snapshot_cursor_t* cur, of1x_group_table_t* gt, uint32_t* num_of_groups){
+
+	of1x_group_t* group;
+	of1x_bucket_t* bucket;
+	of1x_snapshot_group_t* rec;
+	of1x_snapshot_bucket_t* bucket_rec;
+
+	platform_rwlock_rdlock(gt->rwlock);
+
+	for(group=gt->head; group; group=group->next){
+		rec = __of1x_snapshot_put(cur, sizeof(*rec));
+		rec->id = group->id;
+		rec->type = group->type;
+
+		//Buckets and their counters can be replaced by of1x_group_modify()
+		platform_rwlock_rdlock(group->rwlock);
+		__of1x_stats_group_get_counts(&group->stats, OF1X_STATS_GROUP_COLUMN, &rec->packet_count, &rec->byte_count);
+
+		for(bucket=group->bc_list->head; bucket; bucket=bucket->next){
+			bucket_rec = __of1x_snapshot_put(cur, sizeof(*bucket_rec));
+			bucket_rec->weight = bucket->weight;
+			bucket_rec->port = bucket->port;
+			bucket_rec->group = bucket->group;
+			__of1x_stats_group_get_counts(&group->stats, OF1X_STATS_BUCKET_COLUMN(bucket->index), &bucket_rec->packet_count, &bucket_rec->byte_count);
+			__of1x_snapshot_put_actions(cur, bucket->actions, &bucket_rec->num_of_actions);
+			rec->num_of_buckets++;
+		}
+		platform_rwlock_rdunlock(group->rwlock);
+		(*num_of_groups)++;
+	}
+
+	platform_rwlock_rdunlock(gt->rwlock);
+}
+
+static void __of1x_snapshot_put_entry(of1x_snapshot_cursor_t* cur, of1x_flow_entry_t* entry, const struct timeval* now){
+
+	unsigned int i, j;
+	of1x_match_t* match;
+	of1x_instruction_t* inst;
+	of1x_snapshot_entry_t* rec;
+	of1x_snapshot_match_t* match_rec;
+	of1x_snapshot_instruction_t* inst_rec;
+	of1x_snapshot_action_t* action_rec;
+
+	rec = __of1x_snapshot_put(cur, sizeof(*rec));
+	rec->priority = entry->priority;
+	rec->num_of_outputs = entry->inst_grp.num_of_outputs;
+	rec->cookie = entry->cookie;
+	rec->cookie_mask = entry->cookie_mask;
+	rec->hard_timeout = entry->timer_info.hard_timeout;
+	rec->idle_timeout = entry->timer_info.idle_timeout;
+	rec->age_ms = __of1x_snapshot_ms_since(now, &entry->stats.initial_time);
+	if(entry->timer_info.idle_timeout)
+		rec->idle_ms = __of1x_snapshot_ms_since(now, &entry->timer_info.time_last_update);
+	rec->packet_count = entry->stats.packet_count;
+	rec->byte_count = entry->stats.byte_count;
+	rec->notify_removal = entry->notify_removal;
+	rec->importance = entry->importance;
+
+	for(match=entry->matches.head; match; match=match->next){
+		match_rec = __of1x_snapshot_put(cur, sizeof(*match_rec));
+		match_rec->type = match->type;
+		match_rec->utern_type = match->value->type;
+		match_rec->value = match->value->value;
+		match_rec->mask = match->value->mask;
+		rec->num_of_matches++;
+	}
+
+	for(i=0;i<OF1X_IT_MAX;i++){
+		inst = &entry->inst_grp.instructions[i];
+		if(inst->type == OF1X_IT_NO_INSTRUCTION)
+			continue;
+
+		inst_rec = __of1x_snapshot_put(cur, sizeof(*inst_rec));
+		inst_rec->type = inst->type;
+		inst_rec->go_to_table = inst->go_to_table;
+		inst_rec->meter_id = inst->meter_id;
+		inst_rec->metadata = inst->write_metadata.metadata;
+		inst_rec->metadata_mask = inst->write_metadata.metadata_mask;
+
+		if(inst->type == OF1X_IT_APPLY_ACTIONS && inst->apply_actions){
+			inst_rec->num_of_output_actions = inst->apply_actions->num_of_output_actions;
+			__of1x_snapshot_put_actions(cur, inst->apply_actions, &inst_rec->num_of_actions);
+		}else if(inst->type == OF1X_IT_WRITE_ACTIONS && inst->write_actions){
+			inst_rec->num_of_output_actions = inst->write_actions->num_of_output_actions;
+			inst_rec->num_of_write_actions = inst->write_actions->num_of_actions;
+			for(j=0;j<OF1X_AT_NUMBER;j++){
+				if(inst->write_actions->write_actions[j].type == OF1X_AT_NO_ACTION)
+					continue;
+				action_rec = __of1x_snapshot_put(cur, sizeof(*action_rec));
+				action_rec->type = inst->write_actions->write_actions[j].type;
+				action_rec->field = inst->write_actions->write_actions[j].field;
+				inst_rec->num_of_actions++;
+			}
+		}
+		rec->num_of_instructions++;
+	}
+}
+
+static void __of1x_snapshot_put_table(of1x_snapshot_cursor_t* cur, of1x_flow_table_t* table){
+
+	struct timeval now;
+	of1x_flow_entry_t* entry;
+	of1x_snapshot_table_t* rec;
+
+	//Flow mods and expirations
+	platform_mutex_lock(table->mutex);
+
+	__of1x_gettimeofday(&now, NULL);
+
+	rec = __of1x_snapshot_put(cur, sizeof(*rec));
+	rec->number = table->number;
+	rec->default_action = table->default_action;
+	rec->lookup_count = table->stats.lookup_count;
+	rec->matched_count = table->stats.matched_count;
+
+	for(entry=table->entries; entry; entry=entry->next){
+		__of1x_snapshot_put_entry(cur, entry, &now);
+		rec->num_of_entries++;
+	}
+
+	platform_mutex_unlock(table->mutex);
+}
+
+static void __of1x_snapshot_dump(of1x_pipeline_t* pipeline, of1x_snapshot_cursor_t* cur){
+
+	unsigned int i;
+	uint32_t num_of_meters = 0, num_of_groups = 0;
+	of1x_snapshot_header_t* header;
+
+	header = __of1x_snapshot_put(cur, sizeof(*header));
+	header->magic = OF1X_SNAPSHOT_MAGIC;
+	header->version = OF1X_SNAPSHOT_VERSION;
+	header->record_sizes = __of1x_snapshot_record_sizes();
+	header->of_ver = pipeline->sw->of_ver;
+	header->num_of_tables = pipeline->num_of_tables;
+	header->group_select_hash = pipeline->groups->select_hash_fields;
+	header->miss_send_len = pipeline->miss_send_len;
+
+	__of1x_snapshot_put_meters(cur, pipeline->meters, &num_of_meters);
+	__of1x_snapshot_put_groups(cur, pipeline->groups, &num_of_groups);
+
+	for(i=0;i<pipeline->num_of_tables;i++)
+		__of1x_snapshot_put_table(cur, &pipeline->tables[i]);
+
+	//The header may have been overwritten in the scratch
+	if(cur->base && cur->size >= sizeof(*header)){
+		header = (of1x_snapshot_header_t*)cur->base;
+		header->num_of_meters = num_of_meters;
+		header->num_of_groups = num_of_groups;
+		header->size = cur->offset;
+	}
+}
+
+size_t of1x_snapshot_get_size(of1x_pipeline_t* pipeline){
+
+	of1x_snapshot_cursor_t cur;
+
+	memset(&cur, 0, sizeof(cur));
+	__of1x_snapshot_dump(pipeline, &cur);
+
+	return cur.offset;
+}
+
+rofl_result_t of1x_snapshot_save(of1x_pipeline_t* pipeline, void* buf, size_t size, size_t* used){
+
+	of1x_snapshot_cursor_t cur;
+
+	if(!buf)
+		return ROFL_FAILURE;
+
+	memset(&cur, 0, sizeof(cur));
+	cur.base = (uint8_t*)buf;
+	cur.size = size;
+
+	__of1x_snapshot_dump(pipeline, &cur);
+
+	if(cur.overflow){
+		ROFL_PIPELINE_ERR("[snapshot] Buffer too small (%zu bytes, %zu required)\n", size, cur.offset);
+		return ROFL_FAILURE;
+	}
+
+	if(used)
+		*used = cur.offset;
+
+	return ROFL_SUCCESS;
+}
+
+/*
+* Restore
+*/
+
+static rofl_result_t __of1x_snapshot_check_actions(of1x_snapshot_cursor_t* cur, uint32_t num_of_actions){
+
+	uint32_t i;
+	const of1x_snapshot_action_t* rec;
+
+	for(i=0;i<num_of_actions;i++){
+		if( (rec = __of1x_snapshot_get(cur, sizeof(*rec))) == NULL)
+			return ROFL_FAILURE;
+		if(rec->type == OF1X_AT_NO_ACTION || rec->type >= OF1X_AT_NUMBER)
+			return ROFL_FAILURE;
+	}
+
+	return ROFL_SUCCESS;
+}
+
+//Checks the layout of the image, before anything is modified
+static rofl_result_t __of1x_snapshot_check(of1x_pipeline_t* pipeline, const void* buf, size_t size){
+
+	uint32_t i, j, k;
+	of1x_snapshot_cursor_t cur;
+	const of1x_snapshot_header_t* header;
+	const of1x_snapshot_meter_t* meter;
+	const of1x_snapshot_group_t* group;
+	const of1x_snapshot_bucket_t* bucket;
+	const of1x_snapshot_table_t* table;
+	const of1x_snapshot_entry_t* entry;
+	const of1x_snapshot_match_t* match;
+	const of1x_snapshot_instruction_t* inst;
+
+	memset(&cur, 0, sizeof(cur));
+	cur.base = (uint8_t*)buf;
+	cur.size = size;
+
+	if( (header = __of1x_snapshot_get(&cur, sizeof(*header))) == NULL)
+		return ROFL_FAILURE;
+
+	if(header->magic != OF1X_SNAPSHOT_MAGIC || header->version != OF1X_SNAPSHOT_VERSION ||
+		header->record_sizes != __of1x_snapshot_record_sizes() || header->size > size){
+		ROFL_PIPELINE_ERR("[snapshot] Invalid or incompatible image\n");
+		return ROFL_FAILURE;
+	}
+
+	if(header->of_ver != pipeline->sw->of_ver || header->num_of_tables > pipeline->num_of_tables){
+		ROFL_PIPELINE_ERR("[snapshot] Image taken from a pipeline of another version or with more tables\n");
+		return ROFL_FAILURE;
+	}
+
+	cur.size = header->size;
+
+	for(i=0;i<header->num_of_meters;i++){
+		if( (meter = __of1x_snapshot_get(&cur, sizeof(*meter))) == NULL || meter->num_of_bands > OF1X_METER_MAX_BANDS)
+			return ROFL_FAILURE;
+	}
+
+	for(i=0;i<header->num_of_groups;i++){
+		if( (group = __of1x_snapshot_get(&cur, sizeof(*group))) == NULL || group->type > OF1X_GROUP_TYPE_FF)
+			return ROFL_FAILURE;
+		for(j=0;j<group->num_of_buckets;j++){
+			if( (bucket = __of1x_snapshot_get(&cur, sizeof(*bucket))) == NULL)
+				return ROFL_FAILURE;
+			if(__of1x_snapshot_check_actions(&cur, bucket->num_of_actions) != ROFL_SUCCESS)
+				return ROFL_FAILURE;
+		}
+	}
+
+	for(i=0;i<header->num_of_tables;i++){
+		if( (table = __of1x_snapshot_get(&cur, sizeof(*table))) == NULL || table->number != i)
+			return ROFL_FAILURE;
+
+		if(table->num_of_entries > pipeline->tables[i].max_entries){
+			ROFL_PIPELINE_ERR("[snapshot] Table %u cannot hold the %u entries of the image\n", i, table->num_of_entries);
+			return ROFL_FAILURE;
+		}
+
+		for(j=0;j<table->num_of_entries;j++){
+			if( (entry = __of1x_snapshot_get(&cur, sizeof(*entry))) == NULL)
+				return ROFL_FAILURE;
+
+			for(k=0;k<entry->num_of_matches;k++){
+				if( (match = __of1x_snapshot_get(&cur, sizeof(*match))) == NULL || match->type >= OF1X_MATCH_MAX)
+					return ROFL_FAILURE;
+			}
+
+			if(entry->num_of_instructions > OF1X_IT_MAX)
+				return ROFL_FAILURE;
+
+			for(k=0;k<entry->num_of_instructions;k++){
+				if( (inst = __of1x_snapshot_get(&cur, sizeof(*inst))) == NULL)
+					return ROFL_FAILURE;
+				if(inst->type == OF1X_IT_NO_INSTRUCTION || inst->type > OF1X_IT_MAX)
+					return ROFL_FAILURE;
+				if(inst->type == OF1X_IT_GOTO_TABLE && inst->go_to_table >= pipeline->num_of_tables)
+					return ROFL_FAILURE;
+				if(inst->num_of_actions && inst->type != OF1X_IT_APPLY_ACTIONS && inst->type != OF1X_IT_WRITE_ACTIONS)
+					return ROFL_FAILURE;
+				if(__of1x_snapshot_check_actions(&cur, inst->num_of_actions) != ROFL_SUCCESS)
+					return ROFL_FAILURE;
+			}
+		}
+	}
+
+	if(cur.offset != header->size)
+		return ROFL_FAILURE;
+
+	//Must be empty
+	if(pipeline->groups->num_of_entries || pipeline->meters->num_of_entries)
+		return ROFL_FAILURE;
+	for(i=0;i<pipeline->num_of_tables;i++){
+		if(pipeline->tables[i].num_of_entries)
+			return ROFL_FAILURE;
+	}
+
+	return ROFL_SUCCESS;
+}
+
+static rofl_result_t __of1x_snapshot_restore_meters(of1x_pipeline_t* pipeline, of1x_snapshot_cursor_t* cur, uint32_t num_of_meters){
+
+	uint32_t i, j;
+	of1x_meter_t* meter;
+	of1x_meter_band_config_t bands[OF1X_METER_MAX_BANDS];
+	const of1x_snapshot_meter_t* rec;
+
+	for(i=0;i<num_of_meters;i++){
+		rec = __of1x_snapshot_get(cur, sizeof(*rec));
+
+		for(j=0;j<rec->num_of_bands;j++){
+			bands[j].type = rec->bands[j].type;
+			bands[j].rate = rec->bands[j].rate;
+			bands[j].burst_size = rec->bands[j].burst_size;
+			bands[j].prec_level = rec->bands[j].prec_level;
+		}
+
+		if(of1x_meter_add(pipeline->meters, rec->id, rec->flags, bands, rec->num_of_bands) != ROFL_OF1X_MM_OK)
+			return ROFL_FAILURE;
+
+		//Counters (in the first core) and duration
+		platform_rwlock_rdlock(pipeline->meters->rwlock);
+		meter = __of1x_meter_search(pipeline->meters, rec->id);
+		if(meter){
+			meter->cores[0].packet_count = rec->packet_count;
+			meter->cores[0].byte_count = rec->byte_count;
+			meter->creation_time_us -= (rec->duration_us < meter->creation_time_us)? rec->duration_us : meter->creation_time_us;
+			for(j=0;j<rec->num_of_bands && j<meter->config->num_of_bands;j++){
+				meter->config->bands[j].packet_offset = rec->bands[j].packet_count;
+				meter->config->bands[j].byte_offset = rec->bands[j].byte_count;
+			}
+		}
+		platform_rwlock_rdunlock(pipeline->meters->rwlock);
+	}
+
+	return ROFL_SUCCESS;
+}
+
+static rofl_result_t __of1x_snapshot_restore_action_group(of1x_snapshot_cursor_t* cur, of1x_action_group_t* actions, uint32_t num_of_actions, of1x_group_table_t* gt){
+
+	uint32_t i;
+	of1x_packet_action_t* action;
+	const of1x_snapshot_action_t* rec;
+
+	for(i=0;i<num_of_actions;i++){
+		rec = __of1x_snapshot_get(cur, sizeof(*rec));
+
+		if( (action = of1x_init_packet_action(rec->type, rec->field, NULL, NULL)) == NULL)
+			return ROFL_FAILURE;
+		of1x_push_packet_action_to_group(actions, action);
+
+		if(gt && action->type == OF1X_AT_GROUP && (action->group = __of1x_group_search(gt, action->field.u32)) == NULL)
+			return ROFL_FAILURE;
+	}
+
+	return ROFL_SUCCESS;
+}
+
+static rofl_result_t __of1x_snapshot_restore_groups(of1x_pipeline_t* pipeline, of1x_snapshot_cursor_t* cur, uint32_t num_of_groups){
+
+	uint32_t i, j;
+	of1x_group_t* group;
+	of1x_bucket_t* bucket;
+	of1x_bucket_list_t* buckets;
+	of1x_action_group_t* actions;
+	const of1x_snapshot_group_t* rec;
+	const of1x_snapshot_bucket_t* bucket_rec;
+	const uint8_t* first_bucket;
+
+	for(i=0;i<num_of_groups;i++){
+		rec = __of1x_snapshot_get(cur, sizeof(*rec));
+		first_bucket = cur->base + cur->offset;
+
+		if( (buckets = of1x_init_bucket_list()) == NULL)
+			return ROFL_FAILURE;
+
+		for(j=0;j<rec->num_of_buckets;j++){
+			bucket_rec = __of1x_snapshot_get(cur, sizeof(*bucket_rec));
+
+			actions = of1x_init_action_group(NULL);
+			bucket = (actions)? of1x_init_bucket(bucket_rec->weight, bucket_rec->port, bucket_rec->group, actions) : NULL;
+			if(!bucket){
+				if(actions)
+					of1x_destroy_action_group(actions);
+				of1x_destroy_bucket_list(buckets);
+				return ROFL_FAILURE;
+			}
+			of1x_insert_bucket_in_list(buckets, bucket);
+
+			//Validated by of1x_group_add()
+			if(__of1x_snapshot_restore_action_group(cur, actions, bucket_rec->num_of_actions, NULL) != ROFL_SUCCESS){
+				of1x_destroy_bucket_list(buckets);
+				return ROFL_FAILURE;
+			}
+		}
+
+		if(of1x_group_add(pipeline->groups, rec->type, rec->id, buckets) != ROFL_OF1X_GM_OK){
+			of1x_destroy_bucket_list(buckets);
+			return ROFL_FAILURE;
+		}
+
+		//Counters
+		platform_rwlock_rdlock(pipeline->groups->rwlock);
+		group = __of1x_group_search(pipeline->groups, rec->id);
+		if(group){
+			__of1x_stats_group_add_counts(&group->stats, OF1X_STATS_GROUP_COLUMN, rec->packet_count, rec->byte_count);
+			bucket_rec = (const of1x_snapshot_bucket_t*)first_bucket;
+			for(bucket=group->bc_list->head; bucket; bucket=bucket->next){
+				__of1x_stats_group_add_counts(&group->stats, OF1X_STATS_BUCKET_COLUMN(bucket->index), bucket_rec->packet_count, bucket_rec->byte_count);
+				bucket_rec = (const of1x_snapshot_bucket_t*)((const uint8_t*)(bucket_rec+1) + bucket_rec->num_of_actions*sizeof(of1x_snapshot_action_t));
+			}
+		}
+		platform_rwlock_rdunlock(pipeline->groups->rwlock);
+	}
+
+	return ROFL_SUCCESS;
+}
+
+static rofl_result_t __of1x_snapshot_restore_instructions(of1x_pipeline_t* pipeline, of1x_snapshot_cursor_t* cur, of1x_flow_entry_t* entry, uint32_t num_of_instructions){
+
+	uint32_t i, j;
+	of1x_write_metadata_t metadata;
+	of1x_action_group_t* apply;
+	of1x_write_actions_t* write;
+	of1x_packet_action_t* action;
+	of1x_instruction_t* inst;
+	const of1x_snapshot_instruction_t* rec;
+	const of1x_snapshot_action_t* action_rec;
+
+	for(i=0;i<num_of_instructions;i++){
+		rec = __of1x_snapshot_get(cur, sizeof(*rec));
+		inst = &entry->inst_grp.instructions[OF1X_SAFE_IT_TYPE_INDEX(rec->type)];
+
+		switch(rec->type){
+			case OF1X_IT_APPLY_ACTIONS:
+				//Owned by the entry from now on
+				if( (apply = of1x_init_action_group(NULL)) == NULL)
+					return ROFL_FAILURE;
+				of1x_add_instruction_to_group(&entry->inst_grp, OF1X_IT_APPLY_ACTIONS, apply, NULL, NULL, 0);
+
+				if(__of1x_snapshot_restore_action_group(cur, apply, rec->num_of_actions, pipeline->groups) != ROFL_SUCCESS)
+					return ROFL_FAILURE;
+				apply->num_of_output_actions = rec->num_of_output_actions;
+				break;
+
+			case OF1X_IT_WRITE_ACTIONS:
+				if( (write = of1x_init_write_actions()) == NULL)
+					return ROFL_FAILURE;
+				of1x_add_instruction_to_group(&entry->inst_grp, OF1X_IT_WRITE_ACTIONS, NULL, write, NULL, 0);
+
+				for(j=0;j<rec->num_of_actions;j++){
+					action_rec = __of1x_snapshot_get(cur, sizeof(*action_rec));
+					if( (action = of1x_init_packet_action(action_rec->type, action_rec->field, NULL, NULL)) == NULL)
+						return ROFL_FAILURE;
+					if(action->type == OF1X_AT_GROUP && (action->group = __of1x_group_search(pipeline->groups, action->field.u32)) == NULL){
+						of1x_destroy_packet_action(action);
+						return ROFL_FAILURE;
+					}
+					of1x_set_packet_action_on_write_actions(write, action);
+					of1x_destroy_packet_action(action);
+				}
+				write->num_of_actions = rec->num_of_write_actions;
+				write->num_of_output_actions = rec->num_of_output_actions;
+				break;
+
+			case OF1X_IT_WRITE_METADATA:
+				metadata.metadata = rec->metadata;
+				metadata.metadata_mask = rec->metadata_mask;
+				of1x_add_instruction_to_group(&entry->inst_grp, OF1X_IT_WRITE_METADATA, NULL, NULL, &metadata, 0);
+				break;
+
+			case OF1X_IT_GOTO_TABLE:
+				of1x_add_instruction_to_group(&entry->inst_grp, OF1X_IT_GOTO_TABLE, NULL, NULL, NULL, rec->go_to_table);
+				break;
+
+			case OF1X_IT_METER:
+				of1x_add_meter_instruction_to_group(&entry->inst_grp, rec->meter_id);
+				if( (inst->meter = __of1x_meter_search(pipeline->meters, rec->meter_id)) == NULL)
+					return ROFL_FAILURE;
+				break;
+
+			default:
+				of1x_add_instruction_to_group(&entry->inst_grp, rec->type, NULL, NULL, NULL, 0);
+				break;
+		}
+	}
+
+	return ROFL_SUCCESS;
+}
+
+//Builds an entry from its record, as validated when it was installed
+static of1x_flow_entry_t* __of1x_snapshot_restore_entry(of1x_pipeline_t* pipeline, of1x_snapshot_cursor_t* cur, const struct timeval* now){
+
+	uint32_t i;
+	utern_t value;
+	of1x_match_t tmp, *match;
+	of1x_flow_entry_t* entry;
+	const of1x_snapshot_entry_t* rec;
+	const of1x_snapshot_match_t* match_rec;
+
+	rec = __of1x_snapshot_get(cur, sizeof(*rec));
+
+	if( (entry = of1x_init_flow_entry(NULL, NULL, rec->notify_removal)) == NULL)
+		return NULL;
+
+	entry->priority = rec->priority;
+	entry->cookie = rec->cookie;
+	entry->cookie_mask = rec->cookie_mask;
+	entry->importance = rec->importance;
+
+	//Matches are rebuilt with their initializers
+	memset(&tmp, 0, sizeof(tmp));
+	tmp.value = &value;
+	for(i=0;i<rec->num_of_matches;i++){
+		match_rec = __of1x_snapshot_get(cur, sizeof(*match_rec));
+		tmp.type = match_rec->type;
+		value.type = match_rec->utern_type;
+		value.value = match_rec->value;
+		value.mask = match_rec->mask;
+
+		if( (match = __of1x_copy_match(&tmp)) == NULL)
+			goto ENTRY_ERROR;
+		of1x_add_match_to_entry(entry, match);
+	}
+
+	if(__of1x_snapshot_restore_instructions(pipeline, cur, entry, rec->num_of_instructions) != ROFL_SUCCESS)
+		goto ENTRY_ERROR;
+	entry->inst_grp.num_of_outputs = rec->num_of_outputs;
+
+	//Timeouts and counters
+	__of1x_fill_new_timer_entry_info(entry, rec->hard_timeout, rec->idle_timeout);
+	if(rec->idle_timeout)
+		__of1x_snapshot_ms_before(now, rec->idle_ms, &entry->timer_info.time_last_update);
+	__of1x_snapshot_ms_before(now, rec->age_ms, &entry->stats.initial_time);
+	entry->stats.packet_count = rec->packet_count;
+	entry->stats.byte_count = rec->byte_count;
+
+	return entry;
+
+ENTRY_ERROR:
+	of1x_destroy_flow_entry(entry);
+	return NULL;
+}
+
+//Destroys a list of entries not (or no longer) in the table
+static void __of1x_snapshot_destroy_entries(of1x_flow_entry_t* head){
+
+	of1x_flow_entry_t *entry, *next;
+
+	for(entry=head; entry; entry=next){
+		next = entry->next;
+		entry->table = NULL;
+		of1x_destroy_flow_entry(entry);
+	}
+}
+
+//Installs the entries (in order) through the add hook; algorithms that cannot build their state at once
+static rofl_result_t __of1x_snapshot_add_entries(of1x_flow_table_t* table, of1x_flow_entry_t* head){
+
+	of1x_flow_entry_t *entry, *next;
+
+	platform_rwlock_rdlock(table->ma_rwlock);
+	for(entry=head; entry; entry=next){
+		next = entry->next;
+		entry->prev = entry->next = NULL;
+		if(of1x_matching_algorithms[table->matching_algorithm].add_flow_entry_hook(table, entry, false, false) != ROFL_OF1X_FM_SUCCESS){
+			platform_rwlock_rdunlock(table->ma_rwlock);
+			entry->next = next;
+			__of1x_snapshot_destroy_entries(entry);
+			return ROFL_FAILURE;
+		}
+	}
+	platform_rwlock_rdunlock(table->ma_rwlock);
+
+	return ROFL_SUCCESS;
+}
+
+//Links the entries (in order) and builds the matching algorithm state once
+static rofl_result_t __of1x_snapshot_link_entries(of1x_flow_table_t* table, of1x_flow_entry_t* head, unsigned int num_of_entries){
+
+	of1x_matching_algorithms_functions_t* ma;
+	matching_auxiliary_t* state;
+	of1x_flow_entry_t* entry;
+
+	ma = &of1x_matching_algorithms[table->matching_algorithm];
+	if(!ma->migrate_build_hook || !ma->migrate_release_hook)
+		return __of1x_snapshot_add_entries(table, head);
+
+	platform_rwlock_wrlock(table->ma_rwlock);
+	platform_mutex_lock(table->mutex);
+	platform_rwlock_wrlock(table->rwlock);
+
+	table->entries = head;
+	table->num_of_entries = num_of_entries;
+
+	table->matching_aux[1] = NULL;
+	if(ma->migrate_build_hook(table) != ROFL_SUCCESS){
+		table->entries = NULL;
+		table->num_of_entries = 0;
+		platform_rwlock_wrunlock(table->rwlock);
+		platform_mutex_unlock(table->mutex);
+		platform_rwlock_wrunlock(table->ma_rwlock);
+		__of1x_snapshot_destroy_entries(head);
+		return ROFL_FAILURE;
+	}
+
+	state = table->matching_aux[0];
+	table->matching_aux[0] = table->matching_aux[1];
+	table->matching_aux[1] = state;
+
+	platform_rwlock_wrunlock(table->rwlock);
+
+	//Release the (empty) state
+	ma->migrate_release_hook(table);
+	table->matching_aux[1] = NULL;
+
+	for(entry=head; entry; entry=entry->next){
+		__of1x_flow_table_recency_link(table, entry);
+		plaftorm_of1x_add_entry_hook(entry);
+	}
+
+	platform_mutex_unlock(table->mutex);
+	platform_rwlock_wrunlock(table->ma_rwlock);
+
+	return ROFL_SUCCESS;
+}
+
+static rofl_result_t __of1x_snapshot_restore_table(of1x_pipeline_t* pipeline, of1x_snapshot_cursor_t* cur){
+
+	uint32_t i;
+	uint64_t packets = 0, bytes = 0, count;
+	struct timeval now;
+	of1x_flow_table_t* table;
+	of1x_flow_entry_t *head = NULL, *tail = NULL, *entry;
+	const of1x_snapshot_table_t* rec;
+
+	rec = __of1x_snapshot_get(cur, sizeof(*rec));
+	table = &pipeline->tables[rec->number];
+
+	__of1x_gettimeofday(&now, NULL);
+
+	//Entries, out of the table
+	platform_rwlock_rdlock(pipeline->groups->rwlock);
+	platform_rwlock_rdlock(pipeline->meters->rwlock);
+	for(i=0;i<rec->num_of_entries;i++){
+		if( (entry = __of1x_snapshot_restore_entry(pipeline, cur, &now)) == NULL)
+			break;
+
+		entry->table = table;
+		entry->prev = tail;
+		if(tail)
+			tail->next = entry;
+		else
+			head = entry;
+		tail = entry;
+
+		packets += entry->stats.packet_count;
+		bytes += entry->stats.byte_count;
+	}
+	platform_rwlock_rdunlock(pipeline->meters->rwlock);
+	platform_rwlock_rdunlock(pipeline->groups->rwlock);
+
+	if(i < rec->num_of_entries)
+		__of1x_snapshot_destroy_entries(head);
+
+	//The entries are released on failure
+	if(i < rec->num_of_entries || __of1x_snapshot_link_entries(table, head, rec->num_of_entries) != ROFL_SUCCESS){
+		ROFL_PIPELINE_ERR("[snapshot] Unable to restore the entries of table %u\n", table->number);
+		return ROFL_FAILURE;
+	}
+
+	//Timers
+	platform_mutex_lock(table->mutex);
+	for(entry=table->entries; entry; entry=entry->next){
+		if(entry->timer_info.hard_timeout || entry->timer_info.idle_timeout)
+			__of1x_add_timer_elapsed(table, entry, __of1x_snapshot_ms_since(&now, &entry->stats.initial_time)/1000,
+					__of1x_snapshot_ms_since(&now, &entry->timer_info.time_last_update)/1000);
+	}
+	platform_mutex_unlock(table->mutex);
+
+	//Counters
+	__of1x_stats_table_add_flow_counts(table, packets, bytes);
+	count = rec->lookup_count;
+	platform_atomic_add64(&table->stats.lookup_count, &count, table->stats.mutex);
+	count = rec->matched_count;
+	platform_atomic_add64(&table->stats.matched_count, &count, table->stats.mutex);
+	table->default_action = rec->default_action;
+
+	return ROFL_SUCCESS;
+}
+
+rofl_result_t of1x_snapshot_restore(of1x_pipeline_t* pipeline, const void* buf, size_t size){
+
+	uint32_t i;
+	of1x_snapshot_cursor_t cur;
+	const of1x_snapshot_header_t* header;
+
+	if(!buf || __of1x_snapshot_check(pipeline, buf, size) != ROFL_SUCCESS){
+		ROFL_PIPELINE_ERR("[snapshot] Unable to restore; invalid image or pipeline not empty\n");
+		return ROFL_FAILURE;
+	}
+
+	memset(&cur, 0, sizeof(cur));
+	cur.base = (uint8_t*)buf;
+	cur.size = ((const of1x_snapshot_header_t*)buf)->size;
+	header = __of1x_snapshot_get(&cur, sizeof(*header));
+
+	pipeline->miss_send_len = header->miss_send_len;
+	of1x_set_group_table_select_hash(pipeline->groups, header->group_select_hash);
+
+	//Meters and groups first; entries refer to them
+	if(__of1x_snapshot_restore_meters(pipeline, &cur, header->num_of_meters) != ROFL_SUCCESS ||
+		__of1x_snapshot_restore_groups(pipeline, &cur, header->num_of_groups) != ROFL_SUCCESS){
+		ROFL_PIPELINE_ERR("[snapshot] Unable to restore the groups and meters\n");
+		return ROFL_FAILURE;
+	}
+
+	for(i=0;i<header->num_of_tables;i++){
+		if(__of1x_snapshot_restore_table(pipeline, &cur) != ROFL_SUCCESS)
+			return ROFL_FAILURE;
+	}
+
+	return ROFL_SUCCESS;
+}
@@ -0,0 +1,193 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef __OF1X_SNAPSHOT_H__
+#define __OF1X_SNAPSHOT_H__
+
+#include <stddef.h>
+#include <inttypes.h>
+#include "rofl.h"
+#include "../../../common/wrap_types.h"
+#include "of1x_meter_table.h"
+
+/**
+* @file of1x_snapshot.h
+* @brief Pipeline snapshots (warm restart)
+*
+* A snapshot is a flat image of the state of a pipeline: flow entries
+* (matches, instructions, timeouts and counters), groups, meters, table
+* counters and table-miss configuration. It contains no pointers, so that
+* platforms can write it to a file and map it back (mmap) after a restart.
+*
+* Restoring a snapshot bulk-loads the tables: entries are linked in the
+* saved order and the matching algorithm state is built once per table,
+* without the per-entry flow_mod validation, overlap checks or sorting.
+* Timeouts continue from the time elapsed when the snapshot was taken.
+*
+* Snapshots are only meant to be restored by the same build of the library
+* (same host); the header carries a format version and the record sizes.
+*/
+
+//'OFXS'
+#define OF1X_SNAPSHOT_MAGIC 0x4F465853
+#define OF1X_SNAPSHOT_VERSION 1
+
+/*
+* Image layout. All the records are multiple of 8 bytes, in this order:
+*
+*  header
+*  meter[num_of_meters]
+*  group[num_of_groups], each one followed by its buckets; each bucket by its actions
+*  table[num_of_tables], each one followed by its entries; each entry by its
+*  matches and instructions; each instruction by its actions
+*/
+
+/**
+* Snapshot header
+*/
+typedef struct of1x_snapshot_header{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t record_sizes;		//Checksum of the record sizes (format sanity)
+	uint32_t of_ver;
+	uint64_t size;			//Image size, header included
+	uint32_t num_of_tables;
+	uint32_t num_of_groups;
+	uint32_t num_of_meters;
+	uint32_t group_select_hash;
+	uint32_t miss_send_len;
+	uint32_t __pad;
+}of1x_snapshot_header_t;
+
+typedef struct of1x_snapshot_meter_band{
+	uint32_t type;
+	uint32_t rate;
+	uint32_t burst_size;
+	uint32_t prec_level;
+	uint64_t packet_count;
+	uint64_t byte_count;
+}of1x_snapshot_meter_band_t;
+
+typedef struct of1x_snapshot_meter{
+	uint32_t id;
+	uint32_t flags;
+	uint32_t num_of_bands;
+	uint32_t __pad;
+	uint64_t packet_count;
+	uint64_t byte_count;
+	uint64_t duration_us;
+	of1x_snapshot_meter_band_t bands[OF1X_METER_MAX_BANDS];
+}of1x_snapshot_meter_t;
+
+typedef struct of1x_snapshot_group{
+	uint32_t id;
+	uint32_t type;
+	uint32_t num_of_buckets;
+	uint32_t __pad;
+	uint64_t packet_count;
+	uint64_t byte_count;
+}of1x_snapshot_group_t;
+
+typedef struct of1x_snapshot_bucket{
+	uint32_t weight;
+	uint32_t port;
+	uint32_t group;
+	uint32_t num_of_actions;
+	uint64_t packet_count;
+	uint64_t byte_count;
+}of1x_snapshot_bucket_t;
+
+typedef struct of1x_snapshot_action{
+	uint32_t type;
+	uint32_t __pad;
+	wrap_uint_t field;
+}of1x_snapshot_action_t;
+
+typedef struct of1x_snapshot_table{
+	uint32_t number;
+	uint32_t num_of_entries;
+	uint32_t default_action;
+	uint32_t __pad;
+	uint64_t lookup_count;
+	uint64_t matched_count;
+}of1x_snapshot_table_t;
+
+typedef struct of1x_snapshot_entry{
+	uint32_t priority;		//OF1.0 wildcard flag included
+	uint32_t num_of_matches;
+	uint32_t num_of_instructions;
+	uint32_t num_of_outputs;
+	uint64_t cookie;
+	uint64_t cookie_mask;
+	uint32_t hard_timeout;
+	uint32_t idle_timeout;
+	uint64_t age_ms;		//Since the entry was installed
+	uint64_t idle_ms;		//Since the last hit (idle timeout only)
+	uint64_t packet_count;
+	uint64_t byte_count;
+	uint32_t notify_removal;
+	uint32_t importance;
+}of1x_snapshot_entry_t;
+
+typedef struct of1x_snapshot_match{
+	uint32_t type;
+	uint32_t utern_type;
+	wrap_uint_t value;
+	wrap_uint_t mask;
+}of1x_snapshot_match_t;
+
+typedef struct of1x_snapshot_instruction{
+	uint32_t type;
+	uint32_t go_to_table;
+	uint32_t meter_id;
+	uint32_t num_of_actions;	//APPLY_ACTIONS (in order) and WRITE_ACTIONS
+	uint32_t num_of_output_actions;
+	uint32_t num_of_write_actions;	//of1x_write_actions_t num_of_actions
+	uint64_t metadata;
+	uint64_t metadata_mask;
+}of1x_snapshot_instruction_t;
+
+//Fwd declarations
+struct of1x_pipeline;
+
+//C++ extern C
+ROFL_BEGIN_DECLS
+
+/**
+* @ingroup core_of1x
+* Size of the snapshot of the pipeline, as of now. Flow mods processed
+* before of1x_snapshot_save() may change it.
+*/
+size_t of1x_snapshot_get_size(struct of1x_pipeline* pipeline);
+
+/**
+* @ingroup core_of1x
+* Takes a snapshot of the pipeline into buf. Each table is snapshotted
+* atomically (w.r.t. flow mods and expirations); counters are read while
+* packets are being processed.
+*
+* @param size of buf
+* @param used bytes written (optional)
+* @return ROFL_FAILURE if buf is too small
+*/
+rofl_result_t of1x_snapshot_save(struct of1x_pipeline* pipeline, void* buf, size_t size, size_t* used);
+
+/**
+* @ingroup core_of1x
+* Restores a snapshot into a pipeline with no entries, groups or meters,
+* of the same OpenFlow version and with at least as many tables. Table
+* capacities (of1x_set_table_capacity()) are not part of the snapshot; tables
+* with fewer max_entries than the entries saved are not restored.
+*
+* The image layout is checked before the pipeline is modified. If the
+* restore fails afterwards (out of memory, or entries referring to groups or
+* meters not in the image) the pipeline may be left partially restored, and
+* must then be purged.
+*/
+rofl_result_t of1x_snapshot_restore(struct of1x_pipeline* pipeline, const void* buf, size_t size);
+
+//C++ extern C
+ROFL_END_DECLS
+
+#endif //OF1X_SNAPSHOT
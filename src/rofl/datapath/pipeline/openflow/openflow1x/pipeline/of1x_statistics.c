@@ -1,6 +1,7 @@
 #include "of1x_statistics.h"
 
 #include <assert.h> 
+#include <string.h>
 #include "of1x_pipeline.h"
 #include "of1x_flow_table.h"
 #include "of1x_flow_entry.h"
@@ -9,6 +10,8 @@
 #include "of1x_group_table.h"
 #include "../../../platform/memory.h"
 #include "../../../platform/atomic_operations.h"
+#include "../../../platform/cutil.h"
+#include "../../../common/per_core.h"
 #include "../../../util/time.h"
 
 /**
@@ -89,6 +92,23 @@ of1x_stats_single_flow_msg_t* __of1x_init_stats_single_flow_msg(of1x_flow_entry_
 		return NULL;
 	}
 
+	//Reference the matches (immutable once installed); the entry stats
+	//mutex serializes concurrent stats requests over the same entry
+	msg->matches = NULL;
+	msg->match_snapshot = NULL;
+	if(entry->matches.head){
+		platform_mutex_lock(entry->stats.mutex);
+		msg->match_snapshot = __of1x_get_match_snapshot(&entry->matches);
+		platform_mutex_unlock(entry->stats.mutex);
+
+		if(!msg->match_snapshot){
+			platform_free_shared(msg->inst_grp);
+			platform_free_shared(msg);
+			return NULL;
+		}
+		msg->matches = msg->match_snapshot->head;
+	}
+
 	//Fill static values
 	if(entry->table)
 		msg->table_id = entry->table->number;
@@ -102,32 +122,28 @@ of1x_stats_single_flow_msg_t* __of1x_init_stats_single_flow_msg(of1x_flow_entry_
 	//Get durations
 	of1x_stats_flow_get_duration(entry, &msg->duration_sec, &msg->duration_nsec);
 
-	//Copy matches
-	//TODO: deprecate this in favour of group_matches
-	msg->matches = __of1x_copy_matches(entry->matches.head);
-	
-	//Copy instructions
-	__of1x_copy_instruction_group(&entry->inst_grp,msg->inst_grp);
+	//Copy instructions (they can be modified)
+	if(__of1x_copy_instruction_group(&entry->inst_grp,msg->inst_grp) != ROFL_SUCCESS){
+		if(msg->match_snapshot)
+			__of1x_release_match_snapshot(msg->match_snapshot);
+		platform_free_shared(msg->inst_grp);
+		platform_free_shared(msg);
+		return NULL;
+	}
 
 	return msg;
 }
 void __of1x_destroy_stats_single_flow_msg(of1x_stats_single_flow_msg_t* msg){
 
-	of1x_match_t* match;
-
 	if(!msg)
 		return;
 
-	//TODO: deprecate this in favour of group_matches
-	match = msg->matches;
-	while(match){
-		of1x_match_t *next = match->next;
-		of1x_destroy_match(match);
-		match = next;
-	}
+	//Drop the reference to the matches
+	if(msg->match_snapshot)
+		__of1x_release_match_snapshot(msg->match_snapshot);
 
 	//Destroy instructions
-	__of1x_destroy_instruction_group(msg->inst_grp);
+	__of1x_destroy_instruction_group(msg->inst_grp, NULL);
 	
 	
 	platform_free_shared(msg->inst_grp);
@@ -181,6 +197,8 @@ void __of1x_push_single_flow_stats_to_msg(of1x_stats_flow_msg_t* msg, of1x_stats
 void __of1x_stats_flow_reset_counts(of1x_flow_entry_t * entry){
 
 	platform_mutex_lock(entry->stats.mutex);
+	if(entry->table)
+		__of1x_stats_table_sub_flow_counts(entry->table, entry->stats.packet_count, entry->stats.byte_count);
 	entry->stats.packet_count = entry->stats.byte_count =  0;
 	platform_mutex_unlock(entry->stats.mutex);
 }
@@ -205,8 +223,18 @@ void of1x_stats_flow_get_duration(struct of1x_flow_entry * entry, uint32_t* sec,
  * input arguments: bytes_rx, flow_entry
  */
 void __of1x_stats_flow_update_match(of1x_flow_entry_t * entry,uint64_t bytes_rx){
+	unsigned int core_id;
+	of1x_stats_table_core_t* cores;
+
 	platform_atomic_inc64(&entry->stats.packet_count,entry->stats.mutex);
 	platform_atomic_add64(&entry->stats.byte_count,&bytes_rx, entry->stats.mutex);
+
+	//Table aggregates
+	if(entry->table && (cores = entry->table->stats.cores)){
+		core_id = __per_core_id();
+		cores[core_id].packet_count++;
+		cores[core_id].byte_count += bytes_rx;
+	}
 }
 
 //Table Statistics functions
@@ -218,6 +246,12 @@ void __of1x_stats_table_init(of1x_flow_table_t * table){
 	table->stats.lookup_count = 0;
 	table->stats.matched_count = 0;
 
+	//Flow aggregates; if they cannot be allocated, aggregate stats are
+	//calculated walking the table
+	table->stats.flow_packet_offset = 0;
+	table->stats.flow_byte_offset = 0;
+	table->stats.cores = (of1x_stats_table_core_t*)__per_core_alloc(sizeof(of1x_stats_table_core_t));
+
 	//Stats mutex	
 	table->stats.mutex = platform_mutex_init(NULL);
 }
@@ -227,8 +261,55 @@ void __of1x_stats_table_init(of1x_flow_table_t * table){
  */
 void __of1x_stats_table_destroy(of1x_flow_table_t * table){
 
+	__per_core_free(table->stats.cores);
 	platform_mutex_destroy(table->stats.mutex);
 }
+
+/**
+ * Adjusts the table flow aggregates (entries inserted with counters)
+ */
+void __of1x_stats_table_add_flow_counts(of1x_flow_table_t * table, uint64_t packets, uint64_t bytes){
+
+	platform_atomic_add64(&table->stats.flow_packet_offset, &packets, table->stats.mutex);
+	platform_atomic_add64(&table->stats.flow_byte_offset, &bytes, table->stats.mutex);
+}
+
+/**
+ * Adjusts the table flow aggregates (entries removed or reset)
+ */
+void __of1x_stats_table_sub_flow_counts(of1x_flow_table_t * table, uint64_t packets, uint64_t bytes){
+
+	//Modular arithmetic
+	packets = -packets;
+	bytes = -bytes;
+	__of1x_stats_table_add_flow_counts(table, packets, bytes);
+}
+
+/**
+ * Adds the flow aggregates of the table to msg. Returns false if they are not maintained
+ */
+bool __of1x_stats_table_get_flow_aggregate(of1x_flow_table_t * table, of1x_stats_flow_aggregate_msg_t* msg){
+
+	unsigned int i;
+	uint64_t packets, bytes;
+
+	if(!table->stats.cores)
+		return false;
+
+	packets = table->stats.flow_packet_offset;
+	bytes = table->stats.flow_byte_offset;
+	for(i=0;i<ROFL_PIPELINE_MAX_CORES;i++){
+		packets += table->stats.cores[i].packet_count;
+		bytes += table->stats.cores[i].byte_count;
+	}
+
+	msg->packet_count += packets;
+	msg->byte_count += bytes;
+	msg->flow_count += table->num_of_entries;
+
+	return true;
+}
+
 //NOTE this functions add too much overhead!
 /**
  * of1x_stats_table_lookup_update
@@ -319,21 +400,74 @@ void of1x_stats_queue_tx_errors_inc(of1x_stats_queue_t *queue_stats)
 }
 #endif
 
-void __of1x_init_group_stats(of1x_stats_group_t *group_stats){
-	//NOTE bucket stats are initialized when the group is created, before being attached to the list
+//Counters of a core row (the group and its buckets), rounded up to whole cache lines
+static unsigned int __of1x_stats_group_row_len(unsigned int num_of_buckets){
+	unsigned int per_line = ROFL_PIPELINE_CACHE_LINE_SIZE/sizeof(of1x_stats_counter_t);
+
+	return (OF1X_STATS_BUCKET_COLUMN(num_of_buckets) + per_line-1)/per_line*per_line;
+}
+
+rofl_result_t __of1x_init_group_stats(of1x_stats_group_t *group_stats, unsigned int num_of_buckets){
+
+	group_stats->row_len = __of1x_stats_group_row_len(num_of_buckets);
+	group_stats->cores = (of1x_stats_counter_t*)__per_core_alloc(sizeof(of1x_stats_counter_t)*group_stats->row_len);
+	if(!group_stats->cores)
+		return ROFL_FAILURE;
+
 	group_stats->mutex = platform_mutex_init(NULL);
-	group_stats->byte_count = 0;
-	group_stats->packet_count = 0;
 	group_stats->ref_count = 0;
+	return ROFL_SUCCESS;
 }
 
 void __of1x_destroy_group_stats(of1x_stats_group_t* group_stats){
+	__per_core_free(group_stats->cores);
 	platform_mutex_destroy(group_stats->mutex);
 }
 
-void __of1x_stats_group_update(of1x_stats_group_t *gr_stats, uint64_t bytes){
-	platform_atomic_inc64(&gr_stats->packet_count, gr_stats->mutex);
-	platform_atomic_add64(&gr_stats->byte_count, &bytes, gr_stats->mutex);
+/**
+ * Resizes the counters to a new bucket list (group write lock held). The group
+ * counters are kept; the ones of the new buckets start from 0
+ */
+rofl_result_t __of1x_stats_group_reset_buckets(of1x_stats_group_t *group_stats, unsigned int num_of_buckets){
+
+	unsigned int i, row_len = __of1x_stats_group_row_len(num_of_buckets);
+	of1x_stats_counter_t* cores;
+
+	cores = (of1x_stats_counter_t*)__per_core_alloc(sizeof(of1x_stats_counter_t)*row_len);
+	if(!cores)
+		return ROFL_FAILURE;
+
+	for(i=0;i<ROFL_PIPELINE_MAX_CORES;i++)
+		cores[i*row_len + OF1X_STATS_GROUP_COLUMN] = *__of1x_stats_group_row(group_stats, i);
+
+	__per_core_free(group_stats->cores);
+	group_stats->cores = cores;
+	group_stats->row_len = row_len;
+	return ROFL_SUCCESS;
+}
+
+/**
+ * Sums the counters of a column (group or bucket) over all the cores
+ */
+void __of1x_stats_group_get_counts(const of1x_stats_group_t *gr_stats, unsigned int column, uint64_t* packets, uint64_t* bytes){
+
+	unsigned int i;
+	const of1x_stats_counter_t* counter;
+
+	*packets = *bytes = 0;
+	for(i=0;i<ROFL_PIPELINE_MAX_CORES;i++){
+		counter = &gr_stats->cores[i*gr_stats->row_len + column];
+		*packets += counter->packet_count;
+		*bytes += counter->byte_count;
+	}
+}
+
+/**
+ * Adds counts to a column (snapshot restore, no packets going through the group)
+ */
+void __of1x_stats_group_add_counts(of1x_stats_group_t *gr_stats, unsigned int column, uint64_t packets, uint64_t bytes){
+	gr_stats->cores[column].packet_count += packets;
+	gr_stats->cores[column].byte_count += bytes;
 }
 
 void __of1x_stats_group_inc_reference(of1x_stats_group_t *gr_stats){
@@ -373,26 +507,32 @@ void of1x_destroy_stats_group_msg(of1x_stats_group_msg_t* msg){
 
 of1x_stats_group_msg_t* of1x_get_group_stats(of1x_pipeline_t* pipeline,uint32_t id){
 	of1x_bucket_t *bu_it;
+	of1x_stats_group_msg_t* msg;
 	
 	//find the group
 	of1x_group_t* group = __of1x_group_search(pipeline->groups, id);
 	if(group == NULL) return NULL;
 	
-	of1x_stats_group_msg_t* msg = __of1x_init_stats_group_msg(group->bc_list->num_of_buckets);
+	platform_rwlock_rdlock(group->rwlock);
+
+	msg = __of1x_init_stats_group_msg(group->bc_list->num_of_buckets);
+	if(!msg){
+		platform_rwlock_rdunlock(group->rwlock);
+		return NULL;
+	}
 
 	msg->group_id = id;
 	msg->ref_count = group->stats.ref_count;
-	msg->packet_count = group->stats.packet_count;
-	msg->byte_count = group->stats.packet_count;
+	__of1x_stats_group_get_counts(&group->stats, OF1X_STATS_GROUP_COLUMN, &msg->packet_count, &msg->byte_count);
 	msg->num_of_buckets = group->bc_list->num_of_buckets;
 	msg->next = NULL;
 	
 	//collect statistics from buckets
 	int i=0;
-	for(bu_it=group->bc_list->head;bu_it;bu_it=bu_it->next,i++){
-		msg->bucket_stats[i].byte_count = bu_it->stats.byte_count;
-		msg->bucket_stats[i].packet_count = bu_it->stats.packet_count;
-	}
+	for(bu_it=group->bc_list->head;bu_it;bu_it=bu_it->next,i++)
+		__of1x_stats_group_get_counts(&group->stats, OF1X_STATS_BUCKET_COLUMN(bu_it->index), &msg->bucket_stats[i].packet_count, &msg->bucket_stats[i].byte_count);
+
+	platform_rwlock_rdunlock(group->rwlock);
 	return msg;
 }
 
@@ -413,21 +553,6 @@ of1x_stats_group_msg_t* of1x_get_group_all_stats(of1x_pipeline_t* pipeline,uint3
 	return head;
 }
 
-void __of1x_init_bucket_stats(of1x_stats_bucket_counter_t *bc_stats){
-	bc_stats->mutex = platform_mutex_init(NULL);
-	bc_stats->byte_count = 0;
-	bc_stats->packet_count = 0;
-}
-
-void __of1x_destroy_buckets_stats(of1x_stats_bucket_counter_t *bc_stats){
-	platform_mutex_destroy(bc_stats->mutex);
-}
-
-void __of1x_stats_bucket_update(of1x_stats_bucket_counter_t* bc_stats, uint64_t bytes){
-	platform_atomic_inc64(&bc_stats->packet_count, bc_stats->mutex);
-	platform_atomic_add64(&bc_stats->byte_count, &bytes, bc_stats->mutex);
-}
-
 /*
 * External interfaces
 */
@@ -464,10 +589,81 @@ of1x_stats_flow_msg_t* of1x_get_flow_stats(struct of1x_pipeline* pipeline, uint8
 	
 	return msg;
 }
+rofl_result_t of1x_init_stats_flow_cursor(struct of1x_pipeline* pipeline, of1x_stats_flow_cursor_t* cursor, uint8_t table_id, uint32_t cookie, uint32_t cookie_mask, uint32_t out_port, uint32_t out_group, struct of1x_match_group *const matches){
+
+	//Verify table_id
+	if(table_id >= pipeline->num_of_tables && table_id != OF1X_FLOW_TABLE_ALL)
+		return ROFL_FAILURE;
+
+	memset(cursor, 0, sizeof(of1x_stats_flow_cursor_t));
+	cursor->cookie = cookie;
+	cursor->cookie_mask = cookie_mask;
+	cursor->out_port = out_port;
+	cursor->out_group = out_group;
+	cursor->matches = matches;
+
+	//Set the tables to go through
+	if(table_id == OF1X_FLOW_TABLE_ALL){
+		cursor->table_id = 0;
+		cursor->tid_end = pipeline->num_of_tables;
+	}else{
+		cursor->table_id = table_id;
+		cursor->tid_end = table_id+1; 
+	}
+
+	return ROFL_SUCCESS;
+}
+
+of1x_stats_flow_msg_t* of1x_get_flow_stats_chunk(struct of1x_pipeline* pipeline, of1x_stats_flow_cursor_t* cursor, unsigned int max_entries){
+
+	rofl_result_t result;
+	of1x_flow_table_t* table;
+	of1x_stats_flow_msg_t* msg;
+
+	if(!max_entries)
+		return NULL;
+
+	//Create the message 
+	msg = __of1x_init_stats_flow_msg();
+	if(!msg)
+		return NULL;
+
+	while(!cursor->done && msg->num_of_entries < max_entries){
+		table = &pipeline->tables[cursor->table_id];
+
+		if(of1x_matching_algorithms[table->matching_algorithm].get_flow_stats_chunk_hook){
+			result = of1x_matching_algorithms[table->matching_algorithm].get_flow_stats_chunk_hook(table, cursor, max_entries - msg->num_of_entries, msg);
+		}else{
+			//The whole table at once
+			result = of1x_matching_algorithms[table->matching_algorithm].get_flow_stats_hook(table, cursor->cookie, cursor->cookie_mask, cursor->out_port, cursor->out_group, cursor->matches, msg);
+			cursor->table_done = true;
+		}
+
+		if(result != ROFL_SUCCESS){
+			of1x_destroy_stats_flow_msg(msg);
+			return NULL;
+		}
+
+		//Next table
+		if(cursor->table_done){
+			cursor->table_id++;
+			cursor->last = NULL;
+			cursor->last_version = 0;
+			cursor->position = 0;
+			cursor->table_done = false;
+			cursor->done = (cursor->table_id >= cursor->tid_end);
+		}
+	}
+
+	return msg;
+}
+
 of1x_stats_flow_aggregate_msg_t* of1x_get_flow_aggregate_stats(struct of1x_pipeline* pipeline, uint8_t table_id, uint32_t cookie, uint32_t cookie_mask, uint32_t out_port, uint32_t out_group, struct of1x_match_group *const matches){
 	
 	uint32_t i, tid_start, tid_end;	
 	of1x_stats_flow_aggregate_msg_t* msg;
+	of1x_flow_table_t* table;
+	bool unfiltered;
 
 	//Verify table_id
 	if(table_id >= pipeline->num_of_tables && table_id != OF1X_FLOW_TABLE_ALL)
@@ -488,8 +684,16 @@ of1x_stats_flow_aggregate_msg_t* of1x_get_flow_aggregate_stats(struct of1x_pipel
 		tid_end = table_id+1; 
 	}
 
+	//Requests without filters are answered from the table aggregates
+	unfiltered = !cookie_mask && out_port == OF1X_PORT_ANY && out_group == OF1X_GROUP_ANY && (!matches || !matches->head);
+
 	for(i=tid_start;i<tid_end;i++){
-		if(of1x_matching_algorithms[pipeline->tables[i].matching_algorithm].get_flow_aggregate_stats_hook(&pipeline->tables[i], cookie, cookie_mask, out_port, out_group, matches, msg) != ROFL_SUCCESS){
+		table = &pipeline->tables[i];
+
+		if(unfiltered && __of1x_stats_table_get_flow_aggregate(table, msg))
+			continue;
+
+		if(of1x_matching_algorithms[table->matching_algorithm].get_flow_aggregate_stats_hook(table, cookie, cookie_mask, out_port, out_group, matches, msg) != ROFL_SUCCESS){
 			of1x_destroy_stats_flow_aggregate_msg(msg);
 			return NULL;
 		} 
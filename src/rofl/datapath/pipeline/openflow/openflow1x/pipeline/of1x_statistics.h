@@ -6,12 +6,16 @@
 #define __OF1X_STATISTICS_H__
 
 #include <inttypes.h>
+#include <stdbool.h>
 #include <sys/time.h>
 #include "rofl.h"
 #include "../../../platform/lock.h"
 
 #define OF1X_STATS_NS_IN_A_SEC 1000000000
 
+//Max number of entries visited by a flow stats cursor per table lock acquisition
+#define OF1X_STATS_FLOW_CURSOR_MAX_VISITS 256
+
 /**
 * @file of1x_statistics.h
 * @author Victor Alvarez<victor.alvarez (at) bisdn.de>, Marc Sune<marc.sune (at) bisdn.de>
@@ -33,6 +37,7 @@ struct of1x_flow_entry;
 struct of1x_flow_table;
 struct of1x_match;
 struct of1x_match_group;
+struct of1x_match_snapshot;
 struct of1x_pipeline;
 
 
@@ -65,10 +70,14 @@ typedef struct of1x_stats_single_flow_msg{
 	uint64_t packet_count;
 	uint64_t byte_count;
 	
+	//Matches of the entry (read-only; shared with the entry)
 	struct of1x_match* matches;
 	struct of1x_instruction_group* inst_grp;
 	
 	struct of1x_stats_single_flow_msg* next;
+
+	//Reference to the matches
+	struct of1x_match_snapshot* match_snapshot;
 }of1x_stats_single_flow_msg_t;
 
 /**
@@ -81,6 +90,33 @@ typedef struct of1x_stats_flow_msg{
 	of1x_stats_single_flow_msg_t* 	flows_tail;
 }of1x_stats_flow_msg_t;
 
+/**
+* @ingroup core_of1x 
+* Flow stats cursor. Allows to retrieve the flow stats in bounded chunks (see
+* of1x_get_flow_stats_chunk()), instead of a single message with all the flows.
+*
+* The table lock is only held while visiting OF1X_STATS_FLOW_CURSOR_MAX_VISITS
+* entries. Like OpenFlow multipart replies, the result is not atomic: entries
+* added or removed between chunks may be reported or not.
+*/
+typedef struct of1x_stats_flow_cursor{
+	//Request
+	uint64_t cookie;
+	uint64_t cookie_mask;
+	uint32_t out_port;
+	uint32_t out_group;
+	struct of1x_match_group* matches; /* Must be kept by the caller until the cursor is done */
+	uint32_t tid_end;
+
+	//Position
+	uint32_t table_id;
+	struct of1x_flow_entry* last;	/* Last entry visited */
+	uint64_t last_version;		/* Table entries_version when last was visited */
+	uint64_t position;		/* Entries visited in the current table */
+	bool table_done;
+	bool done;
+}of1x_stats_flow_cursor_t;
+
 /**
 * @ingroup core_of1x 
 * Aggregated flow stats message 
@@ -91,10 +127,28 @@ typedef struct of1x_stats_flow_aggregate_msg{
 	uint32_t flow_count;
 }of1x_stats_flow_aggregate_msg_t;
 
+//Per-core share of the flow counters of a table; one cache line per core
+//(cache aligned array, see per_core.h)
+typedef struct of1x_stats_table_core{
+	uint64_t packet_count;
+	uint64_t byte_count;
+	uint64_t __pad[6];
+}of1x_stats_table_core_t;
+
 //Table stats (table state)
 typedef struct of1x_stats_table{
 	uint64_t lookup_count; /* Number of packets looked up in table. */
 	uint64_t matched_count; /* Number of packets that hit table. */
+
+	/*
+	* Sum of the counters of the entries in the table, maintained incrementally:
+	* sum(cores) + offset. Packets are accounted in the shard of the core
+	* (ROFL_PIPELINE_MAX_CORES); the offset compensates entries removed, reset
+	* or inserted with inherited counters.
+	*/
+	of1x_stats_table_core_t* cores;
+	uint64_t flow_packet_offset;
+	uint64_t flow_byte_offset;
 	
 	platform_mutex_t* mutex; //Mutual exclusion only for stats
 }of1x_stats_table_t;
@@ -139,12 +193,25 @@ typedef struct of1x_stats_bucket_counter{
 	platform_mutex_t* mutex;
 }of1x_stats_bucket_counter_t;
 
+//Group and bucket counters (per core)
+typedef struct of1x_stats_counter{
+	uint64_t packet_count;
+	uint64_t byte_count;
+}of1x_stats_counter_t;
+
+//Columns of a core row: the group counters, then the ones of each bucket (index)
+#define OF1X_STATS_GROUP_COLUMN 0
+#define OF1X_STATS_BUCKET_COLUMN(index) ((index)+1)
+
 //Group stats
 typedef struct of1x_stats_group{
 	uint32_t ref_count;
-	uint64_t packet_count;
-	uint64_t byte_count;
-	struct of1x_stats_bucket_counter bucket_stats[0];
+
+	//ROFL_PIPELINE_MAX_CORES rows of row_len counters (cache aligned, see per_core.h).
+	//Only the core owning the row updates it; readers sum all the rows
+	of1x_stats_counter_t* cores;
+	unsigned int row_len;
+
 	platform_mutex_t* mutex;
 }of1x_stats_group_t;
 
@@ -198,12 +265,20 @@ void __of1x_stats_flow_update_match(struct of1x_flow_entry * entry,uint64_t byte
 void __of1x_stats_flow_inc(struct of1x_flow_entry * entry,uint64_t bytes_rx);
 void __of1x_stats_table_init(struct of1x_flow_table * table);
 void __of1x_stats_table_destroy(struct of1x_flow_table * table);
+
+//Table flow aggregates
+void __of1x_stats_table_add_flow_counts(struct of1x_flow_table * table, uint64_t packets, uint64_t bytes);
+void __of1x_stats_table_sub_flow_counts(struct of1x_flow_table * table, uint64_t packets, uint64_t bytes);
+bool __of1x_stats_table_get_flow_aggregate(struct of1x_flow_table * table, of1x_stats_flow_aggregate_msg_t* msg);
+
 void __of1x_stats_table_lookup_inc(struct of1x_flow_table * table);
 void __of1x_stats_table_matches_inc(struct of1x_flow_table * table);
 
-void __of1x_init_group_stats(of1x_stats_group_t *group_stats);
+rofl_result_t __of1x_init_group_stats(of1x_stats_group_t *group_stats, unsigned int num_of_buckets);
 void __of1x_destroy_group_stats(of1x_stats_group_t* group_stats);
-void __of1x_stats_group_update(of1x_stats_group_t *gr_stats, uint64_t bytes);
+rofl_result_t __of1x_stats_group_reset_buckets(of1x_stats_group_t *group_stats, unsigned int num_of_buckets);
+void __of1x_stats_group_get_counts(const of1x_stats_group_t *gr_stats, unsigned int column, uint64_t* packets, uint64_t* bytes);
+void __of1x_stats_group_add_counts(of1x_stats_group_t *gr_stats, unsigned int column, uint64_t packets, uint64_t bytes);
 void __of1x_stats_group_inc_reference(of1x_stats_group_t *gr_stats);
 void __of1x_stats_group_dec_reference(of1x_stats_group_t *gr_stats);
 
@@ -214,9 +289,15 @@ of1x_stats_group_msg_t* of1x_get_group_all_stats(struct of1x_pipeline* pipeline,
 //FIXME: add documentation
 void of1x_destroy_stats_group_msg(of1x_stats_group_msg_t *msg);
 
-void __of1x_init_bucket_stats(of1x_stats_bucket_counter_t *bc_stats);
-void __of1x_destroy_buckets_stats(of1x_stats_bucket_counter_t *bc_stats);
-void __of1x_stats_bucket_update(of1x_stats_bucket_counter_t* bc_stats, uint64_t bytes);
+//Row of the group counters of a core (datapath, group read lock held)
+static inline of1x_stats_counter_t* __of1x_stats_group_row(of1x_stats_group_t *gr_stats, unsigned int core_id){
+	return gr_stats->cores + core_id*gr_stats->row_len;
+}
+
+static inline void __of1x_stats_counter_update(of1x_stats_counter_t* counter, uint64_t bytes){
+	counter->packet_count++;
+	counter->byte_count += bytes;
+}
 
 /*
 * External interfaces
@@ -228,6 +309,20 @@ void __of1x_stats_bucket_update(of1x_stats_bucket_counter_t* bc_stats, uint64_t
 */
 of1x_stats_flow_msg_t* of1x_get_flow_stats(struct of1x_pipeline* pipeline, uint8_t table_id, uint32_t cookie, uint32_t cookie_mask, uint32_t out_port, uint32_t out_group, struct of1x_match_group* matchs);
 
+/**
+* @ingroup core_of1x 
+* Initializes a flow stats cursor. Same parameters as of1x_get_flow_stats()
+*/
+rofl_result_t of1x_init_stats_flow_cursor(struct of1x_pipeline* pipeline, of1x_stats_flow_cursor_t* cursor, uint8_t table_id, uint32_t cookie, uint32_t cookie_mask, uint32_t out_port, uint32_t out_group, struct of1x_match_group* matchs);
+
+/**
+* @ingroup core_of1x 
+* Retrieves the next chunk (at most max_entries) of individual flow stats. There are
+* more chunks to retrieve as long as cursor->done is false.
+* @return of1x_stats_flow_msg_t instance that must be destroyed using of1x_destroy_stats_flow_msg() 
+*/
+of1x_stats_flow_msg_t* of1x_get_flow_stats_chunk(struct of1x_pipeline* pipeline, of1x_stats_flow_cursor_t* cursor, unsigned int max_entries);
+
 /**
 * @ingroup core_of1x 
 * Retrieves aggregated flow stats 
@@ -103,7 +103,7 @@ void __of1x_dump_timers_structure(of1x_timer_group_t * timer_group){
 /**
  * transforms the timeval to a single uint64_t unit time in miliseconds
  */
-inline uint64_t __of1x_get_time_ms(struct timeval *time){
+uint64_t __of1x_get_time_ms(struct timeval *time){
 
 	return time->tv_sec*1000+time->tv_usec/1000;
 }
@@ -575,13 +575,22 @@ static rofl_result_t __of1x_add_single_timer(of1x_flow_table_t* const table, con
 
 //Add timer to a table
 rofl_result_t __of1x_add_timer(of1x_flow_table_t* const table, of1x_flow_entry_t* const entry){
+	return __of1x_add_timer_elapsed(table, entry, 0, 0);
+}
+
+//Remaining timeout; already expired timeouts expire in the next slots
+static inline uint32_t __of1x_timer_remaining(uint32_t timeout, uint32_t elapsed){
+	return (timeout > elapsed)? timeout - elapsed : 1;
+}
+
+rofl_result_t __of1x_add_timer_elapsed(of1x_flow_table_t* const table, of1x_flow_entry_t* const entry, uint32_t hard_elapsed, uint32_t idle_elapsed){
 	rofl_result_t res;
 	//NOTE we don't use that lock because this is only called from of1x_add_flow_entry...()
 	//platform_mutex_lock(table->mutex);
 	
 	if(entry->timer_info.idle_timeout)
 	{
-		res = __of1x_add_single_timer(table, entry->timer_info.idle_timeout, entry, IDLE_TO); //is_idle = 1
+		res = __of1x_add_single_timer(table, __of1x_timer_remaining(entry->timer_info.idle_timeout, idle_elapsed), entry, IDLE_TO); //is_idle = 1
 		if(res == ROFL_FAILURE)
 		{
 			//platform_mutex_unlock(table->mutex);
@@ -590,7 +599,7 @@ rofl_result_t __of1x_add_timer(of1x_flow_table_t* const table, of1x_flow_entry_t
 	}
 	if(entry->timer_info.hard_timeout)
 	{
-		res = __of1x_add_single_timer(table, entry->timer_info.hard_timeout, entry, HARD_TO); //is_idle = 0
+		res = __of1x_add_single_timer(table, __of1x_timer_remaining(entry->timer_info.hard_timeout, hard_elapsed), entry, HARD_TO); //is_idle = 0
 		if(res == ROFL_FAILURE)
 		{
 			//platform_mutex_unlock(table->mutex);
@@ -641,5 +650,8 @@ void __of1x_process_pipeline_tables_timeout_expirations(of1x_pipeline_t *const p
 #endif
 		platform_mutex_unlock(table->mutex);
 	}
+
+	//Unclaimed packet buffers
+	__of1x_expire_packet_buffers(pipeline, now);
 	return;
 }
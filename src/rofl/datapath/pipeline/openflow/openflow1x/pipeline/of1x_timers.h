@@ -91,6 +91,8 @@ ROFL_BEGIN_DECLS
 
 //Timer functions outside tu
 rofl_result_t __of1x_add_timer(struct of1x_flow_table* const table, struct of1x_flow_entry* const entry);
+//Add the timers of an entry whose timeouts started elapsed seconds ago (restored entries)
+rofl_result_t __of1x_add_timer_elapsed(struct of1x_flow_table* const table, struct of1x_flow_entry* const entry, uint32_t hard_elapsed, uint32_t idle_elapsed);
 rofl_result_t __of1x_destroy_timer_entries(struct of1x_flow_entry * entry);
 
 void __of1x_process_pipeline_tables_timeout_expirations(struct of1x_pipeline *const pipeline);
@@ -103,7 +105,7 @@ void __of1x_fill_new_timer_entry_info(struct of1x_flow_entry * entry, uint32_t h
 // public for testing
 int __of1x_gettimeofday(struct timeval * tval, struct timezone * tzone);
 uint64_t __of1x_get_expiration_time_slotted (uint32_t timeout,struct timeval *now);
-inline uint64_t __of1x_get_time_ms(struct timeval *time);
+uint64_t __of1x_get_time_ms(struct timeval *time);
 
 //C++ extern C
 ROFL_END_DECLS
@@ -20,8 +20,8 @@
 typedef enum rofl_of1x_fm_result{
 	ROFL_OF1X_FM_SUCCESS	= EXIT_SUCCESS,
 	ROFL_OF1X_FM_FAILURE	= EXIT_FAILURE,
-	ROFL_OF1X_FM_OVERLAP
-	
+	ROFL_OF1X_FM_OVERLAP,
+	ROFL_OF1X_FM_TABLE_FULL		/* Table full (max_entries) and no entry could be evicted */
 }rofl_of1x_fm_result_t;
 
 /*
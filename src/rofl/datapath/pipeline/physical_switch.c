@@ -2,6 +2,8 @@
 
 #include <assert.h>
 #include "platform/memory.h"
+#include "common/slab.h"
+#include "virtual_link.h"
 #include "util/logging.h"
 #include "openflow/openflow1x/pipeline/matching_algorithms/matching_algorithms.h"
 
@@ -16,6 +18,105 @@ switch_port_t* flood_meta_port=NULL;
 switch_port_t* in_port_meta_port=NULL;
 switch_port_t* all_meta_port=NULL;
 
+//
+// Lookup indices
+//
+
+typedef uint32_t (*__physical_switch_index_hash_t)(const void* item);
+
+static inline uint32_t __physical_switch_dpid_hash(uint64_t dpid){
+	return (uint32_t)((dpid * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+//FNV-1a
+static inline uint32_t __physical_switch_name_hash(const char* name){
+
+	unsigned int i;
+	uint32_t h = 2166136261U;
+
+	for(i=0;i<SWITCH_PORT_MAX_LEN_NAME && name[i];i++)
+		h = (h ^ (uint8_t)name[i]) * 16777619U;
+
+	return h;
+}
+
+static uint32_t __physical_switch_sw_hash(const void* sw){
+	return __physical_switch_dpid_hash(((const of_switch_t*)sw)->dpid);
+}
+
+static uint32_t __physical_switch_port_hash(const void* port){
+	return __physical_switch_name_hash(((const switch_port_t*)port)->name);
+}
+
+//Index size; power of 2, at least twice the max number of items
+static inline unsigned int __physical_switch_index_size(unsigned int max_items){
+
+	unsigned int size = 2;
+
+	while(size < 2*max_items)
+		size <<= 1;
+
+	return size;
+}
+
+//There is always a free slot (the index is never more than half full)
+static void __physical_switch_index_insert(void** index, unsigned int mask, void* item, uint32_t hash){
+
+	unsigned int i = hash & mask;
+
+	while(index[i])
+		i = (i+1) & mask;
+
+	index[i] = item;
+}
+
+//Backward shift deletion (no tombstones). Items are moved towards their home
+//slot, so a concurrent lookup could miss one; lookups retry on index_seq
+static void __physical_switch_index_remove(void** index, unsigned int mask, void* item, __physical_switch_index_hash_t hash){
+
+	unsigned int i, j, k;
+
+	for(i = hash(item) & mask; index[i] != item; i = (i+1) & mask){
+		if(!index[i])
+			return;
+	}
+
+	psw->index_seq++;
+	__sync_synchronize();
+
+	for(j = (i+1) & mask; index[j]; j = (j+1) & mask){
+		//Skip the items whose home slot is cyclically within (i, j]
+		k = hash(index[j]) & mask;
+		if( (i <= j)? (i < k && k <= j) : (i < k || k <= j) )
+			continue;
+
+		index[i] = index[j];
+		i = j;
+	}
+
+	index[i] = NULL;
+
+	__sync_synchronize();
+	psw->index_seq++;
+}
+
+//Lookups (no lock) start here...
+static inline uint32_t __physical_switch_index_read_begin(void){
+
+	uint32_t seq;
+
+	while((seq = psw->index_seq) & 0x1);
+	__sync_synchronize();
+
+	return seq;
+}
+
+//...and repeat if a removal ran meanwhile
+static inline bool __physical_switch_index_read_retry(uint32_t seq){
+	__sync_synchronize();
+	return psw->index_seq != seq;
+}
+
 
 //
 // Physical switch mgmt
@@ -27,28 +128,83 @@ void __physical_switch_generate_matching_algorithm_list(){
 	//Add more versions here...
 }
 
+//Releases the arrays and indices
+static void __physical_switch_free_arrays(physical_switch_t* sw){
+
+	if(sw->logical_switches)
+		platform_free_shared(sw->logical_switches);
+	if(sw->physical_ports)
+		platform_free_shared(sw->physical_ports);
+	if(sw->virtual_ports)
+		platform_free_shared(sw->virtual_ports);
+	if(sw->tunnel_ports)
+		platform_free_shared(sw->tunnel_ports);
+	if(sw->dpid_index)
+		platform_free_shared(sw->dpid_index);
+	if(sw->port_index)
+		platform_free_shared(sw->port_index);
+}
+
+static void* __physical_switch_alloc_array(unsigned int num){
+
+	void* array = platform_malloc_shared(sizeof(void*)*num);
+
+	if(array)
+		memset(array, 0, sizeof(void*)*num);
+
+	return array;
+}
+
 //Init
 rofl_result_t physical_switch_init(){
+	return physical_switch_init_config(NULL);
+}
+
+rofl_result_t physical_switch_init_config(const physical_switch_config_t* config){
+
+	unsigned int dpid_index_size, port_index_size;
 
 	ROFL_PIPELINE_DEBUG("Initializing physical switch\n");
 
+	//Init the slab allocator (flow entries, matches, actions...)
+	if(slab_init() != ROFL_SUCCESS)
+		return ROFL_FAILURE;
+
 	//Allocate memory for the physical switch structure
 	psw = platform_malloc_shared(sizeof(physical_switch_t));
 	
 	if(!psw)
 		return ROFL_FAILURE;	
+	memset(psw, 0, sizeof(physical_switch_t));
+
+	//Limits
+	psw->max_logical_switches = (config && config->max_logical_switches)? config->max_logical_switches : PHYSICAL_SWITCH_MAX_LS;
+	psw->max_physical_ports = (config && config->max_physical_ports)? config->max_physical_ports : PHYSICAL_SWITCH_MAX_NUM_PHY_PORTS;
+	psw->max_virtual_ports = (config && config->max_virtual_ports)? config->max_virtual_ports : PHYSICAL_SWITCH_MAX_NUM_VIR_PORTS;
+	psw->max_tunnel_ports = (config && config->max_tunnel_ports)? config->max_tunnel_ports : PHYSICAL_SWITCH_MAX_NUM_TUN_PORTS;
+
+	dpid_index_size = __physical_switch_index_size(psw->max_logical_switches);
+	port_index_size = __physical_switch_index_size(psw->max_physical_ports + psw->max_virtual_ports + psw->max_tunnel_ports);
+	psw->dpid_index_mask = dpid_index_size-1;
+	psw->port_index_mask = port_index_size-1;
+
+	psw->logical_switches = (of_switch_t**)__physical_switch_alloc_array(psw->max_logical_switches);
+	psw->physical_ports = (switch_port_t**)__physical_switch_alloc_array(psw->max_physical_ports);
+	psw->virtual_ports = (switch_port_t**)__physical_switch_alloc_array(psw->max_virtual_ports);
+	psw->tunnel_ports = (switch_port_t**)__physical_switch_alloc_array(psw->max_tunnel_ports);
+	psw->dpid_index = (of_switch_t**)__physical_switch_alloc_array(dpid_index_size);
+	psw->port_index = (switch_port_t**)__physical_switch_alloc_array(port_index_size);
+
+	if(!psw->logical_switches || !psw->physical_ports || !psw->virtual_ports || !psw->tunnel_ports || !psw->dpid_index || !psw->port_index){
+		__physical_switch_free_arrays(psw);
+		platform_free_shared(psw);
+		psw = NULL;
+		return ROFL_FAILURE;
+	}
 	
 	//FIXME: check error
 	psw->mutex = platform_mutex_init(NULL);
 	
-	memset(psw->logical_switches, 0, sizeof(psw->logical_switches));
-	psw->num_of_logical_switches = 0;	
-
-	memset(psw->physical_ports, 0, sizeof(psw->physical_ports));
-	memset(psw->tunnel_ports, 0, sizeof(psw->tunnel_ports));
-	memset(psw->virtual_ports, 0, sizeof(psw->virtual_ports));
-	memset(psw->meta_ports, 0, sizeof(psw->meta_ports));
-	
 	//Generate metaports
 	//Flood
 	psw->meta_ports[META_PORT_FLOOD_INDEX].type = PORT_TYPE_META_FLOOD;
@@ -90,33 +246,41 @@ void physical_switch_destroy(){
 	platform_mutex_lock(psw->mutex);
 
 	//Destroy logical switches
-	for(i=0;i<PHYSICAL_SWITCH_MAX_LS;i++){
+	for(i=0;i<psw->max_logical_switches;i++){
 		if(psw->logical_switches[i])
 			of_destroy_switch(psw->logical_switches[i]);	
 	}
 
 	//Destroying ports
-	for(i=0;i<PHYSICAL_SWITCH_MAX_NUM_PHY_PORTS;i++){
+	for(i=0;i<psw->max_physical_ports;i++){
 		if( psw->physical_ports[i] != NULL ){ 
 			switch_port_destroy(psw->physical_ports[i]);
 		}
 	}
-	for(i=0;i<PHYSICAL_SWITCH_MAX_NUM_VIR_PORTS;i++){
+	for(i=0;i<psw->max_virtual_ports;i++){
 		if( psw->virtual_ports[i] != NULL ){ 
 			switch_port_destroy(psw->virtual_ports[i]);
 		}
 	}
-	for(i=0;i<PHYSICAL_SWITCH_MAX_NUM_TUN_PORTS;i++){
+	for(i=0;i<psw->max_tunnel_ports;i++){
 		if( psw->tunnel_ports[i] != NULL ){ 
 			switch_port_destroy(psw->tunnel_ports[i]);
 		}
 	}
 
+	//Virtual link queues
+	__virtual_link_destroy();
+
 	//Destroy mutex
 	platform_mutex_destroy(psw->mutex);
 	
 	//destroy physical switch
+	__physical_switch_free_arrays(psw);
 	platform_free_shared(psw);
+	psw = NULL;
+
+	//Release the slab pages
+	slab_destroy();
 }
 
 //
@@ -127,46 +291,35 @@ void physical_switch_destroy(){
 switch_port_t* physical_switch_get_port_by_name(const char *name){
 
 	unsigned int i;
+	uint32_t seq;
+	switch_port_t* port;
 
-	//Physical ports	
-	for(i=0;i<PHYSICAL_SWITCH_MAX_NUM_PHY_PORTS;i++){
-		if( psw->physical_ports[i] != NULL && strncmp(psw->physical_ports[i]->name, name, SWITCH_PORT_MAX_LEN_NAME)==0 ){
-			return psw->physical_ports[i];
-		}
-	}
-
-	//Virtual ports
-	for(i=0;i<PHYSICAL_SWITCH_MAX_NUM_VIR_PORTS;i++){
-		if( psw->virtual_ports[i] != NULL && strncmp(psw->virtual_ports[i]->name, name, SWITCH_PORT_MAX_LEN_NAME)==0 ){
-			return psw->virtual_ports[i];
-		}
-	}
-
-	//Tunnel ports
-	for(i=0;i<PHYSICAL_SWITCH_MAX_NUM_TUN_PORTS;i++){
-		if( psw->tunnel_ports[i] != NULL && strncmp(psw->tunnel_ports[i]->name, name, SWITCH_PORT_MAX_LEN_NAME)==0 ){
-			return psw->tunnel_ports[i];
+	do{
+		seq = __physical_switch_index_read_begin();
+		for(i = __physical_switch_name_hash(name) & psw->port_index_mask; (port = psw->port_index[i]) != NULL; i = (i+1) & psw->port_index_mask){
+			if( strncmp(port->name, name, SWITCH_PORT_MAX_LEN_NAME)==0 )
+				break;
 		}
-	}
+	}while(__physical_switch_index_read_retry(seq));
 
-	return NULL;
+	return port;
 }
 
 
 /* FIXME: this is dangerous. Better go for a copy of the ports */
 //Get the reference to the physical ports
 switch_port_t** physical_switch_get_physical_ports(unsigned int* max_ports){
-	*max_ports = PHYSICAL_SWITCH_MAX_NUM_PHY_PORTS;
+	*max_ports = psw->max_physical_ports;
 	return psw->physical_ports;
 }
 //Get the reference to the virtual ports
 switch_port_t** physical_switch_get_virtual_ports(unsigned int* max_ports){
-	*max_ports = PHYSICAL_SWITCH_MAX_NUM_VIR_PORTS;
+	*max_ports = psw->max_virtual_ports;
 	return psw->virtual_ports;
 }
 //Get the reference to the physical ports
 switch_port_t** physical_switch_get_tunnel_ports(unsigned int* max_ports){
-	*max_ports = PHYSICAL_SWITCH_MAX_NUM_TUN_PORTS;
+	*max_ports = psw->max_tunnel_ports;
 	return psw->tunnel_ports;
 }
 
@@ -217,17 +370,17 @@ rofl_result_t physical_switch_add_port(switch_port_t* port){
 	switch(port->type){
 
 		case PORT_TYPE_PHYSICAL:
-			max = PHYSICAL_SWITCH_MAX_NUM_PHY_PORTS;
+			max = psw->max_physical_ports;
 			array = psw->physical_ports; 
 			break;			
 
 		case PORT_TYPE_VIRTUAL:
-			max = PHYSICAL_SWITCH_MAX_NUM_VIR_PORTS;
+			max = psw->max_virtual_ports;
 			array = psw->virtual_ports; 
 			break;			
 
 		case PORT_TYPE_TUNNEL:
-			max = PHYSICAL_SWITCH_MAX_NUM_TUN_PORTS;
+			max = psw->max_tunnel_ports;
 			array = psw->tunnel_ports; 
 			break;			
 		
@@ -241,6 +394,7 @@ rofl_result_t physical_switch_add_port(switch_port_t* port){
 	for(i=0;i<max;i++){
 		if(array[i] == NULL){
 			array[i] = port;
+			__physical_switch_index_insert((void**)psw->port_index, psw->port_index_mask, port, __physical_switch_name_hash(port->name));
 			platform_mutex_unlock(psw->mutex);
 			return ROFL_SUCCESS;
 		}
@@ -258,8 +412,9 @@ rofl_result_t physical_switch_add_port(switch_port_t* port){
 */
 rofl_result_t physical_switch_remove_port(const char* name){
 
-	unsigned int i;
+	unsigned int i, max;
 	switch_port_t* port;
+	switch_port_t** array;
 
 	if(!name)
 		return ROFL_FAILURE;
@@ -267,46 +422,40 @@ rofl_result_t physical_switch_remove_port(const char* name){
 	//Serialize
 	platform_mutex_lock(psw->mutex);
 
-	//Looking in the physical ports list 
-	for(i=0;i<PHYSICAL_SWITCH_MAX_NUM_PHY_PORTS;i++){
-		
-		if(  psw->physical_ports[i] != NULL && strncmp(psw->physical_ports[i]->name, name, SWITCH_PORT_MAX_LEN_NAME) == 0 ){
-			port = psw->physical_ports[i]; 
-			psw->physical_ports[i] = NULL;
-			platform_mutex_unlock(psw->mutex);
-			switch_port_destroy(port);
-			return ROFL_SUCCESS;
-		}
+	port = physical_switch_get_port_by_name(name);
+	if(!port){
+		platform_mutex_unlock(psw->mutex);
+		//Port not found
+		return ROFL_FAILURE;
 	}
-	
-	//Looking in the virtual ports list 
-	for(i=0;i<PHYSICAL_SWITCH_MAX_NUM_VIR_PORTS;i++){
-		if(  psw->virtual_ports[i] != NULL && strncmp(psw->virtual_ports[i]->name, name, SWITCH_PORT_MAX_LEN_NAME) == 0 ){
-			port = psw->virtual_ports[i]; 
-			psw->virtual_ports[i] = NULL;
-			platform_mutex_unlock(psw->mutex);
-			switch_port_destroy(port);
-			return ROFL_SUCCESS;
-		}
+
+	switch(port->type){
+		case PORT_TYPE_PHYSICAL:
+			max = psw->max_physical_ports;
+			array = psw->physical_ports; 
+			break;			
+		case PORT_TYPE_VIRTUAL:
+			max = psw->max_virtual_ports;
+			array = psw->virtual_ports; 
+			break;			
+		default:
+			max = psw->max_tunnel_ports;
+			array = psw->tunnel_ports; 
+			break;			
 	}
 
-	//Looking in the tunnel ports list 
-	for(i=0;i<PHYSICAL_SWITCH_MAX_NUM_TUN_PORTS;i++){
-		if(  psw->tunnel_ports[i] != NULL && strncmp(psw->tunnel_ports[i]->name, name, SWITCH_PORT_MAX_LEN_NAME) == 0 ){
-			port = psw->tunnel_ports[i]; 
-			psw->tunnel_ports[i] = NULL;
-			platform_mutex_unlock(psw->mutex);
-			switch_port_destroy(port);
-			return ROFL_SUCCESS;
+	for(i=0;i<max;i++){
+		if(array[i] == port){
+			array[i] = NULL;
+			break;
 		}
 	}
+	__physical_switch_index_remove((void**)psw->port_index, psw->port_index_mask, port, __physical_switch_port_hash);
 
 	platform_mutex_unlock(psw->mutex);
-
-	//Port not found
-	return ROFL_FAILURE;
-	 	
-
+	
+	switch_port_destroy(port);
+	return ROFL_SUCCESS;
 }
 
 
@@ -321,7 +470,7 @@ rofl_result_t physical_switch_remove_port(const char* name){
 */
 of_switch_t** physical_switch_get_logical_switches(unsigned int* max_switches){
 
-	*max_switches = PHYSICAL_SWITCH_MAX_LS;
+	*max_switches = psw->max_logical_switches;
 	
 	return psw->logical_switches; 	
 }
@@ -329,14 +478,20 @@ of_switch_t** physical_switch_get_logical_switches(unsigned int* max_switches){
 
 //Get logical switch
 of_switch_t* physical_switch_get_logical_switch_by_dpid(const uint64_t dpid){
-	int i;
+
+	unsigned int i;
+	uint32_t seq;
+	of_switch_t* sw;
 	
-	for(i=0;i<PHYSICAL_SWITCH_MAX_LS;i++){
-		if( psw->logical_switches[i] && psw->logical_switches[i]->dpid == dpid )
-			return psw->logical_switches[i];
-	}
+	do{
+		seq = __physical_switch_index_read_begin();
+		for(i = __physical_switch_dpid_hash(dpid) & psw->dpid_index_mask; (sw = psw->dpid_index[i]) != NULL; i = (i+1) & psw->dpid_index_mask){
+			if( sw->dpid == dpid )
+				break;
+		}
+	}while(__physical_switch_index_read_retry(seq));
 
-	return NULL;
+	return sw;
 }
 
 //Add/remove methods
@@ -350,20 +505,21 @@ rofl_result_t physical_switch_add_logical_switch(of_switch_t* sw){
 	platform_mutex_lock(psw->mutex);
 
 	// check bounds
-	if(psw->num_of_logical_switches == PHYSICAL_SWITCH_MAX_LS){
+	if(psw->num_of_logical_switches == psw->max_logical_switches){
 		//Serialize
 		platform_mutex_unlock(psw->mutex);
 		return ROFL_FAILURE;
 	}
 	
 	//Look for an available slot
-	for(i=0;i<PHYSICAL_SWITCH_MAX_LS;i++){
+	for(i=0;i<psw->max_logical_switches;i++){
 		if(!psw->logical_switches[i])
 			break;
 	}
 
 	psw->logical_switches[i] = sw;
 	psw->num_of_logical_switches++;
+	__physical_switch_index_insert((void**)psw->dpid_index, psw->dpid_index_mask, sw, __physical_switch_dpid_hash(sw->dpid));
 
 	platform_mutex_unlock(psw->mutex);
 	return ROFL_SUCCESS;
@@ -371,7 +527,7 @@ rofl_result_t physical_switch_add_logical_switch(of_switch_t* sw){
 
 rofl_result_t physical_switch_remove_logical_switch_by_dpid(const uint64_t dpid){
 
-	int i;
+	unsigned int i;
 	of_switch_t* sw;
 
 	ROFL_PIPELINE_DEBUG("Removing logical switch with dpid: %"PRIu64"\n",dpid);
@@ -379,33 +535,29 @@ rofl_result_t physical_switch_remove_logical_switch_by_dpid(const uint64_t dpid)
 	//Serialize
 	platform_mutex_lock(psw->mutex);
 
-	if(!physical_switch_get_logical_switch_by_dpid(dpid)){
+	sw = physical_switch_get_logical_switch_by_dpid(dpid);
+	if(!sw){
 		platform_mutex_unlock(psw->mutex);
 		ROFL_PIPELINE_WARN("Logical switch not found\n");	
 		return ROFL_FAILURE;
 	}
 	
-	for(i=0;i<PHYSICAL_SWITCH_MAX_LS;i++){
-		if(psw->logical_switches[i] && psw->logical_switches[i]->dpid == dpid){
-
-			sw = psw->logical_switches[i];
-
+	for(i=0;i<psw->max_logical_switches;i++){
+		if(psw->logical_switches[i] == sw){
 			psw->logical_switches[i] = NULL;
-			psw->num_of_logical_switches--;
-
-			//Free the rest to do stuff with the physical sw
-			platform_mutex_unlock(psw->mutex);
-
-			//Destroy the switch				
-			of_destroy_switch(sw);				
-			
-			return ROFL_SUCCESS;
+			break;
 		}
 	}
-	
-	//This statement can never be reached	
+	psw->num_of_logical_switches--;
+	__physical_switch_index_remove((void**)psw->dpid_index, psw->dpid_index_mask, sw, __physical_switch_sw_hash);
+
+	//Free the rest to do stuff with the physical sw
 	platform_mutex_unlock(psw->mutex);
-	return ROFL_FAILURE;
+
+	//Destroy the switch				
+	of_destroy_switch(sw);				
+	
+	return ROFL_SUCCESS;
 }
 
 rofl_result_t physical_switch_remove_logical_switch(of_switch_t* sw){
@@ -428,7 +580,7 @@ rofl_result_t physical_switch_attach_physical_port_num_to_logical_switch(unsigne
 	
 	rofl_result_t return_val;
 
-	if( !sw || port_num >= PHYSICAL_SWITCH_MAX_NUM_PHY_PORTS || psw->physical_ports[port_num]->attached_sw )
+	if( !sw || port_num >= psw->max_physical_ports || psw->physical_ports[port_num]->attached_sw )
 		return ROFL_FAILURE;
 	
 	//Serialize
@@ -93,36 +93,37 @@
 
 #ifndef PHYSICAL_SWITCH_MAX_LS
     /**
-    * @brief Maximum number of logical switches that can be instantiated
+    * @brief Default maximum number of logical switches that can be instantiated
+    * (see physical_switch_init_config())
     * @ingroup mgmt
     */
-    #define PHYSICAL_SWITCH_MAX_LS 64
+    #define PHYSICAL_SWITCH_MAX_LS 256
 #endif
 
 #ifndef PHYSICAL_SWITCH_MAX_NUM_PHY_PORTS
     /**
-    * @brief Maximum number of phyisical ports
+    * @brief Default maximum number of phyisical ports
     * @ingroup mgmt
     */
-    #define PHYSICAL_SWITCH_MAX_NUM_PHY_PORTS 128 
+    #define PHYSICAL_SWITCH_MAX_NUM_PHY_PORTS 1024 
 #endif
 
 #ifndef PHYSICAL_SWITCH_MAX_NUM_VIR_PORTS
     /**
-    * @brief Maximum number of virtual ports
+    * @brief Default maximum number of virtual ports
     * @ingroup mgmt
     */
-    #define PHYSICAL_SWITCH_MAX_NUM_VIR_PORTS 128
+    #define PHYSICAL_SWITCH_MAX_NUM_VIR_PORTS 1024
 #endif
 
 #ifndef PHYSICAL_SWITCH_MAX_NUM_TUN_PORTS
     /**
-    * @brief Maximum number of tunnel ports
+    * @brief Default maximum number of tunnel ports
     * @ingroup mgmt
     */
-    #define PHYSICAL_SWITCH_MAX_NUM_TUN_PORTS 32
+    #define PHYSICAL_SWITCH_MAX_NUM_TUN_PORTS 256
 #endif
-    
+
 #define PHYSICAL_SWITCH_MAX_NUM_META_PORTS 8
 
 
@@ -156,23 +157,41 @@ typedef struct physical_switch{
     * List of all logical switches in the system
     */
     unsigned int num_of_logical_switches;
-    of_switch_t* logical_switches[PHYSICAL_SWITCH_MAX_LS];
+    unsigned int max_logical_switches;
+    of_switch_t** logical_switches;
 
     /*
     * Ports
     */
     //physical: index is the physical port of the platform.
-    switch_port_t* physical_ports[PHYSICAL_SWITCH_MAX_NUM_PHY_PORTS];
+    unsigned int max_physical_ports;
+    switch_port_t** physical_ports;
 
     //tunnel ports
-    switch_port_t* tunnel_ports[PHYSICAL_SWITCH_MAX_NUM_TUN_PORTS]; //Not used yet
+    unsigned int max_tunnel_ports;
+    switch_port_t** tunnel_ports; //Not used yet
 
     //virtual ports (which are not tunnel)
-    switch_port_t* virtual_ports[PHYSICAL_SWITCH_MAX_NUM_VIR_PORTS]; //Not used yet
+    unsigned int max_virtual_ports;
+    switch_port_t** virtual_ports; //Not used yet
 
     //meta ports (esoteric ports). This is NOT an array of pointers!
     switch_port_t meta_ports[PHYSICAL_SWITCH_MAX_NUM_META_PORTS]; 
 
+    /*
+    * Lookup indices by dpid and by port name (open addressing, linear
+    * probing). Sizes are powers of 2, at least twice the max number of
+    * elements. Updated under the mutex; lookups take no lock and retry
+    * if a removal (which shifts items back) ran meanwhile.
+    */
+    volatile uint32_t index_seq; //Odd while a removal shifts items
+
+    unsigned int dpid_index_mask;
+    of_switch_t** dpid_index;
+
+    unsigned int port_index_mask;
+    switch_port_t** port_index;
+
     /* 
     * Other state 
     */
@@ -193,12 +212,33 @@ ROFL_BEGIN_DECLS
 //
 //
 
+/**
+* @brief Physical switch limits (physical_switch_init_config()). Fields
+* set to 0 take the compile-time default (PHYSICAL_SWITCH_MAX_*)
+* @ingroup  mgmt
+*/
+typedef struct physical_switch_config{
+    unsigned int max_logical_switches;
+    unsigned int max_physical_ports;
+    unsigned int max_virtual_ports;
+    unsigned int max_tunnel_ports;
+}physical_switch_config_t;
+
 /**
 * @brief    Initializes the physical switch. This call must be done before anyone else. 
 * @ingroup  mgmt
+*
+* Uses the compile-time limits (PHYSICAL_SWITCH_MAX_*).
 */
 rofl_result_t physical_switch_init(void);
 
+/**
+* @brief    Initializes the physical switch with the limits in config (NULL for the defaults).
+* This call (or physical_switch_init()) must be done before anyone else. 
+* @ingroup  mgmt
+*/
+rofl_result_t physical_switch_init_config(const physical_switch_config_t* config);
+
 //Only used in multi-process deployments (with shared memory)
 physical_switch_t* __get_physical_switch();
 void __set_physical_switch(physical_switch_t* sw);
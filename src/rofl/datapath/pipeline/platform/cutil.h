@@ -19,6 +19,24 @@ uint32_t cutil_be32toh( uint32_t big32 );
 uint64_t cutil_htobe64( uint64_t host64 );
 uint64_t cutil_be64toh( uint64_t big64 );
 
+/*
+ * Processing core identification
+ */
+
+//Maximum number of processing cores (threads) running the pipeline concurrently
+#ifndef ROFL_PIPELINE_MAX_CORES
+	#define ROFL_PIPELINE_MAX_CORES 64
+#endif
+
+/**
+* @brief Returns the id of the core (thread) calling, in the range [0, ROFL_PIPELINE_MAX_CORES).
+* @ingroup platform_cutil
+*
+* Two threads processing packets concurrently MUST NOT get the same id. The id is used
+* by the library to index per-core state (e.g. meter credits) without atomic operations.
+*/
+unsigned int platform_get_core_id(void);
+
 //C++ extern C
 ROFL_END_DECLS
 
@@ -28,7 +28,7 @@
 * - Push header
 * - Pop header
 * - Drop packet
-* - Replicate (clone) packet
+* - Replicate (clone) packet, either copying or sharing (copy-on-write) the buffer
 * - Output the packet to a port
 *
 * If the platform does NOT support some of the operations contained
@@ -63,6 +63,18 @@ uint32_t platform_packet_get_size_bytes(datapacket_t *const pkt);
 void platform_packet_output(datapacket_t* pkt, switch_port_t* port);
 /**
 * @ingroup platform_packet
+* Output packet to several ports in a single burst. The pipeline uses this
+* hook for OF1X_PORT_FLOOD and OF1X_PORT_ALL outputs, with the ports of the
+* precomputed flood/all set of the switch (the input port excluded), instead
+* of handing the packet to flood_meta_port/all_meta_port.
+*
+* The same (shared) buffer is sent to all the ports; the platform does not
+* need to replicate the datapacket_t, and has to release pkt once (as in
+* platform_packet_output()). num_of_ports is always >= 1.
+*/
+void platform_packet_output_multi(datapacket_t* pkt, switch_port_t** ports, unsigned int num_of_ports);
+/**
+* @ingroup platform_packet
 * Creates a copy (in heap) of the datapacket_t structure including any
 * platform specific state (->platform_state). The following behaviour
 * is expected from this hook:
@@ -86,6 +98,37 @@ void platform_packet_drop(datapacket_t* pkt);
 *   to handle copies (lazy copying)
 */
 datapacket_t* platform_packet_replicate(datapacket_t* pkt);
+/**
+* @ingroup platform_packet
+* Creates a replica of the datapacket_t structure that SHARES the packet
+* buffer with pkt instead of copying it (zero-copy replication). The
+* pipeline uses this hook, instead of platform_packet_replicate(), for
+* multi-output action lists and for the buckets of ALL groups. The
+* following behaviour is expected from this hook:
+*
+* - Same datapacket_t semantics as in platform_packet_replicate()
+* - The platform must keep a reference counter on the shared buffer. 
+*   Releasing a packet (platform_packet_drop() or platform_packet_output())
+*   only decrements the counter; the buffer is freed when it reaches 0
+* - datapacket_t flag is_shared must be set to true in BOTH pkt and the
+*   replica if (and only if) the buffer is effectively shared
+*
+* The pipeline will call platform_packet_make_writable() before mangling
+* any packet with is_shared set, so that only replicas that rewrite headers
+* pay for a private copy (copy-on-write). Platforms that cannot share
+* buffers may simply return platform_packet_replicate(pkt).
+*/
+datapacket_t* platform_packet_replicate_shared(datapacket_t* pkt);
+/**
+* @ingroup platform_packet
+* Copy-on-write hook. Makes sure pkt owns a private copy of the packet
+* buffer, and clears the is_shared flag. If pkt is the last reference
+* to the shared buffer, no copy is necessary.
+*
+* @return ROFL_SUCCESS or ROFL_FAILURE if the private copy could not
+* be allocated; the action that required the copy is then skipped.
+*/
+rofl_result_t platform_packet_make_writable(datapacket_t* pkt);
 
 
 ////////////
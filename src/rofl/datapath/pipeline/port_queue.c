@@ -1,6 +1,9 @@
 #include "port_queue.h"
 
 #include <string.h>
+#include "platform/cutil.h"
+#include "platform/memory.h"
+#include "common/per_core.h"
 
 
 rofl_result_t __port_queue_init(port_queue_t* queue, uint32_t id, char* name, uint16_t length, uint16_t min_rate, uint16_t max_rate){
@@ -15,6 +18,14 @@ rofl_result_t __port_queue_init(port_queue_t* queue, uint32_t id, char* name, ui
 		return ROFL_FAILURE;
 	}
 
+	//Per-core stats
+	queue->stats_shards = (queue_stats_shard_t*)__per_core_alloc(sizeof(queue_stats_shard_t));
+
+	if(!queue->stats_shards){
+		platform_mutex_destroy(queue->stats.mutex);
+		return ROFL_FAILURE;
+	}
+
 	//Fill in values
 	queue->set = true;
 	queue->id = id;
@@ -31,6 +42,7 @@ rofl_result_t __port_queue_init(port_queue_t* queue, uint32_t id, char* name, ui
 rofl_result_t __port_queue_destroy(port_queue_t* queue){
 	//Destroy
 	platform_mutex_destroy(queue->stats.mutex);
+	__per_core_free(queue->stats_shards);
 	memset(queue,0,sizeof(port_queue_t));
 	return ROFL_SUCCESS;
 }
@@ -53,7 +65,7 @@ void port_queue_stats_inc_lockless(port_queue_t* queue,
 }
 
 /*
-* @brief Increments atomically all the statistics of the queue; shall be used by queues on TX. 
+* @brief Increments all the statistics of the queue; shall be used by queues on TX. 
 * Fill in with 0 the ones that should
 * be left untouched.
 * @ingroup  mgmt
@@ -63,9 +75,30 @@ void port_queue_stats_inc(port_queue_t* queue,
 				uint64_t tx_bytes,
 				uint64_t overrun){
 
-	//TODO: evaluate to use lock-less strategies (single threaded I/O subsystems)
-	//or use platform specific atomic_incs
-	platform_mutex_lock(queue->stats.mutex);
-	port_queue_stats_inc_lockless(queue, tx_packets, tx_bytes, overrun);
-	platform_mutex_unlock(queue->stats.mutex);
+	//Non atomic, as in switch_port_stats_inc()
+	queue_stats_shard_t* shard = &queue->stats_shards[__per_core_id()];
+
+	shard->tx_packets += tx_packets;
+	shard->tx_bytes += tx_bytes;
+	shard->overrun += overrun;
+}
+
+void port_queue_get_stats(port_queue_t* queue, queue_stats_t* stats){
+
+	unsigned int i;
+
+	memset(stats,0,sizeof(queue_stats_t));
+
+	stats->tx_packets = queue->stats.tx_packets;
+	stats->tx_bytes = queue->stats.tx_bytes;
+	stats->overrun = queue->stats.overrun;
+
+	if(!queue->stats_shards)
+		return;
+
+	for(i=0;i<ROFL_PIPELINE_MAX_CORES;i++){
+		stats->tx_packets += queue->stats_shards[i].tx_packets;
+		stats->tx_bytes += queue->stats_shards[i].tx_bytes;
+		stats->overrun += queue->stats_shards[i].overrun;
+	}
 }
@@ -36,6 +36,17 @@ typedef struct queue_stats {
 	platform_mutex_t* mutex;
 }queue_stats_t;
 
+/**
+* @brief Per-core queue stats (one cache line)
+* @ingroup core
+*/
+typedef struct queue_stats_shard {
+	uint64_t tx_packets;
+	uint64_t tx_bytes;
+	uint64_t overrun;
+	uint64_t __pad[5];
+}queue_stats_shard_t;
+
 
 /**
 * @brief Switch queue abstraction.
@@ -76,10 +87,16 @@ typedef struct port_queue{
 	uint16_t max_rate;
 
 	/**
-	* Queue statistics
+	* Queue statistics. Only the updates of port_queue_stats_inc_lockless();
+	* use port_queue_get_stats() to retrieve all of them.
 	*/
 	queue_stats_t stats;
 
+	/**
+	* Per-core statistics (ROFL_PIPELINE_MAX_CORES), updated by port_queue_stats_inc()
+	*/
+	queue_stats_shard_t* stats_shards;
+
 	/* Opaque platform queue specific extra state */
 	platform_queue_state_t* platform_queue_state; 
 }port_queue_t;
@@ -104,16 +121,25 @@ void port_queue_stats_inc_lockless(port_queue_t* queue,
 				uint64_t tx_bytes,
 				uint64_t overrun);
 /**
-* @brief Increments atomically all the statistics of the queue; shall be used by queues on TX. 
+* @brief Increments all the statistics of the queue; shall be used by queues on TX. 
 * Fill in with 0 the ones that should
 * be left untouched.
 * @ingroup  mgmt
+*
+* Safe to be called concurrently from several threads, as long as they have
+* different core ids (platform_get_core_id()); counters are kept per core.
 */
 void port_queue_stats_inc(port_queue_t* queue, 
 				uint64_t tx_packets,
 				uint64_t tx_bytes,
 				uint64_t overrun);
 
+/**
+* @brief Retrieves the statistics of the queue (aggregated over all cores)
+* @ingroup  mgmt
+*/
+void port_queue_get_stats(port_queue_t* queue, queue_stats_t* stats);
+
 /*
 * @brief Init a port_queue structure.
 * @ingroup  mgmt
@@ -0,0 +1,324 @@
+#include "port_scheduler.h"
+
+#include <string.h>
+#include <sys/time.h>
+#include "platform/memory.h"
+#include "platform/packet.h"
+#include "common/datapacket.h"
+#include "openflow/openflow1x/pipeline/of1x_timers.h"
+#include "util/logging.h"
+
+/*
+* Port egress scheduler
+*/
+
+static inline uint64_t __port_scheduler_now_ns(void){
+
+	struct timeval now;
+
+	__of1x_gettimeofday(&now, NULL);
+	return (now.tv_sec*1000000ULL + now.tv_usec)*1000ULL;
+}
+
+static uint64_t __port_scheduler_speed_bps(port_features_t speed){
+
+	switch(speed){
+		case PORT_FEATURE_10MB_HD:
+		case PORT_FEATURE_10MB_FD:
+			return 10000000ULL;
+		case PORT_FEATURE_100MB_HD:
+		case PORT_FEATURE_100MB_FD:
+			return 100000000ULL;
+		case PORT_FEATURE_1GB_HD:
+		case PORT_FEATURE_1GB_FD:
+			return 1000000000ULL;
+		case PORT_FEATURE_10GB_FD:
+			return 10000000000ULL;
+		case PORT_FEATURE_40GB_FD:
+			return 40000000000ULL;
+		case PORT_FEATURE_100GB_FD:
+			return 100000000000ULL;
+		case PORT_FEATURE_1TB_FD:
+			return 1000000000000ULL;
+		default:
+			return 0;
+	}
+}
+
+static rofl_result_t __port_scheduler_init_queue(port_scheduler_t* sched, port_queue_t* queue){
+
+	uint64_t i, len;
+	port_scheduler_queue_t* q = &sched->queues[queue->id];
+
+	for(len=1; len < ((queue->length)? queue->length : PORT_SCHEDULER_DEFAULT_LEN); len <<= 1);
+
+	q->slots = (port_scheduler_slot_t*)platform_malloc_shared(sizeof(port_scheduler_slot_t)*len);
+	if(!q->slots)
+		return ROFL_FAILURE;
+	memset(q->slots, 0, sizeof(port_scheduler_slot_t)*len);
+
+	for(i=0;i<len;i++)
+		q->slots[i].seq = i;
+	q->mask = len-1;
+	q->queue = queue;
+
+	//Weight; min_rate in %
+	q->quantum = PORT_SCHEDULER_QUANTUM;
+	if(queue->min_rate <= 1000 && queue->min_rate >= 20)
+		q->quantum *= queue->min_rate/10;
+
+	//Shaper
+	if(queue->max_rate && queue->max_rate < 1000 && sched->rate_bps){
+		q->rate = sched->rate_bps / 8 * queue->max_rate / 1000;
+		q->burst = q->rate * PORT_SCHEDULER_BURST_MS / 1000;
+		if(q->burst < 2*(int64_t)q->quantum)
+			q->burst = 2*q->quantum;
+		q->tokens = q->burst;
+		q->last_ns = __port_scheduler_now_ns();
+		sched->shaped = true;
+	}
+
+	sched->active[sched->num_of_queues++] = queue->id;
+
+	return ROFL_SUCCESS;
+}
+
+static void __port_scheduler_destroy(port_scheduler_t* sched){
+
+	unsigned int i;
+	port_scheduler_queue_t* q;
+	struct datapacket* pkt;
+
+	for(i=0;i<SWITCH_PORT_MAX_QUEUES;i++){
+		q = &sched->queues[i];
+		if(!q->slots)
+			continue;
+
+		//Drop the packets still queued
+		for(; q->slots[q->head & q->mask].seq == q->head+1; q->head++){
+			pkt = q->slots[q->head & q->mask].pkt;
+			platform_packet_drop(pkt);
+		}
+		platform_free_shared(q->slots);
+	}
+
+	platform_free_shared(sched);
+}
+
+rofl_result_t port_scheduler_attach(switch_port_t* port, uint64_t rate_bps){
+
+	unsigned int i;
+	port_scheduler_t* sched;
+
+	if(!port || port->scheduler)
+		return ROFL_FAILURE;
+
+	sched = (port_scheduler_t*)platform_malloc_shared(sizeof(port_scheduler_t));
+	if(!sched)
+		return ROFL_FAILURE;
+	memset(sched, 0, sizeof(port_scheduler_t));
+
+	sched->port = port;
+	sched->rate_bps = (rate_bps)? rate_bps : __port_scheduler_speed_bps(port->curr_speed);
+
+	for(i=0;i<SWITCH_PORT_MAX_QUEUES;i++){
+		if(!port->queues[i].set)
+			continue;
+
+		if(__port_scheduler_init_queue(sched, &port->queues[i]) != ROFL_SUCCESS){
+			__port_scheduler_destroy(sched);
+			return ROFL_FAILURE;
+		}
+	}
+
+	port->scheduler = sched;
+
+	return ROFL_SUCCESS;
+}
+
+rofl_result_t port_scheduler_detach(switch_port_t* port){
+
+	port_scheduler_t* sched = port->scheduler;
+
+	if(!sched)
+		return ROFL_FAILURE;
+
+	port->scheduler = NULL;
+	__port_scheduler_destroy(sched);
+
+	return ROFL_SUCCESS;
+}
+
+rofl_result_t port_scheduler_enqueue(port_scheduler_t* sched, uint32_t queue_id, struct datapacket* pkt, uint32_t size){
+
+	port_scheduler_queue_t* q;
+	port_scheduler_slot_t* slot;
+	uint64_t pos, seq;
+
+	if(queue_id >= SWITCH_PORT_MAX_QUEUES || !sched->queues[queue_id].slots){
+		if(!sched->num_of_queues){
+			platform_packet_drop(pkt);
+			return ROFL_FAILURE;
+		}
+		queue_id = sched->active[0];
+	}
+	q = &sched->queues[queue_id];
+
+	//Reserve a slot (bounded MPMC ring; a slot is free when seq == pos)
+	pos = q->tail;
+	for(;;){
+		slot = &q->slots[pos & q->mask];
+		seq = slot->seq;
+
+		if(seq == pos){
+			if(__sync_bool_compare_and_swap(&q->tail, pos, pos+1))
+				break;
+			pos = q->tail;
+		}else if((int64_t)(seq - pos) < 0){
+			//Full
+			port_queue_stats_inc(q->queue, 0, 0, 1);
+			platform_packet_drop(pkt);
+			return ROFL_FAILURE;
+		}else{
+			pos = q->tail;
+		}
+	}
+
+	slot->pkt = pkt;
+	slot->size = size;
+
+	//Publish
+	__sync_synchronize();
+	slot->seq = pos+1;
+
+	return ROFL_SUCCESS;
+}
+
+//Size of the head packet; false if empty
+static inline bool __port_scheduler_peek(port_scheduler_queue_t* q, uint32_t* size){
+
+	port_scheduler_slot_t* slot = &q->slots[q->head & q->mask];
+
+	if(slot->seq != q->head+1)
+		return false;
+
+	__sync_synchronize();
+	*size = slot->size;
+	return true;
+}
+
+static inline struct datapacket* __port_scheduler_pop(port_scheduler_queue_t* q){
+
+	port_scheduler_slot_t* slot = &q->slots[q->head & q->mask];
+	struct datapacket* pkt = slot->pkt;
+
+	//Release the slot for the next lap
+	__sync_synchronize();
+	slot->seq = q->head + q->mask + 1;
+	q->head++;
+
+	return pkt;
+}
+
+//Not enough tokens for the head packet. A packet larger than the burst is sent
+//with the bucket full (tokens go negative; the refill repays the debt)
+static inline bool __port_scheduler_shaped(port_scheduler_queue_t* q, uint32_t size){
+	return q->rate && q->tokens < (int64_t)size && q->tokens < q->burst;
+}
+
+static void __port_scheduler_refill(port_scheduler_t* sched){
+
+	unsigned int i;
+	uint64_t now = __port_scheduler_now_ns(), elapsed;
+	port_scheduler_queue_t* q;
+
+	for(i=0;i<sched->num_of_queues;i++){
+		q = &sched->queues[sched->active[i]];
+		if(!q->rate)
+			continue;
+
+		elapsed = now - q->last_ns;
+		if(elapsed > 1000000000ULL)
+			elapsed = 1000000000ULL;
+
+		q->tokens += q->rate * elapsed / 1000000000ULL;
+		if(q->tokens > q->burst)
+			q->tokens = q->burst;
+		q->last_ns = now;
+	}
+}
+
+unsigned int port_scheduler_dequeue_burst(port_scheduler_t* sched, struct datapacket** pkts, unsigned int max_pkts){
+
+	unsigned int n = 0, idle = 0;
+	uint32_t size = 0;
+	bool sent, pending;
+	port_scheduler_queue_t* q;
+
+	if(!sched->num_of_queues)
+		return 0;
+
+	if(sched->shaped)
+		__port_scheduler_refill(sched);
+
+	//Stop once every queue has been visited without progress (empty or shaped)
+	while(n < max_pkts && idle < sched->num_of_queues){
+
+		q = &sched->queues[sched->active[sched->current]];
+
+		if(!sched->quantum_added){
+			q->deficit += q->quantum;
+			sched->quantum_added = true;
+		}
+
+		sent = false;
+		while((pending = __port_scheduler_peek(q, &size)) && n < max_pkts){
+			if(size > q->deficit || __port_scheduler_shaped(q, size))
+				break;
+
+			pkts[n++] = __port_scheduler_pop(q);
+			q->deficit -= size;
+			if(q->rate)
+				q->tokens -= size;
+			port_queue_stats_inc(q->queue, 1, size, 0);
+			sent = true;
+		}
+
+		//Batch full; resume with this queue (same round) in the next call
+		if(n == max_pkts && pending)
+			break;
+
+		if(!pending){
+			//Empty queues do not accumulate credit
+			q->deficit = 0;
+			idle = (sent)? 0 : idle+1;
+		}else if(__port_scheduler_shaped(q, size)){
+			//Shaped; keep at most one quantum of credit
+			if(q->deficit > q->quantum)
+				q->deficit = q->quantum;
+			idle = (sent)? 0 : idle+1;
+		}else{
+			//Not enough credit yet
+			idle = 0;
+		}
+
+		sched->current = (sched->current+1) % sched->num_of_queues;
+		sched->quantum_added = false;
+	}
+
+	return n;
+}
+
+unsigned int port_scheduler_get_queue_len(port_scheduler_t* sched, uint32_t queue_id){
+
+	port_scheduler_queue_t* q;
+	uint64_t tail;
+
+	if(queue_id >= SWITCH_PORT_MAX_QUEUES || !sched->queues[queue_id].slots)
+		return 0;
+
+	q = &sched->queues[queue_id];
+	tail = q->tail;
+
+	return (tail > q->head)? (unsigned int)(tail - q->head) : 0;
+}
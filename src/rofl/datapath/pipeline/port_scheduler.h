@@ -0,0 +1,152 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+* @file port_scheduler.h
+* @brief Egress queue scheduler of a port
+*
+* Optional scheduler that platforms can attach to a switch_port_t to honour
+* the configuration of its queues (port_queue_t):
+*
+*  - Deficit Round Robin across queues. The quantum of a queue is
+*    proportional to its min_rate, so that each queue gets at least its
+*    share of the port when it is congested.
+*  - Rate shaping of the queues with a max_rate, with a token bucket.
+*
+* min_rate and max_rate are in 1/10 of a percent of the port rate (as in
+* OpenFlow); values above 1000 mean unset. The port rate is given when the
+* scheduler is attached, or else derived from the port current speed.
+*
+* Queues are lock-free bounded rings of port_queue_t length slots (rounded up
+* to a power of 2): any number of cores can enqueue, while only one at a time
+* (typically the TX thread of the port) may dequeue. Packets and bytes
+* dequeued for transmission, and packets dropped because the queue was full
+* (overrun), are accounted in the queue statistics (port_queue_get_stats()).
+*/
+
+#ifndef __PORT_SCHEDULER_H__
+#define __PORT_SCHEDULER_H__
+
+#include <stdbool.h>
+#include <inttypes.h>
+
+#include "rofl.h"
+#include "switch_port.h"
+
+//Base DRR quantum (bytes); multiplied by the queue weight (min_rate in %, at least 1)
+#define PORT_SCHEDULER_QUANTUM 1518
+
+//Slots of a queue with no length configured
+#define PORT_SCHEDULER_DEFAULT_LEN 512
+
+//Shaper burst (ms at max_rate; at least 2 quanta). Larger packets are sent
+//with the bucket full
+#define PORT_SCHEDULER_BURST_MS 10
+
+//Fwd declarations
+struct datapacket;
+
+/**
+* Queue slot
+*/
+typedef struct port_scheduler_slot{
+	volatile uint64_t seq;
+	struct datapacket* pkt;
+	uint32_t size;
+}port_scheduler_slot_t;
+
+/**
+* Scheduler queue
+*/
+typedef struct port_scheduler_queue{
+	//Producers
+	volatile uint64_t tail;
+	uint64_t __pad0[7];
+
+	//Consumer
+	uint64_t head;
+	uint64_t mask;
+	port_scheduler_slot_t* slots;
+
+	//DRR
+	uint32_t quantum;
+	int64_t deficit;
+
+	//Shaper (rate 0 unlimited)
+	uint64_t rate;				//Bytes/s
+	int64_t burst;				//Bytes
+	int64_t tokens;
+	uint64_t last_ns;
+
+	port_queue_t* queue;
+}port_scheduler_queue_t;
+
+/**
+* @ingroup core
+* Port egress scheduler
+*/
+typedef struct port_scheduler{
+	switch_port_t* port;
+	uint64_t rate_bps;
+
+	//Configured queues (ids), in round robin order
+	unsigned int num_of_queues;
+	unsigned int active[SWITCH_PORT_MAX_QUEUES];
+
+	//Round robin state
+	unsigned int current;
+	bool quantum_added;
+	bool shaped;				//At least one queue is shaped
+
+	port_scheduler_queue_t queues[SWITCH_PORT_MAX_QUEUES];
+}port_scheduler_t;
+
+//C++ extern C
+ROFL_BEGIN_DECLS
+
+/**
+* @ingroup core
+* Creates a scheduler for the queues currently configured in the port and
+* attaches it (port->scheduler). Queues added or removed afterwards require
+* detaching and attaching it again.
+*
+* @param rate_bps port rate (bits/s) used for max_rate shaping; 0 to derive it from port->curr_speed
+*/
+rofl_result_t port_scheduler_attach(switch_port_t* port, uint64_t rate_bps);
+
+/**
+* @ingroup core
+* Detaches and destroys the scheduler of the port, dropping (platform_packet_drop())
+* the packets still queued. There must be no concurrent enqueue/dequeue
+*/
+rofl_result_t port_scheduler_detach(switch_port_t* port);
+
+/**
+* @ingroup core
+* Queues a packet for transmission; the scheduler owns the packet afterwards.
+* Packets for a queue not configured go to the first configured queue.
+*
+* @param size packet size (bytes)
+* @return ROFL_FAILURE if the packet was dropped (queue full or no queues)
+*/
+rofl_result_t port_scheduler_enqueue(port_scheduler_t* sched, uint32_t queue_id, struct datapacket* pkt, uint32_t size);
+
+/**
+* @ingroup core
+* Dequeues up to max_pkts packets, in transmission order. Single consumer.
+*
+* @return number of packets dequeued (0 if all the queues are empty or shaped)
+*/
+unsigned int port_scheduler_dequeue_burst(port_scheduler_t* sched, struct datapacket** pkts, unsigned int max_pkts);
+
+/**
+* @ingroup core
+* Number of packets queued in a queue
+*/
+unsigned int port_scheduler_get_queue_len(port_scheduler_t* sched, uint32_t queue_id);
+
+//C++ extern C
+ROFL_END_DECLS
+
+#endif //PORT_SCHEDULER
@@ -2,6 +2,10 @@
 
 #include <string.h>
 #include "platform/memory.h"
+#include "platform/cutil.h"
+#include "common/per_core.h"
+#include "openflow/of_switch.h"
+#include "port_scheduler.h"
 
 
 /*
@@ -38,6 +42,15 @@ switch_port_t* switch_port_init(char* name, bool up, port_type_t type, port_stat
 		return NULL;
 	}
 
+	//Per-core stats
+	port->stats_shards = (port_stats_shard_t*)__per_core_alloc(sizeof(port_stats_shard_t));
+	if(!port->stats_shards){
+		platform_mutex_destroy(port->stats.mutex);
+		platform_mutex_destroy(port->mutex);
+		platform_free_shared(port);
+		return NULL;
+	}
+
 	//Fill values	
 	port->type = type;
 	port->up = up;
@@ -55,6 +68,8 @@ switch_port_t* switch_port_init(char* name, bool up, port_type_t type, port_stat
 	port->of_port_num = 0;
 	port->of_generate_packet_in = true;
 	port->attached_sw = NULL;
+	port->vlink_peer = NULL;
+	port->scheduler = NULL;
 
 	//Platform state
 	port->platform_port_state = NULL;
@@ -66,6 +81,14 @@ rofl_result_t switch_port_destroy(switch_port_t* port){
 
 	unsigned int i;
 
+	//Disconnect virtual link, if any
+	if(port->vlink_peer)
+		port->vlink_peer->vlink_peer = NULL;
+
+	//Scheduler, if any
+	if(port->scheduler)
+		port_scheduler_detach(port);
+
 	//Destroy queues
 	for(i=0;i<SWITCH_PORT_MAX_QUEUES;i++){
 		if(port->queues[i].set)
@@ -74,6 +97,7 @@ rofl_result_t switch_port_destroy(switch_port_t* port){
 
 	//Destroy port stats mutex
 	platform_mutex_destroy(port->stats.mutex);
+	__per_core_free(port->stats_shards);
 	
 	//Destroy port mutex
 	platform_mutex_destroy(port->mutex);
@@ -99,7 +123,10 @@ rofl_result_t switch_port_add_queue(switch_port_t* port, uint32_t id, char* name
 	}
 	
 	//Init switch queue
-	__port_queue_init(&port->queues[id], id, name, length, min_rate, max_rate);
+	if(__port_queue_init(&port->queues[id], id, name, length, min_rate, max_rate) != ROFL_SUCCESS){
+		platform_mutex_unlock(port->mutex);
+		return ROFL_FAILURE;
+	}
 
 	platform_mutex_unlock(port->mutex);
 	return ROFL_SUCCESS;
@@ -167,7 +194,7 @@ void switch_port_stats_inc_lockless(switch_port_t* port,
 
 
 /*
-* @brief Increments atomically all the statistics of the port; shall be used by ports on TX/RX. 
+* @brief Increments all the statistics of the port; shall be used by ports on TX/RX. 
 * Fill in with 0 the ones that should
 * be left untouched.
 * @ingroup  mgmt
@@ -185,25 +212,36 @@ void switch_port_stats_inc(switch_port_t* port,
 				uint64_t rx_over_err,
 				uint64_t rx_crc_err,
 				uint64_t collisions*/){
-				
-	//TODO: evaluate to use lock-less strategies (single threaded I/O subsystems)
-	//or target platform specific atomic_incs
-	platform_mutex_lock(port->stats.mutex);
-
-	switch_port_stats_inc_lockless(port,
-				rx_packets,
-				tx_packets,
-				rx_bytes,
-				tx_bytes,
-				rx_dropped,
-				tx_dropped
-				/*uint64_t rx_errors,
-				uint64_t tx_errors,
-				uint64_t rx_frame_err,
-				uint64_t rx_over_err,
-				uint64_t rx_crc_err,
-				uint64_t collisions*/);
-	platform_mutex_unlock(port->stats.mutex);
+
+	//Plain increments: a shard is only shared by several threads if their
+	//core ids wrap around ROFL_PIPELINE_MAX_CORES (counts may then be lost)
+	port_stats_shard_t* shard = &port->stats_shards[__per_core_id()];
+
+	shard->rx_packets += rx_packets;
+	shard->tx_packets += tx_packets;
+	shard->rx_bytes += rx_bytes;
+	shard->tx_bytes += tx_bytes;
+	shard->rx_dropped += rx_dropped;
+	shard->tx_dropped += tx_dropped;
+}
+
+void switch_port_get_stats(switch_port_t* port, port_stats_t* stats){
+
+	unsigned int i;
+	port_stats_shard_t* shard;
+
+	memcpy(stats, &port->stats, sizeof(port_stats_t));
+	stats->mutex = NULL;
+
+	for(i=0;i<ROFL_PIPELINE_MAX_CORES;i++){
+		shard = &port->stats_shards[i];
+		stats->rx_packets += shard->rx_packets;
+		stats->tx_packets += shard->tx_packets;
+		stats->rx_bytes += shard->rx_bytes;
+		stats->tx_bytes += shard->tx_bytes;
+		stats->rx_dropped += shard->rx_dropped;
+		stats->tx_dropped += shard->tx_dropped;
+	}
 }
 
 
@@ -217,6 +255,28 @@ void switch_port_add_capabilities(bitmap32_t* bitmap, bitmap32_t features){
 void switch_port_remove_capabilities(bitmap32_t* bitmap, bitmap32_t features){
 	*bitmap &= (~features);
 }
+void switch_port_update_state(switch_port_t* port, bool up, bitmap32_t state){
+
+	port->up = up;
+	port->state = state;
+
+	//Notify the logical switch, if any
+	if(port->attached_sw)
+		__of_update_port_liveness(port->attached_sw, port);
+}
+
+void switch_port_update_config(switch_port_t* port, bool forward_packets, bool drop_received, bool no_flood, bool of_generate_packet_in){
+
+	port->forward_packets = forward_packets;
+	port->drop_received = drop_received;
+	port->no_flood = no_flood;
+	port->of_generate_packet_in = of_generate_packet_in;
+
+	//Notify the logical switch, if any
+	if(port->attached_sw)
+		__of_update_port_liveness(port->attached_sw, port);
+}
+
 void switch_port_set_current_speed(switch_port_t* port, port_features_t speed){
 	if(speed > PORT_FEATURE_1TB_FD)
 		return;
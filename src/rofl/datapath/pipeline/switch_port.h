@@ -95,6 +95,20 @@ typedef struct port_stats {
 	platform_mutex_t* mutex;
 }port_stats_t;
 
+/**
+* @brief Per-core port stats (one cache line)
+* @ingroup core
+*/
+typedef struct port_stats_shard {
+	uint64_t rx_packets;
+	uint64_t tx_packets;
+	uint64_t rx_bytes;
+	uint64_t tx_bytes;
+	uint64_t rx_dropped;
+	uint64_t tx_dropped;
+	uint64_t __pad[2];
+}port_stats_shard_t;
+
 /**
 * @brief Port type enumeration.
 * @ingroup core
@@ -158,9 +172,13 @@ typedef struct switch_port{
 	//Port state (port_state_t bitmap)
 	bitmap32_t state;
 	
-	// Port statistics
+	// Port statistics. Only the updates of switch_port_stats_inc_lockless() and
+	// the error counters; use switch_port_get_stats() to retrieve all of them.
 	port_stats_t stats;
 
+	// Per-core port statistics (ROFL_PIPELINE_MAX_CORES), updated by switch_port_stats_inc()
+	port_stats_shard_t* stats_shards;
+
 	//Port capabilities; port_features_t bitmaps!
 	bitmap32_t curr;          /* Current features. */
 	bitmap32_t advertised;    /* Features being advertised by the port. */
@@ -183,6 +201,12 @@ typedef struct switch_port{
 	unsigned int of_port_num; //XXX: 
 	//Pointer to current logical switch attached
 	struct of_switch* attached_sw;	
+
+	//Other end of an in-memory virtual link (virtual_link.h); NULL otherwise
+	struct switch_port* vlink_peer;
+
+	//Egress scheduler (port_scheduler.h); NULL if the platform does not use it
+	struct port_scheduler* scheduler;
  
 	//Mutex for statistics
 	platform_mutex_t* mutex;
@@ -259,10 +283,14 @@ void switch_port_stats_inc_lockless(switch_port_t* port,
 
 
 /**
-* @brief Increments atomically all the statistics of the port; shall be used by ports on TX/RX. 
+* @brief Increments all the statistics of the port; shall be used by ports on TX/RX. 
 * Fill in with 0 the ones that should
 * be left untouched.
 * @ingroup  mgmt
+*
+* Safe to be called concurrently from several I/O threads (e.g. RSS queues of the
+* same port), as long as they have different core ids (platform_get_core_id());
+* counters are kept per core, without locks nor atomic operations.
 */
 void switch_port_stats_inc(switch_port_t* port,
 				uint64_t rx_packets,
@@ -278,6 +306,12 @@ void switch_port_stats_inc(switch_port_t* port,
 				uint64_t rx_crc_err,
 				uint64_t collisions*/);
 
+/**
+* @brief Retrieves the statistics of the port (aggregated over all cores)
+* @ingroup  mgmt
+*/
+void switch_port_get_stats(switch_port_t* port, port_stats_t* stats);
+
 /*
 * Conveninent wrappers just to avoid messing up with the bitmaps
 */
@@ -294,6 +328,35 @@ void switch_port_add_capabilities(bitmap32_t* bitmap,  bitmap32_t features);
 */
 void switch_port_remove_capabilities(bitmap32_t* bitmap, bitmap32_t features);
 
+/**
+* @brief Updates the admin. state (up) and the state bitmap (port_state_t) of the port.
+* @ingroup  mgmt
+*
+* Platforms shall use this call, instead of modifying port->up and port->state
+* directly, so that the liveness information of the logical switch the port is
+* attached to (e.g. used by fast-failover groups) is kept in sync.
+*/
+void switch_port_update_state(switch_port_t* port, bool up, bitmap32_t state);
+
+/**
+* @brief Updates the OpenFlow configuration flags of the port (OFPPC_NO_FWD,
+* OFPPC_NO_RECV, OFPPC_NO_FLOOD and OFPPC_NO_PACKET_IN, negated where applicable).
+* @ingroup  mgmt
+*
+* Platforms shall use this call, instead of modifying the flags directly, so
+* that the flood and all port sets of the logical switch the port is attached
+* to are kept in sync.
+*/
+void switch_port_update_config(switch_port_t* port, bool forward_packets, bool drop_received, bool no_flood, bool of_generate_packet_in);
+
+/**
+* @brief Returns true if the port is live (administratively up and link up)
+* @ingroup  mgmt
+*/
+static inline bool switch_port_is_live(const switch_port_t* port){
+	return port->up && !(port->state & (PORT_STATE_LINK_DOWN | PORT_STATE_BLOCKED));
+}
+
 /**
 * @brief Sets current speed
 * @ingroup  mgmt
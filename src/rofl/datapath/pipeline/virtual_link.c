@@ -0,0 +1,218 @@
+#include "virtual_link.h"
+
+#include <string.h>
+#include "platform/cutil.h"
+#include "platform/memory.h"
+#include "platform/packet.h"
+#include "common/datapacket.h"
+#include "common/per_core.h"
+#include "openflow/of_switch.h"
+#include "openflow/openflow1x/pipeline/of1x_pipeline.h"
+#include "util/logging.h"
+
+/*
+* In-memory virtual links
+*/
+
+virtual_link_core_t* __virtual_link_cores = NULL;
+
+static inline virtual_link_core_t* __virtual_link_get_core(void){
+
+	return &__virtual_link_cores[__per_core_id()];
+}
+
+rofl_result_t virtual_link_connect(switch_port_t* port1, switch_port_t* port2){
+
+	virtual_link_core_t* cores;
+
+	if(!port1 || !port2 || port1 == port2 || port1->vlink_peer || port2->vlink_peer)
+		return ROFL_FAILURE;
+
+	//Per-core queues, the first time
+	if(!__virtual_link_cores){
+		cores = (virtual_link_core_t*)platform_malloc_shared(sizeof(virtual_link_core_t)*ROFL_PIPELINE_MAX_CORES);
+		if(!cores)
+			return ROFL_FAILURE;
+		memset(cores, 0, sizeof(virtual_link_core_t)*ROFL_PIPELINE_MAX_CORES);
+
+		if(!__sync_bool_compare_and_swap(&__virtual_link_cores, NULL, cores))
+			platform_free_shared(cores);
+	}
+
+	port1->vlink_peer = port2;
+	port2->vlink_peer = port1;
+
+	ROFL_PIPELINE_DEBUG("Virtual link %s <-> %s connected\n", port1->name, port2->name);
+
+	return ROFL_SUCCESS;
+}
+
+rofl_result_t virtual_link_disconnect(switch_port_t* port){
+
+	switch_port_t* peer = port->vlink_peer;
+
+	if(!peer)
+		return ROFL_FAILURE;
+
+	port->vlink_peer = peer->vlink_peer = NULL;
+
+	ROFL_PIPELINE_DEBUG("Virtual link %s <-> %s disconnected\n", port->name, peer->name);
+
+	return ROFL_SUCCESS;
+}
+
+void __virtual_link_destroy(){
+
+	virtual_link_core_t* cores = __virtual_link_cores;
+
+	if(!cores)
+		return;
+
+	__virtual_link_cores = NULL;
+	platform_free_shared(cores);
+}
+
+//Processes the packet through the pipeline of the switch the ingress port is attached to
+static inline void __virtual_link_deliver(virtual_link_pending_t* entry){
+
+	const of_switch_t* sw = entry->port->attached_sw;
+
+	if(!sw){
+		platform_packet_drop(entry->pkt);
+		return;
+	}
+
+	switch(sw->of_ver){
+		case OF_VERSION_10:
+		case OF_VERSION_12:
+		case OF_VERSION_13:
+			__of1x_process_packet_pipeline_vlink(sw, entry->pkt, entry->port->of_port_num, entry->matches_valid);
+			break;
+		default:
+			platform_packet_drop(entry->pkt);
+			break;
+	}
+}
+
+//Processes the queued packets, including the ones queued meanwhile
+static void __virtual_link_drain(virtual_link_core_t* core){
+
+	virtual_link_pending_t entry;
+
+	core->nesting++;
+
+	while(core->count){
+		entry = core->queue[core->head];
+		core->head = (core->head+1) % VIRTUAL_LINK_QUEUE_LEN;
+		core->count--;
+
+		core->hops = entry.hops;
+		__virtual_link_deliver(&entry);
+	}
+
+	core->hops = 0;
+	core->nesting--;
+}
+
+virtual_link_core_t* __virtual_link_enter(){
+
+	virtual_link_core_t* core = __virtual_link_get_core();
+
+	core->nesting++;
+	return core;
+}
+
+void __virtual_link_leave(virtual_link_core_t* core){
+
+	if(--core->nesting == 0 && core->count)
+		__virtual_link_drain(core);
+}
+
+static inline void __virtual_link_enqueue(virtual_link_core_t* core, switch_port_t* port, datapacket_t* pkt, bool matches_valid){
+
+	switch_port_t* peer = port->vlink_peer;
+	virtual_link_pending_t* entry;
+	uint32_t size;
+
+	//Link down
+	if(!peer || !port->up || !port->forward_packets){
+		switch_port_stats_inc(port, 0, 0, 0, 0, 0, 1);
+		platform_packet_drop(pkt);
+		return;
+	}
+
+	//Forwarding loop
+	if(core->hops >= VIRTUAL_LINK_MAX_HOPS){
+		core->loops++;
+		switch_port_stats_inc(port, 0, 0, 0, 0, 0, 1);
+		platform_packet_drop(pkt);
+		return;
+	}
+
+	if(core->count == VIRTUAL_LINK_QUEUE_LEN){
+		core->overflows++;
+		switch_port_stats_inc(port, 0, 0, 0, 0, 0, 1);
+		platform_packet_drop(pkt);
+		return;
+	}
+
+	size = (matches_valid)? pkt->matches.of1x.pkt_size_bytes : platform_packet_get_size_bytes(pkt);
+	switch_port_stats_inc(port, 0, 1, 0, size, 0, 0);
+
+	if(!peer->up || peer->drop_received || !peer->attached_sw){
+		switch_port_stats_inc(peer, 0, 0, 0, 0, 1, 0);
+		platform_packet_drop(pkt);
+		return;
+	}
+	switch_port_stats_inc(peer, 1, 0, size, 0, 0, 0);
+
+	entry = &core->queue[(core->head + core->count) % VIRTUAL_LINK_QUEUE_LEN];
+	entry->pkt = pkt;
+	entry->port = peer;
+	entry->hops = core->hops+1;
+	entry->matches_valid = matches_valid;
+	core->count++;
+}
+
+void virtual_link_transmit(switch_port_t* port, datapacket_t* pkt, bool matches_valid){
+
+	virtual_link_core_t* core = __virtual_link_get_core();
+
+	__virtual_link_enqueue(core, port, pkt, matches_valid);
+
+	//Not within a pipeline invocation (e.g. platform flooding or injection)
+	if(!core->nesting && core->count)
+		__virtual_link_drain(core);
+}
+
+void virtual_link_transmit_burst(switch_port_t* port, datapacket_t** pkts, unsigned int num_of_pkts, bool matches_valid){
+
+	unsigned int i;
+	virtual_link_core_t* core = __virtual_link_get_core();
+
+	for(i=0;i<num_of_pkts;i++){
+		//Make room
+		if(core->count == VIRTUAL_LINK_QUEUE_LEN && !core->nesting)
+			__virtual_link_drain(core);
+
+		__virtual_link_enqueue(core, port, pkts[i], matches_valid);
+	}
+
+	if(!core->nesting && core->count)
+		__virtual_link_drain(core);
+}
+
+void virtual_link_get_stats(virtual_link_stats_t* stats){
+
+	unsigned int i;
+
+	memset(stats, 0, sizeof(virtual_link_stats_t));
+
+	if(!__virtual_link_cores)
+		return;
+
+	for(i=0;i<ROFL_PIPELINE_MAX_CORES;i++){
+		stats->loops += __virtual_link_cores[i].loops;
+		stats->overflows += __virtual_link_cores[i].overflows;
+	}
+}
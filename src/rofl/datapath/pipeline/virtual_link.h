@@ -0,0 +1,146 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+* @file virtual_link.h
+* @brief In-memory (zero-copy) virtual links between logical switches
+*
+* A virtual link joins two ports (typically PORT_TYPE_VIRTUAL) attached to
+* different logical switches. A packet sent through one of the ports is not
+* handed over to the platform (platform_packet_output()); the same
+* datapacket_t is processed by the pipeline of the switch the peer port is
+* attached to, as if it had been received there. Unless stated otherwise,
+* the packet matches already extracted are reused (no re-parsing): only the
+* input port and the metadata are reset.
+*
+* Packets are queued per core and processed once the pipeline invocation
+* that sent them (of_process_packet_pipeline()) has finished, so chains of
+* switches (tenant -> provider) are processed iteratively and in bursts,
+* never recursively. A packet crossing more than VIRTUAL_LINK_MAX_HOPS links
+* (forwarding loop) is dropped.
+*
+* Flood/all outputs of the pipeline reach the virtual link ports of the
+* switch directly (they are never part of platform_packet_output_multi()).
+* Platforms must use virtual_link_transmit() for the virtual link ports
+* when they resolve meta port outputs themselves, and must take the input port of a
+* packet from its matches (pkt->matches) rather than from their own state,
+* since platform_packet_get_port_in() refers to the port the packet was
+* originally received from.
+*/
+
+#ifndef __VIRTUAL_LINK_H__
+#define __VIRTUAL_LINK_H__
+
+#include <stdbool.h>
+#include <inttypes.h>
+
+#include "rofl.h"
+#include "switch_port.h"
+
+//Packets queued per core
+#define VIRTUAL_LINK_QUEUE_LEN 256
+
+//Max links crossed by a packet
+#define VIRTUAL_LINK_MAX_HOPS 8
+
+//Fwd declarations
+struct datapacket;
+struct of_switch;
+
+/**
+* Queued packet
+*/
+typedef struct virtual_link_pending{
+	struct datapacket* pkt;
+	switch_port_t* port;		//Ingress (peer) port
+	unsigned int hops;
+	bool matches_valid;
+}virtual_link_pending_t;
+
+/**
+* Per-core state (only accessed by the owning core)
+*/
+typedef struct virtual_link_core{
+	unsigned int nesting;		//Pipeline invocations in progress
+	unsigned int hops;		//Links crossed by the packet being processed
+	unsigned int head;
+	unsigned int count;
+
+	//Counters
+	uint64_t loops;			//Dropped, max hops exceeded
+	uint64_t overflows;		//Dropped, queue full
+	uint64_t __pad[5];
+
+	virtual_link_pending_t queue[VIRTUAL_LINK_QUEUE_LEN];
+}virtual_link_core_t;
+
+/**
+* @ingroup core
+* Virtual link drop counters
+*/
+typedef struct virtual_link_stats{
+	uint64_t loops;
+	uint64_t overflows;
+}virtual_link_stats_t;
+
+//Per-core state (ROFL_PIPELINE_MAX_CORES); allocated by the first virtual_link_connect()
+extern virtual_link_core_t* __virtual_link_cores;
+
+//C++ extern C
+ROFL_BEGIN_DECLS
+
+/**
+* @ingroup core
+* Connects two ports (not yet connected) with an in-memory virtual link
+*/
+rofl_result_t virtual_link_connect(switch_port_t* port1, switch_port_t* port2);
+
+/**
+* @ingroup core
+* Disconnects a virtual link (either of its ports). Must not be called
+* while packets may be in flight through the link
+*/
+rofl_result_t virtual_link_disconnect(switch_port_t* port);
+
+/**
+* @ingroup core
+* Whether port is one of the ends of a virtual link
+*/
+static inline bool virtual_link_is_connected(const switch_port_t* port){
+	return port->vlink_peer != NULL;
+}
+
+/**
+* @ingroup core
+* Sends a packet through a virtual link; the link owns the packet afterwards.
+*
+* @param matches_valid whether pkt->matches reflect the current packet headers
+* (false for packets not processed by an OpenFlow pipeline, or replicas created
+* by the platform)
+*/
+void virtual_link_transmit(switch_port_t* port, struct datapacket* pkt, bool matches_valid);
+
+/**
+* @ingroup core
+* Sends a burst of packets through a virtual link
+*/
+void virtual_link_transmit_burst(switch_port_t* port, struct datapacket** pkts, unsigned int num_of_pkts, bool matches_valid);
+
+/**
+* @ingroup core
+* Retrieves the drop counters (all the links)
+*/
+void virtual_link_get_stats(virtual_link_stats_t* stats);
+
+//Releases the per-core state (physical_switch_destroy())
+void __virtual_link_destroy(void);
+
+//Pipeline invocation in the calling core; the packets queued are processed when the outermost one leaves
+virtual_link_core_t* __virtual_link_enter(void);
+void __virtual_link_leave(virtual_link_core_t* core);
+
+//C++ extern C
+ROFL_END_DECLS
+
+#endif //VIRTUAL_LINK
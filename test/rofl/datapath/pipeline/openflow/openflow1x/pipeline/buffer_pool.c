@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "CUnit/Basic.h"
+#include "buffer_pool.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_timers.h"
+
+#define BP_BUFFERS 1024
+#define BP_THREADS 4
+#define BP_ITERATIONS 100000
+
+static of1x_switch_t* sw=NULL;
+static datapacket_t pkts[BP_BUFFERS];
+static uint32_t ids[BP_BUFFERS];
+
+int bp_set_up(void){
+	enum of1x_matching_algorithm_available ma_list[1]={of1x_matching_algorithm_loop};
+
+	sw = of1x_init_switch("Buffer switch", OF_VERSION_13, 0x0701, 1, ma_list);
+	if(!sw)
+		return -1;
+
+	//Set by the platform (post init hook)
+	sw->pipeline->num_of_buffers = BP_BUFFERS;
+	if(__of1x_init_buffer_pool(sw->pipeline) != ROFL_SUCCESS)
+		return -1;
+	return 0;
+}
+
+int bp_tear_down(void){
+	__of1x_destroy_switch(sw);
+	return 0;
+}
+
+void bp_store_retrieve_test(void){
+	uint32_t id, id2;
+	of1x_buffer_pool_stats_t stats;
+
+	id = of1x_store_packet_buffer(sw->pipeline, &pkts[0]);
+	CU_ASSERT(id != 0 && id != OF1XP_NO_BUFFER);
+
+	CU_ASSERT(of1x_retrieve_packet_buffer(sw->pipeline, 0) == NULL);
+	CU_ASSERT(of1x_retrieve_packet_buffer(sw->pipeline, OF1XP_NO_BUFFER) == NULL);
+	CU_ASSERT(of1x_retrieve_packet_buffer(sw->pipeline, id) == &pkts[0]);
+
+	//Retrieved; the id is now stale
+	CU_ASSERT(of1x_retrieve_packet_buffer(sw->pipeline, id) == NULL);
+
+	//Reusing the slot assigns a new generation
+	id2 = of1x_store_packet_buffer(sw->pipeline, &pkts[1]);
+	CU_ASSERT(id2 != id);
+	CU_ASSERT(of1x_retrieve_packet_buffer(sw->pipeline, id) == NULL);
+	CU_ASSERT(of1x_retrieve_packet_buffer(sw->pipeline, id2) == &pkts[1]);
+
+	of1x_get_buffer_pool_stats(sw->pipeline, &stats);
+	CU_ASSERT(stats.num_of_buffers == BP_BUFFERS);
+	CU_ASSERT(stats.stored == 2);
+	CU_ASSERT(stats.retrieved == 2);
+	CU_ASSERT(stats.stale == 2);
+	CU_ASSERT(stats.in_use == 0);
+}
+
+void bp_exhaustion_test(void){
+	unsigned int i, j;
+	of1x_buffer_pool_stats_t stats;
+
+	for(i=0;i<BP_BUFFERS;i++){
+		ids[i] = of1x_store_packet_buffer(sw->pipeline, &pkts[i]);
+		CU_ASSERT(ids[i] != OF1XP_NO_BUFFER);
+		for(j=0;j<i;j++)
+			CU_ASSERT(ids[i] != ids[j]);
+	}
+
+	CU_ASSERT(of1x_store_packet_buffer(sw->pipeline, &pkts[0]) == OF1XP_NO_BUFFER);
+
+	of1x_get_buffer_pool_stats(sw->pipeline, &stats);
+	CU_ASSERT(stats.in_use == BP_BUFFERS);
+	CU_ASSERT(stats.exhausted == 1);
+
+	for(i=0;i<BP_BUFFERS;i++)
+		CU_ASSERT(of1x_retrieve_packet_buffer(sw->pipeline, ids[i]) == &pkts[i]);
+}
+
+void bp_expiration_test(void){
+	uint32_t old_id, new_id;
+	of1x_buffer_pool_stats_t stats, prev;
+
+	of1x_get_buffer_pool_stats(sw->pipeline, &prev);
+
+	old_id = of1x_store_packet_buffer(sw->pipeline, &pkts[0]);
+	__of1x_time_forward(OF1X_BUFFER_POOL_EXPIRATION_MS/2000, 0, NULL);
+	new_id = of1x_store_packet_buffer(sw->pipeline, &pkts[1]);
+
+	//Only the first one expires
+	__of1x_time_forward(OF1X_BUFFER_POOL_EXPIRATION_MS/2000+1, 0, NULL);
+	of_process_pipeline_tables_timeout_expirations((of_switch_t*)sw);
+
+	CU_ASSERT(of1x_retrieve_packet_buffer(sw->pipeline, old_id) == NULL);
+	CU_ASSERT(of1x_retrieve_packet_buffer(sw->pipeline, new_id) == &pkts[1]);
+
+	of1x_get_buffer_pool_stats(sw->pipeline, &stats);
+	CU_ASSERT(stats.expired == prev.expired+1);
+	CU_ASSERT(stats.in_use == 0);
+}
+
+//Datapath thread (own core id): packet-in and packet-out of its own packets
+static void* bp_thread(void* arg){
+	unsigned int i;
+	uint32_t id;
+	datapacket_t* pkt = (datapacket_t*)arg;
+	unsigned long errors = 0;
+
+	for(i=0;i<BP_ITERATIONS;i++){
+		id = of1x_store_packet_buffer(sw->pipeline, pkt);
+		if(id == OF1XP_NO_BUFFER || of1x_retrieve_packet_buffer(sw->pipeline, id) != pkt ||
+			of1x_retrieve_packet_buffer(sw->pipeline, id) != NULL)
+			errors++;
+	}
+	return (void*)errors;
+}
+
+void bp_concurrent_test(void){
+	unsigned int i;
+	pthread_t threads[BP_THREADS];
+	void* errors;
+	of1x_buffer_pool_stats_t stats, prev;
+
+	of1x_get_buffer_pool_stats(sw->pipeline, &prev);
+
+	for(i=0;i<BP_THREADS;i++)
+		CU_ASSERT(pthread_create(&threads[i], NULL, bp_thread, &pkts[i]) == 0);
+	for(i=0;i<BP_THREADS;i++){
+		pthread_join(threads[i], &errors);
+		CU_ASSERT(errors == NULL);
+	}
+
+	of1x_get_buffer_pool_stats(sw->pipeline, &stats);
+	CU_ASSERT(stats.stored == prev.stored + BP_THREADS*BP_ITERATIONS);
+	CU_ASSERT(stats.retrieved == prev.retrieved + BP_THREADS*BP_ITERATIONS);
+	CU_ASSERT(stats.in_use == 0);
+
+	//Slots cached by the (finished) threads are not usable by other cores
+	for(i=0;i<BP_BUFFERS;i++){
+		ids[i] = of1x_store_packet_buffer(sw->pipeline, &pkts[i]);
+		if(ids[i] == OF1XP_NO_BUFFER)
+			break;
+	}
+	CU_ASSERT(i >= BP_BUFFERS - BP_THREADS*sw->pipeline->buffers->cache_size);
+	while(i--)
+		CU_ASSERT(of1x_retrieve_packet_buffer(sw->pipeline, ids[i]) == &pkts[i]);
+}
@@ -0,0 +1,15 @@
+#ifndef __BUFFER_POOL_H__
+#define __BUFFER_POOL_H__
+
+#include "rofl.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_buffer_pool.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/of1x_switch.h"
+
+int bp_set_up(void);
+int bp_tear_down(void);
+void bp_store_retrieve_test(void);
+void bp_exhaustion_test(void);
+void bp_expiration_test(void);
+void bp_concurrent_test(void);
+
+#endif //__BUFFER_POOL_H__
@@ -8,6 +8,10 @@ extern unsigned int drops;
 extern unsigned int outputs;
 extern unsigned int allocated;
 extern unsigned int released;
+extern unsigned int shared;
+extern unsigned int copies;
+extern unsigned int shared_writes;
+extern uint64_t output_eth_dst[];
 
 
 void init_io();
@@ -15,5 +19,6 @@ void destroy_io();
 void reset_io_state();
 datapacket_t* allocate_buffer();
 void release_buffer(datapacket_t* pkt);
+unsigned int data_in_use();
 
 #endif
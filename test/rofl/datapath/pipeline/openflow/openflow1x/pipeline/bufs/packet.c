@@ -18,6 +18,9 @@ unsigned int drops = 0;
 unsigned int outputs = 0;
 unsigned int allocated = 0;
 unsigned int released = 0;
+unsigned int shared = 0;
+unsigned int copies = 0;
+unsigned int shared_writes = 0;
 
 /*
 * Buffer pool 
@@ -26,6 +29,55 @@ unsigned int released = 0;
 datapacket_t* pool[FAKE_IO_POOL_SLOTS]={0};
 bool pool_state[FAKE_IO_POOL_SLOTS]={false};
 
+/*
+* Packet data. Replicas made with platform_packet_replicate_shared() point to
+* the data of the original (refcounted) until platform_packet_make_writable()
+*/
+typedef struct fake_data{
+	unsigned int refs;
+	uint64_t eth_dst;
+}fake_data_t;
+
+fake_data_t data[FAKE_IO_POOL_SLOTS];
+unsigned int pool_data[FAKE_IO_POOL_SLOTS];
+uint64_t output_eth_dst[FAKE_IO_POOL_SLOTS];
+
+static int get_slot(datapacket_t* pkt){
+	int i;
+	for(i=0;i<FAKE_IO_POOL_SLOTS;i++){
+		if(pool[i] == pkt)
+			return i;
+	}
+	CU_ASSERT(0);
+	return 0;
+}
+
+static unsigned int allocate_data(uint64_t eth_dst){
+	unsigned int i;
+	for(i=0;i<FAKE_IO_POOL_SLOTS;i++){
+		if(data[i].refs == 0){
+			data[i].refs = 1;
+			data[i].eth_dst = eth_dst;
+			return i;
+		}
+	}
+	CU_ASSERT(0);
+	return 0;
+}
+
+static fake_data_t* get_data(datapacket_t* pkt){
+	return &data[pool_data[get_slot(pkt)]];
+}
+
+unsigned int data_in_use(){
+	unsigned int i, in_use = 0;
+	for(i=0;i<FAKE_IO_POOL_SLOTS;i++){
+		if(data[i].refs)
+			in_use++;
+	}
+	return in_use;
+}
+
 void init_io(){
 	int i;
 	for(i=0;i<FAKE_IO_POOL_SLOTS;i++){
@@ -45,9 +97,11 @@ void reset_io_state(){
 	int i;
 
 	replicas = drops = outputs = allocated = released = 0;
+	shared = copies = shared_writes = 0;
 
 	for(i=0;i<FAKE_IO_POOL_SLOTS;i++){
 		pool_state[i] = false;
+		data[i].refs = 0;
 	}
 }
 
@@ -56,6 +110,8 @@ datapacket_t* allocate_buffer(){
 	for(i=0;i<FAKE_IO_POOL_SLOTS;i++){
 		if(pool_state[i] == false){
 			pool_state[i] = true;
+			pool_data[i] = allocate_data(0);
+			pool[i]->is_shared = false;
 			allocated++;
 			fprintf(stderr,"[pool] allocated %p\n", pool[i]);
 			return pool[i];
@@ -76,6 +132,7 @@ void release_buffer(datapacket_t* pkt){
 			}
 			CU_ASSERT(pool_state[i] == true);
 			pool_state[i] = false;
+			data[pool_data[i]].refs--;
 			released++;
 			fprintf(stderr,"[pool] released %p\n", pkt);
 			return;
@@ -102,7 +159,14 @@ void platform_packet_set_nw_ttl(datapacket_t* pkt, uint8_t new_ttl){}
 void platform_packet_set_queue(datapacket_t* pkt, uint32_t queue){}
 //TODO:
 //void platform_packet_set_metadata(datapacket_t* pkt, uint64_t metadata){ }
-void platform_packet_set_eth_dst(datapacket_t* pkt, uint64_t eth_dst){}
+void platform_packet_set_eth_dst(datapacket_t* pkt, uint64_t eth_dst){
+	fake_data_t* pkt_data = get_data(pkt);
+
+	//Would be seen by the other packets sharing the data
+	if(pkt_data->refs > 1)
+		shared_writes++;
+	pkt_data->eth_dst = eth_dst;
+}
 void platform_packet_set_eth_src(datapacket_t* pkt, uint64_t eth_src){}
 void platform_packet_set_eth_type(datapacket_t* pkt, uint16_t eth_type){}
 void platform_packet_set_vlan_vid(datapacket_t* pkt, uint16_t vlan_vid){}
@@ -139,17 +203,57 @@ void platform_packet_set_gtp_msg_type(datapacket_t* pkt, uint8_t msg_type){}
 void platform_packet_set_gtp_teid(datapacket_t* pkt, uint32_t teid){}
 void platform_packet_output(datapacket_t* pkt, switch_port_t* port){
 	fprintf(stderr,"Output packet %p\n", pkt);
+	output_eth_dst[outputs] = get_data(pkt)->eth_dst;
+	release_buffer(pkt);
+	outputs++;
+}
+void platform_packet_output_multi(datapacket_t* pkt, switch_port_t** ports, unsigned int num_of_ports){
+	fprintf(stderr,"Output packet %p to %u ports\n", pkt, num_of_ports);
+	output_eth_dst[outputs] = get_data(pkt)->eth_dst;
 	release_buffer(pkt);
 	outputs++;
 }
 datapacket_t* platform_packet_replicate(datapacket_t* pkt){
 	datapacket_t* replica = allocate_buffer(); 
 	if(replica){
+		get_data(replica)->eth_dst = get_data(pkt)->eth_dst;
 		replicas++;
 	}
 	fprintf(stderr,"Pkt: %p cloned into %p\n", pkt, replica);
 	return replica;
 }
+datapacket_t* platform_packet_replicate_shared(datapacket_t* pkt){
+	int slot;
+	datapacket_t* replica = allocate_buffer(); 
+
+	if(!replica)
+		return NULL;
+
+	//Drop the data of the new slot; point to the one of pkt
+	slot = get_slot(replica);
+	data[pool_data[slot]].refs--;
+	pool_data[slot] = pool_data[get_slot(pkt)];
+	data[pool_data[slot]].refs++;
+
+	replica->is_shared = pkt->is_shared = true;
+	replicas++;
+	shared++;
+	fprintf(stderr,"Pkt: %p shared with %p\n", pkt, replica);
+	return replica;
+}
+rofl_result_t platform_packet_make_writable(datapacket_t* pkt){
+	int slot = get_slot(pkt);
+	fake_data_t* pkt_data = &data[pool_data[slot]];
+
+	//Private copy, unless this is the last reference
+	if(pkt_data->refs > 1){
+		pool_data[slot] = allocate_data(pkt_data->eth_dst);
+		pkt_data->refs--;
+		copies++;
+	}
+	pkt->is_shared = false;
+	return ROFL_SUCCESS;
+}
 void platform_packet_drop(datapacket_t* pkt){
 	fprintf(stderr,"Drop packet %p\n", pkt);
 	release_buffer(pkt);
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 #include "CUnit/Basic.h"
 #include "test_bufs.h"
@@ -6,6 +7,7 @@
 
 static of1x_switch_t* sw=NULL;
 static datapacket_t* pkt=NULL;
+static switch_port_t out_port;
 
 int bufs_set_up(void){
 	//this is the set up for all tests (its only called once before all test, not for each one)
@@ -19,9 +21,10 @@ int bufs_set_up(void){
 	//Create instance	
 	sw = of1x_init_switch("Test switch", OF_VERSION_12, 0x0101, 4, ma_list);
 
-	//Add a fake port for output
+	//Add a fake port for output (not a virtual link end)
+	memset(&out_port, 0, sizeof(out_port));
 	sw->logical_ports[1].attachment_state = LOGICAL_PORT_STATE_ATTACHED;
-	sw->logical_ports[1].port = (switch_port_t*)0x1;
+	sw->logical_ports[1].port = &out_port;
 	
 	if(!sw)
 		return EXIT_FAILURE;
@@ -1104,4 +1107,60 @@ void bufs_output_all(void){
 	CU_ASSERT(replicas == 12)
 }
 
+//Group (type ALL) with a bucket rewriting the packet (copy-on-write)
+void bufs_shared_group_copy_on_write(void){
 
+	wrap_uint_t field, field_grp, field_eth_dst;
+	unsigned int grp_id = 14; 
+	field_grp.u32 = grp_id;
+	field.u32 = 1;
+	field_eth_dst.u64 = 0x0A0B0C0D0E0FULL;
+	reset_io_state();
+	
+	of1x_flow_entry_t* entry = of1x_init_flow_entry(NULL, NULL, false); 
+	
+	//First bucket mangles; the second one outputs the packet as received
+	of1x_bucket_list_t* buckets=of1x_init_bucket_list();
+	of1x_action_group_t* ag=of1x_init_action_group(NULL);
+	of1x_push_packet_action_to_group(ag, of1x_init_packet_action(OF1X_AT_SET_FIELD_ETH_DST,field_eth_dst,NULL,NULL));
+	of1x_push_packet_action_to_group(ag, of1x_init_packet_action(OF1X_AT_OUTPUT,field,NULL,NULL));
+	of1x_insert_bucket_in_list(buckets,of1x_init_bucket(0,1,0,ag));
+	ag=of1x_init_action_group(NULL);
+	of1x_push_packet_action_to_group(ag, of1x_init_packet_action(OF1X_AT_OUTPUT,field,NULL,NULL));
+	of1x_insert_bucket_in_list(buckets,of1x_init_bucket(0,1,0,ag));
+	CU_ASSERT(of1x_group_add(sw->pipeline->groups,OF1X_GROUP_TYPE_ALL,grp_id,buckets) == ROFL_OF1X_GM_OK);
+
+	of1x_action_group_t *apply_actions = of1x_init_action_group(NULL);
+	of1x_push_packet_action_to_group(apply_actions,of1x_init_packet_action(OF1X_AT_GROUP,field_grp,NULL,NULL));
+	of1x_add_instruction_to_group(
+			&(entry->inst_grp),
+			OF1X_IT_APPLY_ACTIONS,
+			(of1x_action_group_t*)apply_actions,
+			NULL,
+			NULL,
+			/*go_to_table*/0);
+
+	CU_ASSERT(of1x_add_flow_entry_table(sw->pipeline, 0, entry, false,false) == ROFL_OF1X_FM_SUCCESS);
+	
+	pkt = allocate_buffer();	
+	CU_ASSERT(pkt != NULL);	
+	if(!pkt)
+		return;
+
+	of_process_packet_pipeline((of_switch_t*)sw,pkt);
+
+	//Both replicas shared the data; only the mangled one got a copy
+	CU_ASSERT(replicas == 2);
+	CU_ASSERT(shared == 2);
+	CU_ASSERT(copies == 1);
+	CU_ASSERT(shared_writes == 0);
+
+	CU_ASSERT(outputs == 2);
+	CU_ASSERT(output_eth_dst[0] == 0x0A0B0C0D0E0FULL);
+	CU_ASSERT(output_eth_dst[1] == 0x0);
+
+	CU_ASSERT(allocated == 3);
+	CU_ASSERT(released == 3);
+	CU_ASSERT(drops == 1);
+	CU_ASSERT(data_in_use() == 0);
+}
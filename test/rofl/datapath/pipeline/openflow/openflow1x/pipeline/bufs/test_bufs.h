@@ -28,5 +28,6 @@ void bufs_apply_output_action_both_tables_goto(void);
 void bufs_apply_output_action_both_tables_bis_goto(void);
 void bufs_output_first_table_output_on_group_second_table(void);
 void bufs_output_all(void);
+void bufs_shared_group_copy_on_write(void);
 
 #endif //__TEST_BUFS_H__
@@ -34,7 +34,8 @@ int main(int args, char** argv){
 		(CU_add_test(bufs_suite,"Output action(apply) on both tables\n", bufs_apply_output_action_both_tables_goto)==NULL) ||
 		(CU_add_test(bufs_suite,"Two output actions (apply) on first able, one in the second table\n", bufs_apply_output_action_both_tables_goto)==NULL) ||
 		(CU_add_test(bufs_suite,"Output (apply) o first table, output action on an indirect group in second table\n",bufs_output_first_table_output_on_group_second_table)==NULL) ||
-		(CU_add_test(bufs_suite,"Output on apply and group on first table, output on apply, group and write actions(output and group again) on the second table (write set on the first table)\n",bufs_output_all)==NULL)
+		(CU_add_test(bufs_suite,"Output on apply and group on first table, output on apply, group and write actions(output and group again) on the second table (write set on the first table)\n",bufs_output_all)==NULL) ||
+		(CU_add_test(bufs_suite,"Group(type ALL) with a bucket rewriting the shared packet (copy-on-write)\n",bufs_shared_group_copy_on_write)==NULL)
 	){
 		fprintf(stderr,"ERROR WHILE ADDING TEST\n");
 		CU_cleanup_registry();
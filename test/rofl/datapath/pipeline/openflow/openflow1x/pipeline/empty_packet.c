@@ -58,7 +58,15 @@ void platform_packet_set_ppp_proto(datapacket_t* pkt, uint16_t proto){}
 void platform_packet_set_gtp_msg_type(datapacket_t* pkt, uint8_t msg_type){}
 void platform_packet_set_gtp_teid(datapacket_t* pkt, uint32_t teid){}
 void platform_packet_output(datapacket_t* pkt, switch_port_t* port){}
+void platform_packet_output_multi(datapacket_t* pkt, switch_port_t** ports, unsigned int num_of_ports){
+	unsigned int i;
+	//Account the transmission, so that tests can check the ports
+	for(i=0;i<num_of_ports;i++)
+		switch_port_stats_inc(ports[i], 0, 1, 0, 0, 0, 0);
+}
 datapacket_t* platform_packet_replicate(datapacket_t* pkt){return NULL;}
+datapacket_t* platform_packet_replicate_shared(datapacket_t* pkt){return NULL;}
+rofl_result_t platform_packet_make_writable(datapacket_t* pkt){return ROFL_SUCCESS;}
 void platform_packet_drop(datapacket_t* pkt){}
 void platform_packet_set_ipv6_src(datapacket_t * pkt, uint128__t ipv6_src){}
 void platform_packet_set_ipv6_dst(datapacket_t * pkt, uint128__t ipv6_dst){}
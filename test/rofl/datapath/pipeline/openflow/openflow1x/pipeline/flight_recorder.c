@@ -0,0 +1,210 @@
+#include <stdio.h>
+#include <string.h>
+#include "CUnit/Basic.h"
+#include "flight_recorder.h"
+
+static of1x_switch_t* sw=NULL;
+static of1x_flight_record_t records[2*OF1X_FLIGHT_RECORDER_SLOTS];
+
+int fr_set_up(void){
+	enum of1x_matching_algorithm_available ma_list[2]={of1x_matching_algorithm_loop, of1x_matching_algorithm_loop};
+
+	sw = of1x_init_switch("Recorder switch", OF_VERSION_13, 0x0601, 2, ma_list);
+	if(!sw)
+		return -1;
+	return 0;
+}
+
+int fr_tear_down(void){
+	__of1x_destroy_switch(sw);
+	return 0;
+}
+
+//Packet headers are all zero (empty platform packet)
+static void fr_process(void){
+	datapacket_t pkt;
+
+	memset(&pkt, 0, sizeof(pkt));
+	of_process_packet_pipeline((of_switch_t*)sw, &pkt);
+}
+
+void fr_verdicts_test(void){
+	wrap_uint_t field;
+	of1x_flow_entry_t* entries[2];
+	of1x_flow_entry_t* deleting_entry;
+	of1x_action_group_t *apply_actions, *bucket_actions;
+	of1x_write_actions_t* write_actions;
+	of1x_bucket_list_t* buckets = of1x_init_bucket_list();
+
+	//Not enabled
+	CU_ASSERT(of1x_get_flight_records(sw->pipeline, records, 1) == 0);
+	CU_ASSERT(of1x_clear_flight_recorder(sw->pipeline) == ROFL_FAILURE);
+
+	//Table 0: goto table 1
+	entries[0] = of1x_init_flow_entry(NULL, NULL, false);
+	entries[0]->cookie = 0x11;
+	of1x_add_instruction_to_group(&entries[0]->inst_grp, OF1X_IT_GOTO_TABLE, NULL, NULL, NULL, 1);
+	CU_ASSERT(of1x_add_flow_entry_table(sw->pipeline, 0, entries[0], false, false) == ROFL_OF1X_FM_SUCCESS);
+
+	//Table 1: output FLOOD
+	field.u32 = OF1X_PORT_FLOOD;
+	write_actions = of1x_init_write_actions();
+	of1x_set_packet_action_on_write_actions(write_actions, of1x_init_packet_action(OF1X_AT_OUTPUT, field, NULL, NULL));
+	entries[1] = of1x_init_flow_entry(NULL, NULL, false);
+	entries[1]->cookie = 0x22;
+	of1x_add_instruction_to_group(&entries[1]->inst_grp, OF1X_IT_WRITE_ACTIONS, NULL, write_actions, NULL, 0);
+	CU_ASSERT(of1x_add_flow_entry_table(sw->pipeline, 1, entries[1], false, false) == ROFL_OF1X_FM_SUCCESS);
+
+	CU_ASSERT(of1x_set_flight_recorder(sw->pipeline, 1) == ROFL_SUCCESS);
+
+	//Matched in both tables
+	fr_process();
+	CU_ASSERT(of1x_get_flight_records(sw->pipeline, records, 2*OF1X_FLIGHT_RECORDER_SLOTS) == 1);
+	CU_ASSERT(records[0].seq == 1);
+	CU_ASSERT(records[0].verdict == OF1X_FLIGHT_OUTPUT);
+	CU_ASSERT(records[0].num_of_hops == 2);
+	CU_ASSERT(records[0].hops[0].table_id == 0 && records[0].hops[0].matched && records[0].hops[0].entry == entries[0] && records[0].hops[0].cookie == 0x11);
+	CU_ASSERT(records[0].hops[1].table_id == 1 && records[0].hops[1].matched && records[0].hops[1].entry == entries[1] && records[0].hops[1].cookie == 0x22);
+	CU_ASSERT(records[0].group_id == OF1X_FLIGHT_RECORDER_NO_GROUP);
+	CU_ASSERT(records[0].num_of_outputs == 1);
+	CU_ASSERT(records[0].output_port == OF1X_PORT_FLOOD);
+
+	//Table 1: group 1 instead
+	deleting_entry = of1x_init_flow_entry(NULL, NULL, false);
+	CU_ASSERT(of1x_remove_flow_entry_table(sw->pipeline, 1, deleting_entry, NOT_STRICT, OF1X_PORT_ANY, OF1X_GROUP_ANY) == ROFL_SUCCESS);
+	of1x_destroy_flow_entry(deleting_entry);
+
+	bucket_actions = of1x_init_action_group(0);
+	of1x_push_packet_action_to_group(bucket_actions, of1x_init_packet_action(OF1X_AT_OUTPUT, field, NULL, NULL));
+	of1x_insert_bucket_in_list(buckets, of1x_init_bucket(0, 0, 0, bucket_actions));
+	CU_ASSERT(of1x_group_add(sw->pipeline->groups, OF1X_GROUP_TYPE_INDIRECT, 1, buckets) == ROFL_OF1X_GM_OK);
+
+	field.u32 = 1;
+	apply_actions = of1x_init_action_group(0);
+	of1x_push_packet_action_to_group(apply_actions, of1x_init_packet_action(OF1X_AT_GROUP, field, NULL, NULL));
+	entries[1] = of1x_init_flow_entry(NULL, NULL, false);
+	of1x_add_instruction_to_group(&entries[1]->inst_grp, OF1X_IT_APPLY_ACTIONS, apply_actions, NULL, NULL, 0);
+	CU_ASSERT(of1x_add_flow_entry_table(sw->pipeline, 1, entries[1], false, false) == ROFL_OF1X_FM_SUCCESS);
+
+	CU_ASSERT(of1x_clear_flight_recorder(sw->pipeline) == ROFL_SUCCESS);
+	fr_process();
+	CU_ASSERT(of1x_get_flight_records(sw->pipeline, records, 2*OF1X_FLIGHT_RECORDER_SLOTS) == 1);
+	CU_ASSERT(records[0].seq == 2);
+	CU_ASSERT(records[0].num_of_hops == 2);
+	CU_ASSERT(records[0].group_id == 1);
+	CU_ASSERT(records[0].bucket == 0);
+
+	//Misses
+	deleting_entry = of1x_init_flow_entry(NULL, NULL, false);
+	CU_ASSERT(of1x_remove_flow_entry_table(sw->pipeline, 0, deleting_entry, NOT_STRICT, OF1X_PORT_ANY, OF1X_GROUP_ANY) == ROFL_SUCCESS);
+	CU_ASSERT(of1x_remove_flow_entry_table(sw->pipeline, 1, deleting_entry, NOT_STRICT, OF1X_PORT_ANY, OF1X_GROUP_ANY) == ROFL_SUCCESS);
+	of1x_destroy_flow_entry(deleting_entry);
+
+	CU_ASSERT(of1x_clear_flight_recorder(sw->pipeline) == ROFL_SUCCESS);
+	fr_process();
+	CU_ASSERT(of1x_get_flight_records(sw->pipeline, records, 2*OF1X_FLIGHT_RECORDER_SLOTS) == 1);
+	CU_ASSERT(records[0].verdict == OF1X_FLIGHT_DROP_END_OF_PIPELINE);
+	CU_ASSERT(records[0].num_of_hops == 2);
+	CU_ASSERT(!records[0].hops[0].matched && !records[0].hops[1].matched);
+	CU_ASSERT(records[0].group_id == OF1X_FLIGHT_RECORDER_NO_GROUP);
+	CU_ASSERT(records[0].num_of_outputs == 0);
+
+	CU_ASSERT(of1x_clear_flight_recorder(sw->pipeline) == ROFL_SUCCESS);
+	sw->pipeline->tables[0].default_action = OF1X_TABLE_MISS_DROP;
+	fr_process();
+	sw->pipeline->tables[0].default_action = OF1X_TABLE_MISS_CONTROLLER;
+	fr_process();
+	CU_ASSERT(of1x_get_flight_records(sw->pipeline, records, 2*OF1X_FLIGHT_RECORDER_SLOTS) == 2);
+	CU_ASSERT(records[0].verdict == OF1X_FLIGHT_DROP_TABLE_MISS || records[1].verdict == OF1X_FLIGHT_DROP_TABLE_MISS);
+	CU_ASSERT(records[0].verdict == OF1X_FLIGHT_PACKET_IN_MISS || records[1].verdict == OF1X_FLIGHT_PACKET_IN_MISS);
+	CU_ASSERT(records[0].num_of_hops == 1 && records[1].num_of_hops == 1);
+
+	//Disabled; records are kept
+	CU_ASSERT(of1x_set_flight_recorder(sw->pipeline, 0) == ROFL_SUCCESS);
+	fr_process();
+	CU_ASSERT(of1x_get_flight_records(sw->pipeline, records, 2*OF1X_FLIGHT_RECORDER_SLOTS) == 2);
+
+	of1x_dump_flight_recorder(sw->pipeline);
+	CU_ASSERT(strcmp(of1x_flight_verdict_str(OF1X_FLIGHT_DROP_METER), "DROP_METER") == 0);
+}
+
+void fr_sampling_test(void){
+	unsigned int i;
+
+	CU_ASSERT(of1x_clear_flight_recorder(sw->pipeline) == ROFL_SUCCESS);
+	CU_ASSERT(of1x_set_flight_recorder(sw->pipeline, 4) == ROFL_SUCCESS);
+
+	//1 out of 4
+	for(i=0;i<40;i++)
+		fr_process();
+	CU_ASSERT(of1x_get_flight_records(sw->pipeline, records, 2*OF1X_FLIGHT_RECORDER_SLOTS) == 10);
+
+	//The ring keeps the most recent ones
+	CU_ASSERT(of1x_set_flight_recorder(sw->pipeline, 1) == ROFL_SUCCESS);
+	for(i=0;i<2*OF1X_FLIGHT_RECORDER_SLOTS;i++)
+		fr_process();
+	CU_ASSERT(of1x_get_flight_records(sw->pipeline, records, 2*OF1X_FLIGHT_RECORDER_SLOTS) == OF1X_FLIGHT_RECORDER_SLOTS);
+	for(i=0;i<OF1X_FLIGHT_RECORDER_SLOTS;i++)
+		CU_ASSERT(records[i].seq > OF1X_FLIGHT_RECORDER_SLOTS+10);
+
+	//Bounded by the caller
+	CU_ASSERT(of1x_get_flight_records(sw->pipeline, records, 5) == 5);
+
+	//A new rate applies right away (the countdowns are restarted)
+	CU_ASSERT(of1x_clear_flight_recorder(sw->pipeline) == ROFL_SUCCESS);
+	CU_ASSERT(of1x_set_flight_recorder(sw->pipeline, 1000) == ROFL_SUCCESS);
+	fr_process();
+	fr_process();
+	CU_ASSERT(of1x_get_flight_records(sw->pipeline, records, 2*OF1X_FLIGHT_RECORDER_SLOTS) == 1);
+	CU_ASSERT(of1x_set_flight_recorder(sw->pipeline, 1) == ROFL_SUCCESS);
+	fr_process();
+	CU_ASSERT(of1x_get_flight_records(sw->pipeline, records, 2*OF1X_FLIGHT_RECORDER_SLOTS) == 2);
+}
+
+void fr_packet_in_limit_test(void){
+	wrap_uint_t field;
+	of1x_action_group_t* apply_actions;
+	of1x_flow_entry_t* entry;
+
+	CU_ASSERT(of1x_set_flight_recorder(sw->pipeline, 1) == ROFL_SUCCESS);
+	CU_ASSERT(of1x_clear_flight_recorder(sw->pipeline) == ROFL_SUCCESS);
+	sw->pipeline->tables[0].default_action = OF1X_TABLE_MISS_CONTROLLER;
+
+	//Bursts of 1 packet-in; the second miss is dropped by the limiter
+	CU_ASSERT(of1x_set_packet_in_limit(sw->pipeline, OF1X_PKT_IN_LIMIT_SWITCH, 0, 1, 1) == ROFL_SUCCESS);
+	fr_process();
+	fr_process();
+	CU_ASSERT(of1x_get_flight_records(sw->pipeline, records, 2*OF1X_FLIGHT_RECORDER_SLOTS) == 2);
+	CU_ASSERT(records[0].verdict == OF1X_FLIGHT_PACKET_IN_MISS || records[1].verdict == OF1X_FLIGHT_PACKET_IN_MISS);
+	CU_ASSERT(records[0].verdict == OF1X_FLIGHT_DROP_PACKET_IN_LIMIT || records[1].verdict == OF1X_FLIGHT_DROP_PACKET_IN_LIMIT);
+
+	//Output to CONTROLLER, still without tokens
+	field.u32 = OF1X_PORT_CONTROLLER;
+	apply_actions = of1x_init_action_group(0);
+	of1x_push_packet_action_to_group(apply_actions, of1x_init_packet_action(OF1X_AT_OUTPUT, field, NULL, NULL));
+	entry = of1x_init_flow_entry(NULL, NULL, false);
+	of1x_add_instruction_to_group(&entry->inst_grp, OF1X_IT_APPLY_ACTIONS, apply_actions, NULL, NULL, 0);
+	CU_ASSERT(of1x_add_flow_entry_table(sw->pipeline, 0, entry, false, false) == ROFL_OF1X_FM_SUCCESS);
+
+	CU_ASSERT(of1x_clear_flight_recorder(sw->pipeline) == ROFL_SUCCESS);
+	fr_process();
+	CU_ASSERT(of1x_get_flight_records(sw->pipeline, records, 2*OF1X_FLIGHT_RECORDER_SLOTS) == 1);
+	CU_ASSERT(records[0].verdict == OF1X_FLIGHT_DROP_PACKET_IN_LIMIT);
+	CU_ASSERT(records[0].num_of_outputs == 0 && records[0].num_of_pkt_in_limited == 1);
+
+	//1s later, admitted
+	__of1x_time_forward(1, 0, NULL);
+	CU_ASSERT(of1x_clear_flight_recorder(sw->pipeline) == ROFL_SUCCESS);
+	fr_process();
+	CU_ASSERT(of1x_get_flight_records(sw->pipeline, records, 2*OF1X_FLIGHT_RECORDER_SLOTS) == 1);
+	CU_ASSERT(records[0].verdict == OF1X_FLIGHT_OUTPUT);
+	CU_ASSERT(records[0].num_of_outputs == 1 && records[0].output_port == OF1X_PORT_CONTROLLER);
+	CU_ASSERT(records[0].num_of_pkt_in_limited == 0);
+
+	CU_ASSERT(strcmp(of1x_flight_verdict_str(OF1X_FLIGHT_DROP_PACKET_IN_LIMIT), "DROP_PACKET_IN_LIMIT") == 0);
+
+	CU_ASSERT(of1x_set_packet_in_limit(sw->pipeline, OF1X_PKT_IN_LIMIT_SWITCH, 0, 0, 0) == ROFL_SUCCESS);
+	entry = of1x_init_flow_entry(NULL, NULL, false);
+	CU_ASSERT(of1x_remove_flow_entry_table(sw->pipeline, 0, entry, NOT_STRICT, OF1X_PORT_ANY, OF1X_GROUP_ANY) == ROFL_SUCCESS);
+	of1x_destroy_flow_entry(entry);
+}
@@ -0,0 +1,16 @@
+#ifndef __FLIGHT_RECORDER_H__
+#define __FLIGHT_RECORDER_H__
+
+#include "rofl.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_flight_recorder.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_packet_in_limiter.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_timers.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/of1x_switch.h"
+
+int fr_set_up(void);
+int fr_tear_down(void);
+void fr_verdicts_test(void);
+void fr_sampling_test(void);
+void fr_packet_in_limit_test(void);
+
+#endif //__FLIGHT_RECORDER_H__
@@ -0,0 +1,303 @@
+#include <stdio.h>
+#include <string.h>
+#include "CUnit/Basic.h"
+#include "group_types.h"
+
+static of1x_group_table_t* gt=NULL;
+
+int gtypes_set_up(void){
+	gt = of1x_init_group_table();
+	if(!gt)
+		return -1;
+	return 0;
+}
+
+int gtypes_tear_down(void){
+	of1x_destroy_group_table(gt);
+	return 0;
+}
+
+static of1x_bucket_t* gtypes_init_bucket(uint16_t weight, uint32_t watch_port, uint32_t watch_group){
+	wrap_uint_t field;
+	of1x_action_group_t* ag = of1x_init_action_group(0);
+	
+	field.u32 = watch_port;
+	of1x_push_packet_action_to_group(ag, of1x_init_packet_action(OF1X_AT_OUTPUT, field, NULL, NULL));
+	return of1x_init_bucket(weight, watch_port, watch_group, ag);
+}
+
+static of1x_bucket_t* gtypes_init_output_bucket(uint16_t weight, uint32_t port_num){
+	return gtypes_init_bucket(weight, port_num, 0);
+}
+
+static unsigned int gtypes_lut_count(of1x_group_t* group, of1x_bucket_t* bucket){
+	unsigned int i, count=0;
+	for(i=0;i<OF1X_GROUP_SELECT_LUT_SIZE;i++){
+		if(group->select_lut[i] == bucket)
+			count++;
+	}
+	return count;
+}
+
+void gtypes_select_lut_test(void){
+	of1x_group_t* group;
+	of1x_bucket_list_t* buckets = of1x_init_bucket_list();
+	of1x_bucket_t *b1, *b2;
+
+	of1x_insert_bucket_in_list(buckets, b1=gtypes_init_output_bucket(3, 1));
+	of1x_insert_bucket_in_list(buckets, b2=gtypes_init_output_bucket(1, 2));
+	CU_ASSERT(of1x_group_add(gt, OF1X_GROUP_TYPE_SELECT, 1, buckets) == ROFL_OF1X_GM_OK);
+	
+	group = __of1x_group_search(gt, 1);
+	CU_ASSERT(group != NULL);
+	CU_ASSERT(group->select_lut != NULL);
+
+	//Slots are proportional to weights
+	CU_ASSERT(gtypes_lut_count(group, b1) == OF1X_GROUP_SELECT_LUT_SIZE*3/4);
+	CU_ASSERT(gtypes_lut_count(group, b2) == OF1X_GROUP_SELECT_LUT_SIZE/4);
+
+	//Modify weights; the table must be rebuilt
+	buckets = of1x_init_bucket_list();
+	of1x_insert_bucket_in_list(buckets, b1=gtypes_init_output_bucket(1, 1));
+	of1x_insert_bucket_in_list(buckets, b2=gtypes_init_output_bucket(1, 2));
+	CU_ASSERT(of1x_group_modify(gt, OF1X_GROUP_TYPE_SELECT, 1, buckets) == ROFL_OF1X_GM_OK);
+	CU_ASSERT(gtypes_lut_count(group, b1) == OF1X_GROUP_SELECT_LUT_SIZE/2);
+	CU_ASSERT(gtypes_lut_count(group, b2) == OF1X_GROUP_SELECT_LUT_SIZE/2);
+}
+
+void gtypes_select_hash_test(void){
+	unsigned int i, hits=0;
+	of1x_packet_matches_t matches;
+	of1x_group_t* group;
+	of1x_bucket_t *b1, *selected;
+	of1x_bucket_list_t* buckets = of1x_init_bucket_list();
+
+	of1x_insert_bucket_in_list(buckets, b1=gtypes_init_output_bucket(3, 1));
+	of1x_insert_bucket_in_list(buckets, gtypes_init_output_bucket(1, 2));
+	CU_ASSERT(of1x_group_add(gt, OF1X_GROUP_TYPE_SELECT, 2, buckets) == ROFL_OF1X_GM_OK);
+	group = __of1x_group_search(gt, 2);
+
+	memset(&matches, 0, sizeof(matches));
+	matches.ipv4_src = 0x0A000001;
+	matches.ipv4_dst = 0x0A000002;
+	matches.ip_proto = 6;
+	matches.tcp_dst = 80;
+
+	//Same flow, same bucket
+	matches.tcp_src = 1024;
+	selected = __of1x_group_select_bucket(group, gt->select_hash_fields, &matches);
+	CU_ASSERT(selected == __of1x_group_select_bucket(group, gt->select_hash_fields, &matches));
+
+	//Flows spread according to the weights (75%)
+	for(i=0;i<10000;i++){
+		matches.tcp_src = 1024+i;
+		if(__of1x_group_select_bucket(group, gt->select_hash_fields, &matches) == b1)
+			hits++;
+	}
+	CU_ASSERT(hits > 7000 && hits < 8000);
+
+	//Ports are not hashed anymore; all the flows share the bucket
+	CU_ASSERT(of1x_set_group_table_select_hash(gt, OF1X_GROUP_SELECT_HASH_IP_SRC | OF1X_GROUP_SELECT_HASH_IP_DST) == ROFL_SUCCESS);
+	selected = __of1x_group_select_bucket(group, gt->select_hash_fields, &matches);
+	for(i=0;i<100;i++){
+		matches.tcp_src = i;
+		CU_ASSERT(selected == __of1x_group_select_bucket(group, gt->select_hash_fields, &matches));
+	}
+	CU_ASSERT(of1x_set_group_table_select_hash(gt, OF1X_GROUP_SELECT_HASH_DEFAULT) == ROFL_SUCCESS);
+}
+
+void gtypes_select_errors_test(void){
+	of1x_bucket_list_t* buckets = of1x_init_bucket_list();
+
+	//SELECT groups need weights
+	of1x_insert_bucket_in_list(buckets, gtypes_init_output_bucket(0, 1));
+	of1x_insert_bucket_in_list(buckets, gtypes_init_output_bucket(0, 2));
+	CU_ASSERT(of1x_group_add(gt, OF1X_GROUP_TYPE_SELECT, 3, buckets) == ROFL_OF1X_GM_INVAL);
+	CU_ASSERT(__of1x_group_search(gt, 3) == NULL);
+	of1x_destroy_bucket_list(buckets);
+
+	CU_ASSERT(of1x_set_group_table_select_hash(gt, 0x0) == ROFL_FAILURE);
+}
+
+void gtypes_ff_liveness_test(void){
+	of1x_switch_t* sw;
+	of1x_group_t* group;
+	of1x_bucket_t *b1, *b2;
+	of1x_bucket_list_t* buckets;
+	switch_port_t *p1, *p2;
+	unsigned int port_num;
+	enum of1x_matching_algorithm_available ma_list=of1x_matching_algorithm_loop;
+
+	sw = of1x_init_switch("FF switch", OF_VERSION_13, 0x0201, 1, &ma_list);
+	CU_ASSERT(sw != NULL);
+	
+	p1 = switch_port_init("ff1", true, PORT_TYPE_VIRTUAL, PORT_STATE_NONE);
+	p2 = switch_port_init("ff2", true, PORT_TYPE_VIRTUAL, PORT_STATE_NONE);
+	CU_ASSERT(__of1x_attach_port_to_switch_at_port_num(sw, 1, p1) == ROFL_SUCCESS);
+	CU_ASSERT(__of1x_attach_port_to_switch(sw, p2, &port_num) == ROFL_SUCCESS);
+	CU_ASSERT(port_num == 2);
+	CU_ASSERT(__of1x_is_port_live(sw, 1) && __of1x_is_port_live(sw, 2));
+
+	buckets = of1x_init_bucket_list();
+	of1x_insert_bucket_in_list(buckets, b1=gtypes_init_bucket(0, 1, OF1X_GROUP_ANY));
+	of1x_insert_bucket_in_list(buckets, b2=gtypes_init_bucket(0, 2, OF1X_GROUP_ANY));
+	CU_ASSERT(of1x_group_add(sw->pipeline->groups, OF1X_GROUP_TYPE_FF, 1, buckets) == ROFL_OF1X_GM_OK);
+	group = __of1x_group_search(sw->pipeline->groups, 1);
+	CU_ASSERT(group != NULL);
+
+	//Primary
+	CU_ASSERT(__of1x_group_ff_bucket(sw, group) == b1);
+
+	//Link down on primary; failover
+	switch_port_update_state(p1, true, PORT_STATE_LINK_DOWN);
+	CU_ASSERT(!__of1x_is_port_live(sw, 1));
+	CU_ASSERT(__of1x_group_ff_bucket(sw, group) == b2);
+
+	//Admin. down on backup; no live bucket
+	switch_port_update_state(p2, false, PORT_STATE_NONE);
+	CU_ASSERT(__of1x_group_ff_bucket(sw, group) == NULL);
+
+	//Primary recovers
+	switch_port_update_state(p1, true, PORT_STATE_LIVE);
+	CU_ASSERT(__of1x_group_ff_bucket(sw, group) == b1);
+
+	//Detached ports are never live
+	CU_ASSERT(__of1x_detach_port_from_switch(sw, p1) == ROFL_SUCCESS);
+	CU_ASSERT(!__of1x_is_port_live(sw, 1));
+	switch_port_update_state(p2, true, PORT_STATE_NONE);
+	CU_ASSERT(__of1x_group_ff_bucket(sw, group) == b2);
+
+	__of1x_detach_all_ports_from_switch(sw);
+	CU_ASSERT(!__of1x_is_port_live(sw, 2));
+
+	__of1x_destroy_switch(sw);
+	switch_port_destroy(p1);
+	switch_port_destroy(p2);
+}
+
+void gtypes_ff_errors_test(void){
+	of1x_bucket_list_t* buckets;
+
+	//Buckets must watch a port
+	buckets = of1x_init_bucket_list();
+	of1x_insert_bucket_in_list(buckets, gtypes_init_bucket(0, OF1X_PORT_ANY, OF1X_GROUP_ANY));
+	CU_ASSERT(of1x_group_add(gt, OF1X_GROUP_TYPE_FF, 10, buckets) == ROFL_OF1X_GM_BWATCH);
+	of1x_destroy_bucket_list(buckets);
+
+	//Watching groups is not supported
+	buckets = of1x_init_bucket_list();
+	of1x_insert_bucket_in_list(buckets, gtypes_init_bucket(0, 1, 2));
+	CU_ASSERT(of1x_group_add(gt, OF1X_GROUP_TYPE_FF, 10, buckets) == ROFL_OF1X_GM_WATCH);
+	of1x_destroy_bucket_list(buckets);
+
+	CU_ASSERT(__of1x_group_search(gt, 10) == NULL);
+}
+
+#define GTYPES_INDEX_NUM_OF_GROUPS 5000
+
+void gtypes_index_test(void){
+	uint32_t id;
+	of1x_switch_t* sw;
+	of1x_group_t* group;
+	of1x_bucket_list_t* buckets;
+	of1x_group_table_t* groups;
+	enum of1x_matching_algorithm_available ma_list=of1x_matching_algorithm_loop;
+
+	sw = of1x_init_switch("Index switch", OF_VERSION_13, 0x0301, 1, &ma_list);
+	CU_ASSERT(sw != NULL);
+	groups = sw->pipeline->groups;
+
+	for(id=1;id<=GTYPES_INDEX_NUM_OF_GROUPS;id++){
+		buckets = of1x_init_bucket_list();
+		of1x_insert_bucket_in_list(buckets, gtypes_init_output_bucket(0, 1));
+		CU_ASSERT(of1x_group_add(groups, OF1X_GROUP_TYPE_INDIRECT, id, buckets) == ROFL_OF1X_GM_OK);
+	}
+	CU_ASSERT(groups->num_of_entries == GTYPES_INDEX_NUM_OF_GROUPS);
+
+	//Duplicates are detected through the index
+	buckets = of1x_init_bucket_list();
+	of1x_insert_bucket_in_list(buckets, gtypes_init_output_bucket(0, 1));
+	CU_ASSERT(of1x_group_add(groups, OF1X_GROUP_TYPE_INDIRECT, 1, buckets) == ROFL_OF1X_GM_EXISTS);
+	of1x_destroy_bucket_list(buckets);
+
+	for(id=1;id<=GTYPES_INDEX_NUM_OF_GROUPS;id++){
+		group = __of1x_group_search(groups, id);
+		CU_ASSERT(group != NULL && group->id == id);
+	}
+	CU_ASSERT(__of1x_group_search(groups, GTYPES_INDEX_NUM_OF_GROUPS+1) == NULL);
+
+	//Delete the odd ones
+	for(id=1;id<=GTYPES_INDEX_NUM_OF_GROUPS;id+=2)
+		CU_ASSERT(of1x_group_delete(sw->pipeline, groups, id) == ROFL_OF1X_GM_OK);
+	CU_ASSERT(groups->num_of_entries == GTYPES_INDEX_NUM_OF_GROUPS/2);
+
+	for(id=1;id<=GTYPES_INDEX_NUM_OF_GROUPS;id++){
+		group = __of1x_group_search(groups, id);
+		if(id%2){
+			CU_ASSERT(group == NULL);
+		}else{
+			CU_ASSERT(group != NULL && group->id == id);
+		}
+	}
+
+	//Delete all
+	CU_ASSERT(of1x_group_delete(sw->pipeline, groups, OF1X_GROUP_ALL) == ROFL_OF1X_GM_OK);
+	CU_ASSERT(groups->num_of_entries == 0);
+	CU_ASSERT(__of1x_group_search(groups, 2) == NULL);
+
+	__of1x_destroy_switch(sw);
+}
+
+void gtypes_stats_test(void){
+	of1x_switch_t* sw;
+	of1x_group_t* group;
+	of1x_bucket_t* bucket;
+	of1x_bucket_list_t* buckets;
+	of1x_stats_group_msg_t* msg;
+	unsigned int i;
+	enum of1x_matching_algorithm_available ma_list=of1x_matching_algorithm_loop;
+
+	sw = of1x_init_switch("Group stats switch", OF_VERSION_13, 0x0302, 1, &ma_list);
+	CU_ASSERT(sw != NULL);
+
+	buckets = of1x_init_bucket_list();
+	of1x_insert_bucket_in_list(buckets, gtypes_init_output_bucket(0, 1));
+	of1x_insert_bucket_in_list(buckets, gtypes_init_output_bucket(0, 2));
+	CU_ASSERT(of1x_group_add(sw->pipeline->groups, OF1X_GROUP_TYPE_ALL, 1, buckets) == ROFL_OF1X_GM_OK);
+	group = __of1x_group_search(sw->pipeline->groups, 1);
+	CU_ASSERT(((uintptr_t)group->stats.cores % ROFL_PIPELINE_CACHE_LINE_SIZE) == 0);
+
+	//Each core counts on its own row
+	__of1x_stats_counter_update(&__of1x_stats_group_row(&group->stats, 0)[OF1X_STATS_GROUP_COLUMN], 100);
+	__of1x_stats_counter_update(&__of1x_stats_group_row(&group->stats, 0)[OF1X_STATS_BUCKET_COLUMN(1)], 100);
+	__of1x_stats_counter_update(&__of1x_stats_group_row(&group->stats, 7)[OF1X_STATS_GROUP_COLUMN], 60);
+	__of1x_stats_counter_update(&__of1x_stats_group_row(&group->stats, 7)[OF1X_STATS_BUCKET_COLUMN(1)], 60);
+	__of1x_stats_counter_update(&__of1x_stats_group_row(&group->stats, ROFL_PIPELINE_MAX_CORES-1)[OF1X_STATS_BUCKET_COLUMN(0)], 40);
+
+	msg = of1x_get_group_stats(sw->pipeline, 1);
+	CU_ASSERT(msg != NULL);
+	CU_ASSERT(msg->packet_count == 2 && msg->byte_count == 160);
+	CU_ASSERT(msg->num_of_buckets == 2);
+	CU_ASSERT(msg->bucket_stats[0].packet_count == 1 && msg->bucket_stats[0].byte_count == 40);
+	CU_ASSERT(msg->bucket_stats[1].packet_count == 2 && msg->bucket_stats[1].byte_count == 160);
+	of1x_destroy_stats_group_msg(msg);
+
+	//New buckets start from 0; the group counters are kept
+	buckets = of1x_init_bucket_list();
+	for(i=0;i<5;i++)
+		of1x_insert_bucket_in_list(buckets, gtypes_init_output_bucket(0, i+1));
+	CU_ASSERT(of1x_group_modify(sw->pipeline->groups, OF1X_GROUP_TYPE_ALL, 1, buckets) == ROFL_SUCCESS);
+
+	for(bucket=group->bc_list->head, i=0; bucket; bucket=bucket->next, i++)
+		CU_ASSERT(bucket->index == i);
+
+	msg = of1x_get_group_stats(sw->pipeline, 1);
+	CU_ASSERT(msg != NULL);
+	CU_ASSERT(msg->packet_count == 2 && msg->byte_count == 160);
+	CU_ASSERT(msg->num_of_buckets == 5);
+	for(i=0;i<5;i++)
+		CU_ASSERT(msg->bucket_stats[i].packet_count == 0 && msg->bucket_stats[i].byte_count == 0);
+	of1x_destroy_stats_group_msg(msg);
+
+	__of1x_destroy_switch(sw);
+}
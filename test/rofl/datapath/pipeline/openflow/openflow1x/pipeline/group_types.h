@@ -0,0 +1,21 @@
+#ifndef __GROUP_TYPES_H__
+#define __GROUP_TYPES_H__
+
+#include "rofl.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_group_table.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_action.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/of1x_switch.h"
+#include "rofl/datapath/pipeline/switch_port.h"
+#include "rofl/datapath/pipeline/common/per_core.h"
+
+int gtypes_set_up(void);
+int gtypes_tear_down(void);
+void gtypes_select_lut_test(void);
+void gtypes_select_hash_test(void);
+void gtypes_select_errors_test(void);
+void gtypes_ff_liveness_test(void);
+void gtypes_ff_errors_test(void);
+void gtypes_index_test(void);
+void gtypes_stats_test(void);
+
+#endif //__GROUP_TYPES_H__
@@ -0,0 +1,313 @@
+#include "adaptive_test.h"
+
+static of1x_switch_t* sw=NULL;
+
+int set_up(){
+
+	physical_switch_init();
+
+	enum of1x_matching_algorithm_available ma_list[4]={of1x_matching_algorithm_adaptive, of1x_matching_algorithm_adaptive,
+	of1x_matching_algorithm_adaptive, of1x_matching_algorithm_adaptive};
+
+	//Create instance
+	sw = of1x_init_switch("Test switch", OF_VERSION_12, 0x0101,4,ma_list);
+
+	if(!sw)
+		return EXIT_FAILURE;
+
+	return EXIT_SUCCESS;
+}
+
+int tear_down(){
+	//Destroy the switch
+	if(__of1x_destroy_switch(sw) != ROFL_SUCCESS)
+		return EXIT_FAILURE;
+
+	return EXIT_SUCCESS;
+}
+
+static void clean_pipeline(of1x_switch_t* sw){
+
+	of1x_flow_entry_t* deleting_entry = of1x_init_flow_entry(NULL, NULL, false);
+
+	CU_ASSERT(deleting_entry != NULL);
+	CU_ASSERT(of1x_remove_flow_entry_table(sw->pipeline, 0, deleting_entry, NOT_STRICT, OF1X_PORT_ANY, OF1X_GROUP_ANY) == ROFL_SUCCESS);
+	CU_ASSERT(sw->pipeline->tables[0].num_of_entries == 0);
+}
+
+static of1x_flow_entry_t* add_ip4_dst(uint32_t priority, uint32_t value, uint32_t mask){
+
+	of1x_flow_entry_t* entry = of1x_init_flow_entry(NULL, NULL, false);
+
+	CU_ASSERT(entry != NULL);
+	entry->priority = priority;
+	CU_ASSERT(of1x_add_match_to_entry(entry,of1x_init_ip4_dst_match(NULL,NULL,value,mask)) == ROFL_SUCCESS);
+	CU_ASSERT(of1x_add_flow_entry_table(sw->pipeline, 0, entry, false,false) == ROFL_OF1X_FM_SUCCESS);
+
+	return entry;
+}
+
+//Looks up an IPv4/TCP packet; releases the entry
+static of1x_flow_entry_t* lookup(uint32_t ip4_dst, uint16_t tcp_dst, uint8_t dscp){
+
+	of1x_packet_matches_t pkt;
+	of1x_flow_entry_t* entry;
+
+	memset(&pkt, 0, sizeof(pkt));
+	pkt.port_in = 1;
+	pkt.eth_type = OF1X_ETH_TYPE_IPV4;
+	pkt.ip_proto = OF1X_IP_PROTO_TCP;
+	pkt.ipv4_dst = ip4_dst;
+	pkt.tcp_dst = tcp_dst;
+	pkt.ip_dscp = dscp;
+
+	entry = __of1x_find_best_match_table(&sw->pipeline->tables[0], &pkt);
+	if(entry)
+		platform_rwlock_rdunlock(entry->rwlock);
+
+	return entry;
+}
+
+void test_adaptive_strategies(){
+
+	unsigned int i;
+	of1x_adaptive_info_t info;
+	of1x_flow_table_t* table = &sw->pipeline->tables[0];
+	of1x_flow_entry_t *entry, *exact[OF1X_ADAPTIVE_INDEX_MIN_ENTRIES];
+
+	clean_pipeline(sw);
+
+	//Small tables are linear
+	for(i=0;i<OF1X_ADAPTIVE_INDEX_MIN_ENTRIES-1;i++)
+		exact[i] = add_ip4_dst(0, 0x0A000000+i, 0xFFFFFFFF);
+
+	CU_ASSERT(of1x_adaptive_get_info(table, &info) == ROFL_SUCCESS);
+	CU_ASSERT(info.strategy == OF1X_ADAPTIVE_LINEAR);
+	CU_ASSERT(info.num_of_shapes == 1);
+	CU_ASSERT(info.num_of_rebuilds == 0);
+	CU_ASSERT(lookup(0x0A000005, 0, 0) == exact[5]);
+
+	//A single fully masked shape
+	exact[i] = add_ip4_dst(0, 0x0A000000+i, 0xFFFFFFFF);
+	CU_ASSERT(of1x_adaptive_get_info(table, &info) == ROFL_SUCCESS);
+	CU_ASSERT(info.strategy == OF1X_ADAPTIVE_EXACT);
+	CU_ASSERT(info.num_of_rebuilds == 1);
+	CU_ASSERT(info.num_of_switches == 1);
+
+	for(i=0;i<OF1X_ADAPTIVE_INDEX_MIN_ENTRIES;i++)
+		CU_ASSERT(lookup(0x0A000000+i, 0, 0) == exact[i]);
+	CU_ASSERT(lookup(0x0B000000, 0, 0) == NULL);
+
+	//Prefixes of the same field
+	entry = add_ip4_dst(0, 0x0B000000, 0xFFFF0000);
+	CU_ASSERT(of1x_adaptive_get_info(table, &info) == ROFL_SUCCESS);
+	CU_ASSERT(info.strategy == OF1X_ADAPTIVE_LPM);
+	CU_ASSERT(info.num_of_shapes == 2);
+	CU_ASSERT(info.num_of_rebuilds == 1);
+	CU_ASSERT(lookup(0x0B001234, 0, 0) == entry);
+	CU_ASSERT(lookup(0x0A000003, 0, 0) == exact[3]);
+
+	//Mixed shapes
+	entry = of1x_init_flow_entry(NULL, NULL, false);
+	CU_ASSERT(of1x_add_match_to_entry(entry,of1x_init_ip4_dst_match(NULL,NULL,0x0C000000,0xFFFFFFFF)) == ROFL_SUCCESS);
+	CU_ASSERT(of1x_add_match_to_entry(entry,of1x_init_tcp_dst_match(NULL,NULL,80)) == ROFL_SUCCESS);
+	CU_ASSERT(of1x_add_flow_entry_table(sw->pipeline, 0, entry, false,false) == ROFL_OF1X_FM_SUCCESS);
+	CU_ASSERT(of1x_adaptive_get_info(table, &info) == ROFL_SUCCESS);
+	CU_ASSERT(info.strategy == OF1X_ADAPTIVE_TUPLE);
+	CU_ASSERT(info.num_of_shapes == 3);
+	CU_ASSERT(lookup(0x0C000000, 80, 0) == entry);
+	CU_ASSERT(lookup(0x0C000000, 81, 0) == NULL);
+
+	//Fields which cannot be hashed
+	entry = of1x_init_flow_entry(NULL, NULL, false);
+	CU_ASSERT(of1x_add_match_to_entry(entry,of1x_init_ip_dscp_match(NULL,NULL,10)) == ROFL_SUCCESS);
+	CU_ASSERT(of1x_add_flow_entry_table(sw->pipeline, 0, entry, false,false) == ROFL_OF1X_FM_SUCCESS);
+	CU_ASSERT(of1x_adaptive_get_info(table, &info) == ROFL_SUCCESS);
+	CU_ASSERT(info.strategy == OF1X_ADAPTIVE_TUPLE);
+	CU_ASSERT(info.num_of_residual == 1);
+	CU_ASSERT(lookup(0x0D000000, 0, 10) == entry);
+
+	//Back to linear once the table shrinks
+	for(i=0;i<OF1X_ADAPTIVE_INDEX_MIN_ENTRIES;i++){
+		CU_ASSERT(of1x_remove_flow_entry_table(sw->pipeline, 0, exact[i], STRICT, OF1X_PORT_ANY, OF1X_GROUP_ANY) == ROFL_SUCCESS);
+	}
+	CU_ASSERT(of1x_adaptive_get_info(table, &info) == ROFL_SUCCESS);
+	CU_ASSERT(info.strategy == OF1X_ADAPTIVE_LINEAR);
+	CU_ASSERT(info.num_of_shapes == 2);
+	CU_ASSERT(lookup(0x0D000000, 0, 10) == entry);
+	CU_ASSERT(lookup(0x0A000003, 0, 0) == NULL);
+
+	clean_pipeline(sw);
+	CU_ASSERT(of1x_adaptive_get_info(table, &info) == ROFL_SUCCESS);
+	CU_ASSERT(info.num_of_shapes == 0);
+	CU_ASSERT(info.num_of_residual == 0);
+}
+
+void test_adaptive_lookup_priority(){
+
+	unsigned int i;
+	of1x_adaptive_info_t info;
+	of1x_flow_table_t* table = &sw->pipeline->tables[0];
+	of1x_flow_entry_t *low, *high, *residual, *entry;
+
+	clean_pipeline(sw);
+
+	for(i=0;i<2*OF1X_ADAPTIVE_INDEX_MIN_ENTRIES;i++)
+		add_ip4_dst(10, 0x0A000000+i, 0xFFFFFFFF);
+
+	//Less specific, but higher priority
+	high = add_ip4_dst(20, 0x0A000000, 0xFFFFFF00);
+	low = add_ip4_dst(5, 0x0A000000, 0xFF000000);
+
+	CU_ASSERT(of1x_adaptive_get_info(table, &info) == ROFL_SUCCESS);
+	CU_ASSERT(info.strategy == OF1X_ADAPTIVE_LPM);
+
+	CU_ASSERT(lookup(0x0A000005, 0, 0) == high);
+	CU_ASSERT(lookup(0x0A000105, 0, 0) == low);
+	CU_ASSERT(lookup(0x0A0000FF, 0, 0) == high);
+
+	//Residual entry above all
+	residual = of1x_init_flow_entry(NULL, NULL, false);
+	residual->priority = 30;
+	CU_ASSERT(of1x_add_match_to_entry(residual,of1x_init_ip_dscp_match(NULL,NULL,5)) == ROFL_SUCCESS);
+	CU_ASSERT(of1x_add_flow_entry_table(sw->pipeline, 0, residual, false,false) == ROFL_OF1X_FM_SUCCESS);
+	CU_ASSERT(lookup(0x0A000005, 0, 5) == residual);
+	CU_ASSERT(lookup(0x0A000005, 0, 6) == high);
+
+	//Same priority; more matches first (as in loop)
+	entry = of1x_init_flow_entry(NULL, NULL, false);
+	entry->priority = 20;
+	CU_ASSERT(of1x_add_match_to_entry(entry,of1x_init_ip4_dst_match(NULL,NULL,0x0A000005,0xFFFFFFFF)) == ROFL_SUCCESS);
+	CU_ASSERT(of1x_add_match_to_entry(entry,of1x_init_tcp_dst_match(NULL,NULL,22)) == ROFL_SUCCESS);
+	CU_ASSERT(of1x_add_flow_entry_table(sw->pipeline, 0, entry, false,false) == ROFL_OF1X_FM_SUCCESS);
+	CU_ASSERT(lookup(0x0A000005, 22, 0) == entry);
+	CU_ASSERT(lookup(0x0A000005, 23, 0) == high);
+
+	clean_pipeline(sw);
+}
+
+void test_adaptive_migration(){
+
+	unsigned int i;
+	of1x_adaptive_info_t info;
+	of1x_flow_table_t* table = &sw->pipeline->tables[0];
+	of1x_flow_entry_t* results[256];
+
+	clean_pipeline(sw);
+
+	for(i=0;i<64;i++)
+		add_ip4_dst(i%4, 0x0A000000+(i<<4), 0xFFFFFFF0 << (i%3));
+
+	CU_ASSERT(of1x_adaptive_get_info(table, &info) == ROFL_SUCCESS);
+	CU_ASSERT(info.strategy != OF1X_ADAPTIVE_LINEAR);
+	for(i=0;i<256;i++)
+		results[i] = lookup(0x0A000000+(i<<2), 0, 0);
+
+	//Loop must yield the same entries
+	CU_ASSERT(of1x_set_table_matching_algorithm(sw->pipeline, 0, of1x_matching_algorithm_loop) == ROFL_SUCCESS);
+	CU_ASSERT(table->matching_algorithm == of1x_matching_algorithm_loop);
+	CU_ASSERT(of1x_adaptive_get_info(table, &info) == ROFL_FAILURE);
+	for(i=0;i<256;i++)
+		CU_ASSERT(lookup(0x0A000000+(i<<2), 0, 0) == results[i]);
+
+	//And back (index built from the list)
+	CU_ASSERT(of1x_set_table_matching_algorithm(sw->pipeline, 0, of1x_matching_algorithm_adaptive) == ROFL_SUCCESS);
+	CU_ASSERT(of1x_adaptive_get_info(table, &info) == ROFL_SUCCESS);
+	CU_ASSERT(info.strategy != OF1X_ADAPTIVE_LINEAR);
+	CU_ASSERT(info.num_of_rebuilds == 1);
+	CU_ASSERT(table->num_of_entries == 64);
+	for(i=0;i<256;i++)
+		CU_ASSERT(lookup(0x0A000000+(i<<2), 0, 0) == results[i]);
+
+	clean_pipeline(sw);
+}
+
+//Misses everything
+static of1x_flow_entry_t* find_nothing(of1x_flow_table_t *const table, of1x_packet_matches_t *const pkt){
+	return NULL;
+}
+
+void test_adaptive_shadow_lookup(){
+
+	unsigned int i;
+	of1x_shadow_stats_t stats;
+	rofl_result_t (*migrate_build_hook)(of1x_flow_table_t *const table);
+	of1x_flow_entry_t* (*find_best_match_hook)(of1x_flow_table_t *const table, of1x_packet_matches_t *const pkt);
+
+	clean_pipeline(sw);
+
+	for(i=0;i<64;i++)
+		add_ip4_dst(i%4, 0x0A000000+(i<<4), 0xFFFFFFF0 << (i%3));
+
+	CU_ASSERT(of1x_get_table_shadow_stats(sw->pipeline, 0, &stats) == ROFL_SUCCESS);
+	CU_ASSERT(stats.sample_rate == 0);
+	CU_ASSERT(stats.lookups == 0);
+	CU_ASSERT(of1x_set_table_shadow_lookup(sw->pipeline, sw->pipeline->num_of_tables, 1) == ROFL_FAILURE);
+
+	//Algorithms not keeping table->entries are rejected
+	migrate_build_hook = of1x_matching_algorithms[of1x_matching_algorithm_adaptive].migrate_build_hook;
+	of1x_matching_algorithms[of1x_matching_algorithm_adaptive].migrate_build_hook = NULL;
+	CU_ASSERT(of1x_set_table_shadow_lookup(sw->pipeline, 0, 1) == ROFL_FAILURE);
+	CU_ASSERT(of1x_set_table_shadow_lookup(sw->pipeline, 0, 0) == ROFL_SUCCESS);
+	of1x_matching_algorithms[of1x_matching_algorithm_adaptive].migrate_build_hook = migrate_build_hook;
+	CU_ASSERT(of1x_get_table_shadow_stats(sw->pipeline, 0, &stats) == ROFL_SUCCESS);
+	CU_ASSERT(stats.sample_rate == 0);
+
+	//Every lookup
+	CU_ASSERT(of1x_set_table_shadow_lookup(sw->pipeline, 0, 1) == ROFL_SUCCESS);
+	for(i=0;i<256;i++)
+		lookup(0x0A000000+(i<<2), 0, 0);
+
+	CU_ASSERT(of1x_get_table_shadow_stats(sw->pipeline, 0, &stats) == ROFL_SUCCESS);
+	CU_ASSERT(stats.sample_rate == 1);
+	CU_ASSERT(stats.lookups == 256);
+	CU_ASSERT(stats.mismatches == 0);
+	CU_ASSERT(stats.has_mismatch == false);
+
+	//1 out of 16
+	CU_ASSERT(of1x_set_table_shadow_lookup(sw->pipeline, 0, 16) == ROFL_SUCCESS);
+	for(i=0;i<256;i++)
+		lookup(0x0A000000+(i<<2), 0, 0);
+	CU_ASSERT(of1x_get_table_shadow_stats(sw->pipeline, 0, &stats) == ROFL_SUCCESS);
+	CU_ASSERT(stats.lookups == 256+16);
+	CU_ASSERT(stats.mismatches == 0);
+
+	//A broken algorithm is detected
+	find_best_match_hook = of1x_matching_algorithms[of1x_matching_algorithm_adaptive].find_best_match_hook;
+	of1x_matching_algorithms[of1x_matching_algorithm_adaptive].find_best_match_hook = find_nothing;
+
+	CU_ASSERT(of1x_set_table_shadow_lookup(sw->pipeline, 0, 1) == ROFL_SUCCESS);
+	CU_ASSERT(lookup(0x0A000010, 0, 0) == NULL);
+	CU_ASSERT(lookup(0x0B000000, 0, 0) == NULL);
+
+	of1x_matching_algorithms[of1x_matching_algorithm_adaptive].find_best_match_hook = find_best_match_hook;
+
+	CU_ASSERT(of1x_get_table_shadow_stats(sw->pipeline, 0, &stats) == ROFL_SUCCESS);
+	CU_ASSERT(stats.lookups == 256+16+2);
+	CU_ASSERT(stats.mismatches == 1);
+	CU_ASSERT(stats.has_mismatch == true);
+	CU_ASSERT(stats.last_mismatch.ipv4_dst == 0x0A000010);
+
+	//Disabled
+	CU_ASSERT(of1x_set_table_shadow_lookup(sw->pipeline, 0, 0) == ROFL_SUCCESS);
+	lookup(0x0A000010, 0, 0);
+	CU_ASSERT(of1x_get_table_shadow_stats(sw->pipeline, 0, &stats) == ROFL_SUCCESS);
+	CU_ASSERT(stats.sample_rate == 0);
+	CU_ASSERT(stats.lookups == 256+16+2);
+	CU_ASSERT(stats.mismatches_logged == 1);
+
+	//Mismatches are counted, but only logged once per interval
+	of1x_matching_algorithms[of1x_matching_algorithm_adaptive].find_best_match_hook = find_nothing;
+	CU_ASSERT(of1x_set_table_shadow_lookup(sw->pipeline, 0, 1) == ROFL_SUCCESS);
+	lookup(0x0A000010, 0, 0);
+	lookup(0x0A000014, 0, 0);
+	CU_ASSERT(of1x_set_table_shadow_lookup(sw->pipeline, 0, 0) == ROFL_SUCCESS);
+	of1x_matching_algorithms[of1x_matching_algorithm_adaptive].find_best_match_hook = find_best_match_hook;
+
+	CU_ASSERT(of1x_get_table_shadow_stats(sw->pipeline, 0, &stats) == ROFL_SUCCESS);
+	CU_ASSERT(stats.mismatches == 3);
+	CU_ASSERT(stats.mismatches_logged == 1);
+	CU_ASSERT(((uintptr_t)sw->pipeline->tables[0].shadow_cores % ROFL_PIPELINE_CACHE_LINE_SIZE) == 0);
+
+	clean_pipeline(sw);
+}
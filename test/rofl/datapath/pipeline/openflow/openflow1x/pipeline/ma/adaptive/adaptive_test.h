@@ -0,0 +1,28 @@
+#ifndef ADAPTIVE_TEST
+#define ADAPTIVE_TEST
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <CUnit/Basic.h>
+
+#include "rofl/datapath/pipeline/physical_switch.h"
+#include "rofl/datapath/pipeline/platform/lock.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/of1x_switch.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_match.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_flow_entry.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_flow_table.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/matching_algorithms/matching_algorithms_available.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/matching_algorithms/adaptive/of1x_adaptive_match.h"
+
+/* Setup/teardown */
+int set_up(void);
+int tear_down(void);
+
+/* Test cases */
+void test_adaptive_strategies(void);
+void test_adaptive_lookup_priority(void);
+void test_adaptive_migration(void);
+void test_adaptive_shadow_lookup(void);
+
+#endif
@@ -0,0 +1,53 @@
+/*
+ * Platform allocators accounting the memory in use (see bench_memory_in_use())
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+
+//Keeps 16 byte alignment
+#define BENCH_MEM_HDR 16
+
+static volatile int64_t bench_mem_in_use = 0;
+
+static inline void* bench_malloc(size_t length){
+	uint8_t* data = (uint8_t*)malloc(length + BENCH_MEM_HDR);
+
+	if(!data)
+		return NULL;
+
+	*(size_t*)data = length;
+	__sync_add_and_fetch(&bench_mem_in_use, (int64_t)length);
+	return data + BENCH_MEM_HDR;
+}
+
+static inline void bench_free(void* data){
+	uint8_t* hdr;
+
+	if(!data)
+		return;
+
+	hdr = (uint8_t*)data - BENCH_MEM_HDR;
+	__sync_sub_and_fetch(&bench_mem_in_use, (int64_t)*(size_t*)hdr);
+	free(hdr);
+}
+
+int64_t bench_memory_in_use(void){
+	return bench_mem_in_use;
+}
+
+//Per core memory allocators
+void* platform_malloc( size_t length ){
+	return bench_malloc( length );
+}
+void platform_free( void *data ){
+	bench_free( data );
+}
+
+//Shared memory allocators
+void* platform_malloc_shared( size_t length ){
+	return bench_malloc( length );
+}
+void platform_free_shared( void *data ){
+	bench_free( data );
+}
@@ -0,0 +1,426 @@
+/*
+* Matching algorithm benchmark
+*
+* Runs every registered matching algorithm through its add, lookup and remove
+* hooks with synthetic rule sets (see rule_gen.h), and prints one line per
+* (algorithm, rule set, size) in CSV or JSON (one object per line):
+*
+*  - insert_ops_s, insert_avg_ns, insert_p99_ns: flow mod (add) rate and latency
+*  - lookup_ns_pkt: average lookup time per packet (hit_ratio of the trace matched)
+*  - checksum: digest of the entries matched by the trace; equal across algorithms
+*    unless a lookup returns a different entry
+*  - mem_entry_bytes: memory in use per entry (entries, matches and algorithm state)
+*  - update_avg_ns, update_p99_ns: latency of replacing a rule (remove + add)
+*  - remove_ops_s: rate of removal of all the entries
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "rofl/datapath/pipeline/physical_switch.h"
+#include "rofl/datapath/pipeline/common/slab.h"
+#include "rofl/datapath/pipeline/platform/lock.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/of1x_switch.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_flow_table.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/matching_algorithms/matching_algorithms.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/matching_algorithms/matching_algorithms_available.h"
+
+#include "rule_gen.h"
+
+#define BENCH_MAX_SIZES 16
+#define BENCH_MAX_UPDATES 1000
+
+//bench_memory.c
+int64_t bench_memory_in_use(void);
+
+typedef enum{
+	BENCH_OUTPUT_CSV = 0,
+	BENCH_OUTPUT_JSON = 1,
+}bench_output_t;
+
+typedef struct bench_opts{
+	bool algorithms[of1x_matching_algorithm_count];
+	bool rule_sets[RULE_SET_MAX];
+	unsigned int sizes[BENCH_MAX_SIZES];
+	unsigned int num_of_sizes;
+	unsigned int num_of_pkts;
+	unsigned int iterations;
+	double miss_ratio;
+	uint64_t seed;
+	bench_output_t output;
+}bench_opts_t;
+
+typedef struct bench_result{
+	unsigned int rules;
+	unsigned int errors;
+
+	double insert_ops_s;
+	uint64_t insert_avg_ns;
+	uint64_t insert_p99_ns;
+
+	double lookup_ns_pkt;
+	double hit_ratio;
+	uint64_t checksum;
+
+	int64_t mem_entry_bytes;
+
+	uint64_t update_avg_ns;
+	uint64_t update_p99_ns;
+
+	double remove_ops_s;
+}bench_result_t;
+
+static const char* algorithm_names[] = OF1X_MATCHING_ALGORITHM_NAMES;
+
+static inline uint64_t now_ns(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec*1000000000ULL + ts.tv_nsec;
+}
+
+static int cmp_u64(const void* a, const void* b){
+	uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+	return (x > y) - (x < y);
+}
+
+static void latency_stats(uint64_t* lat, unsigned int num, uint64_t* avg, uint64_t* p99){
+	unsigned int i;
+	uint64_t sum = 0;
+
+	*avg = *p99 = 0;
+	if(!num)
+		return;
+
+	for(i=0;i<num;i++)
+		sum += lat[i];
+	qsort(lat, num, sizeof(uint64_t), cmp_u64);
+
+	*avg = sum/num;
+	*p99 = lat[(num*99)/100 < num? (num*99)/100 : num-1];
+}
+
+//Memory in use, counting slab objects instead of slab pages
+static int64_t memory_footprint(void){
+	unsigned int i;
+	slab_stats_t stats;
+	int64_t bytes = bench_memory_in_use();
+
+	slab_get_stats(&stats);
+	for(i=0;i<SLAB_NUM_OF_CLASSES;i++){
+		bytes -= (int64_t)stats.classes[i].num_of_pages*SLAB_PAGE_SIZE;
+		bytes += (int64_t)stats.classes[i].objs_in_use*stats.classes[i].obj_size;
+	}
+	return bytes;
+}
+
+static rofl_result_t remove_entry(of1x_matching_algorithms_functions_t* maf, of1x_flow_table_t* table, of1x_flow_entry_t* entry){
+	return maf->remove_flow_entry_hook(table, NULL, entry, STRICT, OF1X_PORT_ANY, OF1X_GROUP_ANY, OF1X_FLOW_REMOVE_DELETE, MUTEX_NOT_ACQUIRED);
+}
+
+static rofl_result_t bench_run(enum of1x_matching_algorithm_available ma, rule_set_type_t type, unsigned int size, const bench_opts_t* opts, bench_result_t* res){
+
+	unsigned int i, it, idx, num_of_updates, hits = 0;
+	uint64_t t0, t1, rnd_state = opts->seed + 2;
+	uint64_t* lat = NULL;
+	int64_t mem;
+	rule_set_t* set = NULL;
+	of1x_packet_matches_t* pkts = NULL;
+	of1x_flow_entry_t **entries = NULL, *entry;
+	of1x_switch_t* sw = NULL;
+	of1x_flow_table_t* table;
+	of1x_matching_algorithms_functions_t* maf = &of1x_matching_algorithms[ma];
+	rofl_result_t result = ROFL_FAILURE;
+
+	memset(res, 0, sizeof(bench_result_t));
+	res->rules = size;
+
+	set = rule_set_generate(type, size, opts->seed);
+	pkts = (of1x_packet_matches_t*)malloc(sizeof(of1x_packet_matches_t)*opts->num_of_pkts);
+	entries = (of1x_flow_entry_t**)calloc(size, sizeof(of1x_flow_entry_t*));
+	lat = (uint64_t*)malloc(sizeof(uint64_t)*size);
+
+	if(!set || !pkts || !entries || !lat)
+		goto BENCH_END;
+
+	rule_set_trace(set, pkts, opts->num_of_pkts, opts->miss_ratio, opts->seed + 1);
+
+	if( (sw = of1x_init_switch("bench", OF_VERSION_13, 0xBE7C, 1, &ma)) == NULL)
+		goto BENCH_END;
+	table = &sw->pipeline->tables[0];
+
+	//Insertion
+	mem = memory_footprint();
+
+	for(i=0;i<size;i++){
+		if( (entries[i] = rule_to_flow_entry(&set->rules[i])) == NULL){
+			//Not in the table yet
+			while(i--)
+				of1x_destroy_flow_entry(entries[i]);
+			goto BENCH_END;
+		}
+		entries[i]->cookie = i; //Identifies the rule in the checksum
+	}
+
+	t0 = now_ns();
+	for(i=0;i<size;i++){
+		t1 = now_ns();
+		if(maf->add_flow_entry_hook(table, entries[i], false, false) != ROFL_OF1X_FM_SUCCESS){
+			res->errors++;
+			entries[i] = NULL;
+		}
+		lat[i] = now_ns() - t1;
+	}
+	res->insert_ops_s = size*1e9/(double)(now_ns() - t0);
+	latency_stats(lat, size, &res->insert_avg_ns, &res->insert_p99_ns);
+
+	res->mem_entry_bytes = (memory_footprint() - mem)/size;
+
+	//Lookup (the first pass warms up and computes the checksum)
+	for(i=0;i<opts->num_of_pkts;i++){
+		entry = maf->find_best_match_hook(table, &pkts[i]);
+		res->checksum = res->checksum*1099511628211ULL + (entry? entry->cookie + 1 : 0);
+		if(entry){
+			hits++;
+			platform_rwlock_rdunlock(entry->rwlock);
+		}
+	}
+	res->hit_ratio = (double)hits/opts->num_of_pkts;
+
+	t0 = now_ns();
+	for(it=0;it<opts->iterations;it++){
+		for(i=0;i<opts->num_of_pkts;i++){
+			entry = maf->find_best_match_hook(table, &pkts[i]);
+			if(entry)
+				platform_rwlock_rdunlock(entry->rwlock);
+		}
+	}
+	res->lookup_ns_pkt = (double)(now_ns() - t0)/((double)opts->num_of_pkts*opts->iterations);
+
+	//Updates; replace random rules
+	num_of_updates = size/10;
+	if(num_of_updates > BENCH_MAX_UPDATES)
+		num_of_updates = BENCH_MAX_UPDATES;
+	if(!num_of_updates)
+		num_of_updates = 1;
+
+	for(i=0;i<num_of_updates;i++){
+		idx = (unsigned int)(rule_gen_rand(&rnd_state) % size);
+		if( (entry = rule_to_flow_entry(&set->rules[idx])) == NULL)
+			goto BENCH_END;
+		entry->cookie = idx;
+
+		t1 = now_ns();
+		if(entries[idx] && remove_entry(maf, table, entries[idx]) != ROFL_SUCCESS)
+			res->errors++;
+		if(maf->add_flow_entry_hook(table, entry, false, false) != ROFL_OF1X_FM_SUCCESS){
+			res->errors++;
+			entry = NULL;
+		}
+		lat[i] = now_ns() - t1;
+		entries[idx] = entry;
+	}
+	latency_stats(lat, num_of_updates, &res->update_avg_ns, &res->update_p99_ns);
+
+	//Removal
+	t0 = now_ns();
+	for(i=0;i<size;i++){
+		if(entries[i] && remove_entry(maf, table, entries[i]) != ROFL_SUCCESS)
+			res->errors++;
+		entries[i] = NULL;
+	}
+	res->remove_ops_s = size*1e9/(double)(now_ns() - t0);
+
+	if(table->num_of_entries)
+		res->errors++;
+
+	result = ROFL_SUCCESS;
+
+BENCH_END:
+	if(sw)
+		__of1x_destroy_switch(sw);
+	free(lat);
+	free(entries);
+	free(pkts);
+	rule_set_destroy(set);
+
+	return result;
+}
+
+/*
+* Output
+*/
+static void print_header(const bench_opts_t* opts){
+	if(opts->output == BENCH_OUTPUT_CSV)
+		fprintf(stdout, "algorithm,rule_set,rules,packets,insert_ops_s,insert_avg_ns,insert_p99_ns,lookup_ns_pkt,hit_ratio,checksum,mem_entry_bytes,update_avg_ns,update_p99_ns,remove_ops_s,errors\n");
+}
+
+static void print_result(const char* algorithm, const char* rule_set, const bench_opts_t* opts, const bench_result_t* res){
+
+	if(opts->output == BENCH_OUTPUT_CSV){
+		fprintf(stdout, "%s,%s,%u,%u,%.0f,%"PRIu64",%"PRIu64",%.1f,%.4f,%016"PRIx64",%"PRId64",%"PRIu64",%"PRIu64",%.0f,%u\n",
+			algorithm, rule_set, res->rules, opts->num_of_pkts,
+			res->insert_ops_s, res->insert_avg_ns, res->insert_p99_ns,
+			res->lookup_ns_pkt, res->hit_ratio, res->checksum,
+			res->mem_entry_bytes,
+			res->update_avg_ns, res->update_p99_ns,
+			res->remove_ops_s, res->errors);
+	}else{
+		fprintf(stdout, "{\"algorithm\":\"%s\",\"rule_set\":\"%s\",\"rules\":%u,\"packets\":%u,\"insert_ops_s\":%.0f,\"insert_avg_ns\":%"PRIu64",\"insert_p99_ns\":%"PRIu64",\"lookup_ns_pkt\":%.1f,\"hit_ratio\":%.4f,\"checksum\":\"%016"PRIx64"\",\"mem_entry_bytes\":%"PRId64",\"update_avg_ns\":%"PRIu64",\"update_p99_ns\":%"PRIu64",\"remove_ops_s\":%.0f,\"errors\":%u}\n",
+			algorithm, rule_set, res->rules, opts->num_of_pkts,
+			res->insert_ops_s, res->insert_avg_ns, res->insert_p99_ns,
+			res->lookup_ns_pkt, res->hit_ratio, res->checksum,
+			res->mem_entry_bytes,
+			res->update_avg_ns, res->update_p99_ns,
+			res->remove_ops_s, res->errors);
+	}
+	fflush(stdout);
+}
+
+/*
+* Options
+*/
+static void usage(const char* name){
+	unsigned int i;
+
+	fprintf(stderr, "Usage: %s [-a algorithms] [-r rule sets] [-n sizes] [-p packets] [-i iterations] [-m miss ratio] [-s seed] [-j]\n", name);
+	fprintf(stderr, "  -a  comma separated list of algorithms (default all):");
+	for(i=0;i<of1x_matching_algorithm_count;i++)
+		fprintf(stderr, " %s", algorithm_names[i]);
+	fprintf(stderr, "\n  -r  comma separated list of rule sets (default all):");
+	for(i=0;i<RULE_SET_MAX;i++)
+		fprintf(stderr, " %s", rule_set_name(i));
+	fprintf(stderr, "\n  -n  comma separated list of table sizes (default 100,1000,5000)\n");
+	fprintf(stderr, "  -p  packets of the trace (default 20000)\n");
+	fprintf(stderr, "  -i  lookup passes over the trace (default 3)\n");
+	fprintf(stderr, "  -m  ratio of packets not generated from a rule (default 0.1)\n");
+	fprintf(stderr, "  -s  seed of the rule sets and traces (default 1)\n");
+	fprintf(stderr, "  -j  JSON output (one object per line); CSV otherwise\n");
+}
+
+static rofl_result_t parse_list(char* arg, bool* selected, unsigned int num, const char* (*name)(unsigned int)){
+	char *tok, *save = NULL;
+	unsigned int i;
+
+	memset(selected, 0, sizeof(bool)*num);
+
+	for(tok = strtok_r(arg, ",", &save); tok; tok = strtok_r(NULL, ",", &save)){
+		for(i=0;i<num;i++){
+			if(strcmp(tok, name(i)) == 0)
+				break;
+		}
+		if(i == num){
+			fprintf(stderr, "Unknown name '%s'\n", tok);
+			return ROFL_FAILURE;
+		}
+		selected[i] = true;
+	}
+	return ROFL_SUCCESS;
+}
+
+static const char* algorithm_name(unsigned int i){
+	return algorithm_names[i];
+}
+
+static const char* rule_set_name_idx(unsigned int i){
+	return rule_set_name((rule_set_type_t)i);
+}
+
+static rofl_result_t parse_sizes(char* arg, bench_opts_t* opts){
+	char *tok, *save = NULL;
+
+	opts->num_of_sizes = 0;
+	for(tok = strtok_r(arg, ",", &save); tok; tok = strtok_r(NULL, ",", &save)){
+		if(opts->num_of_sizes == BENCH_MAX_SIZES || atoi(tok) <= 0)
+			return ROFL_FAILURE;
+		opts->sizes[opts->num_of_sizes++] = atoi(tok);
+	}
+	return opts->num_of_sizes? ROFL_SUCCESS : ROFL_FAILURE;
+}
+
+int main(int argc, char** argv){
+
+	int opt, ret = EXIT_SUCCESS;
+	unsigned int ma, type, i;
+	bench_opts_t opts;
+	bench_result_t res;
+
+	//Defaults
+	memset(&opts, 0, sizeof(opts));
+	memset(opts.algorithms, true, sizeof(opts.algorithms));
+	memset(opts.rule_sets, true, sizeof(opts.rule_sets));
+	opts.sizes[0] = 100;
+	opts.sizes[1] = 1000;
+	opts.sizes[2] = 5000;
+	opts.num_of_sizes = 3;
+	opts.num_of_pkts = 20000;
+	opts.iterations = 3;
+	opts.miss_ratio = 0.1;
+	opts.seed = 1;
+
+	while( (opt = getopt(argc, argv, "a:r:n:p:i:m:s:jh")) != -1){
+		switch(opt){
+			case 'a':
+				if(parse_list(optarg, opts.algorithms, of1x_matching_algorithm_count, algorithm_name) != ROFL_SUCCESS)
+					return EXIT_FAILURE;
+				break;
+			case 'r':
+				if(parse_list(optarg, opts.rule_sets, RULE_SET_MAX, rule_set_name_idx) != ROFL_SUCCESS)
+					return EXIT_FAILURE;
+				break;
+			case 'n':
+				if(parse_sizes(optarg, &opts) != ROFL_SUCCESS){
+					usage(argv[0]);
+					return EXIT_FAILURE;
+				}
+				break;
+			case 'p': opts.num_of_pkts = atoi(optarg); break;
+			case 'i': opts.iterations = atoi(optarg); break;
+			case 'm': opts.miss_ratio = atof(optarg); break;
+			case 's': opts.seed = strtoull(optarg, NULL, 0); break;
+			case 'j': opts.output = BENCH_OUTPUT_JSON; break;
+			default:
+				usage(argv[0]);
+				return (opt == 'h')? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+
+	if(!opts.num_of_pkts || !opts.iterations || opts.miss_ratio < 0.0 || opts.miss_ratio > 1.0){
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if(physical_switch_init() != ROFL_SUCCESS){
+		fprintf(stderr, "Unable to initialize the physical switch\n");
+		return EXIT_FAILURE;
+	}
+
+	print_header(&opts);
+
+	for(ma=0;ma<of1x_matching_algorithm_count;ma++){
+		if(!opts.algorithms[ma])
+			continue;
+
+		for(type=0;type<RULE_SET_MAX;type++){
+			if(!opts.rule_sets[type])
+				continue;
+
+			for(i=0;i<opts.num_of_sizes;i++){
+				if(bench_run((enum of1x_matching_algorithm_available)ma, (rule_set_type_t)type, opts.sizes[i], &opts, &res) != ROFL_SUCCESS){
+					fprintf(stderr, "Benchmark of %s with %u %s rules failed\n", algorithm_names[ma], opts.sizes[i], rule_set_name(type));
+					ret = EXIT_FAILURE;
+					continue;
+				}
+				print_result(algorithm_names[ma], rule_set_name(type), &opts, &res);
+				if(res.errors)
+					ret = EXIT_FAILURE;
+			}
+		}
+	}
+
+	physical_switch_destroy();
+
+	return ret;
+}
@@ -0,0 +1,330 @@
+#include "rule_gen.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_match.h"
+
+#define RULE_GEN_MAX_PRIORITY 0xFFFF
+
+//Number of /16 blocks the prefixes are drawn from (nesting, as in ClassBench seeds)
+#define RULE_GEN_NUM_OF_BLOCKS 64
+
+static const uint16_t common_ports[] = { 80, 443, 53, 22, 25, 110, 143, 123, 161, 389, 993, 995, 3306, 5060, 8080, 8443 };
+#define RULE_GEN_NUM_OF_PORTS (sizeof(common_ports)/sizeof(common_ports[0]))
+
+static const char* rule_set_names[RULE_SET_MAX] = { "acl", "fw", "ipc", "l2", "lpm" };
+
+const char* rule_set_name(rule_set_type_t type){
+	if(type >= RULE_SET_MAX)
+		return "unknown";
+	return rule_set_names[type];
+}
+
+uint64_t rule_gen_rand(uint64_t* state){
+	uint64_t x = *state;
+
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	*state = x;
+	return x * 0x2545F4914F6CDD1DULL;
+}
+
+static inline unsigned int rnd(uint64_t* state, unsigned int max){
+	return (unsigned int)(rule_gen_rand(state) % max);
+}
+
+static inline uint32_t prefix_mask(uint8_t len){
+	return len? 0xFFFFFFFF << (32-len) : 0x0;
+}
+
+/*
+* Key set, to discard duplicated rules
+*/
+typedef struct key_set{
+	uint64_t* keys;
+	unsigned int size;
+}key_set_t;
+
+static bool key_set_init(key_set_t* set, unsigned int num_of_keys){
+	for(set->size = 1; set->size < num_of_keys*2; set->size <<= 1);
+	set->keys = (uint64_t*)calloc(set->size, sizeof(uint64_t));
+	return set->keys != NULL;
+}
+
+//Returns false if already present (key 0 is reserved)
+static bool key_set_insert(key_set_t* set, uint64_t key){
+	unsigned int i = (unsigned int)((key * 0x9E3779B97F4A7C15ULL) >> 32) & (set->size-1);
+
+	if(!key)
+		return false;
+
+	for(; set->keys[i]; i = (i+1) & (set->size-1)){
+		if(set->keys[i] == key)
+			return false;
+	}
+	set->keys[i] = key;
+	return true;
+}
+
+/*
+* Rules
+*/
+static uint32_t random_prefix(uint64_t* state, const uint32_t* blocks, uint8_t len){
+	uint32_t addr = blocks[rnd(state, RULE_GEN_NUM_OF_BLOCKS)] | (uint32_t)(rule_gen_rand(state) & 0xFFFF);
+	return addr & prefix_mask(len);
+}
+
+static uint8_t acl_dst_len(uint64_t* state){
+	unsigned int p = rnd(state, 100);
+	if(p < 60) return 32;
+	if(p < 85) return 24 + rnd(state, 8);
+	return 8 + rnd(state, 16);
+}
+
+static uint8_t acl_src_len(uint64_t* state){
+	unsigned int p = rnd(state, 100);
+	if(p < 40) return 0;
+	if(p < 70) return 32;
+	return 8 + rnd(state, 24);
+}
+
+static uint8_t fw_dst_len(uint64_t* state){
+	unsigned int p = rnd(state, 100);
+	if(p < 30) return 0;
+	if(p < 70) return 32;
+	return 8 + rnd(state, 24);
+}
+
+static uint8_t fw_src_len(uint64_t* state){
+	if(rnd(state, 100) < 50)
+		return 0;
+	return 8 + rnd(state, 25);
+}
+
+static uint8_t lpm_len(uint64_t* state){
+	unsigned int p = rnd(state, 100);
+	if(p < 55) return 24;
+	if(p < 85) return 16 + rnd(state, 8);
+	if(p < 95) return 25 + rnd(state, 8);
+	return 8 + rnd(state, 8);
+}
+
+static void fill_transport(uint64_t* state, rule_t* rule, unsigned int wildcard_proto, unsigned int exact_dst, unsigned int exact_src){
+	unsigned int p = rnd(state, 100);
+
+	if(p < wildcard_proto)
+		return;
+
+	rule->fields |= RULE_IP_PROTO;
+	rule->ip_proto = (p < wildcard_proto + (100-wildcard_proto)*3/4)? OF1X_IP_PROTO_TCP : OF1X_IP_PROTO_UDP;
+
+	if(rnd(state, 100) < exact_dst){
+		rule->fields |= RULE_DST_PORT;
+		rule->dst_port = (rnd(state, 100) < 80)? common_ports[rnd(state, RULE_GEN_NUM_OF_PORTS)] : 1024 + rnd(state, 64512);
+	}
+	if(rnd(state, 100) < exact_src){
+		rule->fields |= RULE_SRC_PORT;
+		rule->src_port = 1024 + rnd(state, 64512);
+	}
+}
+
+rule_set_t* rule_set_generate(rule_set_type_t type, unsigned int num_of_rules, uint64_t seed){
+
+	unsigned int i;
+	uint32_t blocks[RULE_GEN_NUM_OF_BLOCKS];
+	uint64_t state = seed? seed : 0x5EED;
+	key_set_t keys;
+	rule_set_t* set;
+	rule_t* rule;
+
+	if(type >= RULE_SET_MAX || !num_of_rules)
+		return NULL;
+
+	//Priorities of ordered sets must be unique
+	if(type != RULE_SET_L2 && type != RULE_SET_LPM && num_of_rules > RULE_GEN_MAX_PRIORITY)
+		return NULL;
+
+	set = (rule_set_t*)calloc(1, sizeof(rule_set_t));
+	if(!set)
+		return NULL;
+	set->type = type;
+	set->num_of_rules = num_of_rules;
+	set->rules = (rule_t*)calloc(num_of_rules, sizeof(rule_t));
+
+	if(!set->rules || !key_set_init(&keys, num_of_rules)){
+		rule_set_destroy(set);
+		return NULL;
+	}
+
+	for(i=0;i<RULE_GEN_NUM_OF_BLOCKS;i++)
+		blocks[i] = (uint32_t)(rule_gen_rand(&state) & 0xFFFF0000);
+
+	for(i=0;i<num_of_rules;i++){
+		rule = &set->rules[i];
+
+		switch(type){
+			case RULE_SET_ACL:
+				rule->priority = num_of_rules - i;
+				rule->ip_dst_len = acl_dst_len(&state);
+				rule->ip_src_len = acl_src_len(&state);
+				fill_transport(&state, rule, 5, 80, 10);
+				break;
+			case RULE_SET_FW:
+				rule->priority = num_of_rules - i;
+				rule->ip_dst_len = fw_dst_len(&state);
+				rule->ip_src_len = fw_src_len(&state);
+				fill_transport(&state, rule, 40, 50, 20);
+				break;
+			case RULE_SET_IPC:
+				rule->priority = num_of_rules - i;
+				rule->ip_dst_len = rnd(&state, 2)? acl_dst_len(&state) : fw_dst_len(&state);
+				rule->ip_src_len = rnd(&state, 2)? acl_src_len(&state) : fw_src_len(&state);
+				if(rnd(&state, 100) < 30){
+					rule->fields |= RULE_IN_PORT;
+					rule->in_port = 1 + rnd(&state, 48);
+				}
+				fill_transport(&state, rule, 30, 60, 15);
+				break;
+			case RULE_SET_L2:
+				rule->priority = 100;
+				rule->fields = RULE_ETH_DST;
+				do{
+					rule->eth_dst = rule_gen_rand(&state) & 0xFEFFFFFFFFFFULL; //unicast
+				}while(!key_set_insert(&keys, rule->eth_dst));
+				continue;
+			case RULE_SET_LPM:
+				rule->fields = RULE_IP_DST;
+				do{
+					rule->ip_dst_len = lpm_len(&state);
+					rule->ip_dst = random_prefix(&state, blocks, rule->ip_dst_len);
+				}while(!key_set_insert(&keys, ((uint64_t)rule->ip_dst_len << 32) | rule->ip_dst));
+				rule->priority = rule->ip_dst_len;
+				continue;
+			default:
+				break;
+		}
+
+		if(rule->ip_dst_len){
+			rule->fields |= RULE_IP_DST;
+			rule->ip_dst = random_prefix(&state, blocks, rule->ip_dst_len);
+		}
+		if(rule->ip_src_len){
+			rule->fields |= RULE_IP_SRC;
+			rule->ip_src = random_prefix(&state, blocks, rule->ip_src_len);
+		}
+	}
+
+	free(keys.keys);
+
+	return set;
+}
+
+void rule_set_destroy(rule_set_t* set){
+	if(!set)
+		return;
+	free(set->rules);
+	free(set);
+}
+
+/*
+* Flow entries
+*/
+of1x_flow_entry_t* rule_to_flow_entry(const rule_t* rule){
+
+	of1x_flow_entry_t* entry = of1x_init_flow_entry(NULL, NULL, false);
+
+	if(!entry)
+		return NULL;
+
+	entry->priority = rule->priority;
+
+	if(rule->fields & RULE_IN_PORT)
+		of1x_add_match_to_entry(entry, of1x_init_port_in_match(NULL, NULL, rule->in_port));
+	if(rule->fields & RULE_ETH_DST)
+		of1x_add_match_to_entry(entry, of1x_init_eth_dst_match(NULL, NULL, rule->eth_dst, 0xFFFFFFFFFFFFULL));
+
+	if(rule->fields & (RULE_IP_SRC|RULE_IP_DST|RULE_IP_PROTO))
+		of1x_add_match_to_entry(entry, of1x_init_eth_type_match(NULL, NULL, OF1X_ETH_TYPE_IPV4));
+	if(rule->fields & RULE_IP_SRC)
+		of1x_add_match_to_entry(entry, of1x_init_ip4_src_match(NULL, NULL, rule->ip_src, prefix_mask(rule->ip_src_len)));
+	if(rule->fields & RULE_IP_DST)
+		of1x_add_match_to_entry(entry, of1x_init_ip4_dst_match(NULL, NULL, rule->ip_dst, prefix_mask(rule->ip_dst_len)));
+
+	if(rule->fields & RULE_IP_PROTO)
+		of1x_add_match_to_entry(entry, of1x_init_ip_proto_match(NULL, NULL, rule->ip_proto));
+	if(rule->fields & RULE_SRC_PORT){
+		if(rule->ip_proto == OF1X_IP_PROTO_TCP)
+			of1x_add_match_to_entry(entry, of1x_init_tcp_src_match(NULL, NULL, rule->src_port));
+		else
+			of1x_add_match_to_entry(entry, of1x_init_udp_src_match(NULL, NULL, rule->src_port));
+	}
+	if(rule->fields & RULE_DST_PORT){
+		if(rule->ip_proto == OF1X_IP_PROTO_TCP)
+			of1x_add_match_to_entry(entry, of1x_init_tcp_dst_match(NULL, NULL, rule->dst_port));
+		else
+			of1x_add_match_to_entry(entry, of1x_init_udp_dst_match(NULL, NULL, rule->dst_port));
+	}
+
+	return entry;
+}
+
+/*
+* Traces
+*/
+static inline uint32_t in_prefix(uint64_t* state, uint32_t prefix, uint8_t len){
+	return (prefix & prefix_mask(len)) | ((uint32_t)rule_gen_rand(state) & ~prefix_mask(len));
+}
+
+void rule_set_trace(const rule_set_t* set, of1x_packet_matches_t* pkts, unsigned int num_of_pkts, double miss_ratio, uint64_t seed){
+
+	unsigned int i;
+	uint64_t state = seed? seed : 0x7ACE;
+	uint16_t src_port, dst_port;
+	of1x_packet_matches_t* pkt;
+	const rule_t* rule;
+
+	for(i=0;i<num_of_pkts;i++){
+		pkt = &pkts[i];
+		memset(pkt, 0, sizeof(of1x_packet_matches_t));
+
+		//Random header; may still hit wildcarded rules
+		pkt->port_in = pkt->phy_port_in = 1 + rnd(&state, 48);
+		pkt->eth_dst = rule_gen_rand(&state) & 0xFEFFFFFFFFFFULL;
+		pkt->eth_src = rule_gen_rand(&state) & 0xFEFFFFFFFFFFULL;
+		pkt->eth_type = OF1X_ETH_TYPE_IPV4;
+		pkt->ipv4_src = (uint32_t)rule_gen_rand(&state);
+		pkt->ipv4_dst = (uint32_t)rule_gen_rand(&state);
+		pkt->ip_proto = rnd(&state, 4)? OF1X_IP_PROTO_TCP : OF1X_IP_PROTO_UDP;
+		src_port = 1024 + rnd(&state, 64512);
+		dst_port = common_ports[rnd(&state, RULE_GEN_NUM_OF_PORTS)];
+
+		if((double)rnd(&state, 1000000) >= miss_ratio*1000000){
+			rule = &set->rules[rnd(&state, set->num_of_rules)];
+
+			if(rule->fields & RULE_IN_PORT)
+				pkt->port_in = pkt->phy_port_in = rule->in_port;
+			if(rule->fields & RULE_ETH_DST)
+				pkt->eth_dst = rule->eth_dst;
+			if(rule->fields & RULE_IP_SRC)
+				pkt->ipv4_src = in_prefix(&state, rule->ip_src, rule->ip_src_len);
+			if(rule->fields & RULE_IP_DST)
+				pkt->ipv4_dst = in_prefix(&state, rule->ip_dst, rule->ip_dst_len);
+			if(rule->fields & RULE_IP_PROTO)
+				pkt->ip_proto = rule->ip_proto;
+			if(rule->fields & RULE_SRC_PORT)
+				src_port = rule->src_port;
+			if(rule->fields & RULE_DST_PORT)
+				dst_port = rule->dst_port;
+		}
+
+		if(pkt->ip_proto == OF1X_IP_PROTO_TCP){
+			pkt->tcp_src = src_port;
+			pkt->tcp_dst = dst_port;
+		}else{
+			pkt->udp_src = src_port;
+			pkt->udp_dst = dst_port;
+		}
+		pkt->pkt_size_bytes = 64;
+	}
+}
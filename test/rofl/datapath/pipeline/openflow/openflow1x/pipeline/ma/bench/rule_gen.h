@@ -0,0 +1,71 @@
+#ifndef RULE_GEN_H
+#define RULE_GEN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_flow_entry.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_packet_matches.h"
+
+/*
+* ClassBench-style synthetic rule sets and packet traces. Rules and traces
+* only depend on the seed, so that results are comparable across runs.
+*
+* OpenFlow has no port ranges; ports are either exact or wildcarded.
+*/
+
+typedef enum{
+	RULE_SET_ACL = 0,	//Access control lists; specific dst prefixes and ports
+	RULE_SET_FW = 1,	//Firewalls; many wildcarded fields
+	RULE_SET_IPC = 2,	//IP chains; mix of both
+	RULE_SET_L2 = 3,	//MAC learning table; exact eth_dst
+	RULE_SET_LPM = 4,	//Routing table; ip_dst prefixes, priority = prefix length
+	RULE_SET_MAX
+}rule_set_type_t;
+
+//Fields present in a rule
+#define RULE_IN_PORT	0x01
+#define RULE_ETH_DST	0x02
+#define RULE_IP_SRC	0x04
+#define RULE_IP_DST	0x08
+#define RULE_IP_PROTO	0x10
+#define RULE_SRC_PORT	0x20
+#define RULE_DST_PORT	0x40
+
+typedef struct rule{
+	uint32_t priority;
+	uint32_t fields;
+
+	uint32_t in_port;
+	uint64_t eth_dst;
+	uint32_t ip_src;
+	uint8_t ip_src_len;
+	uint32_t ip_dst;
+	uint8_t ip_dst_len;
+	uint8_t ip_proto;
+	uint16_t src_port;
+	uint16_t dst_port;
+}rule_t;
+
+typedef struct rule_set{
+	rule_set_type_t type;
+	unsigned int num_of_rules;
+	rule_t* rules;
+}rule_set_t;
+
+const char* rule_set_name(rule_set_type_t type);
+
+//Generates num_of_rules unique rules; returns NULL on failure
+rule_set_t* rule_set_generate(rule_set_type_t type, unsigned int num_of_rules, uint64_t seed);
+void rule_set_destroy(rule_set_t* set);
+
+//Creates the flow entry of a rule
+of1x_flow_entry_t* rule_to_flow_entry(const rule_t* rule);
+
+//Fills in num_of_pkts packet headers, (1-miss_ratio) of them matching a random rule
+void rule_set_trace(const rule_set_t* set, of1x_packet_matches_t* pkts, unsigned int num_of_pkts, double miss_ratio, uint64_t seed);
+
+//Random numbers (xorshift64*)
+uint64_t rule_gen_rand(uint64_t* state);
+
+#endif //RULE_GEN_H
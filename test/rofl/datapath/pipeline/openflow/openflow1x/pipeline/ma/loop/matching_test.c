@@ -457,3 +457,269 @@ void test_flow_modify(){
 	//Reupdate with NO-Strict
 
 }
+
+void test_flow_modify_not_strict(){
+
+	unsigned int i;
+	of1x_flow_entry_t* entry, *it;
+	of1x_action_group_t* group;
+	of1x_action_group_t* apply[2];
+	wrap_uint_t field;
+
+	clean_pipeline(sw);
+
+	//Two entries, contained in the modify
+	for(i=0;i<2;i++){
+		entry = of1x_init_flow_entry(NULL, NULL, false); 
+		CU_ASSERT(entry != NULL);
+		entry->priority = 10+i;
+		CU_ASSERT(of1x_add_match_to_entry(entry,of1x_init_ip4_dst_match(NULL,NULL,0x11111100+i, 0xffffffff)) == ROFL_SUCCESS);
+		
+		group = of1x_init_action_group(NULL);
+		field.u16 = 1;
+		of1x_push_packet_action_to_group(group,of1x_init_packet_action(OF1X_AT_OUTPUT,field,NULL,NULL));
+		of1x_add_instruction_to_group(&entry->inst_grp, OF1X_IT_APPLY_ACTIONS, group, NULL, NULL, 0);
+		CU_ASSERT(of1x_add_flow_entry_table(sw->pipeline, 0, entry, true,false) == ROFL_OF1X_FM_SUCCESS);
+	}
+
+	//Wildcarded modify
+	entry = of1x_init_flow_entry(NULL, NULL, false); 
+	CU_ASSERT(entry != NULL);
+	CU_ASSERT(of1x_add_match_to_entry(entry,of1x_init_ip4_dst_match(NULL,NULL,0x11111100, 0xffffff00)) == ROFL_SUCCESS);
+	group = of1x_init_action_group(NULL);
+	of1x_push_packet_action_to_group(group, of1x_init_packet_action(OF1X_AT_SET_FIELD_IP_DSCP, field, NULL,NULL));
+	of1x_add_instruction_to_group(&entry->inst_grp, OF1X_IT_APPLY_ACTIONS, group, NULL, NULL, 0);
+
+	CU_ASSERT(of1x_modify_flow_entry_table(sw->pipeline, 0, entry, NOT_STRICT, false) == ROFL_SUCCESS);
+
+	//Both entries must have been updated, each one with its own actions
+	CU_ASSERT(sw->pipeline->tables[0].num_of_entries == 2);
+	for(i=0, it=sw->pipeline->tables[0].entries; it; it=it->next, i++){
+		apply[i] = it->inst_grp.instructions[OF1X_IT_APPLY_ACTIONS-1].apply_actions;
+		CU_ASSERT(apply[i] != NULL);
+		if(apply[i])
+			CU_ASSERT(apply[i]->head->type == OF1X_AT_SET_FIELD_IP_DSCP);
+	}
+	CU_ASSERT(i == 2);
+	CU_ASSERT(apply[0] != apply[1]);
+
+	clean_pipeline(sw);
+}
+
+void test_flow_stats_matches(){
+
+	of1x_flow_entry_t* entry;
+	of1x_match_group_t matches;
+	of1x_stats_flow_msg_t* msg, *msg2;
+
+	clean_pipeline(sw);
+
+	entry = of1x_init_flow_entry(NULL, NULL, false); 
+	CU_ASSERT(entry != NULL);
+	CU_ASSERT(of1x_add_match_to_entry(entry,of1x_init_ip4_dst_match(NULL,NULL,0x11111111, 0xffffffff)) == ROFL_SUCCESS);
+	CU_ASSERT(of1x_add_flow_entry_table(sw->pipeline, 0, entry, true,false) == ROFL_OF1X_FM_SUCCESS);
+
+	__of1x_init_match_group(&matches);
+
+	//Matches are referenced, not copied
+	msg = of1x_get_flow_stats(sw->pipeline, 0, 0, 0, OF1X_PORT_ANY, OF1X_GROUP_ANY, &matches);
+	msg2 = of1x_get_flow_stats(sw->pipeline, 0, 0, 0, OF1X_PORT_ANY, OF1X_GROUP_ANY, &matches);
+	CU_ASSERT(msg != NULL && msg2 != NULL);
+	CU_ASSERT(msg->num_of_entries == 1);
+	CU_ASSERT(msg->flows_head->matches == entry->matches.head);
+	CU_ASSERT(msg2->flows_head->matches == entry->matches.head);
+
+	//Remove the entry; matches must outlive it
+	clean_pipeline(sw);
+
+	CU_ASSERT(msg->flows_head->matches->type == OF1X_MATCH_IPV4_DST);
+	CU_ASSERT(msg->flows_head->matches->value->value.u32 == 0x11111111);
+	of1x_destroy_stats_flow_msg(msg);
+
+	CU_ASSERT(msg2->flows_head->matches->value->value.u32 == 0x11111111);
+	of1x_destroy_stats_flow_msg(msg2);
+}
+
+void test_flow_stats_cursor(){
+
+	unsigned int i, total, chunks;
+	of1x_flow_entry_t* entry;
+	of1x_match_group_t matches;
+	of1x_stats_flow_cursor_t cursor;
+	of1x_stats_flow_msg_t* msg;
+
+	clean_pipeline(sw);
+
+	//More entries than visited per lock acquisition
+	for(i=0;i<600;i++){
+		entry = of1x_init_flow_entry(NULL, NULL, false); 
+		CU_ASSERT(entry != NULL);
+		CU_ASSERT(of1x_add_match_to_entry(entry,of1x_init_ip4_dst_match(NULL,NULL,0x0A000000+i, 0xffffffff)) == ROFL_SUCCESS);
+		CU_ASSERT(of1x_add_flow_entry_table(sw->pipeline, 0, entry, false,false) == ROFL_OF1X_FM_SUCCESS);
+	}
+
+	__of1x_init_match_group(&matches);
+
+	//All tables, in chunks of 100
+	CU_ASSERT(of1x_init_stats_flow_cursor(sw->pipeline, &cursor, OF1X_FLOW_TABLE_ALL, 0, 0, OF1X_PORT_ANY, OF1X_GROUP_ANY, &matches) == ROFL_SUCCESS);
+	for(total=chunks=0; !cursor.done; chunks++){
+		msg = of1x_get_flow_stats_chunk(sw->pipeline, &cursor, 100);
+		CU_ASSERT(msg != NULL);
+		if(!msg)
+			break;
+		CU_ASSERT(msg->num_of_entries <= 100);
+		total += msg->num_of_entries;
+		of1x_destroy_stats_flow_msg(msg);
+	}
+	CU_ASSERT(total == 600);
+	//Chunks are not cut short at OF1X_STATS_FLOW_CURSOR_MAX_VISITS (the hook is
+	//called again). The 6th fills up as table 0 ends; the empty tables take a 7th
+	CU_ASSERT(chunks == 600/100 + 1);
+
+	//Larger than OF1X_STATS_FLOW_CURSOR_MAX_VISITS; still a single chunk
+	CU_ASSERT(OF1X_STATS_FLOW_CURSOR_MAX_VISITS < 600);
+	CU_ASSERT(of1x_init_stats_flow_cursor(sw->pipeline, &cursor, 0, 0, 0, OF1X_PORT_ANY, OF1X_GROUP_ANY, &matches) == ROFL_SUCCESS);
+	msg = of1x_get_flow_stats_chunk(sw->pipeline, &cursor, 1000);
+	CU_ASSERT(msg != NULL && msg->num_of_entries == 600);
+	CU_ASSERT(cursor.done == true);
+	if(msg)
+		of1x_destroy_stats_flow_msg(msg);
+
+	//Remove entries between chunks; the cursor must not touch removed entries
+	CU_ASSERT(of1x_init_stats_flow_cursor(sw->pipeline, &cursor, 0, 0, 0, OF1X_PORT_ANY, OF1X_GROUP_ANY, &matches) == ROFL_SUCCESS);
+	msg = of1x_get_flow_stats_chunk(sw->pipeline, &cursor, 50);
+	CU_ASSERT(msg != NULL && msg->num_of_entries == 50);
+	of1x_destroy_stats_flow_msg(msg);
+	CU_ASSERT(cursor.done == false);
+
+	//Last entry (not visited yet)
+	for(entry=sw->pipeline->tables[0].entries; entry->next; entry=entry->next)
+		{}
+	CU_ASSERT(__of1x_remove_specific_flow_entry_table(sw->pipeline, 0, entry, OF1X_FLOW_REMOVE_DELETE, MUTEX_NOT_ACQUIRED) == ROFL_SUCCESS);
+
+	for(total=50; !cursor.done;){
+		msg = of1x_get_flow_stats_chunk(sw->pipeline, &cursor, 1000);
+		CU_ASSERT(msg != NULL);
+		if(!msg)
+			break;
+		total += msg->num_of_entries;
+		of1x_destroy_stats_flow_msg(msg);
+	}
+	CU_ASSERT(total == 599);
+
+	//Wrong table
+	CU_ASSERT(of1x_init_stats_flow_cursor(sw->pipeline, &cursor, 10, 0, 0, OF1X_PORT_ANY, OF1X_GROUP_ANY, &matches) == ROFL_FAILURE);
+
+	clean_pipeline(sw);
+}
+
+void test_flow_aggregate_stats(){
+
+	unsigned int i;
+	of1x_flow_entry_t* entry, *it;
+	of1x_match_group_t matches;
+	of1x_stats_flow_aggregate_msg_t *fast, *walk;
+
+	clean_pipeline(sw);
+
+	//Per-core shards start at a cache line
+	CU_ASSERT(((uintptr_t)sw->pipeline->tables[0].stats.cores % ROFL_PIPELINE_CACHE_LINE_SIZE) == 0);
+
+	for(i=0;i<10;i++){
+		entry = of1x_init_flow_entry(NULL, NULL, false); 
+		CU_ASSERT(entry != NULL);
+		CU_ASSERT(of1x_add_match_to_entry(entry,of1x_init_ip4_dst_match(NULL,NULL,0x0A000000+i, 0xffffffff)) == ROFL_SUCCESS);
+		CU_ASSERT(of1x_add_flow_entry_table(sw->pipeline, 0, entry, false,false) == ROFL_OF1X_FM_SUCCESS);
+	}
+
+	//Simulate hits (entry i gets i+1 packets of 100 bytes)
+	for(it=sw->pipeline->tables[0].entries, i=0; it; it=it->next, i++){
+		unsigned int j;
+		for(j=0;j<=i;j++)
+			__of1x_stats_flow_update_match(it, 100);
+	}
+
+	__of1x_init_match_group(&matches);
+
+	//Unfiltered (aggregates) vs filtered (walk; cookie is 0 in all entries)
+	fast = of1x_get_flow_aggregate_stats(sw->pipeline, 0, 0, 0, OF1X_PORT_ANY, OF1X_GROUP_ANY, &matches);
+	walk = of1x_get_flow_aggregate_stats(sw->pipeline, 0, 0, 0x1, OF1X_PORT_ANY, OF1X_GROUP_ANY, &matches);
+	CU_ASSERT(fast != NULL && walk != NULL);
+	CU_ASSERT(fast->flow_count == 10 && walk->flow_count == 10);
+	CU_ASSERT(fast->packet_count == 55 && walk->packet_count == 55);
+	CU_ASSERT(fast->byte_count == 5500 && walk->byte_count == 5500);
+	of1x_destroy_stats_flow_aggregate_msg(fast);
+	of1x_destroy_stats_flow_aggregate_msg(walk);
+
+	//Remove the head; reset the counters of the next one
+	entry = sw->pipeline->tables[0].entries;
+	CU_ASSERT(__of1x_remove_specific_flow_entry_table(sw->pipeline, 0, entry, OF1X_FLOW_REMOVE_DELETE, MUTEX_NOT_ACQUIRED) == ROFL_SUCCESS);
+	__of1x_stats_flow_reset_counts(sw->pipeline->tables[0].entries);
+
+	//Replace an entry keeping its counters
+	entry = of1x_init_flow_entry(NULL, NULL, false); 
+	CU_ASSERT(of1x_add_match_to_entry(entry,of1x_init_ip4_dst_match(NULL,NULL,0x0A000000, 0xffffffff)) == ROFL_SUCCESS);
+	CU_ASSERT(of1x_add_flow_entry_table(sw->pipeline, 0, entry, false,false) == ROFL_OF1X_FM_SUCCESS);
+
+	fast = of1x_get_flow_aggregate_stats(sw->pipeline, OF1X_FLOW_TABLE_ALL, 0, 0, OF1X_PORT_ANY, OF1X_GROUP_ANY, &matches);
+	walk = of1x_get_flow_aggregate_stats(sw->pipeline, OF1X_FLOW_TABLE_ALL, 0, 0x1, OF1X_PORT_ANY, OF1X_GROUP_ANY, &matches);
+	CU_ASSERT(fast != NULL && walk != NULL);
+	CU_ASSERT(fast->flow_count == 9 && walk->flow_count == 9);
+	CU_ASSERT(fast->packet_count == walk->packet_count);
+	CU_ASSERT(fast->byte_count == walk->byte_count);
+	CU_ASSERT(fast->packet_count == 55-1-2);
+	of1x_destroy_stats_flow_aggregate_msg(fast);
+	of1x_destroy_stats_flow_aggregate_msg(walk);
+
+	//Empty table
+	clean_pipeline(sw);
+	fast = of1x_get_flow_aggregate_stats(sw->pipeline, 0, 0, 0, OF1X_PORT_ANY, OF1X_GROUP_ANY, &matches);
+	CU_ASSERT(fast != NULL && fast->flow_count == 0 && fast->packet_count == 0 && fast->byte_count == 0);
+	of1x_destroy_stats_flow_aggregate_msg(fast);
+}
+
+void test_table_migration(){
+
+	unsigned int i;
+	of1x_flow_entry_t* entry, *head;
+	of1x_flow_table_t* table = &sw->pipeline->tables[0];
+	rofl_result_t (*build_hook)(struct of1x_flow_table *const table);
+
+	clean_pipeline(sw);
+
+	for(i=0;i<10;i++){
+		entry = of1x_init_flow_entry(NULL, NULL, false); 
+		CU_ASSERT(entry != NULL);
+		CU_ASSERT(of1x_add_match_to_entry(entry,of1x_init_ip4_dst_match(NULL,NULL,0x0A000000+i, 0xffffffff)) == ROFL_SUCCESS);
+		CU_ASSERT(of1x_add_flow_entry_table(sw->pipeline, 0, entry, false,false) == ROFL_OF1X_FM_SUCCESS);
+	}
+	head = table->entries;
+	__of1x_stats_flow_update_match(head, 100);
+
+	//Rebuild (same algorithm); entries and their state are kept
+	CU_ASSERT(of1x_set_table_matching_algorithm(sw->pipeline, 0, of1x_matching_algorithm_loop) == ROFL_SUCCESS);
+	CU_ASSERT(table->matching_algorithm == of1x_matching_algorithm_loop);
+	CU_ASSERT(table->num_of_entries == 10);
+	CU_ASSERT(table->entries == head);
+	CU_ASSERT(head->stats.packet_count == 1);
+	CU_ASSERT(table->matching_aux[1] == NULL);
+
+	//Wrong table or algorithm
+	CU_ASSERT(of1x_set_table_matching_algorithm(sw->pipeline, 10, of1x_matching_algorithm_loop) == ROFL_FAILURE);
+	CU_ASSERT(of1x_set_table_matching_algorithm(sw->pipeline, 0, of1x_matching_algorithm_count) == ROFL_FAILURE);
+
+	//Algorithms without migration support
+	build_hook = of1x_matching_algorithms[of1x_matching_algorithm_loop].migrate_build_hook;
+	of1x_matching_algorithms[of1x_matching_algorithm_loop].migrate_build_hook = NULL;
+	CU_ASSERT(of1x_set_table_matching_algorithm(sw->pipeline, 0, of1x_matching_algorithm_loop) == ROFL_FAILURE);
+	of1x_matching_algorithms[of1x_matching_algorithm_loop].migrate_build_hook = build_hook;
+
+	//Table still operative
+	CU_ASSERT(table->num_of_entries == 10);
+	entry = of1x_init_flow_entry(NULL, NULL, false); 
+	CU_ASSERT(of1x_add_match_to_entry(entry,of1x_init_ip4_dst_match(NULL,NULL,0x0B000000, 0xffffffff)) == ROFL_SUCCESS);
+	CU_ASSERT(of1x_add_flow_entry_table(sw->pipeline, 0, entry, false,false) == ROFL_OF1X_FM_SUCCESS);
+	CU_ASSERT(table->num_of_entries == 11);
+
+	clean_pipeline(sw);
+}
@@ -9,10 +9,12 @@
 #include <CUnit/Basic.h>
 
 #include "rofl/datapath/pipeline/physical_switch.h"
+#include "rofl/datapath/pipeline/common/per_core.h"
 #include "rofl/datapath/pipeline/openflow/openflow1x/of1x_switch.h"
 #include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_match.h"
 #include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_flow_entry.h"
 #include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_flow_table.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_statistics.h"
 #include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/matching_algorithms/matching_algorithms_available.h"
 #include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/matching_algorithms/loop/of1x_loop_match.h"
 
@@ -27,6 +29,11 @@ void test_uninstall_wildcard(void);
 void test_overlap(void);
 void test_overlap2(void);
 void test_flow_modify(void);
+void test_flow_modify_not_strict(void);
+void test_flow_stats_matches(void);
+void test_flow_stats_cursor(void);
+void test_flow_aggregate_stats(void);
+void test_table_migration(void);
 
 
 #endif
@@ -30,7 +30,12 @@ int main(int args, char** argv){
 	(NULL == CU_add_test(pSuite, "test uninstall wildcard", test_uninstall_wildcard)) || 
 	(NULL == CU_add_test(pSuite, "test check overlap addition", test_overlap)) || 
 	(NULL == CU_add_test(pSuite, "test check overlap addition2", test_overlap2)) || 
-	(NULL == CU_add_test(pSuite, "test flow modify", test_flow_modify)) 
+	(NULL == CU_add_test(pSuite, "test flow modify", test_flow_modify)) ||
+	(NULL == CU_add_test(pSuite, "test flow modify not strict", test_flow_modify_not_strict)) ||
+	(NULL == CU_add_test(pSuite, "test flow stats matches", test_flow_stats_matches)) ||
+	(NULL == CU_add_test(pSuite, "test flow stats cursor", test_flow_stats_cursor)) ||
+	(NULL == CU_add_test(pSuite, "test flow aggregate stats", test_flow_aggregate_stats)) ||
+	(NULL == CU_add_test(pSuite, "test table migration", test_table_migration)) 
 	
 		)
 	{
@@ -0,0 +1,299 @@
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "CUnit/Basic.h"
+#include "meter_table.h"
+
+static of1x_switch_t* sw=NULL;
+
+int mt_set_up(void){
+	enum of1x_matching_algorithm_available ma_list=of1x_matching_algorithm_loop;
+
+	sw = of1x_init_switch("Meter switch", OF_VERSION_13, 0x0401, 1, &ma_list);
+	if(!sw || !sw->pipeline->meters)
+		return -1;
+	return 0;
+}
+
+int mt_tear_down(void){
+	__of1x_destroy_switch(sw);
+	return 0;
+}
+
+static void mt_init_pkt(datapacket_t* pkt, uint32_t size, uint16_t eth_type, uint8_t dscp){
+	memset(pkt, 0, sizeof(datapacket_t));
+	pkt->matches.of1x.pkt_size_bytes = size;
+	pkt->matches.of1x.eth_type = eth_type;
+	pkt->matches.of1x.ip_dscp = dscp;
+}
+
+void mt_mgmt_test(void){
+	of1x_meter_table_t* mt = sw->pipeline->meters;
+	of1x_meter_band_config_t bands[2] = {
+		{ OF1X_METER_BAND_DROP, 1000, 0, 0 },
+		{ OF1X_METER_BAND_DSCP_REMARK, 100, 0, 1 },
+	};
+	of1x_meter_t* meter;
+	of1x_stats_meter_msg_t* msg;
+
+	CU_ASSERT(of1x_meter_add(mt, 1, OF1X_METER_FLAG_KBPS, bands, 2) == ROFL_OF1X_MM_OK);
+	CU_ASSERT(of1x_meter_add(mt, 1, OF1X_METER_FLAG_KBPS, bands, 2) == ROFL_OF1X_MM_EXISTS);
+
+	//Bands are sorted by rate
+	meter = __of1x_meter_search(mt, 1);
+	CU_ASSERT(meter != NULL);
+	CU_ASSERT(meter->config->num_of_bands == 2);
+	CU_ASSERT(meter->config->bands[0].config.rate == 100 && meter->config->bands[1].config.rate == 1000);
+
+	//Errors
+	CU_ASSERT(of1x_meter_add(mt, 0, OF1X_METER_FLAG_KBPS, bands, 2) == ROFL_OF1X_MM_INVAL);
+	CU_ASSERT(of1x_meter_add(mt, OF1X_METER_ALL, OF1X_METER_FLAG_KBPS, bands, 2) == ROFL_OF1X_MM_INVAL);
+	CU_ASSERT(of1x_meter_add(mt, 2, OF1X_METER_FLAG_KBPS | OF1X_METER_FLAG_PKTPS, bands, 2) == ROFL_OF1X_MM_BFLAGS);
+	CU_ASSERT(of1x_meter_add(mt, 2, OF1X_METER_FLAG_BURST, bands, 2) == ROFL_OF1X_MM_BBURST);
+	CU_ASSERT(of1x_meter_add(mt, 2, 0, bands, OF1X_METER_MAX_BANDS+1) == ROFL_OF1X_MM_OBANDS);
+	bands[0].rate = 0;
+	CU_ASSERT(of1x_meter_add(mt, 2, 0, bands, 2) == ROFL_OF1X_MM_BRATE);
+	bands[0].rate = 1000;
+	bands[1].prec_level = 3;
+	CU_ASSERT(of1x_meter_add(mt, 2, 0, bands, 2) == ROFL_OF1X_MM_BBAND_VALUE);
+	bands[1].prec_level = 1;
+	CU_ASSERT(__of1x_meter_search(mt, 2) == NULL);
+
+	//Modify
+	CU_ASSERT(of1x_meter_modify(mt, 2, OF1X_METER_FLAG_KBPS, bands, 1) == ROFL_OF1X_MM_UNKMETER);
+	CU_ASSERT(of1x_meter_modify(mt, 1, OF1X_METER_FLAG_PKTPS, bands, 1) == ROFL_OF1X_MM_OK);
+	CU_ASSERT(meter->config->num_of_bands == 1 && meter->config->flags == OF1X_METER_FLAG_PKTPS);
+
+	//Stats
+	msg = of1x_get_meter_stats(sw->pipeline, 1);
+	CU_ASSERT(msg != NULL && msg->meter_id == 1 && msg->num_of_bands == 1 && msg->packet_in_count == 0);
+	of1x_destroy_stats_meter_msg(msg);
+	CU_ASSERT(of1x_get_meter_stats(sw->pipeline, 2) == NULL);
+
+	//Delete
+	CU_ASSERT(of1x_meter_delete(sw->pipeline, mt, 1) == ROFL_OF1X_MM_OK);
+	CU_ASSERT(__of1x_meter_search(mt, 1) == NULL);
+	CU_ASSERT(mt->num_of_entries == 0);
+}
+
+void mt_drop_band_test(void){
+	of1x_meter_table_t* mt = sw->pipeline->meters;
+	of1x_meter_band_config_t band = { OF1X_METER_BAND_DROP, 10, 5, 0 };
+	of1x_meter_t* meter;
+	of1x_stats_meter_msg_t* msg;
+	datapacket_t pkt;
+	struct timeval now;
+	unsigned int i, passed;
+
+	//10 pkt/s, burst of 5 packets
+	CU_ASSERT(of1x_meter_add(mt, 10, OF1X_METER_FLAG_PKTPS | OF1X_METER_FLAG_BURST | OF1X_METER_FLAG_STATS, &band, 1) == ROFL_OF1X_MM_OK);
+	meter = __of1x_meter_search(mt, 10);
+	CU_ASSERT(meter != NULL);
+
+	mt_init_pkt(&pkt, 100, OF1X_ETH_TYPE_IPV4, 0);
+	for(i=0, passed=0;i<8;i++){
+		if(!__of1x_meter_process_packet(meter, &pkt))
+			passed++;
+	}
+	CU_ASSERT(passed == 5);
+
+	//After 1s the bucket is full again (capped to the burst)
+	__of1x_time_forward(1, 0, &now);
+	for(i=0, passed=0;i<8;i++){
+		if(!__of1x_meter_process_packet(meter, &pkt))
+			passed++;
+	}
+	CU_ASSERT(passed == 5);
+
+	//Counters are aggregated from all cores
+	msg = of1x_get_meter_stats(sw->pipeline, OF1X_METER_ALL);
+	CU_ASSERT(msg != NULL && msg->next == NULL);
+	CU_ASSERT(msg->packet_in_count == 16 && msg->byte_in_count == 1600);
+	CU_ASSERT(msg->band_stats[0].packet_band_count == 6 && msg->band_stats[0].byte_band_count == 600);
+	of1x_destroy_stats_meter_msg(msg);
+
+	CU_ASSERT(of1x_meter_delete(sw->pipeline, mt, OF1X_METER_ALL) == ROFL_OF1X_MM_OK);
+}
+
+void mt_dscp_remark_test(void){
+	of1x_meter_table_t* mt = sw->pipeline->meters;
+	of1x_meter_band_config_t band = { OF1X_METER_BAND_DSCP_REMARK, 8, 1, 1 };
+	of1x_meter_t* meter;
+	datapacket_t pkt;
+
+	//8 kb/s, burst of 1 kb (one 125 byte packet)
+	CU_ASSERT(of1x_meter_add(mt, 20, OF1X_METER_FLAG_KBPS | OF1X_METER_FLAG_BURST, &band, 1) == ROFL_OF1X_MM_OK);
+	meter = __of1x_meter_search(mt, 20);
+
+	//AF11 in profile
+	mt_init_pkt(&pkt, 125, OF1X_ETH_TYPE_IPV4, 10);
+	CU_ASSERT(__of1x_meter_process_packet(meter, &pkt) == false);
+	CU_ASSERT(pkt.matches.of1x.ip_dscp == 10);
+
+	//Out of profile; AF11 -> AF12, never dropped
+	CU_ASSERT(__of1x_meter_process_packet(meter, &pkt) == false);
+	CU_ASSERT(pkt.matches.of1x.ip_dscp == 12);
+
+	//Non AF code points (EF) are left untouched
+	mt_init_pkt(&pkt, 125, OF1X_ETH_TYPE_IPV4, 46);
+	CU_ASSERT(__of1x_meter_process_packet(meter, &pkt) == false);
+	CU_ASSERT(pkt.matches.of1x.ip_dscp == 46);
+
+	CU_ASSERT(of1x_meter_delete(sw->pipeline, mt, 20) == ROFL_OF1X_MM_OK);
+}
+
+void mt_flow_entry_test(void){
+	of1x_meter_table_t* mt = sw->pipeline->meters;
+	of1x_meter_band_config_t band = { OF1X_METER_BAND_DROP, 1000, 0, 0 };
+	of1x_flow_entry_t* entry;
+
+	//Unknown meter
+	entry = of1x_init_flow_entry(NULL, NULL, false);
+	of1x_add_meter_instruction_to_group(&entry->inst_grp, 30);
+	CU_ASSERT(of1x_add_flow_entry_table(sw->pipeline, 0, entry, false, false) != ROFL_OF1X_FM_SUCCESS);
+	of1x_destroy_flow_entry(entry);
+
+	CU_ASSERT(of1x_meter_add(mt, 30, OF1X_METER_FLAG_KBPS, &band, 1) == ROFL_OF1X_MM_OK);
+	entry = of1x_init_flow_entry(NULL, NULL, false);
+	of1x_add_meter_instruction_to_group(&entry->inst_grp, 30);
+	CU_ASSERT(of1x_add_flow_entry_table(sw->pipeline, 0, entry, false, false) == ROFL_OF1X_FM_SUCCESS);
+	CU_ASSERT(sw->pipeline->tables[0].num_of_entries == 1);
+	CU_ASSERT(sw->pipeline->tables[0].entries->inst_grp.instructions[OF1X_SAFE_IT_TYPE_INDEX(OF1X_IT_METER)].meter == __of1x_meter_search(mt, 30));
+
+	//Deleting the meter removes the entries using it
+	CU_ASSERT(of1x_meter_delete(sw->pipeline, mt, 30) == ROFL_OF1X_MM_OK);
+	CU_ASSERT(sw->pipeline->tables[0].num_of_entries == 0);
+}
+
+void mt_modify_counters_test(void){
+	of1x_meter_table_t* mt = sw->pipeline->meters;
+	of1x_meter_band_config_t bands[2] = {
+		{ OF1X_METER_BAND_DROP, 10, 5, 0 },
+		{ OF1X_METER_BAND_DSCP_REMARK, 5, 2, 1 },
+	};
+	of1x_meter_t* meter;
+	of1x_stats_meter_msg_t* msg;
+	datapacket_t pkt;
+	unsigned int i;
+
+	CU_ASSERT(of1x_meter_add(mt, 40, OF1X_METER_FLAG_PKTPS | OF1X_METER_FLAG_BURST, bands, 1) == ROFL_OF1X_MM_OK);
+	meter = __of1x_meter_search(mt, 40);
+
+	//3 packets over the band
+	mt_init_pkt(&pkt, 100, OF1X_ETH_TYPE_IPV4, 0);
+	for(i=0;i<8;i++)
+		__of1x_meter_process_packet(meter, &pkt);
+
+	//The drop band is kept (same type and rate), even if the burst changes
+	bands[0].burst_size = 50;
+	CU_ASSERT(of1x_meter_modify(mt, 40, OF1X_METER_FLAG_PKTPS | OF1X_METER_FLAG_BURST, bands, 2) == ROFL_OF1X_MM_OK);
+
+	msg = of1x_get_meter_stats(sw->pipeline, 40);
+	CU_ASSERT(msg != NULL && msg->num_of_bands == 2);
+	CU_ASSERT(msg->packet_in_count == 8 && msg->byte_in_count == 800);
+	CU_ASSERT(msg->band_stats[0].packet_band_count == 0); //Remark band (lower rate)
+	CU_ASSERT(msg->band_stats[1].packet_band_count == 3 && msg->band_stats[1].byte_band_count == 300);
+	of1x_destroy_stats_meter_msg(msg);
+
+	//A different rate is a new band
+	bands[0].rate = 20;
+	CU_ASSERT(of1x_meter_modify(mt, 40, OF1X_METER_FLAG_PKTPS | OF1X_METER_FLAG_BURST, bands, 1) == ROFL_OF1X_MM_OK);
+	msg = of1x_get_meter_stats(sw->pipeline, 40);
+	CU_ASSERT(msg != NULL && msg->num_of_bands == 1);
+	CU_ASSERT(msg->packet_in_count == 8 && msg->band_stats[0].packet_band_count == 0);
+	of1x_destroy_stats_meter_msg(msg);
+
+	CU_ASSERT(of1x_meter_delete(sw->pipeline, mt, 40) == ROFL_OF1X_MM_OK);
+}
+
+#define MT_THREADS 4
+#define MT_THREAD_PKTS 200000
+
+static of1x_meter_t* mt_concurrent_meter;
+
+static void* mt_concurrent_thread(void* arg){
+	datapacket_t pkt;
+	unsigned int i;
+
+	(void)arg;
+	mt_init_pkt(&pkt, 100, OF1X_ETH_TYPE_IPV4, 10);
+	for(i=0;i<MT_THREAD_PKTS;i++)
+		__of1x_meter_process_packet(mt_concurrent_meter, &pkt);
+	return NULL;
+}
+
+//Bands replaced while packets are being metered
+void mt_concurrent_modify_test(void){
+	of1x_meter_table_t* mt = sw->pipeline->meters;
+	of1x_meter_band_config_t bands[2] = {
+		{ OF1X_METER_BAND_DROP, 1000, 0, 0 },
+		{ OF1X_METER_BAND_DSCP_REMARK, 500, 0, 1 },
+	};
+	of1x_stats_meter_msg_t* msg;
+	pthread_t threads[MT_THREADS];
+	unsigned int i, modifications;
+
+	CU_ASSERT(of1x_meter_add(mt, 50, OF1X_METER_FLAG_PKTPS, bands, 2) == ROFL_OF1X_MM_OK);
+	mt_concurrent_meter = __of1x_meter_search(mt, 50);
+
+	for(i=0;i<MT_THREADS;i++)
+		CU_ASSERT(pthread_create(&threads[i], NULL, mt_concurrent_thread, NULL) == 0);
+
+	for(modifications=0;modifications<500;modifications++){
+		bands[0].rate = 1000 + modifications%2;
+		CU_ASSERT(of1x_meter_modify(mt, 50, OF1X_METER_FLAG_PKTPS, bands, 1 + modifications%2) == ROFL_OF1X_MM_OK);
+	}
+
+	for(i=0;i<MT_THREADS;i++)
+		pthread_join(threads[i], NULL);
+
+	msg = of1x_get_meter_stats(sw->pipeline, 50);
+	CU_ASSERT(msg != NULL && msg->packet_in_count == MT_THREADS*MT_THREAD_PKTS);
+	of1x_destroy_stats_meter_msg(msg);
+
+	CU_ASSERT(of1x_meter_delete(sw->pipeline, mt, 50) == ROFL_OF1X_MM_OK);
+}
+
+#define MT_DELETIONS 2000
+
+static volatile bool mt_deleting;
+
+static void* mt_delete_thread(void* arg){
+	of1x_meter_band_config_t band = { OF1X_METER_BAND_DROP, 1000, 0, 0 };
+	unsigned int i;
+
+	(void)arg;
+	for(i=0;i<MT_DELETIONS;i++){
+		of1x_meter_add(sw->pipeline->meters, 60, OF1X_METER_FLAG_KBPS, &band, 1);
+		of1x_meter_delete(sw->pipeline, sw->pipeline->meters, 60);
+	}
+	mt_deleting = false;
+	return NULL;
+}
+
+//Entries using a meter being deleted concurrently
+void mt_concurrent_delete_test(void){
+	of1x_meter_table_t* mt = sw->pipeline->meters;
+	of1x_meter_band_config_t band = { OF1X_METER_BAND_DROP, 1000, 0, 0 };
+	of1x_flow_entry_t* entry;
+	pthread_t thread;
+
+	mt_deleting = true;
+	CU_ASSERT(pthread_create(&thread, NULL, mt_delete_thread, NULL) == 0);
+
+	while(mt_deleting){
+		entry = of1x_init_flow_entry(NULL, NULL, false);
+		of1x_add_meter_instruction_to_group(&entry->inst_grp, 60);
+		if(of1x_add_flow_entry_table(sw->pipeline, 0, entry, false, false) != ROFL_OF1X_FM_SUCCESS)
+			of1x_destroy_flow_entry(entry);
+	}
+	pthread_join(thread, NULL);
+
+	//No entry survives its meter
+	CU_ASSERT(__of1x_meter_search(mt, 60) == NULL);
+	CU_ASSERT(sw->pipeline->tables[0].num_of_entries == 0);
+
+	//And a new meter can be used again
+	CU_ASSERT(of1x_meter_add(mt, 60, OF1X_METER_FLAG_KBPS, &band, 1) == ROFL_OF1X_MM_OK);
+	CU_ASSERT(of1x_meter_delete(sw->pipeline, mt, 60) == ROFL_OF1X_MM_OK);
+}
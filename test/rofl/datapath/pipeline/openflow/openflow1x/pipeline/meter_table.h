@@ -0,0 +1,19 @@
+#ifndef __METER_TABLE_H__
+#define __METER_TABLE_H__
+
+#include "rofl.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_meter_table.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_timers.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/of1x_switch.h"
+
+int mt_set_up(void);
+int mt_tear_down(void);
+void mt_mgmt_test(void);
+void mt_drop_band_test(void);
+void mt_dscp_remark_test(void);
+void mt_flow_entry_test(void);
+void mt_modify_counters_test(void);
+void mt_concurrent_modify_test(void);
+void mt_concurrent_delete_test(void);
+
+#endif //__METER_TABLE_H__
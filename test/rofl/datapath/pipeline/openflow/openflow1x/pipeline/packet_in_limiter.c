@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <string.h>
+#include "CUnit/Basic.h"
+#include "packet_in_limiter.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_timers.h"
+
+static of1x_switch_t* sw=NULL;
+
+int pil_set_up(void){
+	enum of1x_matching_algorithm_available ma_list[2]={of1x_matching_algorithm_loop, of1x_matching_algorithm_loop};
+
+	sw = of1x_init_switch("Packet-in switch", OF_VERSION_13, 0x0801, 2, ma_list);
+	if(!sw)
+		return -1;
+
+	//Empty tables; table misses go to the controller
+	sw->pipeline->tables[0].default_action = OF1X_TABLE_MISS_CONTROLLER;
+	return 0;
+}
+
+int pil_tear_down(void){
+	__of1x_destroy_switch(sw);
+	return 0;
+}
+
+//Packet headers are all zero (empty platform packet)
+static void pil_process(unsigned int num){
+	datapacket_t pkt;
+
+	while(num--){
+		memset(&pkt, 0, sizeof(pkt));
+		of_process_packet_pipeline((of_switch_t*)sw, &pkt);
+	}
+}
+
+void pil_switch_limit_test(void){
+	of1x_pkt_in_limit_stats_t stats;
+
+	//No limits
+	CU_ASSERT(sw->pipeline->pkt_in_limiter == NULL);
+	CU_ASSERT(of1x_get_packet_in_limit_stats(sw->pipeline, OF1X_PKT_IN_LIMIT_SWITCH, 0, &stats) == ROFL_SUCCESS);
+	CU_ASSERT(stats.rate == 0);
+	pil_process(10);
+
+	//Wrong parameters
+	CU_ASSERT(of1x_set_packet_in_limit(sw->pipeline, OF1X_PKT_IN_LIMIT_SWITCH, 0, 10, 0) == ROFL_FAILURE);
+	CU_ASSERT(of1x_set_packet_in_limit(sw->pipeline, OF1X_PKT_IN_LIMIT_TABLE, 2, 10, 5) == ROFL_FAILURE);
+	CU_ASSERT(of1x_set_packet_in_limit(sw->pipeline, OF1X_PKT_IN_LIMIT_REASON, OF1X_PKT_IN_LIMITER_NUM_REASONS, 10, 5) == ROFL_FAILURE);
+
+	//10 pps, bursts of 5
+	CU_ASSERT(of1x_set_packet_in_limit(sw->pipeline, OF1X_PKT_IN_LIMIT_SWITCH, 0, 10, 5) == ROFL_SUCCESS);
+	pil_process(20);
+
+	of1x_get_packet_in_limit_stats(sw->pipeline, OF1X_PKT_IN_LIMIT_SWITCH, 0, &stats);
+	CU_ASSERT(stats.rate == 10);
+	CU_ASSERT(stats.burst == 5);
+	CU_ASSERT(stats.passed == 5);
+	CU_ASSERT(stats.dropped == 15);
+
+	//200ms later, 2 more tokens
+	__of1x_time_forward(0, 200000, NULL);
+	pil_process(20);
+	of1x_get_packet_in_limit_stats(sw->pipeline, OF1X_PKT_IN_LIMIT_SWITCH, 0, &stats);
+	CU_ASSERT(stats.passed == 7);
+	CU_ASSERT(stats.dropped == 33);
+
+	//Bucket full again (never more than burst)
+	__of1x_time_forward(10, 0, NULL);
+	pil_process(20);
+	of1x_get_packet_in_limit_stats(sw->pipeline, OF1X_PKT_IN_LIMIT_SWITCH, 0, &stats);
+	CU_ASSERT(stats.passed == 12);
+
+	//Removed
+	CU_ASSERT(of1x_set_packet_in_limit(sw->pipeline, OF1X_PKT_IN_LIMIT_SWITCH, 0, 0, 0) == ROFL_SUCCESS);
+	pil_process(20);
+	of1x_get_packet_in_limit_stats(sw->pipeline, OF1X_PKT_IN_LIMIT_SWITCH, 0, &stats);
+	CU_ASSERT(stats.rate == 0);
+	CU_ASSERT(stats.passed == 12);
+}
+
+void pil_table_reason_limit_test(void){
+	datapacket_t pkt;
+	of1x_pkt_in_limit_stats_t stats;
+	unsigned int i, admitted = 0;
+
+	memset(&pkt, 0, sizeof(pkt));
+	__of1x_time_forward(10, 0, NULL);
+
+	CU_ASSERT(of1x_set_packet_in_limit(sw->pipeline, OF1X_PKT_IN_LIMIT_TABLE, 1, 1, 2) == ROFL_SUCCESS);
+	CU_ASSERT(of1x_set_packet_in_limit(sw->pipeline, OF1X_PKT_IN_LIMIT_REASON, OF1X_PKT_IN_ACTION, 1, 3) == ROFL_SUCCESS);
+
+	//Table 0 misses are not limited
+	pil_process(10);
+	of1x_get_packet_in_limit_stats(sw->pipeline, OF1X_PKT_IN_LIMIT_TABLE, 0, &stats);
+	CU_ASSERT(stats.rate == 0);
+	CU_ASSERT(stats.dropped == 0);
+
+	//Table 1, action; the reason tokens of packets dropped by the table limit are returned
+	for(i=0;i<10;i++)
+		admitted += __of1x_packet_in_admit(sw->pipeline, 1, &pkt, OF1X_PKT_IN_ACTION);
+	CU_ASSERT(admitted == 2);
+
+	//Table 0, action; remaining reason token
+	for(i=0;i<10;i++)
+		admitted += __of1x_packet_in_admit(sw->pipeline, 0, &pkt, OF1X_PKT_IN_ACTION);
+	CU_ASSERT(admitted == 3);
+
+	of1x_get_packet_in_limit_stats(sw->pipeline, OF1X_PKT_IN_LIMIT_REASON, OF1X_PKT_IN_ACTION, &stats);
+	CU_ASSERT(stats.passed == 3);
+	CU_ASSERT(stats.dropped == 9);
+	of1x_get_packet_in_limit_stats(sw->pipeline, OF1X_PKT_IN_LIMIT_TABLE, 1, &stats);
+	CU_ASSERT(stats.passed == 2);
+	CU_ASSERT(stats.dropped == 8);
+
+	of1x_set_packet_in_limit(sw->pipeline, OF1X_PKT_IN_LIMIT_TABLE, 1, 0, 0);
+	of1x_set_packet_in_limit(sw->pipeline, OF1X_PKT_IN_LIMIT_REASON, OF1X_PKT_IN_ACTION, 0, 0);
+}
+
+void pil_flow_filter_test(void){
+	datapacket_t pkt;
+
+	memset(&pkt, 0, sizeof(pkt));
+
+	CU_ASSERT(of1x_get_packet_in_flow_filter_suppressed(sw->pipeline) == 0);
+	CU_ASSERT(of1x_set_packet_in_flow_filter(sw->pipeline, 100) == ROFL_SUCCESS);
+
+	//Same flow; suppressed within the window
+	pil_process(10);
+	CU_ASSERT(of1x_get_packet_in_flow_filter_suppressed(sw->pipeline) == 9);
+
+	//Other flows
+	pkt.matches.of1x.port_in = 2;
+	CU_ASSERT(__of1x_packet_in_admit(sw->pipeline, 0, &pkt, OF1X_PKT_IN_NO_MATCH) == true);
+	pkt.matches.of1x.tcp_dst = 80;
+	CU_ASSERT(__of1x_packet_in_admit(sw->pipeline, 0, &pkt, OF1X_PKT_IN_NO_MATCH) == true);
+	CU_ASSERT(__of1x_packet_in_admit(sw->pipeline, 0, &pkt, OF1X_PKT_IN_NO_MATCH) == false);
+
+	//Window expired
+	__of1x_time_forward(1, 0, NULL);
+	CU_ASSERT(__of1x_packet_in_admit(sw->pipeline, 0, &pkt, OF1X_PKT_IN_NO_MATCH) == true);
+	CU_ASSERT(of1x_get_packet_in_flow_filter_suppressed(sw->pipeline) == 10);
+
+	//Disabled
+	CU_ASSERT(of1x_set_packet_in_flow_filter(sw->pipeline, 0) == ROFL_SUCCESS);
+	CU_ASSERT(__of1x_packet_in_admit(sw->pipeline, 0, &pkt, OF1X_PKT_IN_NO_MATCH) == true);
+}
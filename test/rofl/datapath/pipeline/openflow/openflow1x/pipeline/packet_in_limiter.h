@@ -0,0 +1,15 @@
+#ifndef __PACKET_IN_LIMITER_H__
+#define __PACKET_IN_LIMITER_H__
+
+#include "rofl.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_packet_in_limiter.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/of1x_switch.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/of1x_async_events_hooks.h"
+
+int pil_set_up(void);
+int pil_tear_down(void);
+void pil_switch_limit_test(void);
+void pil_table_reason_limit_test(void);
+void pil_flow_filter_test(void);
+
+#endif //__PACKET_IN_LIMITER_H__
@@ -0,0 +1,204 @@
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "CUnit/Basic.h"
+#include "physical_switch_index.h"
+
+#define PSI_MAX_LS 6
+#define PSI_MAX_PHY_PORTS 16
+#define PSI_MAX_VIR_PORTS 4
+#define PSI_MAX_TUN_PORTS 2
+#define PSI_REMOVALS 20000
+
+static volatile bool psi_removing;
+static volatile unsigned int psi_missed;
+
+int psi_set_up(void){
+	physical_switch_config_t config;
+
+	//Replace the physical switch of the previous suites
+	if(__get_physical_switch())
+		physical_switch_destroy();
+
+	memset(&config, 0, sizeof(config));
+	config.max_logical_switches = PSI_MAX_LS;
+	config.max_physical_ports = PSI_MAX_PHY_PORTS;
+	config.max_virtual_ports = PSI_MAX_VIR_PORTS;
+	config.max_tunnel_ports = PSI_MAX_TUN_PORTS;
+
+	if(physical_switch_init_config(&config) != ROFL_SUCCESS)
+		return -1;
+	return 0;
+}
+
+int psi_tear_down(void){
+	physical_switch_destroy();
+	return 0;
+}
+
+void psi_logical_switches_test(void){
+	unsigned int i, max;
+	uint64_t dpid;
+	of1x_switch_t* sw;
+	char name[32];
+	enum of1x_matching_algorithm_available ma_list[1]={of1x_matching_algorithm_loop};
+
+	physical_switch_get_logical_switches(&max);
+	CU_ASSERT(max == PSI_MAX_LS);
+
+	//dpids differing only in the high bits
+	for(i=0;i<PSI_MAX_LS+1;i++){
+		dpid = ((uint64_t)i << 40) | 0x100;
+		snprintf(name, sizeof(name), "LSI %u", i);
+		sw = of1x_init_switch(name, OF_VERSION_13, dpid, 1, ma_list);
+		CU_ASSERT(sw != NULL);
+
+		if(i < PSI_MAX_LS){
+			CU_ASSERT(physical_switch_add_logical_switch((of_switch_t*)sw) == ROFL_SUCCESS);
+		}else{
+			//Full
+			CU_ASSERT(physical_switch_add_logical_switch((of_switch_t*)sw) == ROFL_FAILURE);
+			__of1x_destroy_switch(sw);
+		}
+	}
+
+	//Duplicated dpid
+	sw = of1x_init_switch("Duplicated", OF_VERSION_13, 0x100, 1, ma_list);
+	CU_ASSERT(physical_switch_add_logical_switch((of_switch_t*)sw) == ROFL_FAILURE);
+	__of1x_destroy_switch(sw);
+
+	for(i=0;i<PSI_MAX_LS;i++){
+		dpid = ((uint64_t)i << 40) | 0x100;
+		CU_ASSERT(physical_switch_get_logical_switch_by_dpid(dpid) != NULL);
+		CU_ASSERT(physical_switch_get_logical_switch_by_dpid(dpid)->dpid == dpid);
+	}
+	CU_ASSERT(physical_switch_get_logical_switch_by_dpid(0x101) == NULL);
+
+	//Remove every other switch; the rest must still be found
+	for(i=0;i<PSI_MAX_LS;i+=2)
+		CU_ASSERT(physical_switch_remove_logical_switch_by_dpid(((uint64_t)i << 40) | 0x100) == ROFL_SUCCESS);
+	CU_ASSERT(physical_switch_remove_logical_switch_by_dpid(0x100) == ROFL_FAILURE);
+
+	for(i=0;i<PSI_MAX_LS;i++){
+		dpid = ((uint64_t)i << 40) | 0x100;
+		if(i%2){
+			CU_ASSERT(physical_switch_get_logical_switch_by_dpid(dpid) != NULL);
+		}else{
+			CU_ASSERT(physical_switch_get_logical_switch_by_dpid(dpid) == NULL);
+		}
+	}
+
+	//Slots are reused
+	sw = of1x_init_switch("Reused", OF_VERSION_13, 0x200, 1, ma_list);
+	CU_ASSERT(physical_switch_add_logical_switch((of_switch_t*)sw) == ROFL_SUCCESS);
+	CU_ASSERT(physical_switch_get_logical_switch_by_dpid(0x200) == (of_switch_t*)sw);
+}
+
+void psi_ports_test(void){
+	unsigned int i, max;
+	char name[SWITCH_PORT_MAX_LEN_NAME];
+	switch_port_t* port;
+
+	physical_switch_get_physical_ports(&max);
+	CU_ASSERT(max == PSI_MAX_PHY_PORTS);
+	physical_switch_get_virtual_ports(&max);
+	CU_ASSERT(max == PSI_MAX_VIR_PORTS);
+	physical_switch_get_tunnel_ports(&max);
+	CU_ASSERT(max == PSI_MAX_TUN_PORTS);
+
+	for(i=0;i<PSI_MAX_PHY_PORTS;i++){
+		snprintf(name, sizeof(name), "ge%u", i);
+		CU_ASSERT(physical_switch_add_port(switch_port_init(name, true, PORT_TYPE_PHYSICAL, PORT_STATE_NONE)) == ROFL_SUCCESS);
+	}
+	for(i=0;i<PSI_MAX_VIR_PORTS;i++){
+		snprintf(name, sizeof(name), "veth%u", i);
+		CU_ASSERT(physical_switch_add_port(switch_port_init(name, true, PORT_TYPE_VIRTUAL, PORT_STATE_NONE)) == ROFL_SUCCESS);
+	}
+	for(i=0;i<PSI_MAX_TUN_PORTS;i++){
+		snprintf(name, sizeof(name), "tun%u", i);
+		CU_ASSERT(physical_switch_add_port(switch_port_init(name, true, PORT_TYPE_TUNNEL, PORT_STATE_NONE)) == ROFL_SUCCESS);
+	}
+
+	//Full and duplicated names
+	port = switch_port_init("ge99", true, PORT_TYPE_PHYSICAL, PORT_STATE_NONE);
+	CU_ASSERT(physical_switch_add_port(port) == ROFL_FAILURE);
+	switch_port_destroy(port);
+	port = switch_port_init("tun0", true, PORT_TYPE_VIRTUAL, PORT_STATE_NONE);
+	CU_ASSERT(physical_switch_add_port(port) == ROFL_FAILURE);
+	switch_port_destroy(port);
+
+	for(i=0;i<PSI_MAX_PHY_PORTS;i++){
+		snprintf(name, sizeof(name), "ge%u", i);
+		port = physical_switch_get_port_by_name(name);
+		CU_ASSERT(port != NULL && strcmp(port->name, name) == 0 && port->type == PORT_TYPE_PHYSICAL);
+	}
+	CU_ASSERT(physical_switch_get_port_by_name("veth3") != NULL);
+	CU_ASSERT(physical_switch_get_port_by_name("tun1") != NULL);
+	CU_ASSERT(physical_switch_get_port_by_name("ge16") == NULL);
+
+	//Remove every third physical port
+	for(i=0;i<PSI_MAX_PHY_PORTS;i+=3){
+		snprintf(name, sizeof(name), "ge%u", i);
+		CU_ASSERT(physical_switch_remove_port(name) == ROFL_SUCCESS);
+	}
+	CU_ASSERT(physical_switch_remove_port("ge0") == ROFL_FAILURE);
+	CU_ASSERT(physical_switch_remove_port("veth1") == ROFL_SUCCESS);
+
+	for(i=0;i<PSI_MAX_PHY_PORTS;i++){
+		snprintf(name, sizeof(name), "ge%u", i);
+		if(i%3){
+			CU_ASSERT(physical_switch_get_port_by_name(name) != NULL);
+		}else{
+			CU_ASSERT(physical_switch_get_port_by_name(name) == NULL);
+		}
+	}
+	CU_ASSERT(physical_switch_get_port_by_name("veth0") != NULL);
+	CU_ASSERT(physical_switch_get_port_by_name("veth1") == NULL);
+	CU_ASSERT(physical_switch_get_port_by_name("veth2") != NULL);
+
+	//Freed slots are reused
+	CU_ASSERT(physical_switch_add_port(switch_port_init("ge99", true, PORT_TYPE_PHYSICAL, PORT_STATE_NONE)) == ROFL_SUCCESS);
+	CU_ASSERT(physical_switch_get_port_by_name("ge99") != NULL);
+}
+
+//Looks up the ports that stay in the switch (ge<i>, i%3 != 0)
+static void* psi_reader(void* arg){
+	unsigned int i;
+	char name[SWITCH_PORT_MAX_LEN_NAME];
+
+	(void)arg;
+
+	while(psi_removing){
+		for(i=1;i<PSI_MAX_PHY_PORTS;i++){
+			if(i%3 == 0)
+				continue;
+			snprintf(name, sizeof(name), "ge%u", i);
+			if(!physical_switch_get_port_by_name(name))
+				psi_missed++;
+		}
+	}
+	return NULL;
+}
+
+void psi_concurrent_test(void){
+	unsigned int i;
+	char name[SWITCH_PORT_MAX_LEN_NAME];
+	pthread_t reader;
+
+	psi_missed = 0;
+	psi_removing = true;
+	CU_ASSERT(pthread_create(&reader, NULL, psi_reader, NULL) == 0);
+
+	//Add and remove other ports while the reader looks up
+	for(i=0;i<PSI_REMOVALS;i++){
+		snprintf(name, sizeof(name), "tmp%u", i%4);
+		CU_ASSERT(physical_switch_add_port(switch_port_init(name, true, PORT_TYPE_PHYSICAL, PORT_STATE_NONE)) == ROFL_SUCCESS);
+		CU_ASSERT(physical_switch_remove_port(name) == ROFL_SUCCESS);
+	}
+
+	psi_removing = false;
+	pthread_join(reader, NULL);
+
+	CU_ASSERT(psi_missed == 0);
+	CU_ASSERT((__get_physical_switch()->index_seq & 0x1) == 0);
+}
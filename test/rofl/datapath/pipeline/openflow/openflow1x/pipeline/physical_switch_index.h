@@ -0,0 +1,14 @@
+#ifndef __PHYSICAL_SWITCH_INDEX_H__
+#define __PHYSICAL_SWITCH_INDEX_H__
+
+#include "rofl.h"
+#include "rofl/datapath/pipeline/physical_switch.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/of1x_switch.h"
+
+int psi_set_up(void);
+int psi_tear_down(void);
+void psi_logical_switches_test(void);
+void psi_ports_test(void);
+void psi_concurrent_test(void);
+
+#endif //__PHYSICAL_SWITCH_INDEX_H__
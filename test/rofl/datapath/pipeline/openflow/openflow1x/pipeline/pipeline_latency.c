@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include <string.h>
+#include "CUnit/Basic.h"
+#include "pipeline_latency.h"
+
+static of1x_switch_t* sw=NULL;
+
+int lat_set_up(void){
+	enum of1x_matching_algorithm_available ma_list[2]={of1x_matching_algorithm_loop, of1x_matching_algorithm_loop};
+
+	sw = of1x_init_switch("Latency switch", OF_VERSION_13, 0x0501, 2, ma_list);
+	if(!sw)
+		return -1;
+	return 0;
+}
+
+int lat_tear_down(void){
+	__of1x_destroy_switch(sw);
+	return 0;
+}
+
+static of1x_action_group_t* lat_output_group(uint32_t port_num){
+	wrap_uint_t field;
+	of1x_action_group_t* ag = of1x_init_action_group(0);
+
+	field.u32 = port_num;
+	of1x_push_packet_action_to_group(ag, of1x_init_packet_action(OF1X_AT_OUTPUT, field, NULL, NULL));
+	return ag;
+}
+
+//Sum of the buckets must match the count
+static void lat_check_hist(unsigned int table_id, of1x_latency_stage_t stage, uint64_t count){
+	unsigned int i;
+	uint64_t total=0;
+	of1x_latency_hist_t hist;
+
+	CU_ASSERT(of1x_get_pipeline_latency(sw->pipeline, table_id, stage, &hist) == ROFL_SUCCESS);
+	CU_ASSERT(hist.count == count);
+	for(i=0;i<OF1X_LATENCY_BUCKETS;i++)
+		total += hist.buckets[i];
+	CU_ASSERT(total == count);
+	CU_ASSERT(hist.max <= hist.sum);
+}
+
+void lat_stages_test(void){
+	unsigned int i;
+	wrap_uint_t field;
+	datapacket_t pkt;
+	of1x_latency_hist_t hist;
+	of1x_flow_entry_t* entry;
+	of1x_write_actions_t* write_actions;
+	of1x_action_group_t* apply_actions;
+	of1x_bucket_list_t* buckets = of1x_init_bucket_list();
+
+	//Table 0: group and goto table 1
+	of1x_insert_bucket_in_list(buckets, of1x_init_bucket(0, 0, 0, lat_output_group(OF1X_PORT_FLOOD)));
+	CU_ASSERT(of1x_group_add(sw->pipeline->groups, OF1X_GROUP_TYPE_INDIRECT, 1, buckets) == ROFL_OF1X_GM_OK);
+
+	field.u32 = 1;
+	apply_actions = of1x_init_action_group(0);
+	of1x_push_packet_action_to_group(apply_actions, of1x_init_packet_action(OF1X_AT_GROUP, field, NULL, NULL));
+	entry = of1x_init_flow_entry(NULL, NULL, false);
+	of1x_add_instruction_to_group(&entry->inst_grp, OF1X_IT_APPLY_ACTIONS, apply_actions, NULL, NULL, 0);
+	of1x_add_instruction_to_group(&entry->inst_grp, OF1X_IT_GOTO_TABLE, NULL, NULL, NULL, 1);
+	CU_ASSERT(of1x_add_flow_entry_table(sw->pipeline, 0, entry, false, false) == ROFL_OF1X_FM_SUCCESS);
+
+	//Table 1: output (write actions)
+	field.u32 = OF1X_PORT_FLOOD;
+	write_actions = of1x_init_write_actions();
+	of1x_set_packet_action_on_write_actions(write_actions, of1x_init_packet_action(OF1X_AT_OUTPUT, field, NULL, NULL));
+	entry = of1x_init_flow_entry(NULL, NULL, false);
+	of1x_add_instruction_to_group(&entry->inst_grp, OF1X_IT_WRITE_ACTIONS, NULL, write_actions, NULL, 0);
+	CU_ASSERT(of1x_add_flow_entry_table(sw->pipeline, 1, entry, false, false) == ROFL_OF1X_FM_SUCCESS);
+
+#ifdef ROFL_PIPELINE_LATENCY_STATS
+	for(i=0;i<100;i++){
+		memset(&pkt, 0, sizeof(pkt));
+		of_process_packet_pipeline((of_switch_t*)sw, &pkt);
+	}
+
+	lat_check_hist(0, OF1X_LATENCY_STAGE_LOOKUP, 100);
+	lat_check_hist(0, OF1X_LATENCY_STAGE_INSTRUCTIONS, 100);
+	lat_check_hist(0, OF1X_LATENCY_STAGE_GROUP, 100);
+	lat_check_hist(0, OF1X_LATENCY_STAGE_ACTIONS, 0);
+	lat_check_hist(1, OF1X_LATENCY_STAGE_LOOKUP, 100);
+	lat_check_hist(1, OF1X_LATENCY_STAGE_INSTRUCTIONS, 100);
+	lat_check_hist(1, OF1X_LATENCY_STAGE_GROUP, 0);
+	lat_check_hist(1, OF1X_LATENCY_STAGE_ACTIONS, 100);
+
+	//Errors
+	CU_ASSERT(of1x_get_pipeline_latency(sw->pipeline, 2, OF1X_LATENCY_STAGE_LOOKUP, &hist) == ROFL_FAILURE);
+	CU_ASSERT(of1x_get_pipeline_latency(sw->pipeline, 0, OF1X_LATENCY_STAGE_MAX, &hist) == ROFL_FAILURE);
+
+	//Reset
+	CU_ASSERT(of1x_reset_pipeline_latency(sw->pipeline) == ROFL_SUCCESS);
+	lat_check_hist(0, OF1X_LATENCY_STAGE_LOOKUP, 0);
+	lat_check_hist(1, OF1X_LATENCY_STAGE_ACTIONS, 0);
+#else
+	//Not compiled in
+	for(i=0;i<10;i++){
+		memset(&pkt, 0, sizeof(pkt));
+		of_process_packet_pipeline((of_switch_t*)sw, &pkt);
+	}
+	CU_ASSERT(sw->pipeline->latency == NULL);
+	CU_ASSERT(of1x_get_pipeline_latency(sw->pipeline, 0, OF1X_LATENCY_STAGE_LOOKUP, &hist) == ROFL_FAILURE);
+	CU_ASSERT(of1x_reset_pipeline_latency(sw->pipeline) == ROFL_FAILURE);
+#endif
+	CU_ASSERT(strcmp(of1x_latency_stage_str(OF1X_LATENCY_STAGE_GROUP), "group") == 0);
+}
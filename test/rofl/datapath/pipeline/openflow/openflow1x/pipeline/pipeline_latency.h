@@ -0,0 +1,12 @@
+#ifndef __PIPELINE_LATENCY_H__
+#define __PIPELINE_LATENCY_H__
+
+#include "rofl.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_latency.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/of1x_switch.h"
+
+int lat_set_up(void);
+int lat_tear_down(void);
+void lat_stages_test(void);
+
+#endif //__PIPELINE_LATENCY_H__
@@ -37,9 +37,18 @@ void platform_of1x_packet_in(const of1x_switch_t* sw, uint8_t table_id, datapack
 
 }
 
+//Last flow removed notification (checked by the tests)
+extern "C" {
+unsigned int test_flow_removed_count = 0;
+of1x_flow_remove_reason_t test_flow_removed_reason = OF1X_FLOW_REMOVE_NO_REASON;
+uint64_t test_flow_removed_cookie = 0;
+}
+
 void platform_of1x_notify_flow_removed(const of1x_switch_t* sw, of1x_flow_remove_reason_t reason, of1x_flow_entry_t *entry)
 {
-
+	test_flow_removed_count++;
+	test_flow_removed_reason = reason;
+	test_flow_removed_cookie = entry->cookie;
 }
 
 void
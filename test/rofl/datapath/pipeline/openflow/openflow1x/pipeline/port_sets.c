@@ -0,0 +1,220 @@
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "CUnit/Basic.h"
+#include "port_sets.h"
+
+#define PSET_NUM_PORTS 4
+
+static of1x_switch_t* sw=NULL;
+static switch_port_t* ports[PSET_NUM_PORTS];
+
+int pset_set_up(void){
+	unsigned int i;
+	char name[SWITCH_PORT_MAX_LEN_NAME];
+	enum of1x_matching_algorithm_available ma_list[1]={of1x_matching_algorithm_loop};
+
+	sw = of1x_init_switch("Port sets switch", OF_VERSION_13, 0x0801, 1, ma_list);
+	if(!sw)
+		return -1;
+
+	//Ports 1..4 (ports[0] is moved to 5 by pset_sets_test)
+	for(i=0;i<PSET_NUM_PORTS;i++){
+		snprintf(name, sizeof(name), "pset%u", i+1);
+		ports[i] = switch_port_init(name, true, PORT_TYPE_PHYSICAL, PORT_STATE_NONE);
+		if(!ports[i] || __of1x_attach_port_to_switch_at_port_num(sw, i+1, ports[i]) != ROFL_SUCCESS)
+			return -1;
+	}
+	return 0;
+}
+
+int pset_tear_down(void){
+	unsigned int i;
+
+	__of1x_destroy_switch(sw);
+	for(i=0;i<PSET_NUM_PORTS;i++)
+		switch_port_destroy(ports[i]);
+	return 0;
+}
+
+//Checks the dense array of the set (in port number order) and its bitmap
+static bool pset_check_set(const of1x_port_set_t* set, const uint32_t* port_nums, unsigned int num_of_ports){
+	unsigned int i, members = 0;
+
+	if(set->num_of_ports != num_of_ports)
+		return false;
+	for(i=0;i<num_of_ports;i++){
+		if(set->port_nums[i] != port_nums[i] || !of1x_port_set_contains(set, port_nums[i]))
+			return false;
+	}
+	for(i=0;i<LOGICAL_SWITCH_MAX_LOG_PORTS;i++)
+		members += of1x_port_set_contains(set, i);
+
+	return members == num_of_ports;
+}
+
+void pset_sets_test(void){
+	uint32_t all_ports[] = {1, 2, 3, 4};
+
+	CU_ASSERT(pset_check_set(of1x_get_flood_port_set(sw), all_ports, 4));
+	CU_ASSERT(pset_check_set(of1x_get_all_port_set(sw), all_ports, 4));
+	CU_ASSERT(!of1x_port_set_contains(of1x_get_all_port_set(sw), 0));
+	CU_ASSERT(!of1x_port_set_contains(of1x_get_all_port_set(sw), OF1X_PORT_ALL));
+
+	//Port 2 no flood, port 3 down, port 4 not forwarding
+	switch_port_update_config(ports[1], true, false, true, true);
+	switch_port_update_state(ports[2], false, PORT_STATE_NONE);
+	switch_port_update_config(ports[3], false, false, false, true);
+	{
+		uint32_t flood[] = {1}, all[] = {1, 2};
+		CU_ASSERT(pset_check_set(of1x_get_flood_port_set(sw), flood, 1));
+		CU_ASSERT(pset_check_set(of1x_get_all_port_set(sw), all, 2));
+	}
+
+	//Port 3 up again; link down
+	switch_port_update_state(ports[2], true, PORT_STATE_NONE);
+	switch_port_update_state(ports[0], true, PORT_STATE_LINK_DOWN);
+	{
+		uint32_t flood[] = {3}, all[] = {2, 3};
+		CU_ASSERT(pset_check_set(of1x_get_flood_port_set(sw), flood, 1));
+		CU_ASSERT(pset_check_set(of1x_get_all_port_set(sw), all, 2));
+	}
+	switch_port_update_state(ports[0], true, PORT_STATE_NONE);
+
+	//Detach and attach (detached port numbers are not reused)
+	CU_ASSERT(__of1x_detach_port_from_switch_by_port_num(sw, 1) == ROFL_SUCCESS);
+	{
+		uint32_t flood[] = {3}, all[] = {2, 3};
+		CU_ASSERT(pset_check_set(of1x_get_flood_port_set(sw), flood, 1));
+		CU_ASSERT(pset_check_set(of1x_get_all_port_set(sw), all, 2));
+	}
+	CU_ASSERT(__of1x_attach_port_to_switch_at_port_num(sw, 5, ports[0]) == ROFL_SUCCESS);
+	{
+		uint32_t flood[] = {3, 5}, all[] = {2, 3, 5};
+		CU_ASSERT(pset_check_set(of1x_get_flood_port_set(sw), flood, 2));
+		CU_ASSERT(pset_check_set(of1x_get_all_port_set(sw), all, 3));
+	}
+}
+
+//Entry in table 0: [in_port] -> output
+static void pset_output_entry(uint32_t in_port, uint16_t priority, uint32_t port){
+	wrap_uint_t field;
+	of1x_action_group_t* apply_actions = of1x_init_action_group(0);
+	of1x_flow_entry_t* entry = of1x_init_flow_entry(NULL, NULL, false);
+
+	entry->priority = priority;
+	field.u32 = port;
+	of1x_push_packet_action_to_group(apply_actions, of1x_init_packet_action(OF1X_AT_OUTPUT, field, NULL, NULL));
+	of1x_add_instruction_to_group(&entry->inst_grp, OF1X_IT_APPLY_ACTIONS, apply_actions, NULL, NULL, 0);
+
+	if(in_port)
+		of1x_add_match_to_entry(entry, of1x_init_port_in_match(NULL, NULL, in_port));
+	CU_ASSERT(of1x_add_flow_entry_table(sw->pipeline, 0, entry, false, false) == ROFL_OF1X_FM_SUCCESS);
+}
+
+//tx_packets of the ports (the test platform accounts platform_packet_output_multi())
+static void pset_tx_packets(uint64_t* tx){
+	unsigned int i;
+	port_stats_t stats;
+
+	for(i=0;i<PSET_NUM_PORTS;i++){
+		switch_port_get_stats(ports[i], &stats);
+		tx[i] = stats.tx_packets;
+	}
+}
+
+void pset_output_test(void){
+	datapacket_t pkt;
+	uint64_t before[PSET_NUM_PORTS], after[PSET_NUM_PORTS];
+
+	//Flood set {3, 5}; all set {2, 3, 5}
+	pset_output_entry(0, 1, OF1X_PORT_FLOOD);
+	pset_output_entry(3, 2, OF1X_PORT_ALL);
+
+	//From port 5
+	pset_tx_packets(before);
+	memset(&pkt, 0, sizeof(pkt));
+	__of1x_process_packet_pipeline_vlink((of_switch_t*)sw, &pkt, 5, false);
+	pset_tx_packets(after);
+	CU_ASSERT(after[0] == before[0]);
+	CU_ASSERT(after[1] == before[1]);
+	CU_ASSERT(after[2] == before[2]+1);
+	CU_ASSERT(after[3] == before[3]);
+
+	//From port 3
+	pset_tx_packets(before);
+	memset(&pkt, 0, sizeof(pkt));
+	__of1x_process_packet_pipeline_vlink((of_switch_t*)sw, &pkt, 3, false);
+	pset_tx_packets(after);
+	CU_ASSERT(after[0] == before[0]+1);
+	CU_ASSERT(after[1] == before[1]+1);
+	CU_ASSERT(after[2] == before[2]);
+	CU_ASSERT(after[3] == before[3]);
+
+	//Port 4 forwarding again
+	switch_port_update_config(ports[3], true, false, false, true);
+	pset_tx_packets(before);
+	memset(&pkt, 0, sizeof(pkt));
+	__of1x_process_packet_pipeline_vlink((of_switch_t*)sw, &pkt, 2, false);
+	pset_tx_packets(after);
+	CU_ASSERT(after[0] == before[0]+1);
+	CU_ASSERT(after[1] == before[1]);
+	CU_ASSERT(after[2] == before[2]+1);
+	CU_ASSERT(after[3] == before[3]+1);
+}
+
+#define PSET_REBUILDS 20000
+
+static uint32_t pset_expected[2][LOGICAL_SWITCH_MAX_LOG_PORTS];
+static unsigned int pset_num_expected[2];
+static volatile bool pset_rebuilding;
+static unsigned int pset_torn;
+
+static bool pset_equal(const uint32_t* port_nums, unsigned int num_of_ports, unsigned int expected){
+	return num_of_ports == pset_num_expected[expected] && memcmp(port_nums, pset_expected[expected], num_of_ports*sizeof(uint32_t)) == 0;
+}
+
+static void* pset_reader(void* arg){
+	uint32_t port_nums[LOGICAL_SWITCH_MAX_LOG_PORTS];
+	unsigned int num_of_ports;
+
+	(void)arg;
+	while(pset_rebuilding){
+		num_of_ports = of1x_port_set_read(of1x_get_flood_port_set(sw), port_nums);
+		if(!pset_equal(port_nums, num_of_ports, 0) && !pset_equal(port_nums, num_of_ports, 1))
+			pset_torn++;
+	}
+	return NULL;
+}
+
+//Sets rebuilt (both buffers reused) while being read
+void pset_concurrent_test(void){
+	unsigned int i, num_of_ports;
+	uint32_t port_nums[LOGICAL_SWITCH_MAX_LOG_PORTS];
+	pthread_t reader;
+
+	//Flood set with and without port 4
+	pset_num_expected[0] = of1x_port_set_read(of1x_get_flood_port_set(sw), pset_expected[0]);
+	switch_port_update_config(ports[3], true, false, true, true);
+	pset_num_expected[1] = of1x_port_set_read(of1x_get_flood_port_set(sw), pset_expected[1]);
+	CU_ASSERT(pset_num_expected[0] == pset_num_expected[1]+1);
+
+	pset_rebuilding = true;
+	CU_ASSERT(pthread_create(&reader, NULL, pset_reader, NULL) == 0);
+
+	for(i=0;i<PSET_REBUILDS;i++)
+		switch_port_update_config(ports[3], true, false, i%2 == 1, true);
+
+	pset_rebuilding = false;
+	pthread_join(reader, NULL);
+
+	CU_ASSERT(pset_torn == 0);
+
+	//Sets are published complete (even sequence)
+	CU_ASSERT((of1x_get_flood_port_set(sw)->seq & 0x1) == 0);
+	CU_ASSERT((of1x_get_all_port_set(sw)->seq & 0x1) == 0);
+
+	//Last rebuild without port 4
+	num_of_ports = of1x_port_set_read(of1x_get_flood_port_set(sw), port_nums);
+	CU_ASSERT(pset_equal(port_nums, num_of_ports, 1));
+}
@@ -0,0 +1,15 @@
+#ifndef __PORT_SETS_TEST_H__
+#define __PORT_SETS_TEST_H__
+
+#include "rofl.h"
+#include "rofl/datapath/pipeline/physical_switch.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/of1x_switch.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_pipeline.h"
+
+int pset_set_up(void);
+int pset_tear_down(void);
+void pset_sets_test(void);
+void pset_output_test(void);
+void pset_concurrent_test(void);
+
+#endif //__PORT_SETS_TEST_H__
@@ -0,0 +1,65 @@
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "CUnit/Basic.h"
+#include "port_stats.h"
+
+#define PS_THREADS 4
+#define PS_ITERATIONS 100000
+
+static switch_port_t* port=NULL;
+
+int ps_set_up(void){
+	port = switch_port_init("port0", true, PORT_TYPE_PHYSICAL, PORT_STATE_NONE);
+	if(!port)
+		return -1;
+	if(switch_port_add_queue(port, 0, "queue0", 128, 0, 0) != ROFL_SUCCESS)
+		return -1;
+	return 0;
+}
+
+int ps_tear_down(void){
+	switch_port_destroy(port);
+	return 0;
+}
+
+//I/O thread; each one gets its own core id
+static void* ps_io_thread(void* arg){
+	unsigned int i;
+
+	for(i=0;i<PS_ITERATIONS;i++){
+		switch_port_stats_inc(port, 1, 2, 64, 128, 0, 1);
+		port_queue_stats_inc(&port->queues[0], 1, 128, 0);
+	}
+	return NULL;
+}
+
+void ps_concurrent_inc_test(void){
+	unsigned int i;
+	pthread_t threads[PS_THREADS];
+	port_stats_t stats;
+	queue_stats_t q_stats;
+
+	//Lockless updates are aggregated too
+	switch_port_stats_inc_lockless(port, 1, 0, 0, 0, 0, 0);
+	port->stats.rx_errors = 3;
+
+	for(i=0;i<PS_THREADS;i++)
+		CU_ASSERT(pthread_create(&threads[i], NULL, ps_io_thread, NULL) == 0);
+	for(i=0;i<PS_THREADS;i++)
+		pthread_join(threads[i], NULL);
+
+	switch_port_get_stats(port, &stats);
+	CU_ASSERT(stats.rx_packets == PS_THREADS*PS_ITERATIONS + 1);
+	CU_ASSERT(stats.tx_packets == 2*PS_THREADS*PS_ITERATIONS);
+	CU_ASSERT(stats.rx_bytes == 64ULL*PS_THREADS*PS_ITERATIONS);
+	CU_ASSERT(stats.tx_bytes == 128ULL*PS_THREADS*PS_ITERATIONS);
+	CU_ASSERT(stats.rx_dropped == 0);
+	CU_ASSERT(stats.tx_dropped == PS_THREADS*PS_ITERATIONS);
+	CU_ASSERT(stats.rx_errors == 3);
+
+	port_queue_get_stats(&port->queues[0], &q_stats);
+	CU_ASSERT(q_stats.tx_packets == PS_THREADS*PS_ITERATIONS);
+	CU_ASSERT(q_stats.tx_bytes == 128ULL*PS_THREADS*PS_ITERATIONS);
+	CU_ASSERT(q_stats.overrun == 0);
+}
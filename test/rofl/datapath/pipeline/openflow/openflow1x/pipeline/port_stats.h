@@ -0,0 +1,11 @@
+#ifndef __PORT_STATS_H__
+#define __PORT_STATS_H__
+
+#include "rofl.h"
+#include "rofl/datapath/pipeline/switch_port.h"
+
+int ps_set_up(void);
+int ps_tear_down(void);
+void ps_concurrent_inc_test(void);
+
+#endif //__PORT_STATS_H__
@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "CUnit/Basic.h"
+#include "psch_test.h"
+
+#define PSCH_PKTS 130
+#define PSCH_BURST 16
+#define PSCH_THREADS 4
+#define PSCH_ITERATIONS 20000
+
+static switch_port_t* port=NULL;
+static datapacket_t pkts[2][PSCH_PKTS];
+
+int psch_set_up(void){
+	port = switch_port_init("port0", true, PORT_TYPE_PHYSICAL, PORT_STATE_NONE);
+	if(!port)
+		return -1;
+	return 0;
+}
+
+int psch_tear_down(void){
+	//Also detaches the scheduler
+	switch_port_destroy(port);
+	return 0;
+}
+
+static unsigned int psch_dequeue(datapacket_t** out, unsigned int num){
+	unsigned int n = 0, ret;
+
+	while(n < num){
+		ret = port_scheduler_dequeue_burst(port->scheduler, out+n, (num-n < PSCH_BURST)? num-n : PSCH_BURST);
+		if(!ret)
+			break;
+		n += ret;
+	}
+	return n;
+}
+
+static unsigned int psch_count(datapacket_t** out, unsigned int num, unsigned int queue){
+	unsigned int i, count = 0;
+
+	for(i=0;i<num;i++){
+		if(out[i] >= &pkts[queue][0] && out[i] < &pkts[queue][PSCH_PKTS])
+			count++;
+	}
+	return count;
+}
+
+void psch_drr_test(void){
+	unsigned int i;
+	datapacket_t* out[2*PSCH_PKTS];
+	queue_stats_t stats;
+
+	//Best effort and 30% queues; 128 slots each
+	CU_ASSERT(switch_port_add_queue(port, 0, "be", 128, 0, 0) == ROFL_SUCCESS);
+	CU_ASSERT(switch_port_add_queue(port, 1, "gold", 128, 300, 0) == ROFL_SUCCESS);
+
+	CU_ASSERT(port_scheduler_attach(port, 0) == ROFL_SUCCESS);
+	CU_ASSERT(port_scheduler_attach(port, 0) == ROFL_FAILURE);
+	CU_ASSERT(port_scheduler_dequeue_burst(port->scheduler, out, PSCH_BURST) == 0);
+
+	//Overrun
+	for(i=0;i<PSCH_PKTS;i++){
+		CU_ASSERT(port_scheduler_enqueue(port->scheduler, 0, &pkts[0][i], 1000) == ((i < 128)? ROFL_SUCCESS : ROFL_FAILURE));
+		CU_ASSERT(port_scheduler_enqueue(port->scheduler, 1, &pkts[1][i], 1000) == ((i < 128)? ROFL_SUCCESS : ROFL_FAILURE));
+	}
+	CU_ASSERT(port_scheduler_get_queue_len(port->scheduler, 0) == 128);
+	port_queue_get_stats(&port->queues[0], &stats);
+	CU_ASSERT(stats.overrun == 2 && stats.tx_packets == 0);
+
+	//First round: 1 packet of queue 0 (1518 bytes of credit), 45 of queue 1 (30x)
+	CU_ASSERT(psch_dequeue(out, 46) == 46);
+	CU_ASSERT(psch_count(out, 46, 0) == 1);
+	CU_ASSERT(psch_count(out, 46, 1) == 45);
+	CU_ASSERT(out[0] == &pkts[0][0] && out[1] == &pkts[1][0] && out[45] == &pkts[1][44]);
+
+	//FIFO within the queues; everything is eventually sent
+	CU_ASSERT(psch_dequeue(out, 2*PSCH_PKTS) == 2*128-46);
+	CU_ASSERT(port_scheduler_get_queue_len(port->scheduler, 0) == 0);
+	CU_ASSERT(port_scheduler_get_queue_len(port->scheduler, 1) == 0);
+
+	port_queue_get_stats(&port->queues[1], &stats);
+	CU_ASSERT(stats.tx_packets == 128 && stats.tx_bytes == 128000 && stats.overrun == 2);
+
+	//Unknown queues go to the first one
+	CU_ASSERT(port_scheduler_enqueue(port->scheduler, 7, &pkts[0][0], 64) == ROFL_SUCCESS);
+	CU_ASSERT(port_scheduler_get_queue_len(port->scheduler, 0) == 1);
+
+	//Pending packets are dropped
+	CU_ASSERT(port_scheduler_detach(port) == ROFL_SUCCESS);
+	CU_ASSERT(port->scheduler == NULL);
+	CU_ASSERT(port_scheduler_detach(port) == ROFL_FAILURE);
+}
+
+void psch_shaping_test(void){
+	unsigned int i;
+	datapacket_t* out[2*PSCH_PKTS];
+
+	//8 Mbit/s port (1 MB/s); queue 1 at most 10% (100 KB/s, 3036 bytes of burst)
+	CU_ASSERT(switch_port_remove_queue(port, 1) == ROFL_SUCCESS);
+	CU_ASSERT(switch_port_add_queue(port, 1, "shaped", 128, 0, 100) == ROFL_SUCCESS);
+	CU_ASSERT(port_scheduler_attach(port, 8000000) == ROFL_SUCCESS);
+
+	for(i=0;i<20;i++)
+		CU_ASSERT(port_scheduler_enqueue(port->scheduler, 1, &pkts[1][i], 1000) == ROFL_SUCCESS);
+	for(i=0;i<5;i++)
+		CU_ASSERT(port_scheduler_enqueue(port->scheduler, 0, &pkts[0][i], 1000) == ROFL_SUCCESS);
+
+	//The unshaped queue is not held back
+	CU_ASSERT(psch_dequeue(out, 2*PSCH_PKTS) == 8);
+	CU_ASSERT(psch_count(out, 8, 0) == 5);
+	CU_ASSERT(psch_count(out, 8, 1) == 3);
+	CU_ASSERT(psch_dequeue(out, 2*PSCH_PKTS) == 0);
+
+	//10ms; 1000 bytes
+	__of1x_time_forward(0, 10000, NULL);
+	CU_ASSERT(psch_dequeue(out, 2*PSCH_PKTS) == 1);
+	CU_ASSERT(out[0] == &pkts[1][3]);
+
+	//Tokens are capped at the burst size
+	__of1x_time_forward(1, 0, NULL);
+	CU_ASSERT(psch_dequeue(out, 2*PSCH_PKTS) == 3);
+	CU_ASSERT(port_scheduler_get_queue_len(port->scheduler, 1) == 20-7);
+
+	CU_ASSERT(port_scheduler_detach(port) == ROFL_SUCCESS);
+}
+
+void psch_oversized_test(void){
+	datapacket_t* out[2*PSCH_PKTS];
+
+	//100 Mbit/s port; queue 1 at most 1% (125 KB/s, 3036 bytes of burst)
+	CU_ASSERT(switch_port_remove_queue(port, 1) == ROFL_SUCCESS);
+	CU_ASSERT(switch_port_add_queue(port, 1, "jumbo", 128, 0, 10) == ROFL_SUCCESS);
+	CU_ASSERT(port_scheduler_attach(port, 100000000) == ROFL_SUCCESS);
+
+	CU_ASSERT(port_scheduler_enqueue(port->scheduler, 1, &pkts[1][0], 9000) == ROFL_SUCCESS);
+	CU_ASSERT(port_scheduler_enqueue(port->scheduler, 1, &pkts[1][1], 9000) == ROFL_SUCCESS);
+
+	//Larger than the burst; sent with the bucket full
+	CU_ASSERT(psch_dequeue(out, 2*PSCH_PKTS) == 1);
+	CU_ASSERT(out[0] == &pkts[1][0]);
+	CU_ASSERT(psch_dequeue(out, 2*PSCH_PKTS) == 0);
+
+	//The next one waits until the 9000 bytes are repaid (72ms)
+	__of1x_time_forward(0, 50000, NULL);
+	CU_ASSERT(psch_dequeue(out, 2*PSCH_PKTS) == 0);
+	__of1x_time_forward(0, 30000, NULL);
+	CU_ASSERT(psch_dequeue(out, 2*PSCH_PKTS) == 1);
+	CU_ASSERT(out[0] == &pkts[1][1]);
+
+	CU_ASSERT(port_scheduler_detach(port) == ROFL_SUCCESS);
+}
+
+//Producer; each thread gets its own core id
+static volatile unsigned int psch_finished = 0;
+
+static void* psch_thread(void* arg){
+	unsigned int i, *dropped = (unsigned int*)arg;
+
+	for(i=0;i<PSCH_ITERATIONS;i++){
+		if(port_scheduler_enqueue(port->scheduler, i%2, &pkts[i%2][i%PSCH_PKTS], 100) != ROFL_SUCCESS)
+			(*dropped)++;
+	}
+	__sync_fetch_and_add(&psch_finished, 1);
+	return NULL;
+}
+
+void psch_concurrent_test(void){
+	unsigned int i, n, dequeued = 0, dropped[PSCH_THREADS];
+	bool done;
+	pthread_t threads[PSCH_THREADS];
+	datapacket_t* out[PSCH_BURST];
+	queue_stats_t before[2], after[2];
+
+	port_queue_get_stats(&port->queues[0], &before[0]);
+	port_queue_get_stats(&port->queues[1], &before[1]);
+
+	CU_ASSERT(port_scheduler_attach(port, 0) == ROFL_SUCCESS);
+
+	memset(dropped, 0, sizeof(dropped));
+	for(i=0;i<PSCH_THREADS;i++)
+		CU_ASSERT(pthread_create(&threads[i], NULL, psch_thread, &dropped[i]) == 0);
+
+	//Single consumer; the producers must be done before the (empty) dequeue
+	//that ends the loop, or packets enqueued after it would be left behind
+	do{
+		done = (psch_finished == PSCH_THREADS);
+		__sync_synchronize();
+		n = port_scheduler_dequeue_burst(port->scheduler, out, PSCH_BURST);
+		dequeued += n;
+	}while(n || !done);
+
+	for(i=0;i<PSCH_THREADS;i++){
+		pthread_join(threads[i], NULL);
+		dequeued += dropped[i];
+	}
+	CU_ASSERT(dequeued == PSCH_THREADS*PSCH_ITERATIONS);
+	CU_ASSERT(port_scheduler_get_queue_len(port->scheduler, 0) == 0);
+	CU_ASSERT(port_scheduler_get_queue_len(port->scheduler, 1) == 0);
+
+	//Every packet was either sent or accounted as overrun
+	port_queue_get_stats(&port->queues[0], &after[0]);
+	port_queue_get_stats(&port->queues[1], &after[1]);
+	CU_ASSERT(after[0].tx_packets - before[0].tx_packets + after[1].tx_packets - before[1].tx_packets
+			+ after[0].overrun - before[0].overrun + after[1].overrun - before[1].overrun == PSCH_THREADS*PSCH_ITERATIONS);
+
+	CU_ASSERT(port_scheduler_detach(port) == ROFL_SUCCESS);
+}
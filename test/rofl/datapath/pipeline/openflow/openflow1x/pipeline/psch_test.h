@@ -0,0 +1,16 @@
+#ifndef __PSCH_TEST_H__
+#define __PSCH_TEST_H__
+
+#include "rofl.h"
+#include "rofl/datapath/pipeline/port_scheduler.h"
+#include "rofl/datapath/pipeline/common/datapacket.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_timers.h"
+
+int psch_set_up(void);
+int psch_tear_down(void);
+void psch_drr_test(void);
+void psch_shaping_test(void);
+void psch_oversized_test(void);
+void psch_concurrent_test(void);
+
+#endif //__PSCH_TEST_H__
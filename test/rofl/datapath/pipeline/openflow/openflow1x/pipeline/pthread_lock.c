@@ -1,5 +1,6 @@
 #include <rofl/datapath/pipeline/platform/lock.h>
 #include <rofl/datapath/pipeline/platform/memory.h>
+#include <rofl/datapath/pipeline/platform/cutil.h>
 
 #include <pthread.h>
 
@@ -81,3 +82,14 @@ void platform_rwlock_wrlock(platform_rwlock_t* rwlock){
 void platform_rwlock_wrunlock(platform_rwlock_t* rwlock){
 	pthread_rwlock_unlock(rwlock);
 }
+
+/* Core identification */
+static __thread int core_id = -1;
+static unsigned int next_core_id = 0;
+
+unsigned int platform_get_core_id(void){
+	//One id per thread, assigned on first use
+	if(core_id < 0)
+		core_id = __sync_fetch_and_add(&next_core_id, 1) % ROFL_PIPELINE_MAX_CORES;
+	return core_id;
+}
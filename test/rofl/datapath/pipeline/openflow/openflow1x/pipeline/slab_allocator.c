@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <string.h>
+#include "CUnit/Basic.h"
+#include "slab_allocator.h"
+
+int slab_set_up(void){
+	//Idempotent
+	if(slab_init() != ROFL_SUCCESS || slab_init() != ROFL_SUCCESS)
+		return -1;
+	return 0;
+}
+
+int slab_tear_down(void){
+	return 0;
+}
+
+static uint64_t slab_in_use(void){
+	unsigned int i;
+	uint64_t in_use = 0;
+	slab_stats_t stats;
+
+	slab_get_stats(&stats);
+	for(i=0;i<SLAB_NUM_OF_CLASSES;i++)
+		in_use += stats.classes[i].objs_in_use;
+	return in_use;
+}
+
+void slab_alloc_free_test(void){
+	slab_stats_t before, after;
+	void *a, *b, *big;
+
+	slab_get_stats(&before);
+
+	a = __slab_malloc(40);
+	b = __slab_malloc(40);
+	CU_ASSERT(a != NULL && b != NULL && a != b);
+	//Objects are 16 byte aligned and usable
+	CU_ASSERT(((uintptr_t)a & 0xF) == 0);
+	memset(a, 0xAA, 40);
+	memset(b, 0xBB, 40);
+
+	//Too big for any class
+	big = __slab_malloc(64*1024);
+	CU_ASSERT(big != NULL);
+
+	slab_get_stats(&after);
+	CU_ASSERT(after.classes[0].obj_size == 48);
+	CU_ASSERT(after.classes[0].objs_in_use == before.classes[0].objs_in_use + 2);
+	CU_ASSERT(after.classes[0].num_of_pages >= 1);
+	CU_ASSERT(after.classes[0].objs_total >= after.classes[0].objs_in_use);
+	CU_ASSERT(after.direct_in_use == before.direct_in_use + 1);
+
+	__slab_free(a);
+	__slab_free(b);
+	__slab_free(big);
+
+	slab_get_stats(&after);
+	CU_ASSERT(after.classes[0].objs_in_use == before.classes[0].objs_in_use);
+	CU_ASSERT(after.direct_in_use == before.direct_in_use);
+
+	//Freed objects are recycled
+	a = __slab_malloc(48);
+	CU_ASSERT(a == b);
+	__slab_free(a);
+}
+
+void slab_batch_test(void){
+	unsigned int i;
+	slab_batch_t batch;
+	void* objs[64];
+	uint64_t in_use = slab_in_use();
+
+	for(i=0;i<64;i++){
+		objs[i] = __slab_malloc( (i%2)? 100 : 1000);
+		CU_ASSERT(objs[i] != NULL);
+	}
+	CU_ASSERT(slab_in_use() == in_use + 64);
+
+	__slab_batch_init(&batch);
+	for(i=0;i<64;i++)
+		__slab_batch_free(&batch, objs[i]);
+
+	//Nothing is returned until the flush
+	CU_ASSERT(slab_in_use() == in_use + 64);
+	__slab_batch_flush(&batch);
+	CU_ASSERT(slab_in_use() == in_use);
+
+	//Flushing an empty batch is harmless
+	__slab_batch_flush(&batch);
+	CU_ASSERT(slab_in_use() == in_use);
+}
+
+void slab_flow_entry_test(void){
+	of1x_flow_entry_t* entry;
+	of1x_action_group_t* apply;
+	of1x_write_actions_t* write;
+	of1x_packet_action_t* action;
+	wrap_uint_t field;
+	uint64_t in_use = slab_in_use();
+
+	entry = of1x_init_flow_entry(NULL, NULL, false);
+	CU_ASSERT(entry != NULL);
+
+	CU_ASSERT(of1x_add_match_to_entry(entry, of1x_init_port_in_match(NULL, NULL, 1)) == ROFL_SUCCESS);
+	CU_ASSERT(of1x_add_match_to_entry(entry, of1x_init_eth_type_match(NULL, NULL, 0x0800)) == ROFL_SUCCESS);
+
+	memset(&field, 0, sizeof(field));
+	field.u32 = 2;
+	apply = of1x_init_action_group(NULL);
+	of1x_push_packet_action_to_group(apply, of1x_init_packet_action(OF1X_AT_OUTPUT, field, NULL, NULL));
+	of1x_add_instruction_to_group(&entry->inst_grp, OF1X_IT_APPLY_ACTIONS, apply, NULL, NULL, 0);
+
+	//Actions are copied into the write actions
+	write = of1x_init_write_actions();
+	action = of1x_init_packet_action(OF1X_AT_OUTPUT, field, NULL, NULL);
+	of1x_set_packet_action_on_write_actions(write, action);
+	of1x_destroy_packet_action(action);
+	of1x_add_instruction_to_group(&entry->inst_grp, OF1X_IT_WRITE_ACTIONS, NULL, write, NULL, 0);
+
+	//entry + 2 matches + 2 ternaries + action + action group + write actions
+	CU_ASSERT(slab_in_use() == in_use + 8);
+
+	//Everything is returned in bulk
+	CU_ASSERT(of1x_destroy_flow_entry(entry) == ROFL_SUCCESS);
+	CU_ASSERT(slab_in_use() == in_use);
+}
@@ -0,0 +1,15 @@
+#ifndef __SLAB_ALLOCATOR_H__
+#define __SLAB_ALLOCATOR_H__
+
+#include "rofl.h"
+#include "rofl/datapath/pipeline/common/slab.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_flow_entry.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_instruction.h"
+
+int slab_set_up(void);
+int slab_tear_down(void);
+void slab_alloc_free_test(void);
+void slab_batch_test(void);
+void slab_flow_entry_test(void);
+
+#endif //__SLAB_ALLOCATOR_H__
@@ -0,0 +1,336 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CUnit/Basic.h"
+#include "snapshot.h"
+
+#define SNAP_NUM_ENTRIES 64
+#define SNAP_IP(i) (0x0A000000+(i))
+
+static of1x_switch_t* src=NULL;
+static of1x_switch_t* dst=NULL;
+
+//Source and destination switches (table 0 adaptive, table 1 loop), both empty
+static int snap_init_switches(void){
+	enum of1x_matching_algorithm_available ma_list[2]={of1x_matching_algorithm_adaptive, of1x_matching_algorithm_loop};
+
+	if(src)
+		__of1x_destroy_switch(src);
+	if(dst)
+		__of1x_destroy_switch(dst);
+
+	src = of1x_init_switch("Snapshot source", OF_VERSION_13, 0x0901, 2, ma_list);
+	dst = of1x_init_switch("Snapshot destination", OF_VERSION_13, 0x0902, 2, ma_list);
+	if(!src || !dst)
+		return -1;
+	return 0;
+}
+
+int snap_set_up(void){
+	return snap_init_switches();
+}
+
+int snap_tear_down(void){
+	__of1x_destroy_switch(src);
+	__of1x_destroy_switch(dst);
+	src = dst = NULL;
+	return 0;
+}
+
+static of1x_action_group_t* snap_action_group(of1x_packet_action_type_t type, uint32_t value){
+	wrap_uint_t field;
+	of1x_action_group_t* ag = of1x_init_action_group(0);
+
+	field.u64 = 0;
+	field.u32 = value;
+	of1x_push_packet_action_to_group(ag, of1x_init_packet_action(type, field, NULL, NULL));
+	return ag;
+}
+
+//Meter 1, group 1 (ALL, outputs 1 and 2), entries on both tables
+static void snap_fill(of1x_pipeline_t* pipeline){
+	unsigned int i;
+	of1x_meter_band_config_t band = { OF1X_METER_BAND_DROP, 1000, 0, 0 };
+	of1x_bucket_list_t* buckets = of1x_init_bucket_list();
+	of1x_flow_entry_t* entry;
+	of1x_group_t* group;
+
+	CU_ASSERT(of1x_meter_add(pipeline->meters, 1, OF1X_METER_FLAG_KBPS, &band, 1) == ROFL_OF1X_MM_OK);
+
+	of1x_insert_bucket_in_list(buckets, of1x_init_bucket(0, 1, 0, snap_action_group(OF1X_AT_OUTPUT, 1)));
+	of1x_insert_bucket_in_list(buckets, of1x_init_bucket(0, 2, 0, snap_action_group(OF1X_AT_OUTPUT, 2)));
+	CU_ASSERT(of1x_group_add(pipeline->groups, OF1X_GROUP_TYPE_ALL, 1, buckets) == ROFL_OF1X_GM_OK);
+
+	for(i=0;i<SNAP_NUM_ENTRIES;i++){
+		entry = of1x_init_flow_entry(NULL, NULL, i%2 == 0);
+		entry->priority = 100 + i%4;
+		entry->cookie = i;
+		of1x_add_match_to_entry(entry, of1x_init_eth_type_match(NULL, NULL, OF1X_ETH_TYPE_IPV4));
+		of1x_add_match_to_entry(entry, of1x_init_ip4_dst_match(NULL, NULL, SNAP_IP(i), 0xFFFFFFFF));
+
+		switch(i%3){
+			case 0:
+				of1x_add_instruction_to_group(&entry->inst_grp, OF1X_IT_APPLY_ACTIONS, snap_action_group(OF1X_AT_OUTPUT, i%4+1), NULL, NULL, 0);
+				break;
+			case 1:
+				of1x_add_instruction_to_group(&entry->inst_grp, OF1X_IT_APPLY_ACTIONS, snap_action_group(OF1X_AT_GROUP, 1), NULL, NULL, 0);
+				break;
+			default:{
+				wrap_uint_t field;
+				of1x_write_actions_t* wa = of1x_init_write_actions();
+				of1x_write_metadata_t md = { 0x1000+i, 0xFFFF };
+
+				field.u64 = 0;
+				field.u32 = 3;
+				of1x_set_packet_action_on_write_actions(wa, of1x_init_packet_action(OF1X_AT_OUTPUT, field, NULL, NULL));
+				of1x_add_meter_instruction_to_group(&entry->inst_grp, 1);
+				of1x_add_instruction_to_group(&entry->inst_grp, OF1X_IT_WRITE_ACTIONS, NULL, wa, NULL, 0);
+				of1x_add_instruction_to_group(&entry->inst_grp, OF1X_IT_WRITE_METADATA, NULL, NULL, &md, 0);
+				of1x_add_instruction_to_group(&entry->inst_grp, OF1X_IT_GOTO_TABLE, NULL, NULL, NULL, 1);
+				}break;
+		}
+
+		if(i%5 == 0)
+			__of1x_fill_new_timer_entry_info(entry, 30, 0);
+		else if(i%7 == 0)
+			__of1x_fill_new_timer_entry_info(entry, 0, 20);
+
+		CU_ASSERT(of1x_add_flow_entry_table(pipeline, 0, entry, false, false) == ROFL_OF1X_FM_SUCCESS);
+	}
+
+	entry = of1x_init_flow_entry(NULL, NULL, false);
+	entry->priority = 10;
+	of1x_add_match_to_entry(entry, of1x_init_eth_type_match(NULL, NULL, OF1X_ETH_TYPE_IPV4));
+	of1x_add_match_to_entry(entry, of1x_init_ip4_dst_match(NULL, NULL, 0x0A010000, 0xFFFF0000));
+	of1x_add_instruction_to_group(&entry->inst_grp, OF1X_IT_APPLY_ACTIONS, snap_action_group(OF1X_AT_OUTPUT, 4), NULL, NULL, 0);
+	CU_ASSERT(of1x_add_flow_entry_table(pipeline, 1, entry, false, false) == ROFL_OF1X_FM_SUCCESS);
+
+	//Counters (entry i gets i+1 packets of 100 bytes)
+	for(entry=pipeline->tables[0].entries, i=0; entry; entry=entry->next, i++){
+		entry->stats.packet_count = i+1;
+		entry->stats.byte_count = (i+1)*100;
+	}
+	__of1x_stats_table_add_flow_counts(&pipeline->tables[0], SNAP_NUM_ENTRIES*(SNAP_NUM_ENTRIES+1)/2, SNAP_NUM_ENTRIES*(SNAP_NUM_ENTRIES+1)*50);
+	pipeline->tables[0].stats.lookup_count = 1000;
+	pipeline->tables[0].stats.matched_count = 900;
+
+	//Group counters, spread over two cores
+	group = __of1x_group_search(pipeline->groups, 1);
+	__of1x_stats_group_row(&group->stats, 0)[OF1X_STATS_GROUP_COLUMN].packet_count = 4;
+	__of1x_stats_group_row(&group->stats, 5)[OF1X_STATS_GROUP_COLUMN].packet_count = 3;
+	__of1x_stats_group_row(&group->stats, 5)[OF1X_STATS_BUCKET_COLUMN(1)].byte_count = 64;
+}
+
+//Same entry, restored into dst
+static bool snap_check_entry(of1x_flow_entry_t* s, of1x_flow_entry_t* d){
+	unsigned int i;
+	of1x_instruction_t *s_inst, *d_inst;
+
+	if(!__of1x_flow_entry_check_equal(s, d, OF1X_PORT_ANY, OF1X_GROUP_ANY, true) || s->cookie != d->cookie)
+		return false;
+	if(s->notify_removal != d->notify_removal || d->table != &dst->pipeline->tables[s->table->number])
+		return false;
+	if(s->timer_info.hard_timeout != d->timer_info.hard_timeout || s->timer_info.idle_timeout != d->timer_info.idle_timeout)
+		return false;
+	if(s->stats.packet_count != d->stats.packet_count || s->stats.byte_count != d->stats.byte_count)
+		return false;
+	if(s->inst_grp.num_of_instructions != d->inst_grp.num_of_instructions || s->inst_grp.num_of_outputs != d->inst_grp.num_of_outputs)
+		return false;
+
+	for(i=0;i<OF1X_IT_MAX;i++){
+		s_inst = &s->inst_grp.instructions[i];
+		d_inst = &d->inst_grp.instructions[i];
+
+		if(s_inst->type != d_inst->type)
+			return false;
+
+		switch(s_inst->type){
+			case OF1X_IT_APPLY_ACTIONS:
+				if(d_inst->apply_actions->num_of_actions != s_inst->apply_actions->num_of_actions ||
+					d_inst->apply_actions->num_of_output_actions != s_inst->apply_actions->num_of_output_actions ||
+					d_inst->apply_actions->head->type != s_inst->apply_actions->head->type ||
+					d_inst->apply_actions->head->field.u32 != s_inst->apply_actions->head->field.u32)
+					return false;
+				if(d_inst->apply_actions->head->type == OF1X_AT_GROUP &&
+					d_inst->apply_actions->head->group != __of1x_group_search(dst->pipeline->groups, 1))
+					return false;
+				break;
+			case OF1X_IT_WRITE_ACTIONS:
+				if(d_inst->write_actions->num_of_actions != s_inst->write_actions->num_of_actions ||
+					d_inst->write_actions->num_of_output_actions != s_inst->write_actions->num_of_output_actions ||
+					d_inst->write_actions->write_actions[OF1X_AT_OUTPUT].field.u32 != 3)
+					return false;
+				break;
+			case OF1X_IT_WRITE_METADATA:
+				if(d_inst->write_metadata.metadata != s_inst->write_metadata.metadata ||
+					d_inst->write_metadata.metadata_mask != s_inst->write_metadata.metadata_mask)
+					return false;
+				break;
+			case OF1X_IT_GOTO_TABLE:
+				if(d_inst->go_to_table != s_inst->go_to_table)
+					return false;
+				break;
+			case OF1X_IT_METER:
+				if(d_inst->meter_id != s_inst->meter_id || d_inst->meter != __of1x_meter_search(dst->pipeline->meters, 1))
+					return false;
+				break;
+			default:
+				break;
+		}
+	}
+	return true;
+}
+
+void snap_roundtrip_test(void){
+	unsigned int i;
+	size_t size, used;
+	void* buf;
+	of1x_flow_entry_t *s, *d;
+	of1x_match_group_t matches;
+	of1x_stats_flow_aggregate_msg_t *s_msg, *d_msg;
+	of1x_packet_matches_t pkt;
+	of1x_group_t* group;
+	uint64_t packets, bytes;
+	struct timeval now;
+
+	CU_ASSERT(snap_init_switches() == 0);
+	snap_fill(src->pipeline);
+	__of1x_time_forward(3, 0, NULL);
+
+	size = of1x_snapshot_get_size(src->pipeline);
+	CU_ASSERT(size > sizeof(of1x_snapshot_header_t) + SNAP_NUM_ENTRIES*sizeof(of1x_snapshot_entry_t));
+	buf = malloc(size);
+	CU_ASSERT(buf != NULL);
+
+	//Too small
+	CU_ASSERT(of1x_snapshot_save(src->pipeline, buf, size-8, &used) == ROFL_FAILURE);
+
+	CU_ASSERT(of1x_snapshot_save(src->pipeline, buf, size, &used) == ROFL_SUCCESS);
+	CU_ASSERT(used == size);
+	CU_ASSERT(of1x_snapshot_restore(dst->pipeline, buf, used) == ROFL_SUCCESS);
+	free(buf);
+
+	//Groups, meters, tables
+	CU_ASSERT(dst->pipeline->groups->num_of_entries == 1);
+	group = __of1x_group_search(dst->pipeline->groups, 1);
+	__of1x_stats_group_get_counts(&group->stats, OF1X_STATS_GROUP_COLUMN, &packets, &bytes);
+	CU_ASSERT(packets == 7 && bytes == 0);
+	__of1x_stats_group_get_counts(&group->stats, OF1X_STATS_BUCKET_COLUMN(1), &packets, &bytes);
+	CU_ASSERT(packets == 0 && bytes == 64);
+	CU_ASSERT(__of1x_group_search(dst->pipeline->groups, 1)->bc_list->num_of_buckets == 2);
+	CU_ASSERT(dst->pipeline->meters->num_of_entries == 1);
+	CU_ASSERT(dst->pipeline->tables[0].num_of_entries == SNAP_NUM_ENTRIES);
+	CU_ASSERT(dst->pipeline->tables[1].num_of_entries == 1);
+	CU_ASSERT(dst->pipeline->tables[0].stats.lookup_count == 1000);
+	CU_ASSERT(dst->pipeline->tables[0].stats.matched_count == 900);
+
+	//Entries, in order
+	__of1x_time_forward(0, 0, &now);
+	for(i=0;i<2;i++){
+		for(s=src->pipeline->tables[i].entries, d=dst->pipeline->tables[i].entries; s && d; s=s->next, d=d->next){
+			CU_ASSERT(snap_check_entry(s, d));
+			CU_ASSERT(now.tv_sec - d->stats.initial_time.tv_sec >= 3);
+		}
+		CU_ASSERT(s == NULL && d == NULL);
+	}
+
+	//Aggregated counters
+	__of1x_init_match_group(&matches);
+	s_msg = of1x_get_flow_aggregate_stats(src->pipeline, OF1X_FLOW_TABLE_ALL, 0, 0, OF1X_PORT_ANY, OF1X_GROUP_ANY, &matches);
+	d_msg = of1x_get_flow_aggregate_stats(dst->pipeline, OF1X_FLOW_TABLE_ALL, 0, 0, OF1X_PORT_ANY, OF1X_GROUP_ANY, &matches);
+	CU_ASSERT(s_msg != NULL && d_msg != NULL);
+	CU_ASSERT(d_msg->flow_count == SNAP_NUM_ENTRIES+1);
+	CU_ASSERT(d_msg->packet_count == s_msg->packet_count && d_msg->byte_count == s_msg->byte_count);
+	of1x_destroy_stats_flow_aggregate_msg(s_msg);
+	of1x_destroy_stats_flow_aggregate_msg(d_msg);
+
+	//Lookups (matching algorithm state)
+	for(i=0;i<SNAP_NUM_ENTRIES;i++){
+		memset(&pkt, 0, sizeof(pkt));
+		pkt.eth_type = OF1X_ETH_TYPE_IPV4;
+		pkt.ipv4_dst = SNAP_IP(i);
+		d = __of1x_find_best_match_table(&dst->pipeline->tables[0], &pkt);
+		CU_ASSERT(d != NULL && d->cookie == i);
+		if(d)
+			platform_rwlock_rdunlock(d->rwlock);
+	}
+	memset(&pkt, 0, sizeof(pkt));
+	pkt.eth_type = OF1X_ETH_TYPE_IPV4;
+	pkt.ipv4_dst = 0x0A010203;
+	d = __of1x_find_best_match_table(&dst->pipeline->tables[1], &pkt);
+	CU_ASSERT(d != NULL && d->priority == 10);
+	if(d)
+		platform_rwlock_rdunlock(d->rwlock);
+}
+
+void snap_timers_test(void){
+	size_t size;
+	void* buf;
+	of1x_flow_entry_t* entry;
+
+	CU_ASSERT(snap_init_switches() == 0);
+
+	entry = of1x_init_flow_entry(NULL, NULL, false);
+	of1x_add_match_to_entry(entry, of1x_init_port_in_match(NULL, NULL, 1));
+	__of1x_fill_new_timer_entry_info(entry, 10, 0);
+	CU_ASSERT(of1x_add_flow_entry_table(src->pipeline, 1, entry, false, false) == ROFL_OF1X_FM_SUCCESS);
+	__of1x_time_forward(3, 0, NULL);
+
+	size = of1x_snapshot_get_size(src->pipeline);
+	buf = malloc(size);
+	CU_ASSERT(of1x_snapshot_save(src->pipeline, buf, size, NULL) == ROFL_SUCCESS);
+	CU_ASSERT(of1x_snapshot_restore(dst->pipeline, buf, size) == ROFL_SUCCESS);
+	free(buf);
+	CU_ASSERT(dst->pipeline->tables[1].num_of_entries == 1);
+
+	//The hard timeout continues (7s left)
+	__of1x_time_forward(5, 0, NULL);
+	__of1x_process_pipeline_tables_timeout_expirations(dst->pipeline);
+	CU_ASSERT(dst->pipeline->tables[1].num_of_entries == 1);
+
+	__of1x_time_forward(4, 0, NULL);
+	__of1x_process_pipeline_tables_timeout_expirations(dst->pipeline);
+	CU_ASSERT(dst->pipeline->tables[1].num_of_entries == 0);
+}
+
+void snap_invalid_test(void){
+	size_t size;
+	uint8_t* buf;
+	of1x_snapshot_header_t* hdr;
+
+	CU_ASSERT(snap_init_switches() == 0);
+	snap_fill(src->pipeline);
+
+	size = of1x_snapshot_get_size(src->pipeline);
+	buf = malloc(size);
+	hdr = (of1x_snapshot_header_t*)buf;
+	CU_ASSERT(of1x_snapshot_save(src->pipeline, buf, size, NULL) == ROFL_SUCCESS);
+
+	//Truncated
+	CU_ASSERT(of1x_snapshot_restore(dst->pipeline, buf, size-8) == ROFL_FAILURE);
+	CU_ASSERT(of1x_snapshot_restore(dst->pipeline, buf, sizeof(of1x_snapshot_header_t)-1) == ROFL_FAILURE);
+
+	//Bad magic and version
+	hdr->magic++;
+	CU_ASSERT(of1x_snapshot_restore(dst->pipeline, buf, size) == ROFL_FAILURE);
+	hdr->magic--;
+	hdr->version++;
+	CU_ASSERT(of1x_snapshot_restore(dst->pipeline, buf, size) == ROFL_FAILURE);
+	hdr->version--;
+
+	//Another OpenFlow version
+	hdr->of_ver = OF_VERSION_12;
+	CU_ASSERT(of1x_snapshot_restore(dst->pipeline, buf, size) == ROFL_FAILURE);
+	hdr->of_ver = OF_VERSION_13;
+
+	//Nothing restored so far
+	CU_ASSERT(dst->pipeline->tables[0].num_of_entries == 0);
+	CU_ASSERT(dst->pipeline->groups->num_of_entries == 0);
+	CU_ASSERT(dst->pipeline->meters->num_of_entries == 0);
+
+	//Not empty
+	CU_ASSERT(of1x_snapshot_restore(src->pipeline, buf, size) == ROFL_FAILURE);
+
+	CU_ASSERT(of1x_snapshot_restore(dst->pipeline, buf, size) == ROFL_SUCCESS);
+	free(buf);
+}
@@ -0,0 +1,20 @@
+#ifndef __SNAPSHOT_TEST_H__
+#define __SNAPSHOT_TEST_H__
+
+#include "rofl.h"
+#include "rofl/datapath/pipeline/physical_switch.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/of1x_switch.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_pipeline.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_flow_table.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_group_table.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_meter_table.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_snapshot.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_timers.h"
+
+int snap_set_up(void);
+int snap_tear_down(void);
+void snap_roundtrip_test(void);
+void snap_timers_test(void);
+void snap_invalid_test(void);
+
+#endif //__SNAPSHOT_TEST_H__
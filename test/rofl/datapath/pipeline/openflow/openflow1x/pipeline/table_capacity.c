@@ -0,0 +1,221 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CUnit/Basic.h"
+#include "table_capacity.h"
+
+#define TCAP_IP(i) (0x0A000000+(i))
+
+static of1x_switch_t* sw=NULL;
+
+//Table 0 loop, table 1 adaptive; all the tables empty and unlimited
+int tcap_set_up(void){
+	enum of1x_matching_algorithm_available ma_list[2]={of1x_matching_algorithm_loop, of1x_matching_algorithm_adaptive};
+
+	if(sw)
+		__of1x_destroy_switch(sw);
+
+	sw = of1x_init_switch("Table capacity", OF_VERSION_13, 0x0A01, 2, ma_list);
+	if(!sw)
+		return -1;
+	return 0;
+}
+
+int tcap_tear_down(void){
+	__of1x_destroy_switch(sw);
+	sw = NULL;
+	return 0;
+}
+
+static of1x_flow_entry_t* tcap_entry(unsigned int i, uint16_t importance, uint32_t hard_timeout){
+	of1x_flow_entry_t* entry = of1x_init_flow_entry(NULL, NULL, false);
+
+	entry->priority = 100;
+	entry->cookie = i;
+	entry->importance = importance;
+	of1x_add_match_to_entry(entry, of1x_init_eth_type_match(NULL, NULL, OF1X_ETH_TYPE_IPV4));
+	of1x_add_match_to_entry(entry, of1x_init_ip4_dst_match(NULL, NULL, TCAP_IP(i), 0xFFFFFFFF));
+	if(hard_timeout)
+		__of1x_fill_new_timer_entry_info(entry, hard_timeout, 0);
+	return entry;
+}
+
+static rofl_of1x_fm_result_t tcap_add(unsigned int table_id, unsigned int i, uint16_t importance, uint32_t hard_timeout){
+	rofl_of1x_fm_result_t result;
+	of1x_flow_entry_t* entry = tcap_entry(i, importance, hard_timeout);
+
+	if((result = of1x_add_flow_entry_table(sw->pipeline, table_id, entry, false, false)) != ROFL_OF1X_FM_SUCCESS)
+		of1x_destroy_flow_entry(entry);
+	return result;
+}
+
+static of1x_flow_entry_t* tcap_find(unsigned int table_id, unsigned int i){
+	of1x_flow_entry_t* entry;
+
+	for(entry=sw->pipeline->tables[table_id].entries; entry; entry=entry->next)
+		if(entry->cookie == i)
+			return entry;
+	return NULL;
+}
+
+//Entries (cookies) in the table, as a bitmap
+static uint64_t tcap_present(unsigned int table_id){
+	uint64_t present = 0;
+	of1x_flow_entry_t* entry;
+
+	for(entry=sw->pipeline->tables[table_id].entries; entry; entry=entry->next)
+		present |= 1ULL << entry->cookie;
+	return present;
+}
+
+void tcap_limit_test(void){
+	unsigned int i;
+	of1x_flow_entry_t* entry;
+
+	CU_ASSERT(tcap_set_up() == 0);
+
+	CU_ASSERT(of1x_set_table_capacity(sw->pipeline, 0, 0, OF1X_TABLE_EVICTION_NONE) == ROFL_FAILURE);
+	CU_ASSERT(of1x_set_table_capacity(sw->pipeline, 2, 4, OF1X_TABLE_EVICTION_NONE) == ROFL_FAILURE);
+	CU_ASSERT(of1x_set_table_capacity(sw->pipeline, 0, 4, OF1X_TABLE_EVICTION_MAX+1) == ROFL_FAILURE);
+	CU_ASSERT(of1x_set_table_capacity(sw->pipeline, 0, 4, OF1X_TABLE_EVICTION_NONE) == ROFL_SUCCESS);
+
+	for(i=0;i<4;i++)
+		CU_ASSERT(tcap_add(0, i, 0, 0) == ROFL_OF1X_FM_SUCCESS);
+
+	//Full
+	CU_ASSERT(tcap_add(0, 4, 0, 0) == ROFL_OF1X_FM_TABLE_FULL);
+	CU_ASSERT(sw->pipeline->tables[0].num_of_entries == 4);
+	CU_ASSERT(tcap_present(0) == 0xF);
+
+	//Replacing an entry does not need room
+	CU_ASSERT(tcap_add(0, 2, 0, 0) == ROFL_OF1X_FM_SUCCESS);
+	CU_ASSERT(sw->pipeline->tables[0].num_of_entries == 4);
+
+	//Cannot shrink below the entries installed without eviction
+	CU_ASSERT(of1x_set_table_capacity(sw->pipeline, 0, 2, OF1X_TABLE_EVICTION_NONE) == ROFL_FAILURE);
+	CU_ASSERT(sw->pipeline->tables[0].max_entries == 4);
+
+	//Room after a removal
+	entry = tcap_entry(0, 0, 0);
+	CU_ASSERT(of1x_remove_flow_entry_table(sw->pipeline, 0, entry, STRICT, OF1X_PORT_ANY, OF1X_GROUP_ANY) == ROFL_SUCCESS);
+	of1x_destroy_flow_entry(entry);
+	CU_ASSERT(tcap_add(0, 4, 0, 0) == ROFL_OF1X_FM_SUCCESS);
+	CU_ASSERT(tcap_present(0) == 0x1E);
+
+	//Other tables are not limited
+	for(i=0;i<8;i++)
+		CU_ASSERT(tcap_add(1, i, 0, 0) == ROFL_OF1X_FM_SUCCESS);
+	CU_ASSERT(sw->pipeline->tables[1].num_of_entries == 8);
+}
+
+void tcap_lru_test(void){
+	unsigned int i;
+
+	CU_ASSERT(tcap_set_up() == 0);
+	CU_ASSERT(of1x_set_table_capacity(sw->pipeline, 0, 4, OF1X_TABLE_EVICTION_LRU) == ROFL_SUCCESS);
+
+	for(i=0;i<4;i++)
+		CU_ASSERT(tcap_add(0, i, 0, 0) == ROFL_OF1X_FM_SUCCESS);
+
+	//Hits on the two oldest ones
+	__of1x_flow_entry_mark_referenced(tcap_find(0, 0));
+	__of1x_flow_entry_mark_referenced(tcap_find(0, 1));
+
+	//Oldest entry not hit
+	CU_ASSERT(tcap_add(0, 4, 0, 0) == ROFL_OF1X_FM_SUCCESS);
+	CU_ASSERT(sw->pipeline->tables[0].num_of_entries == 4);
+	CU_ASSERT(tcap_present(0) == 0x1B);
+
+	//No hits since; 3 is now the least recently used
+	CU_ASSERT(tcap_add(0, 5, 0, 0) == ROFL_OF1X_FM_SUCCESS);
+	CU_ASSERT(tcap_present(0) == 0x33);
+	CU_ASSERT(tcap_add(0, 6, 0, 0) == ROFL_OF1X_FM_SUCCESS);
+	CU_ASSERT(tcap_present(0) == 0x72);
+}
+
+void tcap_importance_test(void){
+	unsigned int i;
+	uint16_t importance[4] = { 5, 1, 7, 3 };
+
+	CU_ASSERT(tcap_set_up() == 0);
+	CU_ASSERT(of1x_set_table_capacity(sw->pipeline, 1, 4, OF1X_TABLE_EVICTION_IMPORTANCE) == ROFL_SUCCESS);
+
+	for(i=0;i<4;i++)
+		CU_ASSERT(tcap_add(1, i, importance[i], 0) == ROFL_OF1X_FM_SUCCESS);
+
+	CU_ASSERT(tcap_add(1, 4, 9, 0) == ROFL_OF1X_FM_SUCCESS);
+	CU_ASSERT(tcap_present(1) == 0x1D);
+	CU_ASSERT(tcap_add(1, 5, 9, 0) == ROFL_OF1X_FM_SUCCESS);
+	CU_ASSERT(tcap_present(1) == 0x35);
+	CU_ASSERT(sw->pipeline->tables[1].num_of_entries == 4);
+}
+
+void tcap_lifetime_test(void){
+	unsigned int i;
+	uint32_t hard_timeout[4] = { 0, 30, 10, 0 };
+	struct timeval now;
+
+	CU_ASSERT(tcap_set_up() == 0);
+	CU_ASSERT(of1x_set_table_capacity(sw->pipeline, 0, 4, OF1X_TABLE_EVICTION_LIFETIME) == ROFL_SUCCESS);
+
+	for(i=0;i<4;i++)
+		CU_ASSERT(tcap_add(0, i, 0, hard_timeout[i]) == ROFL_OF1X_FM_SUCCESS);
+
+	__of1x_time_forward(5, 0, &now);
+
+	//Closest to expire first; entries without timeouts last, least recently used first
+	CU_ASSERT(tcap_add(0, 4, 0, 0) == ROFL_OF1X_FM_SUCCESS);
+	CU_ASSERT(tcap_present(0) == 0x1B);
+	CU_ASSERT(tcap_add(0, 5, 0, 0) == ROFL_OF1X_FM_SUCCESS);
+	CU_ASSERT(tcap_present(0) == 0x39);
+	CU_ASSERT(tcap_add(0, 6, 0, 0) == ROFL_OF1X_FM_SUCCESS);
+	CU_ASSERT(tcap_present(0) == 0x78);
+}
+
+void tcap_shrink_test(void){
+	unsigned int i;
+
+	CU_ASSERT(tcap_set_up() == 0);
+
+	for(i=0;i<6;i++)
+		CU_ASSERT(tcap_add(1, i, 0, 0) == ROFL_OF1X_FM_SUCCESS);
+
+	__of1x_flow_entry_mark_referenced(tcap_find(1, 0));
+
+	CU_ASSERT(of1x_set_table_capacity(sw->pipeline, 1, 3, OF1X_TABLE_EVICTION_LRU) == ROFL_SUCCESS);
+	CU_ASSERT(sw->pipeline->tables[1].num_of_entries == 3);
+	CU_ASSERT(tcap_present(1) == 0x31);
+
+	//Disabling eviction keeps the limit
+	CU_ASSERT(of1x_set_table_capacity(sw->pipeline, 1, 3, OF1X_TABLE_EVICTION_NONE) == ROFL_SUCCESS);
+	CU_ASSERT(tcap_add(1, 6, 0, 0) == ROFL_OF1X_FM_TABLE_FULL);
+	CU_ASSERT(tcap_present(1) == 0x31);
+}
+
+void tcap_notify_test(void){
+	unsigned int i;
+	of1x_flow_entry_t* entry;
+
+	CU_ASSERT(tcap_set_up() == 0);
+	CU_ASSERT(of1x_set_table_capacity(sw->pipeline, 0, 3, OF1X_TABLE_EVICTION_LRU) == ROFL_SUCCESS);
+
+	for(i=0;i<3;i++){
+		entry = tcap_entry(i, 0, 0);
+		entry->notify_removal = true;
+		CU_ASSERT(of1x_add_flow_entry_table(sw->pipeline, 0, entry, false, false) == ROFL_OF1X_FM_SUCCESS);
+	}
+	test_flow_removed_count = 0;
+
+	//Evicted to make room
+	CU_ASSERT(tcap_add(0, 3, 0, 0) == ROFL_OF1X_FM_SUCCESS);
+	CU_ASSERT(test_flow_removed_count == 1);
+	CU_ASSERT(test_flow_removed_reason == OF1X_FLOW_REMOVE_EVICTION);
+	CU_ASSERT(test_flow_removed_cookie == 0);
+
+	//Evicted when shrinking
+	CU_ASSERT(of1x_set_table_capacity(sw->pipeline, 0, 2, OF1X_TABLE_EVICTION_LRU) == ROFL_SUCCESS);
+	CU_ASSERT(test_flow_removed_count == 2);
+	CU_ASSERT(test_flow_removed_reason == OF1X_FLOW_REMOVE_EVICTION);
+	CU_ASSERT(test_flow_removed_cookie == 1);
+	CU_ASSERT(tcap_present(0) == 0xC);
+}
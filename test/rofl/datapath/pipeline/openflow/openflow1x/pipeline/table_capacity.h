@@ -0,0 +1,25 @@
+#ifndef __TABLE_CAPACITY_TEST_H__
+#define __TABLE_CAPACITY_TEST_H__
+
+#include "rofl.h"
+#include "rofl/datapath/pipeline/physical_switch.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/of1x_switch.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_pipeline.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_flow_table.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/pipeline/of1x_timers.h"
+
+//Recorded by platform_of1x_notify_flow_removed() (platform_empty_hooks_of12.cc)
+extern unsigned int test_flow_removed_count;
+extern of1x_flow_remove_reason_t test_flow_removed_reason;
+extern uint64_t test_flow_removed_cookie;
+
+int tcap_set_up(void);
+int tcap_tear_down(void);
+void tcap_limit_test(void);
+void tcap_lru_test(void);
+void tcap_importance_test(void);
+void tcap_lifetime_test(void);
+void tcap_shrink_test(void);
+void tcap_notify_test(void);
+
+#endif //__TABLE_CAPACITY_TEST_H__
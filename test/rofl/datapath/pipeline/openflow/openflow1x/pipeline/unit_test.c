@@ -5,12 +5,26 @@
 #include "group_table.h"
 #include "timers_hard_timeout.h"
 #include "output_actions.h"
+#include "group_types.h"
+#include "meter_table.h"
+#include "slab_allocator.h"
+#include "pipeline_latency.h"
+#include "flight_recorder.h"
+#include "port_stats.h"
+#include "buffer_pool.h"
+#include "packet_in_limiter.h"
+#include "vlink_test.h"
+#include "psch_test.h"
+#include "port_sets.h"
+#include "physical_switch_index.h"
+#include "snapshot.h"
+#include "table_capacity.h"
 
 int main(int args, char** argv){
 
 	int return_code;
 	//main to call all the other tests written in the oder files in this folder
-	CU_pSuite output_suite = NULL, timers_hard_suite=NULL;
+	CU_pSuite output_suite = NULL, timers_hard_suite=NULL, group_types_suite=NULL, meter_table_suite=NULL, slab_suite=NULL, latency_suite=NULL, recorder_suite=NULL, port_stats_suite=NULL, buffer_pool_suite=NULL, pkt_in_limiter_suite=NULL, vlink_suite=NULL, port_sched_suite=NULL, port_sets_suite=NULL, snapshot_suite=NULL, capacity_suite=NULL, psw_index_suite=NULL;
 
 	/* initialize the CUnit test registry */
 	if (CUE_SUCCESS != CU_initialize_registry())
@@ -52,6 +66,32 @@ int main(int args, char** argv){
 		return CU_get_error();
 	}
 	
+	if((group_types_suite = CU_add_suite("suite for the group types", gtypes_set_up, gtypes_tear_down))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+	if ((CU_add_test(group_types_suite,"select lookup table",gtypes_select_lut_test))==NULL ||
+		(CU_add_test(group_types_suite,"select hash",gtypes_select_hash_test))==NULL ||
+		(CU_add_test(group_types_suite,"select errors",gtypes_select_errors_test))==NULL ||
+		(CU_add_test(group_types_suite,"fast failover liveness",gtypes_ff_liveness_test))==NULL ||
+		(CU_add_test(group_types_suite,"fast failover errors",gtypes_ff_errors_test))==NULL ||
+		(CU_add_test(group_types_suite,"group id index",gtypes_index_test))==NULL ||
+		(CU_add_test(group_types_suite,"group stats",gtypes_stats_test))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+	
+	if((slab_suite = CU_add_suite("suite for the slab allocator", slab_set_up, slab_tear_down))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+	if ((CU_add_test(slab_suite,"alloc and free",slab_alloc_free_test))==NULL ||
+		(CU_add_test(slab_suite,"batch free",slab_batch_test))==NULL ||
+		(CU_add_test(slab_suite,"flow entry",slab_flow_entry_test))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+
 	timers_hard_suite = CU_add_suite("Suite_timers_hard", NULL, NULL);
 	if (NULL == timers_hard_suite) {
 		CU_cleanup_registry();
@@ -62,6 +102,146 @@ int main(int args, char** argv){
 		return CU_get_error();
 	}
 
+	//Moves the (fake) clock forward; must run after the timers suite
+	if((meter_table_suite = CU_add_suite("suite for the meter table", mt_set_up, mt_tear_down))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+	if ((CU_add_test(meter_table_suite,"meter mgmt",mt_mgmt_test))==NULL ||
+		(CU_add_test(meter_table_suite,"drop band",mt_drop_band_test))==NULL ||
+		(CU_add_test(meter_table_suite,"dscp remark band",mt_dscp_remark_test))==NULL ||
+		(CU_add_test(meter_table_suite,"meter instruction",mt_flow_entry_test))==NULL ||
+		(CU_add_test(meter_table_suite,"modify counters",mt_modify_counters_test))==NULL ||
+		(CU_add_test(meter_table_suite,"concurrent modify",mt_concurrent_modify_test))==NULL ||
+		(CU_add_test(meter_table_suite,"concurrent delete",mt_concurrent_delete_test))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+
+	if((latency_suite = CU_add_suite("suite for the pipeline latency", lat_set_up, lat_tear_down))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+	if ((CU_add_test(latency_suite,"stages",lat_stages_test))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+
+	if((recorder_suite = CU_add_suite("suite for the flight recorder", fr_set_up, fr_tear_down))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+	if ((CU_add_test(recorder_suite,"verdicts",fr_verdicts_test))==NULL ||
+		(CU_add_test(recorder_suite,"sampling",fr_sampling_test))==NULL ||
+		(CU_add_test(recorder_suite,"packet-in limit",fr_packet_in_limit_test))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+
+	if((port_stats_suite = CU_add_suite("suite for the port statistics", ps_set_up, ps_tear_down))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+	if ((CU_add_test(port_stats_suite,"concurrent inc",ps_concurrent_inc_test))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+
+	if((buffer_pool_suite = CU_add_suite("suite for the packet buffer pool", bp_set_up, bp_tear_down))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+	if ((CU_add_test(buffer_pool_suite,"store and retrieve",bp_store_retrieve_test))==NULL ||
+		(CU_add_test(buffer_pool_suite,"exhaustion",bp_exhaustion_test))==NULL ||
+		(CU_add_test(buffer_pool_suite,"expiration",bp_expiration_test))==NULL ||
+		(CU_add_test(buffer_pool_suite,"concurrent",bp_concurrent_test))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+
+	if((pkt_in_limiter_suite = CU_add_suite("suite for the packet-in limiter", pil_set_up, pil_tear_down))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+	if ((CU_add_test(pkt_in_limiter_suite,"switch limit",pil_switch_limit_test))==NULL ||
+		(CU_add_test(pkt_in_limiter_suite,"table and reason limits",pil_table_reason_limit_test))==NULL ||
+		(CU_add_test(pkt_in_limiter_suite,"flow filter",pil_flow_filter_test))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+
+	if((vlink_suite = CU_add_suite("suite for the virtual links", vl_set_up, vl_tear_down))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+	if ((CU_add_test(vlink_suite,"chaining",vl_chaining_test))==NULL ||
+		(CU_add_test(vlink_suite,"burst",vl_burst_test))==NULL ||
+		(CU_add_test(vlink_suite,"loop",vl_loop_test))==NULL ||
+		(CU_add_test(vlink_suite,"push/pop",vl_pop_test))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+
+	if((port_sched_suite = CU_add_suite("suite for the port scheduler", psch_set_up, psch_tear_down))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+	if ((CU_add_test(port_sched_suite,"drr",psch_drr_test))==NULL ||
+		(CU_add_test(port_sched_suite,"shaping",psch_shaping_test))==NULL ||
+		(CU_add_test(port_sched_suite,"oversized packets",psch_oversized_test))==NULL ||
+		(CU_add_test(port_sched_suite,"concurrent",psch_concurrent_test))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+
+	if((port_sets_suite = CU_add_suite("suite for the flood/all port sets", pset_set_up, pset_tear_down))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+	if ((CU_add_test(port_sets_suite,"sets",pset_sets_test))==NULL ||
+		(CU_add_test(port_sets_suite,"output",pset_output_test))==NULL ||
+		(CU_add_test(port_sets_suite,"concurrent rebuilds",pset_concurrent_test))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+
+	if((snapshot_suite = CU_add_suite("suite for the pipeline snapshots", snap_set_up, snap_tear_down))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+	if ((CU_add_test(snapshot_suite,"roundtrip",snap_roundtrip_test))==NULL ||
+		(CU_add_test(snapshot_suite,"timers",snap_timers_test))==NULL ||
+		(CU_add_test(snapshot_suite,"invalid",snap_invalid_test))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+
+	if((capacity_suite = CU_add_suite("suite for the flow table capacities", tcap_set_up, tcap_tear_down))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+	if ((CU_add_test(capacity_suite,"limit",tcap_limit_test))==NULL ||
+		(CU_add_test(capacity_suite,"lru",tcap_lru_test))==NULL ||
+		(CU_add_test(capacity_suite,"importance",tcap_importance_test))==NULL ||
+		(CU_add_test(capacity_suite,"lifetime",tcap_lifetime_test))==NULL ||
+		(CU_add_test(capacity_suite,"shrink",tcap_shrink_test))==NULL ||
+		(CU_add_test(capacity_suite,"notify removal",tcap_notify_test))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+
+	//Replaces the physical switch; must be the last one
+	if((psw_index_suite = CU_add_suite("suite for the physical switch indices", psi_set_up, psi_tear_down))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+	if ((CU_add_test(psw_index_suite,"logical switches",psi_logical_switches_test))==NULL ||
+		(CU_add_test(psw_index_suite,"ports",psi_ports_test))==NULL ||
+		(CU_add_test(psw_index_suite,"concurrent lookups",psi_concurrent_test))==NULL){
+		CU_cleanup_registry();
+		return CU_get_error();
+	}
+
 	/* Run all tests using the CUnit Basic interface */
 	CU_basic_set_mode(CU_BRM_VERBOSE);
 	CU_basic_run_tests();
@@ -0,0 +1,228 @@
+#include <stdio.h>
+#include <string.h>
+#include "CUnit/Basic.h"
+#include "vlink_test.h"
+
+#define VL_ETH_DST 0x0000AABBCCDDEEFFULL
+#define VL_IP_PROTO 17
+
+//Tenant (sw1, port 1) <-> provider (sw2, port 1); provider uplink at sw2 port 2
+static of1x_switch_t *sw1=NULL, *sw2=NULL;
+static switch_port_t *tenant=NULL, *provider=NULL, *uplink=NULL;
+static of1x_flow_entry_t* provider_entry;
+
+int vl_set_up(void){
+	enum of1x_matching_algorithm_available ma_list[1]={of1x_matching_algorithm_loop};
+
+	sw1 = of1x_init_switch("Tenant switch", OF_VERSION_13, 0x0701, 1, ma_list);
+	sw2 = of1x_init_switch("Provider switch", OF_VERSION_13, 0x0702, 1, ma_list);
+	tenant = switch_port_init("vlink0", true, PORT_TYPE_VIRTUAL, PORT_STATE_NONE);
+	provider = switch_port_init("vlink1", true, PORT_TYPE_VIRTUAL, PORT_STATE_NONE);
+	uplink = switch_port_init("uplink", true, PORT_TYPE_PHYSICAL, PORT_STATE_NONE);
+	if(!sw1 || !sw2 || !tenant || !provider || !uplink)
+		return -1;
+
+	if(__of1x_attach_port_to_switch_at_port_num(sw1, 1, tenant) != ROFL_SUCCESS ||
+		__of1x_attach_port_to_switch_at_port_num(sw2, 1, provider) != ROFL_SUCCESS ||
+		__of1x_attach_port_to_switch_at_port_num(sw2, 2, uplink) != ROFL_SUCCESS)
+		return -1;
+	return 0;
+}
+
+int vl_tear_down(void){
+	__of1x_destroy_switch(sw1);
+	__of1x_destroy_switch(sw2);
+	switch_port_destroy(tenant);
+	switch_port_destroy(provider);
+	switch_port_destroy(uplink);
+	return 0;
+}
+
+//Entry in table 0: [in_port] [eth_dst] -> [set eth_dst] output
+static of1x_flow_entry_t* vl_output_entry(of1x_switch_t* sw, uint32_t in_port, bool match_eth_dst, uint16_t priority, uint32_t port, bool set_eth_dst){
+	wrap_uint_t field;
+	of1x_action_group_t* apply_actions = of1x_init_action_group(0);
+	of1x_flow_entry_t* entry = of1x_init_flow_entry(NULL, NULL, false);
+
+	entry->priority = priority;
+	if(set_eth_dst){
+		field.u64 = VL_ETH_DST;
+		of1x_push_packet_action_to_group(apply_actions, of1x_init_packet_action(OF1X_AT_SET_FIELD_ETH_DST, field, NULL, NULL));
+	}
+	field.u32 = port;
+	of1x_push_packet_action_to_group(apply_actions, of1x_init_packet_action(OF1X_AT_OUTPUT, field, NULL, NULL));
+	of1x_add_instruction_to_group(&entry->inst_grp, OF1X_IT_APPLY_ACTIONS, apply_actions, NULL, NULL, 0);
+
+	if(in_port)
+		of1x_add_match_to_entry(entry, of1x_init_port_in_match(NULL, NULL, in_port));
+	if(match_eth_dst)
+		of1x_add_match_to_entry(entry, of1x_init_eth_dst_match(NULL, NULL, VL_ETH_DST, 0xFFFFFFFFFFFFULL));
+	CU_ASSERT(of1x_add_flow_entry_table(sw->pipeline, 0, entry, false, false) == ROFL_OF1X_FM_SUCCESS);
+
+	return entry;
+}
+
+void vl_chaining_test(void){
+	datapacket_t pkt;
+	port_stats_t stats;
+
+	CU_ASSERT(virtual_link_connect(tenant, tenant) == ROFL_FAILURE);
+	CU_ASSERT(virtual_link_connect(tenant, provider) == ROFL_SUCCESS);
+	CU_ASSERT(virtual_link_connect(tenant, uplink) == ROFL_FAILURE);
+	CU_ASSERT(virtual_link_is_connected(provider));
+	CU_ASSERT(!virtual_link_is_connected(uplink));
+
+	//Tenant rewrites the destination; the provider only matches it if the
+	//matches are carried over (the empty platform packet parses as all zeros)
+	vl_output_entry(sw1, 0, false, 1, 1, true);
+	provider_entry = vl_output_entry(sw2, 1, true, 1, 2, false);
+
+	memset(&pkt, 0, sizeof(pkt));
+	CU_ASSERT(of_process_packet_pipeline((of_switch_t*)sw1, &pkt) == ROFL_SUCCESS);
+
+	CU_ASSERT(provider_entry->stats.packet_count == 1);
+	CU_ASSERT(pkt.sw == (of_switch_t*)sw2);
+	CU_ASSERT(pkt.matches.of1x.port_in == 1);
+	CU_ASSERT(pkt.matches.of1x.eth_dst == VL_ETH_DST);
+
+	switch_port_get_stats(tenant, &stats);
+	CU_ASSERT(stats.tx_packets == 1 && stats.tx_dropped == 0);
+	switch_port_get_stats(provider, &stats);
+	CU_ASSERT(stats.rx_packets == 1 && stats.rx_dropped == 0);
+
+	//Provider port down
+	provider->up = false;
+	memset(&pkt, 0, sizeof(pkt));
+	of_process_packet_pipeline((of_switch_t*)sw1, &pkt);
+	CU_ASSERT(provider_entry->stats.packet_count == 1);
+	switch_port_get_stats(provider, &stats);
+	CU_ASSERT(stats.rx_packets == 1 && stats.rx_dropped == 1);
+	provider->up = true;
+}
+
+void vl_burst_test(void){
+	unsigned int i;
+	datapacket_t pkts[4];
+	datapacket_t* burst[4];
+	port_stats_t stats;
+
+	//Injected by the platform, already parsed
+	for(i=0;i<4;i++){
+		memset(&pkts[i], 0, sizeof(datapacket_t));
+		pkts[i].matches.of1x.eth_dst = VL_ETH_DST;
+		burst[i] = &pkts[i];
+	}
+	virtual_link_transmit_burst(tenant, burst, 4, true);
+	CU_ASSERT(provider_entry->stats.packet_count == 5);
+	for(i=0;i<4;i++)
+		CU_ASSERT(pkts[i].sw == (of_switch_t*)sw2 && pkts[i].matches.of1x.port_in == 1);
+
+	//Not parsed; headers are taken from the (empty) platform packet
+	for(i=0;i<4;i++)
+		pkts[i].matches.of1x.eth_dst = VL_ETH_DST;
+	virtual_link_transmit_burst(tenant, burst, 4, false);
+	CU_ASSERT(provider_entry->stats.packet_count == 5);
+	CU_ASSERT(pkts[0].matches.of1x.eth_dst == 0 && pkts[0].matches.of1x.port_in == 1);
+
+	switch_port_get_stats(tenant, &stats);
+	CU_ASSERT(stats.tx_packets == 10);
+	switch_port_get_stats(provider, &stats);
+	CU_ASSERT(stats.rx_packets == 9);
+}
+
+void vl_loop_test(void){
+	datapacket_t pkt;
+	port_stats_t stats;
+	virtual_link_stats_t vl_stats;
+	switch_port_t *back_sw2, *back_sw1;
+
+	//sw2 sends everything back to sw1 through a second link (sw2 port 3 <-> sw1 port 2)
+	back_sw2 = switch_port_init("vlink2", true, PORT_TYPE_VIRTUAL, PORT_STATE_NONE);
+	back_sw1 = switch_port_init("vlink3", true, PORT_TYPE_VIRTUAL, PORT_STATE_NONE);
+	CU_ASSERT(__of1x_attach_port_to_switch_at_port_num(sw2, 3, back_sw2) == ROFL_SUCCESS);
+	CU_ASSERT(__of1x_attach_port_to_switch_at_port_num(sw1, 2, back_sw1) == ROFL_SUCCESS);
+	CU_ASSERT(virtual_link_connect(back_sw2, back_sw1) == ROFL_SUCCESS);
+
+	vl_output_entry(sw2, 1, false, 2, 3, false);
+
+	memset(&pkt, 0, sizeof(pkt));
+	of_process_packet_pipeline((of_switch_t*)sw1, &pkt);
+
+	//8 links crossed; the 9th is dropped
+	virtual_link_get_stats(&vl_stats);
+	CU_ASSERT(vl_stats.loops == 1);
+	CU_ASSERT(vl_stats.overflows == 0);
+	switch_port_get_stats(back_sw2, &stats);
+	CU_ASSERT(stats.tx_packets == 4);
+	switch_port_get_stats(tenant, &stats);
+	CU_ASSERT(stats.tx_packets == 10+4 && stats.tx_dropped == 1);
+
+	CU_ASSERT(virtual_link_disconnect(back_sw1) == ROFL_SUCCESS);
+	CU_ASSERT(!virtual_link_is_connected(back_sw2));
+	CU_ASSERT(virtual_link_disconnect(back_sw1) == ROFL_FAILURE);
+
+	CU_ASSERT(__of1x_detach_port_from_switch(sw2, back_sw2) == ROFL_SUCCESS);
+	CU_ASSERT(__of1x_detach_port_from_switch(sw1, back_sw1) == ROFL_SUCCESS);
+	switch_port_destroy(back_sw2);
+	switch_port_destroy(back_sw1);
+}
+
+//Tenant entry: set ip_proto, [pop MPLS], set eth_type IPv4, output to the provider
+static of1x_flow_entry_t* vl_pop_entry(bool pop_mpls){
+	wrap_uint_t field;
+	of1x_action_group_t* apply_actions = of1x_init_action_group(0);
+	of1x_flow_entry_t* entry = of1x_init_flow_entry(NULL, NULL, false);
+
+	entry->priority = 10;
+	field.u8 = VL_IP_PROTO;
+	of1x_push_packet_action_to_group(apply_actions, of1x_init_packet_action(OF1X_AT_SET_FIELD_IP_PROTO, field, NULL, NULL));
+	if(pop_mpls){
+		field.u16 = OF1X_ETH_TYPE_IPV4;
+		of1x_push_packet_action_to_group(apply_actions, of1x_init_packet_action(OF1X_AT_POP_MPLS, field, NULL, NULL));
+	}
+	field.u16 = OF1X_ETH_TYPE_IPV4;
+	of1x_push_packet_action_to_group(apply_actions, of1x_init_packet_action(OF1X_AT_SET_FIELD_ETH_TYPE, field, NULL, NULL));
+	field.u32 = 1;
+	of1x_push_packet_action_to_group(apply_actions, of1x_init_packet_action(OF1X_AT_OUTPUT, field, NULL, NULL));
+	of1x_add_instruction_to_group(&entry->inst_grp, OF1X_IT_APPLY_ACTIONS, apply_actions, NULL, NULL, 0);
+	CU_ASSERT(of1x_add_flow_entry_table(sw1->pipeline, 0, entry, false, false) == ROFL_OF1X_FM_SUCCESS);
+
+	return entry;
+}
+
+void vl_pop_test(void){
+	datapacket_t pkt;
+	wrap_uint_t field;
+	of1x_action_group_t* apply_actions = of1x_init_action_group(0);
+	of1x_flow_entry_t* entry = of1x_init_flow_entry(NULL, NULL, false);
+
+	//Provider: in_port 1, IPv4, ip_proto -> uplink
+	entry->priority = 10;
+	field.u32 = 2;
+	of1x_push_packet_action_to_group(apply_actions, of1x_init_packet_action(OF1X_AT_OUTPUT, field, NULL, NULL));
+	of1x_add_instruction_to_group(&entry->inst_grp, OF1X_IT_APPLY_ACTIONS, apply_actions, NULL, NULL, 0);
+	of1x_add_match_to_entry(entry, of1x_init_port_in_match(NULL, NULL, 1));
+	of1x_add_match_to_entry(entry, of1x_init_eth_type_match(NULL, NULL, OF1X_ETH_TYPE_IPV4));
+	of1x_add_match_to_entry(entry, of1x_init_ip_proto_match(NULL, NULL, VL_IP_PROTO));
+	CU_ASSERT(of1x_add_flow_entry_table(sw2->pipeline, 0, entry, false, false) == ROFL_OF1X_FM_SUCCESS);
+
+	//Anything else from the tenant -> uplink (port 3 is gone)
+	vl_output_entry(sw2, 1, false, 5, 2, false);
+
+	//Headers untouched; the matches are carried over
+	vl_pop_entry(false);
+	memset(&pkt, 0, sizeof(pkt));
+	of_process_packet_pipeline((of_switch_t*)sw1, &pkt);
+	CU_ASSERT(pkt.sw == (of_switch_t*)sw2);
+	CU_ASSERT(entry->stats.packet_count == 1);
+
+	//Label popped; the provider parses the packet again (all zeros) instead
+	//of matching the ip_proto set before the pop
+	vl_pop_entry(true);
+	memset(&pkt, 0, sizeof(pkt));
+	of_process_packet_pipeline((of_switch_t*)sw1, &pkt);
+	CU_ASSERT(pkt.sw == (of_switch_t*)sw2);
+	CU_ASSERT(pkt.matches.of1x.ip_proto == 0);
+	CU_ASSERT(pkt.matches.of1x.headers_changed == false);
+	CU_ASSERT(entry->stats.packet_count == 1);
+}
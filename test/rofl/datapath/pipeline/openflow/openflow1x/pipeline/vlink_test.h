@@ -0,0 +1,16 @@
+#ifndef __VLINK_TEST_H__
+#define __VLINK_TEST_H__
+
+#include "rofl.h"
+#include "rofl/datapath/pipeline/virtual_link.h"
+#include "rofl/datapath/pipeline/switch_port.h"
+#include "rofl/datapath/pipeline/openflow/openflow1x/of1x_switch.h"
+
+int vl_set_up(void);
+int vl_tear_down(void);
+void vl_chaining_test(void);
+void vl_burst_test(void);
+void vl_loop_test(void);
+void vl_pop_test(void);
+
+#endif //__VLINK_TEST_H__